@@ -305,6 +305,7 @@ if _have_Homebrew_Python:
 KLayoutExecs  = [ 'klayout' ]
 KLayoutExecs += [ 'strm2cif', 'strm2dxf', 'strm2gds', 'strm2gdstxt', 'strm2oas' ]
 KLayoutExecs += [ 'strm2txt', 'strmclip', 'strmcmp',  'strmrun',     'strmxor'  ]
+KLayoutExecs += [ 'strmtile' ]
 
 #----------------
 # End of File
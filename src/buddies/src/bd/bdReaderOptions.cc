@@ -58,6 +58,7 @@ GenericReaderOptions::GenericReaderOptions ()
   m_dxf_contour_accuracy = load_options.get_option_by_name ("dxf_contour_accuracy").to_double ();
   m_dxf_render_texts_as_polygons = load_options.get_option_by_name ("dxf_render_texts_as_polygons").to_bool ();
   m_dxf_keep_other_cells = load_options.get_option_by_name ("dxf_keep_other_cells").to_bool ();
+  m_dxf_streaming_mode = load_options.get_option_by_name ("dxf_streaming_mode").to_bool ();
 
   m_magic_lambda = load_options.get_option_by_name ("mag_lambda").to_double ();
   m_magic_merge = load_options.get_option_by_name ("mag_merge").to_bool ();
@@ -121,6 +122,8 @@ GenericReaderOptions::GenericReaderOptions ()
   m_lefdef_read_lef_with_def = load_options.get_option_by_name ("lefdef_config.read_lef_with_def").to_bool ();
   m_lefdef_separate_groups = load_options.get_option_by_name ("lefdef_config.separate_groups").to_bool ();
   m_lefdef_map_file = load_options.get_option_by_name ("lefdef_config.map_file").to_string ();
+  m_lefdef_threads = load_options.get_option_by_name ("lefdef_config.threads").to_uint ();
+  m_lefdef_lef_cache_path = load_options.get_option_by_name ("lefdef_config.lef_cache_path").to_string ();
   m_lefdef_produce_lef_macros = (load_options.get_option_by_name ("lefdef_config.macro_resolution_mode").to_int () == 0);
 }
 
@@ -338,6 +341,11 @@ GenericReaderOptions::add_options (tl::CommandLineOptions &cmd)
                     "With this option, all cells not found to be instantiated are kept as additional top cells. "
                     "By default, such cells are removed."
                    )
+        << tl::arg (group +
+                    "#--" + m_long_prefix + "dxf-streaming-mode", &m_dxf_streaming_mode, "Joins lines into contours while reading",
+                    "With this option, lines are joined into contours while the file is read and closed contours are "
+                    "turned into polygons in batches. This reduces the memory required for large files in polyline mode 3 and 4."
+                   )
       ;
   }
 
@@ -626,6 +634,21 @@ GenericReaderOptions::add_options (tl::CommandLineOptions &cmd)
                     "\n"
                     "Relative paths are resolved based on the location of the DEF file which is read."
                    )
+        << tl::arg (group +
+                    "#--" + m_long_prefix + "lefdef-threads", &m_lefdef_threads, "Specifies the number of threads to use for reading DEF files",
+                    "This option applies when reading DEF files.\n"
+                    "\n"
+                    "With a value larger than 0, the components and nets sections of DEF files are parsed in the given number of threads. "
+                    "The LEF files are parsed in parallel too. "
+                    "The geometry is still produced in file order, so the result is the same as with single-threaded reading."
+                   )
+        << tl::arg (group +
+                    "#--" + m_long_prefix + "lefdef-lef-cache", &m_lefdef_lef_cache_path, "Specifies a directory for caching parsed LEF files",
+                    "This option applies when reading DEF files.\n"
+                    "\n"
+                    "If given, parsed LEF files are stored in this directory and reused when a LEF file with the same content "
+                    "is read again with the same options."
+                   )
       ;
 
   }
@@ -693,6 +716,7 @@ GenericReaderOptions::configure (db::LoadLayoutOptions &load_options) const
   load_options.set_option_by_name ("dxf_render_texts_as_polygons", m_dxf_render_texts_as_polygons);
   load_options.set_option_by_name ("dxf_keep_layer_names", m_keep_layer_names);
   load_options.set_option_by_name ("dxf_keep_other_cells", m_dxf_keep_other_cells);
+  load_options.set_option_by_name ("dxf_streaming_mode", m_dxf_streaming_mode);
 
   load_options.set_option_by_name ("mag_layer_map", tl::Variant::make_variant (m_layer_map));
   load_options.set_option_by_name ("mag_create_other_layers", m_create_other_layers);
@@ -743,6 +767,8 @@ GenericReaderOptions::configure (db::LoadLayoutOptions &load_options) const
   load_options.set_option_by_name ("lefdef_config.read_lef_with_def", m_lefdef_read_lef_with_def);
   load_options.set_option_by_name ("lefdef_config.separate_groups", m_lefdef_separate_groups);
   load_options.set_option_by_name ("lefdef_config.map_file", m_lefdef_map_file);
+  load_options.set_option_by_name ("lefdef_config.threads", m_lefdef_threads);
+  load_options.set_option_by_name ("lefdef_config.lef_cache_path", m_lefdef_lef_cache_path);
   load_options.set_option_by_name ("lefdef_config.macro_resolution_mode", m_lefdef_produce_lef_macros ? 0 : 2);
 }
 
@@ -127,6 +127,7 @@ private:
   double m_dxf_contour_accuracy;
   bool m_dxf_render_texts_as_polygons;
   bool m_dxf_keep_other_cells;
+  bool m_dxf_streaming_mode;
 
   //  MAGIC
   double m_magic_lambda;
@@ -180,6 +181,8 @@ private:
   bool m_lefdef_read_lef_with_def;
   bool m_lefdef_separate_groups;
   std::string m_lefdef_map_file;
+  unsigned int m_lefdef_threads;
+  std::string m_lefdef_lef_cache_path;
   bool m_lefdef_produce_lef_macros;
 };
 
@@ -55,6 +55,7 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
   double tolerance = 0.0;
   int max_count = 0;
   bool print_properties = false;
+  int threads = 0;
 
   tl::CommandLineOptions cmd;
   generic_reader_options_a.add_options (cmd);
@@ -126,6 +127,10 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
                   "If the value is >1, max-count-1 differences plus one warning about abbreviation is printed. "
                   "A value of 0 means \"no limitation\". To suppress all output, use --silent."
                  )
+      << tl::arg ("-n|--threads=threads",      &threads,   "Specifies the number of threads to use",
+                  "If given, multiple cells are compared in parallel on multiple cores. The differences are "
+                  "reported in the same order as without threads."
+                 )
     ;
 
   cmd.brief ("This program will compare two layout files on a per-object basis");
@@ -231,10 +236,10 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
       throw tl::Exception ("'" + top_b + "' is not a valid cell name in second layout");
     }
 
-    result = db::compare_layouts (layout_a, index_a.second, layout_b, index_b.second, flags, tolerance_dbu, max_count, print_properties);
+    result = db::compare_layouts (layout_a, index_a.second, layout_b, index_b.second, flags, tolerance_dbu, max_count, print_properties, threads);
 
   } else {
-    result = db::compare_layouts (layout_a, layout_b, flags, tolerance_dbu, max_count, print_properties);
+    result = db::compare_layouts (layout_a, layout_b, flags, tolerance_dbu, max_count, print_properties, threads);
   }
 
   if (! result && ! silent) {
@@ -0,0 +1,85 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "bdCommon.h"
+#include "dbTilingProcessor.h"
+#include "tlLog.h"
+#include "tlCommandLineParser.h"
+#include "tlStream.h"
+
+#include <cstdio>
+
+namespace
+{
+
+/**
+ *  @brief A stream delegate writing to stdout
+ *
+ *  The output is flushed immediately as the tiling processor
+ *  reads the results while the worker is running.
+ */
+class StdoutStream
+  : public tl::OutputStreamBase
+{
+public:
+  virtual void write (const char *b, size_t n)
+  {
+    fwrite (b, 1, n, stdout);
+    fflush (stdout);
+  }
+};
+
+}
+
+BD_PUBLIC int strmtile (int argc, char *argv[])
+{
+  std::string job_file, output_file;
+
+  tl::CommandLineOptions cmd;
+
+  cmd << tl::arg ("job",                        &job_file, "The job file to execute",
+                  "The job file is produced by the tiling processor in multi-process mode. "
+                  "The path of this file is appended to the worker command."
+                 )
+      << tl::arg ("-o|--output=file",           &output_file, "Writes the results to the given file",
+                  "By default, the results are written to the standard output."
+                 )
+    ;
+
+  cmd.brief ("This program is the worker process for the multi-process mode of the tiling processor. "
+             "It is not intended to be called by users directly.");
+
+  cmd.parse (argc, argv);
+
+  tl::InputStream job_stream (job_file);
+
+  if (output_file.empty ()) {
+    StdoutStream stdout_stream;
+    tl::OutputStream os (stdout_stream);
+    db::TilingProcessor::run_worker (job_stream, os);
+  } else {
+    tl::OutputStream os (output_file);
+    db::TilingProcessor::run_worker (job_stream, os);
+  }
+
+  return 0;
+}
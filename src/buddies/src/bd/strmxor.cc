@@ -28,6 +28,7 @@
 #include "dbSaveLayoutOptions.h"
 #include "dbRegion.h"
 #include "dbDeepShapeStore.h"
+#include "dbHash.h"
 #include "gsiExpression.h"
 #include "tlCommandLineParser.h"
 
@@ -144,6 +145,200 @@ struct XORData
   std::map<std::pair<int, db::LayerProperties>, ResultDescriptor> *results;
 };
 
+/**
+ *  @brief Identifies cells which are identical in both layouts
+ *
+ *  Cells are matched by name (the top cells are matched with each other). A cell can be skipped
+ *  in the hierarchical XOR if it is placed identically in both layouts (same parents, same
+ *  instances and the parents are placed identically too) and if its content is identical on the
+ *  given layer including all child cells. Such cells do not contribute to the XOR result.
+ *
+ *  To keep the comparison cheap, shape sets are compared by content hashes first. Only if the
+ *  hashes match, the shapes are compared exactly.
+ */
+class IdenticalCellDetector
+{
+public:
+  IdenticalCellDetector (const db::Layout &layout_a, db::cell_index_type top_a, const db::Layout &layout_b, db::cell_index_type top_b)
+    : mp_layout_a (&layout_a), mp_layout_b (&layout_b), m_top_a (top_a), m_top_b (top_b)
+  {
+    if (fabs (layout_a.dbu () - layout_b.dbu ()) > db::epsilon) {
+      //  no identical cells if the database units are different
+      return;
+    }
+
+    std::set<db::cell_index_type> called_a, called_b;
+    layout_a.cell (top_a).collect_called_cells (called_a);
+    called_a.insert (top_a);
+    layout_b.cell (top_b).collect_called_cells (called_b);
+    called_b.insert (top_b);
+
+    for (std::set<db::cell_index_type>::const_iterator c = called_a.begin (); c != called_a.end (); ++c) {
+      if (*c == top_a) {
+        m_a2b.insert (std::make_pair (top_a, top_b));
+      } else {
+        std::pair<bool, db::cell_index_type> cb = layout_b.cell_by_name (layout_a.cell_name (*c));
+        if (cb.first && cb.second != top_b && called_b.find (cb.second) != called_b.end ()) {
+          m_a2b.insert (std::make_pair (*c, cb.second));
+        }
+      }
+    }
+
+    //  determine the cells placed identically in both layouts (top-down)
+
+    for (db::Layout::top_down_const_iterator c = layout_a.begin_top_down (); c != layout_a.end_top_down (); ++c) {
+
+      std::map<db::cell_index_type, db::cell_index_type>::const_iterator cb = m_a2b.find (*c);
+      if (cb == m_a2b.end ()) {
+        continue;
+      }
+
+      if (*c == top_a) {
+        m_placed_identically.insert (*c);
+        continue;
+      }
+
+      std::vector<std::pair<db::cell_index_type, db::CellInstArray> > pi_a, pi_b;
+      bool valid = true;
+
+      for (db::Cell::parent_inst_iterator p = layout_a.cell (*c).begin_parent_insts (); ! p.at_end () && valid; ++p) {
+        if (called_a.find (p->parent_cell_index ()) != called_a.end ()) {
+          std::map<db::cell_index_type, db::cell_index_type>::const_iterator pb = m_a2b.find (p->parent_cell_index ());
+          if (pb == m_a2b.end () || m_placed_identically.find (p->parent_cell_index ()) == m_placed_identically.end ()) {
+            valid = false;
+          } else {
+            pi_a.push_back (std::make_pair (pb->second, p->child_inst ().cell_inst ()));
+            pi_a.back ().second.object ().cell_index (cb->second);
+          }
+        }
+      }
+
+      if (! valid) {
+        continue;
+      }
+
+      for (db::Cell::parent_inst_iterator p = layout_b.cell (cb->second).begin_parent_insts (); ! p.at_end (); ++p) {
+        if (called_b.find (p->parent_cell_index ()) != called_b.end ()) {
+          pi_b.push_back (std::make_pair (p->parent_cell_index (), p->child_inst ().cell_inst ()));
+        }
+      }
+
+      if (pi_a.size () == pi_b.size ()) {
+        std::sort (pi_a.begin (), pi_a.end ());
+        std::sort (pi_b.begin (), pi_b.end ());
+        if (pi_a == pi_b) {
+          m_placed_identically.insert (*c);
+        }
+      }
+
+    }
+
+    //  determine the cells with identical child instances
+
+    for (std::map<db::cell_index_type, db::cell_index_type>::const_iterator c = m_a2b.begin (); c != m_a2b.end (); ++c) {
+      if (same_instances (c->first, c->second)) {
+        m_same_instances.insert (c->first);
+      }
+    }
+  }
+
+  /**
+   *  @brief Computes the cells to skip for the given layers
+   *
+   *  The cell sets are suitable for RecursiveShapeIterator::unselect_cells.
+   *  The return value is true, if the top cells are identical. In that case, the
+   *  layer does not need to be XORed at all.
+   */
+  bool cells_to_skip (unsigned int layer_a, unsigned int layer_b, std::set<db::cell_index_type> &skip_a, std::set<db::cell_index_type> &skip_b) const
+  {
+    std::set<db::cell_index_type> identical;
+
+    for (db::Layout::bottom_up_const_iterator c = mp_layout_a->begin_bottom_up (); c != mp_layout_a->end_bottom_up (); ++c) {
+
+      if (m_same_instances.find (*c) == m_same_instances.end ()) {
+        continue;
+      }
+
+      const db::Cell &cell_a = mp_layout_a->cell (*c);
+
+      bool children_identical = true;
+      for (db::Cell::child_cell_iterator cc = cell_a.begin_child_cells (); ! cc.at_end () && children_identical; ++cc) {
+        children_identical = (identical.find (*cc) != identical.end ());
+      }
+
+      db::cell_index_type cb = m_a2b.find (*c)->second;
+      if (children_identical && same_shapes (cell_a.shapes (layer_a), mp_layout_b->cell (cb).shapes (layer_b))) {
+        identical.insert (*c);
+        if (m_placed_identically.find (*c) != m_placed_identically.end ()) {
+          skip_a.insert (*c);
+          skip_b.insert (cb);
+        }
+      }
+
+    }
+
+    return identical.find (m_top_a) != identical.end ();
+  }
+
+private:
+  const db::Layout *mp_layout_a, *mp_layout_b;
+  db::cell_index_type m_top_a, m_top_b;
+  std::map<db::cell_index_type, db::cell_index_type> m_a2b;
+  std::set<db::cell_index_type> m_placed_identically;
+  std::set<db::cell_index_type> m_same_instances;
+
+  bool same_instances (db::cell_index_type ca, db::cell_index_type cb) const
+  {
+    std::vector<db::CellInstArray> insts_a, insts_b;
+
+    for (db::Cell::const_iterator i = mp_layout_a->cell (ca).begin (); ! i.at_end (); ++i) {
+      std::map<db::cell_index_type, db::cell_index_type>::const_iterator ci = m_a2b.find (i->cell_index ());
+      if (ci == m_a2b.end ()) {
+        return false;
+      }
+      insts_a.push_back (i->cell_inst ());
+      insts_a.back ().object ().cell_index (ci->second);
+    }
+
+    for (db::Cell::const_iterator i = mp_layout_b->cell (cb).begin (); ! i.at_end (); ++i) {
+      insts_b.push_back (i->cell_inst ());
+    }
+
+    if (insts_a.size () != insts_b.size ()) {
+      return false;
+    }
+
+    std::sort (insts_a.begin (), insts_a.end ());
+    std::sort (insts_b.begin (), insts_b.end ());
+    return insts_a == insts_b;
+  }
+
+  static size_t collect_polygons (const db::Shapes &shapes, std::vector<db::Polygon> &polygons)
+  {
+    size_t h = 0;
+    for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::Regions); ! s.at_end (); ++s) {
+      polygons.push_back (db::Polygon ());
+      s->polygon (polygons.back ());
+      //  order-independent hash
+      h += std::hcombine (std::hfunc (polygons.back ()), size_t (0x9e3779b9));
+    }
+    return h;
+  }
+
+  static bool same_shapes (const db::Shapes &shapes_a, const db::Shapes &shapes_b)
+  {
+    std::vector<db::Polygon> polygons_a, polygons_b;
+    if (collect_polygons (shapes_a, polygons_a) != collect_polygons (shapes_b, polygons_b) || polygons_a.size () != polygons_b.size ()) {
+      return false;
+    }
+
+    //  hashes match: confirm by exact comparison
+    std::sort (polygons_a.begin (), polygons_a.end ());
+    std::sort (polygons_b.begin (), polygons_b.end ());
+    return polygons_a == polygons_b;
+  }
+};
+
 static bool run_tiled_xor (const XORData &xor_data);
 static bool run_deep_xor (const XORData &xor_data);
 
@@ -192,7 +387,8 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
                  )
       << tl::arg ("-u|--deep",                 &deep,       "Deep (hierarchical mode)",
                   "Enables hierarchical XOR (experimental). In this mode, tiling is not supported "
-                  "and the tiling arguments are ignored."
+                  "and the tiling arguments are ignored. Cells which are identical in both layouts and "
+                  "placed identically are detected up front and are not XORed at all."
                  )
       << tl::arg ("-s|--silent",               &silent,     "Silent mode",
                   "In silent mode, no summary is printed, but the exit code indicates whether "
@@ -562,6 +758,9 @@ bool run_deep_xor (const XORData &xor_data)
     xor_data.output_layout->dbu (dbu);
   }
 
+  //  cells identical in both layouts don't need to be XORed
+  IdenticalCellDetector identical_cells (*xor_data.layout_a, xor_data.cell_a, *xor_data.layout_b, xor_data.cell_b);
+
   bool result = true;
 
   int index = 1;
@@ -595,19 +794,51 @@ bool run_deep_xor (const XORData &xor_data)
 
       db::RecursiveShapeIterator ri_a, ri_b;
 
+      std::set<db::cell_index_type> skip_a, skip_b;
+      bool all_identical = false;
+      if (ll->second.first >= 0 && ll->second.second >= 0) {
+        all_identical = identical_cells.cells_to_skip (ll->second.first, ll->second.second, skip_a, skip_b);
+      }
+
+      if (tl::verbosity () >= 20) {
+        if (all_identical) {
+          tl::log << "Layer " << ll->first.to_string () << " is identical in both layouts - skipped";
+        } else if (! skip_a.empty ()) {
+          tl::log << "Skipping " << skip_a.size () << " identical cell(s) on layer " << ll->first.to_string ();
+        }
+      }
+
       if (ll->second.first >= 0) {
         ri_a = db::RecursiveShapeIterator (*xor_data.layout_a, xor_data.layout_a->cell (xor_data.cell_a), ll->second.first);
+        ri_a.unselect_cells (skip_a);
       }
 
       if (ll->second.second >= 0) {
         ri_b = db::RecursiveShapeIterator (*xor_data.layout_b, xor_data.layout_b->cell (xor_data.cell_b), ll->second.second);
+        ri_b.unselect_cells (skip_b);
       }
 
-      db::Region in_a (ri_a, dss, db::ICplxTrans (xor_data.layout_a->dbu () / dbu));
-      db::Region in_b (ri_b, dss, db::ICplxTrans (xor_data.layout_b->dbu () / dbu));
-
       db::Region xor_res;
-      xor_res = in_a ^ in_b;
+
+      if (! all_identical) {
+
+        db::Region in_a (ri_a, dss, db::ICplxTrans (xor_data.layout_a->dbu () / dbu));
+        db::Region in_b (ri_b, dss, db::ICplxTrans (xor_data.layout_b->dbu () / dbu));
+        xor_res = in_a ^ in_b;
+
+        //  The skipped cells are present in both layouts. Where other shapes overlap them,
+        //  there is no difference: (A+S)^(B+S) is (A^B)-S.
+        if (! skip_a.empty () && ! xor_res.empty ()) {
+          //  deliver the shapes from the skipped cells' subtrees only (the complement of "ri_a")
+          db::RecursiveShapeIterator ri_s (*xor_data.layout_a, xor_data.layout_a->cell (xor_data.cell_a), ll->second.first);
+          std::set<db::cell_index_type> top_a;
+          top_a.insert (xor_data.cell_a);
+          ri_s.unselect_cells (top_a);
+          ri_s.select_cells (skip_a);
+          xor_res -= db::Region (ri_s, dss, db::ICplxTrans (xor_data.layout_a->dbu () / dbu));
+        }
+
+      }
 
       int tol_index = 0;
       for (std::vector<double>::const_iterator t = xor_data.tolerances.begin (); t != xor_data.tolerances.end (); ++t) {
@@ -14,6 +14,7 @@ SUBDIRS = \
   strmcmp \
   strmxor \
   strmrun \
+  strmtile \
 
 strm2cif.depends += bd
 strm2dxf.depends += bd
@@ -26,3 +27,4 @@ strmclip.depends += bd
 strmcmp.depends += bd
 strmxor.depends += bd
 strmrun.depends += bd
+strmtile.depends += bd
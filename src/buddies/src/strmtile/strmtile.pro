@@ -0,0 +1,2 @@
+
+include($$PWD/../buddy_app.pri)
@@ -0,0 +1,169 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "bdCommon.h"
+#include "dbTilingProcessor.h"
+#include "dbLayout.h"
+#include "tlUnitTest.h"
+#include "tlThreads.h"
+
+BD_PUBLIC int strmtile (int argc, char *argv[]);
+
+namespace
+{
+
+/**
+ *  @brief A worker launcher which runs strmtile inside the test process
+ */
+class InProcessLauncher
+  : public db::TileWorkerLauncher
+{
+public:
+  InProcessLauncher () : m_launched (0) { }
+
+  virtual tl::InputStream *launch (const std::string &job_file)
+  {
+    std::string output = job_file + ".out";
+    const char *argv[] = { "x", job_file.c_str (), "-o", output.c_str () };
+
+    //  NOTE: errors are reported through the output
+    try {
+      strmtile (sizeof (argv) / sizeof (argv[0]), (char **) argv);
+    } catch (tl::Exception &) {
+      //  .. ignore ..
+    }
+
+    tl::MutexLocker locker (&m_lock);
+    ++m_launched;
+
+    return new tl::InputStream (output);
+  }
+
+  int launched () const
+  {
+    return m_launched;
+  }
+
+private:
+  tl::Mutex m_lock;
+  int m_launched;
+};
+
+}
+
+static void make_layout (db::Layout &layout, db::Shapes &flat)
+{
+  db::cell_index_type top = layout.add_cell ("TOP");
+  db::cell_index_type child = layout.add_cell ("CHILD");
+  unsigned int l1 = layout.insert_layer (db::LayerProperties (1, 0));
+
+  for (int i = 0; i < 10; ++i) {
+    layout.cell (child).shapes (l1).insert (db::Box (i * 150, 0, i * 150 + 100, 1000));
+  }
+
+  layout.cell (top).insert (db::CellInstArray (db::CellInst (child), db::Trans (), db::Vector (0, 2000), db::Vector (2000, 0), 5, 5));
+
+  for (int i = 0; i < 20; ++i) {
+    flat.insert (db::Box (0, i * 500, 10000, i * 500 + 200));
+  }
+}
+
+static void setup (db::TilingProcessor &tp, db::Layout &layout, db::Shapes &flat, db::Region &out_region, db::Edges &out_edges)
+{
+  db::cell_index_type top = layout.cell_by_name ("TOP").second;
+
+  tp.input ("a", db::RecursiveShapeIterator (layout, layout.cell (top), 0));
+  tp.input ("b", db::RecursiveShapeIterator (flat));
+  tp.var ("d", tl::Variant (20));
+  tp.output ("o1", out_region);
+  tp.output ("o2", out_edges);
+  tp.tile_size (2.5, 2.5);
+  tp.tile_border (0.1, 0.1);
+  tp.queue ("_output(o1, a.sized(d) & b)");
+  tp.queue ("_output(o2, (a ^ b).edges)");
+}
+
+TEST(1)
+{
+  db::Layout layout;
+  db::Shapes flat;
+  make_layout (layout, flat);
+
+  db::Region r1, r2;
+  db::Edges e1, e2;
+  size_t ntasks = 0;
+
+  {
+    db::TilingProcessor tp;
+    setup (tp, layout, flat, r1, e1);
+    tp.execute ("Local");
+    ntasks = tp.tile_statistics ().size ();
+  }
+
+  InProcessLauncher *launcher = new InProcessLauncher ();
+
+  db::TilingProcessor tp;
+  setup (tp, layout, flat, r2, e2);
+  tp.set_processes (3);
+  tp.set_threads (1);
+  tp.set_launcher (launcher);
+  tp.execute ("Processes");
+
+  EXPECT_EQ (launcher->launched (), 3);
+  EXPECT_EQ (ntasks, size_t (2 * 20));
+  EXPECT_EQ (tp.tile_statistics ().size (), ntasks);
+
+  EXPECT_EQ (r1.empty (), false);
+  EXPECT_EQ (r1.area (), r2.area ());
+  EXPECT_EQ ((r1 ^ r2).empty (), true);
+
+  EXPECT_EQ (e1.empty (), false);
+  EXPECT_EQ (e1.length (), e2.length ());
+  EXPECT_EQ ((e1 ^ e2).empty (), true);
+}
+
+TEST(2)
+{
+  db::Layout layout;
+  db::Shapes flat;
+  make_layout (layout, flat);
+
+  db::Region r;
+  db::Edges e;
+
+  //  errors inside the worker are reported back
+  db::TilingProcessor tp;
+  setup (tp, layout, flat, r, e);
+  tp.queue ("_output(o1, a.unknown_method)");
+  tp.set_processes (2);
+  tp.set_launcher (new InProcessLauncher ());
+
+  bool error = false;
+  try {
+    tp.execute ("Processes");
+  } catch (tl::Exception &ex) {
+    error = true;
+    EXPECT_EQ (ex.msg ().find ("unknown_method") != std::string::npos, true);
+  }
+
+  EXPECT_EQ (error, true);
+}
@@ -22,6 +22,9 @@
 
 #include "bdCommon.h"
 #include "dbReader.h"
+#include "dbWriter.h"
+#include "dbSaveLayoutOptions.h"
+#include "dbRegion.h"
 #include "dbTestSupport.h"
 #include "tlLog.h"
 #include "tlUnitTest.h"
@@ -624,3 +627,140 @@ TEST(6_Deep)
     "Layer 10/0 is not present in first layout, but in second\n"
   );
 }
+
+static void write_layout (db::Layout &layout, const std::string &path)
+{
+  db::SaveLayoutOptions options;
+  options.set_format_from_filename (path);
+  tl::OutputStream stream (path);
+  db::Writer writer (options);
+  writer.write (layout, stream);
+}
+
+static db::Region flat_region (const std::string &path, const db::LayerProperties &lp)
+{
+  db::Layout layout;
+  {
+    tl::InputStream stream (path);
+    db::Reader reader (stream);
+    reader.read (layout);
+  }
+
+  db::Region region;
+  for (db::Layout::layer_iterator l = layout.begin_layers (); l != layout.end_layers (); ++l) {
+    if ((*l).second->log_equal (lp)) {
+      for (db::RecursiveShapeIterator si (layout, layout.cell (*layout.begin_top_down ()), (*l).first); ! si.at_end (); ++si) {
+        db::Polygon poly;
+        si->polygon (poly);
+        region.insert (poly.transformed (si.trans ()));
+      }
+    }
+  }
+  return region;
+}
+
+//  hierarchical mode with identical cells
+TEST(7_Deep_IdenticalCells)
+{
+  db::Layout la;
+  unsigned int l1 = la.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = la.insert_layer (db::LayerProperties (2, 0));
+
+  db::cell_index_type top = la.add_cell ("TOP");
+  db::cell_index_type a = la.add_cell ("A");
+  db::cell_index_type b = la.add_cell ("B");
+
+  la.cell (a).shapes (l1).insert (db::Box (0, 0, 100, 200));
+  la.cell (a).shapes (l2).insert (db::Box (10, 10, 90, 190));
+  la.cell (b).shapes (l1).insert (db::Box (0, 0, 300, 100));
+  la.cell (b).shapes (l2).insert (db::Box (0, 0, 200, 100));
+
+  for (int i = 0; i < 10; ++i) {
+    la.cell (top).insert (db::CellInstArray (db::CellInst (a), db::Trans (db::Vector (i * 1000, 0))));
+  }
+  for (int i = 0; i < 5; ++i) {
+    la.cell (top).insert (db::CellInstArray (db::CellInst (b), db::Trans (db::Vector (i * 1000, 5000))));
+  }
+
+  db::Layout lb = la;
+
+  //  B differs on layer 2/0, A is identical, TOP gets an extra shape on layer 1/0
+  lb.cell (b).shapes (l2).clear ();
+  lb.cell (b).shapes (l2).insert (db::Box (0, 0, 250, 100));
+  lb.cell (top).shapes (l1).insert (db::Box (-1000, -1000, -500, -500));
+
+  std::string input_a = this->tmp_file ("a.gds");
+  std::string input_b = this->tmp_file ("b.gds");
+  write_layout (la, input_a);
+  write_layout (lb, input_b);
+
+  std::string output_deep = this->tmp_file ("deep.oas");
+  std::string output_flat = this->tmp_file ("flat.oas");
+
+  {
+    const char *argv[] = { "x", "-u", "--no-summary", input_a.c_str (), input_b.c_str (), output_deep.c_str () };
+    EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 1);
+  }
+
+  {
+    const char *argv[] = { "x", "--no-summary", input_a.c_str (), input_b.c_str (), output_flat.c_str () };
+    EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 1);
+  }
+
+  db::Region deep1 = flat_region (output_deep, db::LayerProperties (1, 0));
+  db::Region deep2 = flat_region (output_deep, db::LayerProperties (2, 0));
+
+  EXPECT_EQ (deep1.merged ().to_string (), "(-1000,-1000;-1000,-500;-500,-500;-500,-1000)");
+  EXPECT_EQ (deep2.area (), 5 * 50 * 100);
+  EXPECT_EQ ((deep1 ^ flat_region (output_flat, db::LayerProperties (1, 0))).empty (), true);
+  EXPECT_EQ ((deep2 ^ flat_region (output_flat, db::LayerProperties (2, 0))).empty (), true);
+
+  //  identical layouts
+  {
+    const char *argv[] = { "x", "-u", "--no-summary", input_a.c_str (), input_a.c_str () };
+    EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 0);
+  }
+}
+
+//  hierarchical mode with shapes overlapping identical cells
+TEST(8_Deep_IdenticalCellsOverlap)
+{
+  db::Layout la;
+  unsigned int l1 = la.insert_layer (db::LayerProperties (1, 0));
+
+  db::cell_index_type top = la.add_cell ("TOP");
+  db::cell_index_type a = la.add_cell ("A");
+
+  la.cell (a).shapes (l1).insert (db::Box (0, 0, 100, 200));
+  for (int i = 0; i < 4; ++i) {
+    la.cell (top).insert (db::CellInstArray (db::CellInst (a), db::Trans (db::Vector (i * 1000, 0))));
+  }
+
+  db::Layout lb = la;
+
+  //  A is identical, but TOP of the second layout has a shape partially covered by an A instance
+  lb.cell (top).shapes (l1).insert (db::Box (50, 50, 150, 150));
+
+  std::string input_a = this->tmp_file ("a.gds");
+  std::string input_b = this->tmp_file ("b.gds");
+  write_layout (la, input_a);
+  write_layout (lb, input_b);
+
+  std::string output_deep = this->tmp_file ("deep.oas");
+  std::string output_flat = this->tmp_file ("flat.oas");
+
+  {
+    const char *argv[] = { "x", "-u", "--no-summary", input_a.c_str (), input_b.c_str (), output_deep.c_str () };
+    EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 1);
+  }
+
+  {
+    const char *argv[] = { "x", "--no-summary", input_a.c_str (), input_b.c_str (), output_flat.c_str () };
+    EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 1);
+  }
+
+  db::Region deep1 = flat_region (output_deep, db::LayerProperties (1, 0));
+
+  EXPECT_EQ (deep1.merged ().to_string (), "(100,50;100,150;150,150;150,50)");
+  EXPECT_EQ ((deep1 ^ flat_region (output_flat, db::LayerProperties (1, 0))).empty (), true);
+}
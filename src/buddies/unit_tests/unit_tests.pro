@@ -15,6 +15,7 @@ SOURCES = \
   bdStrmcmpTests.cc \
   bdStrmxorTests.cc \
   bdStrmrunTests.cc \
+  bdStrmtileTests.cc \
 
 equals(HAVE_RUBY, "1") {
 
@@ -57,6 +57,7 @@ SOURCES = \
   dbPCellVariant.cc \
   dbPoint.cc \
   dbPolygon.cc \
+  dbPolygonArrays.cc \
   dbPolygonTools.cc \
   dbPolygonGenerators.cc \
   dbPropertiesRepository.cc \
@@ -66,6 +67,7 @@ SOURCES = \
   dbRegionLocalOperations.cc \
   dbSaveLayoutOptions.cc \
   dbShape.cc \
+  dbShapeCounts.cc \
   dbShapeFlags.cc \
   dbShapes2.cc \
   dbShapes3.cc \
@@ -169,6 +171,7 @@ SOURCES = \
     dbPin.cc \
     dbLayoutToNetlistReader.cc \
     dbLayoutToNetlistWriter.cc \
+    dbLayoutToNetlistBinaryFile.cc \
     dbLayoutToNetlistFormatDefs.cc \
     dbDeviceAbstract.cc \
     dbLocalOperationUtils.cc \
@@ -265,6 +268,7 @@ HEADERS = \
   dbPCellVariant.h \
   dbPoint.h \
   dbPolygon.h \
+  dbPolygonArrays.h \
   dbPolygonTools.h \
   dbPolygonGenerators.h \
   dbPropertiesRepository.h \
@@ -274,6 +278,7 @@ HEADERS = \
   dbRegionLocalOperations.h \
   dbSaveLayoutOptions.h \
   dbShape.h \
+  dbShapeCounts.h \
   dbShapeFlags.h \
   dbShapeRepository.h \
   dbShapes2.h \
@@ -338,6 +343,7 @@ HEADERS = \
     dbSubCircuit.h \
     dbLayoutToNetlistReader.h \
     dbLayoutToNetlistWriter.h \
+    dbLayoutToNetlistBinaryFile.h \
     dbLayoutToNetlistFormatDefs.h \
     dbDeviceAbstract.h \
     dbLocalOperationUtils.h \
@@ -1154,6 +1154,176 @@ AsIfFlatRegion::inside_check (const Region &other, db::Coord d, const RegionChec
   return run_check (db::InsideRelation, true, &other, d, options);
 }
 
+namespace {
+
+/**
+ *  @brief A task computing the two-polygon check for the subjects of one slab
+ *
+ *  For intra-layer checks, the intruders are the subjects of the slab plus the
+ *  neighbors from other slabs. In that case, the subjects are fed as intruders
+ *  themselves, so the local processor treats them like in the single-threaded
+ *  case and does not report self-interactions.
+ */
+class CheckSlabTask
+  : public db::box_scanner_slab_task
+{
+public:
+  CheckSlabTask (const db::check_local_operation<db::Polygon, db::Polygon> *op, int base_verbosity, bool self, bool foreign, const std::vector<db::Polygon> *subjects, const std::vector<db::Polygon> *intruders, std::vector<db::EdgePair> *result)
+    : mp_op (op), m_base_verbosity (base_verbosity), m_self (self), m_foreign (foreign), mp_subjects (subjects), mp_intruders (intruders), mp_result (result)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void perform ()
+  {
+    db::local_processor<db::Polygon, db::Polygon, db::EdgePair> proc;
+    proc.set_base_verbosity (m_base_verbosity);
+    proc.set_report_progress (false);
+
+    generic_shape_iterator<db::Polygon> subjects (mp_subjects->begin (), mp_subjects->end ());
+
+    std::vector<generic_shape_iterator<db::Polygon> > others;
+    std::vector<bool> foreign;
+    if (m_self) {
+      others.push_back (subjects);
+      foreign.push_back (m_foreign);
+    }
+    others.push_back (generic_shape_iterator<db::Polygon> (mp_intruders->begin (), mp_intruders->end ()));
+    foreign.push_back (false);
+
+    db::Shapes output (false);
+    std::vector<db::Shapes *> results;
+    results.push_back (&output);
+
+    proc.run_flat (subjects, others, foreign, mp_op, results);
+
+    for (db::Shapes::shape_iterator s = output.begin (db::ShapeIterator::EdgePairs); ! s.at_end (); ++s) {
+      mp_result->push_back (s->edge_pair ());
+    }
+  }
+
+private:
+  const db::check_local_operation<db::Polygon, db::Polygon> *mp_op;
+  int m_base_verbosity;
+  bool m_self, m_foreign;
+  const std::vector<db::Polygon> *mp_subjects, *mp_intruders;
+  std::vector<db::EdgePair> *mp_result;
+};
+
+/**
+ *  @brief Runs the two-polygon check in parallel on vertical slabs
+ *
+ *  Every subject is checked by the slab its left edge is in. The slabs receive
+ *  all intruders within the check distance of their subjects, so each subject
+ *  sees the same intruders as in the single-threaded case. Edge pairs produced
+ *  by more than one slab are dropped, keeping the first one in slab order.
+ *  If "other" is null, the check is an intra-layer check.
+ */
+void
+run_check_in_slabs (const db::check_local_operation<db::Polygon, db::Polygon> &op, db::RegionIterator subjects, const db::Region *other, bool foreign, db::Coord d, unsigned int threads, int base_verbosity, db::Shapes &output)
+{
+  std::vector<db::Polygon> polygons;
+  for ( ; ! subjects.at_end (); ++subjects) {
+    polygons.push_back (*subjects);
+  }
+
+  std::vector<db::Polygon> other_polygons;
+  if (other) {
+    for (db::Region::const_iterator p = other->begin (); ! p.at_end (); ++p) {
+      other_polygons.push_back (*p);
+    }
+  }
+
+  std::vector<db::Coord> x;
+  x.reserve (polygons.size ());
+  for (std::vector<db::Polygon>::const_iterator p = polygons.begin (); p != polygons.end (); ++p) {
+    x.push_back (p->box ().left ());
+  }
+
+  //  the slabs are made wide compared to the check distance, so only few intruders are
+  //  shared between slabs
+  db::box_scanner_slabs<db::Coord> slabs (x, threads, d * 8);
+
+  std::vector<std::vector<db::Polygon> > slab_subjects (slabs.size ());
+  std::vector<db::Box> slab_boxes (slabs.size ());
+  for (std::vector<db::Polygon>::const_iterator p = polygons.begin (); p != polygons.end (); ++p) {
+    size_t s = slabs.slab_for (p->box ().left ());
+    slab_subjects [s].push_back (*p);
+    slab_boxes [s] += p->box ();
+  }
+
+  for (std::vector<db::Box>::iterator b = slab_boxes.begin (); b != slab_boxes.end (); ++b) {
+    b->enlarge (db::Vector (d, d));
+  }
+
+  //  for intra-layer checks, the subjects of the slab itself are not included in the intruders
+  std::vector<std::vector<db::Polygon> > slab_intruders (slabs.size ());
+  const std::vector<db::Polygon> &intruders = other ? other_polygons : polygons;
+  for (std::vector<db::Polygon>::const_iterator p = intruders.begin (); p != intruders.end (); ++p) {
+    db::Box b = p->box ();
+    size_t home = other ? slabs.size () : slabs.slab_for (b.left ());
+    for (size_t s = 0; s < slabs.size (); ++s) {
+      if (s != home && b.touches (slab_boxes [s])) {
+        slab_intruders [s].push_back (*p);
+      }
+    }
+  }
+
+  std::vector<std::vector<db::EdgePair> > slab_results (slabs.size ());
+
+  std::vector<db::box_scanner_slab_task *> tasks;
+  for (size_t s = 0; s < slabs.size (); ++s) {
+    if (! slab_subjects [s].empty ()) {
+      tasks.push_back (new CheckSlabTask (&op, base_verbosity, other == 0, foreign, &slab_subjects [s], &slab_intruders [s], &slab_results [s]));
+    }
+  }
+
+  db::run_box_scanner_slab_tasks (tasks, threads);
+
+  std::unordered_set<db::EdgePair> seen;
+  for (std::vector<std::vector<db::EdgePair> >::const_iterator r = slab_results.begin (); r != slab_results.end (); ++r) {
+    for (std::vector<db::EdgePair>::const_iterator ep = r->begin (); ep != r->end (); ++ep) {
+      if (seen.insert (*ep).second) {
+        output.insert (*ep);
+      }
+    }
+  }
+}
+
+/**
+ *  @brief A task computing the single-polygon check for the polygons of one slab
+ */
+class SinglePolygonCheckSlabTask
+  : public db::box_scanner_slab_task
+{
+public:
+  SinglePolygonCheckSlabTask (const db::EdgeRelationFilter *check, const db::RegionCheckOptions *options, const std::vector<std::pair<db::Polygon, size_t> > *polygons, db::Shapes *output)
+    : mp_check (check), mp_options (options), mp_polygons (polygons), mp_output (output)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void perform ()
+  {
+    edge2edge_check_negative_or_positive<db::Shapes> edge_check (*mp_check, *mp_output, mp_options->negative, false /*=same polygons*/, false /*=same layers*/, mp_options->shielded, true /*symmetric edge pairs*/);
+    poly2poly_check<db::Polygon> poly_check (edge_check);
+
+    do {
+      for (std::vector<std::pair<db::Polygon, size_t> >::const_iterator p = mp_polygons->begin (); p != mp_polygons->end (); ++p) {
+        poly_check.enter (p->first, p->second);
+      }
+    } while (edge_check.prepare_next_pass ());
+  }
+
+private:
+  const db::EdgeRelationFilter *mp_check;
+  const db::RegionCheckOptions *mp_options;
+  const std::vector<std::pair<db::Polygon, size_t> > *mp_polygons;
+  db::Shapes *mp_output;
+};
+
+}
+
 EdgePairsDelegate *
 AsIfFlatRegion::run_check (db::edge_relation_type rel, bool different_polygons, const Region *other, db::Coord d, const RegionCheckOptions &options) const
 {
@@ -1189,6 +1359,13 @@ AsIfFlatRegion::run_check (db::edge_relation_type rel, bool different_polygons,
   db::check_local_operation<db::Polygon, db::Polygon> op (check, different_polygons, has_other, other_is_merged, options);
 
   std::unique_ptr<FlatEdgePairs> output (new FlatEdgePairs ());
+
+  //  negative output of two-polygon checks is not split into slabs as it is not local to the subject
+  if (options.threads > 1 && ! options.negative) {
+    run_check_in_slabs (op, polygons, has_other ? other : 0, foreign.front (), d, options.threads, base_verbosity (), output->raw_edge_pairs ());
+    return output.release ();
+  }
+
   std::vector<db::Shapes *> results;
   results.push_back (&output->raw_edge_pairs ());
 
@@ -1257,6 +1434,44 @@ AsIfFlatRegion::run_single_polygon_check (db::edge_relation_type rel, db::Coord
   check.set_min_projection (options.min_projection);
   check.set_max_projection (options.max_projection);
 
+  if (options.threads > 1) {
+
+    //  the polygons are checked independently, so we simply distribute them over the slabs
+
+    std::vector<std::pair<db::Polygon, size_t> > polygons;
+    std::vector<db::Coord> x;
+
+    size_t n = 0;
+    for (RegionIterator p (begin_merged ()); ! p.at_end (); ++p) {
+      polygons.push_back (std::make_pair (*p, n));
+      x.push_back (p->box ().left ());
+      n += 2;
+    }
+
+    db::box_scanner_slabs<db::Coord> slabs (x, options.threads, 0);
+
+    std::vector<std::vector<std::pair<db::Polygon, size_t> > > slab_polygons (slabs.size ());
+    for (std::vector<std::pair<db::Polygon, size_t> >::const_iterator p = polygons.begin (); p != polygons.end (); ++p) {
+      slab_polygons [slabs.slab_for (p->first.box ().left ())].push_back (*p);
+    }
+
+    std::vector<db::Shapes> slab_results (slabs.size (), db::Shapes (false));
+
+    std::vector<db::box_scanner_slab_task *> tasks;
+    for (size_t s = 0; s < slabs.size (); ++s) {
+      tasks.push_back (new SinglePolygonCheckSlabTask (&check, &options, &slab_polygons [s], &slab_results [s]));
+    }
+
+    db::run_box_scanner_slab_tasks (tasks, options.threads);
+
+    for (std::vector<db::Shapes>::const_iterator r = slab_results.begin (); r != slab_results.end (); ++r) {
+      result->raw_edge_pairs ().insert (*r);
+    }
+
+    return result.release ();
+
+  }
+
   edge2edge_check_negative_or_positive<db::FlatEdgePairs> edge_check (check, *result, options.negative, false /*=same polygons*/, false /*=same layers*/, options.shielded, true /*symmetric edge pairs*/);
   poly2poly_check<db::Polygon> poly_check (edge_check);
 
@@ -23,3 +23,66 @@
 
 #include "dbBoxScanner.h"
 
+
+namespace db
+{
+
+namespace
+{
+
+class BoxScannerSlabWorker
+  : public tl::Worker
+{
+public:
+  BoxScannerSlabWorker ()
+    : tl::Worker ()
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<box_scanner_slab_task *> (task)->perform ();
+  }
+};
+
+}
+
+void
+run_box_scanner_slab_tasks (const std::vector<box_scanner_slab_task *> &tasks, unsigned int threads)
+{
+  if (tasks.size () == 1 || threads < 2) {
+
+    //  single task or single thread: execute in the calling thread
+
+    std::vector<box_scanner_slab_task *>::const_iterator t = tasks.begin ();
+
+    try {
+      for ( ; t != tasks.end (); ++t) {
+        (*t)->perform ();
+        delete *t;
+      }
+    } catch (...) {
+      for ( ; t != tasks.end (); ++t) {
+        delete *t;
+      }
+      throw;
+    }
+
+    return;
+
+  }
+
+  tl::Job<BoxScannerSlabWorker> job (int (std::min (threads, (unsigned int) tasks.size ())));
+  for (std::vector<box_scanner_slab_task *>::const_iterator t = tasks.begin (); t != tasks.end (); ++t) {
+    job.schedule (*t);
+  }
+
+  job.start ();
+  job.wait ();
+
+  if (job.has_error ()) {
+    throw tl::Exception (job.error_messages ().front ());
+  }
+}
+
+}
+
@@ -28,6 +28,7 @@
 
 #include "dbBoxConvert.h"
 #include "tlProgress.h"
+#include "tlThreadedWorkers.h"
 
 #include <list>
 #include <vector>
@@ -35,6 +36,7 @@
 #include <set>
 #include <functional>
 #include <memory>
+#include <algorithm>
 
 namespace db
 {
@@ -105,6 +107,103 @@ bool bs_boxes_overlap (const Box &b1, const Box &b2, typename Box::coord_type en
   }
 }
 
+/**
+ *  @brief A partition of the x axis into slabs
+ *
+ *  This object is used by the multi-threaded flat checks. The slabs are derived from
+ *  a set of sample coordinates (usually the left edges of the objects), so that every slab
+ *  receives roughly the same number of samples. Slabs are not made narrower than
+ *  "min_width" - this way, the overlap caused by objects crossing the slab borders stays
+ *  small compared to the slab's width.
+ *
+ *  Slab n covers the half-open interval from boundary n-1 to boundary n. The first
+ *  and the last slab extend to infinity.
+ */
+template <class C>
+class box_scanner_slabs
+{
+public:
+  typedef C coord_type;
+
+  /**
+   *  @brief Creates a single slab
+   */
+  box_scanner_slabs ()
+  {
+    //  .. nothing yet ..
+  }
+
+  /**
+   *  @brief Creates a partition into at most n slabs from the given samples
+   *
+   *  The sample vector will be sorted by this function.
+   */
+  box_scanner_slabs (std::vector<C> &samples, size_t n, C min_width)
+  {
+    if (n < 2 || samples.empty ()) {
+      return;
+    }
+
+    std::sort (samples.begin (), samples.end ());
+
+    C last = samples.front ();
+    for (size_t i = 1; i < n; ++i) {
+      C c = samples [(samples.size () * i) / n];
+      if (c > last && c - last >= min_width && samples.back () - c >= min_width) {
+        m_boundaries.push_back (c);
+        last = c;
+      }
+    }
+  }
+
+  /**
+   *  @brief Gets the number of slabs
+   */
+  size_t size () const
+  {
+    return m_boundaries.size () + 1;
+  }
+
+  /**
+   *  @brief Gets the index of the slab the given coordinate is in
+   */
+  size_t slab_for (C x) const
+  {
+    return size_t (std::upper_bound (m_boundaries.begin (), m_boundaries.end (), x) - m_boundaries.begin ());
+  }
+
+private:
+  std::vector<C> m_boundaries;
+};
+
+/**
+ *  @brief A task of the multi-threaded flat checks
+ *
+ *  Tasks are executed with "run_box_scanner_slab_tasks".
+ */
+class DB_PUBLIC box_scanner_slab_task
+  : public tl::Task
+{
+public:
+  box_scanner_slab_task () { }
+
+  /**
+   *  @brief Performs the task
+   *
+   *  This method is called from the worker threads.
+   */
+  virtual void perform () = 0;
+};
+
+/**
+ *  @brief Executes the given tasks on the given number of threads
+ *
+ *  This function takes over ownership of the tasks. It returns when all tasks have
+ *  been executed. If a task fails with an exception, this function will throw a
+ *  tl::Exception with the message of the first error.
+ */
+DB_PUBLIC void run_box_scanner_slab_tasks (const std::vector<box_scanner_slab_task *> &tasks, unsigned int threads);
+
 /**
  *  @brief A template for the box scanner output receiver
  *
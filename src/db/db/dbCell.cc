@@ -187,6 +187,24 @@ Cell::clear (unsigned int index)
   }
 }
 
+void
+Cell::compact_polygons ()
+{
+  tl::Arena *arena = mp_layout ? &mp_layout->polygon_arena () : 0;
+  for (shapes_map::iterator s = m_shapes_map.begin (); s != m_shapes_map.end (); ++s) {
+    s->second.compact_polygons (arena);
+  }
+}
+
+void
+Cell::compact_polygons (unsigned int index)
+{
+  shapes_map::iterator s = m_shapes_map.find (index);
+  if (s != m_shapes_map.end ()) {
+    s->second.compact_polygons (mp_layout ? &mp_layout->polygon_arena () : 0);
+  }
+}
+
 Cell::shapes_type &
 Cell::shapes (unsigned int index) 
 {
@@ -199,6 +199,19 @@ public:
    */
   void clear (unsigned int index);
 
+  /**
+   *  @brief Converts the polygons on all layers into the compact representation
+   *
+   *  See Shapes::compact_polygons for details. The storage is taken from the
+   *  layout's polygon arena if the cell lives inside a layout.
+   */
+  void compact_polygons ();
+
+  /**
+   *  @brief Converts the polygons on the given layer into the compact representation
+   */
+  void compact_polygons (unsigned int index);
+
   /** 
    *  @brief Erase a cell instance given by a instance proxy
    *
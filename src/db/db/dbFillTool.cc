@@ -27,6 +27,9 @@
 #include "dbRegion.h"
 #include "dbCell.h"
 #include "tlIntervalMap.h"
+#include "tlThreadedWorkers.h"
+
+#include <map>
 
 namespace db
 {
@@ -382,9 +385,16 @@ rasterize_extended (const db::Polygon &fp, const db::Box &fc_bbox, db::AreaMap &
   return true;
 }
 
-DB_PUBLIC bool 
-fill_region (db::Cell *cell, const db::Polygon &fp0, db::cell_index_type fill_cell_index, const db::Box &fc_bbox, const db::Point &origin, bool enhanced_fill, 
-             std::vector <db::Polygon> *remaining_parts, const db::Vector &fill_margin)
+/**
+ *  @brief Computes the fill cell arrays for a single polygon
+ *
+ *  The arrays are delivered in "arrays" rather than being inserted into a cell, so this function
+ *  can be used from multiple threads. Runs of fill sites which are identical in adjacent columns
+ *  are combined into two-dimensional arrays.
+ */
+static bool
+fill_polygon_impl (const db::Polygon &fp0, db::cell_index_type fill_cell_index, const db::Box &fc_bbox, const db::Point &origin, bool enhanced_fill,
+                   std::vector<db::CellInstArray> &arrays, std::vector <db::Polygon> *remaining_parts, const db::Vector &fill_margin)
 {
   std::vector <db::Polygon> filled_regions;
   db::EdgeProcessor ep;
@@ -431,10 +441,15 @@ fill_region (db::Cell *cell, const db::Polygon &fp0, db::cell_index_type fill_ce
 
       db::AreaMap::area_type amax = am.pixel_area ();
 
+      //  vertical runs of the previous columns: (first row, end row) -> first column
+      std::map<std::pair<size_t, size_t>, size_t> open_runs, next_runs;
+
       //  Create the fill cell instances
-      for (size_t i = 0; i < nx; ++i) {
+      for (size_t i = 0; i <= nx; ++i) {
+
+        next_runs.clear ();
 
-        for (size_t j = 0; j < ny; ) {
+        for (size_t j = 0; i < nx && j < ny; ) {
 
           size_t jj = j + 1;
           if (am.get (i, j) >= amax) {
@@ -445,31 +460,50 @@ fill_region (db::Cell *cell, const db::Polygon &fp0, db::cell_index_type fill_ce
 
             ninsts += (jj - j);
 
-            db::Vector p0 (am.p0 () - fc_bbox.p1 ());
-            p0 += db::Vector (db::Coord (i) * fc_bbox.width (), db::Coord (j) * fc_bbox.height ());
-
-            db::CellInstArray array;
-
-            if (jj > j + 1) {
-              array = db::CellInstArray (db::CellInst (fill_cell_index), db::Trans (p0), db::Vector (0, fc_bbox.height ()), db::Vector (fc_bbox.width (), 0), (unsigned long) (jj - j), 1);
+            std::pair<size_t, size_t> run (j, jj);
+            std::map<std::pair<size_t, size_t>, size_t>::iterator r = open_runs.find (run);
+            if (r != open_runs.end ()) {
+              next_runs.insert (*r);
+              open_runs.erase (r);
             } else {
-              array = db::CellInstArray (db::CellInst (fill_cell_index), db::Trans (p0));
+              next_runs.insert (std::make_pair (run, i));
             }
 
-            cell->insert (array);
+          }
 
-            if (remaining_parts) {
-              db::Box filled_box = array.raw_bbox () * fc_bbox; 
-              filled_regions.push_back (db::Polygon (filled_box.enlarged (fill_margin)));
-            }
-            any_fill = true;
+          j = jj;
+
+        }
 
+        //  runs not continued in this column are turned into arrays
+        for (std::map<std::pair<size_t, size_t>, size_t>::const_iterator r = open_runs.begin (); r != open_runs.end (); ++r) {
+
+          size_t j = r->first.first, jj = r->first.second;
+          size_t i0 = r->second;
+
+          db::Vector p0 (am.p0 () - fc_bbox.p1 ());
+          p0 += db::Vector (db::Coord (i0) * fc_bbox.width (), db::Coord (j) * fc_bbox.height ());
+
+          db::CellInstArray array;
+
+          if (jj > j + 1 || i > i0 + 1) {
+            array = db::CellInstArray (db::CellInst (fill_cell_index), db::Trans (p0), db::Vector (0, fc_bbox.height ()), db::Vector (fc_bbox.width (), 0), (unsigned long) (jj - j), (unsigned long) (i - i0));
+          } else {
+            array = db::CellInstArray (db::CellInst (fill_cell_index), db::Trans (p0));
           }
 
-          j = jj;
+          arrays.push_back (array);
+
+          if (remaining_parts) {
+            db::Box filled_box = array.raw_bbox () * fc_bbox;
+            filled_regions.push_back (db::Polygon (filled_box.enlarged (fill_margin)));
+          }
+          any_fill = true;
 
         }
 
+        open_runs.swap (next_runs);
+
       }
 
     }
@@ -496,18 +530,195 @@ fill_region (db::Cell *cell, const db::Polygon &fp0, db::cell_index_type fill_ce
   }
 }
 
+DB_PUBLIC bool
+fill_region (db::Cell *cell, const db::Polygon &fp0, db::cell_index_type fill_cell_index, const db::Box &fc_bbox, const db::Point &origin, bool enhanced_fill,
+             std::vector <db::Polygon> *remaining_parts, const db::Vector &fill_margin)
+{
+  std::vector<db::CellInstArray> arrays;
+  if (! fill_polygon_impl (fp0, fill_cell_index, fc_bbox, origin, enhanced_fill, arrays, remaining_parts, fill_margin)) {
+    return false;
+  }
+
+  for (std::vector<db::CellInstArray>::const_iterator a = arrays.begin (); a != arrays.end (); ++a) {
+    cell->insert (*a);
+  }
+
+  return true;
+}
+
+namespace
+{
+
+/**
+ *  @brief The fill result for one distinct polygon
+ */
+struct FillResult
+{
+  FillResult () : any_fill (false) { }
+
+  bool any_fill;
+  std::vector<db::CellInstArray> arrays;
+  std::vector<db::Polygon> remaining_parts;
+};
+
+/**
+ *  @brief The parameters shared by all fill tasks
+ */
+struct FillParameters
+{
+  db::cell_index_type fill_cell_index;
+  db::Box fc_bbox;
+  db::Point origin;
+  bool enhanced_fill;
+  bool with_remaining_parts;
+  db::Vector fill_margin;
+};
+
+static void
+fill_polygon (const FillParameters &params, const db::Polygon &fp, FillResult &result)
+{
+  result.any_fill = fill_polygon_impl (fp, params.fill_cell_index, params.fc_bbox, params.origin, params.enhanced_fill, result.arrays, params.with_remaining_parts ? &result.remaining_parts : 0, params.fill_margin);
+}
+
+class FillTask
+  : public tl::Task
+{
+public:
+  FillTask (const FillParameters *params, const db::Polygon *polygon, FillResult *result)
+    : mp_params (params), mp_polygon (polygon), mp_result (result)
+  { }
+
+  void perform ()
+  {
+    fill_polygon (*mp_params, *mp_polygon, *mp_result);
+  }
+
+private:
+  const FillParameters *mp_params;
+  const db::Polygon *mp_polygon;
+  FillResult *mp_result;
+};
+
+class FillWorker
+  : public tl::Worker
+{
+public:
+  FillWorker ()
+    : tl::Worker ()
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<FillTask *> (task)->perform ();
+  }
+};
+
+/**
+ *  @brief Gets the largest multiple of d (plus offset o) which is less or equal to x
+ */
+static db::Coord
+snap_down (db::Coord x, db::Coord o, db::Coord d)
+{
+  db::Coord n = (x - o) / d;
+  if (n * d > x - o) {
+    --n;
+  }
+  return n * d + o;
+}
+
+}
+
 DB_PUBLIC void
-fill_region (db::Cell *cell, const db::Region &fr, db::cell_index_type fill_cell_index, const db::Box &fc_box, const db::Point &origin, bool enhanced_fill, 
-             db::Region *remaining_parts, const db::Vector &fill_margin, db::Region *remaining_polygons)
+fill_region (db::Cell *cell, const db::Region &fr, db::cell_index_type fill_cell_index, const db::Box &fc_box, const db::Point &origin, bool enhanced_fill,
+             db::Region *remaining_parts, const db::Vector &fill_margin, db::Region *remaining_polygons, unsigned int threads)
 {
-  std::vector<db::Polygon> rem_pp, rem_poly;
+  FillParameters params;
+  params.fill_cell_index = fill_cell_index;
+  params.fc_bbox = fc_box;
+  params.origin = origin;
+  params.enhanced_fill = enhanced_fill;
+  params.with_remaining_parts = (remaining_parts != 0);
+  params.fill_margin = fill_margin;
+
+  //  The fill result does not change if a polygon is shifted by a multiple of the fill raster
+  //  (or by any vector in enhanced mode). Hence polygons are normalized and identical ones
+  //  - for example from repeated cells of a hierarchical region - are filled only once.
+
+  std::vector<db::Polygon> distinct_polygons;
+  std::map<db::Polygon, size_t> polygon_index;
+  std::vector<std::pair<size_t, db::Vector> > polygon_refs;
 
   for (db::Region::const_iterator p = fr.begin_merged (); !p.at_end (); ++p) {
-    if (!fill_region (cell, *p, fill_cell_index, fc_box, origin, enhanced_fill, remaining_parts ? &rem_pp : 0, fill_margin)) {
-      if (remaining_polygons) {
-        rem_poly.push_back (*p);
+
+    db::Point p1 = p->box ().p1 ();
+    db::Vector shift;
+    if (enhanced_fill) {
+      shift = p1 - db::Point ();
+    } else {
+      shift = db::Point (snap_down (p1.x (), origin.x (), fc_box.width ()), snap_down (p1.y (), origin.y (), fc_box.height ())) - origin;
+    }
+
+    db::Polygon pn = p->moved (-shift);
+    std::map<db::Polygon, size_t>::const_iterator pi = polygon_index.find (pn);
+    if (pi == polygon_index.end ()) {
+      pi = polygon_index.insert (std::make_pair (pn, distinct_polygons.size ())).first;
+      distinct_polygons.push_back (pn);
+    }
+
+    polygon_refs.push_back (std::make_pair (pi->second, shift));
+
+  }
+
+  polygon_index.clear ();
+
+  std::vector<FillResult> results (distinct_polygons.size ());
+
+  if (threads > 0 && distinct_polygons.size () > 1) {
+
+    tl::Job<FillWorker> job (int (std::min (size_t (threads), distinct_polygons.size ())));
+    for (size_t i = 0; i < distinct_polygons.size (); ++i) {
+      job.schedule (new FillTask (&params, &distinct_polygons [i], &results [i]));
+    }
+
+    job.start ();
+    job.wait ();
+
+    if (job.has_error ()) {
+      throw tl::Exception (job.error_messages ().front ());
+    }
+
+  } else {
+
+    for (size_t i = 0; i < distinct_polygons.size (); ++i) {
+      fill_polygon (params, distinct_polygons [i], results [i]);
+    }
+
+  }
+
+  //  produce the output in the order of the input polygons
+
+  std::vector<db::Polygon> rem_pp, rem_poly;
+
+  for (std::vector<std::pair<size_t, db::Vector> >::const_iterator r = polygon_refs.begin (); r != polygon_refs.end (); ++r) {
+
+    const FillResult &result = results [r->first];
+
+    if (result.any_fill) {
+
+      for (std::vector<db::CellInstArray>::const_iterator a = result.arrays.begin (); a != result.arrays.end (); ++a) {
+        db::CellInstArray array = *a;
+        array.move (r->second);
+        cell->insert (array);
+      }
+
+      for (std::vector<db::Polygon>::const_iterator p = result.remaining_parts.begin (); p != result.remaining_parts.end (); ++p) {
+        rem_pp.push_back (p->moved (r->second));
       }
+
+    } else if (remaining_polygons) {
+      rem_poly.push_back (distinct_polygons [r->first].moved (r->second));
     }
+
   }
 
   if (remaining_parts == &fr) {
@@ -59,11 +59,16 @@ fill_region (db::Cell *cell, const db::Polygon &fp, db::cell_index_type fill_cel
  *  remaining_parts (if non-null) will receive the non-filled parts of partially filled polygons. 
  *  fill_margin will specify the margin around the filled area when computing (through subtraction of the tiled area) the remaining_parts.
  *  remaining_polygons (if non-null) will receive the polygons which could not be filled at all.
+ *
+ *  Polygons which are identical up to a shift by the fill raster (or any shift if enhanced_fill is true)
+ *  are filled only once. This specifically applies to the polygons of repeated cells in hierarchical regions.
+ *  If threads is larger than 0, the distinct polygons are filled in parallel using the given number of threads.
+ *  The fill cell instances are inserted into the cell in the order of the input polygons in any case.
  */
 
 DB_PUBLIC void
 fill_region (db::Cell *cell, const db::Region &fr, db::cell_index_type fill_cell_index, const db::Box &fc_box, const db::Point &origin, bool enhanced_fill, 
-             db::Region *remaining_parts = 0, const db::Vector &fill_margin = db::Vector (), db::Region *remaining_polygons = 0);
+             db::Region *remaining_parts = 0, const db::Vector &fill_margin = db::Vector (), db::Region *remaining_polygons = 0, unsigned int threads = 0);
 
 }
 
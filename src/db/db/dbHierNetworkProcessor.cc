@@ -719,6 +719,16 @@ local_clusters<T>::cluster_by_id (typename local_cluster<T>::id_type id) const
   }
 }
 
+template <class T>
+local_cluster<T> &
+local_clusters<T>::cluster_by_id_for_update (typename local_cluster<T>::id_type id)
+{
+  tl_assert (id > 0 && id <= m_clusters.size ());
+
+  m_needs_update = true;
+  return const_cast<local_cluster<T> &> (m_clusters.objects ().item (id - 1));
+}
+
 template <class T>
 void
 local_clusters<T>::remove_cluster (typename local_cluster<T>::id_type id)
@@ -435,6 +435,14 @@ public:
    */
   const local_cluster<T> &cluster_by_id (typename local_cluster<T>::id_type id) const;
 
+  /**
+   *  @brief Gets the cluster by ID for modification
+   *
+   *  The collection is re-sorted on the next access, so shapes can be added to the
+   *  cluster returned.
+   */
+  local_cluster<T> &cluster_by_id_for_update (typename local_cluster<T>::id_type id);
+
   /**
    *  @brief Clears the clusters
    */
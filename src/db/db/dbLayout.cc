@@ -355,7 +355,8 @@ Layout::Layout (db::Manager *manager)
     m_guiding_shape_layer (-1),
     m_waste_layer (-1),
     m_do_cleanup (false),
-    m_editable (db::default_editable_mode ())
+    m_editable (db::default_editable_mode ()),
+    m_compact_polygon_mode (false)
 {
   // .. nothing yet ..
 }
@@ -371,7 +372,8 @@ Layout::Layout (bool editable, db::Manager *manager)
     m_guiding_shape_layer (-1),
     m_waste_layer (-1),
     m_do_cleanup (false),
-    m_editable (editable)
+    m_editable (editable),
+    m_compact_polygon_mode (false)
 {
   // .. nothing yet ..
 }
@@ -391,7 +393,8 @@ Layout::Layout (const db::Layout &layout)
     m_guiding_shape_layer (-1),
     m_waste_layer (-1),
     m_do_cleanup (false),
-    m_editable (layout.m_editable)
+    m_editable (layout.m_editable),
+    m_compact_polygon_mode (false)
 {
   *this = layout;
 }
@@ -443,6 +446,9 @@ Layout::clear ()
   m_cell_map.clear ();
 
   m_shape_repository = db::GenericRepository ();
+  if (m_compact_polygon_mode) {
+    m_shape_repository.set_polygon_arena (&m_polygon_arena);
+  }
   db::PropertiesRepository empty_pr (this);
   m_properties_repository = empty_pr;
   m_array_repository = db::ArrayRepository ();
@@ -458,6 +464,18 @@ Layout::clear ()
 
   m_lib_proxy_map.clear ();
   m_meta_info.clear ();
+
+  //  all polygons of the layout are gone now, so the arena can be released - unless undo
+  //  operations may still hold polygons from it (e.g. cleared layers or deleted cells).
+  //  In that case the arena is kept until the layout is destroyed.
+  if (! manager () || ! (manager ()->transacting () || manager ()->replaying () || manager ()->available_undo ().first || manager ()->available_redo ().first)) {
+    m_polygon_arena.clear ();
+  }
+
+  tl::MutexLocker locker (&m_shape_counts_lock);
+  m_shape_counts.clear ();
+  m_flat_shape_counts.clear ();
+  m_cell_multiplicities.clear ();
 }
 
 Layout &
@@ -473,6 +491,9 @@ Layout::operator= (const Layout &d)
     m_waste_layer = d.m_waste_layer;
     m_editable = d.m_editable;
 
+    m_compact_polygon_mode = d.m_compact_polygon_mode;
+    m_shape_repository.set_polygon_arena (m_compact_polygon_mode ? &m_polygon_arena : 0);
+
     m_pcell_ids = d.m_pcell_ids;
     m_pcells.reserve (d.m_pcells.size ());
 
@@ -729,6 +750,11 @@ Layout::mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat
   db::mem_stat (stat, purpose, cat, m_properties_repository, true, (void *) this);
   db::mem_stat (stat, purpose, cat, m_array_repository, true, (void *) this);
 
+  //  the arena's chunks are reported by the polygons - here we only report the unused part
+  if (m_polygon_arena.capacity () > m_polygon_arena.used ()) {
+    stat->add (typeid (tl::Arena), (void *) &m_polygon_arena, m_polygon_arena.capacity () - m_polygon_arena.used (), 0, (void *) this, purpose, cat);
+  }
+
   for (std::vector<const char *>::const_iterator i = m_cell_names.begin (); i != m_cell_names.end (); ++i) {
     stat->add (typeid (char []), (void *) *i, *i ? (strlen (*i) + 1) : 0, *i ? (strlen (*i) + 1) : 0, (void *) this, purpose, cat);
   }
@@ -836,8 +862,9 @@ Layout::delete_cells (const std::set<cell_index_type> &cells_to_delete)
 
     if (manager () && manager ()->transacting ()) {
        
-      //  note the "take" method - this takes out the cell
-      manager ()->queue (this, new NewRemoveCellOp (*c, cell_name (*c), true /*remove*/, take_cell (*c)));
+      //  note the "take" method - this takes out the cell (and its name, hence the name is taken first)
+      std::string cn (cell_name (*c));
+      manager ()->queue (this, new NewRemoveCellOp (*c, cn, true /*remove*/, take_cell (*c)));
 
     } else {
 
@@ -904,8 +931,9 @@ Layout::delete_cell (cell_index_type id)
 
   if (manager () && manager ()->transacting ()) {
      
-    //  not the "take" method - this takes out the cell
-    manager ()->queue (this, new NewRemoveCellOp (id, cell_name (id), true /*remove*/, take_cell (id)));
+    //  not the "take" method - this takes out the cell (and its name, hence the name is taken first)
+    std::string cn (cell_name (id));
+    manager ()->queue (this, new NewRemoveCellOp (id, cn, true /*remove*/, take_cell (id)));
 
   } else {
 
@@ -1541,6 +1569,10 @@ Layout::allocate_new_cell ()
   } else {
     new_index = m_free_cell_indices.back ();
     m_free_cell_indices.pop_back ();
+    //  drop whatever has been cached for the previous owner of this index
+    tl::MutexLocker locker (&m_shape_counts_lock);
+    m_shape_counts.erase (m_shape_counts.lower_bound (std::make_pair (new_index, (unsigned int) 0)),
+                          m_shape_counts.lower_bound (std::make_pair (new_index + 1, (unsigned int) 0)));
   }
 
   ++m_cells_size;
@@ -1662,6 +1694,221 @@ Layout::update () const
   }
 }
 
+db::ShapeCounts
+Layout::shape_counts (cell_index_type cell_index, unsigned int layer) const
+{
+  update ();
+
+  db::ShapeCounts counts;
+  get_shape_counts (cell_index, layer, counts);
+  return counts;
+}
+
+bool
+Layout::get_shape_counts (cell_index_type cell_index, unsigned int layer, db::ShapeCounts &counts) const
+{
+  const db::Shapes &shapes = cell (cell_index).shapes (layer);
+  if (shapes.empty ()) {
+    return ! shapes.is_dirty ();
+  }
+
+  std::pair<cell_index_type, unsigned int> key (cell_index, layer);
+
+  {
+    tl::MutexLocker locker (&m_shape_counts_lock);
+    std::map<std::pair<cell_index_type, unsigned int>, db::ShapeCounts>::const_iterator sc = m_shape_counts.find (key);
+    if (sc != m_shape_counts.end ()) {
+      counts += sc->second;
+      return true;
+    }
+  }
+
+  db::ShapeCounts sc;
+  shapes.count_shapes (sc);
+  counts += sc;
+
+  //  A dirty shape container will not report further changes, so we cannot cache the
+  //  counts in this case.
+  if (shapes.is_dirty ()) {
+    return false;
+  }
+
+  tl::MutexLocker locker (&m_shape_counts_lock);
+  m_shape_counts.insert (std::make_pair (key, sc));
+  return true;
+}
+
+size_t
+Layout::flat_shape_count (cell_index_type cell_index, unsigned int layer) const
+{
+  update ();
+
+  if (! hier_dirty ()) {
+    tl::MutexLocker locker (&m_shape_counts_lock);
+    std::map<unsigned int, std::vector<size_t> >::const_iterator fc = m_flat_shape_counts.find (layer);
+    if (fc != m_flat_shape_counts.end ()) {
+      return cell_index < fc->second.size () ? fc->second [cell_index] : 0;
+    }
+  }
+
+  std::vector<size_t> fc = flat_shape_counts (layer);
+  return cell_index < fc.size () ? fc [cell_index] : 0;
+}
+
+std::vector<size_t>
+Layout::flat_shape_counts (unsigned int layer) const
+{
+  update ();
+
+  //  NOTE: the cached vector is copied while the lock is held, as another thread may drop it
+  if (! hier_dirty ()) {
+    tl::MutexLocker locker (&m_shape_counts_lock);
+    std::map<unsigned int, std::vector<size_t> >::const_iterator fc = m_flat_shape_counts.find (layer);
+    if (fc != m_flat_shape_counts.end ()) {
+      return fc->second;
+    }
+  }
+
+  bool cacheable = ! hier_dirty ();
+
+  //  a single bottom-up pass: the child cells are always computed before their parents
+  std::vector<size_t> flat;
+  flat.resize (cells (), 0);
+
+  for (bottom_up_const_iterator c = begin_bottom_up (); c != end_bottom_up (); ++c) {
+
+    if (! is_valid_cell_index (*c)) {
+      continue;
+    }
+
+    db::ShapeCounts sc;
+    if (! get_shape_counts (*c, layer, sc)) {
+      cacheable = false;
+    }
+
+    size_t n = sc.total ();
+
+    const db::Cell &cc = cell (*c);
+    for (db::Cell::const_iterator i = cc.begin (); ! i.at_end (); ++i) {
+      n += i->cell_inst ().size () * flat [i->cell_index ()];
+    }
+
+    flat [*c] = n;
+
+  }
+
+  if (cacheable) {
+    tl::MutexLocker locker (&m_shape_counts_lock);
+    m_flat_shape_counts.insert (std::make_pair (layer, flat));
+  }
+
+  return flat;
+}
+
+size_t
+Layout::cell_multiplicity (cell_index_type cell_index) const
+{
+  update ();
+
+  if (! hier_dirty ()) {
+    tl::MutexLocker locker (&m_shape_counts_lock);
+    if (! m_cell_multiplicities.empty ()) {
+      return cell_index < m_cell_multiplicities.size () ? m_cell_multiplicities [cell_index] : 0;
+    }
+  }
+
+  std::vector<size_t> m = get_cell_multiplicities ();
+  return cell_index < m.size () ? m [cell_index] : 0;
+}
+
+std::vector<size_t>
+Layout::get_cell_multiplicities () const
+{
+  update ();
+
+  //  NOTE: the cached vector is copied while the lock is held, as another thread may drop it
+  if (! hier_dirty ()) {
+    tl::MutexLocker locker (&m_shape_counts_lock);
+    if (! m_cell_multiplicities.empty ()) {
+      return m_cell_multiplicities;
+    }
+  }
+
+  //  a single top-down pass: the parents are always computed before their children
+  std::vector<size_t> mult;
+  mult.resize (cells (), 0);
+
+  for (top_down_const_iterator c = begin_top_down (); c != end_top_cells (); ++c) {
+    mult [*c] = 1;
+  }
+
+  for (top_down_const_iterator c = begin_top_down (); c != end_top_down (); ++c) {
+    size_t m = mult [*c];
+    if (m > 0 && is_valid_cell_index (*c)) {
+      const db::Cell &cc = cell (*c);
+      for (db::Cell::const_iterator i = cc.begin (); ! i.at_end (); ++i) {
+        mult [i->cell_index ()] += m * i->cell_inst ().size ();
+      }
+    }
+  }
+
+  if (! hier_dirty () && ! mult.empty ()) {
+    tl::MutexLocker locker (&m_shape_counts_lock);
+    if (m_cell_multiplicities.empty ()) {
+      m_cell_multiplicities = mult;
+    }
+  }
+
+  return mult;
+}
+
+db::ShapeCounts
+Layout::shape_counts (unsigned int layer, bool flat) const
+{
+  update ();
+
+  std::vector<size_t> mult;
+  if (flat) {
+    mult = get_cell_multiplicities ();
+  }
+
+  db::ShapeCounts counts;
+
+  for (const_iterator c = begin (); c != end (); ++c) {
+
+    if (flat && mult [c->cell_index ()] == 0) {
+      continue;
+    }
+
+    db::ShapeCounts sc;
+    get_shape_counts (c->cell_index (), layer, sc);
+
+    if (flat) {
+      sc *= mult [c->cell_index ()];
+    }
+    counts += sc;
+
+  }
+
+  return counts;
+}
+
+void
+Layout::invalidate_shape_counts (cell_index_type cell_index, unsigned int layer)
+{
+  tl::MutexLocker locker (&m_shape_counts_lock);
+  m_shape_counts.erase (std::make_pair (cell_index, layer));
+  m_flat_shape_counts.erase (layer);
+}
+
+void
+Layout::clear_flat_shape_counts ()
+{
+  tl::MutexLocker locker (&m_shape_counts_lock);
+  m_flat_shape_counts.clear ();
+  m_cell_multiplicities.clear ();
+}
+
 void 
 Layout::do_update ()
 {
@@ -1679,6 +1926,7 @@ Layout::do_update ()
     //  if the hierarchy has been changed so far, update
     //  the hierarchy management information
     if (hier_dirty ()) {
+      clear_flat_shape_counts ();
       {
         tl::SelfTimer timer (tl::verbosity () > layout_base_verbosity + 10, "Updating relations");
         pr->set_desc (tl::to_string (tr ("Updating relations")));
@@ -1851,6 +2099,36 @@ Layout::clear_layer (unsigned int n)
   }
 }
 
+void
+Layout::compact_polygons ()
+{
+  for (iterator c = begin (); c != end (); ++c) {
+    c->compact_polygons ();
+  }
+}
+
+void
+Layout::compact_polygons (unsigned int n)
+{
+  tl_assert (n < layers () && m_layer_states [n] != Free);
+
+  for (iterator c = begin (); c != end (); ++c) {
+    c->compact_polygons (n);
+  }
+}
+
+void
+Layout::set_compact_polygon_mode (bool f)
+{
+  if (f != m_compact_polygon_mode) {
+    m_compact_polygon_mode = f;
+    m_shape_repository.set_polygon_arena (f ? &m_polygon_arena : 0);
+    if (f) {
+      compact_polygons ();
+    }
+  }
+}
+
 void 
 Layout::delete_layer (unsigned int n)
 {
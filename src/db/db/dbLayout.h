@@ -31,6 +31,7 @@
 #include "dbObject.h"
 #include "dbText.h"
 #include "dbCell.h"
+#include "dbShapeCounts.h"
 #include "dbLayoutStateModel.h"
 #include "dbLayerProperties.h"
 #include "dbMetaInfo.h"
@@ -41,6 +42,7 @@
 #include "tlThreads.h"
 #include "tlObject.h"
 #include "tlUniqueId.h"
+#include "tlArena.h"
 #include "gsi.h"
 
 #include <cstring>
@@ -640,6 +642,17 @@ public:
     return m_shape_repository;
   }
 
+  /**
+   *  @brief Accessor to the polygon arena
+   *
+   *  The arena provides the storage for compact polygons (see compact_polygons).
+   *  It is released as a whole when the layout is cleared or destroyed.
+   */
+  tl::Arena &polygon_arena ()
+  {
+    return m_polygon_arena;
+  }
+
   /**
    *  @brief Accessor to the properties repository
    */
@@ -1359,6 +1372,59 @@ public:
    */
   void clear_layer (unsigned int n);
 
+  /**
+   *  @brief Converts the polygons of all layers into the compact representation
+   *
+   *  The compact representation stores the polygon points as variable-length
+   *  deltas which typically needs a fraction of the memory. Polygons in compact
+   *  representation are intended for read-only use such as viewing: point access
+   *  is somewhat slower and modifications convert the polygons back into the normal
+   *  representation. The geometry is not changed by this operation.
+   *
+   *  The storage of the compact polygons is taken from the layout's polygon arena.
+   *  Hence, neither allocating nor releasing it involves individual heap operations
+   *  per polygon. Polygons copied out of the layout use the heap again.
+   *
+   *  This method must not be called while the layout is accessed by other threads
+   *  (i.e. while it is drawn).
+   */
+  void compact_polygons ();
+
+  /**
+   *  @brief Converts the polygons of the given layer into the compact representation
+   *
+   *  See the other version of this method for details. As polygon references
+   *  share their polygons through the shape repository, identical polygons on
+   *  other layers may become compact as well.
+   */
+  void compact_polygons (unsigned int n);
+
+  /**
+   *  @brief Enables or disables the compact polygon mode
+   *
+   *  In compact polygon mode, polygons are converted into the compact representation
+   *  with storage from the layout's polygon arena as they enter the layout - i.e. when
+   *  stream readers insert them. This avoids holding the full representation of all
+   *  polygons at any time. Enabling the mode also compacts the polygons already present.
+   *  Disabling the mode does not expand the polygons again.
+   *
+   *  The mode applies to the layout as a whole: polygon references share their
+   *  polygons across layers through the shape repository. Use compact_polygons (n)
+   *  for a one-time conversion of a single layer.
+   *
+   *  Only shapes inserted individually (Shapes::insert with a single shape) are
+   *  compacted on insert. The same threading restrictions as for compact_polygons apply.
+   */
+  void set_compact_polygon_mode (bool f);
+
+  /**
+   *  @brief Gets a value indicating whether the compact polygon mode is enabled
+   */
+  bool compact_polygon_mode () const
+  {
+    return m_compact_polygon_mode;
+  }
+
   /**  
    *  @brief Delete a layer
    *
@@ -1608,6 +1674,64 @@ public:
    */
   void force_update ();
 
+  /**
+   *  @brief Gets the shape counts for the given cell and layer
+   *
+   *  The counts are computed once and cached. The cache entry is dropped when the
+   *  shapes of that cell and layer are modified.
+   */
+  db::ShapeCounts shape_counts (cell_index_type cell_index, unsigned int layer) const;
+
+  /**
+   *  @brief Gets the total number of shapes for the given cell and layer
+   *
+   *  Array members are counted individually. This is a shortcut for "shape_counts (cell_index, layer).total ()".
+   */
+  size_t shape_count (cell_index_type cell_index, unsigned int layer) const
+  {
+    return shape_counts (cell_index, layer).total ();
+  }
+
+  /**
+   *  @brief Gets the "as if flat" number of shapes for the given cell and layer
+   *
+   *  This number includes the shapes of the child cells, counted as often as they are
+   *  placed (array instances count with their number of members).
+   *  The flat counts for all cells are computed in a single bottom-up pass and
+   *  are cached per layer until the hierarchy or the shapes on this layer change.
+   */
+  size_t flat_shape_count (cell_index_type cell_index, unsigned int layer) const;
+
+  /**
+   *  @brief Gets the "as if flat" number of shapes for all cells on the given layer
+   *
+   *  The vector is indexed by cell index. Use this method instead of "flat_shape_count"
+   *  if the counts of many cells are required.
+   */
+  std::vector<size_t> flat_shape_counts (unsigned int layer) const;
+
+  /**
+   *  @brief Gets the shape counts for the given layer summed over all cells
+   *
+   *  If "flat" is true, each cell contributes as many times as it is seen from the top cells.
+   *  Otherwise each cell contributes once.
+   */
+  db::ShapeCounts shape_counts (unsigned int layer, bool flat) const;
+
+  /**
+   *  @brief Gets the number of flat placements of the given cell seen from the top cells
+   *
+   *  Top cells have a multiplicity of 1. The values are cached until the hierarchy changes.
+   */
+  size_t cell_multiplicity (cell_index_type cell_index) const;
+
+  /**
+   *  @brief Drops the cached shape counts for the given cell and layer
+   *
+   *  This method is called by the shape containers when they are modified.
+   */
+  void invalidate_shape_counts (cell_index_type cell_index, unsigned int layer);
+
   /**
    *  @brief Cleans up the layout
    *
@@ -1843,6 +1967,8 @@ protected:
 private:
   enum LayerState { Normal, Free, Special };
 
+  //  NOTE: the arena needs to be destroyed after the cells and the shape repository
+  tl::Arena m_polygon_arena;
   cell_list m_cells;
   size_t m_cells_size;
   cell_ptr_vector m_cell_ptrs;
@@ -1868,9 +1994,18 @@ private:
   int m_waste_layer;
   bool m_do_cleanup;
   bool m_editable;
+  bool m_compact_polygon_mode;
   meta_info m_meta_info;
   std::string m_tech_name;
   tl::Mutex m_lock;
+  mutable tl::Mutex m_shape_counts_lock;
+  mutable std::map<std::pair<cell_index_type, unsigned int>, db::ShapeCounts> m_shape_counts;
+  mutable std::map<unsigned int, std::vector<size_t> > m_flat_shape_counts;
+  mutable std::vector<size_t> m_cell_multiplicities;
+
+  bool get_shape_counts (cell_index_type cell_index, unsigned int layer, db::ShapeCounts &counts) const;
+  std::vector<size_t> get_cell_multiplicities () const;
+  void clear_flat_shape_counts ();
 
   /**
    *  @brief Sort the cells topologically
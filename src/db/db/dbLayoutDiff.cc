@@ -26,8 +26,12 @@
 #include "dbCellMapping.h"
 #include "dbFuzzyCellMapping.h"
 #include "dbLayoutUtils.h"
+#include "dbHash.h"
 #include "tlLog.h"
 #include "tlExceptions.h"
+#include "tlThreadedWorkers.h"
+
+#include <memory>
 
 namespace db
 {
@@ -510,6 +514,47 @@ make_path_compare_func (db::Coord tolerance)
   return pair_compare_func<db::Path, db::properties_id_type, PathCompareOpWithTolerance, std_compare_func<db::properties_id_type> > (PathCompareOpWithTolerance (tolerance), std_compare_func<db::properties_id_type> ());
 }
 
+// -------------------------------------------------------------------------------
+//  Shortcut for unchanged layers
+//
+//  For exact compares (zero tolerance), unchanged layers usually deliver their shapes
+//  in the same order. Such sets are detected by a single pass over both sets, so the
+//  expensive sorting step can be skipped.
+
+/**
+ *  @brief Returns true if both shape sets hold the same shapes in the same order
+ */
+template <class X, class Op>
+static bool
+same_in_order (const std::vector<X> &a, const std::vector<X> &b, Op op)
+{
+  typename std::vector<X>::const_iterator ib = b.begin ();
+  for (typename std::vector<X>::const_iterator ia = a.begin (); ia != a.end (); ++ia, ++ib) {
+    if (op (*ia, *ib) || op (*ib, *ia)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ *  @brief Reduces two shape sets to the shapes not present in the other set
+ *
+ *  Without tolerance, sets holding the same shapes in the same order are cleared right away.
+ *  Otherwise, the sets are sorted and reduced.
+ */
+template <class X, class Op>
+static void
+reduce_shapes (std::vector<std::pair<X, db::properties_id_type> > &a, std::vector<std::pair<X, db::properties_id_type> > &b, Op op, db::Coord tolerance)
+{
+  if (tolerance == 0 && a.size () == b.size () && same_in_order (a, b, op)) {
+    a.clear ();
+    b.clear ();
+  } else {
+    reduce (a, b, op, tolerance > 0);
+  }
+}
+
 static void
 collect_polygons (const db::Layout & /*l*/, const db::Cell *c, unsigned int layer, unsigned int flags, std::vector< std::pair<db::Polygon, db::properties_id_type> > &shapes, PropertyMapper &pn)
 {
@@ -604,8 +649,651 @@ collect_paths (const db::Layout &, const db::Cell *c, unsigned int layer, unsign
   }
 }
 
+// -------------------------------------------------------------------------------
+//  A receiver recording the differences of a single cell
+//
+//  When cells are compared in parallel, the differences are recorded per cell and
+//  replayed to the actual receiver in the order of the cells.
+
+class DifferenceEvent
+{
+public:
+  virtual ~DifferenceEvent () { }
+  virtual void replay (DifferenceReceiver &r) const = 0;
+};
+
+class SimpleDifferenceEvent
+  : public DifferenceEvent
+{
+public:
+  typedef void (DifferenceReceiver::*func_type) ();
+
+  SimpleDifferenceEvent (func_type f)
+    : m_f (f)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_f) ();
+  }
+
+private:
+  func_type m_f;
+};
+
+class BoxDifferenceEvent
+  : public DifferenceEvent
+{
+public:
+  typedef void (DifferenceReceiver::*func_type) (const db::Box &, const db::Box &);
+
+  BoxDifferenceEvent (func_type f, const db::Box &ba, const db::Box &bb)
+    : m_f (f), m_ba (ba), m_bb (bb)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_f) (m_ba, m_bb);
+  }
+
+private:
+  func_type m_f;
+  db::Box m_ba, m_bb;
+};
+
+class BeginCellEvent
+  : public DifferenceEvent
+{
+public:
+  BeginCellEvent (const std::string &cellname, db::cell_index_type cia, db::cell_index_type cib)
+    : m_cellname (cellname), m_cia (cia), m_cib (cib)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    r.begin_cell (m_cellname, m_cia, m_cib);
+  }
+
+private:
+  std::string m_cellname;
+  db::cell_index_type m_cia, m_cib;
+};
+
+class BeginLayerEvent
+  : public DifferenceEvent
+{
+public:
+  BeginLayerEvent (const db::LayerProperties &layer, unsigned int layer_index_a, bool is_valid_a, unsigned int layer_index_b, bool is_valid_b)
+    : m_layer (layer), m_layer_index_a (layer_index_a), m_is_valid_a (is_valid_a), m_layer_index_b (layer_index_b), m_is_valid_b (is_valid_b)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    r.begin_layer (m_layer, m_layer_index_a, m_is_valid_a, m_layer_index_b, m_is_valid_b);
+  }
+
+private:
+  db::LayerProperties m_layer;
+  unsigned int m_layer_index_a;
+  bool m_is_valid_a;
+  unsigned int m_layer_index_b;
+  bool m_is_valid_b;
+};
+
+class InstancesEvent
+  : public DifferenceEvent
+{
+public:
+  typedef void (DifferenceReceiver::*func_type) (const std::vector <db::CellInstArrayWithProperties> &, const std::vector <std::string> &, const db::PropertiesRepository &);
+
+  InstancesEvent (func_type f, const std::vector <db::CellInstArrayWithProperties> &insts, const std::vector <std::string> &cell_names, const db::PropertiesRepository &props)
+    : m_f (f), m_insts (insts), mp_cell_names (&cell_names), mp_props (&props)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_f) (m_insts, *mp_cell_names, *mp_props);
+  }
+
+private:
+  func_type m_f;
+  std::vector <db::CellInstArrayWithProperties> m_insts;
+  const std::vector <std::string> *mp_cell_names;
+  const db::PropertiesRepository *mp_props;
+};
+
+class InstancesOnlyEvent
+  : public DifferenceEvent
+{
+public:
+  typedef void (DifferenceReceiver::*func_type) (const std::vector <db::CellInstArrayWithProperties> &, const db::Layout &);
+
+  InstancesOnlyEvent (func_type f, const std::vector <db::CellInstArrayWithProperties> &insts, const db::Layout &layout)
+    : m_f (f), m_insts (insts), mp_layout (&layout)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_f) (m_insts, *mp_layout);
+  }
+
+private:
+  func_type m_f;
+  std::vector <db::CellInstArrayWithProperties> m_insts;
+  const db::Layout *mp_layout;
+};
+
+template <class SH>
+class DetailedDiffEvent
+  : public DifferenceEvent
+{
+public:
+  DetailedDiffEvent (const db::PropertiesRepository &pr, const std::vector <std::pair <SH, db::properties_id_type> > &a, const std::vector <std::pair <SH, db::properties_id_type> > &b)
+    : mp_pr (&pr), m_a (a), m_b (b)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    r.detailed_diff (*mp_pr, m_a, m_b);
+  }
+
+private:
+  const db::PropertiesRepository *mp_pr;
+  std::vector <std::pair <SH, db::properties_id_type> > m_a, m_b;
+};
+
+class DifferenceRecorder
+  : public DifferenceReceiver
+{
+public:
+  DifferenceRecorder () { }
+
+  ~DifferenceRecorder ()
+  {
+    for (std::vector<DifferenceEvent *>::const_iterator e = m_events.begin (); e != m_events.end (); ++e) {
+      delete *e;
+    }
+    m_events.clear ();
+  }
+
+  void replay (DifferenceReceiver &r) const
+  {
+    for (std::vector<DifferenceEvent *>::const_iterator e = m_events.begin (); e != m_events.end (); ++e) {
+      (*e)->replay (r);
+    }
+  }
+
+  void begin_cell (const std::string &cellname, db::cell_index_type cia, db::cell_index_type cib) { add (new BeginCellEvent (cellname, cia, cib)); }
+  void bbox_differs (const db::Box &ba, const db::Box &bb) { add (new BoxDifferenceEvent (&DifferenceReceiver::bbox_differs, ba, bb)); }
+  void begin_inst_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_inst_differences)); }
+  void instances_in_a (const std::vector <db::CellInstArrayWithProperties> &insts_a, const std::vector <std::string> &cell_names, const db::PropertiesRepository &props) { add (new InstancesEvent (&DifferenceReceiver::instances_in_a, insts_a, cell_names, props)); }
+  void instances_in_b (const std::vector <db::CellInstArrayWithProperties> &insts_b, const std::vector <std::string> &cell_names, const db::PropertiesRepository &props) { add (new InstancesEvent (&DifferenceReceiver::instances_in_b, insts_b, cell_names, props)); }
+  void instances_in_a_only (const std::vector <db::CellInstArrayWithProperties> &anotb, const db::Layout &a) { add (new InstancesOnlyEvent (&DifferenceReceiver::instances_in_a_only, anotb, a)); }
+  void instances_in_b_only (const std::vector <db::CellInstArrayWithProperties> &bnota, const db::Layout &b) { add (new InstancesOnlyEvent (&DifferenceReceiver::instances_in_b_only, bnota, b)); }
+  void end_inst_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_inst_differences)); }
+  void begin_layer (const db::LayerProperties &layer, unsigned int layer_index_a, bool is_valid_a, unsigned int layer_index_b, bool is_valid_b) { add (new BeginLayerEvent (layer, layer_index_a, is_valid_a, layer_index_b, is_valid_b)); }
+  void per_layer_bbox_differs (const db::Box &ba, const db::Box &bb) { add (new BoxDifferenceEvent (&DifferenceReceiver::per_layer_bbox_differs, ba, bb)); }
+  void begin_polygon_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_polygon_differences)); }
+  void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Polygon, db::properties_id_type> > &a, const std::vector <std::pair <db::Polygon, db::properties_id_type> > &b) { add (new DetailedDiffEvent<db::Polygon> (pr, a, b)); }
+  void end_polygon_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_polygon_differences)); }
+  void begin_path_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_path_differences)); }
+  void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Path, db::properties_id_type> > &a, const std::vector <std::pair <db::Path, db::properties_id_type> > &b) { add (new DetailedDiffEvent<db::Path> (pr, a, b)); }
+  void end_path_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_path_differences)); }
+  void begin_box_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_box_differences)); }
+  void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Box, db::properties_id_type> > &a, const std::vector <std::pair <db::Box, db::properties_id_type> > &b) { add (new DetailedDiffEvent<db::Box> (pr, a, b)); }
+  void end_box_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_box_differences)); }
+  void begin_edge_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_edge_differences)); }
+  void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Edge, db::properties_id_type> > &a, const std::vector <std::pair <db::Edge, db::properties_id_type> > &b) { add (new DetailedDiffEvent<db::Edge> (pr, a, b)); }
+  void end_edge_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_edge_differences)); }
+  void begin_text_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_text_differences)); }
+  void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Text, db::properties_id_type> > &a, const std::vector <std::pair <db::Text, db::properties_id_type> > &b) { add (new DetailedDiffEvent<db::Text> (pr, a, b)); }
+  void end_text_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_text_differences)); }
+  void end_layer () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_layer)); }
+  void end_cell () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_cell)); }
+
+private:
+  std::vector<DifferenceEvent *> m_events;
+
+  DifferenceRecorder (const DifferenceRecorder &);
+  DifferenceRecorder &operator= (const DifferenceRecorder &);
+
+  void add (DifferenceEvent *e)
+  {
+    m_events.push_back (e);
+  }
+};
+
+// -------------------------------------------------------------------------------
+//  The cell-by-cell compare
+
+/**
+ *  @brief The shared, read-only state of a layout compare
+ *
+ *  The property mappers are filled in advance, so they can be used from multiple
+ *  threads without modifying them.
+ */
+struct LayoutDiffContext
+{
+  const db::Layout *a, *b, *n;
+  unsigned int flags;
+  db::Coord tolerance;
+  const std::vector <std::string> *common_cells;
+  const std::map <db::cell_index_type, db::cell_index_type> *common_cell_indices_a;
+  const std::vector <db::cell_index_type> *common_cells_a;
+  const std::map <db::cell_index_type, db::cell_index_type> *common_cell_indices_b;
+  const std::vector <db::cell_index_type> *common_cells_b;
+  const std::vector<db::LayerProperties> *common_layers;
+  const std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> *layers_a;
+  const std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> *layers_b;
+  db::PropertyMapper *prop_normalize_a, *prop_normalize_b;
+  db::PropertyMapper *prop_remap_to_a, *prop_remap_to_b;
+};
+
+/**
+ *  @brief Working buffers for the cell compare
+ */
+struct LayoutDiffBuffers
+{
+  std::vector <db::CellInstArrayWithProperties> insts_a;
+  std::vector <db::CellInstArrayWithProperties> insts_b;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_a;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_b;
+  std::vector <std::pair <db::Path, db::properties_id_type> > paths_a;
+  std::vector <std::pair <db::Path, db::properties_id_type> > paths_b;
+  std::vector <std::pair <db::Text, db::properties_id_type> > texts_a;
+  std::vector <std::pair <db::Text, db::properties_id_type> > texts_b;
+  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_a;
+  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_b;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_a;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_b;
+};
+
+/**
+ *  @brief Compares the common cell with index cci
+ *
+ *  @return True, if the cells differ
+ */
+static bool
+compare_cell (const LayoutDiffContext &ctx, unsigned int cci, LayoutDiffBuffers &buffers, DifferenceReceiver &r)
+{
+  const db::Layout &a = *ctx.a;
+  const db::Layout &b = *ctx.b;
+  const db::Layout &n = *ctx.n;
+  unsigned int flags = ctx.flags;
+  db::Coord tolerance = ctx.tolerance;
+  bool verbose = (flags & layout_diff::f_verbose);
+
+  const std::vector <std::string> &common_cells = *ctx.common_cells;
+  const std::map <db::cell_index_type, db::cell_index_type> &common_cell_indices_a = *ctx.common_cell_indices_a;
+  const std::vector <db::cell_index_type> &common_cells_a = *ctx.common_cells_a;
+  const std::map <db::cell_index_type, db::cell_index_type> &common_cell_indices_b = *ctx.common_cell_indices_b;
+  const std::vector <db::cell_index_type> &common_cells_b = *ctx.common_cells_b;
+  const std::vector<db::LayerProperties> &common_layers = *ctx.common_layers;
+  const std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> &layers_a = *ctx.layers_a;
+  const std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> &layers_b = *ctx.layers_b;
+  db::PropertyMapper &prop_normalize_a = *ctx.prop_normalize_a;
+  db::PropertyMapper &prop_normalize_b = *ctx.prop_normalize_b;
+  db::PropertyMapper &prop_remap_to_a = *ctx.prop_remap_to_a;
+  db::PropertyMapper &prop_remap_to_b = *ctx.prop_remap_to_b;
+
+  std::vector <db::CellInstArrayWithProperties> &insts_a = buffers.insts_a;
+  std::vector <db::CellInstArrayWithProperties> &insts_b = buffers.insts_b;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > &polygons_a = buffers.polygons_a;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > &polygons_b = buffers.polygons_b;
+  std::vector <std::pair <db::Path, db::properties_id_type> > &paths_a = buffers.paths_a;
+  std::vector <std::pair <db::Path, db::properties_id_type> > &paths_b = buffers.paths_b;
+  std::vector <std::pair <db::Text, db::properties_id_type> > &texts_a = buffers.texts_a;
+  std::vector <std::pair <db::Text, db::properties_id_type> > &texts_b = buffers.texts_b;
+  std::vector <std::pair <db::Box, db::properties_id_type> > &boxes_a = buffers.boxes_a;
+  std::vector <std::pair <db::Box, db::properties_id_type> > &boxes_b = buffers.boxes_b;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > &edges_a = buffers.edges_a;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > &edges_b = buffers.edges_b;
+
+  bool differs = false;
+
+
+  const db::Cell *cell_a = &a.cell (common_cells_a [cci]);
+  const db::Cell *cell_b = &b.cell (common_cells_b [cci]);
+
+  if (tl::verbosity () >= 30) {
+    tl::info << "Layout diff - compare cell " << a.cell_name (cell_a->cell_index ()) << " and " << b.cell_name (cell_b->cell_index ());
+  }
+
+  r.begin_cell (common_cells [cci], common_cells_a [cci], common_cells_b [cci]); 
+
+  if (!verbose && cell_a->bbox () != cell_b->bbox ()) {
+    differs = true;
+    if (flags & layout_diff::f_silent) {
+      return true;
+    }
+    r.bbox_differs (cell_a->bbox (), cell_b->bbox ());
+  }
+
+  collect_insts (a, cell_a, flags, common_cell_indices_a, insts_a, prop_normalize_a);
+  collect_insts (b, cell_b, flags, common_cell_indices_b, insts_b, prop_normalize_b);
+
+  std::vector <db::CellInstArrayWithProperties> anotb;
+  std::set_difference (insts_a.begin (), insts_a.end (), insts_b.begin (), insts_b.end (), std::back_inserter (anotb));
+
+  rewrite_instances_to (anotb, flags, common_cells_a, prop_remap_to_a);
+  collect_insts_of_unmapped_cells (a, cell_a, flags, common_cell_indices_a, anotb);
+
+  std::vector <db::CellInstArrayWithProperties> bnota;
+  std::set_difference (insts_b.begin (), insts_b.end (), insts_a.begin (), insts_a.end (), std::back_inserter (bnota));
+
+  rewrite_instances_to (bnota, flags, common_cells_b, prop_remap_to_b);
+  collect_insts_of_unmapped_cells (b, cell_b, flags, common_cell_indices_b, bnota);
+
+  if (! anotb.empty () || ! bnota.empty ()) {
+
+    differs = true;
+
+    if (flags & layout_diff::f_silent) {
+      return true;
+    }
+
+    r.begin_inst_differences ();
+
+    if (verbose) {
+
+      r.instances_in_a (insts_a, common_cells, n.properties_repository ());
+      r.instances_in_b (insts_b, common_cells, n.properties_repository ());
+
+      r.instances_in_a_only (anotb, a);
+      r.instances_in_b_only (bnota, b);
+
+    }
+
+    r.end_inst_differences ();
+
+  }
+
+
+  //  compare layer by layer
+  
+  for (std::vector<db::LayerProperties>::const_iterator cl = common_layers.begin (); cl != common_layers.end (); ++cl) {
+
+    if (tl::verbosity () >= 40) {
+      tl::info << "Layout diff - compare layer " << cl->to_string ();
+    }
+
+    bool is_valid_a = false, is_valid_b = false;
+    unsigned int layer_a = 0, layer_b = 0;
+
+    if (layers_a.find (*cl) != layers_a.end ()) { 
+      layer_a = layers_a.find (*cl)->second;
+      is_valid_a = true;
+    }
+    
+    if (layers_b.find (*cl) != layers_b.end ()) {
+      layer_b = layers_b.find (*cl)->second;
+      is_valid_b = true;
+    }
+
+    r.begin_layer (*cl, layer_a, is_valid_a, layer_b, is_valid_b);
+
+    if (!verbose && is_valid_a && is_valid_b && cell_a->bbox (layer_a) != cell_b->bbox (layer_b)) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return true;
+      }
+      r.per_layer_bbox_differs (cell_a->bbox (layer_a), cell_b->bbox (layer_b));
+    }
+
+    //  compare polygons
+
+    polygons_a.clear();
+    polygons_b.clear();
+    if (is_valid_a) {
+      collect_polygons (a, cell_a, layer_a, flags, polygons_a, prop_normalize_a);
+    } 
+    if (is_valid_b) {
+      collect_polygons (b, cell_b, layer_b, flags, polygons_b, prop_normalize_b);
+    }
+
+    reduce_shapes (polygons_a, polygons_b, make_polygon_compare_func (tolerance), tolerance);
+
+    if (!polygons_a.empty () || !polygons_b.empty ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return true;
+      }
+      r.begin_polygon_differences ();
+      if (verbose) {
+        r.detailed_diff (n.properties_repository (), polygons_a, polygons_b);
+      }
+      r.end_polygon_differences ();
+    }
+
+
+    //  compare paths
+
+    if (! (flags & db::layout_diff::f_paths_as_polygons)) {
+
+      paths_a.clear();
+      paths_b.clear();
+      if (is_valid_a) {
+        collect_paths (a, cell_a, layer_a, flags, paths_a, prop_normalize_a);
+      }
+      if (is_valid_b) {
+        collect_paths (b, cell_b, layer_b, flags, paths_b, prop_normalize_b);
+      }
+
+      reduce_shapes (paths_a, paths_b, make_path_compare_func (tolerance), tolerance);
+
+      if (!paths_a.empty () || !paths_b.empty ()) {
+        differs = true;
+        if (flags & layout_diff::f_silent) {
+          return true;
+        }
+        r.begin_path_differences ();
+        if (verbose) {
+          r.detailed_diff (n.properties_repository (), paths_a, paths_b);
+        }
+        r.end_path_differences ();
+      }
+
+    }
+
+    //  compare texts
+
+    texts_a.clear();
+    texts_b.clear();
+    if (is_valid_a) {
+      collect_texts (a, cell_a, layer_a, flags, texts_a, prop_normalize_a);
+    }
+    if (is_valid_b) {
+      collect_texts (b, cell_b, layer_b, flags, texts_b, prop_normalize_b);
+    }
+
+    reduce_shapes (texts_a, texts_b, make_text_compare_func (tolerance), tolerance);
+
+    if (!texts_a.empty () || !texts_b.empty ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return true;
+      }
+      r.begin_text_differences ();
+      if (verbose) {
+        r.detailed_diff (n.properties_repository (), texts_a, texts_b);
+      }
+      r.end_text_differences ();
+    }
+
+    //  compare boxes (unless this is done by the polygon compare code)
+    
+    if (! (flags & db::layout_diff::f_boxes_as_polygons)) {
+
+      boxes_a.clear();
+      boxes_b.clear();
+      if (is_valid_a) {
+        collect_boxes (a, cell_a, layer_a, flags, boxes_a, prop_normalize_a);
+      }
+      if (is_valid_b) {
+        collect_boxes (b, cell_b, layer_b, flags, boxes_b, prop_normalize_b);
+      }
+
+      reduce_shapes (boxes_a, boxes_b, make_box_compare_func (tolerance), tolerance);
+
+      if (!boxes_a.empty () || !boxes_b.empty ()) {
+        differs = true;
+        if (flags & layout_diff::f_silent) {
+          return true;
+        }
+        r.begin_box_differences ();
+        if (verbose) {
+          r.detailed_diff (n.properties_repository (), boxes_a, boxes_b);
+        }
+        r.end_box_differences ();
+      }
+
+    }
+
+    //  compare edges
+
+    edges_a.clear();
+    edges_b.clear();
+    if (is_valid_a) {
+      collect_edges (a, cell_a, layer_a, flags, edges_a, prop_normalize_a);
+    }
+    if (is_valid_b) {
+      collect_edges (b, cell_b, layer_b, flags, edges_b, prop_normalize_b);
+    }
+
+    reduce_shapes (edges_a, edges_b, make_edge_compare_func (tolerance), tolerance);
+
+    if (!edges_a.empty () || !edges_b.empty ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return true;
+      }
+      r.begin_edge_differences ();
+      if (verbose) {
+        r.detailed_diff (n.properties_repository (), edges_a, edges_b);
+      }
+      r.end_edge_differences ();
+    }
+
+    r.end_layer ();
+
+  }
+
+  r.end_cell ();
+
+  return differs;
+}
+
+// -------------------------------------------------------------------------------
+//  Parallel execution of the cell compare
+
+static void
+prefill_property_mapper (db::PropertyMapper &pm, const db::PropertiesRepository &source)
+{
+  for (db::PropertiesRepository::iterator p = source.begin (); p != source.end (); ++p) {
+    pm (p->first);
+  }
+}
+
+class LayoutDiffTask
+  : public tl::Task
+{
+public:
+  LayoutDiffTask (unsigned int cci)
+    : m_cci (cci)
+  { }
+
+  unsigned int cci () const
+  {
+    return m_cci;
+  }
+
+private:
+  unsigned int m_cci;
+};
+
+class LayoutDiffJob;
+
+class LayoutDiffWorker
+  : public tl::Worker
+{
+public:
+  LayoutDiffWorker (LayoutDiffJob *job)
+    : tl::Worker (), mp_job (job)
+  { }
+
+  void perform_task (tl::Task *task);
+
+private:
+  LayoutDiffJob *mp_job;
+  LayoutDiffBuffers m_buffers;
+};
+
+class LayoutDiffJob
+  : public tl::JobBase
+{
+public:
+  LayoutDiffJob (int nworkers, const LayoutDiffContext &ctx)
+    : tl::JobBase (nworkers), m_ctx (ctx),
+      m_recorders (ctx.common_cells->size (), (DifferenceRecorder *) 0),
+      m_differs (ctx.common_cells->size (), false)
+  { }
+
+  ~LayoutDiffJob ()
+  {
+    for (std::vector<DifferenceRecorder *>::const_iterator r = m_recorders.begin (); r != m_recorders.end (); ++r) {
+      delete *r;
+    }
+  }
+
+  const LayoutDiffContext &context () const
+  {
+    return m_ctx;
+  }
+
+  void put_result (unsigned int cci, DifferenceRecorder *recorder, bool differs)
+  {
+    tl::MutexLocker locker (&m_lock);
+    m_recorders [cci] = recorder;
+    m_differs [cci] = differs;
+  }
+
+  bool take_result (unsigned int cci, DifferenceRecorder *&recorder, bool &differs)
+  {
+    tl::MutexLocker locker (&m_lock);
+    if (! m_recorders [cci]) {
+      return false;
+    }
+    recorder = m_recorders [cci];
+    differs = m_differs [cci];
+    m_recorders [cci] = 0;
+    return true;
+  }
+
+protected:
+  virtual tl::Worker *create_worker ()
+  {
+    return new LayoutDiffWorker (this);
+  }
+
+private:
+  LayoutDiffContext m_ctx;
+  tl::Mutex m_lock;
+  std::vector<DifferenceRecorder *> m_recorders;
+  std::vector<bool> m_differs;
+};
+
+void
+LayoutDiffWorker::perform_task (tl::Task *task)
+{
+  unsigned int cci = static_cast<LayoutDiffTask *> (task)->cci ();
+
+  std::unique_ptr<DifferenceRecorder> recorder (new DifferenceRecorder ());
+  bool differs = compare_cell (mp_job->context (), cci, m_buffers, *recorder);
+  mp_job->put_result (cci, recorder.release (), differs);
+}
+
 static bool
-do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout &b, const db::Cell *top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r)
+do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout &b, const db::Cell *top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, int threads)
 {
   bool differs = false;
 
@@ -617,8 +1305,6 @@ do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout
     r.dbu_differs (a.dbu (), b.dbu ());
   }
 
-  bool verbose = (flags & layout_diff::f_verbose);
-
   db::Layout n, na, nb;
   na.properties_repository () = a.properties_repository ();
   nb.properties_repository () = b.properties_repository ();
@@ -816,250 +1502,100 @@ do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout
     tl::info << "Layout diff - cell by cell compare";
   }
 
-  std::vector <db::CellInstArrayWithProperties> insts_a;
-  std::vector <db::CellInstArrayWithProperties> insts_b;
-  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_a;
-  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_b;
-  std::vector <std::pair <db::Path, db::properties_id_type> > paths_a;
-  std::vector <std::pair <db::Path, db::properties_id_type> > paths_b;
-  std::vector <std::pair <db::Text, db::properties_id_type> > texts_a;
-  std::vector <std::pair <db::Text, db::properties_id_type> > texts_b;
-  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_a;
-  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_b;
-  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_a;
-  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_b;
-
-  for (unsigned int cci = 0; cci < common_cells.size (); ++cci) {
-
-    const db::Cell *cell_a = &a.cell (common_cells_a [cci]);
-    const db::Cell *cell_b = &b.cell (common_cells_b [cci]);
-
-    if (tl::verbosity () >= 30) {
-      tl::info << "Layout diff - compare cell " << a.cell_name (cell_a->cell_index ()) << " and " << b.cell_name (cell_b->cell_index ());
-    }
-
-    r.begin_cell (common_cells [cci], common_cells_a [cci], common_cells_b [cci]); 
-
-    if (!verbose && cell_a->bbox () != cell_b->bbox ()) {
-      differs = true;
-      if (flags & layout_diff::f_silent) {
-        return false;
-      }
-      r.bbox_differs (cell_a->bbox (), cell_b->bbox ());
-    }
-
-    collect_insts (a, cell_a, flags, common_cell_indices_a, insts_a, prop_normalize_a);
-    collect_insts (b, cell_b, flags, common_cell_indices_b, insts_b, prop_normalize_b);
-
-    std::vector <db::CellInstArrayWithProperties> anotb;
-    std::set_difference (insts_a.begin (), insts_a.end (), insts_b.begin (), insts_b.end (), std::back_inserter (anotb));
-
-    rewrite_instances_to (anotb, flags, common_cells_a, prop_remap_to_a);
-    collect_insts_of_unmapped_cells (a, cell_a, flags, common_cell_indices_a, anotb);
-
-    std::vector <db::CellInstArrayWithProperties> bnota;
-    std::set_difference (insts_b.begin (), insts_b.end (), insts_a.begin (), insts_a.end (), std::back_inserter (bnota));
-
-    rewrite_instances_to (bnota, flags, common_cells_b, prop_remap_to_b);
-    collect_insts_of_unmapped_cells (b, cell_b, flags, common_cell_indices_b, bnota);
-
-    if (! anotb.empty () || ! bnota.empty ()) {
-
-      differs = true;
-
-      if (flags & layout_diff::f_silent) {
-        return false;
-      }
-
-      r.begin_inst_differences ();
-
-      if (verbose) {
-
-        r.instances_in_a (insts_a, common_cells, n.properties_repository ());
-        r.instances_in_b (insts_b, common_cells, n.properties_repository ());
-
-        r.instances_in_a_only (anotb, a);
-        r.instances_in_b_only (bnota, b);
-
-      }
-
-      r.end_inst_differences ();
-
-    }
-
-
-    //  compare layer by layer
-    
-    for (std::vector<db::LayerProperties>::const_iterator cl = common_layers.begin (); cl != common_layers.end (); ++cl) {
-
-      if (tl::verbosity () >= 40) {
-        tl::info << "Layout diff - compare layer " << cl->to_string ();
-      }
-
-      bool is_valid_a = false, is_valid_b = false;
-      unsigned int layer_a = 0, layer_b = 0;
-
-      if (layers_a.find (*cl) != layers_a.end ()) { 
-        layer_a = layers_a.find (*cl)->second;
-        is_valid_a = true;
-      }
-      
-      if (layers_b.find (*cl) != layers_b.end ()) {
-        layer_b = layers_b.find (*cl)->second;
-        is_valid_b = true;
-      }
-
-      r.begin_layer (*cl, layer_a, is_valid_a, layer_b, is_valid_b);
-
-      if (!verbose && is_valid_a && is_valid_b && cell_a->bbox (layer_a) != cell_b->bbox (layer_b)) {
+  LayoutDiffContext ctx;
+  ctx.a = &a;
+  ctx.b = &b;
+  ctx.n = &n;
+  ctx.flags = flags;
+  ctx.tolerance = tolerance;
+  ctx.common_cells = &common_cells;
+  ctx.common_cell_indices_a = &common_cell_indices_a;
+  ctx.common_cells_a = &common_cells_a;
+  ctx.common_cell_indices_b = &common_cell_indices_b;
+  ctx.common_cells_b = &common_cells_b;
+  ctx.common_layers = &common_layers;
+  ctx.layers_a = &layers_a;
+  ctx.layers_b = &layers_b;
+  ctx.prop_normalize_a = &prop_normalize_a;
+  ctx.prop_normalize_b = &prop_normalize_b;
+  ctx.prop_remap_to_a = &prop_remap_to_a;
+  ctx.prop_remap_to_b = &prop_remap_to_b;
+
+  if (threads <= 0 || common_cells.size () < 2) {
+
+    LayoutDiffBuffers buffers;
+
+    for (unsigned int cci = 0; cci < common_cells.size (); ++cci) {
+
+      if (compare_cell (ctx, cci, buffers, r)) {
         differs = true;
         if (flags & layout_diff::f_silent) {
           return false;
         }
-        r.per_layer_bbox_differs (cell_a->bbox (layer_a), cell_b->bbox (layer_b));
-      }
-
-      //  compare polygons
-
-      polygons_a.clear();
-      polygons_b.clear();
-      if (is_valid_a) {
-        collect_polygons (a, cell_a, layer_a, flags, polygons_a, prop_normalize_a);
-      } 
-      if (is_valid_b) {
-        collect_polygons (b, cell_b, layer_b, flags, polygons_b, prop_normalize_b);
       }
 
-      reduce (polygons_a, polygons_b, make_polygon_compare_func (tolerance), tolerance > 0);
+      ++progress;
 
-      if (!polygons_a.empty () || !polygons_b.empty ()) {
-        differs = true;
-        if (flags & layout_diff::f_silent) {
-          return false;
-        }
-        r.begin_polygon_differences ();
-        if (verbose) {
-          r.detailed_diff (n.properties_repository (), polygons_a, polygons_b);
-        }
-        r.end_polygon_differences ();
-      }
+    }
 
+  } else {
 
-      //  compare paths
+    //  The property mappers are shared between the threads, hence they need to be
+    //  complete before the threads start.
+    if (! (flags & layout_diff::f_no_properties)) {
+      prefill_property_mapper (prop_normalize_a, a.properties_repository ());
+      prefill_property_mapper (prop_normalize_b, b.properties_repository ());
+      prefill_property_mapper (prop_remap_to_a, n.properties_repository ());
+      prefill_property_mapper (prop_remap_to_b, n.properties_repository ());
+    }
 
-      if (! (flags & db::layout_diff::f_paths_as_polygons)) {
+    LayoutDiffJob job (threads, ctx);
+    for (unsigned int cci = 0; cci < common_cells.size (); ++cci) {
+      job.schedule (new LayoutDiffTask (cci));
+    }
 
-        paths_a.clear();
-        paths_b.clear();
-        if (is_valid_a) {
-          collect_paths (a, cell_a, layer_a, flags, paths_a, prop_normalize_a);
-        }
-        if (is_valid_b) {
-          collect_paths (b, cell_b, layer_b, flags, paths_b, prop_normalize_b);
-        }
+    try {
 
-        reduce (paths_a, paths_b, make_path_compare_func (tolerance), tolerance > 0);
+      job.start ();
 
-        if (!paths_a.empty () || !paths_b.empty ()) {
-          differs = true;
-          if (flags & layout_diff::f_silent) {
-            return false;
-          }
-          r.begin_path_differences ();
-          if (verbose) {
-            r.detailed_diff (n.properties_repository (), paths_a, paths_b);
-          }
-          r.end_path_differences ();
-        }
-
-      }
+      //  deliver the results in the order of the cells, so the output does not
+      //  depend on the thread scheduling
+      unsigned int next = 0;
+      bool finished = false;
+      while (! finished) {
 
-      //  compare texts
+        finished = job.wait (10);
 
-      texts_a.clear();
-      texts_b.clear();
-      if (is_valid_a) {
-        collect_texts (a, cell_a, layer_a, flags, texts_a, prop_normalize_a);
-      }
-      if (is_valid_b) {
-        collect_texts (b, cell_b, layer_b, flags, texts_b, prop_normalize_b);
-      }
+        bool cell_differs = false;
+        DifferenceRecorder *recorder = 0;
+        while (next < common_cells.size () && job.take_result (next, recorder, cell_differs)) {
 
-      reduce (texts_a, texts_b, make_text_compare_func (tolerance), tolerance > 0);
+          std::unique_ptr<DifferenceRecorder> recorder_holder (recorder);
+          recorder->replay (r);
 
-      if (!texts_a.empty () || !texts_b.empty ()) {
-        differs = true;
-        if (flags & layout_diff::f_silent) {
-          return false;
-        }
-        r.begin_text_differences ();
-        if (verbose) {
-          r.detailed_diff (n.properties_repository (), texts_a, texts_b);
-        }
-        r.end_text_differences ();
-      }
-
-      //  compare boxes (unless this is done by the polygon compare code)
-      
-      if (! (flags & db::layout_diff::f_boxes_as_polygons)) {
-
-        boxes_a.clear();
-        boxes_b.clear();
-        if (is_valid_a) {
-          collect_boxes (a, cell_a, layer_a, flags, boxes_a, prop_normalize_a);
-        }
-        if (is_valid_b) {
-          collect_boxes (b, cell_b, layer_b, flags, boxes_b, prop_normalize_b);
-        }
-
-        reduce (boxes_a, boxes_b, make_box_compare_func (tolerance), tolerance > 0);
-
-        if (!boxes_a.empty () || !boxes_b.empty ()) {
-          differs = true;
-          if (flags & layout_diff::f_silent) {
-            return false;
+          if (cell_differs) {
+            differs = true;
+            if (flags & layout_diff::f_silent) {
+              job.terminate ();
+              return false;
+            }
           }
-          r.begin_box_differences ();
-          if (verbose) {
-            r.detailed_diff (n.properties_repository (), boxes_a, boxes_b);
-          }
-          r.end_box_differences ();
-        }
-
-      }
-
-      //  compare edges
 
-      edges_a.clear();
-      edges_b.clear();
-      if (is_valid_a) {
-        collect_edges (a, cell_a, layer_a, flags, edges_a, prop_normalize_a);
-      }
-      if (is_valid_b) {
-        collect_edges (b, cell_b, layer_b, flags, edges_b, prop_normalize_b);
-      }
+          ++next;
+          ++progress;
 
-      reduce (edges_a, edges_b, make_edge_compare_func (tolerance), tolerance > 0);
-
-      if (!edges_a.empty () || !edges_b.empty ()) {
-        differs = true;
-        if (flags & layout_diff::f_silent) {
-          return false;
-        }
-        r.begin_edge_differences ();
-        if (verbose) {
-          r.detailed_diff (n.properties_repository (), edges_a, edges_b);
         }
-        r.end_edge_differences ();
-      }
 
-      r.end_layer ();
+      }
 
+    } catch (...) {
+      job.terminate ();
+      throw;
     }
 
-    r.end_cell ();
-
-    ++progress;
+    if (job.has_error ()) {
+      throw tl::Exception (job.error_messages ().front ());
+    }
 
   }
 
@@ -1068,15 +1604,15 @@ do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout
 }
 
 bool
-compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r)
+compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, int threads)
 {
-  return do_compare_layouts (a, 0, b, 0, flags, tolerance, r);
+  return do_compare_layouts (a, 0, b, 0, flags, tolerance, r, threads);
 }
 
 bool
-compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r)
+compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, int threads)
 {
-  return do_compare_layouts (a, &a.cell (top_a), b, &b.cell (top_b), flags, tolerance, r);
+  return do_compare_layouts (a, &a.cell (top_a), b, &b.cell (top_b), flags, tolerance, r, threads);
 }
 
 // -------------------------------------------------------------------------------
@@ -1567,21 +2103,21 @@ PrintingDifferenceReceiver::end_cell ()
 //  Implementation of a printing diff 
 
 bool
-compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties)
+compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties, int threads)
 {
   PrintingDifferenceReceiver r;
   r.set_max_count (max_count);
   r.set_print_properties (print_properties);
-  return compare_layouts (a, b, flags, tolerance, r);
+  return compare_layouts (a, b, flags, tolerance, r, threads);
 }
 
 bool
-compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties)
+compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties, int threads)
 {
   PrintingDifferenceReceiver r;
   r.set_max_count (max_count);
   r.set_print_properties (print_properties);
-  return compare_layouts (a, top_a, b, top_b, flags, tolerance, r);
+  return compare_layouts (a, top_a, b, top_b, flags, tolerance, r, threads);
 }
 
 }
@@ -140,13 +140,14 @@ public:
  *  @param tolerance A coordinate tolerance to apply (0: exact match, 1: one DBU tolerance is allowed ...)
  *  @param max_count The maximum number of lines printed to the logger - the compare result will reflect all differences however
  *  @param print_properties If true, property differences are printed as well
+ *  @param threads The number of threads to use for comparing the cells (0: compare in the calling thread)
  *
  *  If "max_count" is 0, no limitation is imposed. If it is 1, only a warning saying that the log has been abbreviated is printed.
  *  If "max_count" is >1, max_count-1 differences plus one warning about abbreviation is printed.
  *
  *  @return True, if the layouts are identical
  */
-bool DB_PUBLIC compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, size_t max_count = 0, bool print_properties = false);
+bool DB_PUBLIC compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, size_t max_count = 0, bool print_properties = false, int threads = 0);
 
 /**
  *  @brief Compare two layout objects
@@ -162,10 +163,11 @@ bool DB_PUBLIC compare_layouts (const db::Layout &a, const db::Layout &b, unsign
  *  @param tolerance A coordinate tolerance to apply (0: exact match, 1: one DBU tolerance is allowed ...)
  *  @param max_count The maximum number of lines printed to the logger - the compare result will reflect all differences however
  *  @param print_properties If true, property differences are printed as well
+ *  @param threads The number of threads to use for comparing the cells (0: compare in the calling thread)
  *
  *  @return True, if the layouts are identical
  */
-bool DB_PUBLIC compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, size_t max_count = 0, bool print_properties = false);
+bool DB_PUBLIC compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, size_t max_count = 0, bool print_properties = false, int threads = 0);
 
 /**
  *  @brief Compare two layout objects with a custom receiver for the differences
@@ -179,10 +181,14 @@ bool DB_PUBLIC compare_layouts (const db::Layout &a, db::cell_index_type top_a,
  *  @param b The second input layout
  *  @param flags Flags to use for the comparison
  *  @param tolerance A coordinate tolerance to apply (0: exact match, 1: one DBU tolerance is allowed ...)
+ *  @param threads The number of threads to use for comparing the cells (0: compare in the calling thread)
+ *
+ *  With threads, the cells are compared in parallel. The differences are delivered to the receiver
+ *  from the calling thread and in the same order as without threads.
  *
  *  @return True, if the layouts are identical
  */
-bool DB_PUBLIC compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r);
+bool DB_PUBLIC compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, int threads = 0);
 
 /**
  *  @brief Compare two layouts using the specified top cells
@@ -190,7 +196,7 @@ bool DB_PUBLIC compare_layouts (const db::Layout &a, const db::Layout &b, unsign
  *  This function basically works like the previous one but allows one to specify top cells which
  *  are compared hierarchically.
  */
-bool DB_PUBLIC compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r);
+bool DB_PUBLIC compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, int threads = 0);
 
 }
 
@@ -29,10 +29,12 @@
 #include "dbCellMapping.h"
 #include "dbLayoutToNetlistWriter.h"
 #include "dbLayoutToNetlistReader.h"
+#include "dbLayoutToNetlistBinaryFile.h"
 #include "dbLayoutVsSchematic.h"
 #include "dbLayoutToNetlistFormatDefs.h"
 #include "dbLayoutVsSchematicFormatDefs.h"
 #include "tlGlobPattern.h"
+#include "tlFileUtils.h"
 
 namespace db
 {
@@ -429,6 +431,9 @@ std::string LayoutToNetlist::name (unsigned int l) const
 
 db::Region *LayoutToNetlist::layer_by_name (const std::string &name)
 {
+  //  the region delivered needs to be complete
+  ensure_geometry ();
+
   std::map<std::string, db::DeepLayer>::const_iterator l = m_named_regions.find (name);
   if (l == m_named_regions.end ()) {
     return 0;
@@ -764,6 +769,7 @@ void LayoutToNetlist::shapes_of_net (const db::Net &net, const db::Region &of_la
   std::map<unsigned int, db::Shapes *> lmap;
   lmap [lid] = &to;
 
+  ensure_net_geometry (net);
   deliver_shapes_of_net (recursive, mp_netlist.get (), m_net_clusters, circuit->cell_index (), net.cluster_id (), lmap, db::ICplxTrans (), propid);
 }
 
@@ -777,6 +783,7 @@ db::Region *LayoutToNetlist::shapes_of_net (const db::Net &net, const db::Region
   std::map<unsigned int, db::Region *> lmap;
   lmap [lid] = res.get ();
 
+  ensure_net_geometry (net);
   deliver_shapes_of_net (recursive, mp_netlist.get (), m_net_clusters, circuit->cell_index (), net.cluster_id (), lmap, db::ICplxTrans (), 0);
 
   return res.release ();
@@ -920,6 +927,8 @@ LayoutToNetlist::build_net (const db::Net &net, db::Layout &target, db::Cell &ta
     throw tl::Exception (tl::to_string (tr ("The netlist has not been extracted yet")));
   }
 
+  ensure_net_geometry (net);
+
   cell_reuse_table_type cell_reuse_table;
 
   double mag = internal_layout ()->dbu () / target.dbu ();
@@ -970,6 +979,8 @@ LayoutToNetlist::build_nets (const std::vector<const db::Net *> *nets, const db:
     throw tl::Exception (tl::to_string (tr ("The netlist has not been extracted yet")));
   }
 
+  ensure_geometry ();
+
   std::set<const db::Net *> net_set;
   if (nets) {
     net_set.insert (nets->begin (), nets->end ());
@@ -1084,6 +1095,8 @@ db::Net *LayoutToNetlist::probe_net (const db::Region &of_region, const db::Poin
   }
   tl_assert (mp_netlist.get ());
 
+  ensure_geometry ();
+
   db::CplxTrans dbu_trans (internal_layout ()->dbu ());
   db::VCplxTrans dbu_trans_inv = dbu_trans.inverted ();
 
@@ -1214,6 +1227,8 @@ db::Region LayoutToNetlist::antenna_check (const db::Region &gate, double gate_a
     throw tl::Exception (tl::to_string (tr ("The netlist has not been extracted yet")));
   }
 
+  ensure_geometry ();
+
   db::Layout &ly = dss ().layout (m_layout_index);
   double dbu = ly.dbu ();
 
@@ -1296,25 +1311,62 @@ db::Region LayoutToNetlist::antenna_check (const db::Region &gate, double gate_a
 
 void LayoutToNetlist::save (const std::string &path, bool short_format)
 {
-  tl::OutputStream stream (path);
-  db::LayoutToNetlistStandardWriter writer (stream, short_format);
-  set_filename (path);
-  writer.write (this);
+  if (db::is_l2n_binary_file_name (path)) {
+    tl::OutputStream stream (path, tl::OutputStream::OM_Plain);
+    db::LayoutToNetlistBinaryWriter writer (stream);
+    set_filename (path);
+    writer.write (this);
+  } else {
+    tl::OutputStream stream (path);
+    db::LayoutToNetlistStandardWriter writer (stream, short_format);
+    set_filename (path);
+    writer.write (this);
+  }
 }
 
 void LayoutToNetlist::load (const std::string &path)
 {
-  tl::InputStream stream (path);
-  db::LayoutToNetlistStandardReader reader (stream);
-  set_filename (path);
-  set_name (stream.filename ());
-  reader.read (this);
+  if (db::is_l2n_binary_file (path)) {
+    db::LayoutToNetlistBinaryReader reader (path);
+    set_filename (path);
+    set_name (tl::filename (path));
+    reader.read (this);
+  } else {
+    tl::InputStream stream (path);
+    db::LayoutToNetlistStandardReader reader (stream);
+    set_filename (path);
+    set_name (stream.filename ());
+    reader.read (this);
+  }
 }
 
 db::LayoutToNetlist *LayoutToNetlist::create_from_file (const std::string &path)
 {
   std::unique_ptr<db::LayoutToNetlist> db;
 
+  if (db::is_l2n_binary_file (path)) {
+
+    //  binary files: load the net geometry on demand
+    db::LayoutToNetlistBinaryReader reader (path);
+    reader.set_geometry_on_demand (true);
+
+    if (reader.is_lvs ()) {
+      db::LayoutVsSchematic *lvs_db = new db::LayoutVsSchematic ();
+      db.reset (lvs_db);
+      lvs_db->set_filename (path);
+      lvs_db->set_name (tl::filename (path));
+      reader.read_lvs (lvs_db);
+    } else {
+      db.reset (new db::LayoutToNetlist ());
+      db->set_filename (path);
+      db->set_name (tl::filename (path));
+      reader.read (db.get ());
+    }
+
+    return db.release ();
+
+  }
+
   //  TODO: generic concept to detect format
   std::string first_line;
   {
@@ -1340,4 +1392,31 @@ void LayoutToNetlist::set_generator (const std::string &g)
   m_generator = g;
 }
 
+void LayoutToNetlist::set_geometry_loader (db::LayoutToNetlistGeometryLoader *loader)
+{
+  mp_geometry_loader.reset (loader);
+}
+
+void LayoutToNetlist::ensure_net_geometry (const db::Net &net) const
+{
+  if (! mp_geometry_loader.get ()) {
+    return;
+  }
+
+  //  NOTE: nets from other netlists (e.g. the reference netlist of a LVS DB) don't have geometry
+  const db::Circuit *circuit = net.circuit ();
+  if (circuit && circuit->netlist () == mp_netlist.get () && net.cluster_id () > 0) {
+    mp_geometry_loader->load_cluster (const_cast<LayoutToNetlist *> (this), circuit->cell_index (), net.cluster_id ());
+  }
+}
+
+void LayoutToNetlist::ensure_geometry () const
+{
+  if (mp_geometry_loader.get ()) {
+    LayoutToNetlist *non_const_this = const_cast<LayoutToNetlist *> (this);
+    mp_geometry_loader->load_all (non_const_this);
+    non_const_this->mp_geometry_loader.reset (0);
+  }
+}
+
 }
@@ -31,6 +31,33 @@
 namespace db
 {
 
+class LayoutToNetlist;
+
+/**
+ *  @brief An interface for providing net geometry on demand
+ *
+ *  Readers which do not load the net geometry together with the netlist install
+ *  an object of this kind in the LayoutToNetlist object (see
+ *  LayoutToNetlist::set_geometry_loader). The geometry is then loaded when it is
+ *  required.
+ */
+class DB_PUBLIC LayoutToNetlistGeometryLoader
+{
+public:
+  LayoutToNetlistGeometryLoader () { }
+  virtual ~LayoutToNetlistGeometryLoader () { }
+
+  /**
+   *  @brief Loads the geometry of the given cluster and of all clusters connected to it from child cells
+   */
+  virtual void load_cluster (db::LayoutToNetlist *l2n, db::cell_index_type ci, size_t cluster_id) = 0;
+
+  /**
+   *  @brief Loads all remaining geometry
+   */
+  virtual void load_all (db::LayoutToNetlist *l2n) = 0;
+};
+
 /**
  *  @brief A generic framework for extracting netlists from layouts
  *
@@ -783,7 +810,8 @@ public:
    *  @brief Saves the database to the given path
    *
    *  Currently, the internal format will be used. If "short_format" is true, the short version
-   *  of the format is used.
+   *  of the format is used. If the file name ends with ".l2nb", the binary format is used
+   *  (see LayoutToNetlistBinaryWriter).
    *
    *  This is a convenience method. The low-level functionality is the LayoutToNetlistWriter.
    */
@@ -793,6 +821,8 @@ public:
    *  @brief Loads the database from the given path
    *
    *  This is a convenience method. The low-level functionality is the LayoutToNetlistReader.
+   *  Files in the binary format are detected automatically. The net geometry is loaded
+   *  entirely in this case too.
    */
   void load (const std::string &path);
 
@@ -802,10 +832,42 @@ public:
    *  This method analyses the file and will create a LayoutToNetlist object
    *  or one of a derived class (specifically LayoutVsSchematic).
    *
+   *  For files in the binary format, the net geometry is not loaded initially.
+   *  It is loaded on demand, e.g. by "ensure_net_geometry".
+   *
    *  The returned object is new'd one and must be deleted by the caller.
    */
   static db::LayoutToNetlist *create_from_file (const std::string &path);
 
+  /**
+   *  @brief Installs a loader for net geometry which is provided on demand
+   *
+   *  The LayoutToNetlist object will take ownership over the loader. Passing 0
+   *  will remove the loader.
+   */
+  void set_geometry_loader (db::LayoutToNetlistGeometryLoader *loader);
+
+  /**
+   *  @brief Returns a value indicating whether there is net geometry which is not loaded yet
+   */
+  bool has_pending_geometry () const
+  {
+    return mp_geometry_loader.get () != 0;
+  }
+
+  /**
+   *  @brief Makes sure the geometry of the given net is loaded
+   *
+   *  This includes the geometry of the subnets inside subcircuits.
+   *  Code accessing the net clusters directly should call this method first.
+   */
+  void ensure_net_geometry (const db::Net &net) const;
+
+  /**
+   *  @brief Makes sure all net geometry is loaded
+   */
+  void ensure_geometry () const;
+
 private:
   //  no copying
   LayoutToNetlist (const db::LayoutToNetlist &other);
@@ -830,6 +892,7 @@ private:
   double m_device_scaling;
   db::DeepLayer m_dummy_layer;
   std::string m_generator;
+  std::unique_ptr<db::LayoutToNetlistGeometryLoader> mp_geometry_loader;
 
   struct CellReuseTableKey
   {
@@ -0,0 +1,832 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "dbLayoutToNetlistBinaryFile.h"
+#include "dbLayoutToNetlist.h"
+#include "dbLayoutVsSchematic.h"
+#include "dbLayoutVsSchematicReader.h"
+#include "dbLayoutVsSchematicWriter.h"
+#include "dbLayoutVsSchematicFormatDefs.h"
+#include "tlFileUtils.h"
+#include "tlTimer.h"
+#include "tlLog.h"
+#include "tlProgress.h"
+
+#include <fstream>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+#include <stdint.h>
+
+namespace db
+{
+
+//  The file layout is:
+//
+//    magic ("KLayout-L2N-binary\0"), version
+//    netlist section: the short standard format of the L2N or LVS DB without the net geometry
+//    net sections: number of shapes, shapes
+//    index: layer names, number of circuits, per circuit: name, number of nets, per net: net id, offset, size
+//    position of the index (8 bytes, little endian)
+//
+//  Unsigned integers are stored as variable-length integers with 7 bits per byte,
+//  least significant group first. Signed integers are zig-zag encoded.
+//  A shape is stored as the layer's index in the layer name list, the shape type and
+//  the points. Points are stored as differences to the previous point of the same net.
+//  Net ids are the positions of the nets inside their circuit, starting with 1 - these
+//  are the ids the standard format uses.
+
+static const char binary_magic [] = "KLayout-L2N-binary";
+static const unsigned int binary_version = 1;
+
+static const unsigned char shape_type_box = 0;
+static const unsigned char shape_type_polygon = 1;
+static const unsigned char shape_type_text = 2;
+
+// -------------------------------------------------------------------------------------------
+//  Binary writer and reader utilities
+
+namespace
+{
+
+class BinaryWriter
+{
+public:
+  BinaryWriter (tl::OutputStream &os)
+    : m_os (os), m_pos (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  void put_bytes (const char *b, size_t n)
+  {
+    m_os.put (b, n);
+    m_pos += n;
+  }
+
+  void put_byte (unsigned char b)
+  {
+    char c = char (b);
+    put_bytes (&c, 1);
+  }
+
+  void put_uint (uint64_t v)
+  {
+    do {
+      unsigned char b = (unsigned char) (v & 0x7f);
+      v >>= 7;
+      if (v) {
+        b |= 0x80;
+      }
+      put_byte (b);
+    } while (v);
+  }
+
+  void put_int (int64_t v)
+  {
+    put_uint (v < 0 ? ((uint64_t (-(v + 1)) << 1) | 1) : (uint64_t (v) << 1));
+  }
+
+  void put_fixed (uint64_t u)
+  {
+    char b [8];
+    for (unsigned int i = 0; i < 8; ++i) {
+      b [i] = char ((u >> (8 * i)) & 0xff);
+    }
+    put_bytes (b, 8);
+  }
+
+  void put_string (const std::string &s)
+  {
+    put_uint (s.size ());
+    put_bytes (s.c_str (), s.size ());
+  }
+
+  size_t pos () const
+  {
+    return m_pos;
+  }
+
+private:
+  tl::OutputStream &m_os;
+  size_t m_pos;
+};
+
+class BinaryReader
+{
+public:
+  BinaryReader (tl::InputStream &is)
+    : m_is (is)
+  {
+    //  .. nothing yet ..
+  }
+
+  const char *get_bytes (size_t n)
+  {
+    const char *b = m_is.get (n);
+    if (! b) {
+      throw tl::Exception (tl::to_string (tr ("Unexpected end of file in binary L2N file")));
+    }
+    return b;
+  }
+
+  unsigned char get_byte ()
+  {
+    return (unsigned char) *get_bytes (1);
+  }
+
+  uint64_t get_uint ()
+  {
+    uint64_t v = 0;
+    unsigned int s = 0;
+    unsigned char b;
+    do {
+      if (s > 63) {
+        throw tl::Exception (tl::to_string (tr ("Integer overflow in binary L2N file")));
+      }
+      b = get_byte ();
+      v |= uint64_t (b & 0x7f) << s;
+      s += 7;
+    } while ((b & 0x80) != 0);
+    return v;
+  }
+
+  size_t get_size ()
+  {
+    return size_t (get_uint ());
+  }
+
+  int64_t get_int ()
+  {
+    uint64_t u = get_uint ();
+    if ((u & 1) != 0) {
+      return -int64_t (u >> 1) - 1;
+    } else {
+      return int64_t (u >> 1);
+    }
+  }
+
+  std::string get_string ()
+  {
+    size_t n = get_size ();
+    if (n == 0) {
+      return std::string ();
+    }
+    const char *b = get_bytes (n);
+    return std::string (b, n);
+  }
+
+private:
+  tl::InputStream &m_is;
+};
+
+static std::string name_for_layer (const db::LayoutToNetlist *l2n, unsigned int l)
+{
+  std::string n = l2n->name (l);
+  if (n.empty ()) {
+    n = "L" + tl::to_string (l);
+  }
+  return n;
+}
+
+// -------------------------------------------------------------------------------------------
+//  Net geometry writer
+
+/**
+ *  @brief Writes the geometry of the nets
+ *
+ *  The shapes are collected the same way the standard writer does: shapes from
+ *  child cells which are neither circuits nor device abstracts are included in
+ *  the net.
+ */
+class NetGeometryWriter
+  : private db::CircuitCallback
+{
+public:
+  NetGeometryWriter (const db::LayoutToNetlist *l2n, BinaryWriter &writer)
+    : mp_l2n (l2n), mp_netlist (l2n->netlist ()), mp_writer (&writer)
+  {
+    const db::Connectivity &conn = l2n->connectivity ();
+    for (db::Connectivity::layer_iterator l = conn.begin_layers (); l != conn.end_layers (); ++l) {
+      m_layers.push_back (*l);
+    }
+  }
+
+  const std::vector<unsigned int> &layers () const
+  {
+    return m_layers;
+  }
+
+  /**
+   *  @brief Writes the net's geometry and returns false if the net does not have shapes
+   */
+  bool write (const db::Net &net)
+  {
+    const db::hier_clusters<db::NetShape> &clusters = mp_l2n->net_clusters ();
+    db::cell_index_type cci = net.circuit ()->cell_index ();
+
+    m_shapes.clear ();
+
+    for (std::vector<unsigned int>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+
+      db::cell_index_type prev_ci = cci;
+
+      for (db::recursive_cluster_shape_iterator<db::NetShape> si (clusters, *l, cci, net.cluster_id (), this); ! si.at_end (); ) {
+
+        //  NOTE: we don't recursive into circuits and device abstracts - see the standard writer
+        db::cell_index_type ci = si.cell_index ();
+        if (ci != prev_ci && ci != cci && ! new_cell (ci)) {
+          si.skip_cell ();
+        } else {
+          m_shapes.push_back (ShapeRef (l - m_layers.begin (), si.operator-> (), si.trans ()));
+          prev_ci = ci;
+          ++si;
+        }
+
+      }
+
+    }
+
+    if (m_shapes.empty ()) {
+      return false;
+    }
+
+    m_ref = db::Point ();
+
+    mp_writer->put_uint (m_shapes.size ());
+    for (std::vector<ShapeRef>::const_iterator s = m_shapes.begin (); s != m_shapes.end (); ++s) {
+      write_shape (s->layer, *s->shape, s->trans);
+    }
+
+    return true;
+  }
+
+private:
+  struct ShapeRef
+  {
+    ShapeRef (size_t _layer, const db::NetShape *_shape, const db::ICplxTrans &_trans)
+      : layer (_layer), shape (_shape), trans (_trans)
+    { }
+
+    size_t layer;
+    const db::NetShape *shape;
+    db::ICplxTrans trans;
+  };
+
+  const db::LayoutToNetlist *mp_l2n;
+  const db::Netlist *mp_netlist;
+  BinaryWriter *mp_writer;
+  std::vector<unsigned int> m_layers;
+  std::vector<ShapeRef> m_shapes;
+  db::Point m_ref;
+
+  void write_point (const db::Point &pt)
+  {
+    mp_writer->put_int (int64_t (pt.x ()) - int64_t (m_ref.x ()));
+    mp_writer->put_int (int64_t (pt.y ()) - int64_t (m_ref.y ()));
+    m_ref = pt;
+  }
+
+  void write_shape (size_t layer, const db::NetShape &s, const db::ICplxTrans &tr)
+  {
+    if (s.type () == db::NetShape::Polygon) {
+
+      db::PolygonRef pr = s.polygon_ref ();
+      db::ICplxTrans t = tr * db::ICplxTrans (pr.trans ());
+
+      const db::Polygon &poly = pr.obj ();
+      if (poly.is_box ()) {
+
+        db::Box box = t * poly.box ();
+
+        mp_writer->put_uint (layer);
+        mp_writer->put_byte (shape_type_box);
+        write_point (box.p1 ());
+        write_point (box.p2 ());
+
+      } else {
+
+        db::Polygon tp = poly.transformed (t);
+
+        mp_writer->put_uint (layer);
+        mp_writer->put_byte (shape_type_polygon);
+        mp_writer->put_uint (tp.holes () + 1);
+        for (unsigned int c = 0; c <= tp.holes (); ++c) {
+          const db::Polygon::contour_type &ctr = tp.contour (c);
+          mp_writer->put_uint (ctr.size ());
+          for (size_t i = 0; i < ctr.size (); ++i) {
+            write_point (ctr [i]);
+          }
+        }
+
+      }
+
+    } else if (s.type () == db::NetShape::Text) {
+
+      db::TextRef txtr = s.text_ref ();
+      db::ICplxTrans t = tr * db::ICplxTrans (txtr.trans ());
+
+      mp_writer->put_uint (layer);
+      mp_writer->put_byte (shape_type_text);
+      mp_writer->put_string (txtr.obj ().string ());
+      write_point (t * (db::Point () + txtr.obj ().trans ().disp ()));
+
+    }
+  }
+
+  //  implementation of CircuitCallback
+  bool new_cell (cell_index_type ci) const
+  {
+    return ! (mp_netlist->circuit_by_cell_index (ci) || mp_netlist->device_abstract_by_cell_index (ci));
+  }
+};
+
+// -------------------------------------------------------------------------------------------
+//  Net geometry loader
+
+static void
+read_file_section (std::ifstream &is, const std::string &path, size_t offset, size_t size, std::vector<char> &buffer)
+{
+  buffer.resize (size);
+  is.clear ();
+  is.seekg (std::streamoff (offset), std::ios::beg);
+  if (size > 0) {
+    is.read (&buffer.front (), std::streamsize (size));
+  }
+  if (! is.good ()) {
+    throw tl::Exception (tl::sprintf (tl::to_string (tr ("Unable to read from binary L2N file %s")), path));
+  }
+}
+
+static void
+open_file (std::ifstream &is, const std::string &path)
+{
+  is.open (path.c_str (), std::ios::in | std::ios::binary);
+  if (! is.good ()) {
+    throw tl::Exception (tl::sprintf (tl::to_string (tr ("Unable to open binary L2N file %s")), path));
+  }
+}
+
+/**
+ *  @brief Loads the net geometry from the net sections of a binary file
+ */
+class NetGeometryLoader
+  : public db::LayoutToNetlistGeometryLoader
+{
+public:
+  NetGeometryLoader (const std::string &path, const std::vector<unsigned int> &layers)
+    : m_path (path), m_layers (layers)
+  {
+    //  .. nothing yet ..
+  }
+
+  void add_section (db::cell_index_type ci, size_t cluster_id, size_t offset, size_t size)
+  {
+    m_sections.insert (std::make_pair (std::make_pair (ci, cluster_id), std::make_pair (offset, size)));
+  }
+
+  virtual void load_cluster (db::LayoutToNetlist *l2n, db::cell_index_type ci, size_t cluster_id)
+  {
+    if (m_visited.find (std::make_pair (ci, cluster_id)) != m_visited.end ()) {
+      return;
+    }
+
+    std::ifstream is;
+    open_file (is, m_path);
+
+    db::LayoutLocker layout_locker (l2n->internal_layout ());
+    load_cluster_rec (l2n, is, ci, cluster_id);
+  }
+
+  virtual void load_all (db::LayoutToNetlist *l2n)
+  {
+    if (m_sections.empty ()) {
+      return;
+    }
+
+    tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (tr ("Loading net geometry: ")) + m_path);
+
+    std::ifstream is;
+    open_file (is, m_path);
+
+    db::LayoutLocker layout_locker (l2n->internal_layout ());
+
+    tl::RelativeProgress progress (tl::to_string (tr ("Loading net geometry")), m_sections.size (), 1000);
+
+    for (std::map<std::pair<db::cell_index_type, size_t>, std::pair<size_t, size_t> >::const_iterator s = m_sections.begin (); s != m_sections.end (); ++s) {
+      load_section (l2n, is, s->first.first, s->first.second, s->second.first, s->second.second);
+      ++progress;
+    }
+
+    m_sections.clear ();
+  }
+
+private:
+  std::string m_path;
+  std::vector<unsigned int> m_layers;
+  std::map<std::pair<db::cell_index_type, size_t>, std::pair<size_t, size_t> > m_sections;
+  std::set<std::pair<db::cell_index_type, size_t> > m_visited;
+
+  void load_cluster_rec (db::LayoutToNetlist *l2n, std::ifstream &is, db::cell_index_type ci, size_t cluster_id)
+  {
+    //  a visited cluster is loaded together with all clusters connected to it from child cells
+    if (! m_visited.insert (std::make_pair (ci, cluster_id)).second) {
+      return;
+    }
+
+    std::map<std::pair<db::cell_index_type, size_t>, std::pair<size_t, size_t> >::iterator s = m_sections.find (std::make_pair (ci, cluster_id));
+    if (s != m_sections.end ()) {
+      load_section (l2n, is, ci, cluster_id, s->second.first, s->second.second);
+      m_sections.erase (s);
+    }
+
+    const db::connected_clusters<db::NetShape>::connections_type &connections = l2n->net_clusters ().clusters_per_cell (ci).connections_for_cluster (cluster_id);
+    for (db::connected_clusters<db::NetShape>::connections_type::const_iterator c = connections.begin (); c != connections.end (); ++c) {
+      load_cluster_rec (l2n, is, c->inst_cell_index (), c->id ());
+    }
+  }
+
+  db::Point read_point (BinaryReader &r, db::Point &ref)
+  {
+    int64_t x = int64_t (ref.x ()) + r.get_int ();
+    int64_t y = int64_t (ref.y ()) + r.get_int ();
+    ref = db::Point (db::Coord (x), db::Coord (y));
+    return ref;
+  }
+
+  void load_section (db::LayoutToNetlist *l2n, std::ifstream &is, db::cell_index_type ci, size_t cluster_id, size_t offset, size_t size)
+  {
+    std::vector<char> buffer;
+    read_file_section (is, m_path, offset, size, buffer);
+
+    tl::InputMemoryStream mem (buffer.empty () ? 0 : &buffer.front (), buffer.size ());
+    tl::InputStream stream (mem);
+    BinaryReader r (stream);
+
+    db::Layout *ly = l2n->internal_layout ();
+    db::Cell &cell = ly->cell (ci);
+    db::local_cluster<db::NetShape> &lc = l2n->net_clusters ().clusters_per_cell (ci).cluster_by_id_for_update (cluster_id);
+
+    db::Point ref;
+    std::vector<db::Point> pts;
+
+    size_t n = r.get_size ();
+    for (size_t i = 0; i < n; ++i) {
+
+      size_t li = r.get_size ();
+      if (li >= m_layers.size ()) {
+        throw tl::Exception (tl::sprintf (tl::to_string (tr ("Invalid layer index in binary L2N file %s")), m_path));
+      }
+      unsigned int layer = m_layers [li];
+
+      db::NetShape shape;
+
+      unsigned char type = r.get_byte ();
+      if (type == shape_type_box) {
+
+        db::Point p1 = read_point (r, ref);
+        db::Point p2 = read_point (r, ref);
+        shape = db::PolygonRef (db::Polygon (db::Box (p1, p2)), ly->shape_repository ());
+
+      } else if (type == shape_type_polygon) {
+
+        size_t nc = r.get_size ();
+        if (nc == 0) {
+          throw tl::Exception (tl::sprintf (tl::to_string (tr ("Invalid polygon in binary L2N file %s")), m_path));
+        }
+
+        db::Polygon poly;
+        for (size_t c = 0; c < nc; ++c) {
+          size_t np = r.get_size ();
+          pts.clear ();
+          pts.reserve (np);
+          for (size_t p = 0; p < np; ++p) {
+            pts.push_back (read_point (r, ref));
+          }
+          if (c == 0) {
+            poly.assign_hull (pts.begin (), pts.end ());
+          } else {
+            poly.insert_hole (pts.begin (), pts.end ());
+          }
+        }
+
+        shape = db::PolygonRef (poly, ly->shape_repository ());
+
+      } else if (type == shape_type_text) {
+
+        std::string text = r.get_string ();
+        db::Point pt = read_point (r, ref);
+        shape = db::TextRef (db::Text (text, db::Trans (pt - db::Point ())), ly->shape_repository ());
+
+      } else {
+        throw tl::Exception (tl::sprintf (tl::to_string (tr ("Invalid shape type in binary L2N file %s")), m_path));
+      }
+
+      lc.add (shape, layer);
+      shape.insert_into (cell.shapes (layer));
+
+    }
+  }
+};
+
+}
+
+// -------------------------------------------------------------------------------------------
+//  Format detection
+
+bool is_l2n_binary_file_name (const std::string &fn)
+{
+  std::string ext = tl::extension_last (fn);
+  return ext == "l2nb" || ext == "lvsdbb";
+}
+
+bool is_l2n_binary_file (const std::string &path)
+{
+  tl::InputStream stream (path);
+  const char *b = stream.get (sizeof (binary_magic));
+  return b && memcmp (b, binary_magic, sizeof (binary_magic)) == 0;
+}
+
+// -------------------------------------------------------------------------------------------
+//  LayoutToNetlistBinaryWriter implementation
+
+LayoutToNetlistBinaryWriter::LayoutToNetlistBinaryWriter (tl::OutputStream &stream)
+  : mp_stream (&stream)
+{
+  //  .. nothing yet ..
+}
+
+void LayoutToNetlistBinaryWriter::do_write (const db::LayoutToNetlist *l2n)
+{
+  if (! l2n->netlist ()) {
+    throw tl::Exception (tl::to_string (tr ("Can't write annotated netlist before the netlist has been created")));
+  }
+  if (! l2n->internal_layout ()) {
+    throw tl::Exception (tl::to_string (tr ("Can't write annotated netlist before the layout has been loaded")));
+  }
+
+  //  the netlist section is the short text format without the net geometry
+
+  tl::OutputMemoryStream text_mem;
+  {
+    tl::OutputStream text_stream (text_mem);
+    const db::LayoutVsSchematic *lvs = dynamic_cast<const db::LayoutVsSchematic *> (l2n);
+    if (lvs) {
+      db::LayoutVsSchematicStandardWriter writer (text_stream, true);
+      writer.set_with_net_geometry (false);
+      writer.write (lvs);
+    } else {
+      db::LayoutToNetlistStandardWriter writer (text_stream, true);
+      writer.set_with_net_geometry (false);
+      writer.write (l2n);
+    }
+    text_stream.flush ();
+  }
+
+  BinaryWriter w (*mp_stream);
+
+  w.put_bytes (binary_magic, sizeof (binary_magic));
+  w.put_uint (binary_version);
+
+  w.put_uint (text_mem.size ());
+  w.put_bytes (text_mem.data (), text_mem.size ());
+
+  //  the net sections
+
+  struct NetEntry
+  {
+    NetEntry (unsigned int _id, size_t _offset, size_t _size)
+      : id (_id), offset (_offset), size (_size)
+    { }
+
+    unsigned int id;
+    size_t offset, size;
+  };
+
+  NetGeometryWriter geometry_writer (l2n, w);
+  std::vector<std::pair<std::string, std::vector<NetEntry> > > index;
+
+  const db::Netlist *netlist = l2n->netlist ();
+
+  tl::RelativeProgress progress (tl::to_string (tr ("Writing binary L2N database")), netlist->circuit_count (), 1);
+
+  for (db::Netlist::const_circuit_iterator c = netlist->begin_circuits (); c != netlist->end_circuits (); ++c) {
+
+    index.push_back (std::make_pair (c->name (), std::vector<NetEntry> ()));
+    std::vector<NetEntry> &entries = index.back ().second;
+
+    unsigned int id = 0;
+    for (db::Circuit::const_net_iterator n = c->begin_nets (); n != c->end_nets (); ++n) {
+      ++id;
+      size_t pos = w.pos ();
+      if (geometry_writer.write (*n)) {
+        entries.push_back (NetEntry (id, pos, w.pos () - pos));
+      }
+    }
+
+    ++progress;
+
+  }
+
+  //  the index
+
+  size_t index_pos = w.pos ();
+
+  const std::vector<unsigned int> &layers = geometry_writer.layers ();
+  w.put_uint (layers.size ());
+  for (std::vector<unsigned int>::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+    w.put_string (name_for_layer (l2n, *l));
+  }
+
+  w.put_uint (index.size ());
+  for (std::vector<std::pair<std::string, std::vector<NetEntry> > >::const_iterator i = index.begin (); i != index.end (); ++i) {
+    w.put_string (i->first);
+    w.put_uint (i->second.size ());
+    for (std::vector<NetEntry>::const_iterator e = i->second.begin (); e != i->second.end (); ++e) {
+      w.put_uint (e->id);
+      w.put_uint (e->offset);
+      w.put_uint (e->size);
+    }
+  }
+
+  w.put_fixed (index_pos);
+}
+
+// -------------------------------------------------------------------------------------------
+//  LayoutToNetlistBinaryReader implementation
+
+LayoutToNetlistBinaryReader::LayoutToNetlistBinaryReader (const std::string &path)
+  : m_path (path), m_geometry_on_demand (false)
+{
+  tl::InputStream stream (path);
+  BinaryReader r (stream);
+
+  const char *magic = r.get_bytes (sizeof (binary_magic));
+  if (memcmp (magic, binary_magic, sizeof (binary_magic)) != 0) {
+    throw tl::Exception (tl::sprintf (tl::to_string (tr ("%s is not a binary L2N file")), path));
+  }
+
+  unsigned int version = (unsigned int) r.get_uint ();
+  if (version != binary_version) {
+    throw tl::Exception (tl::sprintf (tl::to_string (tr ("Unsupported version %d of binary L2N file %s")), version, path));
+  }
+
+  m_netlist_text = r.get_string ();
+}
+
+bool LayoutToNetlistBinaryReader::is_lvs () const
+{
+  return m_netlist_text.find (db::lvs_std_format::keys<true>::lvs_magic_string) == 0;
+}
+
+void LayoutToNetlistBinaryReader::do_read (db::LayoutToNetlist *l2n)
+{
+  if (is_lvs ()) {
+    db::LayoutVsSchematic *lvs = dynamic_cast<db::LayoutVsSchematic *> (l2n);
+    if (! lvs) {
+      throw tl::Exception (tl::sprintf (tl::to_string (tr ("Binary L2N file %s holds a LVS database")), m_path));
+    }
+    read_lvs (lvs);
+    return;
+  }
+
+  tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (tr ("File read: ")) + m_path);
+
+  try {
+    tl::InputMemoryStream mem (m_netlist_text.c_str (), m_netlist_text.size ());
+    tl::InputStream stream (mem);
+    db::LayoutToNetlistStandardReader reader (stream);
+    reader.read (l2n);
+  } catch (tl::Exception &ex) {
+    throw tl::Exception (tl::sprintf (tl::to_string (tr ("%s (netlist section of %s)")), ex.msg (), m_path));
+  }
+
+  install_geometry (l2n);
+}
+
+void LayoutToNetlistBinaryReader::read_lvs (db::LayoutVsSchematic *lvs)
+{
+  if (! is_lvs ()) {
+    throw tl::Exception (tl::sprintf (tl::to_string (tr ("Binary L2N file %s does not hold a LVS database")), m_path));
+  }
+
+  tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (tr ("File read: ")) + m_path);
+
+  try {
+    tl::InputMemoryStream mem (m_netlist_text.c_str (), m_netlist_text.size ());
+    tl::InputStream stream (mem);
+    db::LayoutVsSchematicStandardReader reader (stream);
+    reader.read (lvs);
+  } catch (tl::Exception &ex) {
+    throw tl::Exception (tl::sprintf (tl::to_string (tr ("%s (netlist section of %s)")), ex.msg (), m_path));
+  }
+
+  install_geometry (lvs);
+}
+
+void LayoutToNetlistBinaryReader::install_geometry (db::LayoutToNetlist *l2n)
+{
+  std::ifstream is;
+  open_file (is, m_path);
+
+  is.seekg (0, std::ios::end);
+  size_t file_size = size_t (is.tellg ());
+  if (file_size < 8) {
+    throw tl::Exception (tl::sprintf (tl::to_string (tr ("Binary L2N file %s is truncated")), m_path));
+  }
+
+  std::vector<char> buffer;
+  read_file_section (is, m_path, file_size - 8, 8, buffer);
+
+  uint64_t index_pos = 0;
+  for (unsigned int i = 0; i < 8; ++i) {
+    index_pos |= uint64_t ((unsigned char) buffer [i]) << (8 * i);
+  }
+  if (index_pos > file_size - 8) {
+    throw tl::Exception (tl::sprintf (tl::to_string (tr ("Invalid index position in binary L2N file %s")), m_path));
+  }
+
+  read_file_section (is, m_path, size_t (index_pos), file_size - 8 - size_t (index_pos), buffer);
+
+  tl::InputMemoryStream index_mem (buffer.empty () ? 0 : &buffer.front (), buffer.size ());
+  tl::InputStream index_stream (index_mem);
+  BinaryReader r (index_stream);
+
+  std::vector<unsigned int> layers;
+  size_t nlayers = r.get_size ();
+  for (size_t i = 0; i < nlayers; ++i) {
+    std::string name = r.get_string ();
+    std::unique_ptr<db::Region> region (l2n->layer_by_name (name));
+    if (! region.get ()) {
+      throw tl::Exception (tl::sprintf (tl::to_string (tr ("Not a valid layer name in binary L2N file %s: %s")), m_path, name));
+    }
+    layers.push_back (l2n->layer_of (*region));
+  }
+
+  std::unique_ptr<NetGeometryLoader> loader (new NetGeometryLoader (m_path, layers));
+
+  db::Netlist *netlist = l2n->netlist ();
+
+  size_t ncircuits = r.get_size ();
+  for (size_t i = 0; i < ncircuits; ++i) {
+
+    std::string name = r.get_string ();
+    const db::Circuit *circuit = netlist->circuit_by_name (name);
+    if (! circuit) {
+      throw tl::Exception (tl::sprintf (tl::to_string (tr ("Not a valid circuit name in binary L2N file %s: %s")), m_path, name));
+    }
+
+    std::vector<const db::Net *> nets;
+    nets.reserve (circuit->net_count ());
+    for (db::Circuit::const_net_iterator n = circuit->begin_nets (); n != circuit->end_nets (); ++n) {
+      nets.push_back (n.operator-> ());
+    }
+
+    size_t nnets = r.get_size ();
+    for (size_t j = 0; j < nnets; ++j) {
+
+      size_t id = r.get_size ();
+      size_t offset = r.get_size ();
+      size_t size = r.get_size ();
+
+      if (id == 0 || id > nets.size ()) {
+        throw tl::Exception (tl::sprintf (tl::to_string (tr ("Not a valid net ID in binary L2N file %s: %d")), m_path, int (id)));
+      }
+      if (offset + size > size_t (index_pos)) {
+        throw tl::Exception (tl::sprintf (tl::to_string (tr ("Invalid net section position in binary L2N file %s")), m_path));
+      }
+
+      loader->add_section (circuit->cell_index (), nets [id - 1]->cluster_id (), offset, size);
+
+    }
+
+  }
+
+  if (m_geometry_on_demand) {
+    l2n->set_geometry_loader (loader.release ());
+  } else {
+    loader->load_all (l2n);
+  }
+}
+
+}
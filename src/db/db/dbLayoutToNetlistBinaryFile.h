@@ -0,0 +1,120 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef HDR_dbLayoutToNetlistBinaryFile
+#define HDR_dbLayoutToNetlistBinaryFile
+
+#include "dbCommon.h"
+#include "dbLayoutToNetlistReader.h"
+#include "dbLayoutToNetlistWriter.h"
+#include "tlStream.h"
+
+#include <string>
+
+namespace db
+{
+
+class LayoutToNetlist;
+class LayoutVsSchematic;
+
+/**
+ *  @brief Returns a value indicating whether the file name asks for the binary L2N or LVS DB format
+ *
+ *  The binary format is selected by the ".l2nb" and ".lvsdbb" suffixes.
+ */
+DB_PUBLIC bool is_l2n_binary_file_name (const std::string &fn);
+
+/**
+ *  @brief Returns a value indicating whether the given file is a binary L2N or LVS DB file
+ */
+DB_PUBLIC bool is_l2n_binary_file (const std::string &path);
+
+/**
+ *  @brief The binary writer for L2N and LVS databases
+ *
+ *  The binary format stores the netlist (for LVS databases: the layout and reference
+ *  netlist and the cross-reference) in a netlist section using the short version of
+ *  the standard format, but without the net geometry. The net geometry follows in
+ *  binary-encoded sections, one for each net. An index at the end of the file lists
+ *  the net sections with their file positions, so the geometry of individual nets
+ *  can be loaded on demand.
+ *
+ *  If the object written is a LayoutVsSchematic object, an LVS database is produced.
+ */
+class DB_PUBLIC LayoutToNetlistBinaryWriter
+  : public LayoutToNetlistWriterBase
+{
+public:
+  LayoutToNetlistBinaryWriter (tl::OutputStream &stream);
+
+protected:
+  void do_write (const db::LayoutToNetlist *l2n);
+
+private:
+  tl::OutputStream *mp_stream;
+};
+
+/**
+ *  @brief The binary reader for L2N and LVS databases
+ *
+ *  The reader reads the netlist section when it is constructed. "read" or "read_lvs" will
+ *  produce the netlist. If "geometry on demand" is enabled, the net geometry is not loaded
+ *  by "read". Instead, a geometry loader is installed in the LayoutToNetlist object which
+ *  loads the net geometry when requested (see LayoutToNetlist::ensure_net_geometry).
+ */
+class DB_PUBLIC LayoutToNetlistBinaryReader
+  : public LayoutToNetlistReaderBase
+{
+public:
+  LayoutToNetlistBinaryReader (const std::string &path);
+
+  /**
+   *  @brief Returns a value indicating whether the file holds an LVS database
+   */
+  bool is_lvs () const;
+
+  /**
+   *  @brief Specifies whether to load the net geometry on demand
+   *  The default is false, so all geometry is loaded by "read".
+   */
+  void set_geometry_on_demand (bool f)
+  {
+    m_geometry_on_demand = f;
+  }
+
+  /**
+   *  @brief Reads an LVS database
+   */
+  void read_lvs (db::LayoutVsSchematic *lvs);
+
+private:
+  std::string m_path;
+  std::string m_netlist_text;
+  bool m_geometry_on_demand;
+
+  virtual void do_read (db::LayoutToNetlist *l2n);
+  void install_geometry (db::LayoutToNetlist *l2n);
+};
+
+}
+
+#endif
@@ -43,6 +43,8 @@ LayoutToNetlistWriterBase::~LayoutToNetlistWriterBase ()
 
 void LayoutToNetlistWriterBase::write (const db::LayoutToNetlist *l2n)
 {
+  //  net geometry which is loaded on demand is needed now
+  l2n->ensure_geometry ();
   do_write (l2n);
 }
 
@@ -58,7 +60,8 @@ static const std::string indent2 ("  ");
 template <class Keys>
 std_writer_impl<Keys>::std_writer_impl (tl::OutputStream &stream, double dbu, const std::string &progress_description)
   : mp_stream (&stream), m_dbu (dbu), mp_netlist (0),
-    m_progress (progress_description.empty () ? tl::to_string (tr ("Writing L2N database")) : progress_description, 10000)
+    m_progress (progress_description.empty () ? tl::to_string (tr ("Writing L2N database")) : progress_description, 10000),
+    m_with_net_geometry (true)
 {
   m_progress.set_format (tl::to_string (tr ("%.0f MB")));
   m_progress.set_unit (1024 * 1024);
@@ -460,7 +463,7 @@ void std_writer_impl<Keys>::write (const db::Net &net, unsigned int id, const st
 
   bool any = false;
 
-  if (mp_l2n) {
+  if (mp_l2n && m_with_net_geometry) {
 
     reset_geometry_ref ();
 
@@ -729,7 +732,7 @@ template class std_writer_impl<l2n_std_format::keys<true> >;
 //  LayoutToNetlistStandardWriter implementation
 
 LayoutToNetlistStandardWriter::LayoutToNetlistStandardWriter (tl::OutputStream &stream, bool short_version)
-  : mp_stream (&stream), m_short_version (short_version)
+  : mp_stream (&stream), m_short_version (short_version), m_with_net_geometry (true)
 {
   //  .. nothing yet ..
 }
@@ -747,9 +750,11 @@ void LayoutToNetlistStandardWriter::do_write (const db::LayoutToNetlist *l2n)
 
   if (m_short_version) {
     l2n_std_format::std_writer_impl<l2n_std_format::keys<true> > writer (*mp_stream, dbu);
+    writer.set_with_net_geometry (m_with_net_geometry);
     writer.write (l2n);
   } else {
     l2n_std_format::std_writer_impl<l2n_std_format::keys<false> > writer (*mp_stream, dbu);
+    writer.set_with_net_geometry (m_with_net_geometry);
     writer.write (l2n);
   }
 }
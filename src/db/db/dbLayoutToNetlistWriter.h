@@ -56,6 +56,15 @@ public:
   void write (const db::LayoutToNetlist *l2n);
   void write (const db::Netlist *netlist, const db::LayoutToNetlist *l2n, bool nested, std::map<const db::Circuit *, std::map<const db::Net *, unsigned int> > *net2id_per_circuit);
 
+  /**
+   *  @brief Specifies whether to write the net geometry
+   *  If false, the nets are written without their shapes. The default is true.
+   */
+  void set_with_net_geometry (bool f)
+  {
+    m_with_net_geometry = f;
+  }
+
 protected:
   tl::OutputStream &stream ()
   {
@@ -69,6 +78,7 @@ private:
   const db::Netlist *mp_netlist;
   const db::LayoutToNetlist *mp_l2n;
   tl::AbsoluteProgress m_progress;
+  bool m_with_net_geometry;
 
   void write (bool nested, std::map<const db::Circuit *, std::map<const db::Net *, unsigned int> > *net2id_per_circuit);
   void write (const db::Circuit &circuit, const std::string &indent, std::map<const db::Circuit *, std::map<const db::Net *, unsigned int> > *net2id_per_circuit);
@@ -115,12 +125,22 @@ class DB_PUBLIC LayoutToNetlistStandardWriter
 public:
   LayoutToNetlistStandardWriter (tl::OutputStream &stream, bool short_version);
 
+  /**
+   *  @brief Specifies whether to write the net geometry
+   *  If false, the nets are written without their shapes. The default is true.
+   */
+  void set_with_net_geometry (bool f)
+  {
+    m_with_net_geometry = f;
+  }
+
 protected:
   void do_write (const db::LayoutToNetlist *l2n);
 
 private:
   tl::OutputStream *mp_stream;
   bool m_short_version;
+  bool m_with_net_geometry;
 };
 
 }
@@ -25,6 +25,8 @@
 #include "dbLayoutVsSchematic.h"
 #include "dbLayoutVsSchematicWriter.h"
 #include "dbLayoutVsSchematicReader.h"
+#include "dbLayoutToNetlistBinaryFile.h"
+#include "tlFileUtils.h"
 
 namespace db
 {
@@ -88,19 +90,33 @@ db::NetlistCrossReference *LayoutVsSchematic::make_cross_ref ()
 
 void LayoutVsSchematic::save (const std::string &path, bool short_format)
 {
-  tl::OutputStream stream (path);
-  db::LayoutVsSchematicStandardWriter writer (stream, short_format);
-  set_filename (path);
-  writer.write (this);
+  if (db::is_l2n_binary_file_name (path)) {
+    tl::OutputStream stream (path, tl::OutputStream::OM_Plain);
+    db::LayoutToNetlistBinaryWriter writer (stream);
+    set_filename (path);
+    writer.write (this);
+  } else {
+    tl::OutputStream stream (path);
+    db::LayoutVsSchematicStandardWriter writer (stream, short_format);
+    set_filename (path);
+    writer.write (this);
+  }
 }
 
 void LayoutVsSchematic::load (const std::string &path)
 {
-  tl::InputStream stream (path);
-  db::LayoutVsSchematicStandardReader reader (stream);
-  set_filename (path);
-  set_name (stream.filename ());
-  reader.read (this);
+  if (db::is_l2n_binary_file (path)) {
+    db::LayoutToNetlistBinaryReader reader (path);
+    set_filename (path);
+    set_name (tl::filename (path));
+    reader.read_lvs (this);
+  } else {
+    tl::InputStream stream (path);
+    db::LayoutVsSchematicStandardReader reader (stream);
+    set_filename (path);
+    set_name (stream.filename ());
+    reader.read (this);
+  }
 }
 
 }
@@ -148,7 +148,8 @@ public:
    *  @brief Saves the database to the given path
    *
    *  Currently, the internal format will be used. If "short_format" is true, the short version
-   *  of the format is used.
+   *  of the format is used. If the file name ends with ".lvsdbb", the binary format is used
+   *  (see LayoutToNetlistBinaryWriter).
    *
    *  This is a convenience method. The low-level functionality is the LayoutVsSchematicWriter.
    */
@@ -158,6 +159,7 @@ public:
    *  @brief Loads the database from the given path
    *
    *  This is a convenience method. The low-level functionality is the LayoutVsSchematicReader.
+   *  Files in the binary format are detected automatically.
    */
   void load (const std::string &path);
 
@@ -43,6 +43,8 @@ LayoutVsSchematicWriterBase::~LayoutVsSchematicWriterBase ()
 
 void LayoutVsSchematicWriterBase::write (const db::LayoutVsSchematic *lvs)
 {
+  //  net geometry which is loaded on demand is needed now
+  lvs->ensure_geometry ();
   do_write_lvs (lvs);
 }
 
@@ -213,7 +215,7 @@ void std_writer_impl<Keys>::write (const db::NetlistCrossReference *xref)
 //  LayoutVsSchematicStandardWriter implementation
 
 LayoutVsSchematicStandardWriter::LayoutVsSchematicStandardWriter (tl::OutputStream &stream, bool short_version)
-  : mp_stream (&stream), m_short_version (short_version)
+  : mp_stream (&stream), m_short_version (short_version), m_with_net_geometry (true)
 {
   //  .. nothing yet ..
 }
@@ -231,9 +233,11 @@ void LayoutVsSchematicStandardWriter::do_write_lvs (const db::LayoutVsSchematic
 
   if (m_short_version) {
     lvs_std_format::std_writer_impl<lvs_std_format::keys<true> > writer (*mp_stream, dbu);
+    writer.set_with_net_geometry (m_with_net_geometry);
     writer.write (lvs);
   } else {
     lvs_std_format::std_writer_impl<lvs_std_format::keys<false> > writer (*mp_stream, dbu);
+    writer.set_with_net_geometry (m_with_net_geometry);
     writer.write (lvs);
   }
 }
@@ -62,12 +62,22 @@ class DB_PUBLIC LayoutVsSchematicStandardWriter
 public:
   LayoutVsSchematicStandardWriter (tl::OutputStream &stream, bool short_version);
 
+  /**
+   *  @brief Specifies whether to write the net geometry
+   *  If false, the nets are written without their shapes. The default is true.
+   */
+  void set_with_net_geometry (bool f)
+  {
+    m_with_net_geometry = f;
+  }
+
 protected:
   void do_write_lvs (const db::LayoutVsSchematic *lvs);
 
 private:
   tl::OutputStream *mp_stream;
   bool m_short_version;
+  bool m_with_net_geometry;
 };
 
 }
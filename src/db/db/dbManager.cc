@@ -27,8 +27,11 @@
 #include "tlAssert.h"
 #include "tlProgress.h"
 #include "tlLog.h"
+#include "tlStream.h"
+#include "tlDeflate.h"
 
 #include <cstdio>
+#include <algorithm>
 
 namespace db
 {
@@ -37,7 +40,9 @@ Manager::Manager (bool enabled)
   : m_transactions (),
     m_current (m_transactions.begin ()), 
     m_opened (false), m_replay (false),
-    m_enabled (enabled)
+    m_enabled (enabled),
+    m_max_memory (0), m_spill_to_disk (false),
+    mp_spill_file (0)
 {
   //  .. nothing yet ..
 }
@@ -95,15 +100,25 @@ Manager::clear ()
   m_opened = false;
   erase_transactions (m_transactions.begin (), m_transactions.end ());
   m_current = m_transactions.begin ();
+
+  //  the history is empty now, so the spill file can be dropped
+  if (mp_spill_file) {
+    fclose (mp_spill_file);
+    mp_spill_file = 0;
+  }
+  m_spill_free.clear ();
 }
 
 void
 Manager::erase_transactions (transactions_t::iterator from, transactions_t::iterator to)
 {
   for (transactions_t::iterator i = from; i != to; ++i) {
-    for (operations_t::iterator o = i->first.begin (); o != i->first.end (); ++o) {
+    for (operations_t::iterator o = i->operations.begin (); o != i->operations.end (); ++o) {
       delete o->second;
     }
+    if (i->on_disk) {
+      release_spill_region (i->file_offset, i->file_size);
+    }
   }
   m_transactions.erase (from, to);
 }
@@ -115,18 +130,18 @@ Manager::transaction (const std::string &description, transaction_id_t join_with
 
     //  close transactions that are still open (was an assertion before)
     if (m_opened) {
-      tl::warn << tl::to_string (tr ("Transaction still opened: ")) << m_current->second;
+      tl::warn << tl::to_string (tr ("Transaction still opened: ")) << m_current->description;
       commit ();
     }
 
     tl_assert (! m_replay);
 
     if (! m_transactions.empty () && reinterpret_cast<transaction_id_t> (& m_transactions.back ()) == join_with) {
-      m_transactions.back ().second = description;
+      m_transactions.back ().description = description;
     } else {
       //  delete all following transactions and add a new one
       erase_transactions (m_current, m_transactions.end ());
-      m_transactions.push_back (transaction_t (operations_t (), description));
+      m_transactions.push_back (transaction_t (description));
     }
     m_current = m_transactions.end ();
     --m_current;
@@ -155,7 +170,7 @@ Manager::cancel ()
     tl_assert (! m_replay);
     m_opened = false;
 
-    if (m_current->first.begin () != m_current->first.end ()) {
+    if (m_current->operations.begin () != m_current->operations.end ()) {
       ++m_current;
       undo ();
     }
@@ -177,8 +192,13 @@ Manager::commit ()
     m_opened = false;
 
     //  delete transactions that are empty
-    if (m_current->first.begin () != m_current->first.end ()) {
+    if (m_current->operations.begin () != m_current->operations.end ()) {
+      //  NOTE: computing the size may be expensive, so we do it only if a budget is set
+      if (m_max_memory > 0) {
+        update_mem_size (*m_current);
+      }
       ++m_current;
+      enforce_memory_budget ();
     } else {
       erase_transactions (m_current, m_transactions.end ());
       m_current = m_transactions.end ();
@@ -201,11 +221,13 @@ Manager::undo ()
   m_replay = true;
   --m_current;
 
-  tl::RelativeProgress progress (tl::to_string (tr ("Undoing")), m_current->first.size (), 10);
+  tl::RelativeProgress progress (tl::to_string (tr ("Undoing")), m_current->operations.size (), 10);
 
   try {
 
-    for (operations_t::reverse_iterator o = m_current->first.rbegin (); o != m_current->first.rend (); ++o) {
+    expand_transaction (*m_current);
+
+    for (operations_t::reverse_iterator o = m_current->operations.rbegin (); o != m_current->operations.rend (); ++o) {
 
       tl_assert (o->second->is_done ());
       db::Object *obj = object_by_id (o->first);
@@ -236,12 +258,14 @@ Manager::redo ()
   tl_assert (! m_opened);
   tl_assert (! m_replay);
 
-  tl::RelativeProgress progress (tl::to_string (tr ("Redoing")), m_current->first.size (), 10);
+  tl::RelativeProgress progress (tl::to_string (tr ("Redoing")), m_current->operations.size (), 10);
 
   try {
 
     m_replay = true;
-    for (operations_t::iterator o = m_current->first.begin (); o != m_current->first.end (); ++o) {
+    expand_transaction (*m_current);
+
+    for (operations_t::iterator o = m_current->operations.begin (); o != m_current->operations.end (); ++o) {
 
       tl_assert (! o->second->is_done ());
       db::Object *obj = object_by_id (o->first);
@@ -269,7 +293,7 @@ Manager::available_undo () const
   } else {
     transactions_t::const_iterator t = m_current;
     --t;
-    return std::make_pair (true, t->second);
+    return std::make_pair (true, t->description);
   }
 }
 
@@ -279,7 +303,7 @@ Manager::available_redo () const
   if (m_opened || m_current == m_transactions.end ()) {
     return std::make_pair (false, std::string (""));
   } else {
-    return std::make_pair (true, m_current->second);
+    return std::make_pair (true, m_current->description);
   }
 }
 
@@ -289,10 +313,10 @@ Manager::last_queued (db::Object *object)
   tl_assert (m_opened);
   tl_assert (! m_replay);
 
-  if (m_current->first.empty () || m_current->first.back ().first != object->id ()) {
+  if (m_current->operations.empty () || m_current->operations.back ().first != object->id ()) {
     return 0;
   } else {
-    return m_current->first.back ().second;
+    return m_current->operations.back ().second;
   }
 }
 
@@ -312,11 +336,281 @@ Manager::queue (db::Object *object, db::Op *op)
       op->set_done (true);
     }
 
-    m_current->first.push_back (std::make_pair (object->id (), op));
+    m_current->operations.push_back (std::make_pair (object->id (), op));
+
+  }
+}
+
+
+
+void
+Manager::set_max_memory (size_t max_memory)
+{
+  m_max_memory = max_memory;
+  if (m_max_memory == 0) {
+    return;
+  }
+
+  //  the sizes of the transactions committed without a budget are computed now
+  for (transactions_t::iterator t = m_transactions.begin (); t != m_transactions.end (); ++t) {
+    if (! t->mem_size_valid) {
+      update_mem_size (*t);
+    }
+  }
+
+  if (! m_opened && ! m_replay) {
+    enforce_memory_budget ();
+  }
+}
+
+size_t
+Manager::transaction_mem_size (const transaction_t &t)
+{
+  size_t n = sizeof (transaction_t) + t.description.capacity () + t.compacted_data.capacity ();
+  for (operations_t::const_iterator o = t.operations.begin (); o != t.operations.end (); ++o) {
+    //  NOTE: the list node is approximated by two pointers
+    n += sizeof (operation_t) + 2 * sizeof (void *) + o->second->mem_size ();
+  }
+  return n;
+}
+
+void
+Manager::update_mem_size (transaction_t &t)
+{
+  t.mem_size = transaction_mem_size (t);
+  t.mem_size_valid = true;
+}
+
+size_t
+Manager::memory_used () const
+{
+  size_t n = 0;
+  for (transactions_t::const_iterator t = m_transactions.begin (); t != m_transactions.end (); ++t) {
+    n += t->mem_size_valid ? t->mem_size : transaction_mem_size (*t);
+  }
+  return n;
+}
+
+size_t
+Manager::spill_file_size () const
+{
+  if (! mp_spill_file || fseek (mp_spill_file, 0, SEEK_END) != 0) {
+    return 0;
+  }
+
+  long pos = ftell (mp_spill_file);
+  return pos > 0 ? size_t (pos) : 0;
+}
+
+void
+Manager::enforce_memory_budget ()
+{
+  if (m_max_memory == 0 || m_current == m_transactions.begin ()) {
+    return;
+  }
+
+  size_t used = memory_used ();
+  if (used <= m_max_memory) {
+    return;
+  }
+
+  //  the most recent transaction is left intact, so a single undo is fast
+  transactions_t::iterator last = m_current;
+  --last;
+
+  for (transactions_t::iterator t = m_transactions.begin (); t != last && used > m_max_memory; ++t) {
+    if (! t->compacted) {
+      used -= t->mem_size;
+      compact_transaction (*t);
+      used += t->mem_size;
+    }
+  }
+
+  if (m_spill_to_disk) {
+    for (transactions_t::iterator t = m_transactions.begin (); t != last && used > m_max_memory; ++t) {
+      if (t->compacted && ! t->on_disk && ! t->compacted_data.empty ()) {
+        used -= t->mem_size;
+        spill_transaction (*t);
+        used += t->mem_size;
+      }
+    }
+  }
+}
+
+void
+Manager::compact_transaction (transaction_t &t)
+{
+  std::string data;
+  for (operations_t::iterator o = t.operations.begin (); o != t.operations.end (); ++o) {
+    if (o->second->compact (data)) {
+      o->second->m_compacted = true;
+    }
+  }
+
+  t.compacted = true;
+  t.uncompressed_size = data.size ();
+
+  if (! data.empty ()) {
+
+    tl::OutputStringStream oss;
+    {
+      tl::OutputStream os (oss);
+      tl::DeflateFilter deflate (os);
+      deflate.put (data.c_str (), data.size ());
+      deflate.flush ();
+      os.flush ();
+    }
+
+    std::string compressed = oss.string ();
+    t.compacted_data.swap (compressed);
+
+  }
+
+  update_mem_size (t);
+}
+
+void
+Manager::spill_transaction (transaction_t &t)
+{
+  if (! mp_spill_file) {
+    mp_spill_file = tmpfile ();
+    if (! mp_spill_file) {
+      //  no temporary file available: keep the data in memory
+      return;
+    }
+  }
+
+  //  reuse the space of transactions restored or discarded before, append otherwise
+  long pos = allocate_spill_region (t.compacted_data.size ());
+  if (pos >= 0) {
+    if (fseek (mp_spill_file, pos, SEEK_SET) != 0) {
+      release_spill_region (pos, t.compacted_data.size ());
+      return;
+    }
+  } else {
+    if (fseek (mp_spill_file, 0, SEEK_END) != 0) {
+      return;
+    }
+    pos = ftell (mp_spill_file);
+    if (pos < 0) {
+      return;
+    }
+  }
+
+  if (fwrite (t.compacted_data.c_str (), 1, t.compacted_data.size (), mp_spill_file) != t.compacted_data.size ()) {
+    release_spill_region (pos, t.compacted_data.size ());
+    return;
+  }
+
+  t.on_disk = true;
+  t.file_offset = pos;
+  t.file_size = t.compacted_data.size ();
+  std::string ().swap (t.compacted_data);
+
+  update_mem_size (t);
+}
+
+long
+Manager::allocate_spill_region (size_t size)
+{
+  //  first fit
+  for (std::map<long, size_t>::iterator r = m_spill_free.begin (); r != m_spill_free.end (); ++r) {
+    if (r->second >= size) {
+      long pos = r->first;
+      size_t left = r->second - size;
+      m_spill_free.erase (r);
+      if (left > 0) {
+        m_spill_free.insert (std::make_pair (pos + long (size), left));
+      }
+      return pos;
+    }
+  }
+
+  return -1;
+}
+
+void
+Manager::release_spill_region (long offset, size_t size)
+{
+  if (size == 0) {
+    return;
+  }
 
+  std::map<long, size_t>::iterator r = m_spill_free.insert (std::make_pair (offset, size)).first;
+
+  //  join with the following free region
+  std::map<long, size_t>::iterator rn = r;
+  ++rn;
+  if (rn != m_spill_free.end () && r->first + long (r->second) == rn->first) {
+    r->second += rn->second;
+    m_spill_free.erase (rn);
+  }
+
+  //  join with the preceding free region
+  if (r != m_spill_free.begin ()) {
+    std::map<long, size_t>::iterator rp = r;
+    --rp;
+    if (rp->first + long (rp->second) == r->first) {
+      rp->second += r->second;
+      m_spill_free.erase (r);
+    }
   }
 }
 
+void
+Manager::expand_transaction (transaction_t &t)
+{
+  if (! t.compacted) {
+    return;
+  }
+
+  if (t.on_disk) {
+
+    std::string data;
+    data.resize (t.file_size);
+    if (! mp_spill_file || fseek (mp_spill_file, t.file_offset, SEEK_SET) != 0 ||
+        fread (&data [0], 1, t.file_size, mp_spill_file) != t.file_size) {
+      throw tl::Exception (tl::to_string (tr ("Unable to read undo data from temporary file")));
+    }
+
+    t.compacted_data.swap (data);
+    t.on_disk = false;
+    release_spill_region (t.file_offset, t.file_size);
+
+  }
+
+  std::string data;
+  data.reserve (t.uncompressed_size);
+
+  if (t.uncompressed_size > 0) {
+
+    tl::InputMemoryStream ims (t.compacted_data.c_str (), t.compacted_data.size ());
+    tl::InputStream is (ims);
+    tl::InflateFilter inflate (is);
+
+    //  NOTE: the inflate filter delivers limited chunks only
+    const size_t chunk = 4096;
+    while (data.size () < t.uncompressed_size) {
+      size_t n = std::min (chunk, t.uncompressed_size - data.size ());
+      data.append (inflate.get (n), n);
+    }
+
+  }
+
+  const char *p = data.c_str ();
+  for (operations_t::iterator o = t.operations.begin (); o != t.operations.end (); ++o) {
+    if (o->second->m_compacted) {
+      o->second->expand (p);
+      o->second->m_compacted = false;
+    }
+  }
+
+  t.compacted = false;
+  t.uncompressed_size = 0;
+  std::string ().swap (t.compacted_data);
+
+  update_mem_size (t);
+}
 
 } // namespace db
 
@@ -30,7 +30,9 @@
 
 #include <vector>
 #include <list>
+#include <map>
 #include <string>
+#include <cstdio>
 
 namespace db
 {
@@ -49,6 +51,7 @@ private:
   friend class Manager;
 
   bool m_done;
+  bool m_compacted;
 
   void set_done (bool d)
   {
@@ -56,7 +59,7 @@ private:
   }
 
 public:
-  Op (bool done = true) : m_done (done)
+  Op (bool done = true) : m_done (done), m_compacted (false)
   { }
 
   virtual ~Op () 
@@ -66,6 +69,40 @@ public:
   {
     return m_done;
   }
+
+  /**
+   *  @brief Gets the approximate memory used by this operation in bytes
+   *
+   *  This value is used by the manager to enforce the undo memory budget.
+   *  Operations holding a significant amount of data should reimplement this method.
+   */
+  virtual size_t mem_size () const
+  {
+    return sizeof (Op);
+  }
+
+  /**
+   *  @brief Serializes the payload of the operation and releases it
+   *
+   *  The manager calls this method to compact old transactions. The implementation
+   *  should append the payload to "data" and release the memory it occupied. If the
+   *  operation does not support compaction, it should return false and leave "data"
+   *  untouched.
+   *  The operation is not used until "expand" has been called.
+   */
+  virtual bool compact (std::string & /*data*/)
+  {
+    return false;
+  }
+
+  /**
+   *  @brief Restores the payload released by "compact"
+   *
+   *  "data" points to the payload written by "compact" and needs to be advanced
+   *  behind it.
+   */
+  virtual void expand (const char *& /*data*/)
+  { }
 };
 
 /**
@@ -234,6 +271,60 @@ public:
    */
   void clear ();
 
+  /**
+   *  @brief Sets the undo memory budget in bytes
+   *
+   *  When the memory used by the undo history exceeds this value after a transaction
+   *  has been committed, old transactions are compacted: the operations supporting this
+   *  feature are serialized into a compressed block. If spilling to disk is enabled,
+   *  the compressed blocks of old transactions are written to a temporary file
+   *  if the budget is still exceeded. The most recent transaction is never compacted.
+   *  Compacted transactions are restored when they are undone or redone. The space of
+   *  restored or discarded transactions in the temporary file is reused.
+   *
+   *  A value of 0 (the default) disables the budget.
+   */
+  void set_max_memory (size_t max_memory);
+
+  /**
+   *  @brief Gets the undo memory budget in bytes
+   */
+  size_t max_memory () const
+  {
+    return m_max_memory;
+  }
+
+  /**
+   *  @brief Enables or disables spilling of compacted transactions to a temporary file
+   */
+  void set_spill_to_disk (bool f)
+  {
+    m_spill_to_disk = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether compacted transactions are spilled to disk
+   */
+  bool spill_to_disk () const
+  {
+    return m_spill_to_disk;
+  }
+
+  /**
+   *  @brief Gets the approximate memory used by the committed transactions in bytes
+   *
+   *  Without a memory budget, the transaction sizes are not maintained and this method
+   *  computes them on the fly.
+   */
+  size_t memory_used () const;
+
+  /**
+   *  @brief Gets the size of the temporary file holding spilled transactions in bytes
+   *
+   *  This value is provided for diagnostics. It is 0 if no data has been spilled.
+   */
+  size_t spill_file_size () const;
+
   /**
    *  @brief Query if we are within a transaction
    */
@@ -256,7 +347,27 @@ private:
 
   typedef std::pair<db::Manager::ident_t, db::Op *> operation_t;
   typedef std::list<operation_t> operations_t;
-  typedef std::pair<operations_t, std::string> transaction_t;
+
+  struct transaction_t
+  {
+    transaction_t (const std::string &d)
+      : description (d), mem_size (0), mem_size_valid (false), compacted (false), uncompressed_size (0), on_disk (false), file_offset (0), file_size (0)
+    { }
+
+    operations_t operations;
+    std::string description;
+    //  the size is computed only if a memory budget is set
+    size_t mem_size;
+    bool mem_size_valid;
+    //  compacted operations: deflated payload, either in memory or in the spill file
+    bool compacted;
+    std::string compacted_data;
+    size_t uncompressed_size;
+    bool on_disk;
+    long file_offset;
+    size_t file_size;
+  };
+
   typedef std::list<transaction_t> transactions_t;
 
   transactions_t m_transactions;
@@ -264,8 +375,20 @@ private:
   bool m_opened;
   bool m_replay;
   bool m_enabled;
+  size_t m_max_memory;
+  bool m_spill_to_disk;
+  FILE *mp_spill_file;
+  std::map<long, size_t> m_spill_free;
 
   void erase_transactions (transactions_t::iterator from, transactions_t::iterator to);
+  void enforce_memory_budget ();
+  void compact_transaction (transaction_t &t);
+  void spill_transaction (transaction_t &t);
+  void expand_transaction (transaction_t &t);
+  long allocate_spill_region (size_t size);
+  void release_spill_region (long offset, size_t size);
+  static size_t transaction_mem_size (const transaction_t &t);
+  static void update_mem_size (transaction_t &t);
 };
 
 /**
@@ -30,7 +30,7 @@
 #include "tlFileUtils.h"
 #include "tlUri.h"
 #include "tlTimer.h"
-#include "tlLog.h"
+#include "tlThreadedWorkers.h"
 
 #include <sstream>
 #include <cctype>
@@ -89,7 +89,10 @@ static db::DeviceClass *make_device_class (db::Circuit *circuit, const std::stri
 
 bool NetlistSpiceReaderDelegate::element (db::Circuit *circuit, const std::string &element, const std::string &name, const std::string &model, double value, const std::vector<db::Net *> &nets, const std::map<std::string, double> &pv)
 {
-  std::map<std::string, double> params = pv;
+  const std::map<std::string, double> &params = pv;
+
+  //  the multiplier is applied to this parameter (if given)
+  const char *mult_param = 0;
 
   double mult = 1.0;
   std::map<std::string, double>::const_iterator mp = params.find ("M");
@@ -166,11 +169,7 @@ bool NetlistSpiceReaderDelegate::element (db::Circuit *circuit, const std::strin
     }
 
     //  Apply multiplier to "A"
-    std::map<std::string, double>::iterator p;
-    p = params.find ("A");
-    if (p != params.end ()) {
-      p->second *= mult;
-    }
+    mult_param = "A";
 
   } else if (element == "Q") {
 
@@ -201,11 +200,7 @@ bool NetlistSpiceReaderDelegate::element (db::Circuit *circuit, const std::strin
     }
 
     //  Apply multiplier to "AE"
-    std::map<std::string, double>::iterator p;
-    p = params.find ("AE");
-    if (p != params.end ()) {
-      p->second *= mult;
-    }
+    mult_param = "AE";
 
   } else if (element == "M") {
 
@@ -225,11 +220,7 @@ bool NetlistSpiceReaderDelegate::element (db::Circuit *circuit, const std::strin
     }
 
     //  Apply multiplier to "W"
-    std::map<std::string, double>::iterator p;
-    p = params.find ("W");
-    if (p != params.end ()) {
-      p->second *= mult;
-    }
+    mult_param = "W";
 
   } else {
     error (tl::sprintf (tl::to_string (tr ("Not a known element type: '%s'")), element));
@@ -260,7 +251,11 @@ bool NetlistSpiceReaderDelegate::element (db::Circuit *circuit, const std::strin
   for (std::vector<db::DeviceParameterDefinition>::const_iterator i = pd.begin (); i != pd.end (); ++i) {
     std::map<std::string, double>::const_iterator v = params.find (i->name ());
     if (v != params.end ()) {
-      device->set_parameter_value (i->id (), v->second / i->si_scaling ());
+      double pval = v->second;
+      if (mult_param && v->first == mult_param) {
+        pval *= mult;
+      }
+      device->set_parameter_value (i->id (), pval / i->si_scaling ());
     } else if (i->id () == defp) {
       device->set_parameter_value (i->id (), value / i->si_scaling ());
     }
@@ -273,302 +268,98 @@ bool NetlistSpiceReaderDelegate::element (db::Circuit *circuit, const std::strin
 
 static const char *allowed_name_chars = "_.:,!+$/&\\#[]|<>";
 
-NetlistSpiceReader::NetlistSpiceReader (NetlistSpiceReaderDelegate *delegate)
-  : mp_netlist (0), mp_stream (), mp_delegate (delegate)
-{
-  static NetlistSpiceReaderDelegate std_delegate;
-  if (! delegate) {
-    mp_delegate.reset (&std_delegate);
-  }
-}
-
-NetlistSpiceReader::~NetlistSpiceReader ()
-{
-  //  .. nothing yet ..
-}
-
-void NetlistSpiceReader::read (tl::InputStream &stream, db::Netlist &netlist)
-{
-  tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (tr ("Reading netlist ")) + stream.source ());
-
-  mp_stream.reset (new tl::TextInputStream (stream));
-  mp_netlist = &netlist;
-  mp_circuit = 0;
-  mp_anonymous_top_circuit = 0;
-  mp_nets_by_name.reset (0);
-  m_global_nets.clear ();
-  m_circuits_read.clear ();
-
-  try {
-
-    mp_delegate->start (&netlist);
-
-    while (! at_end ()) {
-      read_card ();
-    }
-
-    build_global_nets ();
-
-    mp_delegate->finish (&netlist);
-    finish ();
-
-  } catch (tl::Exception &ex) {
-
-    //  NOTE: because we do a peek to capture the "+" line continuation character, we're
-    //  one line ahead.
-    std::string fmt_msg = tl::sprintf ("%s in %s, line %d", ex.msg (), mp_stream->source (), mp_stream->line_number () - 1);
-    finish ();
-    throw tl::Exception (fmt_msg);
-
-  } catch (...) {
-
-    finish ();
-    throw;
-
-  }
-}
-
-void NetlistSpiceReader::build_global_nets ()
-{
-  for (std::vector<std::string>::const_iterator gn = m_global_nets.begin (); gn != m_global_nets.end (); ++gn) {
-
-    for (db::Netlist::bottom_up_circuit_iterator c = mp_netlist->begin_bottom_up (); c != mp_netlist->end_bottom_up (); ++c) {
-
-      if (c.operator-> () == mp_anonymous_top_circuit) {
-        //  no pins for the anonymous top circuit
-        continue;
-      }
-
-      db::Net *net = c->net_by_name (*gn);
-      if (! net || net->pin_count () > 0) {
-        //  only add a pin for a global net if there is a net with this name
-        //  don't add a pin if it already has one
-        continue;
-      }
-
-      const db::Pin &pin = c->add_pin (*gn);
-      c->connect_pin (pin.id (), net);
-
-      for (db::Circuit::refs_iterator r = c->begin_refs (); r != c->end_refs (); ++r) {
-
-        db::SubCircuit &sc = *r;
-
-        db::Net *pnet = sc.circuit ()->net_by_name (*gn);
-        if (! pnet) {
-          pnet = new db::Net ();
-          pnet->set_name (*gn);
-          sc.circuit ()->add_net (pnet);
-        }
-
-        sc.connect_pin (pin.id (), pnet);
-
-      }
-
-    }
-
-  }
-}
-
+//  The number of lines read and parsed in one batch (per thread)
+static const size_t lines_per_batch_and_thread = 25000;
 
-void NetlistSpiceReader::finish ()
-{
-  while (! m_streams.empty ()) {
-    pop_stream ();
-  }
+//  The number of lines after which a parser task is cut at the next top-level line
+static const size_t min_lines_per_task = 500;
 
-  mp_stream.reset (0);
-  mp_netlist = 0;
-  mp_circuit = 0;
-  mp_nets_by_name.reset (0);
-}
+//  The maximum number of lines per parser task
+static const size_t max_lines_per_task = 5000;
 
-void NetlistSpiceReader::push_stream (const std::string &path)
+/**
+ *  @brief A logical line (continuation lines joined) with its location
+ */
+struct NetlistSpiceReaderLine
 {
-  tl::URI current_uri (mp_stream->source ());
-  tl::URI new_uri (path);
-
-  tl::InputStream *istream;
-  if (current_uri.scheme ().empty () && new_uri.scheme ().empty ()) {
-    if (tl::is_absolute (path)) {
-      istream = new tl::InputStream (path);
-    } else {
-      istream = new tl::InputStream (tl::combine_path (tl::dirname (mp_stream->source ()), path));
-    }
-  } else {
-    istream = new tl::InputStream (current_uri.resolved (new_uri).to_string ());
-  }
-
-  m_streams.push_back (std::make_pair (istream, mp_stream.release ()));
-  mp_stream.reset (new tl::TextInputStream (*istream));
-}
-
-void NetlistSpiceReader::pop_stream ()
+  NetlistSpiceReaderLine () : source (0), line_number (0) { }
+
+  std::string text;
+  unsigned int source;
+  int line_number;
+};
+
+/**
+ *  @brief A parsed line
+ *
+ *  Net names (also pin names and global net names) are stored as ids of the name
+ *  pool of the parser task. Parse errors are not thrown but kept, as the line
+ *  may be part of a subcircuit the delegate does not want to see.
+ */
+struct NetlistSpiceReaderCard
 {
-  if (! m_streams.empty ()) {
-
-    mp_stream.reset (m_streams.back ().second);
-    delete m_streams.back ().first;
-
-    m_streams.pop_back ();
+  enum kind_type { Unknown, Model, Global, Subckt, Ends, End, Control, Element };
 
-  }
-}
+  NetlistSpiceReaderCard () : kind (Unknown), element (0), value (0.0), source (0), line_number (0) { }
 
-bool NetlistSpiceReader::at_end ()
+  kind_type kind;
+  char element;
+  std::string name;
+  std::string model;
+  double value;
+  std::vector<unsigned int> nets;
+  std::map<std::string, double> params;
+  std::string error;
+  unsigned int source;
+  int line_number;
+};
+
+namespace
 {
-  return mp_stream->at_end () && m_streams.empty ();
-}
 
-std::string NetlistSpiceReader::get_line ()
+/**
+ *  @brief Interns the net names of one parser task
+ */
+class SpiceNamePool
 {
-  if (! m_stored_line.empty ()) {
-    std::string l;
-    l.swap (m_stored_line);
-    return l;
-  }
-
-  std::string l;
-
-  do {
-
-    while (mp_stream->at_end ()) {
-      if (m_streams.empty ()) {
-        return std::string ();
-      }
-      pop_stream ();
-    }
-
-    l = mp_stream->get_line ();
-    while (! mp_stream->at_end () && mp_stream->peek_char () == '+') {
-      mp_stream->get_char ();
-      l += mp_stream->get_line ();
-    }
-
-    tl::Extractor ex (l.c_str ());
-    if (ex.test_without_case (".include") || ex.test_without_case (".inc")) {
-
-      std::string path = read_name_with_case (ex);
-
-      push_stream (path);
-
-      l.clear ();
-
-    } else if (ex.at_end () || ex.test ("*")) {
-      l.clear ();
+public:
+  unsigned int id (const std::string &name)
+  {
+    std::unordered_map<std::string, unsigned int>::const_iterator i = m_ids.find (name);
+    if (i != m_ids.end ()) {
+      return i->second;
     }
 
-  } while (l.empty ());
-
-  return l;
-}
-
-void NetlistSpiceReader::unget_line (const std::string &l)
-{
-  m_stored_line = l;
-}
-
-bool NetlistSpiceReader::subcircuit_captured (const std::string &nc_name)
-{
-  std::map<std::string, bool>::const_iterator c = m_captured.find (nc_name);
-  if (c != m_captured.end ()) {
-    return c->second;
-  } else {
-    bool cap = mp_delegate->wants_subcircuit (nc_name);
-    m_captured.insert (std::make_pair (nc_name, cap));
-    return cap;
-  }
-}
-
-bool NetlistSpiceReader::read_card ()
-{
-  std::string l = get_line ();
-  if (l.empty ()) {
-    return false;
+    unsigned int id = (unsigned int) m_names.size ();
+    m_ids.insert (std::make_pair (name, id));
+    m_names.push_back (name);
+    return id;
   }
 
-  tl::Extractor ex (l.c_str ());
-
-  ex.skip ();
-  char next_char = toupper (*ex);
-
-  if (ex.test_without_case (".")) {
-
-    //  control statement
-    if (ex.test_without_case ("model")) {
-
-      //  ignore model statements
-
-    } else if (ex.test_without_case ("global")) {
-
-      while (! ex.at_end ()) {
-        std::string n = read_name (ex);
-        if (m_global_net_names.find (n) == m_global_net_names.end ()) {
-          m_global_nets.push_back (n);
-          m_global_net_names.insert (n);
-        }
-      }
-
-    } else if (ex.test_without_case ("subckt")) {
-
-      std::string nc = read_name (ex);
-      if (subcircuit_captured (nc)) {
-        skip_circuit (ex);
-      } else {
-        read_circuit (ex, nc);
-      }
-
-    } else if (ex.test_without_case ("ends")) {
-
-      return true;
-
-    } else if (ex.test_without_case ("end")) {
-
-      //  ignore end statements
-
-    } else {
-
-      std::string s;
-      ex.read_word (s);
-      s = tl::to_lower_case (s);
-      warn (tl::to_string (tr ("Control statement ignored: ")) + s);
-
-    }
-
-  } else if (isalpha (next_char)) {
-
-    ++ex;
-
-    std::string name = read_name (ex);
-    ensure_circuit ();
-
-    std::string es;
-    es.push_back (next_char);
-
-    if (! read_element (ex, es, name)) {
-      warn (tl::sprintf (tl::to_string (tr ("Element type '%c' ignored")), next_char));
-    }
-
-    ex.expect_end ();
-
-  } else {
-    warn (tl::to_string (tr ("Line ignored")));
+  const std::vector<std::string> &names () const
+  {
+    return m_names;
   }
 
-  return false;
-}
+private:
+  std::unordered_map<std::string, unsigned int> m_ids;
+  std::vector<std::string> m_names;
+};
 
-void NetlistSpiceReader::error (const std::string &msg)
+/**
+ *  @brief The staging area of one parser task
+ */
+struct SpiceParserResult
 {
-  throw tl::Exception (msg);
-}
+  std::vector<NetlistSpiceReaderCard> cards;
+  SpiceNamePool names;
+};
 
-void NetlistSpiceReader::warn (const std::string &msg)
-{
-  std::string fmt_msg = tl::sprintf ("%s in %s, line %d", msg, mp_stream->source (), mp_stream->line_number () - 1);
-  tl::warn << fmt_msg;
 }
 
-double NetlistSpiceReader::read_atomic_value (tl::Extractor &ex)
+static double read_dot_expr (tl::Extractor &ex);
+
+static double read_atomic_value (tl::Extractor &ex)
 {
   if (ex.test ("(")) {
 
@@ -614,24 +405,7 @@ double NetlistSpiceReader::read_atomic_value (tl::Extractor &ex)
   }
 }
 
-double NetlistSpiceReader::read_bar_expr (tl::Extractor &ex)
-{
-  double v = read_atomic_value (ex);
-  while (true) {
-    if (ex.test ("+")) {
-      double vv = read_atomic_value (ex);
-      v += vv;
-    } else if (ex.test ("+")) {
-      double vv = read_atomic_value (ex);
-      v -= vv;
-    } else {
-      break;
-    }
-  }
-  return v;
-}
-
-double NetlistSpiceReader::read_dot_expr (tl::Extractor &ex)
+static double read_dot_expr (tl::Extractor &ex)
 {
   double v = read_atomic_value (ex);
   while (true) {
@@ -648,89 +422,23 @@ double NetlistSpiceReader::read_dot_expr (tl::Extractor &ex)
   return v;
 }
 
-double NetlistSpiceReader::read_value (tl::Extractor &ex)
+static double read_value (tl::Extractor &ex)
 {
   return read_dot_expr (ex);
 }
 
-void NetlistSpiceReader::ensure_circuit ()
+inline static int hex_num (char c)
 {
-  if (! mp_circuit) {
-
-    mp_circuit = new db::Circuit ();
-    //  TODO: make top name configurable
-    mp_circuit->set_name (".TOP");
-    mp_anonymous_top_circuit = mp_circuit;
-    mp_netlist->add_circuit (mp_circuit);
-
+  if (c >= '0' && c <= '9') {
+    return (int (c - '0'));
+  } else if (c >= 'a' && c <= 'f') {
+    return (int (c - 'f') + 10);
+  } else {
+    return -1;
   }
 }
 
-db::Net *NetlistSpiceReader::make_net (const std::string &name)
-{
-  if (! mp_nets_by_name.get ()) {
-    mp_nets_by_name.reset (new std::map<std::string, db::Net *> ());
-  }
-
-  std::map<std::string, db::Net *>::const_iterator n2n = mp_nets_by_name->find (name);
-
-  db::Net *net = 0;
-  if (n2n == mp_nets_by_name->end ()) {
-
-    net = new db::Net ();
-    net->set_name (name);
-    mp_circuit->add_net (net);
-
-    mp_nets_by_name->insert (std::make_pair (name, net));
-
-  } else {
-    net = n2n->second;
-  }
-
-  return net;
-}
-
-void NetlistSpiceReader::read_pin_and_parameters (tl::Extractor &ex, std::vector<std::string> &nn, std::map<std::string, double> &pv)
-{
-  bool in_params = false;
-
-  while (! ex.at_end ()) {
-
-    if (ex.test_without_case ("params:")) {
-
-      in_params = true;
-
-    } else {
-
-      std::string n = read_name (ex);
-
-      if (ex.test ("=")) {
-        //  a parameter
-        pv.insert (std::make_pair (n, read_value (ex)));
-      } else {
-        if (in_params) {
-          error (tl::to_string (tr ("Missing '=' in parameter assignment")));
-        }
-        nn.push_back (n);
-      }
-
-    }
-
-  }
-}
-
-inline static int hex_num (char c)
-{
-  if (c >= '0' && c <= '9') {
-    return (int (c - '0'));
-  } else if (c >= 'a' && c <= 'f') {
-    return (int (c - 'f') + 10);
-  } else {
-    return -1;
-  }
-}
-
-std::string NetlistSpiceReader::read_name_with_case (tl::Extractor &ex)
+static std::string read_name_with_case (tl::Extractor &ex)
 {
   std::string n;
   ex.read_word_or_quoted (n, allowed_name_chars);
@@ -773,7 +481,7 @@ std::string NetlistSpiceReader::read_name_with_case (tl::Extractor &ex)
   return nn;
 }
 
-std::string NetlistSpiceReader::read_name (tl::Extractor &ex)
+static std::string read_name (tl::Extractor &ex)
 {
   //  TODO: allow configuring Spice reader as case sensitive?
   //  this is easy to do: just avoid to_upper here:
@@ -784,31 +492,55 @@ std::string NetlistSpiceReader::read_name (tl::Extractor &ex)
 #endif
 }
 
-bool NetlistSpiceReader::read_element (tl::Extractor &ex, const std::string &element, const std::string &name)
+static void read_pin_and_parameters (tl::Extractor &ex, std::vector<std::string> &nn, std::map<std::string, double> &pv)
 {
-  //  generic parse
-  std::vector<std::string> nn;
-  std::map<std::string, double> pv;
+  bool in_params = false;
 
-  std::string model;
-  double value = 0.0;
+  while (! ex.at_end ()) {
+
+    if (ex.test_without_case ("params:")) {
+
+      in_params = true;
+
+    } else {
+
+      std::string n = read_name (ex);
+
+      if (ex.test ("=")) {
+        //  a parameter
+        pv.insert (std::make_pair (n, read_value (ex)));
+      } else {
+        if (in_params) {
+          throw tl::Exception (tl::to_string (tr ("Missing '=' in parameter assignment")));
+        }
+        nn.push_back (n);
+      }
+
+    }
+
+  }
+}
+
+static void read_element (tl::Extractor &ex, NetlistSpiceReaderCard &card, std::vector<std::string> &nn)
+{
+  char element = card.element;
 
   //  interpret the parameters according to the code
-  if (element == "X") {
+  if (element == 'X') {
 
     //  subcircuit call:
     //  Xname n1 n2 ... nn circuit [params]
 
-    read_pin_and_parameters (ex, nn, pv);
+    read_pin_and_parameters (ex, nn, card.params);
 
     if (nn.empty ()) {
-      error (tl::to_string (tr ("No circuit name given for subcircuit call")));
+      throw tl::Exception (tl::to_string (tr ("No circuit name given for subcircuit call")));
     }
 
-    model = nn.back ();
+    card.model = nn.back ();
     nn.pop_back ();
 
-  } else if (element == "R" || element == "C" || element == "L") {
+  } else if (element == 'R' || element == 'C' || element == 'L') {
 
     //  resistor, cap, inductor: two-terminal devices with a value
     //  Rname n1 n2 value
@@ -821,23 +553,23 @@ bool NetlistSpiceReader::read_element (tl::Extractor &ex, const std::string &ele
     }
 
     if (nn.size () != 2) {
-      error (tl::to_string (tr ("Two-terminal device needs two nets")));
+      throw tl::Exception (tl::to_string (tr ("Two-terminal device needs two nets")));
     }
 
     tl::Extractor ve (ex);
     double vv = 0.0;
     if (ve.try_read (vv) || ve.test ("(")) {
-      value = read_value (ex);
+      card.value = read_value (ex);
     }
 
     while (! ex.at_end ()) {
       std::string n = read_name (ex);
       if (ex.test ("=")) {
-        pv [n] = read_value (ex);
-      } else if (! model.empty ()) {
-        error (tl::sprintf (tl::to_string (tr ("Too many arguments for two-terminal device (additional argumen is '%s')")), n));
+        card.params [n] = read_value (ex);
+      } else if (! card.model.empty ()) {
+        throw tl::Exception (tl::sprintf (tl::to_string (tr ("Too many arguments for two-terminal device (additional argumen is '%s')")), n));
       } else {
-        model = n;
+        card.model = n;
       }
     }
 
@@ -848,50 +580,659 @@ bool NetlistSpiceReader::read_element (tl::Extractor &ex, const std::string &ele
     while (! ex.at_end ()) {
       std::string n = read_name (ex);
       if (ex.test ("=")) {
-        pv [n] = read_value (ex);
+        card.params [n] = read_value (ex);
       } else {
         nn.push_back (n);
       }
     }
 
     if (nn.empty ()) {
-      error (tl::sprintf (tl::to_string (tr ("No model name given for element '%s'")), element));
+      throw tl::Exception (tl::sprintf (tl::to_string (tr ("No model name given for element '%s'")), std::string (1, element)));
     }
 
-    model = nn.back ();
+    card.model = nn.back ();
     nn.pop_back ();
 
-    if (element == "M") {
+    if (element == 'M') {
       if (nn.size () != 4) {
-        error (tl::to_string (tr ("'M' element must have four nodes")));
+        throw tl::Exception (tl::to_string (tr ("'M' element must have four nodes")));
       }
-    } else if (element == "Q") {
+    } else if (element == 'Q') {
       if (nn.size () != 3 && nn.size () != 4) {
-        error (tl::to_string (tr ("'Q' element must have three or four nodes")));
+        throw tl::Exception (tl::to_string (tr ("'Q' element must have three or four nodes")));
       }
-    } else if (element == "D") {
+    } else if (element == 'D') {
       if (nn.size () != 2) {
-        error (tl::to_string (tr ("'D' element must have two nodes")));
+        throw tl::Exception (tl::to_string (tr ("'D' element must have two nodes")));
       }
     }
 
     //  TODO: other devices?
 
   }
+}
+
+/**
+ *  @brief Parses one line into a card
+ *
+ *  This function does not access the reader or the netlist, so it can be
+ *  called from multiple threads.
+ */
+static void parse_card (const NetlistSpiceReaderLine &line, NetlistSpiceReaderCard &card, SpiceNamePool &names)
+{
+  card.source = line.source;
+  card.line_number = line.line_number;
+
+  std::vector<std::string> nn;
+
+  try {
+
+    tl::Extractor ex (line.text.c_str ());
+
+    ex.skip ();
+    char next_char = toupper (*ex);
+
+    if (ex.test_without_case (".")) {
+
+      //  control statement
+      if (ex.test_without_case ("model")) {
+
+        //  ignore model statements
+        card.kind = NetlistSpiceReaderCard::Model;
+
+      } else if (ex.test_without_case ("global")) {
+
+        card.kind = NetlistSpiceReaderCard::Global;
+        while (! ex.at_end ()) {
+          nn.push_back (read_name (ex));
+        }
+
+      } else if (ex.test_without_case ("subckt")) {
+
+        card.kind = NetlistSpiceReaderCard::Subckt;
+        card.name = read_name (ex);
+        read_pin_and_parameters (ex, nn, card.params);
+
+      } else if (ex.test_without_case ("ends")) {
+
+        card.kind = NetlistSpiceReaderCard::Ends;
+
+      } else if (ex.test_without_case ("end")) {
+
+        //  ignore end statements
+        card.kind = NetlistSpiceReaderCard::End;
+
+      } else {
+
+        card.kind = NetlistSpiceReaderCard::Control;
+        std::string s;
+        ex.read_word (s);
+        card.name = tl::to_lower_case (s);
+
+      }
+
+    } else if (isalpha (next_char)) {
+
+      ++ex;
+
+      card.kind = NetlistSpiceReaderCard::Element;
+      card.element = next_char;
+      card.name = read_name (ex);
+
+      read_element (ex, card, nn);
+
+      ex.expect_end ();
+
+    }
+
+  } catch (tl::Exception &ex) {
+    card.error = ex.msg ();
+  }
+
+  card.nets.reserve (nn.size ());
+  for (std::vector<std::string>::const_iterator n = nn.begin (); n != nn.end (); ++n) {
+    card.nets.push_back (names.id (*n));
+  }
+}
+
+static void parse_lines (const NetlistSpiceReaderLine *from, const NetlistSpiceReaderLine *to, SpiceParserResult &result)
+{
+  result.cards.resize (to - from);
+  for (const NetlistSpiceReaderLine *l = from; l != to; ++l) {
+    parse_card (*l, result.cards [l - from], result.names);
+  }
+}
+
+namespace
+{
+
+class SpiceParserTask
+  : public tl::Task
+{
+public:
+  SpiceParserTask (const NetlistSpiceReaderLine *from, const NetlistSpiceReaderLine *to, SpiceParserResult *result)
+    : mp_from (from), mp_to (to), mp_result (result)
+  { }
+
+  void perform ()
+  {
+    parse_lines (mp_from, mp_to, *mp_result);
+  }
+
+private:
+  const NetlistSpiceReaderLine *mp_from, *mp_to;
+  SpiceParserResult *mp_result;
+};
+
+class SpiceParserWorker
+  : public tl::Worker
+{
+public:
+  SpiceParserWorker ()
+    : tl::Worker ()
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<SpiceParserTask *> (task)->perform ();
+  }
+};
+
+}
+
+static bool is_control_line (const std::string &l, const char *what)
+{
+  tl::Extractor ex (l.c_str ());
+  return ex.test (".") && ex.test_without_case (what);
+}
+
+/**
+ *  @brief Cuts a batch of lines into parser tasks
+ *
+ *  The .SUBCKT/.ENDS blocks are tracked, so small blocks are kept together in one
+ *  task. Large blocks are split - every line can be parsed on its own.
+ */
+static void make_parser_ranges (const std::vector<NetlistSpiceReaderLine> &lines, std::vector<std::pair<size_t, size_t> > &ranges)
+{
+  int depth = 0;
+  size_t from = 0;
+
+  for (size_t i = 0; i < lines.size (); ++i) {
+
+    const std::string &l = lines [i].text;
+    if (is_control_line (l, "subckt")) {
+      ++depth;
+    } else if (depth > 0 && is_control_line (l, "ends")) {
+      --depth;
+    }
+
+    size_t n = i + 1 - from;
+    if ((depth == 0 && n >= min_lines_per_task) || n >= max_lines_per_task) {
+      ranges.push_back (std::make_pair (from, i + 1));
+      from = i + 1;
+    }
+
+  }
+
+  if (from < lines.size ()) {
+    ranges.push_back (std::make_pair (from, lines.size ()));
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+NetlistSpiceReader::NetlistSpiceReader (NetlistSpiceReaderDelegate *delegate)
+  : mp_netlist (0), mp_circuit (0), mp_anonymous_top_circuit (0), mp_stream (), mp_delegate (delegate),
+    m_threads (0), m_source_index (0), m_location_source (0), m_location_line (0),
+    m_next_net_generation (0), m_skip_depth (0)
+{
+  static NetlistSpiceReaderDelegate std_delegate;
+  if (! delegate) {
+    mp_delegate.reset (&std_delegate);
+  }
+}
+
+NetlistSpiceReader::~NetlistSpiceReader ()
+{
+  //  .. nothing yet ..
+}
+
+void NetlistSpiceReader::read (tl::InputStream &stream, db::Netlist &netlist)
+{
+  tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (tr ("Reading netlist ")) + stream.source ());
+
+  mp_stream.reset (new tl::TextInputStream (stream));
+  mp_netlist = &netlist;
+  mp_circuit = 0;
+  mp_anonymous_top_circuit = 0;
+  m_global_nets.clear ();
+  m_global_net_names.clear ();
+  m_circuits_read.clear ();
+  m_parent_circuits.clear ();
+  m_skip_depth = 0;
+
+  m_sources.clear ();
+  m_sources.push_back (stream.source ());
+  m_source_index = 0;
+  m_location_source = 0;
+  m_location_line = 0;
+
+  //  the net name scope of the top level
+  m_net_generations.assign (1, ++m_next_net_generation);
+
+  try {
+
+    mp_delegate->start (&netlist);
+
+    std::vector<NetlistSpiceReaderLine> lines;
+    while (read_lines (lines)) {
+      parse_and_process (lines);
+    }
+
+    //  close circuits without .ENDS
+    while (! m_parent_circuits.empty ()) {
+      end_circuit ();
+    }
+
+    build_global_nets ();
+
+    mp_delegate->finish (&netlist);
+    finish ();
+
+  } catch (tl::Exception &ex) {
+
+    std::string fmt_msg = tl::sprintf ("%s in %s, line %d", ex.msg (), m_sources [m_location_source], m_location_line);
+    finish ();
+    throw tl::Exception (fmt_msg);
+
+  } catch (...) {
+
+    finish ();
+    throw;
+
+  }
+}
+
+void NetlistSpiceReader::build_global_nets ()
+{
+  for (std::vector<std::string>::const_iterator gn = m_global_nets.begin (); gn != m_global_nets.end (); ++gn) {
+
+    for (db::Netlist::bottom_up_circuit_iterator c = mp_netlist->begin_bottom_up (); c != mp_netlist->end_bottom_up (); ++c) {
+
+      if (c.operator-> () == mp_anonymous_top_circuit) {
+        //  no pins for the anonymous top circuit
+        continue;
+      }
+
+      db::Net *net = c->net_by_name (*gn);
+      if (! net || net->pin_count () > 0) {
+        //  only add a pin for a global net if there is a net with this name
+        //  don't add a pin if it already has one
+        continue;
+      }
+
+      const db::Pin &pin = c->add_pin (*gn);
+      c->connect_pin (pin.id (), net);
+
+      for (db::Circuit::refs_iterator r = c->begin_refs (); r != c->end_refs (); ++r) {
+
+        db::SubCircuit &sc = *r;
+
+        db::Net *pnet = sc.circuit ()->net_by_name (*gn);
+        if (! pnet) {
+          pnet = new db::Net ();
+          pnet->set_name (*gn);
+          sc.circuit ()->add_net (pnet);
+        }
 
+        sc.connect_pin (pin.id (), pnet);
+
+      }
+
+    }
+
+  }
+}
+
+
+void NetlistSpiceReader::finish ()
+{
+  while (! m_streams.empty ()) {
+    pop_stream ();
+  }
+
+  mp_stream.reset (0);
+  mp_netlist = 0;
+  mp_circuit = 0;
+  m_parent_circuits.clear ();
+
+  m_net_names.clear ();
+  m_net_name_ids.clear ();
+  m_nets_by_name_id.clear ();
+}
+
+void NetlistSpiceReader::push_stream (const std::string &path)
+{
+  tl::URI current_uri (mp_stream->source ());
+  tl::URI new_uri (path);
+
+  tl::InputStream *istream;
+  if (current_uri.scheme ().empty () && new_uri.scheme ().empty ()) {
+    if (tl::is_absolute (path)) {
+      istream = new tl::InputStream (path);
+    } else {
+      istream = new tl::InputStream (tl::combine_path (tl::dirname (mp_stream->source ()), path));
+    }
+  } else {
+    istream = new tl::InputStream (current_uri.resolved (new_uri).to_string ());
+  }
+
+  m_streams.push_back (std::make_pair (istream, mp_stream.release ()));
+  mp_stream.reset (new tl::TextInputStream (*istream));
+
+  m_source_index_stack.push_back (m_source_index);
+  m_source_index = (unsigned int) m_sources.size ();
+  m_sources.push_back (mp_stream->source ());
+}
+
+void NetlistSpiceReader::pop_stream ()
+{
+  if (! m_streams.empty ()) {
+
+    mp_stream.reset (m_streams.back ().second);
+    delete m_streams.back ().first;
+
+    m_streams.pop_back ();
+
+    m_source_index = m_source_index_stack.back ();
+    m_source_index_stack.pop_back ();
+
+  }
+}
+
+bool NetlistSpiceReader::get_line (std::string &l)
+{
+  do {
+
+    while (mp_stream->at_end ()) {
+      if (m_streams.empty ()) {
+        l.clear ();
+        return false;
+      }
+      pop_stream ();
+    }
+
+    l = mp_stream->get_line ();
+    while (! mp_stream->at_end () && mp_stream->peek_char () == '+') {
+      mp_stream->get_char ();
+      l += mp_stream->get_line ();
+    }
+
+    //  NOTE: because we do a peek to capture the "+" line continuation character, we're
+    //  one line ahead.
+    m_location_source = m_source_index;
+    m_location_line = int (mp_stream->line_number ()) - 1;
+
+    tl::Extractor ex (l.c_str ());
+    if (ex.test_without_case (".include") || ex.test_without_case (".inc")) {
+
+      std::string path = read_name_with_case (ex);
+
+      push_stream (path);
+
+      l.clear ();
+
+    } else if (ex.at_end () || ex.test ("*")) {
+      l.clear ();
+    }
+
+  } while (l.empty ());
+
+  return true;
+}
+
+bool NetlistSpiceReader::read_lines (std::vector<NetlistSpiceReaderLine> &lines)
+{
+  lines.clear ();
+
+  size_t max_lines = lines_per_batch_and_thread * std::max (m_threads, 1u);
+
+  std::string l;
+  while (lines.size () < max_lines && get_line (l)) {
+    lines.push_back (NetlistSpiceReaderLine ());
+    lines.back ().text.swap (l);
+    lines.back ().source = m_location_source;
+    lines.back ().line_number = m_location_line;
+  }
+
+  return ! lines.empty ();
+}
+
+void NetlistSpiceReader::parse_and_process (const std::vector<NetlistSpiceReaderLine> &lines)
+{
+  std::vector<std::pair<size_t, size_t> > ranges;
+  if (m_threads > 0) {
+    make_parser_ranges (lines, ranges);
+  } else {
+    ranges.push_back (std::make_pair (size_t (0), lines.size ()));
+  }
+
+  std::vector<SpiceParserResult> results (ranges.size ());
+
+  if (m_threads > 0 && ranges.size () > 1) {
+
+    tl::Job<SpiceParserWorker> job (int (std::min (size_t (m_threads), ranges.size ())));
+    for (size_t i = 0; i < ranges.size (); ++i) {
+      job.schedule (new SpiceParserTask (&lines.front () + ranges [i].first, &lines.front () + ranges [i].second, &results [i]));
+    }
+
+    job.start ();
+    job.wait ();
+
+    if (job.has_error ()) {
+      throw tl::Exception (job.error_messages ().front ());
+    }
+
+  } else {
+
+    for (size_t i = 0; i < ranges.size (); ++i) {
+      parse_lines (&lines.front () + ranges [i].first, &lines.front () + ranges [i].second, results [i]);
+    }
+
+  }
+
+  //  build the netlist in the order of the lines
+
+  std::vector<unsigned int> name_ids;
+
+  for (std::vector<SpiceParserResult>::iterator r = results.begin (); r != results.end (); ++r) {
+
+    //  map the task's net names to the reader's ones
+    const std::vector<std::string> &names = r->names.names ();
+    name_ids.clear ();
+    name_ids.reserve (names.size ());
+    for (std::vector<std::string>::const_iterator n = names.begin (); n != names.end (); ++n) {
+      std::unordered_map<std::string, unsigned int>::const_iterator i = m_net_name_ids.find (*n);
+      if (i == m_net_name_ids.end ()) {
+        i = m_net_name_ids.insert (std::make_pair (*n, (unsigned int) m_net_names.size ())).first;
+        m_net_names.push_back (*n);
+      }
+      name_ids.push_back (i->second);
+    }
+
+    for (std::vector<NetlistSpiceReaderCard>::const_iterator c = r->cards.begin (); c != r->cards.end (); ++c) {
+      process_card (*c, name_ids);
+    }
+
+    //  release the memory early
+    *r = SpiceParserResult ();
+
+  }
+}
+
+bool NetlistSpiceReader::subcircuit_captured (const std::string &nc_name)
+{
+  std::map<std::string, bool>::const_iterator c = m_captured.find (nc_name);
+  if (c != m_captured.end ()) {
+    return c->second;
+  } else {
+    bool cap = mp_delegate->wants_subcircuit (nc_name);
+    m_captured.insert (std::make_pair (nc_name, cap));
+    return cap;
+  }
+}
+
+void NetlistSpiceReader::process_card (const NetlistSpiceReaderCard &card, const std::vector<unsigned int> &name_ids)
+{
+  m_location_source = card.source;
+  m_location_line = card.line_number;
+
+  if (m_skip_depth > 0) {
+
+    //  inside a subcircuit captured by the delegate: just follow the nesting
+    if (card.kind == NetlistSpiceReaderCard::Subckt) {
+      ++m_skip_depth;
+    } else if (card.kind == NetlistSpiceReaderCard::Ends) {
+      --m_skip_depth;
+    }
+
+    return;
+
+  }
+
+  if (card.kind == NetlistSpiceReaderCard::Subckt) {
+
+    if (card.name.empty () && ! card.error.empty ()) {
+      error (card.error);
+    }
+
+    if (subcircuit_captured (card.name)) {
+      m_skip_depth = 1;
+      return;
+    }
+
+  }
+
+  if (! card.error.empty ()) {
+    error (card.error);
+  }
+
+  switch (card.kind) {
+
+  case NetlistSpiceReaderCard::Model:
+  case NetlistSpiceReaderCard::End:
+    break;
+
+  case NetlistSpiceReaderCard::Global:
+    for (std::vector<unsigned int>::const_iterator n = card.nets.begin (); n != card.nets.end (); ++n) {
+      const std::string &nn = m_net_names [name_ids [*n]];
+      if (m_global_net_names.find (nn) == m_global_net_names.end ()) {
+        m_global_nets.push_back (nn);
+        m_global_net_names.insert (nn);
+      }
+    }
+    break;
+
+  case NetlistSpiceReaderCard::Subckt:
+    begin_circuit (card, name_ids);
+    break;
+
+  case NetlistSpiceReaderCard::Ends:
+    if (! m_parent_circuits.empty ()) {
+      end_circuit ();
+    }
+    break;
+
+  case NetlistSpiceReaderCard::Control:
+    warn (tl::to_string (tr ("Control statement ignored: ")) + card.name);
+    break;
+
+  case NetlistSpiceReaderCard::Element:
+    ensure_circuit ();
+    process_element (card, name_ids);
+    break;
+
+  default:
+    warn (tl::to_string (tr ("Line ignored")));
+    break;
+
+  }
+}
+
+void NetlistSpiceReader::error (const std::string &msg)
+{
+  throw tl::Exception (msg);
+}
+
+void NetlistSpiceReader::warn (const std::string &msg)
+{
+  std::string fmt_msg = tl::sprintf ("%s in %s, line %d", msg, m_sources [m_location_source], m_location_line);
+  tl::warn << fmt_msg;
+}
+
+void NetlistSpiceReader::ensure_circuit ()
+{
+  if (! mp_circuit) {
+
+    mp_circuit = new db::Circuit ();
+    //  TODO: make top name configurable
+    mp_circuit->set_name (".TOP");
+    mp_anonymous_top_circuit = mp_circuit;
+    mp_netlist->add_circuit (mp_circuit);
+
+  }
+}
+
+db::Net *NetlistSpiceReader::make_net (unsigned int name_id)
+{
+  //  Every circuit nesting level has a table of nets by name id. A generation counter
+  //  tells whether the entry belongs to the current circuit of that level.
+  size_t level = m_parent_circuits.size ();
+  if (m_nets_by_name_id.size () <= level) {
+    m_nets_by_name_id.resize (level + 1);
+  }
+
+  std::vector<std::pair<size_t, db::Net *> > &nets = m_nets_by_name_id [level];
+  if (nets.size () <= size_t (name_id)) {
+    nets.resize (m_net_names.size (), std::make_pair (size_t (0), (db::Net *) 0));
+  }
+
+  std::pair<size_t, db::Net *> &n = nets [name_id];
+  if (n.first != m_net_generations [level]) {
+
+    db::Net *net = new db::Net ();
+    net->set_name (m_net_names [name_id]);
+    mp_circuit->add_net (net);
+
+    n = std::make_pair (m_net_generations [level], net);
+
+  }
+
+  return n.second;
+}
+
+void NetlistSpiceReader::process_element (const NetlistSpiceReaderCard &card, const std::vector<unsigned int> &name_ids)
+{
   std::vector<db::Net *> nets;
-  for (std::vector<std::string>::const_iterator i = nn.begin (); i != nn.end (); ++i) {
-    nets.push_back (make_net (*i));
+  nets.reserve (card.nets.size ());
+  for (std::vector<unsigned int>::const_iterator i = card.nets.begin (); i != card.nets.end (); ++i) {
+    nets.push_back (make_net (name_ids [*i]));
   }
 
-  if (element == "X" && ! subcircuit_captured (model)) {
-    if (! pv.empty ()) {
+  bool read = false;
+
+  if (card.element == 'X' && ! subcircuit_captured (card.model)) {
+    if (! card.params.empty ()) {
       warn (tl::to_string (tr ("Circuit parameters are not allowed currently")));
     }
-    read_subcircuit (name, model, nets);
-    return true;
+    read_subcircuit (card.name, card.model, nets);
+    read = true;
   } else {
-    return mp_delegate->element (mp_circuit, element, name, model, value, nets, pv);
+    read = mp_delegate->element (mp_circuit, std::string (1, card.element), card.name, card.model, card.value, nets, card.params);
+  }
+
+  if (! read) {
+    warn (tl::sprintf (tl::to_string (tr ("Element type '%c' ignored")), card.element));
   }
 }
 
@@ -925,33 +1266,11 @@ void NetlistSpiceReader::read_subcircuit (const std::string &sc_name, const std:
   }
 }
 
-void NetlistSpiceReader::skip_circuit (tl::Extractor & /*ex*/)
+void NetlistSpiceReader::begin_circuit (const NetlistSpiceReaderCard &card, const std::vector<unsigned int> &name_ids)
 {
-  while (! at_end ()) {
-
-    std::string l = get_line ();
-    tl::Extractor ex (l.c_str ());
-    if (ex.test_without_case (".")) {
-
-      //  control statement
-      if (ex.test_without_case ("subckt")) {
-        skip_circuit (ex);
-      } else if (ex.test_without_case ("ends")) {
-        break;
-      }
-
-    }
+  const std::string &nc = card.name;
 
-  }
-}
-
-void NetlistSpiceReader::read_circuit (tl::Extractor &ex, const std::string &nc)
-{
-  std::vector<std::string> nn;
-  std::map<std::string, double> pv;
-  read_pin_and_parameters (ex, nn, pv);
-
-  if (! pv.empty ()) {
+  if (! card.params.empty ()) {
     warn (tl::to_string (tr ("Circuit parameters are not allowed currently")));
   }
 
@@ -961,14 +1280,14 @@ void NetlistSpiceReader::read_circuit (tl::Extractor &ex, const std::string &nc)
     cc = new db::Circuit ();
     mp_netlist->add_circuit (cc);
     cc->set_name (nc);
-    for (std::vector<std::string>::const_iterator i = nn.begin (); i != nn.end (); ++i) {
+    for (size_t i = 0; i < card.nets.size (); ++i) {
       cc->add_pin (std::string ());
     }
 
   } else {
 
-    if (cc->pin_count () != nn.size ()) {
-      error (tl::sprintf (tl::to_string (tr ("Pin count mismatch between implicit (through call) and explicit circuit definition: %d expected, got %d in circuit %s")), int (cc->pin_count ()), int (nn.size ()), nc));
+    if (cc->pin_count () != card.nets.size ()) {
+      error (tl::sprintf (tl::to_string (tr ("Pin count mismatch between implicit (through call) and explicit circuit definition: %d expected, got %d in circuit %s")), int (cc->pin_count ()), int (card.nets.size ()), nc));
     }
 
   }
@@ -978,32 +1297,32 @@ void NetlistSpiceReader::read_circuit (tl::Extractor &ex, const std::string &nc)
   }
   m_circuits_read.insert (cc);
 
-  std::unique_ptr<std::map<std::string, db::Net *> > n2n (mp_nets_by_name.release ());
-  mp_nets_by_name.reset (0);
+  m_parent_circuits.push_back (mp_circuit);
+  mp_circuit = cc;
 
-  std::swap (cc, mp_circuit);
+  //  start a new net name scope
+  size_t level = m_parent_circuits.size ();
+  if (m_net_generations.size () <= level) {
+    m_net_generations.resize (level + 1, 0);
+  }
+  m_net_generations [level] = ++m_next_net_generation;
 
   //  produce the explicit pins
-  for (std::vector<std::string>::const_iterator i = nn.begin (); i != nn.end (); ++i) {
-    db::Net *net = make_net (*i);
+  for (std::vector<unsigned int>::const_iterator i = card.nets.begin (); i != card.nets.end (); ++i) {
+    db::Net *net = make_net (name_ids [*i]);
     //  use the net name to name the pin (otherwise SPICE pins are always unnamed)
-    size_t pin_id = i - nn.begin ();
-    if (! i->empty ()) {
+    size_t pin_id = i - card.nets.begin ();
+    if (! net->name ().empty ()) {
       mp_circuit->rename_pin (pin_id, net->name ());
     }
     mp_circuit->connect_pin (pin_id, net);
   }
+}
 
-  while (! at_end ()) {
-    if (read_card ()) {
-      break;
-    }
-  }
-
-  mp_nets_by_name.reset (n2n.release ());
-  std::swap (cc, mp_circuit);
-
-  ex.expect_end ();
+void NetlistSpiceReader::end_circuit ()
+{
+  mp_circuit = m_parent_circuits.back ();
+  m_parent_circuits.pop_back ();
 }
 
 }
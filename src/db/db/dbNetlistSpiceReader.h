@@ -31,6 +31,8 @@
 #include <set>
 #include <map>
 #include <memory>
+#include <vector>
+#include <unordered_map>
 
 namespace db
 {
@@ -109,8 +111,19 @@ public:
   virtual void error (const std::string &msg);
 };
 
+struct NetlistSpiceReaderLine;
+struct NetlistSpiceReaderCard;
+
 /**
  *  @brief A SPICE format reader for netlists
+ *
+ *  The reader works in batches of lines. The lines are collected first - this
+ *  includes joining continuation lines and following ".include" statements.
+ *  The lines are then parsed into cards, optionally in multiple threads. The
+ *  batches are cut into parsing tasks at the boundaries of the .SUBCKT/.ENDS blocks
+ *  where possible. Finally the cards are turned into circuits, nets and devices
+ *  in the order of the file. This last step - which also involves the delegate -
+ *  is always done in the calling thread.
  */
 class DB_PUBLIC NetlistSpiceReader
   : public NetlistReader
@@ -121,6 +134,24 @@ public:
 
   virtual void read (tl::InputStream &stream, db::Netlist &netlist);
 
+  /**
+   *  @brief Sets the number of threads to use for parsing the lines
+   *
+   *  With 0 threads (the default), the lines are parsed in the calling thread.
+   */
+  void set_threads (unsigned int n)
+  {
+    m_threads = n;
+  }
+
+  /**
+   *  @brief Gets the number of threads to use for parsing the lines
+   */
+  unsigned int threads () const
+  {
+    return m_threads;
+  }
+
 private:
   db::Netlist *mp_netlist;
   db::Circuit *mp_circuit;
@@ -128,34 +159,38 @@ private:
   std::unique_ptr<tl::TextInputStream> mp_stream;
   tl::weak_ptr<NetlistSpiceReaderDelegate> mp_delegate;
   std::vector<std::pair<tl::InputStream *, tl::TextInputStream *> > m_streams;
-  std::unique_ptr<std::map<std::string, db::Net *> > mp_nets_by_name;
-  std::string m_stored_line;
   std::map<std::string, bool> m_captured;
   std::vector<std::string> m_global_nets;
   std::set<std::string> m_global_net_names;
   std::set<const db::Circuit *> m_circuits_read;
+  unsigned int m_threads;
+  std::vector<std::string> m_sources;
+  unsigned int m_source_index;
+  std::vector<unsigned int> m_source_index_stack;
+  unsigned int m_location_source;
+  int m_location_line;
+  std::vector<std::string> m_net_names;
+  std::unordered_map<std::string, unsigned int> m_net_name_ids;
+  std::vector<std::vector<std::pair<size_t, db::Net *> > > m_nets_by_name_id;
+  std::vector<size_t> m_net_generations;
+  size_t m_next_net_generation;
+  std::vector<db::Circuit *> m_parent_circuits;
+  unsigned int m_skip_depth;
 
   void push_stream (const std::string &path);
   void pop_stream ();
-  bool at_end ();
-  void read_pin_and_parameters (tl::Extractor &ex, std::vector<std::string> &nn, std::map<std::string, double> &pv);
-  bool read_element (tl::Extractor &ex, const std::string &element, const std::string &name);
+  bool read_lines (std::vector<NetlistSpiceReaderLine> &lines);
+  void parse_and_process (const std::vector<NetlistSpiceReaderLine> &lines);
+  void process_card (const NetlistSpiceReaderCard &card, const std::vector<unsigned int> &name_ids);
+  void process_element (const NetlistSpiceReaderCard &card, const std::vector<unsigned int> &name_ids);
+  void begin_circuit (const NetlistSpiceReaderCard &card, const std::vector<unsigned int> &name_ids);
+  void end_circuit ();
   void read_subcircuit (const std::string &sc_name, const std::string &nc_name, const std::vector<db::Net *> &nets);
-  void read_circuit (tl::Extractor &ex, const std::string &name);
-  void skip_circuit (tl::Extractor &ex);
-  bool read_card ();
-  double read_value (tl::Extractor &ex);
-  std::string read_name_with_case (tl::Extractor &ex);
-  std::string read_name (tl::Extractor &ex);
-  double read_atomic_value (tl::Extractor &ex);
-  double read_dot_expr (tl::Extractor &ex);
-  double read_bar_expr (tl::Extractor &ex);
-  std::string get_line ();
-  void unget_line (const std::string &l);
+  bool get_line (std::string &l);
   void error (const std::string &msg);
   void warn (const std::string &msg);
   void finish ();
-  db::Net *make_net (const std::string &name);
+  db::Net *make_net (unsigned int name_id);
   void ensure_circuit ();
   bool subcircuit_captured (const std::string &nc_name);
   void build_global_nets ();
@@ -23,6 +23,8 @@
 
 #include "dbPolygon.h"
 
+#include <cstring>
+
 namespace db
 {
 
@@ -469,6 +471,111 @@ void polygon_contour<C>::size (C dx, C dy, unsigned int mode)
 
 }
 
+template <class C>
+void polygon_contour<C>::move_to_arena (tl::Arena &arena)
+{
+  if (in_arena () || mp_points == 0) {
+    return;
+  }
+
+  size_type n = allocated_size ();
+  point_type *pts = (point_type *) ((size_t) mp_points & ~3);
+
+  point_type *apts = arena.allocate_array<point_type> (n);
+  memcpy ((void *) apts, (const void *) pts, n * sizeof (point_type));
+
+  mp_points = (point_type *) ((size_t) apts | ((size_t) mp_points & 3));
+  m_size |= arena_flag;
+
+  delete [] pts;
+}
+
+template <class C>
+void polygon_contour<C>::compact (tl::Arena *arena)
+{
+  //  floating-point coordinates cannot be delta-encoded without loss
+  if (! std::numeric_limits<C>::is_integer || m_size == 0) {
+    return;
+  }
+
+  if (is_compact ()) {
+    if (arena) {
+      move_to_arena (*arena);
+    }
+    return;
+  }
+
+  point_type *pts = (point_type *) ((size_t) mp_points & ~3);
+  size_type ns = stored_size ();
+
+  //  first pass: determine the encoded size, so the data can be written in place
+  size_type nbytes = 0;
+  point_type pl;
+  for (size_type i = 0; i < ns; ++i) {
+    nbytes += compact_delta_size (pl.x (), pts [i].x ());
+    nbytes += compact_delta_size (pl.y (), pts [i].y ());
+    pl = pts [i];
+  }
+
+  size_type n = (nbytes + sizeof (point_type) - 1) / sizeof (point_type);
+  if (n >= ns) {
+    //  no benefit, but still use the arena if one is given
+    if (arena) {
+      move_to_arena (*arena);
+    }
+    return;
+  }
+
+  //  the encoded data is kept in a point array, so release () does not need to care
+  point_type *cpts;
+  if (arena) {
+    cpts = arena->allocate_array<point_type> (n);
+  } else {
+    cpts = new point_type [n];
+  }
+
+  //  second pass: encode
+  unsigned char *data = (unsigned char *) cpts;
+  pl = point_type ();
+  for (size_type i = 0; i < ns; ++i) {
+    data = write_compact_delta (data, pl.x (), pts [i].x ());
+    data = write_compact_delta (data, pl.y (), pts [i].y ());
+    pl = pts [i];
+  }
+
+  if (! in_arena ()) {
+    delete [] pts;
+  }
+
+  mp_points = (point_type *) ((size_t) cpts | ((size_t) mp_points & 3));
+  m_size = ns | compact_flag | (arena ? arena_flag : 0);
+}
+
+template <class C>
+void polygon_contour<C>::expand ()
+{
+  if (! is_compact ()) {
+    return;
+  }
+
+  point_type *cpts = (point_type *) ((size_t) mp_points & ~3);
+
+  size_type n = stored_size ();
+  point_type *pts = new point_type [n];
+
+  compact_cursor c;
+  for (size_type i = 0; i < n; ++i) {
+    pts [i] = stored_point (i, c);
+  }
+
+  if (! in_arena ()) {
+    delete [] cpts;
+  }
+
+  mp_points = (point_type *) ((size_t) pts | ((size_t) mp_points & 3));
+  m_size = n;
+}
+
 // explicit instantiations for polygon<T> and simple_polygon<T>
 template class polygon_contour<db::Coord>;
 template class polygon_contour<db::DCoord>;
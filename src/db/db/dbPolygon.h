@@ -39,12 +39,14 @@
 #include "tlVector.h"
 #include "tlAlgorithm.h"
 #include "tlAssert.h"
+#include "tlArena.h"
 
 #include <cstddef>
 #include <string>
 #include <vector>
 #include <iterator>
 #include <algorithm>
+#include <limits>
 
 namespace db {
 
@@ -105,6 +107,26 @@ public:
   typedef typename container_type::const_iterator const_iterator;
   typedef polygon_contour_iterator<polygon_contour, db::unit_trans<C> > simple_iterator;
 
+  /**
+   *  @brief The decoder state for sequential access to compact contours
+   *
+   *  A compact contour stores the points as variable-length deltas, so a point
+   *  cannot be located in constant time. The cursor remembers the last point
+   *  decoded, so accessing neighbouring points is cheap again.
+   */
+  struct compact_cursor
+  {
+    compact_cursor ()
+      : index (0), offset (0), valid (false)
+    {
+      //  .. nothing yet ..
+    }
+
+    size_type index, offset;
+    point_type p;
+    bool valid;
+  };
+
 private:
   /**
    *  @brief A helper predicate function that returns true if p1-p2 is colinear with p2-p3
@@ -135,15 +157,16 @@ public:
    *  @brief Copy ctor
    */
   polygon_contour (const polygon_contour &d)
-    : m_size (d.m_size)
+    : m_size (d.m_size & ~arena_flag)
   {
     if (d.mp_points == 0) {
       mp_points = 0;
     } else {
-      point_type *p = new point_type [m_size];
+      size_type n = d.allocated_size ();
+      point_type *p = new point_type [n];
       point_type *pp = (point_type *) ((size_t) d.mp_points & ~3);
       mp_points = (point_type *)((size_t) p | ((size_t) d.mp_points & 3));
-      for (unsigned int i = 0; i < m_size; ++i) {
+      for (size_type i = 0; i < n; ++i) {
         p[i] = pp[i];
       }
     }
@@ -606,10 +629,17 @@ public:
    */
   polygon_contour<C> &move (const vector_type &d)
   {
+    bool was_compact = is_compact ();
+    if (was_compact) {
+      expand ();
+    }
     point_type *p = (point_type *) ((size_t) mp_points & ~3);
-    for (size_type i = 0; i < m_size; ++i, ++p) {
+    for (size_type i = 0; i < stored_size (); ++i, ++p) {
       *p += d;
     }
+    if (was_compact) {
+      compact ();
+    }
     return *this;
   }
 
@@ -649,8 +679,9 @@ public:
     std::vector<point_type> buffer;
     size_type n = size ();
     buffer.reserve (n);
+    compact_cursor c;
     for (size_type i = 0; i < n; ++i) {
-      buffer.push_back ((*this) [i]);
+      buffer.push_back (point_at (i, c));
     }
     assign (buffer.begin (), buffer.end (), tr, is_hole (), compress, true, remove_reflected);
     return *this;
@@ -677,8 +708,9 @@ public:
       std::vector<point_type> buffer;
       size_type n = size ();
       buffer.reserve (n);
+      compact_cursor c;
       for (size_type i = 0; i < n; ++i) {
-        buffer.push_back ((*this) [i]);
+        buffer.push_back (point_at (i, c));
       }
       assign (buffer.begin (), buffer.end (), tr, is_hole (), compress, true, remove_reflected);
     }
@@ -729,12 +761,14 @@ public:
     if (((size_t) mp_points & 1) != 0) {
       return true;
     }
-    if (m_size < 2) {
+    size_type n = stored_size ();
+    if (n < 2) {
       return false;
     }
-    point_type pl = mp_points [m_size - 1];
-    for (size_t i = 0; i < m_size; ++i) {
-      point_type p = mp_points [i];
+    compact_cursor c;
+    point_type pl = stored_point (n - 1, c);
+    for (size_t i = 0; i < n; ++i) {
+      point_type p = stored_point (i, c);
       if (! coord_traits::equals (p.x (), pl.x ()) && ! coord_traits::equals (p.y (), pl.y ())) {
         return false;
       }
@@ -751,12 +785,14 @@ public:
     if (((size_t) mp_points & 1) != 0) {
       return true;
     }
-    if (m_size < 2) {
+    size_type n = stored_size ();
+    if (n < 2) {
       return false;
     }
-    point_type pl = mp_points [m_size - 1];
-    for (size_t i = 0; i < m_size; ++i) {
-      point_type p = mp_points [i];
+    compact_cursor c;
+    point_type pl = stored_point (n - 1, c);
+    for (size_t i = 0; i < n; ++i) {
+      point_type p = stored_point (i, c);
       if (! coord_traits::equals (p.x (), pl.x ()) && ! coord_traits::equals (p.y (), pl.y ()) && ! coord_traits::equals (std::abs (p.x () - pl.x ()), std::abs (p.y () - pl.y ()))) {
         return false;
       }
@@ -797,9 +833,10 @@ public:
     }
 
     area_type a = 0;
-    point_type pl = (*this) [n - 1];
+    compact_cursor c;
+    point_type pl = point_at (n - 1, c);
     for (size_type p = 0; p < n; ++p) {
-      point_type pp = (*this) [p];
+      point_type pp = point_at (p, c);
       a += db::vprod (pp - point_type (), pl - point_type ());
       pl = pp;
     }
@@ -817,9 +854,10 @@ public:
     }
 
     double d = 0;
-    point_type pl = (*this) [n - 1];
+    compact_cursor c;
+    point_type pl = point_at (n - 1, c);
     for (size_type p = 0; p < n; ++p) {
-      point_type pp = (*this) [p];
+      point_type pp = point_at (p, c);
       d += pp.double_distance (pl);
       pl = pp;
     }
@@ -830,18 +868,25 @@ public:
   /**
    *  @brief Random access operator
    *
-   *  The time for the access operation is guaranteed to be constant.
+   *  The time for the access operation is guaranteed to be constant unless
+   *  the contour is compact (see \compact). For compact contours, use
+   *  \point_at with a cursor or the iterators for sequential access.
    */
   point_type operator[] (size_type index) const
   {
+    if (is_compact ()) {
+      compact_cursor c;
+      return point_at (index, c);
+    }
+
     size_t f = (size_t) mp_points;
     point_type *pts = (point_type *) (f & ~3);
     if ((f & 1) != 0) {
       if ((index & 1) != 0) {
         if ((f & 2) != 0) {
-          return point_type (pts [((index + 1) / 2) % m_size].x (), pts [(index - 1) / 2].y ());
+          return point_type (pts [((index + 1) / 2) % stored_size ()].x (), pts [(index - 1) / 2].y ());
         } else {
-          return point_type (pts [(index - 1) / 2].x (), pts [((index + 1) / 2) % m_size].y ());
+          return point_type (pts [(index - 1) / 2].x (), pts [((index + 1) / 2) % stored_size ()].y ());
         }
       } else {
         return pts [index / 2];
@@ -851,6 +896,71 @@ public:
     }
   }
 
+  /**
+   *  @brief Point access with a decoder cursor
+   *
+   *  This method delivers the same points than the random access operator.
+   *  For compact contours, the cursor keeps the decoder state, hence accessing
+   *  the points in ascending or descending order is done in constant time per point.
+   *  The cursor must not be shared between different contours.
+   */
+  point_type point_at (size_type index, compact_cursor &c) const
+  {
+    size_t f = (size_t) mp_points;
+    if ((f & 1) != 0) {
+      if ((index & 1) != 0) {
+        point_type p1 = stored_point ((index - 1) / 2, c);
+        point_type p2 = stored_point (((index + 1) / 2) % stored_size (), c);
+        if ((f & 2) != 0) {
+          return point_type (p2.x (), p1.y ());
+        } else {
+          return point_type (p1.x (), p2.y ());
+        }
+      } else {
+        return stored_point (index / 2, c);
+      }
+    } else {
+      return stored_point (index, c);
+    }
+  }
+
+  /**
+   *  @brief Converts the contour into the compact representation
+   *
+   *  In the compact representation, the points are stored as variable-length
+   *  encoded deltas: the first point relative to the origin and every further
+   *  point relative to its predecessor. As contours are normalized, the first point
+   *  is the lower-left one, so the deltas are usually small and need one or two bytes
+   *  per coordinate instead of a full coordinate.
+   *
+   *  Compact contours are read-only in the sense that most modifications will
+   *  convert them back to the normal representation. Random access to the points
+   *  is no longer possible in constant time. Iterators are still efficient.
+   *
+   *  This method does nothing for floating-point contours or if the compact
+   *  representation would not save memory.
+   *
+   *  If an arena is given, the storage is taken from the arena. In that case,
+   *  the arena must live longer than the contour. This also applies if the
+   *  contour does not benefit from the compact representation - the points
+   *  are moved into the arena nevertheless. Copies of the contour will use
+   *  the heap again, edits drop the arena storage without releasing it.
+   */
+  void compact (tl::Arena *arena = 0);
+
+  /**
+   *  @brief Converts a compact contour back into the normal representation
+   */
+  void expand ();
+
+  /**
+   *  @brief Returns true, if the contour is stored in the compact representation
+   */
+  bool is_compact () const
+  {
+    return (m_size & compact_flag) != 0;
+  }
+
   /**
    *  @brief Sizing
    *
@@ -876,9 +986,9 @@ public:
   size_type size () const 
   {
     if ((size_t) mp_points & 1) {
-      return m_size * 2;
+      return stored_size () * 2;
     } else {
-      return m_size;
+      return stored_size ();
     }
   }
 
@@ -893,9 +1003,17 @@ public:
   box_type bbox () const
   {
     box_type box;
-    point_type *p = (point_type *) ((size_t) mp_points & ~3);
-    for (size_type i = 0; i < m_size; ++i, ++p) {
-      box += *p;
+    if (is_compact ()) {
+      compact_cursor c;
+      size_type n = stored_size ();
+      for (size_type i = 0; i < n; ++i) {
+        box += stored_point (i, c);
+      }
+    } else {
+      point_type *p = (point_type *) ((size_t) mp_points & ~3);
+      for (size_type i = 0; i < stored_size (); ++i, ++p) {
+        box += *p;
+      }
     }
     return box;
   }
@@ -1008,13 +1126,32 @@ public:
     return false;
   }
 
+  /**
+   *  @brief Returns true, if the contour's storage is owned by an arena
+   */
+  bool in_arena () const
+  {
+    return (m_size & arena_flag) != 0;
+  }
+
   /**
    *  @brief swap with a different contour
+   *
+   *  Arena storage never travels to another contour: the contours may belong
+   *  to different layouts and hence to different arenas. If one of the contours
+   *  lives in an arena, the contours are swapped by copy and both end up with
+   *  heap storage.
    */
   void swap (polygon_contour<C> &d)
   {
-    std::swap (m_size, d.m_size);
-    std::swap (mp_points, d.mp_points);
+    if (in_arena () || d.in_arena ()) {
+      polygon_contour<C> tmp (d);
+      d = *this;
+      *this = tmp;
+    } else {
+      std::swap (m_size, d.m_size);
+      std::swap (mp_points, d.mp_points);
+    }
   }
 
   /**
@@ -1025,17 +1162,147 @@ public:
     if (! no_self) {
       stat->add (typeid (*this), (void *) this, sizeof (*this), sizeof (*this), parent, purpose, cat);
     }
-    stat->add (typeid (point_type []), (void *) mp_points, sizeof (point_type) * m_size, sizeof (point_type) * m_size, (void *) this, purpose, cat);
+    size_type n = allocated_size ();
+    stat->add (typeid (point_type []), (void *) mp_points, sizeof (point_type) * n, sizeof (point_type) * n, (void *) this, purpose, cat);
   }
 
 private:
+  //  the top bit of m_size indicates the compact representation, the next one
+  //  indicates that the storage is owned by an arena
+  static const size_type compact_flag = size_type (1) << (sizeof (size_type) * 8 - 1);
+  static const size_type arena_flag = compact_flag >> 1;
+
   point_type *mp_points;
   size_type m_size;
 
+  size_type stored_size () const
+  {
+    return m_size & ~(compact_flag | arena_flag);
+  }
+
+  void move_to_arena (tl::Arena &arena);
+
+  size_type allocated_size () const
+  {
+    if (is_compact ()) {
+      return (compact_bytes () + sizeof (point_type) - 1) / sizeof (point_type);
+    } else {
+      return stored_size ();
+    }
+  }
+
+  size_type compact_bytes () const
+  {
+    const unsigned char *data = (const unsigned char *) ((size_t) mp_points & ~3);
+    size_type n = 0;
+    for (size_type nc = stored_size () * 2; nc > 0; ++n) {
+      if ((data [n] & 0x80) == 0) {
+        --nc;
+      }
+    }
+    return n;
+  }
+
+  static uint64_t compact_delta (coord_type from, coord_type to)
+  {
+    //  deltas are computed modulo 2^64 and zigzag-encoded so small negative values stay small
+    uint64_t d = uint64_t (int64_t (to)) - uint64_t (int64_t (from));
+    return (d << 1) ^ uint64_t (int64_t (d) >> 63);
+  }
+
+  static size_type compact_delta_size (coord_type from, coord_type to)
+  {
+    size_type n = 1;
+    for (uint64_t z = compact_delta (from, to); z >= 0x80; z >>= 7) {
+      ++n;
+    }
+    return n;
+  }
+
+  static unsigned char *write_compact_delta (unsigned char *data, coord_type from, coord_type to)
+  {
+    uint64_t z = compact_delta (from, to);
+    while (z >= 0x80) {
+      *data++ = (unsigned char) (z | 0x80);
+      z >>= 7;
+    }
+    *data++ = (unsigned char) z;
+    return data;
+  }
+
+  static uint64_t read_compact_delta (const unsigned char *data, size_type &offset)
+  {
+    uint64_t z = 0;
+    unsigned int shift = 0;
+    unsigned char b;
+    do {
+      b = data [offset++];
+      z |= uint64_t (b & 0x7f) << shift;
+      shift += 7;
+    } while ((b & 0x80) != 0);
+    return (z >> 1) ^ (~(z & 1) + 1);
+  }
+
+  static coord_type add_compact_delta (coord_type c, uint64_t d)
+  {
+    return coord_type (int64_t (uint64_t (int64_t (c)) + d));
+  }
+
+  static coord_type sub_compact_delta (coord_type c, uint64_t d)
+  {
+    return coord_type (int64_t (uint64_t (int64_t (c)) - d));
+  }
+
+  point_type stored_point (size_type i, compact_cursor &c) const
+  {
+    if (! is_compact ()) {
+      return ((const point_type *) ((size_t) mp_points & ~3)) [i];
+    }
+
+    const unsigned char *data = (const unsigned char *) ((size_t) mp_points & ~3);
+
+    //  restart from the beginning if that is closer
+    if (! c.valid || (i < c.index && i < c.index - i)) {
+      c.offset = 0;
+      c.index = 0;
+      c.valid = true;
+      uint64_t dx = read_compact_delta (data, c.offset);
+      uint64_t dy = read_compact_delta (data, c.offset);
+      c.p = point_type (add_compact_delta (0, dx), add_compact_delta (0, dy));
+    }
+
+    while (c.index < i) {
+      uint64_t dx = read_compact_delta (data, c.offset);
+      uint64_t dy = read_compact_delta (data, c.offset);
+      c.p = point_type (add_compact_delta (c.p.x (), dx), add_compact_delta (c.p.y (), dy));
+      ++c.index;
+    }
+
+    while (c.index > i) {
+      //  walk back to the start of the current point's record: the last byte of
+      //  each number is the only one without the continuation bit
+      size_type o = c.offset - 1;
+      while (o > 0 && (data [o - 1] & 0x80) != 0) {
+        --o;
+      }
+      --o;
+      while (o > 0 && (data [o - 1] & 0x80) != 0) {
+        --o;
+      }
+      c.offset = o;
+      uint64_t dx = read_compact_delta (data, o);
+      uint64_t dy = read_compact_delta (data, o);
+      c.p = point_type (sub_compact_delta (c.p.x (), dx), sub_compact_delta (c.p.y (), dy));
+      --c.index;
+    }
+
+    return c.p;
+  }
+
   void release ()
   {
     point_type *p = (point_type *) ((size_t) mp_points & ~3);
-    if (p) {
+    if (p && ! in_arena ()) {
       delete [] p;
     }
     mp_points = 0;
@@ -1144,7 +1411,7 @@ public:
    */
   point_type operator* () const 
   {
-    return m_trans ((*mp_contour) [m_index]);
+    return m_trans (mp_contour->point_at (m_index, m_cursor));
   }
 
   /**
@@ -1243,6 +1510,7 @@ private:
   size_t m_index;
   trans_type m_trans;
   bool m_reverse;
+  mutable typename contour_type::compact_cursor m_cursor;
 };
 
 /**
@@ -1348,8 +1616,8 @@ public:
   {
     const contour_type *c = get_ctr ();
     
-    point_type p1 (m_trans ((*c) [m_pt]));
-    point_type p2 (m_trans ((*c) [m_pt + 1 >= c->size () ? 0 : m_pt + 1]));
+    point_type p1 (m_trans (c->point_at (m_pt, m_cursor)));
+    point_type p2 (m_trans (c->point_at (m_pt + 1 >= c->size () ? 0 : m_pt + 1, m_cursor)));
 
     //  to maintain the edge orientation we need to swap start end end point
     //  if the transformation is mirroring
@@ -1368,6 +1636,7 @@ public:
     const contour_type *c = get_ctr ();
     if (++m_pt == c->size ()) {
       m_pt = 0;
+      m_cursor = typename contour_type::compact_cursor ();
       //  polygons may contain empty contours (holes): skip those
       do { 
         ++m_ctr;
@@ -1382,6 +1651,7 @@ public:
   polygon_edge_iterator &operator-- () 
   {
     if (m_pt == 0) {
+      m_cursor = typename contour_type::compact_cursor ();
       //  polygons may contain empty contours (holes): skip those
       do {
         --m_ctr;
@@ -1398,6 +1668,7 @@ private:
   unsigned int m_ctr, m_num_ctr;
   size_t m_pt;
   trans_type m_trans;
+  mutable typename contour_type::compact_cursor m_cursor;
 
   //  fetch the contour pointer to the current contour
   const contour_type *get_ctr () const
@@ -2250,8 +2521,15 @@ public:
    */
   void swap (polygon<C> &d)
   {
-    m_ctrs.swap (d.m_ctrs);
-    std::swap (m_bbox, d.m_bbox);
+    if (in_arena () || d.in_arena ()) {
+      //  arena storage must not travel to another polygon (see polygon_contour::swap)
+      polygon<C> tmp (d);
+      d = *this;
+      *this = tmp;
+    } else {
+      m_ctrs.swap (d.m_ctrs);
+      std::swap (m_bbox, d.m_bbox);
+    }
   }
 
   /**
@@ -2371,6 +2649,41 @@ public:
     return copy;
   }
 
+  /**
+   *  @brief Converts the contours into the compact representation
+   *
+   *  See polygon_contour::compact for details. The compact representation
+   *  saves memory but is intended for read-only use: modifications of the
+   *  polygon will usually restore the normal representation.
+   */
+  void compact (tl::Arena *arena = 0)
+  {
+    for (typename contour_list_type::iterator c = m_ctrs.begin (); c != m_ctrs.end (); ++c) {
+      c->compact (arena);
+    }
+  }
+
+  /**
+   *  @brief Returns true, if the hull is stored in the compact representation
+   */
+  bool is_compact () const
+  {
+    return m_ctrs [0].is_compact ();
+  }
+
+  /**
+   *  @brief Returns true, if the storage of any contour is owned by an arena
+   */
+  bool in_arena () const
+  {
+    for (typename contour_list_type::const_iterator c = m_ctrs.begin (); c != m_ctrs.end (); ++c) {
+      if (c->in_arena ()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, bool no_self = false, void *parent = 0) const
   {
     db::mem_stat (stat, purpose, cat, m_ctrs, no_self, parent);
@@ -3069,6 +3382,32 @@ public:
     }
   }
 
+  /**
+   *  @brief Converts the hull into the compact representation
+   *
+   *  See polygon_contour::compact for details.
+   */
+  void compact (tl::Arena *arena = 0)
+  {
+    m_hull.compact (arena);
+  }
+
+  /**
+   *  @brief Returns true, if the hull is stored in the compact representation
+   */
+  bool is_compact () const
+  {
+    return m_hull.is_compact ();
+  }
+
+  /**
+   *  @brief Returns true, if the storage of the hull is owned by an arena
+   */
+  bool in_arena () const
+  {
+    return m_hull.in_arena ();
+  }
+
   void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, bool no_self = false, void *parent = 0) const
   {
     db::mem_stat (stat, purpose, cat, m_hull, no_self, parent);
@@ -0,0 +1,118 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbPolygonArrays.h"
+#include "tlException.h"
+#include "tlInternational.h"
+
+namespace db
+{
+
+PolygonArrays::PolygonArrays ()
+{
+  m_contours.push_back (0);
+  m_polygons.push_back (0);
+}
+
+PolygonArrays::PolygonArrays (const std::vector<db::Coord> &coordinates, const std::vector<index_type> &contours, const std::vector<index_type> &polygons)
+  : m_coordinates (coordinates), m_contours (contours), m_polygons (polygons)
+{
+  if (m_coordinates.size () % 2 != 0) {
+    throw tl::Exception (tl::to_string (tr ("Polygon arrays: the number of coordinates must be even")));
+  }
+  if (m_contours.empty ()) {
+    m_contours.push_back (0);
+  }
+  if (m_polygons.empty ()) {
+    m_polygons.push_back (0);
+  }
+
+  index_type npoints = index_type (m_coordinates.size () / 2);
+  for (std::vector<index_type>::const_iterator i = m_contours.begin (); i != m_contours.end (); ++i) {
+    if (*i < 0 || *i > npoints || (i != m_contours.begin () && *i < i[-1])) {
+      throw tl::Exception (tl::to_string (tr ("Polygon arrays: contour indexes must be ascending and refer to points")));
+    }
+  }
+
+  index_type ncontours = index_type (m_contours.size () - 1);
+  for (std::vector<index_type>::const_iterator i = m_polygons.begin (); i != m_polygons.end (); ++i) {
+    if (*i < 0 || *i > ncontours || (i != m_polygons.begin () && *i <= i[-1])) {
+      throw tl::Exception (tl::to_string (tr ("Polygon arrays: polygon indexes must be strictly ascending and refer to contours")));
+    }
+  }
+}
+
+void
+PolygonArrays::reserve (size_t polygons, size_t points)
+{
+  m_coordinates.reserve (points * 2);
+  m_contours.reserve (polygons + 1);
+  m_polygons.reserve (polygons + 1);
+}
+
+void
+PolygonArrays::add_contour (const db::Polygon::contour_type &contour)
+{
+  for (db::Polygon::contour_type::simple_iterator p = contour.begin (); p != contour.end (); ++p) {
+    m_coordinates.push_back ((*p).x ());
+    m_coordinates.push_back ((*p).y ());
+  }
+  m_contours.push_back (index_type (m_coordinates.size () / 2));
+}
+
+void
+PolygonArrays::add (const db::Polygon &polygon)
+{
+  for (unsigned int c = 0; c < polygon.holes () + 1; ++c) {
+    add_contour (polygon.contour (c));
+  }
+  m_polygons.push_back (index_type (m_contours.size () - 1));
+}
+
+db::Polygon
+PolygonArrays::polygon (size_t n) const
+{
+  db::Polygon polygon;
+
+  std::vector<db::Point> points;
+
+  for (index_type c = m_polygons [n]; c < m_polygons [n + 1]; ++c) {
+
+    points.clear ();
+    for (index_type i = m_contours [c]; i < m_contours [c + 1]; ++i) {
+      points.push_back (db::Point (m_coordinates [i * 2], m_coordinates [i * 2 + 1]));
+    }
+
+    if (c == m_polygons [n]) {
+      polygon.assign_hull (points.begin (), points.end (), false /*don't compress*/);
+    } else {
+      polygon.insert_hole (points.begin (), points.end (), false /*don't compress*/);
+    }
+
+  }
+
+  return polygon;
+}
+
+}
+
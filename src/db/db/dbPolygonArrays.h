@@ -0,0 +1,127 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_dbPolygonArrays
+#define HDR_dbPolygonArrays
+
+#include "dbCommon.h"
+#include "dbPolygon.h"
+
+#include <vector>
+#include <stdint.h>
+
+namespace db
+{
+
+/**
+ *  @brief A flat, array-based representation of a polygon collection
+ *
+ *  This representation is intended for bulk exchange of polygon data, e.g. with
+ *  numerical libraries. It consists of three arrays:
+ *
+ *  @ul
+ *  @li "coordinates" holds the x and y values of all contour points (hulls and holes) @/li
+ *  @li "contours" holds the index of the first point of each contour plus a final end index @/li
+ *  @li "polygons" holds the index of the first contour of each polygon plus a final end index @/li
+ *  @/ul
+ *
+ *  The first contour of a polygon is the hull, the following ones are the holes.
+ *  Point indexes count points, not coordinate values. Hence the points of contour
+ *  i are stored at coordinates [2 * contours[i], 2 * contours[i + 1]).
+ */
+class DB_PUBLIC PolygonArrays
+{
+public:
+  typedef int64_t index_type;
+
+  /**
+   *  @brief Creates an empty polygon collection
+   */
+  PolygonArrays ();
+
+  /**
+   *  @brief Creates a polygon collection from the given arrays
+   *
+   *  This constructor will throw an exception if the arrays are not consistent.
+   */
+  PolygonArrays (const std::vector<db::Coord> &coordinates, const std::vector<index_type> &contours, const std::vector<index_type> &polygons);
+
+  /**
+   *  @brief Reserves space for the given number of polygons and points
+   */
+  void reserve (size_t polygons, size_t points);
+
+  /**
+   *  @brief Adds a polygon
+   */
+  void add (const db::Polygon &polygon);
+
+  /**
+   *  @brief Gets the number of polygons
+   */
+  size_t size () const
+  {
+    return m_polygons.size () - 1;
+  }
+
+  /**
+   *  @brief Gets the nth polygon
+   */
+  db::Polygon polygon (size_t n) const;
+
+  /**
+   *  @brief Gets the coordinate array
+   */
+  const std::vector<db::Coord> &coordinates () const
+  {
+    return m_coordinates;
+  }
+
+  /**
+   *  @brief Gets the contour index array
+   */
+  const std::vector<index_type> &contours () const
+  {
+    return m_contours;
+  }
+
+  /**
+   *  @brief Gets the polygon index array
+   */
+  const std::vector<index_type> &polygons () const
+  {
+    return m_polygons;
+  }
+
+private:
+  std::vector<db::Coord> m_coordinates;
+  std::vector<index_type> m_contours;
+  std::vector<index_type> m_polygons;
+
+  void add_contour (const db::Polygon::contour_type &contour);
+};
+
+}
+
+#endif
+
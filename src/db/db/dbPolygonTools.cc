@@ -446,8 +446,8 @@ static bool _cut_polygon_internal (const PolygonType &input, const Edge &line, c
         if (n > 0) {
           //  look for one point "really" inside ...
           int inside = 0;
-          for (size_t i = 0; i < n && inside == 0; ++i) {
-            inside = inside_hull (hole->hull ()[i]);
+          for (typename PolygonType::polygon_contour_iterator hp = hole->begin_hull (); hp != hole->end_hull () && inside == 0; ++hp) {
+            inside = inside_hull (*hp);
           }
           if (inside >= 0) {
             hull->insert_hole (hole->hull ().begin (), hole->hull ().end ());
@@ -2175,10 +2175,18 @@ static void decompose_convex_helper (int depth, PreferredOrientation po, const d
     return;
   }
 
+  //  NOTE: the points are accessed randomly below - random access is slow on compact contours,
+  //  so we take a copy of the points
+  std::vector<db::Point> hull;
+  hull.reserve (n);
+  for (db::SimplePolygon::polygon_contour_iterator p = sp.begin_hull (); p != sp.end_hull (); ++p) {
+    hull.push_back (*p);
+  }
+
   db::Box bbox = sp.box ();
   db::coord_traits<db::Coord>::area_type atot = 0;
   for (size_t i = 0; i < n; ++i) {
-    db::Edge ep (sp.hull ()[(i + n - 1) % n], sp.hull ()[i]);
+    db::Edge ep (hull [(i + n - 1) % n], hull [i]);
     atot += db::vprod (ep.p2 () - db::Point (), ep.p1 () - db::Point ());
   }
 
@@ -2191,12 +2199,12 @@ static void decompose_convex_helper (int depth, PreferredOrientation po, const d
     db::Coord dmin = 0;
     for (size_t i = 0; i < n; ++i) {
 
-      db::Edge ep (sp.hull ()[(i + n - 1) % n], sp.hull ()[i]);
-      db::Edge ec (sp.hull ()[i], sp.hull ()[(i + 1) % n]);
+      db::Edge ep (hull [(i + n - 1) % n], hull [i]);
+      db::Edge ec (hull [i], hull [(i + 1) % n]);
 
       if (db::vprod_sign (ep, ec) > 0 && skipped.find (ep.p2 ()) == skipped.end ()) {
 
-        db::Vector v = sp.hull ()[i] - bbox.center ();
+        db::Vector v = hull [i] - bbox.center ();
         db::Coord d = std::min (std::abs (v.x ()), std::abs (v.y ()));
         if (imed == std::numeric_limits<size_t>::max () || d < dmin) {
           imed = i;
@@ -2217,9 +2225,9 @@ static void decompose_convex_helper (int depth, PreferredOrientation po, const d
       return;
     }
 
-    db::Point p (sp.hull ()[imed]);
-    db::Edge ep (sp.hull ()[(imed + n - 1) % n], p);
-    db::Edge ec (p, sp.hull ()[(imed + 1) % n]);
+    db::Point p (hull [imed]);
+    db::Edge ep (hull [(imed + n - 1) % n], p);
+    db::Edge ec (p, hull [(imed + 1) % n]);
 
     //  convex corner
 
@@ -2264,8 +2272,8 @@ static void decompose_convex_helper (int depth, PreferredOrientation po, const d
 
       for (size_t j = 1; j != n - 1; ++j) {
 
-        db::Edge efc (sp.hull ()[(imed + j) % n], sp.hull ()[(imed + j + 1) % n]);
-        db::Edge efp (sp.hull ()[(imed + j + n - 1) % n], sp.hull ()[(imed + j) % n]);
+        db::Edge efc (hull [(imed + j) % n], hull [(imed + j + 1) % n]);
+        db::Edge efp (hull [(imed + j + n - 1) % n], hull [(imed + j) % n]);
 
         asum += db::vprod (efp.p2 () - db::Point (), efp.p1 () - db::Point ());
 
@@ -2370,7 +2378,7 @@ static void decompose_convex_helper (int depth, PreferredOrientation po, const d
       db::SimplePolygon sp_out;
 
       for (size_t i = imed; i <= imed + jmin; ++i) {
-        pts.push_back (sp.hull ()[i % n]);
+        pts.push_back (hull [i % n]);
       }
       if (pts.back () != xmin) {
         pts.push_back (xmin);
@@ -2381,7 +2389,7 @@ static void decompose_convex_helper (int depth, PreferredOrientation po, const d
       pts.clear ();
 
       for (size_t i = imed + jmin + 1; i <= imed + n; ++i) {
-        pts.push_back (sp.hull ()[i % n]);
+        pts.push_back (hull [i % n]);
       }
       if (pts.front () != xmin) {
         pts.push_back (xmin);
@@ -2480,12 +2488,21 @@ is_convex_helper (const P &p)
     return true;
   }
 
+  //  NOTE: the points are taken in sequential order with a cursor, which is efficient for compact contours too
+  const typename P::contour_type &hull = p.hull ();
+  typename P::contour_type::compact_cursor c;
+
+  db::Point pp = hull.point_at (n - 1, c);
+  db::Point pc = hull.point_at (0, c);
   for (size_t i = 0; i < n; ++i) {
-    db::Edge ep (p.hull ()[(i + n - 1) % n], p.hull ()[i]);
-    db::Edge ec (p.hull ()[i], p.hull ()[(i + 1) % n]);
+    db::Point pn = hull.point_at ((i + 1) % n, c);
+    db::Edge ep (pp, pc);
+    db::Edge ec (pc, pn);
     if (db::vprod_sign (ep, ec) > 0) {
       return false;
     }
+    pp = pc;
+    pc = pn;
   }
 
   return true;
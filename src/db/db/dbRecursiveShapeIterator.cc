@@ -24,6 +24,10 @@
 #include "dbRegion.h"
 #include "dbEdgeProcessor.h"
 #include "tlProgress.h"
+#include "tlThreadedWorkers.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace db
 {
@@ -1013,5 +1017,265 @@ RecursiveShapeIterator::push (RecursiveShapeReceiver *receiver)
   }
 }
 
+// ------------------------------------------------------------------------------------
+//  Partitioned push mode implementation
+
+namespace
+{
+
+/**
+ *  @brief Describes the partitioning of the region into a grid of chunks
+ *
+ *  The chunks are half-open on the right and top side except for the last
+ *  column and row. Hence each point of the region belongs to exactly one chunk.
+ */
+class RegionPartitioning
+{
+public:
+  RegionPartitioning (const db::Box &box, size_t chunks)
+    : m_box (box)
+  {
+    size_t nx = 1;
+    if (box.height () <= 0) {
+      nx = chunks;
+    } else {
+      double f = sqrt (double (chunks) * double (box.width ()) / double (box.height ()));
+      nx = std::max (size_t (1), std::min (chunks, size_t (f + 0.5)));
+    }
+    size_t ny = std::max (size_t (1), chunks / nx);
+
+    for (size_t i = 0; i <= nx; ++i) {
+      m_x.push_back (db::Coord (box.left () + (int64_t (box.width ()) * int64_t (i)) / int64_t (nx)));
+    }
+    for (size_t i = 0; i <= ny; ++i) {
+      m_y.push_back (db::Coord (box.bottom () + (int64_t (box.height ()) * int64_t (i)) / int64_t (ny)));
+    }
+  }
+
+  size_t chunks () const
+  {
+    return (m_x.size () - 1) * (m_y.size () - 1);
+  }
+
+  db::Box chunk_box (size_t index) const
+  {
+    size_t nx = m_x.size () - 1;
+    size_t ix = index % nx, iy = index / nx;
+    return db::Box (m_x [ix], m_y [iy], m_x [ix + 1], m_y [iy + 1]);
+  }
+
+  size_t owner (const db::Box &box) const
+  {
+    db::Box b = box & m_box;
+    if (b.empty ()) {
+      return 0;
+    }
+
+    size_t nx = m_x.size () - 1, ny = m_y.size () - 1;
+    size_t ix = std::min (nx - 1, size_t (std::upper_bound (m_x.begin (), m_x.end (), b.left ()) - m_x.begin ()) - 1);
+    size_t iy = std::min (ny - 1, size_t (std::upper_bound (m_y.begin (), m_y.end (), b.bottom ()) - m_y.begin ()) - 1);
+    return iy * nx + ix;
+  }
+
+private:
+  db::Box m_box;
+  std::vector<db::Coord> m_x, m_y;
+};
+
+/**
+ *  @brief A receiver forwarding the events of one chunk while filtering the shapes owned by other chunks
+ */
+class ChunkShapeReceiver
+  : public RecursiveShapeReceiver
+{
+public:
+  ChunkShapeReceiver (RecursiveShapeReceiver *target, const RegionPartitioning *partitioning, size_t index)
+    : mp_target (target), mp_partitioning (partitioning), m_index (index)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void begin (const RecursiveShapeIterator *iter)
+  {
+    mp_target->begin (iter);
+  }
+
+  virtual void end (const RecursiveShapeIterator *iter)
+  {
+    mp_target->end (iter);
+  }
+
+  virtual void enter_cell (const RecursiveShapeIterator *iter, const db::Cell *cell, const db::Box &region, const box_tree_type *complex_region)
+  {
+    mp_target->enter_cell (iter, cell, region, complex_region);
+  }
+
+  virtual void leave_cell (const RecursiveShapeIterator *iter, const db::Cell *cell)
+  {
+    mp_target->leave_cell (iter, cell);
+  }
+
+  virtual new_inst_mode new_inst (const RecursiveShapeIterator *iter, const db::CellInstArray &inst, const db::Box &region, const box_tree_type *complex_region, bool all)
+  {
+    return mp_target->new_inst (iter, inst, region, complex_region, all);
+  }
+
+  virtual bool new_inst_member (const RecursiveShapeIterator *iter, const db::CellInstArray &inst, const db::ICplxTrans &trans, const db::Box &region, const box_tree_type *complex_region, bool all)
+  {
+    return mp_target->new_inst_member (iter, inst, trans, region, complex_region, all);
+  }
+
+  virtual void shape (const RecursiveShapeIterator *iter, const db::Shape &shape, const db::ICplxTrans &trans, const db::Box &region, const box_tree_type *complex_region)
+  {
+    if (! mp_partitioning || mp_partitioning->owner (trans * shape.bbox ()) == m_index) {
+      mp_target->shape (iter, shape, trans, region, complex_region);
+    }
+  }
+
+private:
+  RecursiveShapeReceiver *mp_target;
+  const RegionPartitioning *mp_partitioning;
+  size_t m_index;
+};
+
+class RecursiveShapeIteratorChunkTask
+  : public tl::Task
+{
+public:
+  RecursiveShapeIteratorChunkTask (const RecursiveShapeIterator &iter, RecursiveShapeReceiver *target, const RegionPartitioning *partitioning, size_t index)
+    : m_iter (iter), m_receiver (target, partitioning, index)
+  {
+    //  .. nothing yet ..
+  }
+
+  void run ()
+  {
+    m_iter.push (&m_receiver);
+  }
+
+private:
+  RecursiveShapeIterator m_iter;
+  ChunkShapeReceiver m_receiver;
+};
+
+class RecursiveShapeIteratorChunkWorker
+  : public tl::Worker
+{
+public:
+  RecursiveShapeIteratorChunkWorker ()
+    : tl::Worker ()
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    RecursiveShapeIteratorChunkTask *chunk_task = dynamic_cast<RecursiveShapeIteratorChunkTask *> (task);
+    if (chunk_task) {
+      chunk_task->run ();
+    }
+  }
+};
+
+/**
+ *  @brief Returns true, if all instances below the given cell have orthogonal transformations
+ *
+ *  Only in this case, the hierarchical region tests are exact and the chunks can be
+ *  guaranteed to see the shapes they own.
+ */
+static bool
+has_ortho_instances_only (const db::Layout &layout, const db::Cell &top_cell)
+{
+  std::set<db::cell_index_type> called;
+  top_cell.collect_called_cells (called);
+  called.insert (top_cell.cell_index ());
+
+  for (std::set<db::cell_index_type>::const_iterator c = called.begin (); c != called.end (); ++c) {
+    for (db::Cell::const_iterator i = layout.cell (*c).begin (); ! i.at_end (); ++i) {
+      if (! i->cell_inst ().complex_trans ().is_ortho ()) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+}
+
+void
+RecursiveShapeIterator::push (ParallelRecursiveShapeReceiver *receiver, unsigned int threads, size_t chunks)
+{
+  if (chunks == 0) {
+    chunks = std::max (size_t (1), size_t (threads) * 4);
+  }
+
+  //  Ensures the trees are built properly before the workers start
+  if (mp_shapes) {
+    (const_cast <db::Shapes *> (mp_shapes))->update ();
+  } else if (mp_layout) {
+    mp_layout->update ();
+  }
+
+  box_type box = bbox ();
+
+  bool partition = chunks > 1 && ! box.empty () && ! mp_complex_region.get ();
+  if (partition && ! mp_shapes && mp_layout && mp_top_cell) {
+    partition = has_ortho_instances_only (*mp_layout, *mp_top_cell);
+  }
+
+  std::unique_ptr<RegionPartitioning> partitioning;
+  if (partition) {
+    partitioning.reset (new RegionPartitioning (box, chunks));
+  }
+
+  std::vector<RecursiveShapeReceiver *> receivers;
+
+  try {
+
+    tl::Job<RecursiveShapeIteratorChunkWorker> job (threads);
+
+    if (partitioning.get ()) {
+
+      for (size_t i = 0; i < partitioning->chunks (); ++i) {
+
+        db::Box chunk_box = partitioning->chunk_box (i);
+        receivers.push_back (receiver->create_receiver (i, chunk_box));
+
+        RecursiveShapeIterator chunk_iter (*this);
+        chunk_iter.confine_region (chunk_box);
+        job.schedule (new RecursiveShapeIteratorChunkTask (chunk_iter, receivers.back (), partitioning.get (), i));
+
+      }
+
+    } else {
+
+      receivers.push_back (receiver->create_receiver (0, m_region));
+      job.schedule (new RecursiveShapeIteratorChunkTask (*this, receivers.back (), 0, 0));
+
+    }
+
+    job.start ();
+    job.wait ();
+
+    if (job.has_error ()) {
+      throw tl::Exception (tl::to_string (tr ("Errors occurred during shape delivery. First error message says:\n")) + job.error_messages ().front ());
+    }
+
+    for (size_t i = 0; i < receivers.size (); ++i) {
+      receiver->finish_receiver (i, receivers [i]);
+    }
+
+  } catch (...) {
+    for (std::vector<RecursiveShapeReceiver *>::const_iterator r = receivers.begin (); r != receivers.end (); ++r) {
+      delete *r;
+    }
+    throw;
+  }
+
+  for (std::vector<RecursiveShapeReceiver *>::const_iterator r = receivers.begin (); r != receivers.end (); ++r) {
+    delete *r;
+  }
 }
 
+}
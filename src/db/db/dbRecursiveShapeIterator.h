@@ -39,6 +39,7 @@ namespace db
 
 class Region;
 class RecursiveShapeReceiver;
+class ParallelRecursiveShapeReceiver;
 
 /**
  *  @brief An iterator delivering shapes that touch or overlap the given region recursively
@@ -704,6 +705,37 @@ public:
    */
   void push (RecursiveShapeReceiver *receiver);
 
+  /**
+   *  @brief Partitioned push-mode delivery
+   *
+   *  This method splits the region to iterate into a number of rectangular chunks
+   *  and delivers the shapes of each chunk to a separate receiver. The receivers
+   *  are obtained from "receiver" and the chunks are processed on "threads" worker
+   *  threads. With "threads" being 0, the chunks are processed synchronously.
+   *  "chunks" gives the number of chunks requested. If 0, four chunks per thread
+   *  are used.
+   *
+   *  The chunks form a regular grid of nx columns and ny rows over the bounding box
+   *  of the region. nx is sqrt(chunks * w / h) rounded to the nearest integer and
+   *  ny is chunks / nx rounded down. Hence the actual number of chunks is nx * ny
+   *  which may be less than requested. The grid depends on the bounding box and
+   *  the chunk count only, not on the number of threads.
+   *
+   *  Each shape the sequential iterator delivers is delivered exactly once - to
+   *  the receiver of the chunk containing the lower-left corner of the shape's
+   *  bounding box clipped at the region. Hierarchy events (enter_cell, new_inst etc.)
+   *  are delivered per chunk and the return values of new_inst and new_inst_member
+   *  act on the respective chunk only.
+   *
+   *  Partitioning requires a box-type region and a hierarchy without arbitrary-angle
+   *  instances. If these conditions are not met, a single chunk is used.
+   *
+   *  The layout must not be modified while this method executes.
+   *
+   *  See ParallelRecursiveShapeReceiver class for more details.
+   */
+  void push (ParallelRecursiveShapeReceiver *receiver, unsigned int threads, size_t chunks = 0);
+
   /**
    *  @brief Returns a value indicating whether the current cell is inactive (disabled)
    */
@@ -904,6 +936,47 @@ public:
   virtual void shape (const RecursiveShapeIterator * /*iter*/, const db::Shape & /*shape*/, const db::ICplxTrans & /*trans*/, const db::Box & /*region*/, const box_tree_type * /*complex_region*/) { }
 };
 
+/**
+ *  @brief A receiver interface for the partitioned "push" mode
+ *
+ *  In partitioned push mode, the iterator will split the region into chunks and
+ *  deliver the shapes of each chunk to a separate RecursiveShapeReceiver. This
+ *  interface provides these receivers and collects the results.
+ *  See "RecursiveShapeIterator::push" for details about this mode.
+ */
+class DB_PUBLIC ParallelRecursiveShapeReceiver
+{
+public:
+  /**
+   *  @brief Constructor
+   */
+  ParallelRecursiveShapeReceiver () { }
+
+  /**
+   *  @brief Destructor
+   */
+  virtual ~ParallelRecursiveShapeReceiver () { }
+
+  /**
+   *  @brief Creates the receiver for a chunk
+   *
+   *  This method is called in the calling thread before the chunks are processed.
+   *  "index" is the index of the chunk and "box" is the part of the region covered
+   *  by this chunk. The receiver returned will be called from a worker thread and
+   *  becomes owned by the iterator.
+   */
+  virtual RecursiveShapeReceiver *create_receiver (size_t index, const db::Box &box) = 0;
+
+  /**
+   *  @brief Collects the results of a chunk
+   *
+   *  This method is called in the calling thread after all chunks have been processed
+   *  successfully. It is called in the order of the chunk indexes. The receiver is
+   *  deleted after this method returns.
+   */
+  virtual void finish_receiver (size_t /*index*/, RecursiveShapeReceiver * /*receiver*/) { }
+};
+
 }  // namespace db
 
 #endif
@@ -189,6 +189,89 @@ Region::flat_region ()
   return region;
 }
 
+namespace
+{
+
+class FlatRegionChunkReceiver
+  : public db::RecursiveShapeReceiver
+{
+public:
+  FlatRegionChunkReceiver (const db::ICplxTrans &trans)
+    : m_trans (trans)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void shape (const db::RecursiveShapeIterator * /*iter*/, const db::Shape &shape, const db::ICplxTrans &trans, const db::Box & /*region*/, const box_tree_type * /*complex_region*/)
+  {
+    if (shape.is_polygon () || shape.is_path () || shape.is_box ()) {
+      m_polygons.push_back (db::Polygon ());
+      shape.polygon (m_polygons.back ());
+      m_polygons.back ().transform (m_trans * trans, false);
+    }
+  }
+
+  const std::vector<db::Polygon> &polygons () const
+  {
+    return m_polygons;
+  }
+
+private:
+  db::ICplxTrans m_trans;
+  std::vector<db::Polygon> m_polygons;
+};
+
+class FlatRegionParallelReceiver
+  : public db::ParallelRecursiveShapeReceiver
+{
+public:
+  FlatRegionParallelReceiver (FlatRegion *region, const db::ICplxTrans &trans)
+    : mp_region (region), m_trans (trans)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual db::RecursiveShapeReceiver *create_receiver (size_t /*index*/, const db::Box & /*box*/)
+  {
+    return new FlatRegionChunkReceiver (m_trans);
+  }
+
+  virtual void finish_receiver (size_t /*index*/, db::RecursiveShapeReceiver *receiver)
+  {
+    const std::vector<db::Polygon> &polygons = static_cast<FlatRegionChunkReceiver *> (receiver)->polygons ();
+    mp_region->insert (polygons.begin (), polygons.end ());
+  }
+
+private:
+  FlatRegion *mp_region;
+  db::ICplxTrans m_trans;
+};
+
+}
+
+db::Region &
+Region::flatten (unsigned int threads)
+{
+  if (threads > 0 && dynamic_cast<OriginalLayerRegion *> (mp_delegate) != 0) {
+
+    std::pair<db::RecursiveShapeIterator, db::ICplxTrans> si = begin_iter ();
+
+    std::unique_ptr<FlatRegion> region (new FlatRegion ());
+    region->RegionDelegate::operator= (*mp_delegate);   //  copy basic flags
+
+    FlatRegionParallelReceiver receiver (region.get (), si.second);
+    si.first.push (&receiver, threads);
+
+    region->set_is_merged (mp_delegate->is_merged ());
+    set_delegate (region.release ());
+
+  } else {
+    flat_region ();
+  }
+
+  return *this;
+}
+
 EdgePairs
 Region::cop_to_edge_pairs (db::CompoundRegionOperationNode &node)
 {
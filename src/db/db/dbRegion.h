@@ -1549,6 +1549,15 @@ public:
     return *this;
   }
 
+  /**
+   *  @brief Forces flattening of the region using multiple threads
+   *
+   *  For regions taken from a layout, the shapes are collected on "threads" worker threads
+   *  using the partitioned mode of the recursive shape iterator. The order of the polygons
+   *  may differ from the one produced by the single-threaded version.
+   */
+  db::Region &flatten (unsigned int threads);
+
   /**
    *  @brief Returns true, if the region has valid polygons stored within itself
    *
@@ -123,7 +123,8 @@ struct DB_PUBLIC RegionCheckOptions
                       bool _shielded = true,
                       OppositeFilter _opposite_filter = NoOppositeFilter,
                       RectFilter _rect_filter = NoSideAllowed,
-                      bool _negative = false)
+                      bool _negative = false,
+                      unsigned int _threads = 0)
     : whole_edges (_whole_edges),
       metrics (_metrics),
       ignore_angle (_ignore_angle),
@@ -132,7 +133,8 @@ struct DB_PUBLIC RegionCheckOptions
       shielded (_shielded),
       opposite_filter (_opposite_filter),
       rect_filter (_rect_filter),
-      negative (_negative)
+      negative (_negative),
+      threads (_threads)
   { }
 
   /**
@@ -196,6 +198,17 @@ struct DB_PUBLIC RegionCheckOptions
    *  @brief Specifies whether to produce negative output
    */
   bool negative;
+
+  /**
+   *  @brief Specifies the number of threads to use for checks on flat regions
+   *
+   *  With two or more threads, the flat implementation splits the input into vertical slabs
+   *  which are checked in parallel. The result is the same as with a single thread, but the
+   *  order of the edge pairs may be different. Two-polygon checks with negative output are
+   *  always run in a single thread. Deep regions use the thread count of the deep shape
+   *  store instead.
+   */
+  unsigned int threads;
 };
 
 template <class TS, class TI>
@@ -0,0 +1,82 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbShapeCounts.h"
+
+namespace db
+{
+
+ShapeCounts::ShapeCounts ()
+{
+  for (unsigned int c = 0; c < (unsigned int) num_categories; ++c) {
+    m_single [c] = 0;
+    m_arrays [c] = 0;
+    m_members [c] = 0;
+  }
+}
+
+size_t
+ShapeCounts::total () const
+{
+  size_t n = 0;
+  for (unsigned int c = 0; c < (unsigned int) num_categories; ++c) {
+    n += m_single [c] + m_members [c];
+  }
+  return n;
+}
+
+ShapeCounts &
+ShapeCounts::operator+= (const ShapeCounts &other)
+{
+  for (unsigned int c = 0; c < (unsigned int) num_categories; ++c) {
+    m_single [c] += other.m_single [c];
+    m_arrays [c] += other.m_arrays [c];
+    m_members [c] += other.m_members [c];
+  }
+  return *this;
+}
+
+ShapeCounts &
+ShapeCounts::operator*= (size_t f)
+{
+  for (unsigned int c = 0; c < (unsigned int) num_categories; ++c) {
+    m_single [c] *= f;
+    m_arrays [c] *= f;
+    m_members [c] *= f;
+  }
+  return *this;
+}
+
+bool
+ShapeCounts::operator== (const ShapeCounts &other) const
+{
+  for (unsigned int c = 0; c < (unsigned int) num_categories; ++c) {
+    if (m_single [c] != other.m_single [c] || m_arrays [c] != other.m_arrays [c] || m_members [c] != other.m_members [c]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}
+
@@ -0,0 +1,154 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_dbShapeCounts
+#define HDR_dbShapeCounts
+
+#include "dbCommon.h"
+
+#include <cstddef>
+
+namespace db
+{
+
+/**
+ *  @brief A summary of the shapes inside a shape container
+ *
+ *  The counts are kept per shape category. For each category, the
+ *  number of single shapes, the number of shape arrays and the number
+ *  of shapes contributed by these arrays is recorded. "total" delivers
+ *  the effective number of shapes (single shapes plus array members).
+ *
+ *  Shape counts can be added and scaled, so they can be used to derive
+ *  flat counts from hierarchical ones.
+ */
+class DB_PUBLIC ShapeCounts
+{
+public:
+  /**
+   *  @brief The shape categories
+   */
+  enum category
+  {
+    Boxes = 0,
+    Polygons,
+    Paths,
+    Texts,
+    Edges,
+    EdgePairs,
+    UserObjects,
+    num_categories
+  };
+
+  /**
+   *  @brief Creates an empty count object
+   */
+  ShapeCounts ();
+
+  /**
+   *  @brief Adds single shapes for the given category
+   */
+  void add_single (category c, size_t n)
+  {
+    m_single [c] += n;
+  }
+
+  /**
+   *  @brief Adds one shape array with the given number of members for the given category
+   */
+  void add_array (category c, size_t members)
+  {
+    m_arrays [c] += 1;
+    m_members [c] += members;
+  }
+
+  /**
+   *  @brief Gets the effective number of shapes (single shapes plus array members) for the given category
+   */
+  size_t total (category c) const
+  {
+    return m_single [c] + m_members [c];
+  }
+
+  /**
+   *  @brief Gets the number of single (non-array) shapes for the given category
+   */
+  size_t single (category c) const
+  {
+    return m_single [c];
+  }
+
+  /**
+   *  @brief Gets the number of shape arrays for the given category
+   */
+  size_t arrays (category c) const
+  {
+    return m_arrays [c];
+  }
+
+  /**
+   *  @brief Gets the effective number of shapes over all categories
+   */
+  size_t total () const;
+
+  /**
+   *  @brief Returns true, if no shapes are counted
+   */
+  bool empty () const
+  {
+    return total () == 0;
+  }
+
+  /**
+   *  @brief Adds another count object to this one
+   */
+  ShapeCounts &operator+= (const ShapeCounts &other);
+
+  /**
+   *  @brief Multiplies all counts by the given factor
+   */
+  ShapeCounts &operator*= (size_t f);
+
+  /**
+   *  @brief Equality
+   */
+  bool operator== (const ShapeCounts &other) const;
+
+  /**
+   *  @brief Inequality
+   */
+  bool operator!= (const ShapeCounts &other) const
+  {
+    return ! operator== (other);
+  }
+
+private:
+  size_t m_single [num_categories];
+  size_t m_arrays [num_categories];
+  size_t m_members [num_categories];
+};
+
+}
+
+#endif
+
@@ -33,6 +33,11 @@
 
 #include <set>
 
+namespace tl
+{
+  class Arena;
+}
+
 namespace db {
 
 template <class C> class polygon;
@@ -42,6 +47,30 @@ template <class C> class edge;
 template <class C> class text;
 template <class C> class user_object;
 
+/**
+ *  @brief Internal: moves the storage of a repository object into an arena
+ *
+ *  Only polygons have storage to move. Moving the storage does not change the
+ *  geometry and hence not the sorting order inside the repository.
+ */
+template <class Sh>
+inline void compact_repository_object (const Sh & /*obj*/, tl::Arena * /*arena*/)
+{
+  //  .. nothing yet ..
+}
+
+template <class C>
+inline void compact_repository_object (const db::polygon<C> &obj, tl::Arena *arena)
+{
+  const_cast<db::polygon<C> &> (obj).compact (arena);
+}
+
+template <class C>
+inline void compact_repository_object (const db::simple_polygon<C> &obj, tl::Arena *arena)
+{
+  const_cast<db::simple_polygon<C> &> (obj).compact (arena);
+}
+
 /**
  *  @brief A repository for a certain shape type
  *
@@ -62,7 +91,7 @@ public:
    *  @brief The standard constructor
    */
   repository ()
-    : m_set ()
+    : m_set (), mp_arena (0)
   {
     //  .. nothing yet ..
   }
@@ -76,8 +105,31 @@ public:
    */
   const Sh *insert (const Sh &shape)
   {
-    typename std::set<Sh>::iterator f = m_set.insert (shape).first;
-    return &(*f);
+    std::pair<typename std::set<Sh>::iterator, bool> f = m_set.insert (shape);
+    if (f.second && mp_arena) {
+      compact_repository_object (*f.first, mp_arena);
+    }
+    return &(*f.first);
+  }
+
+  /**
+   *  @brief Sets the arena for compact storage of new shapes
+   *
+   *  If an arena is set, polygons entering the repository are converted into
+   *  compact representation with storage taken from the arena (see polygon::compact).
+   *  Pass 0 to disable compaction. The arena must live longer than the repository.
+   */
+  void set_arena (tl::Arena *arena)
+  {
+    mp_arena = arena;
+  }
+
+  /**
+   *  @brief Gets the arena for compact storage
+   */
+  tl::Arena *arena () const
+  {
+    return mp_arena;
   }
 
   /**
@@ -111,6 +163,7 @@ public:
 
 private:
   set_type m_set;
+  tl::Arena *mp_arena;
 };
 
 /**
@@ -176,6 +229,18 @@ public:
     return const_cast<generic_repository<C> *> (this)->repository (tag);
   }
 
+  /**
+   *  @brief Sets the arena for compact storage of new polygons
+   *
+   *  See repository::set_arena for details. This applies to the polygon and
+   *  simple polygon repositories.
+   */
+  void set_polygon_arena (tl::Arena *arena)
+  {
+    m_polygon_repository.set_arena (arena);
+    m_simple_polygon_repository.set_arena (arena);
+  }
+
   void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, bool no_self, void *parent) const
   {
     db::mem_stat (stat, purpose, cat, m_polygon_repository, no_self, parent);
@@ -30,6 +30,7 @@
 #include "dbLayout.h"
 
 #include <limits>
+#include <cstring>
 
 namespace db
 {
@@ -81,6 +82,278 @@ inline bool needs_translate (object_tag<Sh> /*tag*/)
   return tl::is_equal_type<typename shape_traits<Sh>::can_deref, tl::True> () || tl::is_equal_type<typename shape_traits<Sh>::is_array, tl::True> ();
 }
 
+/**
+ *  @brief A memory statistics collector delivering the total memory only
+ */
+class MemSizeCollector
+  : public MemStatistics
+{
+public:
+  MemSizeCollector () : m_size (0) { }
+
+  virtual void add (const std::type_info & /*ti*/, void * /*ptr*/, size_t size, size_t /*used*/, void * /*parent*/, purpose_t /*purpose*/, int /*cat*/)
+  {
+    m_size += size;
+  }
+
+  size_t size () const
+  {
+    return m_size;
+  }
+
+private:
+  size_t m_size;
+};
+
+template <class T>
+inline void put_value (std::string &data, T v)
+{
+  data.append ((const char *) &v, sizeof (T));
+}
+
+template <class T>
+inline T get_value (const char *&data)
+{
+  T v;
+  memcpy ((void *) &v, data, sizeof (T));
+  data += sizeof (T);
+  return v;
+}
+
+inline void put_point (std::string &data, const db::Point &p)
+{
+  put_value (data, p.x ());
+  put_value (data, p.y ());
+}
+
+inline db::Point get_point (const char *&data)
+{
+  db::Coord x = get_value<db::Coord> (data);
+  db::Coord y = get_value<db::Coord> (data);
+  return db::Point (x, y);
+}
+
+template <class Iter>
+inline void put_points (std::string &data, Iter from, Iter to, size_t n)
+{
+  put_value (data, (uint64_t) n);
+  for (Iter i = from; i != to; ++i) {
+    put_point (data, *i);
+  }
+}
+
+inline void get_points (const char *&data, std::vector<db::Point> &pts)
+{
+  pts.clear ();
+  size_t n = size_t (get_value<uint64_t> (data));
+  pts.reserve (n);
+  for (size_t i = 0; i < n; ++i) {
+    pts.push_back (get_point (data));
+  }
+}
+
+template <class Ctr>
+inline void put_contour (std::string &data, const Ctr &ctr)
+{
+  put_value (data, (uint64_t) ctr.size ());
+  //  NOTE: random access is slow on compact contours, so we use the iterator
+  for (typename Ctr::simple_iterator p = ctr.begin (); p != ctr.end (); ++p) {
+    put_point (data, *p);
+  }
+}
+
+/**
+ *  @brief Serializes shapes for the compaction of undo operations (see db::Op::compact)
+ *
+ *  Only the shape types carrying their own geometry are supported. References, arrays
+ *  and texts (which may refer to a string repository) stay in memory.
+ */
+template <class Sh>
+struct op_serializer
+{
+  static const bool supported = false;
+  static void write (std::string & /*data*/, const Sh & /*sh*/) { }
+  static void read (const char *& /*data*/, Sh & /*sh*/) { }
+};
+
+template <>
+struct op_serializer<db::Box>
+{
+  static const bool supported = true;
+
+  static void write (std::string &data, const db::Box &box)
+  {
+    put_value (data, char (box.empty () ? 1 : 0));
+    if (! box.empty ()) {
+      put_point (data, box.p1 ());
+      put_point (data, box.p2 ());
+    }
+  }
+
+  static void read (const char *&data, db::Box &box)
+  {
+    if (get_value<char> (data)) {
+      box = db::Box ();
+    } else {
+      db::Point p1 = get_point (data);
+      db::Point p2 = get_point (data);
+      box = db::Box (p1, p2);
+    }
+  }
+};
+
+template <>
+struct op_serializer<db::Point>
+{
+  static const bool supported = true;
+
+  static void write (std::string &data, const db::Point &pt)
+  {
+    put_point (data, pt);
+  }
+
+  static void read (const char *&data, db::Point &pt)
+  {
+    pt = get_point (data);
+  }
+};
+
+template <>
+struct op_serializer<db::Edge>
+{
+  static const bool supported = true;
+
+  static void write (std::string &data, const db::Edge &edge)
+  {
+    put_point (data, edge.p1 ());
+    put_point (data, edge.p2 ());
+  }
+
+  static void read (const char *&data, db::Edge &edge)
+  {
+    db::Point p1 = get_point (data);
+    db::Point p2 = get_point (data);
+    edge = db::Edge (p1, p2);
+  }
+};
+
+template <>
+struct op_serializer<db::EdgePair>
+{
+  static const bool supported = true;
+
+  static void write (std::string &data, const db::EdgePair &ep)
+  {
+    op_serializer<db::Edge>::write (data, ep.first ());
+    op_serializer<db::Edge>::write (data, ep.second ());
+    put_value (data, char (ep.is_symmetric () ? 1 : 0));
+  }
+
+  static void read (const char *&data, db::EdgePair &ep)
+  {
+    db::Edge e1, e2;
+    op_serializer<db::Edge>::read (data, e1);
+    op_serializer<db::Edge>::read (data, e2);
+    bool symmetric = get_value<char> (data) != 0;
+    ep = db::EdgePair (e1, e2, symmetric);
+  }
+};
+
+template <>
+struct op_serializer<db::Polygon>
+{
+  static const bool supported = true;
+
+  static void write (std::string &data, const db::Polygon &poly)
+  {
+    put_value (data, (uint64_t) poly.holes ());
+    put_contour (data, poly.hull ());
+    for (unsigned int h = 0; h < poly.holes (); ++h) {
+      put_contour (data, poly.hole (h));
+    }
+  }
+
+  static void read (const char *&data, db::Polygon &poly)
+  {
+    size_t holes = size_t (get_value<uint64_t> (data));
+    std::vector<db::Point> pts;
+    get_points (data, pts);
+    poly.assign_hull (pts.begin (), pts.end (), false /*don't compress*/);
+    for (size_t h = 0; h < holes; ++h) {
+      get_points (data, pts);
+      poly.insert_hole (pts.begin (), pts.end (), false /*don't compress*/);
+    }
+  }
+};
+
+template <>
+struct op_serializer<db::SimplePolygon>
+{
+  static const bool supported = true;
+
+  static void write (std::string &data, const db::SimplePolygon &poly)
+  {
+    put_contour (data, poly.hull ());
+  }
+
+  static void read (const char *&data, db::SimplePolygon &poly)
+  {
+    std::vector<db::Point> pts;
+    get_points (data, pts);
+    poly.assign_hull (pts.begin (), pts.end (), false /*don't compress*/);
+  }
+};
+
+template <>
+struct op_serializer<db::Path>
+{
+  static const bool supported = true;
+
+  static void write (std::string &data, const db::Path &path)
+  {
+    put_value (data, path.width ());
+    put_value (data, path.bgn_ext ());
+    put_value (data, path.end_ext ());
+    put_value (data, char (path.round () ? 1 : 0));
+    put_points (data, path.begin (), path.end (), path.points ());
+  }
+
+  static void read (const char *&data, db::Path &path)
+  {
+    db::Coord w = get_value<db::Coord> (data);
+    db::Coord bx = get_value<db::Coord> (data);
+    db::Coord ex = get_value<db::Coord> (data);
+    bool round = get_value<char> (data) != 0;
+    std::vector<db::Point> pts;
+    get_points (data, pts);
+    path.assign (pts.begin (), pts.end ());
+    path.width (w);
+    path.bgn_ext (bx);
+    path.end_ext (ex);
+    path.round (round);
+  }
+};
+
+template <class Sh>
+struct op_serializer<db::object_with_properties<Sh> >
+{
+  static const bool supported = op_serializer<Sh>::supported;
+
+  static void write (std::string &data, const db::object_with_properties<Sh> &sh)
+  {
+    op_serializer<Sh>::write (data, sh);
+    put_value (data, sh.properties_id ());
+  }
+
+  static void read (const char *&data, db::object_with_properties<Sh> &sh)
+  {
+    Sh s;
+    op_serializer<Sh>::read (data, s);
+    db::properties_id_type pid = get_value<db::properties_id_type> (data);
+    sh = db::object_with_properties<Sh> (s, pid);
+  }
+};
+
 // ---------------------------------------------------------------------------------------
 //  layer_op implementation
 
@@ -131,6 +404,222 @@ layer_op<Sh, StableTag>::erase (Shapes *shapes)
   }
 }
 
+template <class Sh, class StableTag>
+size_t
+layer_op<Sh, StableTag>::mem_size () const
+{
+  MemSizeCollector ms;
+  db::mem_stat (&ms, MemStatistics::None, 0, m_shapes, true);
+  return sizeof (*this) + ms.size ();
+}
+
+template <class Sh, class StableTag>
+bool
+layer_op<Sh, StableTag>::compact (std::string &data)
+{
+  if (! op_serializer<Sh>::supported) {
+    return false;
+  }
+
+  put_value (data, (uint64_t) m_shapes.size ());
+  for (typename std::vector<Sh>::const_iterator s = m_shapes.begin (); s != m_shapes.end (); ++s) {
+    op_serializer<Sh>::write (data, *s);
+  }
+
+  std::vector<Sh> ().swap (m_shapes);
+  return true;
+}
+
+template <class Sh, class StableTag>
+void
+layer_op<Sh, StableTag>::expand (const char *&data)
+{
+  size_t n = size_t (get_value<uint64_t> (data));
+  m_shapes.resize (n);
+  for (typename std::vector<Sh>::iterator s = m_shapes.begin (); s != m_shapes.end (); ++s) {
+    op_serializer<Sh>::read (data, *s);
+  }
+}
+
+// ---------------------------------------------------------------------------------------
+//  ShapesSnapshotOp implementation
+
+namespace
+{
+
+template <class Sh, class StableTag>
+bool compact_snapshot_layer (LayerBase *layer, std::string &data)
+{
+  const layer_class<Sh, StableTag> *lc = dynamic_cast<const layer_class<Sh, StableTag> *> (layer);
+  if (! lc) {
+    return false;
+  }
+
+  put_value (data, (uint64_t) lc->layer ().size ());
+  for (typename db::layer<Sh, StableTag>::iterator s = lc->layer ().begin (); s != lc->layer ().end (); ++s) {
+    op_serializer<Sh>::write (data, *s);
+  }
+
+  return true;
+}
+
+template <class Sh, class StableTag>
+LayerBase *expand_snapshot_layer (const char *&data)
+{
+  layer_class<Sh, StableTag> *lc = new layer_class<Sh, StableTag> ();
+
+  size_t n = size_t (get_value<uint64_t> (data));
+  lc->layer ().reserve (n);
+  for (size_t i = 0; i < n; ++i) {
+    Sh sh;
+    op_serializer<Sh>::read (data, sh);
+    lc->layer ().insert (sh);
+  }
+
+  return lc;
+}
+
+struct SnapshotLayerSerializer
+{
+  bool (*compact) (LayerBase *layer, std::string &data);
+  LayerBase *(*expand) (const char *&data);
+};
+
+#define DB_SNAPSHOT_LAYER_SERIALIZER(Sh) \
+  { &compact_snapshot_layer<Sh, db::stable_layer_tag>, &expand_snapshot_layer<Sh, db::stable_layer_tag> }, \
+  { &compact_snapshot_layer<Sh, db::unstable_layer_tag>, &expand_snapshot_layer<Sh, db::unstable_layer_tag> }, \
+  { &compact_snapshot_layer<db::object_with_properties<Sh>, db::stable_layer_tag>, &expand_snapshot_layer<db::object_with_properties<Sh>, db::stable_layer_tag> }, \
+  { &compact_snapshot_layer<db::object_with_properties<Sh>, db::unstable_layer_tag>, &expand_snapshot_layer<db::object_with_properties<Sh>, db::unstable_layer_tag> }
+
+//  the layer types supported by op_serializer
+static const SnapshotLayerSerializer snapshot_layer_serializers [] = {
+  DB_SNAPSHOT_LAYER_SERIALIZER (db::Box),
+  DB_SNAPSHOT_LAYER_SERIALIZER (db::Edge),
+  DB_SNAPSHOT_LAYER_SERIALIZER (db::EdgePair),
+  DB_SNAPSHOT_LAYER_SERIALIZER (db::Polygon),
+  DB_SNAPSHOT_LAYER_SERIALIZER (db::SimplePolygon),
+  DB_SNAPSHOT_LAYER_SERIALIZER (db::Path)
+};
+
+#undef DB_SNAPSHOT_LAYER_SERIALIZER
+
+static const unsigned char snapshot_layer_kept = 0xff;
+
+}
+
+ShapesSnapshotOp::ShapesSnapshotOp (Shapes *shapes)
+{
+  m_layers.swap (shapes->m_layers);
+}
+
+ShapesSnapshotOp::~ShapesSnapshotOp ()
+{
+  for (tl::vector<LayerBase *>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+    delete *l;
+  }
+  m_layers.clear ();
+}
+
+void
+ShapesSnapshotOp::undo (Shapes *shapes)
+{
+  swap_layers (shapes);
+
+  //  Usually the shapes container is empty before the undo. Shapes added without undo
+  //  support after the clear are merged into the restored ones.
+  tl::vector<LayerBase *> added;
+  added.swap (m_layers);
+  for (tl::vector<LayerBase *>::const_iterator l = added.begin (); l != added.end (); ++l) {
+    if (! (*l)->empty ()) {
+      (*l)->insert_into (shapes);
+    }
+    delete *l;
+  }
+}
+
+void
+ShapesSnapshotOp::redo (Shapes *shapes)
+{
+  swap_layers (shapes);
+}
+
+void
+ShapesSnapshotOp::swap_layers (Shapes *shapes)
+{
+  shapes->invalidate_state ();  //  HINT: must come before the change is done!
+  m_layers.swap (shapes->m_layers);
+}
+
+bool
+ShapesSnapshotOp::compact (std::string &data)
+{
+  const size_t nserializers = sizeof (snapshot_layer_serializers) / sizeof (snapshot_layer_serializers [0]);
+
+  std::string layer_data;
+  std::string order;
+  tl::vector<LayerBase *> kept;
+
+  for (tl::vector<LayerBase *>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+
+    size_t i = 0;
+    while (i < nserializers && ! snapshot_layer_serializers [i].compact (*l, layer_data)) {
+      ++i;
+    }
+
+    if (i < nserializers) {
+      order += char (i);
+      delete *l;
+    } else {
+      order += char (snapshot_layer_kept);
+      kept.push_back (*l);
+    }
+
+  }
+
+  if (kept.size () == m_layers.size ()) {
+    //  nothing to compact
+    return false;
+  }
+
+  m_layers.swap (kept);
+
+  put_value (data, (uint64_t) order.size ());
+  data += order;
+  data += layer_data;
+  return true;
+}
+
+void
+ShapesSnapshotOp::expand (const char *&data)
+{
+  size_t n = size_t (get_value<uint64_t> (data));
+  std::string order (data, n);
+  data += n;
+
+  tl::vector<LayerBase *> kept;
+  kept.swap (m_layers);
+
+  tl::vector<LayerBase *>::const_iterator k = kept.begin ();
+  for (std::string::const_iterator o = order.begin (); o != order.end (); ++o) {
+    if ((unsigned char) *o == snapshot_layer_kept) {
+      tl_assert (k != kept.end ());
+      m_layers.push_back (*k++);
+    } else {
+      m_layers.push_back (snapshot_layer_serializers [(unsigned char) *o].expand (data));
+    }
+  }
+}
+
+size_t
+ShapesSnapshotOp::mem_size () const
+{
+  MemSizeCollector ms;
+  for (tl::vector<LayerBase *>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+    (*l)->mem_stat (&ms, MemStatistics::None, 0, false, 0);
+  }
+  return sizeof (*this) + ms.size ();
+}
+
 // ---------------------------------------------------------------------------------------
 //  Shapes implementation
 
@@ -225,6 +714,7 @@ Shapes::invalidate_state ()
       unsigned int index = cell ()->index_of_shapes (this);
       if (index != std::numeric_limits<unsigned int>::max ()) {
         layout ()->invalidate_bboxes (index);
+        layout ()->invalidate_shape_counts (cell ()->cell_index (), index);
       }
     }
   }
@@ -931,12 +1421,83 @@ void
 Shapes::clear ()
 {
   if (!m_layers.empty ()) {
-    for (tl::vector<LayerBase *>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
-      (*l)->clear (this, manager ());
-      delete *l;
+    if (manager () && manager ()->transacting ()) {
+      //  hand over the layers to the undo queue rather than copying the shapes
+      invalidate_state ();  //  HINT: must come before the change is done!
+      manager ()->queue (this, new db::ShapesSnapshotOp (this));
+    } else {
+      for (tl::vector<LayerBase *>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+        (*l)->clear (this, manager ());
+        delete *l;
+      }
+      invalidate_state ();  //  HINT: must come before the change is done!
+      m_layers.clear ();
     }
-    invalidate_state ();  //  HINT: must come before the change is done!
-    m_layers.clear ();
+  }
+}
+
+void
+Shapes::count_shapes (db::ShapeCounts &counts) const
+{
+  const unsigned int array_mask = (1 << ShapeIterator::PolygonPtrArray) | (1 << ShapeIterator::SimplePolygonPtrArray) |
+                                  (1 << ShapeIterator::PathPtrArray) | (1 << ShapeIterator::BoxArray) |
+                                  (1 << ShapeIterator::ShortBoxArray) | (1 << ShapeIterator::TextPtrArray);
+
+  unsigned int arrays_present = 0;
+
+  for (tl::vector<LayerBase *>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+
+    unsigned int tm = (*l)->type_mask () & (unsigned int) ShapeIterator::All;
+    if ((tm & array_mask) != 0) {
+      arrays_present |= tm;
+      continue;
+    }
+
+    db::ShapeCounts::category c;
+    if ((tm & ShapeIterator::Boxes) != 0) {
+      c = db::ShapeCounts::Boxes;
+    } else if ((tm & ShapeIterator::Polygons) != 0) {
+      c = db::ShapeCounts::Polygons;
+    } else if ((tm & ShapeIterator::Paths) != 0) {
+      c = db::ShapeCounts::Paths;
+    } else if ((tm & ShapeIterator::Texts) != 0) {
+      c = db::ShapeCounts::Texts;
+    } else if ((tm & ShapeIterator::Edges) != 0) {
+      c = db::ShapeCounts::Edges;
+    } else if ((tm & ShapeIterator::EdgePairs) != 0) {
+      c = db::ShapeCounts::EdgePairs;
+    } else if ((tm & ShapeIterator::UserObjects) != 0) {
+      c = db::ShapeCounts::UserObjects;
+    } else {
+      continue;
+    }
+
+    counts.add_single (c, (*l)->size ());
+
+  }
+
+  //  arrays need to be visited for the number of members
+  if (arrays_present != 0) {
+
+    for (ShapeIterator i = begin (arrays_present); ! i.at_end (); ++i) {
+
+      tl_assert (i.in_array ());
+
+      size_t n = i.array ().array_size ();
+      i.finish_array ();
+
+      if (i->is_box ()) {
+        counts.add_array (db::ShapeCounts::Boxes, n);
+      } else if (i->is_polygon ()) {
+        counts.add_array (db::ShapeCounts::Polygons, n);
+      } else if (i->is_path ()) {
+        counts.add_array (db::ShapeCounts::Paths, n);
+      } else if (i->is_text ()) {
+        counts.add_array (db::ShapeCounts::Texts, n);
+      }
+
+    }
+
   }
 }
 
@@ -986,6 +1547,13 @@ void Shapes::sort ()
   }
 }
 
+void Shapes::compact_polygons (tl::Arena *arena)
+{
+  for (tl::vector<LayerBase *>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+    (*l)->compact_polygons (arena);
+  }
+}
+
 void 
 Shapes::redo (db::Op *op)
 {
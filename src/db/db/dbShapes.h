@@ -32,6 +32,7 @@
 #include "dbLayer.h"
 #include "dbPropertiesRepository.h"
 #include "dbShape.h"
+#include "dbShapeCounts.h"
 #include "tlVector.h"
 #include "tlUtils.h"
 
@@ -502,6 +503,7 @@ public:
   virtual void deref_and_transform_into (Shapes *target, const ICplxTrans &trans) = 0;
   virtual void deref_and_transform_into (Shapes *target, const ICplxTrans &trans, pm_delegate_type &pm) = 0;
   virtual unsigned int type_mask () const = 0;
+  virtual void compact_polygons (tl::Arena *arena) = 0;
 
   virtual void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, bool no_self, void *parent) const;
 };
@@ -814,9 +816,13 @@ public:
     }
     invalidate_state ();  //  HINT: must come before the change is done!
     if (is_editable ()) {
-      return shape_type (this, get_layer<Sh, db::stable_layer_tag> ().insert (sh));
+      typename db::layer<Sh, db::stable_layer_tag>::iterator i = get_layer<Sh, db::stable_layer_tag> ().insert (sh);
+      compact_on_insert (*i);
+      return shape_type (this, i);
     } else {
-      return shape_type (this, *get_layer<Sh, db::unstable_layer_tag> ().insert (sh));
+      typename db::layer<Sh, db::unstable_layer_tag>::iterator i = get_layer<Sh, db::unstable_layer_tag> ().insert (sh);
+      compact_on_insert (*i);
+      return shape_type (this, *i);
     }
   }
 
@@ -1186,6 +1192,17 @@ public:
    */
   bool is_bbox_dirty () const;
 
+  /**
+   *  @brief Returns true, if the container was modified since the last update
+   *
+   *  A container which is not dirty will report the next modification to the
+   *  layout it lives in. This is the basis for caching derived information.
+   */
+  bool is_dirty () const 
+  {
+    return (size_t (mp_cell) & 1) != 0;
+  }
+
   /**
    *  @brief Retrieve the bbox 
    *
@@ -1205,6 +1222,21 @@ public:
    */
   void sort ();
 
+  /**
+   *  @brief Converts the polygons into the compact representation
+   *
+   *  This method converts polygons and simple polygons into the compact,
+   *  delta-encoded representation (see polygon::compact). This includes polygons referenced
+   *  by polygon references and polygon reference arrays. The geometry is not changed, hence
+   *  no undo information is recorded.
+   *  The compact representation is intended for read-only use (i.e. viewing) - it
+   *  saves memory but makes random access to the points more expensive.
+   *
+   *  If an arena is given, the polygon storage is taken from the arena. The arena
+   *  must live longer than this container then.
+   */
+  void compact_polygons (tl::Arena *arena = 0);
+
   /**
    *  @brief Clears the collection
    */
@@ -1250,6 +1282,14 @@ public:
     return n;
   }
 
+  /**
+   *  @brief Adds the shapes of this container to the given shape count object
+   *
+   *  Single shapes are counted from the per-type storage directly. Only shape
+   *  arrays need to be visited for determining the number of members.
+   */
+  void count_shapes (db::ShapeCounts &counts) const;
+
   /**
    *  @brief Report the shape count for a certain type
    */
@@ -1466,6 +1506,7 @@ public:
 
 private:
   friend class ShapeIterator;
+  friend class ShapesSnapshotOp;
 
   tl::vector<LayerBase *> m_layers;
   db::Cell *mp_cell;  //  HINT: contains "dirty" in bit 0 and "editable" in bit 1
@@ -1473,12 +1514,6 @@ private:
   void invalidate_state ();
   void do_insert (const Shapes &d);
 
-  //  extract dirty flag from mp_cell
-  bool is_dirty () const 
-  {
-    return (size_t (mp_cell) & 1) != 0;
-  }
-
   //  extract editable flag from mp_cell
   bool is_editable () const 
   {
@@ -1488,6 +1523,15 @@ private:
   //  get the shape repository associated with this container
   db::GenericRepository &shape_repository () const;
 
+  //  compacts a newly inserted polygon if the layout is in compact polygon mode
+  template <class Sh>
+  void compact_on_insert (const Sh & /*sh*/) { }
+  void compact_on_insert (const shape_type::polygon_type &sh);
+  void compact_on_insert (const shape_type::simple_polygon_type &sh);
+  void compact_on_insert (const db::object_with_properties<shape_type::polygon_type> &sh);
+  void compact_on_insert (const db::object_with_properties<shape_type::simple_polygon_type> &sh);
+  tl::Arena *compact_polygon_arena () const;
+
   //  get the array repository associated with this container
   db::ArrayRepository &array_repository () const; 
 
@@ -1687,6 +1731,10 @@ public:
     }
   }
 
+  virtual size_t mem_size () const;
+  virtual bool compact (std::string &data);
+  virtual void expand (const char *&data);
+
   static void queue_or_append (db::Manager *manager, db::Shapes *shapes, bool insert, const Sh &sh)
   {
     db::layer_op<Sh, StableTag> *old_op = dynamic_cast <db::layer_op<Sh, StableTag> *> (manager->last_queued (shapes));
@@ -1729,6 +1777,37 @@ private:
   void erase (Shapes *shapes);
 };
 
+/**
+ *  @brief A undo/redo queue object for clearing a shapes container
+ *
+ *  Instead of copying the shapes, this operation takes over the layers of the
+ *  shapes container when it is cleared. Undo and redo swap the layers back and forth.
+ *  If shapes have been added to the container without undo support after it was
+ *  cleared, undo merges these shapes with the restored ones. A redo clears them too.
+ *
+ *  For the memory budget of the manager, the layers with serializable shape types
+ *  (boxes, polygons, paths, edges etc.) can be compacted. Other layers (references,
+ *  arrays, texts) stay in memory.
+ */
+class DB_PUBLIC ShapesSnapshotOp
+  : public LayerOpBase
+{
+public:
+  ShapesSnapshotOp (Shapes *shapes);
+  ~ShapesSnapshotOp ();
+
+  virtual void undo (Shapes *shapes);
+  virtual void redo (Shapes *shapes);
+  virtual size_t mem_size () const;
+  virtual bool compact (std::string &data);
+  virtual void expand (const char *&data);
+
+private:
+  tl::vector<LayerBase *> m_layers;
+
+  void swap_layers (Shapes *shapes);
+};
+
 }  // namespace db
   
 #endif
@@ -22,6 +22,7 @@
 
 
 #include "dbShapes2.h"
+#include "dbLayout.h"
 
 namespace db
 {
@@ -909,6 +910,98 @@ layer_class<Sh, StableTag>::type_mask () const
   return iterator_type_mask (typename Sh::tag ());
 }
 
+/// @brief Internal: compacts the polygon storage of a shape (generic: nothing to compact)
+template <class Sh>
+inline void compact_polygon_storage (const Sh & /*shape*/, tl::Arena * /*arena*/)
+{
+  //  .. nothing yet ..
+}
+
+/// @brief Internal: compacts the polygon storage of a polygon
+inline void compact_polygon_storage (const db::Shape::polygon_type &shape, tl::Arena *arena)
+{
+  //  compaction does not change the geometry, so it does not harm the sorting order of the container
+  const_cast<db::Shape::polygon_type &> (shape).compact (arena);
+}
+
+/// @brief Internal: compacts the polygon storage of a simple polygon
+inline void compact_polygon_storage (const db::Shape::simple_polygon_type &shape, tl::Arena *arena)
+{
+  const_cast<db::Shape::simple_polygon_type &> (shape).compact (arena);
+}
+
+/// @brief Internal: compacts the polygon storage of a polygon reference
+template <class Sh, class Tr>
+inline void compact_polygon_storage (const db::polygon_ref<Sh, Tr> &shape, tl::Arena *arena)
+{
+  //  NOTE: this compacts the polygon inside the shape repository
+  if (shape.ptr ()) {
+    compact_polygon_storage (*shape.ptr (), arena);
+  }
+}
+
+/// @brief Internal: compacts the polygon storage of a shape array
+template <class Obj, class Tr>
+inline void compact_polygon_storage (const db::array<Obj, Tr> &shape, tl::Arena *arena)
+{
+  compact_polygon_storage (shape.object (), arena);
+}
+
+/// @brief Internal: compacts the polygon storage of a shape with properties
+template <class Sh>
+inline void compact_polygon_storage (const db::object_with_properties<Sh> &shape, tl::Arena *arena)
+{
+  compact_polygon_storage ((const Sh &) shape, arena);
+}
+
+tl::Arena *
+Shapes::compact_polygon_arena () const
+{
+  db::Layout *ly = layout ();
+  return ly && ly->compact_polygon_mode () ? &ly->polygon_arena () : 0;
+}
+
+void
+Shapes::compact_on_insert (const shape_type::polygon_type &sh)
+{
+  if (tl::Arena *arena = compact_polygon_arena ()) {
+    compact_polygon_storage (sh, arena);
+  }
+}
+
+void
+Shapes::compact_on_insert (const shape_type::simple_polygon_type &sh)
+{
+  if (tl::Arena *arena = compact_polygon_arena ()) {
+    compact_polygon_storage (sh, arena);
+  }
+}
+
+void
+Shapes::compact_on_insert (const db::object_with_properties<shape_type::polygon_type> &sh)
+{
+  if (tl::Arena *arena = compact_polygon_arena ()) {
+    compact_polygon_storage (sh, arena);
+  }
+}
+
+void
+Shapes::compact_on_insert (const db::object_with_properties<shape_type::simple_polygon_type> &sh)
+{
+  if (tl::Arena *arena = compact_polygon_arena ()) {
+    compact_polygon_storage (sh, arena);
+  }
+}
+
+template <class Sh, class StableTag>
+void
+layer_class<Sh, StableTag>::compact_polygons (tl::Arena *arena)
+{
+  for (typename layer_type::iterator s = m_layer.begin (); s != m_layer.end (); ++s) {
+    compact_polygon_storage (*s, arena);
+  }
+}
+
 //  explicit instantiations
 
 template class layer_class<db::Shape::polygon_type, db::stable_layer_tag>;
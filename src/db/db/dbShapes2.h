@@ -163,6 +163,7 @@ public:
   }
 
   unsigned int type_mask () const;
+  virtual void compact_polygons (tl::Arena *arena);
 
 private:
   layer_type m_layer;
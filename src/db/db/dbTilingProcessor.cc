@@ -22,14 +22,24 @@
 
 
 #include "dbTilingProcessor.h"
+#include "dbReader.h"
+#include "dbWriter.h"
+#include "dbSaveLayoutOptions.h"
 
 #include "tlExpression.h"
 #include "tlProgress.h"
 #include "tlThreadedWorkers.h"
 #include "tlThreads.h"
+#include "tlTimer.h"
+#include "tlFileUtils.h"
+#include "tlStream.h"
 #include "gsiDecl.h"
 
 #include <cmath>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <set>
 
 namespace db
 {
@@ -319,6 +329,303 @@ private:
   db::Texts *mp_texts;
 };
 
+// ----------------------------------------------------------------------------------
+//  Transfer of tile data between the tiling processor and the worker processes
+
+/**
+ *  @brief Writes a value to the worker protocol stream
+ *
+ *  Shape containers are written as one object per line, terminated by "end".
+ *  Other values are written in their parsable string representation.
+ */
+static void
+write_value (tl::OutputStream &os, const tl::Variant &v)
+{
+  if (v.is_user<db::Region> ()) {
+    os << "region\n";
+    for (db::Region::const_iterator p = v.to_user<db::Region> ().begin (); ! p.at_end (); ++p) {
+      os << p->to_string () << "\n";
+    }
+    os << "end\n";
+  } else if (v.is_user<db::Edges> ()) {
+    os << "edges\n";
+    for (db::Edges::const_iterator e = v.to_user<db::Edges> ().begin (); ! e.at_end (); ++e) {
+      os << e->to_string () << "\n";
+    }
+    os << "end\n";
+  } else if (v.is_user<db::EdgePairs> ()) {
+    os << "edge_pairs\n";
+    for (db::EdgePairs::const_iterator ep = v.to_user<db::EdgePairs> ().begin (); ! ep.at_end (); ++ep) {
+      os << ep->to_string () << "\n";
+    }
+    os << "end\n";
+  } else if (v.is_user<db::Texts> ()) {
+    os << "texts\n";
+    for (db::Texts::const_iterator t = v.to_user<db::Texts> ().begin (); ! t.at_end (); ++t) {
+      os << t->to_string () << "\n";
+    }
+    os << "end\n";
+  } else {
+    os << "value " << v.to_parsable_string () << "\n";
+  }
+}
+
+template <class Obj, class Container>
+static void
+read_objects (tl::TextInputStream &is, Container &container)
+{
+  while (true) {
+
+    if (is.at_end ()) {
+      throw tl::Exception (tl::to_string (tr ("Unexpected end of tile data")));
+    }
+
+    tl::Extractor ex (is.get_line ().c_str ());
+    if (ex.test ("end")) {
+      break;
+    }
+
+    Obj obj;
+    ex.read (obj);
+    container.insert (obj);
+
+  }
+}
+
+/**
+ *  @brief Reads a value written with "write_value"
+ *
+ *  "ex" is the extractor for the current line which is positioned at the value.
+ */
+static tl::Variant
+read_value (tl::Extractor &ex, tl::TextInputStream &is)
+{
+  if (ex.test ("value")) {
+    tl::Variant v;
+    ex.read (v);
+    return v;
+  } else if (ex.test ("region")) {
+    db::Region region;
+    read_objects<db::Polygon> (is, region);
+    return tl::Variant (region);
+  } else if (ex.test ("edges")) {
+    db::Edges edges;
+    read_objects<db::Edge> (is, edges);
+    return tl::Variant (edges);
+  } else if (ex.test ("edge_pairs")) {
+    db::EdgePairs edge_pairs;
+    read_objects<db::EdgePair> (is, edge_pairs);
+    return tl::Variant (edge_pairs);
+  } else if (ex.test ("texts")) {
+    db::Texts texts;
+    read_objects<db::Text> (is, texts);
+    return tl::Variant (texts);
+  } else {
+    ex.error (tl::to_string (tr ("Expected a value")));
+    return tl::Variant ();
+  }
+}
+
+/**
+ *  @brief The output receiver used inside a worker process
+ *
+ *  This receiver sends the objects back to the tiling processor which
+ *  has launched the worker.
+ */
+class TileWorkerOutputReceiver
+  : public db::TileOutputReceiver
+{
+public:
+  TileWorkerOutputReceiver (tl::OutputStream *os)
+    : mp_os (os)
+  {
+    //  .. nothing yet ..
+  }
+
+  void put (size_t ix, size_t iy, const db::Box &tile, size_t id, const tl::Variant &obj, double /*dbu*/, const db::ICplxTrans & /*trans*/, bool clip)
+  {
+    //  NOTE: the processor's output mutex is locked when we get here
+    *mp_os << "put " << id << " " << ix << " " << iy << " " << (clip ? 1 : 0) << " " << tile.to_string () << " ";
+    write_value (*mp_os, obj);
+  }
+
+private:
+  tl::OutputStream *mp_os;
+};
+
+// ----------------------------------------------------------------------------------
+//  TileStreamWriter implementation
+
+TileStreamWriter::TileStreamWriter (const std::string &path, double dbu, const std::string &top_cell, Mode mode, const db::SaveLayoutOptions &options)
+  : m_top_cell (top_cell), m_mode (mode), m_buffer (false)
+{
+  db::SaveLayoutOptions opt (options);
+  if (opt.format ().empty () && ! opt.set_format_from_filename (path)) {
+    throw tl::Exception (tl::to_string (tr ("Cannot determine file format from file name: %s")), path);
+  }
+
+  std::unique_ptr<db::Writer> writer (new db::Writer (opt));
+  if (! writer->supports_streaming ()) {
+    throw tl::Exception (tl::to_string (tr ("Format does not support direct output of tiles: %s")), opt.format ());
+  }
+
+  m_buffer.dbu (dbu);
+  m_buffer_cell = m_buffer.add_cell (top_cell.c_str ());
+
+  mp_stream.reset (new tl::OutputStream (path));
+  writer->begin_stream (*mp_stream, dbu);
+  mp_writer.reset (writer.release ());
+
+  if (m_mode == Merged) {
+    mp_writer->begin_stream_cell (m_top_cell);
+  }
+}
+
+TileStreamWriter::~TileStreamWriter ()
+{
+  try {
+    close ();
+  } catch (...) {
+    //  .. ignore exceptions here ..
+  }
+}
+
+size_t
+TileStreamWriter::add_layer (const db::LayerProperties &lp)
+{
+  m_layers.push_back (std::make_pair (lp, m_buffer.insert_layer (db::LayerProperties ())));
+  return m_layers.size () - 1;
+}
+
+void
+TileStreamWriter::put (size_t ix, size_t iy, const db::Box &tile, size_t id, const tl::Variant &obj, double dbu, const db::ICplxTrans &trans, bool clip)
+{
+  if (! mp_writer.get ()) {
+    throw tl::Exception (tl::to_string (tr ("Output file is already closed")));
+  }
+  if (id >= m_layers.size ()) {
+    throw tl::Exception (tl::to_string (tr ("Invalid output ID %d - no layer registered for this ID")), int (id));
+  }
+
+  //  in "CellPerTile" mode, each tile in progress has a buffer cell of its own
+  db::cell_index_type ci = m_buffer_cell;
+  if (m_mode == CellPerTile) {
+    pending_tiles_type::const_iterator t = m_pending_tiles.find (std::make_pair (ix, iy));
+    if (t != m_pending_tiles.end ()) {
+      ci = t->second;
+    } else {
+      ci = m_buffer.add_cell ();
+      m_pending_tiles.insert (std::make_pair (std::make_pair (ix, iy), ci));
+    }
+  }
+
+  db::Shapes &shapes = m_buffer.cell (ci).shapes (m_layers [id].second);
+
+  db::ICplxTrans t (db::ICplxTrans (dbu / m_buffer.dbu ()) * trans);
+  ShapesInserter inserter (&shapes, t, 1);
+  insert_var (inserter, obj, tile, clip);
+
+  if (m_mode == Merged) {
+    mp_writer->stream_shapes (m_buffer, shapes, m_layers [id].first);
+    shapes.clear ();
+  }
+}
+
+void
+TileStreamWriter::end_tile (size_t ix, size_t iy)
+{
+  if (mp_writer.get ()) {
+    pending_tiles_type::iterator t = m_pending_tiles.find (std::make_pair (ix, iy));
+    if (t != m_pending_tiles.end ()) {
+      flush_tile (t);
+    }
+  }
+}
+
+void
+TileStreamWriter::finish (bool /*success*/)
+{
+  //  writes the tiles which have not been reported complete (e.g. without tiling)
+  if (mp_writer.get ()) {
+    flush_tiles ();
+  }
+}
+
+void
+TileStreamWriter::flush_tiles ()
+{
+  while (! m_pending_tiles.empty ()) {
+    flush_tile (m_pending_tiles.begin ());
+  }
+}
+
+void
+TileStreamWriter::flush_tile (pending_tiles_type::iterator t)
+{
+  size_t ix = t->first.first, iy = t->first.second;
+  db::cell_index_type ci = t->second;
+  m_pending_tiles.erase (t);
+
+  const db::Cell &buffer_cell = m_buffer.cell (ci);
+
+  bool any = false;
+  for (std::vector<std::pair<db::LayerProperties, unsigned int> >::const_iterator l = m_layers.begin (); l != m_layers.end () && ! any; ++l) {
+    any = ! buffer_cell.shapes (l->second).empty ();
+  }
+
+  if (any) {
+
+    //  tiles delivered again (e.g. in a second run) get separate cells
+    unsigned int &n = m_tile_cell_count [std::make_pair (ix, iy)];
+    std::string name = "TILE_" + tl::to_string (ix) + "_" + tl::to_string (iy);
+    if (n > 0) {
+      name += "_" + tl::to_string (n);
+    }
+    ++n;
+
+    mp_writer->begin_stream_cell (name);
+    for (std::vector<std::pair<db::LayerProperties, unsigned int> >::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+      const db::Shapes &shapes = buffer_cell.shapes (l->second);
+      if (! shapes.empty ()) {
+        mp_writer->stream_shapes (m_buffer, shapes, l->first);
+      }
+    }
+    mp_writer->end_stream_cell ();
+
+    m_tile_cells.push_back (name);
+
+  }
+
+  m_buffer.delete_cell (ci);
+}
+
+void
+TileStreamWriter::close ()
+{
+  if (! mp_writer.get ()) {
+    return;
+  }
+
+  if (m_mode == CellPerTile) {
+
+    flush_tiles ();
+
+    mp_writer->begin_stream_cell (m_top_cell);
+    for (std::vector<std::string>::const_iterator c = m_tile_cells.begin (); c != m_tile_cells.end (); ++c) {
+      mp_writer->stream_cell_reference (*c, db::Vector ());
+    }
+    mp_writer->end_stream_cell ();
+
+  } else {
+    mp_writer->end_stream_cell ();
+  }
+
+  mp_writer->end_stream ();
+
+  mp_writer.reset (0);
+  mp_stream.reset (0);
+}
+
 class TilingProcessorJob
   : public tl::JobBase
 {
@@ -372,8 +679,8 @@ class TilingProcessorTask
   : public tl::Task
 {
 public:
-  TilingProcessorTask (const std::string &tile_desc, size_t ix, size_t iy, const db::DBox &clip_box, const db::DBox &region, const std::string &script, size_t script_index)
-    : m_tile_desc (tile_desc), m_ix (ix), m_iy (iy), m_clip_box (clip_box), m_region (region), m_script (script), m_script_index (script_index)
+  TilingProcessorTask (const std::string &tile_desc, size_t ix, size_t iy, const db::DBox &clip_box, const db::DBox &region, const std::string &script, size_t script_index, size_t estimated_count = 0)
+    : m_tile_desc (tile_desc), m_ix (ix), m_iy (iy), m_clip_box (clip_box), m_region (region), m_script (script), m_script_index (script_index), m_estimated_count (estimated_count)
   {
     //  .. nothing yet ..
   }
@@ -413,12 +720,30 @@ public:
     return m_script_index;
   }
 
+  size_t estimated_count () const
+  {
+    return m_estimated_count;
+  }
+
+  void set_input (size_t index, const tl::Variant &data)
+  {
+    m_inputs [index] = data;
+  }
+
+  const tl::Variant *input (size_t index) const
+  {
+    std::map<size_t, tl::Variant>::const_iterator i = m_inputs.find (index);
+    return i != m_inputs.end () ? &i->second : 0;
+  }
+
 private:
   std::string m_tile_desc;
   size_t m_ix, m_iy;
   db::DBox m_clip_box, m_region;
   std::string m_script;
   size_t m_script_index;
+  size_t m_estimated_count;
+  std::map<size_t, tl::Variant> m_inputs;
 };
 
 class TilingProcessorWorker
@@ -443,7 +768,9 @@ private:
   TilingProcessorJob *mp_job;
 
   void do_perform (const TilingProcessorTask *task);
-  void make_input_var (const TilingProcessor::InputSpec &is, const db::RecursiveShapeIterator *iter, tl::Eval &eval, double sf);
+
+public:
+  static tl::Variant make_input (const TilingProcessor *proc, const TilingProcessor::InputSpec &is, bool has_tiles, const db::DBox &region);
 };
 
 class TilingProcessorReceiverFunction
@@ -475,130 +802,626 @@ public:
     //  .. nothing yet ..
   }
 
-  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant & /*out*/, const std::vector<tl::Variant> &args) const 
-  {
-    mp_proc->put (m_ix, m_iy, m_tile_box, args);
+  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant & /*out*/, const std::vector<tl::Variant> &args) const 
+  {
+    mp_proc->put (m_ix, m_iy, m_tile_box, args);
+  }
+
+private:
+  TilingProcessor *mp_proc;
+  size_t m_ix, m_iy;
+  db::Box m_tile_box; 
+};
+
+class TilingProcessorCountFunction
+  : public tl::EvalFunction
+{
+public:
+  TilingProcessorCountFunction (TilingProcessor * /*proc*/)
+  {
+    //  .. nothing yet ..
+  }
+
+  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant & /*out*/, const std::vector<tl::Variant> & /*args*/) const 
+  {
+    // TODO: ... implement ..
+  }
+};
+
+/**
+ *  @brief A cheap estimate of the number of shapes an input delivers inside a box
+ *
+ *  The estimate is computed hierarchically: instances entirely inside the box
+ *  contribute the flat shape count of their cell, which is computed once per cell.
+ *  Only cells crossing the box boundary are looked into. Complex regions, depth
+ *  limits and cell selections of the input iterator are not taken into account.
+ */
+class TilingProcessorCountEstimator
+{
+public:
+  TilingProcessorCountEstimator (const db::RecursiveShapeIterator &iter)
+    : mp_layout (iter.layout ()), mp_top_cell (iter.top_cell ()), mp_shapes (iter.shapes ()), m_region (iter.region ())
+  {
+    if (iter.multiple_layers ()) {
+      m_layers = iter.layers ();
+    } else if (mp_layout) {
+      m_layers.push_back (iter.layer ());
+    }
+
+    //  makes sure the bounding boxes are valid
+    if (mp_layout) {
+      mp_layout->update ();
+    }
+  }
+
+  size_t count (const db::Box &box)
+  {
+    db::Box b = box & m_region;
+    if (b.empty ()) {
+      return 0;
+    } else if (mp_shapes) {
+      return count_shapes (*mp_shapes, b);
+    } else if (mp_layout && mp_top_cell) {
+      return count_in_cell (*mp_top_cell, b);
+    } else {
+      return 0;
+    }
+  }
+
+private:
+  const db::Layout *mp_layout;
+  const db::Cell *mp_top_cell;
+  const db::Shapes *mp_shapes;
+  db::Box m_region;
+  std::vector<unsigned int> m_layers;
+  std::vector<size_t> m_flat_counts;
+
+  static size_t count_shapes (const db::Shapes &shapes, const db::Box &box)
+  {
+    size_t n = 0;
+    for (db::ShapeIterator s = shapes.begin_touching (box, db::ShapeIterator::All); ! s.at_end (); ++s) {
+      ++n;
+    }
+    return n;
+  }
+
+  db::Box cell_bbox (const db::Cell &cell) const
+  {
+    db::Box b;
+    for (std::vector<unsigned int>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+      b += cell.bbox (*l);
+    }
+    return b;
+  }
+
+  size_t flat_count (const db::Cell &cell)
+  {
+    //  the flat counts are fetched once per layer for all cells
+    if (m_flat_counts.empty ()) {
+      m_flat_counts.resize (mp_layout->cells (), 0);
+      for (std::vector<unsigned int>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+        std::vector<size_t> fc = mp_layout->flat_shape_counts (*l);
+        for (size_t i = 0; i < fc.size () && i < m_flat_counts.size (); ++i) {
+          m_flat_counts [i] += fc [i];
+        }
+      }
+    }
+
+    return cell.cell_index () < m_flat_counts.size () ? m_flat_counts [cell.cell_index ()] : 0;
+  }
+
+  size_t count_in_cell (const db::Cell &cell, const db::Box &box)
+  {
+    db::Box bbox = cell_bbox (cell);
+    if (! bbox.touches (box)) {
+      return 0;
+    } else if (box.contains (bbox.p1 ()) && box.contains (bbox.p2 ())) {
+      return flat_count (cell);
+    }
+
+    size_t n = 0;
+    for (std::vector<unsigned int>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+      n += count_shapes (cell.shapes (*l), box);
+    }
+
+    db::box_convert<db::CellInst> bc (*mp_layout);
+
+    for (db::Cell::touching_iterator i = cell.begin_touching (box); ! i.at_end (); ++i) {
+
+      const db::CellInstArray &cia = i->cell_inst ();
+      const db::Cell &child = mp_layout->cell (cia.object ().cell_index ());
+
+      db::Box array_box = cia.bbox (bc);
+      if (box.contains (array_box.p1 ()) && box.contains (array_box.p2 ())) {
+        n += cia.size () * flat_count (child);
+      } else {
+        for (db::CellInstArray::iterator a = cia.begin_touching (box, bc); ! a.at_end (); ++a) {
+          n += count_in_cell (child, box.transformed (cia.complex_trans (*a).inverted ()));
+        }
+      }
+
+    }
+
+    return n;
+  }
+};
+
+/**
+ *  @brief Creates the input object for the given input and tile
+ *
+ *  If "has_tiles" is false, the whole input is delivered and "region" is ignored.
+ */
+tl::Variant
+TilingProcessorWorker::make_input (const TilingProcessor *proc, const TilingProcessor::InputSpec &is, bool has_tiles, const db::DBox &region)
+{
+  double dbu = proc->dbu ();
+  if (proc->scale_to_dbu () && is.iter.layout ()) {
+    dbu = is.iter.layout ()->dbu ();
+  }
+
+  double sf = dbu / proc->dbu ();
+
+  db::RecursiveShapeIterator iter;
+
+  if (! has_tiles) {
+
+    iter = is.iter;
+
+  } else {
+
+    db::Box region_dbu = db::Box (region.transformed ((db::DCplxTrans (dbu) * db::DCplxTrans (is.trans)).inverted ()));
+    region_dbu &= is.iter.region ();
+
+    if (! region_dbu.empty ()) {
+      iter = is.iter;
+      iter.confine_region (region_dbu);
+    }
+
+  }
+
+  if (is.type == TilingProcessor::TypeRegion) {
+    return tl::Variant (db::Region (iter, db::ICplxTrans (sf) * is.trans, is.merged_semantics));
+  } else if (is.type == TilingProcessor::TypeEdges) {
+    return tl::Variant (db::Edges (iter, db::ICplxTrans (sf) * is.trans, is.merged_semantics));
+  } else if (is.type == TilingProcessor::TypeEdgePairs) {
+    return tl::Variant (db::EdgePairs (iter, db::ICplxTrans (sf) * is.trans));
+  } else if (is.type == TilingProcessor::TypeTexts) {
+    return tl::Variant (db::Texts (iter, db::ICplxTrans (sf) * is.trans));
+  } else {
+    return tl::Variant ();
+  }
+}
+
+void
+TilingProcessorWorker::do_perform (const TilingProcessorTask *tile_task)
+{
+  tl::Eval eval (&mp_job->processor ()->top_eval ());
+
+  db::Box clip_box_dbu = db::Box::world ();
+
+  eval.set_var ("_dbu", tl::Variant (mp_job->processor ()->dbu ()));
+
+  if (! mp_job->has_tiles ()) { 
+    eval.set_var ("_tile", tl::Variant ());
+  } else {
+
+    clip_box_dbu = db::Box (tile_task->clip_box ().transformed (db::DCplxTrans (mp_job->processor ()->dbu ()).inverted ()));
+
+    db::Region r;
+    r.insert (clip_box_dbu);
+    eval.set_var ("_tile", tl::Variant (r));
+
+  }
+
+  {
+    db::Box frame_box_dbu = db::Box (mp_job->processor ()->frame ().transformed (db::DCplxTrans (mp_job->processor ()->dbu ()).inverted ()));
+
+    db::Region r;
+    r.insert (frame_box_dbu);
+    eval.set_var ("_frame", tl::Variant (r));
+  }
+
+  size_t index = 0;
+  for (std::vector<TilingProcessor::InputSpec>::const_iterator i = mp_job->processor ()->begin_inputs (); i != mp_job->processor ()->end_inputs (); ++i, ++index) {
+
+    //  inputs transferred with the task (worker processes only)
+    const tl::Variant *data = tile_task->input (index);
+    if (data) {
+
+      tl::Variant v = *data;
+      if (v.is_user<db::Region> ()) {
+        v.to_user<db::Region> ().set_merged_semantics (i->merged_semantics);
+      } else if (v.is_user<db::Edges> ()) {
+        v.to_user<db::Edges> ().set_merged_semantics (i->merged_semantics);
+      }
+      eval.set_var (i->name, v);
+
+    } else {
+      eval.set_var (i->name, make_input (mp_job->processor (), *i, mp_job->has_tiles (), tile_task->region ()));
+    }
+
+  }
+
+  eval.define_function ("_output", new TilingProcessorOutputFunction (mp_job->processor (), tile_task->ix (), tile_task->iy (), clip_box_dbu));
+  eval.define_function ("_rec", new TilingProcessorReceiverFunction (mp_job->processor ()));
+  eval.define_function ("_count", new TilingProcessorCountFunction (mp_job->processor ()));
+
+  if (tl::verbosity () >= (mp_job->has_tiles () ? 20 : 10)) {
+    tl::info << "TilingProcessor: script #" << (tile_task->script_index () + 1) << ", tile " << tile_task->tile_desc ();
+  }
+
+  tl::SelfTimer timer (tl::verbosity () >= (mp_job->has_tiles () ? 21 : 11), "Elapsed time");
+
+  tl::Timer tile_timer;
+  tile_timer.start ();
+
+  tl::Expression ex;
+  eval.parse (ex, tile_task->script ());
+  ex.execute ();
+
+  tile_timer.stop ();
+
+  TileStatistics ts;
+  ts.ix = tile_task->ix ();
+  ts.iy = tile_task->iy ();
+  ts.box = tile_task->clip_box ();
+  ts.script_index = tile_task->script_index ();
+  ts.estimated_count = tile_task->estimated_count ();
+  ts.seconds = tile_timer.sec_wall ();
+  mp_job->processor ()->add_tile_statistics (ts);
+
+  if (mp_job->has_tiles ()) {
+    mp_job->processor ()->task_finished (ts.ix, ts.iy);
+  }
+
+  mp_job->next_progress ();
+}
+
+tl::Worker *
+TilingProcessorJob::create_worker ()
+{
+  return new TilingProcessorWorker (this);
+}
+
+// ----------------------------------------------------------------------------------
+//  The multi-process implementation
+
+static std::string
+shell_quote (const std::string &s)
+{
+#if defined(_WIN32)
+  return "\"" + s + "\"";
+#else
+  std::string r = "'";
+  for (const char *c = s.c_str (); *c; ++c) {
+    if (*c == '\'') {
+      r += "'\\''";
+    } else {
+      r += *c;
+    }
+  }
+  r += "'";
+  return r;
+#endif
+}
+
+TileWorkerCommandLauncher::TileWorkerCommandLauncher (const std::string &command)
+  : m_command (command)
+{
+  //  .. nothing yet ..
+}
+
+tl::InputStream *
+TileWorkerCommandLauncher::launch (const std::string &job_file)
+{
+  return new tl::InputStream ("pipe:" + m_command + " " + shell_quote (job_file));
+}
+
+/**
+ *  @brief Returns true, if the given input can be transferred through a layout snapshot
+ *
+ *  Other inputs are transferred per tile.
+ */
+static bool
+is_snapshot_input (const TilingProcessor::Type type, const db::RecursiveShapeIterator &iter)
+{
+  //  NOTE: OASIS does not preserve edges and edge pairs, so these inputs are transferred per tile
+  return (type == TilingProcessor::TypeRegion || type == TilingProcessor::TypeTexts) &&
+         iter.layout () && iter.top_cell () &&
+         ! iter.has_complex_region () && iter.enables ().empty () && iter.disables ().empty ();
+}
+
+class TilingProcessorProcessTask
+  : public tl::Task
+{
+public:
+  TilingProcessorProcessTask (const std::string &job_file)
+    : m_job_file (job_file)
+  {
+    //  .. nothing yet ..
+  }
+
+  const std::string &job_file () const
+  {
+    return m_job_file;
+  }
+
+private:
+  std::string m_job_file;
+};
+
+class TilingProcessorProcessJob
+  : public TilingProcessorJob
+{
+public:
+  TilingProcessorProcessJob (TilingProcessor *proc, int nprocesses)
+    : TilingProcessorJob (proc, nprocesses, true), m_nprocesses (nprocesses)
+  {
+    if (proc->mp_launcher.get ()) {
+      mp_launcher = proc->mp_launcher.get ();
+    } else {
+      std::string cmd = proc->worker_command ();
+      if (cmd.empty ()) {
+        cmd = shell_quote (tl::combine_path (tl::get_inst_path (), "strmtile"));
+      }
+      mp_default_launcher.reset (new TileWorkerCommandLauncher (cmd));
+      mp_launcher = mp_default_launcher.get ();
+    }
+  }
+
+  ~TilingProcessorProcessJob ()
+  {
+    if (! m_dir.empty ()) {
+      tl::rm_dir_recursive (m_dir);
+    }
+  }
+
+  TileWorkerLauncher *launcher () const
+  {
+    return mp_launcher;
+  }
+
+  void prepare (const std::list<TilingProcessorTask> &tasks);
+
+  virtual tl::Worker *create_worker ();
+
+private:
+  int m_nprocesses;
+  std::string m_dir;
+  TileWorkerLauncher *mp_launcher;
+  std::unique_ptr<TileWorkerLauncher> mp_default_launcher;
+
+  void write_input (tl::OutputStream &os, const TilingProcessor::InputSpec &is, const std::map<const db::Layout *, std::string> &snapshots);
+};
+
+void
+TilingProcessorProcessJob::prepare (const std::list<TilingProcessorTask> &tasks)
+{
+  const TilingProcessor *proc = processor ();
+
+  m_dir = tl::tmpdir ("klayout-tiles");
+
+  //  Inputs from layouts are transferred through one OASIS snapshot per layout
+
+  std::map<const db::Layout *, std::set<unsigned int> > snapshot_layers;
+  for (std::vector<TilingProcessor::InputSpec>::const_iterator i = proc->begin_inputs (); i != proc->end_inputs (); ++i) {
+    if (is_snapshot_input (i->type, i->iter)) {
+      std::set<unsigned int> &layers = snapshot_layers [i->iter.layout ()];
+      if (i->iter.multiple_layers ()) {
+        layers.insert (i->iter.layers ().begin (), i->iter.layers ().end ());
+      } else {
+        layers.insert (i->iter.layer ());
+      }
+    }
+  }
+
+  std::map<const db::Layout *, std::string> snapshots;
+
+  for (std::map<const db::Layout *, std::set<unsigned int> >::const_iterator s = snapshot_layers.begin (); s != snapshot_layers.end (); ++s) {
+
+    db::SaveLayoutOptions options;
+    options.set_format ("OASIS");
+    options.set_write_context_info (false);
+    options.deselect_all_layers ();
+    for (std::set<unsigned int>::const_iterator l = s->second.begin (); l != s->second.end (); ++l) {
+      options.add_layer (*l, db::LayerProperties (int (*l), 0));
+    }
+
+    std::string path = tl::combine_path (m_dir, "snapshot" + tl::to_string (snapshots.size ()) + ".oas");
+    snapshots.insert (std::make_pair (s->first, path));
+
+    tl::OutputStream os (path);
+    db::Writer writer (options);
+    writer.write (const_cast<db::Layout &> (*s->first), os);
+
+  }
+
+  //  Write one job file per process. The tasks are distributed round-robin which
+  //  gives a reasonable balance if the tasks are sorted by size (adaptive mode).
+
+  size_t n = size_t (m_nprocesses);
+
+  for (size_t p = 0; p < n; ++p) {
+
+    std::string path = tl::combine_path (m_dir, "job" + tl::to_string (p) + ".txt");
+
+    {
+      tl::OutputStream os (path);
+
+      os << "klayout-tiling-job 1\n";
+      os << "dbu " << proc->dbu () << "\n";
+      os << "scale-to-dbu " << (proc->scale_to_dbu () ? 1 : 0) << "\n";
+      os << "threads " << proc->threads () << "\n";
+      os << "frame " << proc->frame ().to_string () << "\n";
+
+      for (std::vector<TilingProcessor::InputSpec>::const_iterator i = proc->begin_inputs (); i != proc->end_inputs (); ++i) {
+        write_input (os, *i, snapshots);
+      }
+
+      for (std::vector<std::pair<std::string, tl::Variant> >::const_iterator v = proc->m_vars.begin (); v != proc->m_vars.end (); ++v) {
+        os << "var " << tl::to_quoted_string (v->first) << " ";
+        write_value (os, v->second);
+      }
+
+      for (std::vector<TilingProcessor::OutputSpec>::const_iterator o = proc->m_outputs.begin (); o != proc->m_outputs.end (); ++o) {
+        os << "output " << tl::to_quoted_string (o->name) << "\n";
+      }
+
+      for (std::vector<std::string>::const_iterator s = proc->m_scripts.begin (); s != proc->m_scripts.end (); ++s) {
+        os << "script " << tl::to_quoted_string (*s) << "\n";
+      }
+
+      size_t index = 0;
+      for (std::list<TilingProcessorTask>::const_iterator t = tasks.begin (); t != tasks.end (); ++t, ++index) {
+
+        if (index % n != p) {
+          continue;
+        }
+
+        os << "task " << tl::to_quoted_string (t->tile_desc ()) << " " << t->ix () << " " << t->iy () << " "
+           << t->clip_box ().to_string () << " " << t->region ().to_string () << " "
+           << t->script_index () << " " << t->estimated_count () << "\n";
+
+        size_t ii = 0;
+        for (std::vector<TilingProcessor::InputSpec>::const_iterator i = proc->begin_inputs (); i != proc->end_inputs (); ++i, ++ii) {
+          if (! is_snapshot_input (i->type, i->iter)) {
+            os << "data " << ii << " ";
+            write_value (os, TilingProcessorWorker::make_input (proc, *i, true, t->region ()));
+          }
+        }
+
+      }
+
+      os << "end\n";
+    }
+
+    schedule (new TilingProcessorProcessTask (path));
+
+  }
+}
+
+void
+TilingProcessorProcessJob::write_input (tl::OutputStream &os, const TilingProcessor::InputSpec &is, const std::map<const db::Layout *, std::string> &snapshots)
+{
+  os << "input " << tl::to_quoted_string (is.name) << " " << int (is.type) << " " << (is.merged_semantics ? 1 : 0) << " ";
+
+  if (! is_snapshot_input (is.type, is.iter)) {
+    os << "embedded\n";
+    return;
+  }
+
+  std::map<const db::Layout *, std::string>::const_iterator s = snapshots.find (is.iter.layout ());
+  tl_assert (s != snapshots.end ());
+
+  os << "snapshot " << tl::to_quoted_string (s->second) << " " << tl::to_quoted_string (is.iter.layout ()->cell_name (is.iter.top_cell ()->cell_index ())) << " ";
+
+  if (is.iter.multiple_layers ()) {
+    os << is.iter.layers ().size ();
+    for (std::vector<unsigned int>::const_iterator l = is.iter.layers ().begin (); l != is.iter.layers ().end (); ++l) {
+      os << " " << *l;
+    }
+  } else {
+    os << "1 " << is.iter.layer ();
   }
 
-private:
-  TilingProcessor *mp_proc;
-  size_t m_ix, m_iy;
-  db::Box m_tile_box; 
-};
+  //  NOTE: the world box cannot be read back as a box
+  os << " " << (is.iter.region () == db::Box::world () ? std::string ("world") : is.iter.region ().to_string ()) << " " << (is.iter.overlapping () ? 1 : 0)
+     << " " << is.iter.min_depth () << " " << is.iter.max_depth () << " " << is.iter.shape_flags ()
+     << " " << db::DCplxTrans (is.trans).to_string () << "\n";
+}
 
-class TilingProcessorCountFunction
-  : public tl::EvalFunction
+class TilingProcessorProcessWorker
+  : public tl::Worker
 {
 public:
-  TilingProcessorCountFunction (TilingProcessor * /*proc*/)
+  TilingProcessorProcessWorker (TilingProcessorProcessJob *job)
+    : tl::Worker (), mp_job (job)
   {
     //  .. nothing yet ..
   }
 
-  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant & /*out*/, const std::vector<tl::Variant> & /*args*/) const 
+  void perform_task (tl::Task *task)
   {
-    // TODO: ... implement ..
+    TilingProcessorProcessTask *process_task = dynamic_cast <TilingProcessorProcessTask *> (task);
+    if (process_task) {
+      do_perform (process_task->job_file ());
+    }
   }
-};
 
-void
-TilingProcessorWorker::make_input_var (const TilingProcessor::InputSpec &is, const db::RecursiveShapeIterator *iter, tl::Eval &eval, double sf)
-{
-  if (! iter) {
-    iter = &is.iter;
-  }
+private:
+  TilingProcessorProcessJob *mp_job;
 
-  if (is.type == TilingProcessor::TypeRegion) {
-    eval.set_var (is.name, tl::Variant (db::Region (*iter, db::ICplxTrans (sf) * is.trans, is.merged_semantics)));
-  } else if (is.type == TilingProcessor::TypeEdges) {
-    eval.set_var (is.name, tl::Variant (db::Edges (*iter, db::ICplxTrans (sf) * is.trans, is.merged_semantics)));
-  } else if (is.type == TilingProcessor::TypeEdgePairs) {
-    eval.set_var (is.name, tl::Variant (db::EdgePairs (*iter, db::ICplxTrans (sf) * is.trans)));
-  } else if (is.type == TilingProcessor::TypeTexts) {
-    eval.set_var (is.name, tl::Variant (db::Texts (*iter, db::ICplxTrans (sf) * is.trans)));
-  }
-}
+  void do_perform (const std::string &job_file);
+};
 
 void
-TilingProcessorWorker::do_perform (const TilingProcessorTask *tile_task)
+TilingProcessorProcessWorker::do_perform (const std::string &job_file)
 {
-  tl::Eval eval (&mp_job->processor ()->top_eval ());
-
-  db::Box clip_box_dbu = db::Box::world ();
-
-  eval.set_var ("_dbu", tl::Variant (mp_job->processor ()->dbu ()));
-
-  if (! mp_job->has_tiles ()) { 
-    eval.set_var ("_tile", tl::Variant ());
-  } else {
-
-    clip_box_dbu = db::Box (tile_task->clip_box ().transformed (db::DCplxTrans (mp_job->processor ()->dbu ()).inverted ()));
-
-    db::Region r;
-    r.insert (clip_box_dbu);
-    eval.set_var ("_tile", tl::Variant (r));
+  TilingProcessor *proc = mp_job->processor ();
 
+  if (tl::verbosity () >= 20) {
+    tl::info << "TilingProcessor: starting worker for " << job_file;
   }
 
-  {
-    db::Box frame_box_dbu = db::Box (mp_job->processor ()->frame ().transformed (db::DCplxTrans (mp_job->processor ()->dbu ()).inverted ()));
+  std::unique_ptr<tl::InputStream> is (mp_job->launcher ()->launch (job_file));
+  tl::TextInputStream text (*is);
 
-    db::Region r;
-    r.insert (frame_box_dbu);
-    eval.set_var ("_frame", tl::Variant (r));
-  }
+  bool finished = false;
 
-  for (std::vector<TilingProcessor::InputSpec>::const_iterator i = mp_job->processor ()->begin_inputs (); i != mp_job->processor ()->end_inputs (); ++i) {
+  while (! finished && ! text.at_end ()) {
 
-    double dbu = mp_job->processor ()->dbu ();
-    if (mp_job->processor ()->scale_to_dbu () && i->iter.layout ()) {
-      dbu = i->iter.layout ()->dbu ();
-    }
+    std::string line = text.get_line ();
+    tl::Extractor ex (line.c_str ());
 
-    double sf = dbu / mp_job->processor ()->dbu ();
+    if (ex.test ("put")) {
 
-    if (! mp_job->has_tiles ()) { 
+      size_t index = 0, ix = 0, iy = 0;
+      int clip = 0;
+      db::Box tile;
+      ex.read (index);
+      ex.read (ix);
+      ex.read (iy);
+      ex.read (clip);
+      ex.read (tile);
 
-      make_input_var (*i, 0, eval, sf);
+      tl::Variant obj = read_value (ex, text);
+      proc->put_result (index, ix, iy, tile, obj, clip != 0);
 
-    } else {
+    } else if (ex.test ("stat")) {
 
-      db::Box region_dbu = db::Box (tile_task->region ().transformed ((db::DCplxTrans (dbu) * db::DCplxTrans (i->trans)).inverted ()));
-      region_dbu &= i->iter.region ();
+      TileStatistics ts;
+      ex.read (ts.ix);
+      ex.read (ts.iy);
+      ex.read (ts.box);
+      ex.read (ts.script_index);
+      ex.read (ts.estimated_count);
+      ex.read (ts.seconds);
+      proc->add_tile_statistics (ts);
+      proc->task_finished (ts.ix, ts.iy);
 
-      db::RecursiveShapeIterator iter;
-      if (! region_dbu.empty ()) {
-        iter = i->iter;
-        iter.confine_region (region_dbu);
-      }
+      mp_job->next_progress ();
 
-      make_input_var (*i, &iter, eval, sf);
+    } else if (ex.test ("error")) {
 
+      std::string msg;
+      ex.read_word_or_quoted (msg);
+      throw tl::Exception (msg);
+
+    } else if (ex.test ("end")) {
+      finished = true;
     }
 
   }
 
-  eval.define_function ("_output", new TilingProcessorOutputFunction (mp_job->processor (), tile_task->ix (), tile_task->iy (), clip_box_dbu));
-  eval.define_function ("_rec", new TilingProcessorReceiverFunction (mp_job->processor ()));
-  eval.define_function ("_count", new TilingProcessorCountFunction (mp_job->processor ()));
-
-  if (tl::verbosity () >= (mp_job->has_tiles () ? 20 : 10)) {
-    tl::info << "TilingProcessor: script #" << (tile_task->script_index () + 1) << ", tile " << tile_task->tile_desc ();
+  if (! finished) {
+    throw tl::Exception (tl::to_string (tr ("Tiling worker process terminated unexpectedly (job file %s)")), job_file);
   }
-
-  tl::SelfTimer timer (tl::verbosity () >= (mp_job->has_tiles () ? 21 : 11), "Elapsed time");
-
-  tl::Expression ex;
-  eval.parse (ex, tile_task->script ());
-  ex.execute ();
-
-  mp_job->next_progress ();
 }
 
 tl::Worker *
-TilingProcessorJob::create_worker ()
+TilingProcessorProcessJob::create_worker ()
 {
-  return new TilingProcessorWorker (this);
+  return new TilingProcessorProcessWorker (this);
 }
 
 // ----------------------------------------------------------------------------------
@@ -611,7 +1434,9 @@ TilingProcessor::TilingProcessor ()
     m_tile_origin_x (0.0), m_tile_origin_y (0.0),
     m_tile_origin_given (false),
     m_tile_bx (0.0), m_tile_by (0.0),
-    m_threads (0), m_dbu (0.001), m_dbu_specific (0.001), m_dbu_specific_set (false),
+    m_threads (0), m_adaptive (false), m_adaptive_threshold (10000),
+    m_processes (0), mp_worker_stream (0),
+    m_dbu (0.001), m_dbu_specific (0.001), m_dbu_specific_set (false),
     m_scale_to_dbu (true)
 {
   //  .. nothing yet ..
@@ -689,6 +1514,7 @@ void
 TilingProcessor::var (const std::string &name, const tl::Variant &value)
 {
   m_top_eval.set_var (name, value);
+  m_vars.push_back (std::make_pair (name, value));
 }
 
 
@@ -778,6 +1604,14 @@ TilingProcessor::output (const std::string &name, db::Edges &edges)
   m_outputs.back ().receiver = new TileEdgesOutputReceiver (&edges);
 }
 
+void
+TilingProcessor::output (const std::string &name, db::TileStreamWriter &writer, const db::LayerProperties &lp)
+{
+  //  the processor does not take ownership over the writer
+  writer.keep_object ();
+  output (name, writer.add_layer (lp), &writer, db::ICplxTrans ());
+}
+
 tl::Variant
 TilingProcessor::receiver (const std::vector<tl::Variant> &args)
 {
@@ -819,9 +1653,127 @@ TilingProcessor::put (size_t ix, size_t iy, const db::Box &tile, const std::vect
   m_outputs[index].receiver->put (ix, iy, tile, m_outputs[index].id, args[1], dbu (), m_outputs[index].trans, clip);
 }
 
+void
+TilingProcessor::put_result (size_t index, size_t ix, size_t iy, const db::Box &tile, const tl::Variant &obj, bool clip)
+{
+  tl::MutexLocker locker (&m_output_mutex);
+
+  if (index >= m_outputs.size ()) {
+    throw tl::Exception (tl::to_string (tr ("Invalid output channel index received from tiling worker process")));
+  }
+
+  m_outputs[index].receiver->put (ix, iy, tile, m_outputs[index].id, obj, dbu (), m_outputs[index].trans, clip);
+}
+
+void
+TilingProcessor::task_finished (size_t ix, size_t iy)
+{
+  tl::MutexLocker locker (&m_output_mutex);
+
+  std::map<std::pair<size_t, size_t>, size_t>::iterator t = m_tasks_pending.find (std::make_pair (ix, iy));
+  if (t == m_tasks_pending.end () || --t->second > 0) {
+    return;
+  }
+
+  m_tasks_pending.erase (t);
+
+  //  all scripts are done with this tile (receivers serving multiple outputs are told once)
+  std::set<db::TileOutputReceiver *> seen;
+  for (std::vector<OutputSpec>::iterator o = m_outputs.begin (); o != m_outputs.end (); ++o) {
+    if (o->receiver && seen.insert (o->receiver.get ()).second) {
+      o->receiver->end_tile (ix, iy);
+    }
+  }
+}
+
+void
+TilingProcessor::add_tile_statistics (const TileStatistics &ts)
+{
+  if (mp_worker_stream) {
+    //  inside a worker process the statistics are sent back - this also indicates progress
+    tl::MutexLocker locker (&m_output_mutex);
+    *mp_worker_stream << "stat " << ts.ix << " " << ts.iy << " " << ts.box.to_string () << " " << ts.script_index << " " << ts.estimated_count << " " << ts.seconds << "\n";
+    mp_worker_stream->flush ();
+  }
+
+  tl::MutexLocker locker (&m_statistics_mutex);
+  m_tile_statistics.push_back (ts);
+}
+
+size_t
+TilingProcessor::estimate_count (std::vector<TilingProcessorCountEstimator> &estimators, const db::DBox &region) const
+{
+  size_t n = 0;
+
+  std::vector<TilingProcessorCountEstimator>::iterator e = estimators.begin ();
+  for (std::vector<InputSpec>::const_iterator i = m_inputs.begin (); i != m_inputs.end (); ++i, ++e) {
+
+    double dbu_value = dbu ();
+    if (scale_to_dbu () && i->iter.layout ()) {
+      dbu_value = i->iter.layout ()->dbu ();
+    }
+
+    n += e->count (db::Box (region.transformed ((db::DCplxTrans (dbu_value) * db::DCplxTrans (i->trans)).inverted ())));
+
+  }
+
+  return n;
+}
+
+namespace
+{
+
+/**
+ *  @brief Describes a tile of the adaptive tiling in units of the finest grid
+ */
+struct AdaptiveTile
+{
+  AdaptiveTile (size_t _ix, size_t _iy, size_t _n, size_t _count)
+    : ix (_ix), iy (_iy), n (_n), count (_count)
+  { }
+
+  size_t ix, iy, n;
+  size_t count;
+};
+
+/**
+ *  @brief Sorts the tiles by descending count, then by position
+ */
+struct AdaptiveTileCompare
+{
+  bool operator() (const AdaptiveTile &a, const AdaptiveTile &b) const
+  {
+    if (a.count != b.count) {
+      return a.count > b.count;
+    }
+    if (a.iy != b.iy) {
+      return a.iy < b.iy;
+    }
+    return a.ix < b.ix;
+  }
+};
+
+struct TileStatisticsCompare
+{
+  bool operator() (const TileStatistics &a, const TileStatistics &b) const
+  {
+    if (a.ix != b.ix) {
+      return a.ix < b.ix;
+    }
+    if (a.iy != b.iy) {
+      return a.iy < b.iy;
+    }
+    return a.script_index < b.script_index;
+  }
+};
+
+}
+
 void  
 TilingProcessor::execute (const std::string &desc)
 {
+  m_tile_statistics.clear ();
+
   db::DBox tot_box = m_frame;
 
   if (tot_box.empty ()) {
@@ -883,9 +1835,10 @@ TilingProcessor::execute (const std::string &desc)
   //  is just a single tile.
   bool has_tiles = (ntiles_w > 1 || ntiles_h > 1 || ! m_frame.empty ());
 
-  TilingProcessorJob job (this, int (m_threads), has_tiles);
+  std::list<TilingProcessorTask> tasks;
 
   double l = 0.0, b = 0.0;
+  size_t ntasks = 0;
 
   if (has_tiles) {
 
@@ -900,23 +1853,128 @@ TilingProcessor::execute (const std::string &desc)
       b = dbu () * floor (0.5 + (tot_box.center ().y () - ntiles_h * 0.5 * tile_height) / dbu () + 1e-10);
     }
 
-    //  create the TilingProcessor tasks
-    for (size_t ix = 0; ix < ntiles_w; ++ix) {
+    if (m_adaptive) {
+
+      //  adaptive tiling: subdivide the regular tiles in up to max_levels steps
+      //  where the estimated shape count is high. Tile coordinates are kept in units
+      //  of the finest grid.
+      const unsigned int max_levels = 4;
+      size_t nsub = size_t (1) << max_levels;
+      double sub_width = tile_width / nsub, sub_height = tile_height / nsub;
+
+      std::vector<double> xc, yc;
+      for (size_t i = 0; i <= ntiles_w * nsub; ++i) {
+        xc.push_back (dbu () * floor (0.5 + (l + i * sub_width) / dbu () + 1e-10));
+      }
+      for (size_t i = 0; i <= ntiles_h * nsub; ++i) {
+        yc.push_back (dbu () * floor (0.5 + (b + i * sub_height) / dbu () + 1e-10));
+      }
+
+      std::vector<TilingProcessorCountEstimator> estimators;
+      for (std::vector<InputSpec>::const_iterator i = m_inputs.begin (); i != m_inputs.end (); ++i) {
+        estimators.push_back (TilingProcessorCountEstimator (i->iter));
+      }
+
+      std::vector<AdaptiveTile> todo;
+      size_t total = 0;
+
+      for (size_t ix = 0; ix < ntiles_w; ++ix) {
+        for (size_t iy = 0; iy < ntiles_h; ++iy) {
+          db::DBox clip_box (xc [ix * nsub], yc [iy * nsub], xc [(ix + 1) * nsub], yc [(iy + 1) * nsub]);
+          size_t count = estimate_count (estimators, clip_box.enlarged (db::DVector (m_tile_bx, m_tile_by)));
+          todo.push_back (AdaptiveTile (ix * nsub, iy * nsub, nsub, count));
+          total += count;
+        }
+      }
+
+      //  tiles are subdivided if they have more than twice the average count
+      size_t limit = std::max (m_adaptive_threshold, 2 * total / (ntiles_w * ntiles_h));
+
+      std::vector<AdaptiveTile> tiles;
+
+      while (! todo.empty ()) {
+
+        AdaptiveTile t = todo.back ();
+        todo.pop_back ();
+
+        size_t h = t.n / 2;
+
+        //  subdividing makes no sense if the tile borders dominate
+        if (t.n > 1 && t.count > limit && h * sub_width >= 2.0 * m_tile_bx && h * sub_height >= 2.0 * m_tile_by) {
+
+          for (size_t i = 0; i < 4; ++i) {
+            size_t ix = t.ix + ((i & 1) ? h : 0);
+            size_t iy = t.iy + ((i & 2) ? h : 0);
+            db::DBox clip_box (xc [ix], yc [iy], xc [ix + h], yc [iy + h]);
+            todo.push_back (AdaptiveTile (ix, iy, h, estimate_count (estimators, clip_box.enlarged (db::DVector (m_tile_bx, m_tile_by)))));
+          }
 
-      for (size_t iy = 0; iy < ntiles_h; ++iy) {
+        } else {
+          tiles.push_back (t);
+        }
+
+      }
+
+      //  execute the largest tiles first
+      std::sort (tiles.begin (), tiles.end (), AdaptiveTileCompare ());
+
+      //  The receivers see the coarsest grid that still has one cell per tile. Without
+      //  any subdivision, this is the regular grid and the tile indexes are the same as
+      //  in non-adaptive mode.
+      size_t ngrid = nsub;
+      for (std::vector<AdaptiveTile>::const_iterator t = tiles.begin (); t != tiles.end (); ++t) {
+        ngrid = std::min (ngrid, t->n);
+      }
+
+      ntiles_w *= nsub / ngrid;
+      ntiles_h *= nsub / ngrid;
+      tile_width = sub_width * ngrid;
+      tile_height = sub_height * ngrid;
 
-        db::DBox clip_box (l + ix * tile_width, b + iy * tile_height, l + (ix + 1) * tile_width, b + (iy + 1) * tile_height);
+      if (tl::verbosity () >= 20) {
+        tl::info << "TilingProcessor: adaptive tiling uses " << tiles.size () << " tiles";
+      }
+
+      for (std::vector<AdaptiveTile>::const_iterator t = tiles.begin (); t != tiles.end (); ++t) {
+
+        db::DBox clip_box (xc [t->ix], yc [t->iy], xc [t->ix + t->n], yc [t->iy + t->n]);
         db::DBox region = clip_box.enlarged (db::DVector (m_tile_bx, m_tile_by));
 
+        size_t ix = t->ix / ngrid, iy = t->iy / ngrid;
         std::string tile_desc = tl::sprintf ("%d/%d,%d/%d", ix + 1, ntiles_w, iy + 1, ntiles_h);
 
         size_t si = 0;
         for (std::vector <std::string>::const_iterator s = m_scripts.begin (); s != m_scripts.end (); ++s, ++si) {
-          job.schedule (new TilingProcessorTask (tile_desc, ix, iy, clip_box, region, *s, si));
+          tasks.push_back (TilingProcessorTask (tile_desc, ix, iy, clip_box, region, *s, si, t->count));
+        }
+
+      }
+
+      ntasks = tiles.size () * m_scripts.size ();
+
+    } else {
+
+      //  create the TilingProcessor tasks
+      for (size_t ix = 0; ix < ntiles_w; ++ix) {
+
+        for (size_t iy = 0; iy < ntiles_h; ++iy) {
+
+          db::DBox clip_box (l + ix * tile_width, b + iy * tile_height, l + (ix + 1) * tile_width, b + (iy + 1) * tile_height);
+          db::DBox region = clip_box.enlarged (db::DVector (m_tile_bx, m_tile_by));
+
+          std::string tile_desc = tl::sprintf ("%d/%d,%d/%d", ix + 1, ntiles_w, iy + 1, ntiles_h);
+
+          size_t si = 0;
+          for (std::vector <std::string>::const_iterator s = m_scripts.begin (); s != m_scripts.end (); ++s, ++si) {
+            tasks.push_back (TilingProcessorTask (tile_desc, ix, iy, clip_box, region, *s, si));
+          }
+
         }
 
       }
 
+      ntasks = ntiles_w * ntiles_h * m_scripts.size ();
+
     }
 
   } else {
@@ -925,15 +1983,43 @@ TilingProcessor::execute (const std::string &desc)
 
     size_t si = 0;
     for (std::vector <std::string>::const_iterator s = m_scripts.begin (); s != m_scripts.end (); ++s, ++si) {
-      job.schedule (new TilingProcessorTask ("all", 0, 0, db::DBox (), db::DBox (), *s, si));
+      tasks.push_back (TilingProcessorTask ("all", 0, 0, db::DBox (), db::DBox (), *s, si));
+    }
+
+  }
+
+  //  counts the tasks per tile, so the receivers can be told when a tile is complete
+  m_tasks_pending.clear ();
+  if (has_tiles) {
+    for (std::list<TilingProcessorTask>::const_iterator t = tasks.begin (); t != tasks.end (); ++t) {
+      ++m_tasks_pending [std::make_pair (t->ix (), t->iy ())];
+    }
+  }
+
+  std::unique_ptr<TilingProcessorJob> job_holder;
+
+  if (m_processes > 0 && has_tiles && ! tasks.empty ()) {
+
+    tl::SelfTimer timer (tl::verbosity () >= 21, "Preparing worker jobs");
+
+    TilingProcessorProcessJob *process_job = new TilingProcessorProcessJob (this, int (std::min (m_processes, tasks.size ())));
+    job_holder.reset (process_job);
+    process_job->prepare (tasks);
+
+  } else {
+
+    job_holder.reset (new TilingProcessorJob (this, int (m_threads), has_tiles));
+    for (std::list<TilingProcessorTask>::const_iterator t = tasks.begin (); t != tasks.end (); ++t) {
+      job_holder->schedule (new TilingProcessorTask (*t));
     }
 
   }
 
+  TilingProcessorJob &job = *job_holder;
+
   //  TODO: there should be a general scheme of how thread-specific progress is merged
   //  into a global one ..
-  size_t todo_count = ntiles_w * ntiles_h * m_scripts.size ();
-  tl::RelativeProgress progress (desc, todo_count, 1);
+  tl::RelativeProgress progress (desc, ntasks, 1);
 
   try {
 
@@ -978,10 +2064,234 @@ TilingProcessor::execute (const std::string &desc)
     throw ex;
   }
 
+  std::sort (m_tile_statistics.begin (), m_tile_statistics.end (), TileStatisticsCompare ());
+
   if (job.has_error ()) {
     throw tl::Exception (tl::to_string (tr ("Errors occurred during processing. First error message says:\n")) + job.error_messages ().front ());
   }
 }
 
+static unsigned int
+snapshot_layer (db::Layout &layout, int lnum)
+{
+  db::LayerProperties lp (lnum, 0);
+  for (db::Layout::layer_iterator l = layout.begin_layers (); l != layout.end_layers (); ++l) {
+    if ((*l).second->log_equal (lp)) {
+      return (*l).first;
+    }
+  }
+
+  //  empty layers may not be present in the snapshot
+  return layout.insert_layer (lp);
+}
+
+void
+TilingProcessor::run_worker (tl::InputStream &job_stream, tl::OutputStream &out)
+{
+  try {
+
+    TilingProcessor proc;
+    proc.mp_worker_stream = &out;
+
+    std::map<std::string, db::Layout *> snapshots;
+    std::list<db::Layout> layouts;
+
+    std::unique_ptr<TilingProcessorJob> job;
+    TilingProcessorTask *last_task = 0;
+
+    tl::TextInputStream text (job_stream);
+
+    {
+      tl::Extractor ex (text.get_line ().c_str ());
+      if (! ex.test ("klayout-tiling-job") || ! ex.test ("1")) {
+        throw tl::Exception (tl::to_string (tr ("Not a tiling processor job file")));
+      }
+    }
+
+    while (! text.at_end ()) {
+
+      std::string line = text.get_line ();
+      tl::Extractor ex (line.c_str ());
+
+      if (ex.test ("dbu")) {
+
+        double dbu = 0.001;
+        ex.read (dbu);
+        proc.set_dbu (dbu);
+
+      } else if (ex.test ("scale-to-dbu")) {
+
+        int f = 0;
+        ex.read (f);
+        proc.set_scale_to_dbu (f != 0);
+
+      } else if (ex.test ("threads")) {
+
+        size_t n = 0;
+        ex.read (n);
+        proc.set_threads (n);
+
+      } else if (ex.test ("frame")) {
+
+        db::DBox frame;
+        ex.read (frame);
+        proc.set_frame (frame);
+
+      } else if (ex.test ("input")) {
+
+        std::string name;
+        int type = 0, merged = 0;
+        ex.read_word_or_quoted (name);
+        ex.read (type);
+        ex.read (merged);
+
+        if (ex.test ("snapshot")) {
+
+          std::string path, top_cell;
+          ex.read_word_or_quoted (path);
+          ex.read_word_or_quoted (top_cell);
+
+          db::Layout *layout = 0;
+          std::map<std::string, db::Layout *>::const_iterator s = snapshots.find (path);
+          if (s != snapshots.end ()) {
+            layout = s->second;
+          } else {
+            layouts.push_back (db::Layout ());
+            layout = &layouts.back ();
+            tl::InputStream snapshot_stream (path);
+            db::Reader reader (snapshot_stream);
+            reader.read (*layout);
+            snapshots.insert (std::make_pair (path, layout));
+          }
+
+          size_t nlayers = 0;
+          ex.read (nlayers);
+          std::vector<unsigned int> layers;
+          for (size_t i = 0; i < nlayers; ++i) {
+            int lnum = 0;
+            ex.read (lnum);
+            layers.push_back (snapshot_layer (*layout, lnum));
+          }
+
+          db::Box region;
+          int overlapping = 0, min_depth = 0, max_depth = 0;
+          unsigned int shape_flags = 0;
+          db::DCplxTrans trans;
+          if (ex.test ("world")) {
+            region = db::Box::world ();
+          } else {
+            ex.read (region);
+          }
+          ex.read (overlapping);
+          ex.read (min_depth);
+          ex.read (max_depth);
+          ex.read (shape_flags);
+          ex.read (trans);
+
+          std::pair<bool, db::cell_index_type> ci = layout->cell_by_name (top_cell.c_str ());
+          if (! ci.first) {
+            throw tl::Exception (tl::to_string (tr ("Top cell %s not found in layout snapshot %s")), top_cell, path);
+          }
+
+          db::RecursiveShapeIterator iter;
+          if (layers.size () == 1) {
+            iter = db::RecursiveShapeIterator (*layout, layout->cell (ci.second), layers.front (), region, overlapping != 0);
+          } else {
+            iter = db::RecursiveShapeIterator (*layout, layout->cell (ci.second), layers, region, overlapping != 0);
+          }
+          iter.min_depth (min_depth);
+          iter.max_depth (max_depth);
+          iter.shape_flags (shape_flags);
+
+          proc.input (name, iter, db::ICplxTrans (trans), Type (type), merged != 0);
+
+        } else {
+
+          //  the data is delivered per task
+          ex.expect ("embedded");
+          proc.input (name, db::RecursiveShapeIterator (), db::ICplxTrans (), Type (type), merged != 0);
+
+        }
+
+      } else if (ex.test ("var")) {
+
+        std::string name;
+        ex.read_word_or_quoted (name);
+        proc.var (name, read_value (ex, text));
+
+      } else if (ex.test ("output")) {
+
+        std::string name;
+        ex.read_word_or_quoted (name);
+        proc.output (name, proc.m_outputs.size (), new TileWorkerOutputReceiver (&out), db::ICplxTrans ());
+
+      } else if (ex.test ("script")) {
+
+        std::string script;
+        ex.read_word_or_quoted (script);
+        proc.queue (script);
+
+      } else if (ex.test ("task")) {
+
+        std::string desc;
+        size_t ix = 0, iy = 0, script_index = 0, estimated_count = 0;
+        db::DBox clip_box, region;
+        ex.read_word_or_quoted (desc);
+        ex.read (ix);
+        ex.read (iy);
+        ex.read (clip_box);
+        ex.read (region);
+        ex.read (script_index);
+        ex.read (estimated_count);
+
+        if (script_index >= proc.m_scripts.size ()) {
+          throw tl::Exception (tl::to_string (tr ("Invalid script index in tiling job file")));
+        }
+
+        if (! job.get ()) {
+          job.reset (new TilingProcessorJob (&proc, int (proc.threads ()), true));
+        }
+
+        last_task = new TilingProcessorTask (desc, ix, iy, clip_box, region, proc.m_scripts [script_index], script_index, estimated_count);
+        job->schedule (last_task);
+
+      } else if (ex.test ("data")) {
+
+        size_t index = 0;
+        ex.read (index);
+        if (! last_task) {
+          throw tl::Exception (tl::to_string (tr ("Input data without a task in tiling job file")));
+        }
+        last_task->set_input (index, read_value (ex, text));
+
+      } else if (ex.test ("end")) {
+        break;
+      }
+
+    }
+
+    if (job.get ()) {
+
+      job->start ();
+      while (job->is_running ()) {
+        job->wait (100);
+      }
+
+      if (job->has_error ()) {
+        throw tl::Exception (job->error_messages ().front ());
+      }
+
+    }
+
+    out << "end\n";
+    out.flush ();
+
+  } catch (tl::Exception &ex) {
+    out << "error " << tl::to_quoted_string (ex.msg ()) << "\n";
+    out.flush ();
+    throw;
+  }
+}
+
 }
 
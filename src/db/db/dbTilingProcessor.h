@@ -31,17 +31,23 @@
 #include "dbLayoutUtils.h"
 #include "dbPolygonTools.h"
 #include "dbClip.h"
+#include "dbWriter.h"
 
 #include "gsiObject.h"
 
 #include "tlExpression.h"
 #include "tlTypeTraits.h"
 #include "tlThreads.h"
+#include "tlStream.h"
+
+#include <memory>
 
 namespace db
 {
 
 class TilingProcessor;
+class TilingProcessorCountEstimator;
+class TilingProcessorTask;
 
 /**
  *  @brief A receiver for the output data 
@@ -105,6 +111,16 @@ public:
    */
   virtual void put (size_t /*ix*/, size_t /*iy*/, const db::Box &/*tile*/, size_t /*id*/, const tl::Variant & /*obj*/, double /*dbu*/, const db::ICplxTrans & /*trans*/, bool /*clip*/) { }
 
+  /**
+   *  @brief Indicates that a tile is complete
+   *
+   *  This method is called when all scripts have been executed on the given tile.
+   *  No more objects are delivered for this tile after this call. Like "put", this
+   *  method is protected by a mutex.
+   *  This method is not called if tiles are not used.
+   */
+  virtual void end_tile (size_t /*ix*/, size_t /*iy*/) { }
+
   /**
    *  @brief Indicate the end of the execution
    *  @param sucess Will be true if all tiles executed successfully
@@ -410,6 +426,186 @@ bool insert_var (X &inserter, const tl::Variant &obj, const db::Box &tile, bool
   }
 }
 
+/**
+ *  @brief Execution statistics for one tile and script
+ *
+ *  These records are collected by the tiling processor during "execute".
+ */
+struct DB_PUBLIC TileStatistics
+{
+  TileStatistics ()
+    : ix (0), iy (0), script_index (0), estimated_count (0), seconds (0.0)
+  { }
+
+  /**
+   *  @brief The tile index (see TileOutputReceiver::put)
+   */
+  size_t ix, iy;
+
+  /**
+   *  @brief The tile box in micron units
+   */
+  db::DBox box;
+
+  /**
+   *  @brief The index of the script executed
+   */
+  size_t script_index;
+
+  /**
+   *  @brief The estimated number of input shapes (only available in adaptive mode)
+   */
+  size_t estimated_count;
+
+  /**
+   *  @brief The wall clock time spent on the tile in seconds
+   */
+  double seconds;
+};
+
+/**
+ *  @brief Launches a worker process for the multi-process mode of the tiling processor
+ *
+ *  The launcher receives the path of a job file. It is supposed to execute
+ *  "TilingProcessor::run_worker" on this job file in a separate process (for example by
+ *  running the "strmtile" tool) and deliver the worker's output as a stream.
+ *  By reimplementing this class, workers can be started on remote machines for example.
+ */
+class DB_PUBLIC TileWorkerLauncher
+{
+public:
+  /**
+   *  @brief Constructor
+   */
+  TileWorkerLauncher () { }
+
+  /**
+   *  @brief Destructor
+   */
+  virtual ~TileWorkerLauncher () { }
+
+  /**
+   *  @brief Starts the worker for the given job file and returns the stream delivering it's output
+   *
+   *  The caller takes ownership over the stream returned.
+   */
+  virtual tl::InputStream *launch (const std::string &job_file) = 0;
+};
+
+/**
+ *  @brief The default worker launcher
+ *
+ *  This launcher runs the given command through the shell with the job file path as
+ *  the last argument. The worker's output is taken from the command's standard output.
+ */
+class DB_PUBLIC TileWorkerCommandLauncher
+  : public TileWorkerLauncher
+{
+public:
+  /**
+   *  @brief Constructor
+   */
+  TileWorkerCommandLauncher (const std::string &command);
+
+  /**
+   *  @brief Implements TileWorkerLauncher::launch
+   */
+  virtual tl::InputStream *launch (const std::string &job_file);
+
+private:
+  std::string m_command;
+};
+
+/**
+ *  @brief A tile output receiver which writes the results directly to a layout file
+ *
+ *  This receiver sends the tile results to a stream writer (GDS2 or OASIS) while the tiles
+ *  are computed. Hence the results don't need to be collected in memory.
+ *  Each output channel using this receiver needs to be associated with a layer through
+ *  "add_layer". The ID returned by this method must be used as the output ID.
+ *
+ *  In "CellPerTile" mode, the results of a tile are written into a cell of their own
+ *  (named "TILE_<ix>_<iy>") which is placed in the top cell. The results are buffered
+ *  per tile and written when the tile is complete, so only the results of the tiles
+ *  currently being computed are kept in memory. If the receiver is used for multiple
+ *  runs, the cells of tiles delivered again get a numeric suffix. In "Merged" mode, the
+ *  results are written into the top cell as they arrive. Shape properties are not written.
+ *
+ *  The file is opened when the receiver is created and completed by "close" or when the
+ *  receiver is destroyed. The receiver can be used for multiple runs of a tiling processor.
+ */
+class DB_PUBLIC TileStreamWriter
+  : public TileOutputReceiver
+{
+public:
+  enum Mode { CellPerTile, Merged };
+
+  /**
+   *  @brief Constructor
+   *
+   *  @param path The path of the file to write
+   *  @param dbu The database unit of the file
+   *  @param top_cell The name of the top cell
+   *  @param mode The output mode
+   *  @param options The save options. If no format is specified, it is derived from the file name.
+   */
+  TileStreamWriter (const std::string &path, double dbu, const std::string &top_cell, Mode mode, const db::SaveLayoutOptions &options = db::SaveLayoutOptions ());
+
+  /**
+   *  @brief Destructor
+   *  The destructor will close the file if not done already.
+   */
+  ~TileStreamWriter ();
+
+  /**
+   *  @brief Registers a layer and returns the ID to be used for the output channel
+   */
+  size_t add_layer (const db::LayerProperties &lp);
+
+  /**
+   *  @brief Completes and closes the file
+   */
+  void close ();
+
+  /**
+   *  @brief Returns true if the file is still open
+   */
+  bool is_open () const
+  {
+    return mp_writer.get () != 0;
+  }
+
+  /**
+   *  @brief Returns the number of tile cells written so far
+   */
+  size_t tile_cells () const
+  {
+    return m_tile_cells.size ();
+  }
+
+  //  TileOutputReceiver implementation
+  virtual void put (size_t ix, size_t iy, const db::Box &tile, size_t id, const tl::Variant &obj, double dbu, const db::ICplxTrans &trans, bool clip);
+  virtual void end_tile (size_t ix, size_t iy);
+  virtual void finish (bool success);
+
+private:
+  typedef std::map<std::pair<size_t, size_t>, db::cell_index_type> pending_tiles_type;
+
+  std::unique_ptr<tl::OutputStream> mp_stream;
+  std::unique_ptr<db::Writer> mp_writer;
+  std::string m_top_cell;
+  Mode m_mode;
+  std::vector<std::pair<db::LayerProperties, unsigned int> > m_layers;
+  db::Layout m_buffer;
+  db::cell_index_type m_buffer_cell;
+  pending_tiles_type m_pending_tiles;
+  std::vector<std::string> m_tile_cells;
+  std::map<std::pair<size_t, size_t>, unsigned int> m_tile_cell_count;
+
+  void flush_tile (pending_tiles_type::iterator t);
+  void flush_tiles ();
+};
+
 /**
  *  @brief A processor for executing scripts on tiles of a layout
  *
@@ -523,6 +719,14 @@ public:
    */
   void output (const std::string &name, db::Edges &edges);
 
+  /**
+   *  @brief Specifies output to a layer of a tile stream writer
+   *
+   *  The results will be written to the writer's file on the given layer.
+   *  The writer is not owned by the processor, so it can be used for multiple runs.
+   */
+  void output (const std::string &name, db::TileStreamWriter &writer, const db::LayerProperties &lp);
+
   /**
    *  @brief Gets the database unit under which the computation will be done
    */
@@ -616,6 +820,69 @@ public:
    */
   void tile_origin (double xo, double yo);
 
+  /**
+   *  @brief Enables or disables adaptive tiling
+   *
+   *  In adaptive mode, the tiles of the regular grid are subdivided further
+   *  (quadtree style) where the estimated number of input shapes is high.
+   *  The estimate is computed from a cheap hierarchical count. The goal is to
+   *  obtain tiles with a similar amount of work. In addition, the tiles
+   *  are executed in the order of decreasing estimated count, so the large
+   *  tiles don't end up as stragglers.
+   *
+   *  In adaptive mode, the tile indexes passed to the receivers refer to
+   *  the lower-left cell of the tile in the grid of the smallest tiles.
+   *  This grid is finer than the regular one by a power of two. If no tile
+   *  is subdivided, it is identical to the regular grid, so the indexes are
+   *  the same as in non-adaptive mode. TileOutputReceiver::begin receives
+   *  the dimensions of that grid. The tile box passed to
+   *  TileOutputReceiver::put is the actual tile.
+   *
+   *  Adaptive tiling requires tiles being specified.
+   */
+  void set_adaptive (bool f)
+  {
+    m_adaptive = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether adaptive tiling is enabled
+   */
+  bool adaptive () const
+  {
+    return m_adaptive;
+  }
+
+  /**
+   *  @brief Sets the minimum estimated shape count for a tile to be subdivided
+   *
+   *  In adaptive mode, tiles with fewer estimated shapes are never subdivided
+   *  as the gain would not pay off the cost of the tile borders.
+   */
+  void set_adaptive_threshold (size_t n)
+  {
+    m_adaptive_threshold = n;
+  }
+
+  /**
+   *  @brief Gets the minimum estimated shape count for a tile to be subdivided
+   */
+  size_t adaptive_threshold () const
+  {
+    return m_adaptive_threshold;
+  }
+
+  /**
+   *  @brief Gets the statistics of the last execution
+   *
+   *  One entry is present for each tile and script. The entries are sorted
+   *  by tile and script index.
+   */
+  const std::vector<TileStatistics> &tile_statistics () const
+  {
+    return m_tile_statistics;
+  }
+
   /**
    *  @brief Specifies the number of threads to use
    */
@@ -629,6 +896,69 @@ public:
     return m_threads;
   }
 
+  /**
+   *  @brief Specifies the number of worker processes to use
+   *
+   *  If this number is non-zero, the tiles are distributed over the given number of
+   *  worker processes instead of being executed in threads of the current process.
+   *  Each worker process may use multiple threads itself (see "set_threads").
+   *  The inputs are transferred to the workers through files in a temporary directory.
+   *  Inputs taken from a layout are written as an OASIS snapshot once, other inputs
+   *  are transferred per tile. The "_rec" function is not available in this mode.
+   *  The multi-process mode is effective only if tiles are used.
+   */
+  void set_processes (size_t n)
+  {
+    m_processes = n;
+  }
+
+  /**
+   *  @brief Gets the number of worker processes
+   */
+  size_t processes () const
+  {
+    return m_processes;
+  }
+
+  /**
+   *  @brief Specifies the command to start a worker process
+   *
+   *  The job file path is appended to this command. By default, the "strmtile" tool
+   *  from the installation path is used.
+   */
+  void set_worker_command (const std::string &cmd)
+  {
+    m_worker_command = cmd;
+  }
+
+  /**
+   *  @brief Gets the command to start a worker process
+   */
+  const std::string &worker_command () const
+  {
+    return m_worker_command;
+  }
+
+  /**
+   *  @brief Installs a custom launcher for the worker processes
+   *
+   *  The tiling processor takes ownership over the launcher object. If a launcher is
+   *  installed, the worker command is not used. Passing 0 resets the launcher.
+   */
+  void set_launcher (TileWorkerLauncher *launcher)
+  {
+    mp_launcher.reset (launcher);
+  }
+
+  /**
+   *  @brief Executes a worker job
+   *
+   *  This method is the implementation of the worker process. It reads the job file
+   *  produced by the tiling processor in multi-process mode, executes the tiles listed
+   *  in the job and writes the results to the given stream.
+   */
+  static void run_worker (tl::InputStream &job, tl::OutputStream &out);
+
   /**
    *  @brief Queue a script for execution with "execute"
    *
@@ -648,6 +978,8 @@ private:
   friend class TilingProcessorWorker;
   friend class TilingProcessorOutputFunction;
   friend class TilingProcessorReceiverFunction;
+  friend class TilingProcessorProcessJob;
+  friend class TilingProcessorProcessWorker;
 
   struct InputSpec
   {
@@ -672,7 +1004,11 @@ private:
   std::vector<InputSpec>::const_iterator end_inputs () const { return m_inputs.end (); }
 
   void put (size_t ix, size_t iy, const db::Box &tile, const std::vector<tl::Variant> &args);
+  void add_tile_statistics (const TileStatistics &ts);
+  size_t estimate_count (std::vector<TilingProcessorCountEstimator> &estimators, const db::DBox &region) const;
   tl::Variant receiver (const std::vector<tl::Variant> &args);
+  void put_result (size_t index, size_t ix, size_t iy, const db::Box &tile, const tl::Variant &obj, bool clip);
+  void task_finished (size_t ix, size_t iy);
   tl::Eval &top_eval () { return m_top_eval; }
 
   std::vector<InputSpec> m_inputs;
@@ -685,10 +1021,20 @@ private:
   bool m_tile_origin_given;
   double m_tile_bx, m_tile_by;
   size_t m_threads;
+  bool m_adaptive;
+  size_t m_adaptive_threshold;
+  std::vector<TileStatistics> m_tile_statistics;
+  tl::Mutex m_statistics_mutex;
+  size_t m_processes;
+  std::string m_worker_command;
+  std::unique_ptr<TileWorkerLauncher> mp_launcher;
+  tl::OutputStream *mp_worker_stream;
+  std::vector<std::pair<std::string, tl::Variant> > m_vars;
   double m_dbu, m_dbu_specific;
   bool m_dbu_specific_set;
   bool m_scale_to_dbu;
   std::vector<std::string> m_scripts;
+  std::map<std::pair<size_t, size_t>, size_t> m_tasks_pending;
   tl::Mutex m_output_mutex;
   tl::Eval m_top_eval;
 };
@@ -703,6 +1049,13 @@ namespace tl
     typedef tl::true_tag has_default_constructor;
     typedef tl::false_tag has_copy_constructor;
   };
+
+  template <>
+  struct type_traits<db::TileStreamWriter> : public type_traits<void>
+  {
+    typedef tl::false_tag has_default_constructor;
+    typedef tl::false_tag has_copy_constructor;
+  };
 }
 
 #endif
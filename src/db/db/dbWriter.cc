@@ -32,6 +32,53 @@
 namespace db
 {
 
+// ------------------------------------------------------------------
+//  WriterBase implementation
+
+static void streaming_not_supported ()
+{
+  throw tl::Exception (tl::to_string (tr ("This writer does not support streaming mode")));
+}
+
+void
+WriterBase::begin_stream (tl::OutputStream & /*stream*/, double /*dbu*/, const db::SaveLayoutOptions & /*options*/)
+{
+  streaming_not_supported ();
+}
+
+void
+WriterBase::begin_stream_cell (const std::string & /*name*/)
+{
+  streaming_not_supported ();
+}
+
+void
+WriterBase::stream_shapes (const db::Layout & /*layout*/, const db::Shapes & /*shapes*/, const db::LayerProperties & /*lp*/)
+{
+  streaming_not_supported ();
+}
+
+void
+WriterBase::stream_cell_reference (const std::string & /*name*/, const db::Vector & /*disp*/)
+{
+  streaming_not_supported ();
+}
+
+void
+WriterBase::end_stream_cell ()
+{
+  streaming_not_supported ();
+}
+
+void
+WriterBase::end_stream ()
+{
+  streaming_not_supported ();
+}
+
+// ------------------------------------------------------------------
+//  Writer implementation
+
 Writer::Writer (const db::SaveLayoutOptions &options)
   : mp_writer (0), m_options (options)
 {
@@ -62,5 +109,46 @@ Writer::write (db::Layout &layout, tl::OutputStream &stream)
   mp_writer->write (layout, stream, m_options);
 }
 
+void
+Writer::begin_stream (tl::OutputStream &stream, double dbu)
+{
+  tl_assert (mp_writer != 0);
+  mp_writer->begin_stream (stream, dbu, m_options);
+}
+
+void
+Writer::begin_stream_cell (const std::string &name)
+{
+  tl_assert (mp_writer != 0);
+  mp_writer->begin_stream_cell (name);
 }
 
+void
+Writer::stream_shapes (const db::Layout &layout, const db::Shapes &shapes, const db::LayerProperties &lp)
+{
+  tl_assert (mp_writer != 0);
+  mp_writer->stream_shapes (layout, shapes, lp);
+}
+
+void
+Writer::stream_cell_reference (const std::string &name, const db::Vector &disp)
+{
+  tl_assert (mp_writer != 0);
+  mp_writer->stream_cell_reference (name, disp);
+}
+
+void
+Writer::end_stream_cell ()
+{
+  tl_assert (mp_writer != 0);
+  mp_writer->end_stream_cell ();
+}
+
+void
+Writer::end_stream ()
+{
+  tl_assert (mp_writer != 0);
+  mp_writer->end_stream ();
+}
+
+}
@@ -28,6 +28,8 @@
 
 #include "tlException.h"
 #include "dbSaveLayoutOptions.h"
+#include "dbLayerProperties.h"
+#include "dbVector.h"
 
 namespace tl 
 {
@@ -39,6 +41,7 @@ namespace db
 {
 
 class Layout;
+class Shapes;
 
 /**
  *  @brief The generic writer base class
@@ -61,6 +64,52 @@ public:
    *  The layout is non-const since the writer may modify the meta information of the layout.
    */
   virtual void write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options) = 0;
+
+  /**
+   *  @brief Returns a value indicating whether the writer is able to write a file incrementally
+   *
+   *  Incremental ("streaming") output is a sequence of "begin_stream", one or more cells
+   *  (each "begin_stream_cell", "stream_shapes" and "stream_cell_reference" calls, "end_stream_cell")
+   *  and "end_stream". Cells are written in the order they are delivered and are referred to by name.
+   *  This way, a writer does not need to hold the full layout in memory.
+   *  Properties and context information are not written in streaming mode.
+   */
+  virtual bool supports_streaming () const
+  {
+    return false;
+  }
+
+  /**
+   *  @brief Starts writing a file in streaming mode
+   *  "dbu" is the database unit of the shapes delivered later.
+   */
+  virtual void begin_stream (tl::OutputStream &stream, double dbu, const db::SaveLayoutOptions &options);
+
+  /**
+   *  @brief Starts a new cell in streaming mode
+   */
+  virtual void begin_stream_cell (const std::string &name);
+
+  /**
+   *  @brief Writes the shapes to the current cell on the given layer
+   *  The layout is used for resolving property ID's.
+   */
+  virtual void stream_shapes (const db::Layout &layout, const db::Shapes &shapes, const db::LayerProperties &lp);
+
+  /**
+   *  @brief Places the cell with the given name with the given displacement into the current cell
+   */
+  virtual void stream_cell_reference (const std::string &name, const db::Vector &disp);
+
+  /**
+   *  @brief Finishes the current cell
+   */
+  virtual void end_stream_cell ();
+
+  /**
+   *  @brief Finishes the file
+   */
+  virtual void end_stream ();
 };
 
 /**
@@ -96,6 +145,45 @@ public:
     return mp_writer != 0;
   }
 
+  /**
+   *  @brief Returns true, if the writer for this format supports streaming mode
+   */
+  bool supports_streaming () const
+  {
+    return mp_writer != 0 && mp_writer->supports_streaming ();
+  }
+
+  /**
+   *  @brief Starts writing a file in streaming mode
+   *  See WriterBase::begin_stream for details about the streaming protocol.
+   */
+  void begin_stream (tl::OutputStream &stream, double dbu);
+
+  /**
+   *  @brief Starts a new cell in streaming mode
+   */
+  void begin_stream_cell (const std::string &name);
+
+  /**
+   *  @brief Writes shapes to the current cell in streaming mode
+   */
+  void stream_shapes (const db::Layout &layout, const db::Shapes &shapes, const db::LayerProperties &lp);
+
+  /**
+   *  @brief Places a cell into the current cell in streaming mode
+   */
+  void stream_cell_reference (const std::string &name, const db::Vector &disp);
+
+  /**
+   *  @brief Finishes the current cell in streaming mode
+   */
+  void end_stream_cell ();
+
+  /**
+   *  @brief Finishes the file in streaming mode
+   */
+  void end_stream ();
+
 private:
   WriterBase *mp_writer;
   db::SaveLayoutOptions m_options;
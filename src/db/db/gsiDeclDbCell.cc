@@ -1255,12 +1255,12 @@ fill_region1 (db::Cell *cell, const db::Region &fr, db::cell_index_type fill_cel
 
 static void
 fill_region2 (db::Cell *cell, const db::Region &fr, db::cell_index_type fill_cell_index, const db::Box &fc_box, const db::Point *origin,
-              db::Region *remaining_parts, const db::Vector &fill_margin, db::Region *remaining_polygons)
+              db::Region *remaining_parts, const db::Vector &fill_margin, db::Region *remaining_polygons, unsigned int threads)
 {
   if (fc_box.empty () || fc_box.width () == 0 || fc_box.height () == 0) {
     throw tl::Exception (tl::to_string (tr ("Invalid fill cell footprint (empty or zero width/height)")));
   }
-  db::fill_region (cell, fr, fill_cell_index, fc_box, origin ? *origin : db::Point (), origin == 0, remaining_parts, fill_margin, remaining_polygons);
+  db::fill_region (cell, fr, fill_cell_index, fc_box, origin ? *origin : db::Point (), origin == 0, remaining_parts, fill_margin, remaining_polygons, threads);
 }
 
 static db::Instance cell_inst_dtransform_simple (db::Cell *cell, const db::Instance &inst, const db::DTrans &t)
@@ -1371,6 +1371,26 @@ static db::DBox cell_dbbox_per_layer (const db::Cell *cell, unsigned int layer_i
   return cell->bbox (layer_index) * layout->dbu ();
 }
 
+static size_t cell_shape_count (const db::Cell *cell, unsigned int layer_index)
+{
+  const db::Layout *layout = cell->layout ();
+  if (! layout) {
+    throw tl::Exception (tl::to_string (tr ("Cell does not reside inside a layout - cannot compute the shape count")));
+  }
+
+  return layout->shape_count (cell->cell_index (), layer_index);
+}
+
+static size_t cell_flat_shape_count (const db::Cell *cell, unsigned int layer_index)
+{
+  const db::Layout *layout = cell->layout ();
+  if (! layout) {
+    throw tl::Exception (tl::to_string (tr ("Cell does not reside inside a layout - cannot compute the flat shape count")));
+  }
+
+  return layout->flat_shape_count (cell->cell_index (), layer_index);
+}
+
 gsi::layout_locking_iterator1<db::Cell::overlapping_iterator> begin_overlapping_inst (const db::Cell *cell, const db::Cell::box_type &b)
 {
   return gsi::layout_locking_iterator1<db::Cell::overlapping_iterator> (cell->layout (), cell->begin_overlapping (b));
@@ -1737,7 +1757,7 @@ Class<db::Cell> decl_Cell ("db", "Cell",
     "\n"
     "This method has been introduced in version 0.23.\n"
   ) +
-  gsi::method_ext ("fill_region", &fill_region2, gsi::arg ("region"), gsi::arg ("fill_cell_index"), gsi::arg ("fc_box"), gsi::arg ("origin"), gsi::arg ("remaining_parts"), gsi::arg ("fill_margin"), gsi::arg ("remaining_polygons"),
+  gsi::method_ext ("fill_region", &fill_region2, gsi::arg ("region"), gsi::arg ("fill_cell_index"), gsi::arg ("fc_box"), gsi::arg ("origin"), gsi::arg ("remaining_parts"), gsi::arg ("fill_margin"), gsi::arg ("remaining_polygons"), gsi::arg ("threads", (unsigned int) 0),
     "@brief Fills the given region with cells of the given type (extended version)\n"
     "@param region The region to fill\n"
     "@param fill_cell_index The fill cell to place\n"
@@ -1746,6 +1766,7 @@ Class<db::Cell> decl_Cell ("db", "Cell",
     "@param remaining_parts See explanation below\n"
     "@param fill_margin See explanation below\n"
     "@param remaining_polygons See explanation below\n"
+    "@param threads The number of threads to use for filling (0: fill in the calling thread)\n"
     "\n"
     "First of all, this method behaves like the simple form. In addition, it can be configured to return information about the "
     "parts which could not be filled. Those can be full polygons from the input (without a chance to fill) or parts of original polygons "
@@ -1778,7 +1799,11 @@ Class<db::Cell> decl_Cell ("db", "Cell",
     "end\n"
     "@/code\n"
     "\n"
-    "This method has been introduced in version 0.23.\n"
+    "Polygons which are identical apart from a shift by the fill raster (or any shift if 'origin' is nil) are filled "
+    "only once. Neighboring fill cells are combined into regular instance arrays. With 'threads' larger than 0, "
+    "the polygons are filled in parallel.\n"
+    "\n"
+    "This method has been introduced in version 0.23. The 'threads' argument has been added in version 0.27.\n"
   ) +
   gsi::method_ext ("begin_shapes_rec", &begin_shapes_rec, gsi::arg ("layer"),
     "@brief Delivers a recursive shape iterator for the shapes below the cell on the given layer\n"
@@ -2312,6 +2337,24 @@ Class<db::Cell> decl_Cell ("db", "Cell",
     "\n"
     "The bounding box is the box enclosing all shapes on the given layer.\n"
   ) +
+  gsi::method_ext ("shape_count", &cell_shape_count, gsi::arg ("layer_index"),
+    "@brief Gets the number of shapes on the given layer in this cell\n"
+    "\n"
+    "The members of shape arrays are counted individually. Shapes of child cells are not included. "
+    "The counts are cached inside the layout and the cache is maintained automatically when shapes are changed. "
+    "Hence this method is cheap when called multiple times.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method_ext ("flat_shape_count", &cell_flat_shape_count, gsi::arg ("layer_index"),
+    "@brief Gets the \"as if flat\" number of shapes on the given layer in this cell and its children\n"
+    "\n"
+    "Shapes of child cells count as many times as the child cell is placed. Array instances count with their number of members. "
+    "The flat counts of all cells are computed in a single pass over the hierarchy and cached inside the layout until "
+    "the hierarchy or the shapes on this layer change. This is much faster than a recursive shape iterator for this purpose.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   gsi::method_ext ("dbbox", &cell_dbbox,
     "@brief Gets the bounding box of the cell in micrometer units\n"
     "\n"
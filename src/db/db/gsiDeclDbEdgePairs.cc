@@ -27,6 +27,7 @@
 #include "dbEdges.h"
 #include "dbRegion.h"
 #include "dbDeepEdgePairs.h"
+#include "gsiDeclDbHelpers.h"
 
 namespace gsi
 {
@@ -75,6 +76,39 @@ static db::EdgePairs *new_si2d (const db::RecursiveShapeIterator &si, db::DeepSh
   return new db::EdgePairs (si, dss, trans);
 }
 
+static std::vector<char> to_array (const db::EdgePairs *edge_pairs)
+{
+  std::vector<db::Coord> coordinates;
+  for (db::EdgePairs::const_iterator e = edge_pairs->begin (); ! e.at_end (); ++e) {
+    coordinates.push_back (e->first ().p1 ().x ());
+    coordinates.push_back (e->first ().p1 ().y ());
+    coordinates.push_back (e->first ().p2 ().x ());
+    coordinates.push_back (e->first ().p2 ().y ());
+    coordinates.push_back (e->second ().p1 ().x ());
+    coordinates.push_back (e->second ().p1 ().y ());
+    coordinates.push_back (e->second ().p2 ().x ());
+    coordinates.push_back (e->second ().p2 ().y ());
+  }
+  return values_to_bytes (coordinates);
+}
+
+static db::EdgePairs *new_array (const std::vector<char> &bytes)
+{
+  std::vector<db::Coord> coordinates = values_from_bytes<db::Coord> (bytes);
+  if (coordinates.size () % 8 != 0) {
+    throw tl::Exception (tl::to_string (tr ("Edge pair coordinate arrays need to have eight values per edge pair")));
+  }
+
+  std::unique_ptr<db::EdgePairs> edge_pairs (new db::EdgePairs ());
+  edge_pairs->reserve (coordinates.size () / 8);
+  for (size_t i = 0; i < coordinates.size (); i += 8) {
+    db::Edge first (coordinates [i], coordinates [i + 1], coordinates [i + 2], coordinates [i + 3]);
+    db::Edge second (coordinates [i + 4], coordinates [i + 5], coordinates [i + 6], coordinates [i + 7]);
+    edge_pairs->insert (first, second);
+  }
+  return edge_pairs.release ();
+}
+
 static std::string to_string0 (const db::EdgePairs *r)
 {
   return r->to_string ();
@@ -516,6 +550,25 @@ Class<db::EdgePairs> decl_EdgePairs (decl_dbShapeCollection, "db", "EdgePairs",
     "\n"
     "This method has been introduced in version 0.26."
   ) +
+  method_ext ("to_array", &to_array,
+    "@brief Exports the edge pairs into a flat coordinate array\n"
+    "\n"
+    "This method delivers a byte array holding eight values per edge pair: x1, y1, x2 and y2 of the first "
+    "edge followed by x1, y1, x2 and y2 of the second edge. The values are database coordinates "
+    "(32 bit integers or 64 bit integers if KLayout is built with 64 bit coordinates) in native byte order. This representation avoids creating one object per edge pair. "
+    "In Python, the array can be turned into a NumPy array without copying, e.g. with "
+    "\"numpy.frombuffer(array, dtype = numpy.int32)\". See \\from_array for the reverse conversion.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  constructor ("from_array", &new_array, gsi::arg ("array"),
+    "@brief Creates an edge pair collection from a flat coordinate array\n"
+    "\n"
+    "This constructor is the counterpart of \\to_array. In Python, any object supporting the buffer "
+    "protocol can be passed, for example a NumPy array of type int32.\n"
+    "\n"
+    "This constructor has been introduced in version 0.27."
+  ) +
   method ("has_valid_edge_pairs?", &db::EdgePairs::has_valid_edge_pairs,
     "@brief Returns true if the edge pair collection is flat and individual edge pairs can be accessed randomly\n"
     "\n"
@@ -31,6 +31,7 @@
 #include "dbRegion.h"
 #include "dbOriginalLayerRegion.h"
 #include "dbLayoutUtils.h"
+#include "gsiDeclDbHelpers.h"
 
 namespace gsi
 {
@@ -116,6 +117,33 @@ static db::Edges *new_si2d (const db::RecursiveShapeIterator &si, db::DeepShapeS
   return new db::Edges (si, dss, trans, as_edges);
 }
 
+static std::vector<char> to_array (const db::Edges *edges)
+{
+  std::vector<db::Coord> coordinates;
+  for (db::Edges::const_iterator e = edges->begin (); ! e.at_end (); ++e) {
+    coordinates.push_back (e->p1 ().x ());
+    coordinates.push_back (e->p1 ().y ());
+    coordinates.push_back (e->p2 ().x ());
+    coordinates.push_back (e->p2 ().y ());
+  }
+  return values_to_bytes (coordinates);
+}
+
+static db::Edges *new_array (const std::vector<char> &bytes)
+{
+  std::vector<db::Coord> coordinates = values_from_bytes<db::Coord> (bytes);
+  if (coordinates.size () % 4 != 0) {
+    throw tl::Exception (tl::to_string (tr ("Edge coordinate arrays need to have four values per edge")));
+  }
+
+  std::unique_ptr<db::Edges> edges (new db::Edges ());
+  edges->reserve (coordinates.size () / 4);
+  for (size_t i = 0; i < coordinates.size (); i += 4) {
+    edges->insert (db::Edge (coordinates [i], coordinates [i + 1], coordinates [i + 2], coordinates [i + 3]));
+  }
+  return edges.release ();
+}
+
 static db::Edges::distance_type length1 (const db::Edges *edges)
 {
   return edges->length ();
@@ -1416,6 +1444,26 @@ Class<db::Edges> decl_Edges (decl_dbShapeCollection, "db", "Edges",
     "\n"
     "This method has been introduced in version 0.26."
   ) +
+  method_ext ("to_array", &to_array,
+    "@brief Exports the edges into a flat coordinate array\n"
+    "\n"
+    "This method delivers a byte array holding x1, y1, x2 and y2 of each edge as database coordinate "
+    "values (32 bit integers or 64 bit integers if KLayout is built with 64 bit coordinates) in native byte order. This representation avoids creating one object per edge. "
+    "In Python, the array can be turned into a NumPy array without copying, e.g. with "
+    "\"numpy.frombuffer(array, dtype = numpy.int32)\". See \\from_array for the reverse conversion.\n"
+    "\n"
+    "Merged semantics does not apply - the raw edges are delivered.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  constructor ("from_array", &new_array, gsi::arg ("array"),
+    "@brief Creates an edge collection from a flat coordinate array\n"
+    "\n"
+    "This constructor is the counterpart of \\to_array. In Python, any object supporting the buffer "
+    "protocol can be passed, for example a NumPy array of type int32.\n"
+    "\n"
+    "This constructor has been introduced in version 0.27."
+  ) +
   method ("has_valid_edges?", &db::Edges::has_valid_edges,
     "@brief Returns true if the edge collection is flat and individual edges can be accessed randomly\n"
     "\n"
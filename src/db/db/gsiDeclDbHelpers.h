@@ -25,6 +25,11 @@
 #define HDR_gsiDeclDbHelpers
 
 #include "dbLayoutUtils.h"
+#include "tlException.h"
+#include "tlInternational.h"
+
+#include <vector>
+#include <cstring>
 
 namespace gsi
 {
@@ -78,6 +83,32 @@ namespace gsi
     I m_i;
   };
 
+  /**
+   *  @brief Converts a vector of plain values into a byte array (native byte order)
+   */
+  template <class T>
+  std::vector<char> values_to_bytes (const std::vector<T> &values)
+  {
+    const char *cp = reinterpret_cast<const char *> (values.empty () ? 0 : &values.front ());
+    return std::vector<char> (cp, cp + values.size () * sizeof (T));
+  }
+
+  /**
+   *  @brief Converts a byte array (native byte order) into a vector of plain values
+   */
+  template <class T>
+  std::vector<T> values_from_bytes (const std::vector<char> &bytes)
+  {
+    if (bytes.size () % sizeof (T) != 0) {
+      throw tl::Exception (tl::to_string (tr ("Byte array size is not a multiple of the value size (%d)")), int (sizeof (T)));
+    }
+    std::vector<T> values (bytes.size () / sizeof (T));
+    if (! bytes.empty ()) {
+      memcpy (&values.front (), &bytes.front (), bytes.size ());
+    }
+    return values;
+  }
+
 }
 
 #endif
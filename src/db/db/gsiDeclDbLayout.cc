@@ -698,6 +698,11 @@ static db::Cell *cell_from_index (db::Layout *ly, db::cell_index_type ci)
   return &ly->cell (ci);
 }
 
+static size_t layout_shape_count (const db::Layout *ly, unsigned int layer_index, bool flat)
+{
+  return ly->shape_counts (layer_index, flat).total ();
+}
+
 static db::Cell *cell_from_name (db::Layout *ly, const std::string &name)
 {
   std::pair<bool, db::cell_index_type> cn = ly->cell_by_name (name.c_str ());
@@ -1486,6 +1491,18 @@ Class<db::Layout> decl_Layout ("db", "Layout",
     "\n"
     "@return The number of cells (the maximum cell index)\n"
   ) +
+  gsi::method_ext ("shape_count", &layout_shape_count, gsi::arg ("layer_index"), gsi::arg ("flat", false),
+    "@brief Gets the number of shapes on the given layer over all cells\n"
+    "\n"
+    "If 'flat' is false, each cell contributes its shapes once. If 'flat' is true, each cell contributes "
+    "as many times as it is seen from the top cells (\"as if flat\" count). The members of shape arrays "
+    "are counted individually.\n"
+    "\n"
+    "The per-cell counts and the cell multiplicities are cached inside the layout and maintained "
+    "automatically, so this method is cheap when called repeatedly. See also \\Cell#shape_count and \\Cell#flat_shape_count.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   gsi::method_ext ("cell", &cell_from_name, gsi::arg ("name"),
     "@brief Gets a cell object from the cell name\n"
     "\n"
@@ -1571,6 +1588,40 @@ Class<db::Layout> decl_Layout ("db", "Layout",
     "\n"
     "@param layer_index The index of the layer to delete.\n"
   ) +
+  gsi::method ("compact_polygons", (void (db::Layout::*) ()) &db::Layout::compact_polygons,
+    "@brief Converts the polygons of all layers into a compact representation\n"
+    "\n"
+    "The compact representation stores the polygon points as delta-encoded variable-length numbers. "
+    "This usually needs a fraction of the memory of the normal representation. It is intended for "
+    "read-only layouts, for example when viewing large layouts. Point access is somewhat slower "
+    "and modifying a polygon will convert it back into the normal representation. The geometry "
+    "is not changed.\n"
+    "\n"
+    "This method was introduced in version 0.27.\n"
+  ) +
+  gsi::method ("compact_polygons", (void (db::Layout::*) (unsigned int)) &db::Layout::compact_polygons, gsi::arg ("layer_index"),
+    "@brief Converts the polygons of the given layer into a compact representation\n"
+    "\n"
+    "See \\compact_polygons for details. Polygon references share identical polygons across layers, "
+    "so polygons on other layers may become compact as well.\n"
+    "\n"
+    "This method was introduced in version 0.27.\n"
+  ) +
+  gsi::method ("compact_polygon_mode=", &db::Layout::set_compact_polygon_mode, gsi::arg ("f"),
+    "@brief Enables or disables the compact polygon mode\n"
+    "\n"
+    "In compact polygon mode, polygons are converted into the compact representation (see \\compact_polygons) "
+    "as they are inserted into the layout, for example while a layout file is read. Enabling the mode "
+    "converts the polygons already present as well. Disabling the mode does not expand the polygons again.\n"
+    "\n"
+    "This attribute was introduced in version 0.27.\n"
+  ) +
+  gsi::method ("compact_polygon_mode?", &db::Layout::compact_polygon_mode,
+    "@brief Gets a value indicating whether the compact polygon mode is enabled\n"
+    "See \\compact_polygon_mode= for details.\n"
+    "\n"
+    "This attribute was introduced in version 0.27.\n"
+  ) +
   gsi::method ("delete_layer", &db::Layout::delete_layer, gsi::arg ("layer_index"),
     "@brief Deletes a layer\n"
     "\n"
@@ -1837,7 +1888,7 @@ Class<db::Layout> decl_Layout ("db", "Layout",
     "Starting with version 0.23, this variant is deprecated since the more convenient "
     "variant with two parameters automatically determines the compression mode from the file name. "
     "The gzip parameter is ignored staring with version 0.23.\n"
-  ) +
+  ).allow_threads () +
   gsi::method_ext ("write", &write_options1, gsi::arg ("filename"), gsi::arg ("options"),
     "@brief Writes the layout to a stream file\n"
     "@param filename The file to which to write the layout\n"
@@ -1847,11 +1898,11 @@ Class<db::Layout> decl_Layout ("db", "Layout",
     "The file is written with zlib compression if the suffix is \".gz\" or \".gzip\".\n"
     "\n"
     "This variant has been introduced in version 0.23.\n"
-  ) +
+  ).allow_threads () +
   gsi::method_ext ("write", &write_simple, gsi::arg ("filename"),
     "@brief Writes the layout to a stream file\n"
     "@param filename The file to which to write the layout\n"
-  ) + 
+  ).allow_threads () + 
   gsi::method_ext ("clip", &clip, gsi::arg ("cell"), gsi::arg ("box"),
     "@brief Clips the given cell by the given rectangle and produce a new cell with the clip\n"
     "@param cell The cell index of the cell to clip\n"
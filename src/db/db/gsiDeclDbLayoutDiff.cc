@@ -37,11 +37,22 @@ class LayoutDiff
 public:
   LayoutDiff ()
     : mp_layout_a (0), mp_cell_a (0), m_layer_index_a (0),
-      mp_layout_b (0), mp_cell_b (0), m_layer_index_b (0)
+      mp_layout_b (0), mp_cell_b (0), m_layer_index_b (0),
+      m_threads (0)
   {
     // .. nothing yet ..
   }
 
+  void set_threads (int n)
+  {
+    m_threads = n;
+  }
+
+  int threads () const
+  {
+    return m_threads;
+  }
+
   bool compare_layouts (const db::Layout *a, const db::Layout *b, unsigned int flags, db::Coord tolerance)
   {
     if (!a || !b) {
@@ -53,7 +64,7 @@ public:
     mp_layout_a = a;
     mp_layout_b = b;
     try {
-      res = db::compare_layouts(*a, *b, flags, tolerance, *this);
+      res = db::compare_layouts(*a, *b, flags, tolerance, *this, m_threads);
       mp_layout_a = mp_layout_b = 0;
     } catch (...) {
       mp_layout_a = mp_layout_b = 0;
@@ -76,7 +87,7 @@ public:
     tl_assert (mp_layout_b != 0);
 
     try {
-      res = db::compare_layouts(*mp_layout_a, a->cell_index (), *mp_layout_b, b->cell_index (), flags, tolerance, *this);
+      res = db::compare_layouts(*mp_layout_a, a->cell_index (), *mp_layout_b, b->cell_index (), flags, tolerance, *this, m_threads);
       mp_layout_a = mp_layout_b = 0;
     } catch (...) {
       mp_layout_a = mp_layout_b = 0;
@@ -367,6 +378,7 @@ private:
   const db::Layout *mp_layout_b;
   const db::Cell *mp_cell_b;
   int m_layer_index_b;
+  int m_threads;
 };
 
 }
@@ -537,6 +549,19 @@ gsi::Class<LayoutDiff> decl_LayoutDiff ("db", "LayoutDiff",
     "\n"
     "@return True, if the cells are identical\n"
   ) +
+  gsi::method ("threads=", &LayoutDiff::set_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads to use for the compare\n"
+    "If this value is larger than 0, the cells are compared in parallel using the given number of threads. "
+    "The events are still issued from the calling thread and in the same order as without threads.\n"
+    "\n"
+    "This attribute has been introduced in version 0.27."
+  ) +
+  gsi::method ("threads", &LayoutDiff::threads,
+    "@brief Gets the number of threads to use for the compare\n"
+    "See \\threads= for details.\n"
+    "\n"
+    "This attribute has been introduced in version 0.27."
+  ) +
   gsi::method ("layout_a", &LayoutDiff::layout_a,
     "@brief Gets the first layout the difference detector runs on"
   ) +
@@ -579,10 +579,14 @@ Class<db::LayoutToNetlist> decl_dbLayoutToNetlist ("db", "LayoutToNetlist",
   gsi::method ("write|write_l2n", &db::LayoutToNetlist::save, gsi::arg ("path"), gsi::arg ("short_format", false),
     "@brief Writes the extracted netlist to a file.\n"
     "This method employs the native format of KLayout.\n"
+    "\n"
+    "If the file name ends with '.l2nb', a binary version of the format is written. "
+    "This format is faster to read and allows the netlist browser to load the net geometry on demand. "
+    "The binary format has been introduced in version 0.27.\n"
   ) +
   gsi::method ("read|read_l2n", &db::LayoutToNetlist::load, gsi::arg ("path"),
     "@brief Reads the extracted netlist from the file.\n"
-    "This method employs the native format of KLayout.\n"
+    "This method employs the native format of KLayout. The binary format is detected automatically.\n"
   ) +
   gsi::method_ext ("antenna_check", &antenna_check, gsi::arg ("gate"), gsi::arg ("metal"), gsi::arg ("ratio"), gsi::arg ("diodes", std::vector<tl::Variant> (), "[]"),
    "@brief Runs an antenna check on the extracted clusters\n"
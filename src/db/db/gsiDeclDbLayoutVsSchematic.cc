@@ -121,10 +121,14 @@ Class<db::LayoutVsSchematic> decl_dbLayoutVsSchematic (decl_dbLayoutToNetlist, "
   gsi::method ("write", &db::LayoutVsSchematic::save, gsi::arg ("path"), gsi::arg ("short_format", false),
     "@brief Writes the LVS object to a file.\n"
     "This method employs the native format of KLayout.\n"
+    "\n"
+    "If the file name ends with '.lvsdbb', a binary version of the format is written. "
+    "This format is faster to read and allows the netlist browser to load the net geometry on demand. "
+    "The binary format has been introduced in version 0.27.\n"
   ) +
   gsi::method ("read", &db::LayoutVsSchematic::load, gsi::arg ("path"),
     "@brief Reads the LVS object from the file.\n"
-    "This method employs the native format of KLayout.\n"
+    "This method employs the native format of KLayout. The binary format is detected automatically.\n"
   ),
   "@brief A generic framework for doing LVS (layout vs. schematic)\n"
   "\n"
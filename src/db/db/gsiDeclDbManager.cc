@@ -116,6 +116,38 @@ Class<db::Manager> decl_Manager ("db", "Manager",
   ) +
   gsi::method_ext ("transaction_for_redo", &transaction_for_redo,
     "@brief Return the description of the next transaction for 'redo'\n"
+  ) +
+  gsi::method ("max_memory=", &db::Manager::set_max_memory, gsi::arg ("bytes"),
+    "@brief Sets the undo memory budget in bytes\n"
+    "\n"
+    "When the undo history exceeds this amount of memory, old transactions are compacted into a "
+    "compressed representation. They are restored when they are undone or redone. If \\spill_to_disk is "
+    "enabled, compacted transactions are moved to a temporary file when the budget is still exceeded.\n"
+    "A value of 0 (the default) disables the budget.\n"
+    "\n"
+    "This attribute has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("max_memory", &db::Manager::max_memory,
+    "@brief Gets the undo memory budget in bytes\n"
+    "See \\max_memory= for details.\n"
+    "\n"
+    "This attribute has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("spill_to_disk=", &db::Manager::set_spill_to_disk, gsi::arg ("flag"),
+    "@brief Enables or disables moving compacted transactions to a temporary file\n"
+    "See \\max_memory= for details.\n"
+    "\n"
+    "This attribute has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("spill_to_disk?", &db::Manager::spill_to_disk,
+    "@brief Gets a value indicating whether compacted transactions are moved to a temporary file\n"
+    "\n"
+    "This attribute has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("memory_used", &db::Manager::memory_used,
+    "@brief Gets the approximate memory used by the undo history in bytes\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
   ),
   "@brief A transaction manager class\n"
   "\n"
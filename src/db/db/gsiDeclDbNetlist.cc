@@ -2328,6 +2328,20 @@ Class<db::NetlistSpiceReader> db_NetlistSpiceReader (db_NetlistReader, "db", "Ne
   ) +
   gsi::constructor ("new", &new_spice_reader2, gsi::arg ("delegate"),
     "@brief Creates a new reader with a delegate.\n"
+  ) +
+  gsi::method ("threads=", &db::NetlistSpiceReader::set_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads to use for parsing the netlist\n"
+    "With multiple threads, the lines of the netlist are parsed in parallel. The circuits, nets and devices are still "
+    "created in the calling thread and the delegate is called from there too. With 0 threads (the default), "
+    "the netlist is parsed in the calling thread.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("threads", &db::NetlistSpiceReader::threads,
+    "@brief Gets the number of threads to use for parsing the netlist\n"
+    "See \\threads= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
   ),
   "@brief Implements a netlist Reader for the SPICE format.\n"
   "Use the SPICE reader like this:\n"
@@ -419,7 +419,7 @@ namespace gsi
       "@return A layer map that contains the mapping used by the reader including the layers that have been created."
       "\n"
       "This method has been added in version 0.18."
-    ) +
+    ).allow_threads () +
     gsi::method_ext ("read", &load_with_options, gsi::arg ("filename"), gsi::arg ("options"),
       "@brief Load the layout from the given file with options\n"
       "The format of the file is determined automatically and automatic unzipping is provided. "
@@ -429,7 +429,7 @@ namespace gsi
       "@return A layer map that contains the mapping used by the reader including the layers that have been created."
       "\n"
       "This method has been added in version 0.18."
-    ),
+    ).allow_threads (),
     ""
   );
 
@@ -34,6 +34,8 @@
 #include "dbRegion.h"
 #include "dbRegionProcessors.h"
 #include "dbCompoundOperation.h"
+#include "dbPolygonArrays.h"
+#include "gsiDeclDbHelpers.h"
 #include "tlGlobPattern.h"
 
 #include <memory>
@@ -217,6 +219,32 @@ static void insert_si2 (db::Region *r, db::RecursiveShapeIterator si, db::ICplxT
   }
 }
 
+static std::vector<std::vector<char> > to_arrays (const db::Region *r)
+{
+  db::PolygonArrays arrays;
+  for (db::Region::const_iterator p = r->begin (); ! p.at_end (); ++p) {
+    arrays.add (*p);
+  }
+
+  std::vector<std::vector<char> > res;
+  res.push_back (values_to_bytes (arrays.coordinates ()));
+  res.push_back (values_to_bytes (arrays.contours ()));
+  res.push_back (values_to_bytes (arrays.polygons ()));
+  return res;
+}
+
+static db::Region *new_arrays (const std::vector<char> &coordinates, const std::vector<char> &contours, const std::vector<char> &polygons)
+{
+  db::PolygonArrays arrays (values_from_bytes<db::Coord> (coordinates), values_from_bytes<db::PolygonArrays::index_type> (contours), values_from_bytes<db::PolygonArrays::index_type> (polygons));
+
+  std::unique_ptr<db::Region> r (new db::Region ());
+  r->reserve (arrays.size ());
+  for (size_t i = 0; i < arrays.size (); ++i) {
+    r->insert (arrays.polygon (i));
+  }
+  return r.release ();
+}
+
 static db::Region minkowsky_sum_pe (const db::Region *r, const db::Edge &e)
 {
   return r->processed (db::minkowsky_sum_computation<db::Edge> (e));
@@ -486,7 +514,7 @@ static db::Region merged_ext2 (db::Region *r, bool min_coherence, int min_wc)
   return r->merged (min_coherence, std::max (0, min_wc - 1));
 }
 
-static db::EdgePairs width2 (const db::Region *r, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, bool negative)
+static db::EdgePairs width2 (const db::Region *r, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, bool negative, unsigned int threads)
 {
   return r->width_check (d, db::RegionCheckOptions (whole_edges,
                                             metrics,
@@ -496,11 +524,12 @@ static db::EdgePairs width2 (const db::Region *r, db::Region::distance_type d, b
                                             shielded,
                                             db::NoOppositeFilter,
                                             db::NoSideAllowed,
-                                            negative)
+                                            negative,
+                                            threads)
                         );
 }
 
-static db::EdgePairs space2 (const db::Region *r, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative)
+static db::EdgePairs space2 (const db::Region *r, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative, unsigned int threads)
 {
   return r->space_check (d, db::RegionCheckOptions (whole_edges,
                                             metrics,
@@ -510,11 +539,12 @@ static db::EdgePairs space2 (const db::Region *r, db::Region::distance_type d, b
                                             shielded,
                                             opposite,
                                             rect_filter,
-                                            negative)
+                                            negative,
+                                            threads)
                         );
 }
 
-static db::EdgePairs notch2 (const db::Region *r, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, bool negative)
+static db::EdgePairs notch2 (const db::Region *r, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, bool negative, unsigned int threads)
 {
   return r->notch_check (d, db::RegionCheckOptions (whole_edges,
                                             metrics,
@@ -524,11 +554,12 @@ static db::EdgePairs notch2 (const db::Region *r, db::Region::distance_type d, b
                                             shielded,
                                             db::NoOppositeFilter,
                                             db::NoSideAllowed,
-                                            negative)
+                                            negative,
+                                            threads)
                         );
 }
 
-static db::EdgePairs isolated2 (const db::Region *r, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative)
+static db::EdgePairs isolated2 (const db::Region *r, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative, unsigned int threads)
 {
   return r->isolated_check (d, db::RegionCheckOptions (whole_edges,
                                             metrics,
@@ -538,11 +569,12 @@ static db::EdgePairs isolated2 (const db::Region *r, db::Region::distance_type d
                                             shielded,
                                             opposite,
                                             rect_filter,
-                                            negative)
+                                            negative,
+                                            threads)
                            );
 }
 
-static db::EdgePairs inside2 (const db::Region *r, const db::Region &other, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative)
+static db::EdgePairs inside2 (const db::Region *r, const db::Region &other, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative, unsigned int threads)
 {
   return r->inside_check (other, d, db::RegionCheckOptions (whole_edges,
                                             metrics,
@@ -552,11 +584,12 @@ static db::EdgePairs inside2 (const db::Region *r, const db::Region &other, db::
                                             shielded,
                                             opposite,
                                             rect_filter,
-                                            negative)
+                                            negative,
+                                            threads)
                          );
 }
 
-static db::EdgePairs overlap2 (const db::Region *r, const db::Region &other, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative)
+static db::EdgePairs overlap2 (const db::Region *r, const db::Region &other, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative, unsigned int threads)
 {
   return r->overlap_check (other, d, db::RegionCheckOptions (whole_edges,
                                             metrics,
@@ -566,11 +599,12 @@ static db::EdgePairs overlap2 (const db::Region *r, const db::Region &other, db:
                                             shielded,
                                             opposite,
                                             rect_filter,
-                                            negative)
+                                            negative,
+                                            threads)
                           );
 }
 
-static db::EdgePairs enclosing2 (const db::Region *r, const db::Region &other, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative)
+static db::EdgePairs enclosing2 (const db::Region *r, const db::Region &other, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative, unsigned int threads)
 {
   return r->enclosing_check (other, d, db::RegionCheckOptions (whole_edges,
                                             metrics,
@@ -580,11 +614,12 @@ static db::EdgePairs enclosing2 (const db::Region *r, const db::Region &other, d
                                             shielded,
                                             opposite,
                                             rect_filter,
-                                            negative)
+                                            negative,
+                                            threads)
                             );
 }
 
-static db::EdgePairs separation2 (const db::Region *r, const db::Region &other, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative)
+static db::EdgePairs separation2 (const db::Region *r, const db::Region &other, db::Region::distance_type d, bool whole_edges, db::metrics_type metrics, const tl::Variant &ignore_angle, const tl::Variant &min_projection, const tl::Variant &max_projection, bool shielded, db::OppositeFilter opposite, db::RectFilter rect_filter, bool negative, unsigned int threads)
 {
   return r->separation_check (other, d, db::RegionCheckOptions (whole_edges,
                                             metrics,
@@ -594,7 +629,8 @@ static db::EdgePairs separation2 (const db::Region *r, const db::Region &other,
                                             shielded,
                                             opposite,
                                             rect_filter,
-                                            negative)
+                                            negative,
+                                            threads)
                              );
 }
 
@@ -707,6 +743,21 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "This constructor has been introduced in version 0.25."
   ) +
+  constructor ("from_arrays", &new_arrays, gsi::arg ("coordinates"), gsi::arg ("contours"), gsi::arg ("polygons"),
+    "@brief Creates a region from flat coordinate arrays\n"
+    "\n"
+    "This constructor is the counterpart of \\to_arrays. The arguments are byte arrays holding the "
+    "values in native byte order. \"coordinates\" holds x and y of all contour points as database "
+    "coordinate values (32 bit integers or 64 bit integers if KLayout is built with 64 bit coordinates). \"contours\" holds the index of the first point of each contour "
+    "plus a final end index and \"polygons\" holds the index of the first contour of each polygon plus "
+    "a final end index. Both index arrays are 64 bit integers. The first contour of each polygon is "
+    "the hull, the following ones are the holes.\n"
+    "\n"
+    "In Python, any object supporting the buffer protocol can be passed, for example NumPy arrays of "
+    "type int32 and int64.\n"
+    "\n"
+    "This constructor has been introduced in version 0.27."
+  ) +
   constructor ("new", &new_si, gsi::arg ("shape_iterator"),
     "@brief Constructor from a hierarchical shape set\n"
     "\n"
@@ -1290,7 +1341,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "Merging removes overlaps and joins touching polygons.\n"
     "If the region is already merged, this method does nothing\n"
-  ) +
+  ).allow_threads () +
   method_ext ("merge", &merge_ext1, gsi::arg ("min_wc"),
     "@brief Merge the region with options\n"
     "\n"
@@ -1303,7 +1354,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "means that output is only produced if two or more polygons overlap.\n"
     "\n"
     "This method is equivalent to \"merge(false, min_wc).\n"
-  ) +
+  ).allow_threads () +
   method_ext ("merge", &merge_ext2, gsi::arg ("min_coherence"), gsi::arg ("min_wc"),
     "@brief Merge the region with options\n"
     "\n"
@@ -1316,7 +1367,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "resolved by producing separate polygons. \"min_wc\" controls whether output is only produced if multiple "
     "polygons overlap. The value specifies the number of polygons that need to overlap. A value of 2 "
     "means that output is only produced if two or more polygons overlap.\n"
-  ) +
+  ).allow_threads () +
   method ("merged", (db::Region (db::Region::*) () const) &db::Region::merged,
     "@brief Returns the merged region\n"
     "\n"
@@ -1325,7 +1376,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "Merging removes overlaps and joins touching polygons.\n"
     "If the region is already merged, this method does nothing.\n"
     "In contrast to \\merge, this method does not modify the region but returns a merged copy.\n"
-  ) +
+  ).allow_threads () +
   method_ext ("merged", &merged_ext1, gsi::arg ("min_wc"),
     "@brief Returns the merged region (with options)\n"
     "\n"
@@ -1338,7 +1389,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "This method is equivalent to \"merged(false, min_wc)\".\n"
     "\n"
     "In contrast to \\merge, this method does not modify the region but returns a merged copy.\n"
-  ) +
+  ).allow_threads () +
   method_ext ("merged", &merged_ext2, gsi::arg ("min_coherence"), gsi::arg ("min_wc"),
     "@brief Returns the merged region (with options)\n"
     "\n"
@@ -1353,7 +1404,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "means that output is only produced if two or more polygons overlap.\n"
     "\n"
     "In contrast to \\merge, this method does not modify the region but returns a merged copy.\n"
-  ) +
+  ).allow_threads () +
   method ("round_corners", &db::Region::round_corners, gsi::arg ("r_inner"), gsi::arg ("r_outer"), gsi::arg ("n"),
     "@brief Corner rounding\n"
     "@param r_inner Inner corner radius (in database units)\n"
@@ -1422,7 +1473,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "r.merge(false, 1)\n"
     "# r now is (50,-50;50,100;100,100;100,-50)\n"
     "@/code\n"
-  ) + 
+  ).allow_threads () + 
   method ("size", (db::Region & (db::Region::*) (db::Coord, unsigned int)) &db::Region::size, gsi::arg ("d"), gsi::arg ("mode"),
     "@brief Isotropic sizing (biasing)\n"
     "\n"
@@ -1431,7 +1482,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "This method is equivalent to \"size(d, d, mode)\".\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) + 
+  ).allow_threads () + 
   method_ext ("size", size_ext, gsi::arg ("d"),
     "@brief Isotropic sizing (biasing)\n"
     "\n"
@@ -1440,7 +1491,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "This method is equivalent to \"size(d, d, 2)\".\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) + 
+  ).allow_threads () + 
   method ("sized", (db::Region (db::Region::*) (db::Coord, db::Coord, unsigned int) const) &db::Region::sized, gsi::arg ("dx"), gsi::arg ("dy"), gsi::arg ("mode"),
     "@brief Returns the anisotropically sized region\n"
     "\n"
@@ -1449,7 +1500,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "This method is returns the sized region (see \\size), but does not modify self.\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) + 
+  ).allow_threads () + 
   method ("sized", (db::Region (db::Region::*) (db::Coord, unsigned int) const) &db::Region::sized, gsi::arg ("d"), gsi::arg ("mode"),
     "@brief Returns the isotropically sized region\n"
     "\n"
@@ -1458,7 +1509,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "This method is returns the sized region (see \\size), but does not modify self.\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) + 
+  ).allow_threads () + 
   method_ext ("sized", sized_ext, gsi::arg ("d"),
     "@brief Isotropic sizing (biasing)\n"
     "\n"
@@ -1467,7 +1518,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "This method is equivalent to \"sized(d, d, 2)\".\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) + 
+  ).allow_threads () + 
   method_ext ("andnot", &andnot, gsi::arg ("other"),
     "@brief Returns the boolean AND and NOT between self and the other region\n"
     "\n"
@@ -1477,7 +1528,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "Because this requires a single sweep only, using this method is faster than doing AND and NOT separately.\n"
     "\n"
     "This method has been added in version 0.27.\n"
-  ) +
+  ).allow_threads () +
   method ("&", &db::Region::operator&, gsi::arg ("other"),
     "@brief Returns the boolean AND between self and the other region\n"
     "\n"
@@ -1485,7 +1536,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "This method will compute the boolean AND (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
-  ) + 
+  ).allow_threads () + 
   method ("&=", &db::Region::operator&=, gsi::arg ("other"),
     "@brief Performs the boolean AND between self and the other region\n"
     "\n"
@@ -1493,7 +1544,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "This method will compute the boolean AND (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
-  ) + 
+  ).allow_threads () + 
   method ("-", &db::Region::operator-, gsi::arg ("other"),
     "@brief Returns the boolean NOT between self and the other region\n"
     "\n"
@@ -1501,7 +1552,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "This method will compute the boolean NOT (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
-  ) + 
+  ).allow_threads () + 
   method ("-=", &db::Region::operator-=, gsi::arg ("other"),
     "@brief Performs the boolean NOT between self and the other region\n"
     "\n"
@@ -1509,7 +1560,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "This method will compute the boolean NOT (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
-  ) + 
+  ).allow_threads () + 
   method ("^", &db::Region::operator^, gsi::arg ("other"),
     "@brief Returns the boolean NOT between self and the other region\n"
     "\n"
@@ -1517,7 +1568,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "This method will compute the boolean XOR (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
-  ) + 
+  ).allow_threads () + 
   method ("^=", &db::Region::operator^=, gsi::arg ("other"),
     "@brief Performs the boolean XOR between self and the other region\n"
     "\n"
@@ -1525,7 +1576,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "This method will compute the boolean XOR (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
-  ) + 
+  ).allow_threads () + 
   method ("\\|", &db::Region::operator|, gsi::arg ("other"),
     "@brief Returns the boolean OR between self and the other region\n"
     "\n"
@@ -1533,7 +1584,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "The boolean OR is implemented by merging the polygons of both regions. To simply join the regions "
     "without merging, the + operator is more efficient."
-  ) + 
+  ).allow_threads () + 
   method ("\\|=", &db::Region::operator|=, gsi::arg ("other"),
     "@brief Performs the boolean OR between self and the other region\n"
     "\n"
@@ -1541,7 +1592,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "The boolean OR is implemented by merging the polygons of both regions. To simply join the regions "
     "without merging, the + operator is more efficient."
-  ) + 
+  ).allow_threads () + 
   method ("+", &db::Region::operator+, gsi::arg ("other"),
     "@brief Returns the combined region of self and the other region\n"
     "\n"
@@ -2193,7 +2244,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "@return The transformed region.\n"
   ) +
-  method_ext ("width_check", &width2, gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("negative", false),
+  method_ext ("width_check", &width2, gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("negative", false), gsi::arg ("threads", (unsigned int) 0),
     "@brief Performs a width check with options\n"
     "@param d The minimum width for which the polygons are checked\n"
     "@param whole_edges If true, deliver the whole edges\n"
@@ -2203,6 +2254,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "@param max_projection The upper limit of the projected length of one edge onto another\n"
     "@param shielded Enables shielding\n"
     "@param negative If true, edges not violation the condition will be output as pseudo-edge pairs\n"
+    "@param threads The number of threads to use for flat regions (0 for none)\n"
     "\n"
     "This version is similar to the simple version with one parameter. In addition, it allows "
     "to specify many more options.\n"
@@ -2232,9 +2284,14 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
     "\n"
-    "The 'shielded' and 'negative' options have been introduced in version 0.27."
+    "The 'shielded' and 'negative' options have been introduced in version 0.27.\n"
+    "\n"
+    "\"threads\" is used for flat regions only: with two or more threads, the input is split into vertical slabs "
+    "which are checked in parallel. The result is the same, but the order of the edge pairs may differ. "
+    "Deep regions use the thread count of the \\DeepShapeStore instead. "
+    "This option has been introduced in version 0.27."
   ) +
-  method_ext ("space_check", &space2, gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false),
+  method_ext ("space_check", &space2, gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false), gsi::arg ("threads", (unsigned int) 0),
     "@brief Performs a space check with options\n"
     "@param d The minimum space for which the polygons are checked\n"
     "@param whole_edges If true, deliver the whole edges\n"
@@ -2245,6 +2302,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "@param opposite_filter Specifies a filter mode for errors happening on opposite sides of inputs shapes\n"
     "@param rect_filter Specifies an error filter for rectangular input shapes\n"
     "@param negative If true, edges not violation the condition will be output as pseudo-edge pairs\n"
+    "@param threads The number of threads to use for flat regions (0 for none)\n"
     "\n"
     "If \"whole_edges\" is true, the resulting \\EdgePairs collection will receive the whole "
     "edges which contribute in the width check.\n"
@@ -2274,9 +2332,14 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
     "\n"
-    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27."
+    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27.\n"
+    "\n"
+    "\"threads\" is used for flat regions only: with two or more threads, the input is split into vertical slabs "
+    "which are checked in parallel. The result is the same, but the order of the edge pairs may differ. "
+    "Deep regions use the thread count of the \\DeepShapeStore instead. "
+    "This option has been introduced in version 0.27."
   ) +
-  method_ext ("notch_check", &notch2, gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("negative", false),
+  method_ext ("notch_check", &notch2, gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("negative", false), gsi::arg ("threads", (unsigned int) 0),
     "@brief Performs a space check between edges of the same polygon with options\n"
     "@param d The minimum space for which the polygons are checked\n"
     "@param whole_edges If true, deliver the whole edges\n"
@@ -2286,6 +2349,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "@param max_projection The upper limit of the projected length of one edge onto another\n"
     "@param shielded Enables shielding\n"
     "@param negative If true, edges not violation the condition will be output as pseudo-edge pairs\n"
+    "@param threads The number of threads to use for flat regions (0 for none)\n"
     "\n"
     "This version is similar to the simple version with one parameter. In addition, it allows "
     "to specify many more options.\n"
@@ -2315,9 +2379,14 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
     "\n"
-    "The 'shielded' and 'negative' options have been introduced in version 0.27."
+    "The 'shielded' and 'negative' options have been introduced in version 0.27.\n"
+    "\n"
+    "\"threads\" is used for flat regions only: with two or more threads, the input is split into vertical slabs "
+    "which are checked in parallel. The result is the same, but the order of the edge pairs may differ. "
+    "Deep regions use the thread count of the \\DeepShapeStore instead. "
+    "This option has been introduced in version 0.27."
   ) +
-  method_ext ("isolated_check", &isolated2, gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false),
+  method_ext ("isolated_check", &isolated2, gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false), gsi::arg ("threads", (unsigned int) 0),
     "@brief Performs a space check between edges of different polygons with options\n"
     "@param d The minimum space for which the polygons are checked\n"
     "@param whole_edges If true, deliver the whole edges\n"
@@ -2328,6 +2397,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "@param opposite_filter Specifies a filter mode for errors happening on opposite sides of inputs shapes\n"
     "@param rect_filter Specifies an error filter for rectangular input shapes\n"
     "@param negative If true, edges not violation the condition will be output as pseudo-edge pairs\n"
+    "@param threads The number of threads to use for flat regions (0 for none)\n"
     "\n"
     "If \"whole_edges\" is true, the resulting \\EdgePairs collection will receive the whole "
     "edges which contribute in the width check.\n"
@@ -2357,9 +2427,14 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
     "\n"
-    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27."
+    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27.\n"
+    "\n"
+    "\"threads\" is used for flat regions only: with two or more threads, the input is split into vertical slabs "
+    "which are checked in parallel. The result is the same, but the order of the edge pairs may differ. "
+    "Deep regions use the thread count of the \\DeepShapeStore instead. "
+    "This option has been introduced in version 0.27."
   ) +
-  method_ext ("inside_check", &inside2, gsi::arg ("other"), gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false),
+  method_ext ("inside_check", &inside2, gsi::arg ("other"), gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false), gsi::arg ("threads", (unsigned int) 0),
     "@brief Performs an inside check with options\n"
     "@param d The minimum distance for which the polygons are checked\n"
     "@param other The other region against which to check\n"
@@ -2371,6 +2446,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "@param opposite_filter Specifies a filter mode for errors happening on opposite sides of inputs shapes\n"
     "@param rect_filter Specifies an error filter for rectangular input shapes\n"
     "@param negative If true, edges not violation the condition will be output as pseudo-edge pairs\n"
+    "@param threads The number of threads to use for flat regions (0 for none)\n"
     "\n"
     "If \"whole_edges\" is true, the resulting \\EdgePairs collection will receive the whole "
     "edges which contribute in the width check.\n"
@@ -2400,9 +2476,14 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
     "\n"
-    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27."
+    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27.\n"
+    "\n"
+    "\"threads\" is used for flat regions only: with two or more threads, the input is split into vertical slabs "
+    "which are checked in parallel. The result is the same, but the order of the edge pairs may differ. "
+    "Deep regions use the thread count of the \\DeepShapeStore instead. "
+    "This option has been introduced in version 0.27."
   ) +
-  method_ext ("overlap_check", &overlap2, gsi::arg ("other"), gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false),
+  method_ext ("overlap_check", &overlap2, gsi::arg ("other"), gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false), gsi::arg ("threads", (unsigned int) 0),
     "@brief Performs an overlap check with options\n"
     "@param d The minimum overlap for which the polygons are checked\n"
     "@param other The other region against which to check\n"
@@ -2414,6 +2495,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "@param opposite_filter Specifies a filter mode for errors happening on opposite sides of inputs shapes\n"
     "@param rect_filter Specifies an error filter for rectangular input shapes\n"
     "@param negative If true, edges not violation the condition will be output as pseudo-edge pairs\n"
+    "@param threads The number of threads to use for flat regions (0 for none)\n"
     "\n"
     "If \"whole_edges\" is true, the resulting \\EdgePairs collection will receive the whole "
     "edges which contribute in the width check.\n"
@@ -2443,9 +2525,14 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
     "\n"
-    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27."
+    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27.\n"
+    "\n"
+    "\"threads\" is used for flat regions only: with two or more threads, the input is split into vertical slabs "
+    "which are checked in parallel. The result is the same, but the order of the edge pairs may differ. "
+    "Deep regions use the thread count of the \\DeepShapeStore instead. "
+    "This option has been introduced in version 0.27."
   ) +
-  method_ext ("enclosing_check", &enclosing2, gsi::arg ("other"), gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false),
+  method_ext ("enclosing_check", &enclosing2, gsi::arg ("other"), gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false), gsi::arg ("threads", (unsigned int) 0),
     "@brief Performs an enclosing check with options\n"
     "@param d The minimum enclosing distance for which the polygons are checked\n"
     "@param other The other region against which to check\n"
@@ -2457,6 +2544,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "@param opposite_filter Specifies a filter mode for errors happening on opposite sides of inputs shapes\n"
     "@param rect_filter Specifies an error filter for rectangular input shapes\n"
     "@param negative If true, edges not violation the condition will be output as pseudo-edge pairs\n"
+    "@param threads The number of threads to use for flat regions (0 for none)\n"
     "\n"
     "If \"whole_edges\" is true, the resulting \\EdgePairs collection will receive the whole "
     "edges which contribute in the width check.\n"
@@ -2486,9 +2574,14 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
     "\n"
-    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27."
+    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27.\n"
+    "\n"
+    "\"threads\" is used for flat regions only: with two or more threads, the input is split into vertical slabs "
+    "which are checked in parallel. The result is the same, but the order of the edge pairs may differ. "
+    "Deep regions use the thread count of the \\DeepShapeStore instead. "
+    "This option has been introduced in version 0.27."
   ) +
-  method_ext ("separation_check", &separation2, gsi::arg ("other"), gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false),
+  method_ext ("separation_check", &separation2, gsi::arg ("other"), gsi::arg ("d"), gsi::arg ("whole_edges", false), gsi::arg ("metrics", db::metrics_type::Euclidian, "Euclidian"), gsi::arg ("ignore_angle", tl::Variant (), "default"), gsi::arg ("min_projection", tl::Variant (), "0"), gsi::arg ("max_projection", tl::Variant (), "max"), gsi::arg ("shielded", true), gsi::arg ("opposite_filter", db::NoOppositeFilter, "NoOppositeFilter"), gsi::arg ("rect_filter", db::NoSideAllowed, "NoSideAllowed"), gsi::arg ("negative", false), gsi::arg ("threads", (unsigned int) 0),
     "@brief Performs a separation check with options\n"
     "@param d The minimum separation for which the polygons are checked\n"
     "@param other The other region against which to check\n"
@@ -2500,6 +2593,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "@param opposite_filter Specifies a filter mode for errors happening on opposite sides of inputs shapes\n"
     "@param rect_filter Specifies an error filter for rectangular input shapes\n"
     "@param negative If true, edges not violation the condition will be output as pseudo-edge pairs\n"
+    "@param threads The number of threads to use for flat regions (0 for none)\n"
     "\n"
     "If \"whole_edges\" is true, the resulting \\EdgePairs collection will receive the whole "
     "edges which contribute in the width check.\n"
@@ -2529,7 +2623,12 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
     "\n"
-    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27."
+    "The 'shielded', 'negative', 'not_opposite' and 'rect_sides' options have been introduced in version 0.27.\n"
+    "\n"
+    "\"threads\" is used for flat regions only: with two or more threads, the input is split into vertical slabs "
+    "which are checked in parallel. The result is the same, but the order of the edge pairs may differ. "
+    "Deep regions use the thread count of the \\DeepShapeStore instead. "
+    "This option has been introduced in version 0.27."
   ) +
   method_ext ("area", &area1,
     "@brief The area of the region\n"
@@ -2616,7 +2715,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "The \\each iterator is the more general approach to access the polygons."
   ) +
-  method ("flatten", &db::Region::flatten,
+  method ("flatten", (db::Region &(db::Region::*) ()) &db::Region::flatten,
     "@brief Explicitly flattens a region\n"
     "\n"
     "If the region is already flat (i.e. \\has_valid_polygons? returns true), this method will "
@@ -2626,6 +2725,30 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "This method has been introduced in version 0.26."
   ) +
+  method ("flatten", (db::Region &(db::Region::*) (unsigned int)) &db::Region::flatten, gsi::arg ("threads"),
+    "@brief Explicitly flattens a region using multiple threads\n"
+    "\n"
+    "For regions taken from a layout (see \\new with a \\RecursiveShapeIterator), the area is split "
+    "into a grid of chunks and the shapes of the chunks are collected on \"threads\" worker threads. "
+    "The result is the same as with \\flatten, but the order of the polygons may differ. "
+    "With \"threads\" being 0 or for other regions, this method is equivalent to \\flatten.\n"
+    "\n"
+    "Returns 'self', so this method can be used in a dot concatenation.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("to_arrays", &to_arrays,
+    "@brief Exports the polygons into flat coordinate arrays\n"
+    "\n"
+    "This method delivers three byte arrays: the coordinates, the contour indexes and the polygon indexes. "
+    "See \\from_arrays for a description of the format. This representation avoids creating one object "
+    "per polygon. In Python, the arrays can be turned into NumPy arrays without copying, e.g. with "
+    "\"numpy.frombuffer(coordinates, dtype = numpy.int32)\".\n"
+    "\n"
+    "Merged semantics does not apply - the raw polygons are delivered.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   method ("has_valid_polygons?", &db::Region::has_valid_polygons,
     "@brief Returns true if the region is flat and individual polygons can be accessed randomly\n"
     "\n"
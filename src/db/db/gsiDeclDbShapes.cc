@@ -30,6 +30,7 @@
 #include "dbRegion.h"
 #include "dbEdgePairs.h"
 #include "dbEdges.h"
+#include "dbPolygonArrays.h"
 
 namespace gsi
 {
@@ -315,6 +316,30 @@ static void insert_region_with_dtrans (db::Shapes *sh, const db::Region &r, cons
   }
 }
 
+static std::vector<std::vector<char> > to_polygon_arrays (const db::Shapes *sh)
+{
+  db::PolygonArrays arrays;
+  for (db::Shapes::shape_iterator s = sh->begin (db::ShapeIterator::Polygons | db::ShapeIterator::Boxes | db::ShapeIterator::Paths); ! s.at_end (); ++s) {
+    db::Polygon poly;
+    s->polygon (poly);
+    arrays.add (poly);
+  }
+
+  std::vector<std::vector<char> > res;
+  res.push_back (values_to_bytes (arrays.coordinates ()));
+  res.push_back (values_to_bytes (arrays.contours ()));
+  res.push_back (values_to_bytes (arrays.polygons ()));
+  return res;
+}
+
+static void insert_polygon_arrays (db::Shapes *sh, const std::vector<char> &coordinates, const std::vector<char> &contours, const std::vector<char> &polygons)
+{
+  db::PolygonArrays arrays (values_from_bytes<db::Coord> (coordinates), values_from_bytes<db::PolygonArrays::index_type> (contours), values_from_bytes<db::PolygonArrays::index_type> (polygons));
+  for (size_t i = 0; i < arrays.size (); ++i) {
+    sh->insert (arrays.polygon (i));
+  }
+}
+
 static void insert_edges (db::Shapes *sh, const db::Edges &r)
 {
   for (db::Edges::const_iterator s = r.begin (); ! s.at_end (); ++s) {
@@ -544,6 +569,26 @@ Class<db::Shapes> decl_Shapes ("db", "Shapes",
     "\n"
     "This method has been introduced in version 0.25.3.\n"
   ) +
+  gsi::method_ext ("to_polygon_arrays", &to_polygon_arrays,
+    "@brief Exports the polygons, boxes and paths of this shape container into flat coordinate arrays\n"
+    "\n"
+    "Boxes and paths are converted to polygons. This method delivers three byte arrays: "
+    "the coordinates, the contour indexes and the polygon indexes. See \\Region#from_arrays for a "
+    "description of the format. This representation avoids creating one object per shape. "
+    "In Python, the arrays can be turned into NumPy arrays without copying, e.g. with "
+    "\"numpy.frombuffer(coordinates, dtype = numpy.int32)\".\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method_ext ("insert_polygon_arrays", &insert_polygon_arrays, gsi::arg ("coordinates"), gsi::arg ("contours"), gsi::arg ("polygons"),
+    "@brief Inserts polygons from flat coordinate arrays\n"
+    "\n"
+    "This method is the counterpart of \\to_polygon_arrays. See \\Region#from_arrays for a "
+    "description of the format. In Python, any object supporting the buffer protocol can be passed, for "
+    "example NumPy arrays of type int32 and int64.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   gsi::method_ext ("insert", &insert_region, gsi::arg ("region"),
     "@brief Inserts the polygons from the region into this shape container\n"
     "@param region The region to insert\n"
@@ -91,7 +91,8 @@ public:
 
   virtual void begin (size_t nx, size_t ny, const db::DPoint &p0, double dx, double dy, const db::DBox &frame)
   { 
-    m_mt_mode = (processor () && processor ()->threads () >= 1);
+    //  NOTE: in multi-process mode, the results are received in separate threads too
+    m_mt_mode = (processor () && (processor ()->threads () >= 1 || processor ()->processes () >= 1));
     m_events.clear ();
     if (begin_cb.can_issue ()) {
       begin_cb.issue<db::TileOutputReceiver, size_t, size_t, const db::DPoint &, double, double, const db::DBox &> (&db::TileOutputReceiver::begin, nx, ny, p0, dx, dy, frame);
@@ -224,6 +225,65 @@ gsi::Class<TileOutputReceiver_Impl> decl_TileOutputReceiver (decl_TileOutputRece
   "This class has been introduced in version 0.23.\n"
 );
 
+static db::TileStreamWriter *new_tile_stream_writer (const std::string &path, double dbu, const std::string &top_cell, bool per_tile, const db::SaveLayoutOptions &options)
+{
+  return new db::TileStreamWriter (path, dbu, top_cell, per_tile ? db::TileStreamWriter::CellPerTile : db::TileStreamWriter::Merged, options);
+}
+
+gsi::Class<db::TileStreamWriter> decl_TileStreamWriter (decl_TileOutputReceiverBase, "db", "TileStreamWriter",
+  gsi::constructor ("new", &new_tile_stream_writer, gsi::arg ("path"), gsi::arg ("dbu"), gsi::arg ("top_cell", std::string ("TOP")), gsi::arg ("per_tile", true), gsi::arg ("options", db::SaveLayoutOptions (), "default"),
+    "@brief Creates a new writer for the given file\n"
+    "\n"
+    "@param path The path of the file to write\n"
+    "@param dbu The database unit of the file\n"
+    "@param top_cell The name of the top cell\n"
+    "@param per_tile If true, each tile's results are written into a separate cell. Otherwise all results go into the top cell.\n"
+    "@param options The options for the writer. If no format is given, the format is derived from the file name.\n"
+    "\n"
+    "The file is opened immediately. The format must be GDS2 or OASIS."
+  ) +
+  gsi::method ("close", &db::TileStreamWriter::close,
+    "@brief Completes and closes the file\n"
+    "This method writes the top cell and the end of the file. After the file is closed, no more data can be delivered to the writer."
+  ) +
+  gsi::method ("is_open?", &db::TileStreamWriter::is_open,
+    "@brief Returns true if the file has not been closed yet\n"
+  ) +
+  gsi::method ("tile_cells", &db::TileStreamWriter::tile_cells,
+    "@brief Returns the number of tile cells written so far\n"
+  ),
+  "@brief A tile output receiver which writes the results directly into a layout file\n"
+  "\n"
+  "This receiver writes the tiling processor's results into a GDS2 or OASIS file as the tiles are computed. "
+  "Hence the results do not need to be kept in memory. "
+  "Use \\TilingProcessor#output with a \\LayerInfo object to establish an output channel to a layer of the file. "
+  "One writer can serve multiple output channels and multiple runs of a tiling processor. The file is "
+  "completed when \\close is called or the object is destroyed.\n"
+  "\n"
+  "In per-tile mode, the results of a tile are written into a cell named \"TILE_<ix>_<iy>\" which is placed in the top cell. "
+  "If tiles are delivered interleaved (e.g. when multiple threads are used), the results of a tile may be split "
+  "into several cells. In merged mode, all results are written to the top cell directly. Properties "
+  "are not written.\n"
+  "\n"
+  "@code\n"
+  "writer = RBA::TileStreamWriter::new(\"out.oas\", layout.dbu)\n"
+  "tp = RBA::TilingProcessor::new\n"
+  "tp.input(\"the_input\", layout.begin_shapes(cell, layer))\n"
+  "tp.tile_size(100, 100)\n"
+  "tp.output(\"out\", writer, RBA::LayerInfo::new(100, 0))\n"
+  "tp.queue(\"_output(out, the_input.sized(10))\")\n"
+  "tp.execute(\"Job description\")\n"
+  "writer.close\n"
+  "@/code\n"
+  "\n"
+  "This class has been introduced in version 0.27.\n"
+);
+
+static void tp_output_stream_writer (db::TilingProcessor *proc, const std::string &name, db::TileStreamWriter *writer, const db::LayerProperties &lp)
+{
+  proc->output (name, *writer, lp);
+}
+
 static void tp_output (db::TilingProcessor *proc, const std::string &name, db::TileOutputReceiver *rec)
 {
   rec->gsi::ObjectBase::keep ();
@@ -265,6 +325,25 @@ static void tp_output_double (db::TilingProcessor *proc, const std::string &name
   proc->output (name, 0, new DoubleCollectingTileOutputReceiver (v), db::ICplxTrans ());
 }
 
+static std::vector<tl::Variant> tp_tile_statistics (const db::TilingProcessor *proc)
+{
+  std::vector<tl::Variant> res;
+
+  const std::vector<db::TileStatistics> &stat = proc->tile_statistics ();
+  for (std::vector<db::TileStatistics>::const_iterator s = stat.begin (); s != stat.end (); ++s) {
+    res.push_back (tl::Variant::empty_list ());
+    tl::Variant &e = res.back ();
+    e.push (tl::Variant (s->ix));
+    e.push (tl::Variant (s->iy));
+    e.push (tl::Variant (s->box));
+    e.push (tl::Variant (s->script_index));
+    e.push (tl::Variant (s->estimated_count));
+    e.push (tl::Variant (s->seconds));
+  }
+
+  return res;
+}
+
 static void tp_input2 (db::TilingProcessor *proc, const std::string &name, const db::RecursiveShapeIterator &iter)
 {
   proc->input (name, iter);
@@ -529,6 +608,14 @@ Class<db::TilingProcessor> decl_TilingProcessor ("db", "TilingProcessor",
     "tp.execute(\"Job description\")\n"
     "@/code\n"
   ) + 
+  method_ext ("output", &tp_output_stream_writer, gsi::arg ("name"), gsi::arg ("writer"), gsi::arg ("lp"),
+    "@brief Specifies output to a layer of a file written directly\n"
+    "This method will establish an output channel to a \\TileStreamWriter object. The output sent to that channel "
+    "will be written to the given layer of the writer's file as the tiles are computed.\n"
+    "The writer is not owned by the processor and can be used for multiple outputs and multiple runs.\n"
+    "\n"
+    "This variant has been introduced in version 0.27.\n"
+  ) +
   method_ext ("output", &tp_output_layout1, gsi::arg ("name"), gsi::arg ("layout"), gsi::arg ("cell"), gsi::arg ("lp"),
     "@brief Specifies output to a layout layer\n"
     "This method will establish an output channel to a layer in a layout. The output sent to that channel "
@@ -681,12 +768,93 @@ Class<db::TilingProcessor> decl_TilingProcessor ("db", "TilingProcessor",
     "\n"
     "The tile border is given in micron.\n"
   ) + 
+  method ("adaptive=", &db::TilingProcessor::set_adaptive, gsi::arg ("flag"),
+    "@brief Enables or disables adaptive tiling\n"
+    "\n"
+    "In adaptive mode, the tiles are subdivided further (quadtree style) where the estimated number of input shapes is high. "
+    "The estimate is obtained from a cheap hierarchical shape count. This way, dense areas are split into smaller tiles "
+    "and the tiles will require a similar amount of work. The tiles are executed with the largest ones first.\n"
+    "\n"
+    "In adaptive mode, the tile indexes passed to \\TileOutputReceiver#put refer to the lower left cell of the tile in the grid "
+    "of the smallest tiles. This grid is finer than the regular tile grid by a power of two. If no tile is subdivided, it is "
+    "identical to the regular grid and the indexes are the same as in non-adaptive mode. \\TileOutputReceiver#begin receives the "
+    "dimensions of that grid. The tile box passed to \\TileOutputReceiver#put is the actual tile.\n"
+    "\n"
+    "Adaptive tiling needs a tile size or tile count to be specified.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method ("adaptive?", &db::TilingProcessor::adaptive,
+    "@brief Gets a value indicating whether adaptive tiling is enabled\n"
+    "See \\adaptive= for details about this feature.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method ("adaptive_threshold=", &db::TilingProcessor::set_adaptive_threshold, gsi::arg ("n"),
+    "@brief Sets the minimum estimated shape count for a tile to be subdivided in adaptive mode\n"
+    "Tiles with fewer shapes are not subdivided as they are cheap anyway. The default value is 10000.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method ("adaptive_threshold", &db::TilingProcessor::adaptive_threshold,
+    "@brief Gets the minimum estimated shape count for a tile to be subdivided in adaptive mode\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("tile_statistics", &tp_tile_statistics,
+    "@brief Gets the execution statistics of the last run\n"
+    "This method delivers one entry per tile and script. Each entry is an array with the tile indexes "
+    "(ix and iy), the tile box in micrometer units (a \\DBox), the script index, the estimated shape count "
+    "(adaptive mode only, 0 otherwise) and the time spent on the tile in seconds.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   method ("threads=", &db::TilingProcessor::set_threads, gsi::arg ("n"),
     "@brief Specifies the number of threads to use\n"
   ) + 
   method ("threads", &db::TilingProcessor::threads,
     "@brief Gets the number of threads to use\n"
   ) + 
+  method ("processes=", &db::TilingProcessor::set_processes, gsi::arg ("n"),
+    "@brief Specifies the number of worker processes to use\n"
+    "\n"
+    "If this number is non-zero, the tiles are distributed over the given number of worker processes "
+    "instead of being executed by threads of the current process. Each worker process may use multiple threads "
+    "itself (see \\threads=). The workers receive their input through files in a temporary directory: "
+    "inputs taken from layouts are written as an OASIS snapshot once, other inputs are transferred per tile. "
+    "The results are sent back to this processor and delivered to the receivers as usual.\n"
+    "\n"
+    "By default, the workers are started locally with the 'strmtile' tool of the installation. "
+    "See \\worker_command= for a way to use a different command - for example one which starts the workers on other machines. "
+    "The temporary directory is created in the location given by the TMPDIR environment variable. "
+    "If workers run on other machines, this location needs to be shared.\n"
+    "\n"
+    "In multi-process mode, the '_rec' function is not available in the scripts. "
+    "The multi-process mode is effective only if tiles are used.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method ("processes", &db::TilingProcessor::processes,
+    "@brief Gets the number of worker processes to use\n"
+    "See \\processes= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method ("worker_command=", &db::TilingProcessor::set_worker_command, gsi::arg ("command"),
+    "@brief Specifies the command to start a worker process\n"
+    "\n"
+    "The path of the job file is appended to this command. The command is executed by the shell and "
+    "is supposed to run the 'strmtile' tool on the job file and deliver it's standard output. "
+    "An empty string selects the 'strmtile' tool of the installation (the default).\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method ("worker_command", &db::TilingProcessor::worker_command,
+    "@brief Gets the command to start a worker process\n"
+    "See \\worker_command= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   method ("queue", &db::TilingProcessor::queue, gsi::arg ("script"),
     "@brief Queues a script for parallel execution\n"
     "\n"
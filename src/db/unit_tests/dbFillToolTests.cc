@@ -0,0 +1,178 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlUnitTest.h"
+
+#include "dbFillTool.h"
+#include "dbRegion.h"
+#include "dbLayout.h"
+#include "dbCell.h"
+#include "dbRecursiveShapeIterator.h"
+
+#include <cstdlib>
+
+namespace
+{
+
+struct FillSetup
+{
+  FillSetup ()
+  {
+    layout.insert_layer (0, db::LayerProperties (1, 0));
+    top = &layout.cell (layout.add_cell ("TOP"));
+    fill_cell = &layout.cell (layout.add_cell ("FILL"));
+    fc_box = db::Box (0, 0, 100, 200);
+    fill_cell->shapes (0).insert (fc_box);
+  }
+
+  db::Region flat_fill () const
+  {
+    return db::Region (db::RecursiveShapeIterator (layout, *top, 0));
+  }
+
+  size_t instances () const
+  {
+    size_t n = 0;
+    for (db::Cell::const_iterator i = top->begin (); ! i.at_end (); ++i) {
+      ++n;
+    }
+    return n;
+  }
+
+  db::Layout layout;
+  db::Cell *top, *fill_cell;
+  db::Box fc_box;
+};
+
+}
+
+TEST(1_Basic)
+{
+  FillSetup fs;
+
+  db::Region fr;
+  fr.insert (db::Polygon (db::Box (0, 0, 1000, 1000)));
+  fr.insert (db::Polygon (db::Box (2000, 0, 2250, 1000)));
+
+  db::Region remaining_parts, remaining_polygons;
+  fr.insert (db::Polygon (db::Box (3000, 0, 3050, 1000)));
+
+  db::fill_region (fs.top, fr, fs.fill_cell->cell_index (), fs.fc_box, db::Point (), false, &remaining_parts, db::Vector (), &remaining_polygons);
+
+  //  the regular blocks are represented by arrays
+  EXPECT_EQ (fs.instances (), size_t (2));
+  EXPECT_EQ (fs.flat_fill ().merged ().to_string (), "(0,0;0,1000;1000,1000;1000,0);(2000,0;2000,1000;2200,1000;2200,0)");
+  EXPECT_EQ (fs.flat_fill ().count (), size_t (60));
+  EXPECT_EQ (remaining_parts.to_string (), "(2200,0;2200,1000;2250,1000;2250,0)");
+  EXPECT_EQ (remaining_polygons.to_string (), "(3000,0;3000,1000;3050,1000;3050,0)");
+}
+
+TEST(2_RepeatedPolygonsAndThreads)
+{
+  db::Region fr;
+
+  srand (1);
+
+  //  many identical polygons (with respect to the fill raster) plus random ones
+  for (int i = 0; i < 200; ++i) {
+    db::Coord x = (rand () % 200) * 1000;
+    db::Coord y = (rand () % 200) * 1000;
+    if (i % 2 == 0) {
+      db::Point pts[] = { db::Point (0, 0), db::Point (0, 700), db::Point (300, 700), db::Point (300, 350), db::Point (650, 350), db::Point (650, 0) };
+      db::Polygon p;
+      p.assign_hull (pts, pts + sizeof (pts) / sizeof (pts [0]));
+      fr.insert (p.moved (db::Vector (x, y)));
+    } else {
+      fr.insert (db::Polygon (db::Box (x, y, x + 100 + rand () % 800, y + 200 + rand () % 800)));
+    }
+  }
+
+  for (int enhanced = 0; enhanced < 2; ++enhanced) {
+
+    FillSetup fs1, fs2;
+    db::Region rp1, rp2, rpoly1, rpoly2;
+
+    db::fill_region (fs1.top, fr, fs1.fill_cell->cell_index (), fs1.fc_box, db::Point (50, 0), enhanced != 0, &rp1, db::Vector (10, 10), &rpoly1, 0);
+    db::fill_region (fs2.top, fr, fs2.fill_cell->cell_index (), fs2.fc_box, db::Point (50, 0), enhanced != 0, &rp2, db::Vector (10, 10), &rpoly2, 4);
+
+    EXPECT_EQ (fs1.instances () > 0, true);
+    EXPECT_EQ (fs1.instances (), fs2.instances ());
+    EXPECT_EQ ((fs1.flat_fill () ^ fs2.flat_fill ()).empty (), true);
+    EXPECT_EQ (fs1.flat_fill ().count (), fs2.flat_fill ().count ());
+    EXPECT_EQ ((rp1 ^ rp2).empty (), true);
+    EXPECT_EQ ((rpoly1 ^ rpoly2).empty (), true);
+
+    //  the fill cells are inside the fill region
+    EXPECT_EQ ((fs1.flat_fill () - fr).empty (), true);
+
+    //  the fill (plus margin) and the remaining parts cover the fill region
+    EXPECT_EQ ((fr - fs1.flat_fill ().sized (10) - rp1 - rpoly1).empty (), true);
+
+  }
+
+  //  in raster mode, the fill cells are on the raster given by the origin
+  FillSetup fs;
+  db::fill_region (fs.top, fr, fs.fill_cell->cell_index (), fs.fc_box, db::Point (50, 0), false, 0, db::Vector (), 0, 4);
+  db::Region fill = fs.flat_fill ();
+  bool on_raster = true;
+  for (db::Region::const_iterator p = fill.begin (); ! p.at_end (); ++p) {
+    db::Box b = p->box ();
+    if ((b.left () - 50) % 100 != 0 || b.bottom () % 200 != 0) {
+      on_raster = false;
+    }
+  }
+  EXPECT_EQ (on_raster, true);
+}
+
+TEST(3_Origin)
+{
+  FillSetup fs1;
+
+  db::Region fr;
+  db::Point pts1[] = { db::Point (0, 0), db::Point (500, 500), db::Point (500, 0) };
+  db::Polygon p1;
+  p1.assign_hull (pts1, pts1 + sizeof (pts1) / sizeof (pts1 [0]));
+  fr.insert (p1);
+
+  db::fill_region (fs1.top, fr, fs1.fill_cell->cell_index (), fs1.fc_box, db::Point (), false);
+
+  EXPECT_EQ (fs1.flat_fill ().count (), size_t (4));
+  EXPECT_EQ (fs1.flat_fill ().merged ().to_string (), "(200,0;200,200;400,200;400,400;500,400;500,0)");
+
+  FillSetup fs2;
+
+  fr.clear ();
+  db::Point pts2[] = { db::Point (0, 0), db::Point (200, 0), db::Point (200, -50), db::Point (400, -50), db::Point (400, 150), db::Point (200, 150), db::Point (200, 400), db::Point (0, 400) };
+  db::Polygon p2;
+  p2.assign_hull (pts2, pts2 + sizeof (pts2) / sizeof (pts2 [0]));
+  fr.insert (p2);
+
+  db::fill_region (fs2.top, fr, fs2.fill_cell->cell_index (), fs2.fc_box, db::Point (), true);
+
+  db::Region expected;
+  expected.insert (db::Box (0, 150, 200, 350));
+  expected.insert (db::Box (200, -50, 400, 150));
+
+  EXPECT_EQ (fs2.flat_fill ().count (), size_t (4));
+  EXPECT_EQ ((fs2.flat_fill () ^ expected).empty (), true);
+}
@@ -1477,3 +1477,97 @@ TEST(7)
 }
 
 
+
+//  Multi-threaded compare and unchanged layer shortcut
+TEST(8)
+{
+  db::Layout g;
+  g.insert_layer (0);
+  g.set_properties (0, db::LayerProperties (17, 0));
+  g.insert_layer (1);
+  g.set_properties (1, db::LayerProperties (42, 1));
+
+  db::PropertiesRepository::properties_set ps;
+  ps.insert (std::make_pair (g.properties_repository ().prop_name_id (tl::Variant (1)), tl::Variant ("x")));
+  db::properties_id_type pid = g.properties_repository ().properties_id (ps);
+
+  std::vector<db::cell_index_type> cells;
+  for (unsigned int i = 0; i < 20; ++i) {
+
+    db::cell_index_type ci = g.add_cell (("C" + tl::to_string (i)).c_str ());
+    db::Cell &c = g.cell (ci);
+
+    for (unsigned int j = 0; j < 50; ++j) {
+      c.shapes (0).insert (db::Box (j * 10, i, j * 10 + 5, i + 100));
+      c.shapes (1).insert (db::BoxWithProperties (db::Box (j * 10, i, j * 10 + 5, i + 100), pid));
+      db::Point pts[] = { db::Point (j, 0), db::Point (j, 100), db::Point (j + 10, 200), db::Point (j + 20, 0) };
+      db::Polygon poly;
+      poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts[0]));
+      c.shapes (1).insert (poly);
+    }
+    c.shapes (0).insert (db::Text ("T" + tl::to_string (i), db::Trans (db::Vector (i, 0)), 5));
+
+    if (! cells.empty ()) {
+      c.insert (db::CellInstArray (db::CellInst (cells.back ()), db::Trans (db::Vector (0, 1000))));
+    }
+    cells.push_back (ci);
+
+  }
+
+  db::Layout h = g;
+
+  TestDifferenceReceiver r;
+  bool eq;
+
+  r.clear ();
+  eq = db::compare_layouts (g, h, db::layout_diff::f_verbose, 0, r, 4);
+
+  EXPECT_EQ (eq, true);
+  EXPECT_EQ (r.text (), "");
+
+  //  a text size change is a difference (the shortcut must see it)
+  h.cell (cells [3]).shapes (0).clear ();
+  for (unsigned int j = 0; j < 50; ++j) {
+    h.cell (cells [3]).shapes (0).insert (db::Box (j * 10, 3, j * 10 + 5, 103));
+  }
+  h.cell (cells [3]).shapes (0).insert (db::Text ("T3", db::Trans (db::Vector (3, 0)), 6));
+
+  //  a shape with different properties
+  h.cell (cells [7]).shapes (1).insert (db::Box (0, 7, 5, 107));
+
+  //  a shape on a different position
+  h.cell (cells [15]).shapes (0).insert (db::Box (1, 2, 3, 4));
+
+  //  an instance difference
+  h.cell (cells [11]).insert (db::CellInstArray (db::CellInst (cells [0]), db::Trans ()));
+
+  r.clear ();
+  eq = db::compare_layouts (g, h, db::layout_diff::f_verbose, 0, r);
+
+  EXPECT_EQ (eq, false);
+  std::string serial = r.text ();
+  EXPECT_NE (serial.find ("texts differ for layer 17/0 in cell C3"), std::string::npos);
+  EXPECT_NE (serial.find ("boxes differ for layer 42/1 in cell C7"), std::string::npos);
+  EXPECT_NE (serial.find ("boxes differ for layer 17/0 in cell C15"), std::string::npos);
+  EXPECT_NE (serial.find ("instances differ in cell C11"), std::string::npos);
+
+  for (int threads = 1; threads <= 4; ++threads) {
+
+    r.clear ();
+    eq = db::compare_layouts (g, h, db::layout_diff::f_verbose, 0, r, threads);
+
+    EXPECT_EQ (eq, false);
+    EXPECT_EQ (r.text (), serial);
+
+    r.clear ();
+    eq = db::compare_layouts (g, h, 0, 0, r, threads);
+
+    EXPECT_EQ (eq, false);
+
+    r.clear ();
+    eq = db::compare_layouts (g, h, db::layout_diff::f_silent, 0, r, threads);
+
+    EXPECT_EQ (eq, false);
+
+  }
+}
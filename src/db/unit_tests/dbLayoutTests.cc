@@ -640,3 +640,331 @@ TEST(6)
     EXPECT_EQ (l2s (l), "begin_lib 0.001\nbegin_cell {CIRCLE}\nboundary 1 0 {-2071 -5000} {-5000 -2071} {-5000 2071} {-2071 5000} {2071 5000} {5000 2071} {5000 -2071} {2071 -5000} {-2071 -5000}\nend_cell\nend_lib\n");
   }
 }
+
+namespace
+{
+
+class UsedMemoryCollector
+  : public db::MemStatistics
+{
+public:
+  UsedMemoryCollector () : used (0) { }
+
+  virtual void add (const std::type_info & /*ti*/, void * /*ptr*/, size_t /*size*/, size_t u, void * /*parent*/, purpose_t /*purpose*/, int /*cat*/)
+  {
+    used += u;
+  }
+
+  size_t used;
+};
+
+}
+
+static std::string compact_polygons (const db::Shapes &shapes)
+{
+  std::string r;
+  for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::Polygons); ! s.at_end (); ++s) {
+    if (s->type () == db::Shape::PolygonRef) {
+      r += s->polygon_ref ().obj ().is_compact () ? "1" : "0";
+    }
+  }
+  for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::Polygons); ! s.at_end (); ++s) {
+    if (s->type () == db::Shape::Polygon) {
+      r += s->polygon ().is_compact () ? "1" : "0";
+    }
+  }
+  return r;
+}
+
+TEST(7)
+{
+  //  Compact polygon representation
+  db::Layout l;
+  unsigned int l1 = l.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = l.insert_layer (db::LayerProperties (2, 0));
+  db::Cell &top = l.cell (l.add_cell ("TOP"));
+
+  for (int i = 0; i < 10; ++i) {
+
+    std::vector<db::Point> pts;
+    for (int j = 0; j < 100; ++j) {
+      pts.push_back (db::Point (i * 100000 + j * 10, 5000 + (j % 2) * 7 + j));
+    }
+    pts.push_back (db::Point (i * 100000 + 1000, 0));
+    pts.push_back (db::Point (i * 100000, 0));
+
+    db::Polygon poly;
+    poly.assign_hull (pts.begin (), pts.end ());
+
+    top.shapes (l1).insert (poly);
+    top.shapes (l2).insert (db::PolygonRef (poly, l.shape_repository ()));
+    top.shapes (l2).insert (db::PolygonWithProperties (poly, 1));
+
+  }
+
+  std::string s = l2s (l);
+
+  UsedMemoryCollector m;
+  l.mem_stat (&m, db::MemStatistics::LayoutInfo, 0);
+
+  l.compact_polygons (l1);
+  EXPECT_EQ (compact_polygons (top.shapes (l1)), "1111111111");
+  EXPECT_EQ (compact_polygons (top.shapes (l2)), "0000000000" "0000000000");
+
+  l.compact_polygons ();
+  EXPECT_EQ (compact_polygons (top.shapes (l2)), "1111111111" "1111111111");
+
+  EXPECT_EQ (l2s (l), s);
+
+  UsedMemoryCollector mc;
+  l.mem_stat (&mc, db::MemStatistics::LayoutInfo, 0);
+  EXPECT_EQ (mc.used * 2 < m.used, true);
+  EXPECT_EQ (l.polygon_arena ().used () > 0, true);
+
+  //  the box trees are still valid
+  size_t n = 0;
+  for (db::ShapeIterator s = top.shapes (l2).begin_touching (db::Box (200000, 0, 200010, 10), db::ShapeIterator::All); ! s.at_end (); ++s) {
+    ++n;
+  }
+  EXPECT_EQ (n, size_t (2));
+
+  //  the arena is released with the layout's content
+  l.clear ();
+  EXPECT_EQ (l.polygon_arena ().used (), size_t (0));
+}
+
+TEST(8)
+{
+  //  Cached shape counts
+  db::Layout l;
+  unsigned int l1 = l.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = l.insert_layer (db::LayerProperties (2, 0));
+  db::Cell &top = l.cell (l.add_cell ("TOP"));
+  db::Cell &child = l.cell (l.add_cell ("CHILD"));
+
+  child.shapes (l1).insert (db::Box (0, 0, 100, 100));
+  child.shapes (l1).insert (db::Box (0, 200, 100, 300));
+  child.shapes (l1).insert (db::Shape::box_array_type (db::Box (0, 0, 10, 10), db::UnitTrans (), db::Vector (0, 100), db::Vector (100, 0), 3, 2));
+  child.shapes (l2).insert (db::Text ("A", db::Trans ()));
+  top.shapes (l1).insert (db::Polygon (db::Box (0, 0, 1000, 1000)));
+
+  top.insert (db::CellInstArray (db::CellInst (child.cell_index ()), db::Trans ()));
+  db::Instance ai = top.insert (db::CellInstArray (db::CellInst (child.cell_index ()), db::Trans (), db::Vector (0, 1000), db::Vector (1000, 0), 2, 2));
+
+  db::ShapeCounts sc = l.shape_counts (child.cell_index (), l1);
+  EXPECT_EQ (sc.total (), size_t (8));
+  EXPECT_EQ (sc.single (db::ShapeCounts::Boxes), size_t (2));
+  EXPECT_EQ (sc.arrays (db::ShapeCounts::Boxes), size_t (1));
+  EXPECT_EQ (sc.total (db::ShapeCounts::Boxes), size_t (8));
+  EXPECT_EQ (sc.total (db::ShapeCounts::Polygons), size_t (0));
+  EXPECT_EQ (l.shape_count (top.cell_index (), l1), size_t (1));
+  EXPECT_EQ (l.shape_count (child.cell_index (), l2), size_t (1));
+
+  EXPECT_EQ (l.cell_multiplicity (top.cell_index ()), size_t (1));
+  EXPECT_EQ (l.cell_multiplicity (child.cell_index ()), size_t (5));
+
+  EXPECT_EQ (l.flat_shape_count (top.cell_index (), l1), size_t (41));
+  EXPECT_EQ (l.flat_shape_count (child.cell_index (), l1), size_t (8));
+  EXPECT_EQ (l.flat_shape_count (top.cell_index (), l2), size_t (5));
+
+  std::vector<size_t> fc = l.flat_shape_counts (l1);
+  EXPECT_EQ (fc.size (), size_t (2));
+  EXPECT_EQ (fc [top.cell_index ()], size_t (41));
+  EXPECT_EQ (fc [child.cell_index ()], size_t (8));
+
+  EXPECT_EQ (l.shape_counts (l1, false).total (), size_t (9));
+  EXPECT_EQ (l.shape_counts (l1, true).total (), size_t (41));
+  EXPECT_EQ (l.shape_counts (l1, true).arrays (db::ShapeCounts::Boxes), size_t (5));
+  EXPECT_EQ (l.shape_counts (l1, true).total (db::ShapeCounts::Polygons), size_t (1));
+
+  //  cached values are updated when the shapes change
+  child.shapes (l1).insert (db::Box (0, 400, 100, 500));
+  EXPECT_EQ (l.shape_count (child.cell_index (), l1), size_t (9));
+  EXPECT_EQ (l.flat_shape_count (top.cell_index (), l1), size_t (46));
+  EXPECT_EQ (l.flat_shape_count (top.cell_index (), l2), size_t (5));
+
+  //  .. and when the hierarchy changes
+  top.erase (ai);
+  EXPECT_EQ (l.cell_multiplicity (child.cell_index ()), size_t (1));
+  EXPECT_EQ (l.flat_shape_count (top.cell_index (), l1), size_t (10));
+  EXPECT_EQ (l.flat_shape_count (top.cell_index (), l2), size_t (1));
+
+  child.shapes (l1).clear ();
+  EXPECT_EQ (l.shape_count (child.cell_index (), l1), size_t (0));
+  EXPECT_EQ (l.flat_shape_count (top.cell_index (), l1), size_t (1));
+
+  //  deleting a cell updates the flat counts
+  child.shapes (l2).insert (db::Text ("B", db::Trans ()));
+  EXPECT_EQ (l.shape_count (child.cell_index (), l2), size_t (2));
+  EXPECT_EQ (l.flat_shape_count (top.cell_index (), l2), size_t (2));
+  l.delete_cell (child.cell_index ());
+  EXPECT_EQ (l.flat_shape_count (top.cell_index (), l2), size_t (0));
+  EXPECT_EQ (l.shape_counts (l2, false).total (), size_t (0));
+}
+
+TEST(9)
+{
+  //  Compact polygon mode
+  db::Layout l;
+  unsigned int l1 = l.insert_layer (db::LayerProperties (1, 0));
+  db::Cell &top = l.cell (l.add_cell ("TOP"));
+
+  std::vector<db::Point> pts;
+  for (int j = 0; j < 100; ++j) {
+    pts.push_back (db::Point (j * 10, 5000 + (j % 2) * 7 + j));
+  }
+  pts.push_back (db::Point (1000, 0));
+  pts.push_back (db::Point (0, 0));
+
+  db::Polygon poly;
+  poly.assign_hull (pts.begin (), pts.end ());
+
+  //  polygons present before are compacted when the mode is enabled
+  top.shapes (l1).insert (poly);
+  EXPECT_EQ (compact_polygons (top.shapes (l1)), "0");
+
+  EXPECT_EQ (l.compact_polygon_mode (), false);
+  l.set_compact_polygon_mode (true);
+  EXPECT_EQ (l.compact_polygon_mode (), true);
+  EXPECT_EQ (compact_polygons (top.shapes (l1)), "1");
+
+  //  new polygons are compacted on insert - this is the path the stream readers take
+  top.shapes (l1).insert (poly.moved (db::Vector (0, 10000)));
+  top.shapes (l1).insert (db::PolygonWithProperties (poly.moved (db::Vector (0, 20000)), 1));
+  top.shapes (l1).insert (db::PolygonRef (poly.moved (db::Vector (0, 30000)), l.shape_repository ()));
+  top.shapes (l1).insert (db::SimplePolygonRef (db::SimplePolygon (poly).moved (db::Vector (0, 40000)), l.shape_repository ()));
+  EXPECT_EQ (compact_polygons (top.shapes (l1)), "1111");
+
+  for (db::ShapeIterator s = top.shapes (l1).begin (db::ShapeIterator::Polygons); ! s.at_end (); ++s) {
+    if (s->type () == db::Shape::SimplePolygonRef) {
+      EXPECT_EQ (s->simple_polygon_ref ().obj ().is_compact (), true);
+      EXPECT_EQ (s->simple_polygon_ref ().obj ().in_arena (), true);
+      EXPECT_EQ (s->simple_polygon_ref ().obj ().hull ().size (), poly.hull ().size ());
+    }
+  }
+
+  size_t n = 0;
+  for (db::ShapeIterator s = top.shapes (l1).begin_touching (db::Box (0, 30000, 10, 30010), db::ShapeIterator::All); ! s.at_end (); ++s) {
+    db::Polygon p;
+    s->polygon (p);
+    EXPECT_EQ (p.to_string (), poly.moved (db::Vector (0, 30000)).to_string ());
+    ++n;
+  }
+  EXPECT_EQ (n, size_t (1));
+
+  //  the mode survives clear, but the arena is released
+  size_t used = l.polygon_arena ().used ();
+  EXPECT_EQ (used > 0, true);
+  l.clear ();
+  EXPECT_EQ (l.polygon_arena ().used (), size_t (0));
+  EXPECT_EQ (l.compact_polygon_mode (), true);
+
+  l1 = l.insert_layer (db::LayerProperties (1, 0));
+  db::Cell &top2 = l.cell (l.add_cell ("TOP"));
+  top2.shapes (l1).insert (db::PolygonRef (poly, l.shape_repository ()));
+  EXPECT_EQ (compact_polygons (top2.shapes (l1)), "1");
+  EXPECT_EQ (l.polygon_arena ().used () > 0, true);
+
+  //  after disabling the mode, new polygons are inserted in normal representation
+  l.set_compact_polygon_mode (false);
+  top2.shapes (l1).insert (poly.moved (db::Vector (0, 10000)));
+  //  (rotated, as references are normalized by displacement and would share the first repository entry)
+  top2.shapes (l1).insert (db::PolygonRef (poly.transformed (db::Trans (db::Trans::r90)), l.shape_repository ()));
+  EXPECT_EQ (compact_polygons (top2.shapes (l1)), "100");
+
+  //  copies of the layout use their own arena
+  l.set_compact_polygon_mode (true);
+  db::Layout lc (l);
+  EXPECT_EQ (lc.compact_polygon_mode (), true);
+  EXPECT_EQ (lc.polygon_arena ().used () > 0, true);
+  EXPECT_EQ (l2s (lc), l2s (l));
+}
+
+TEST(10)
+{
+  //  Compact polygon mode: the arena is kept while undo operations may hold polygons from it
+  db::Manager m (true);
+  db::Layout l (&m);
+  l.set_compact_polygon_mode (true);
+
+  std::vector<db::Point> pts;
+  for (int j = 0; j < 100; ++j) {
+    pts.push_back (db::Point (j * 10, 5000 + (j % 2) * 7 + j));
+  }
+  pts.push_back (db::Point (1000, 0));
+  pts.push_back (db::Point (0, 0));
+
+  db::Polygon poly;
+  poly.assign_hull (pts.begin (), pts.end ());
+
+  m.transaction ("insert");
+  unsigned int l1 = l.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type ci = l.add_cell ("A");
+  l.cell (ci).shapes (l1).insert (poly);
+  m.commit ();
+
+  EXPECT_EQ (compact_polygons (l.cell (ci).shapes (l1)), "1");
+  size_t used = l.polygon_arena ().used ();
+  EXPECT_EQ (used > 0, true);
+
+  //  the deleted cell is held by the undo operation
+  m.transaction ("delete");
+  l.delete_cell (ci);
+  m.commit ();
+
+  l.clear ();
+  EXPECT_EQ (l.polygon_arena ().used (), used);
+
+  //  new content must not reuse the storage of the polygons held by the undo operation
+  l1 = l.insert_layer (db::LayerProperties (1, 0));
+  //  (this frees the index of the deleted cell again, so it can be restored by undo)
+  db::cell_index_type cx = l.add_cell ("X");
+  EXPECT_EQ (cx, ci);
+  db::Cell &b = l.cell (l.add_cell ("B"));
+  l.delete_cell (cx);
+  for (int i = 0; i < 10; ++i) {
+    b.shapes (l1).insert (poly.transformed (db::Trans (db::Trans::r90, db::Vector (i * 100, 0))));
+  }
+  EXPECT_EQ (l.polygon_arena ().used () > used, true);
+
+  m.undo ();
+  EXPECT_EQ (l.is_valid_cell_index (ci), true);
+
+  db::ShapeIterator s = l.cell (ci).shapes (l1).begin (db::ShapeIterator::Polygons);
+  EXPECT_EQ (s.at_end (), false);
+  if (! s.at_end ()) {
+    db::Polygon p;
+    s->polygon (p);
+    EXPECT_EQ (p.to_string (), poly.to_string ());
+  }
+
+  //  without undo data, the arena is released
+  m.clear ();
+  l.clear ();
+  EXPECT_EQ (l.polygon_arena ().used (), size_t (0));
+
+  //  swapping polygons between layouts does not hand over arena storage
+  db::Layout la, lb;
+  la.set_compact_polygon_mode (true);
+  lb.set_compact_polygon_mode (true);
+  unsigned int la1 = la.insert_layer (db::LayerProperties (1, 0));
+  unsigned int lb1 = lb.insert_layer (db::LayerProperties (1, 0));
+  db::Cell &ca = la.cell (la.add_cell ("A"));
+  db::Cell &cb = lb.cell (lb.add_cell ("B"));
+  ca.shapes (la1).insert (poly);
+  cb.shapes (lb1).insert (poly.moved (db::Vector (0, 10000)));
+
+  db::Polygon &pa = const_cast<db::Polygon &> (ca.shapes (la1).begin (db::ShapeIterator::Polygons)->polygon ());
+  db::Polygon &pb = const_cast<db::Polygon &> (cb.shapes (lb1).begin (db::ShapeIterator::Polygons)->polygon ());
+  EXPECT_EQ (pa.in_arena (), true);
+  EXPECT_EQ (pb.in_arena (), true);
+
+  pa.swap (pb);
+  EXPECT_EQ (pa.in_arena (), false);
+  EXPECT_EQ (pb.in_arena (), false);
+
+  //  releasing the other layout's arena leaves the swapped polygon intact
+  lb.clear ();
+  EXPECT_EQ (lb.polygon_arena ().used (), size_t (0));
+  EXPECT_EQ (pa.to_string (), poly.moved (db::Vector (0, 10000)).to_string ());
+}
@@ -23,6 +23,8 @@
 #include "dbLayoutToNetlist.h"
 #include "dbLayoutToNetlistReader.h"
 #include "dbLayoutToNetlistWriter.h"
+#include "dbLayoutToNetlistBinaryFile.h"
+#include "dbLayoutVsSchematic.h"
 #include "dbStream.h"
 #include "dbCommonReader.h"
 #include "dbNetlistDeviceExtractorClasses.h"
@@ -481,3 +483,62 @@ TEST(4_ReaderCombinedDevices)
   }
 }
 
+
+TEST(5_BinaryFormat)
+{
+  db::LayoutToNetlist l2n;
+
+  std::string in_path = tl::combine_path (tl::combine_path (tl::combine_path (tl::testsrc (), "testdata"), "algo"), "l2n_reader_in.txt");
+  l2n.load (in_path);
+
+  std::string bin_path = tmp_file ("tmp_l2nreader_5.l2nb");
+  l2n.save (bin_path, false);
+
+  EXPECT_EQ (db::is_l2n_binary_file (bin_path), true);
+  EXPECT_EQ (db::is_l2n_binary_file (in_path), false);
+
+  //  full load
+
+  {
+    db::LayoutToNetlist l2n2;
+    l2n2.load (bin_path);
+    EXPECT_EQ (l2n2.has_pending_geometry (), false);
+
+    std::string path = tmp_file ("tmp_l2nreader_5a.txt");
+    l2n2.save (path, false);
+
+    compare_text_files (path, in_path);
+  }
+
+  //  geometry on demand
+
+  {
+    std::unique_ptr<db::LayoutToNetlist> l2n3 (db::LayoutToNetlist::create_from_file (bin_path));
+    EXPECT_EQ (dynamic_cast<db::LayoutVsSchematic *> (l2n3.get ()) == 0, true);
+    EXPECT_EQ (l2n3->has_pending_geometry (), true);
+
+    const db::Circuit *ringo = l2n3->netlist ()->circuit_by_name ("RINGO");
+    const db::Circuit *inv2 = l2n3->netlist ()->circuit_by_name ("INV2");
+    tl_assert (ringo != 0 && inv2 != 0);
+
+    const db::Net *fb = ringo->net_by_name ("FB");
+    const db::Net *in = inv2->net_by_name ("IN");
+    tl_assert (fb != 0 && in != 0);
+
+    const db::hier_clusters<db::NetShape> &clusters = l2n3->net_clusters ();
+    EXPECT_EQ (clusters.clusters_per_cell (ringo->cell_index ()).cluster_by_id (fb->cluster_id ()).size (), size_t (0));
+    EXPECT_EQ (clusters.clusters_per_cell (inv2->cell_index ()).cluster_by_id (in->cluster_id ()).size (), size_t (0));
+
+    //  FB connects to IN of INV2 through a subcircuit, so this net is loaded as well
+    l2n3->ensure_net_geometry (*fb);
+    EXPECT_EQ (clusters.clusters_per_cell (ringo->cell_index ()).cluster_by_id (fb->cluster_id ()).size () > 0, true);
+    EXPECT_EQ (clusters.clusters_per_cell (inv2->cell_index ()).cluster_by_id (in->cluster_id ()).size () > 0, true);
+    EXPECT_EQ (l2n3->has_pending_geometry (), true);
+
+    std::string path = tmp_file ("tmp_l2nreader_5b.txt");
+    l2n3->save (path, false);
+    EXPECT_EQ (l2n3->has_pending_geometry (), false);
+
+    compare_text_files (path, in_path);
+  }
+}
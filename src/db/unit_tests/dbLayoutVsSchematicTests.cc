@@ -445,5 +445,21 @@ TEST(2_FlowWithErrors)
   std::string au_path2 = tl::combine_path (tl::combine_path (tl::combine_path (tl::testsrc (), "testdata"), "algo"), "lvs_test2b_au.lvsdb");
 
   compare_lvsdbs (_this, path2, au_path2);
+
+  //  binary format: save, load with geometry on demand, save and compare
+
+  std::string path3 = tmp_file ("tmp_lvstest2c.lvsdbb");
+  lvs2.save (path3, false);
+
+  std::unique_ptr<db::LayoutToNetlist> lvs3 (db::LayoutToNetlist::create_from_file (path3));
+  db::LayoutVsSchematic *lvs3p = dynamic_cast<db::LayoutVsSchematic *> (lvs3.get ());
+  EXPECT_EQ (lvs3p != 0, true);
+  EXPECT_EQ (lvs3->has_pending_geometry (), true);
+
+  std::string path4 = tmp_file ("tmp_lvstest2d.lvsdb");
+  lvs3p->save (path4, false);
+  EXPECT_EQ (lvs3->has_pending_geometry (), false);
+
+  compare_lvsdbs (_this, path4, au_path2);
 }
 
@@ -27,6 +27,9 @@
 #include "tlUnitTest.h"
 #include "tlStream.h"
 #include "tlFileUtils.h"
+#include "tlTimer.h"
+
+#include <cstdio>
 
 TEST(1_BasicReader)
 {
@@ -534,3 +537,108 @@ TEST(13_NoGlobalNetsIfNotUsed)
   );
 }
 
+
+TEST(14_MultiThreadedReader)
+{
+  const char *files[] = { "nreader1.cir", "nreader2.cir", "nreader3.cir", "nreader4.cir", "nreader7.cir", "nreader8.cir", "nreader12.cir", "nreader13.cir" };
+
+  for (size_t i = 0; i < sizeof (files) / sizeof (files [0]); ++i) {
+
+    std::string path = tl::combine_path (tl::combine_path (tl::combine_path (tl::testsrc (), "testdata"), "algo"), files [i]);
+
+    db::Netlist nl, nl_mt;
+
+    {
+      db::NetlistSpiceReader reader;
+      tl::InputStream is (path);
+      reader.read (is, nl);
+    }
+
+    {
+      db::NetlistSpiceReader reader;
+      reader.set_threads (4);
+      EXPECT_EQ (reader.threads (), (unsigned int) 4);
+      tl::InputStream is (path);
+      reader.read (is, nl_mt);
+    }
+
+    EXPECT_EQ (nl_mt.to_string (), nl.to_string ());
+
+  }
+
+  //  errors are reported with the right line
+  std::string path = tl::combine_path (tl::combine_path (tl::combine_path (tl::testsrc (), "testdata"), "algo"), "nreader11.cir");
+
+  db::Netlist nl;
+  db::NetlistSpiceReader reader;
+  reader.set_threads (4);
+
+  std::string msg;
+  try {
+    tl::InputStream is (path);
+    reader.read (is, nl);
+  } catch (tl::Exception &ex) {
+    msg = ex.msg ();
+  }
+
+  EXPECT_EQ (tl::replaced (msg, path, "?"), "Redefinition of circuit SUBCKT in ?, line 20");
+}
+
+//  Writes a synthetic netlist with "ncircuits" subcircuits of "ndevices" devices each,
+//  called from a top circuit
+static void write_large_netlist (const std::string &path, int ncircuits, int ndevices)
+{
+  FILE *f = fopen (path.c_str (), "w");
+  tl_assert (f != 0);
+
+  fprintf (f, "* synthetic netlist\n");
+  fprintf (f, ".GLOBAL VDD VSS\n");
+
+  for (int c = 0; c < ncircuits; ++c) {
+    fprintf (f, ".SUBCKT C%d IN OUT\n", c);
+    for (int d = 0; d < ndevices; ++d) {
+      fprintf (f, "M%d N%d IN N%d VSS NMOS L=0.15U W=%gU AS=0.1P AD=0.1P\n+ PS=1.2U PD=1.2U\n", d, d, d + 1, 0.5 + d % 7);
+      fprintf (f, "R%d N%d OUT %gK\n", d, d + 1, 1.0 + d % 3);
+    }
+    fprintf (f, "C0 IN VDD 1.5F\n");
+    fprintf (f, ".ENDS C%d\n", c);
+  }
+
+  fprintf (f, ".SUBCKT TOP A Z\n");
+  for (int c = 0; c < ncircuits; ++c) {
+    fprintf (f, "X%d N%d N%d C%d\n", c, c, c + 1, c);
+  }
+  fprintf (f, ".ENDS TOP\n");
+
+  fclose (f);
+}
+
+TEST(15_LargeNetlistBenchmark)
+{
+  std::string path = tmp_file ("large_netlist.cir");
+  write_large_netlist (path, 200, 500);
+
+  db::Netlist nl, nl_mt;
+
+  {
+    tl::SelfTimer timer ("SPICE reader, single-threaded");
+    db::NetlistSpiceReader reader;
+    tl::InputStream is (path);
+    reader.read (is, nl);
+  }
+
+  {
+    tl::SelfTimer timer ("SPICE reader, 4 threads");
+    db::NetlistSpiceReader reader;
+    reader.set_threads (4);
+    tl::InputStream is (path);
+    reader.read (is, nl_mt);
+  }
+
+  EXPECT_EQ (nl.circuit_count (), size_t (201));
+  EXPECT_EQ (nl.circuit_by_name ("C17")->device_count (), size_t (1001));
+  EXPECT_EQ (nl.circuit_by_name ("C17")->net_count (), size_t (505));
+  EXPECT_EQ (nl.circuit_by_name ("TOP")->subcircuit_count (), size_t (200));
+
+  EXPECT_EQ (nl_mt.to_string () == nl.to_string (), true);
+}
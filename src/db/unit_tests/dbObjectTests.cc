@@ -33,9 +33,18 @@ struct AO : public db::Op
   int d;
   static int inst_count () { return ao_inst; }
   static int ao_inst;
+
+  virtual size_t mem_size () const
+  {
+    ++mem_size_calls;
+    return sizeof (AO);
+  }
+
+  static int mem_size_calls;
 };
 
 int AO::ao_inst = 0;
+int AO::mem_size_calls = 0;
 
 struct A : public db::Object 
 {
@@ -313,3 +322,42 @@ TEST(4)
   EXPECT_EQ (BO::inst_count (), 0);
 }
 
+
+//  transaction sizes are computed only with a memory budget
+TEST(5)
+{
+  db::Manager *man = new db::Manager (true);
+  {
+    A a (man);
+
+    AO::mem_size_calls = 0;
+
+    for (int i = 0; i < 3; ++i) {
+      db::Transaction t (man, "add");
+      a.add (1);
+      a.add (2);
+    }
+
+    EXPECT_EQ (a.x, 9);
+    EXPECT_EQ (AO::mem_size_calls, 0);
+
+    //  the budget computes the sizes of the transactions committed before
+    man->set_max_memory (1000000);
+    EXPECT_EQ (AO::mem_size_calls, 6);
+
+    {
+      db::Transaction t (man, "add");
+      a.add (3);
+    }
+
+    EXPECT_EQ (AO::mem_size_calls, 7);
+    EXPECT_EQ (man->memory_used () >= 7 * sizeof (AO), true);
+    EXPECT_EQ (AO::mem_size_calls, 7);
+
+    man->undo ();
+    EXPECT_EQ (a.x, 9);
+  }
+
+  delete man;
+  EXPECT_EQ (AO::inst_count (), 0);
+}
@@ -23,6 +23,7 @@
 
 #include "dbPolygon.h"
 #include "dbPolygonTools.h"
+#include "dbPolygonArrays.h"
 #include "dbPath.h"
 #include "dbBox.h"
 #include "dbEdge.h"
@@ -1395,3 +1396,278 @@ TEST(28)
   db::Polygon b (db::Box (-1000000000, -1000000000, 1000000000, 1000000000));
   EXPECT_EQ (b.perimeter (), 8000000000.0);
 }
+
+namespace
+{
+
+class UsedMemoryCollector
+  : public db::MemStatistics
+{
+public:
+  UsedMemoryCollector () : used (0) { }
+
+  virtual void add (const std::type_info & /*ti*/, void * /*ptr*/, size_t /*size*/, size_t u, void * /*parent*/, purpose_t /*purpose*/, int /*cat*/)
+  {
+    used += u;
+  }
+
+  size_t used;
+};
+
+}
+
+//  compact representation
+TEST(29)
+{
+  db::Polygon poly;
+  std::string s ("(0,0;0,1000;100,1000;100,1100;-200,1100;-200,1500;2000,1500;2000,-50;1000,-50;1000,0/10,10;50,10;50,20;10,20)");
+  tl::Extractor ex (s.c_str ());
+  ex.read (poly);
+
+  db::Polygon pc (poly);
+  EXPECT_EQ (pc.is_compact (), false);
+  pc.compact ();
+  EXPECT_EQ (pc.is_compact (), true);
+  EXPECT_EQ (pc.hole (0).is_compact (), true);
+
+  EXPECT_EQ (pc.to_string (), poly.to_string ());
+  EXPECT_EQ (pc == poly, true);
+  EXPECT_EQ (pc.box ().to_string (), poly.box ().to_string ());
+  EXPECT_EQ (pc.hull ().bbox ().to_string (), poly.hull ().bbox ().to_string ());
+  EXPECT_EQ (pc.is_rectilinear (), true);
+  EXPECT_EQ (pc.area (), poly.area ());
+  EXPECT_EQ (pc.perimeter (), poly.perimeter ());
+
+  //  random access
+  for (size_t i = 0; i < poly.hull ().size (); ++i) {
+    EXPECT_EQ (pc.hull () [i].to_string (), poly.hull () [i].to_string ());
+  }
+  EXPECT_EQ (pc.hull () [7].to_string (), "-200,1500");
+  EXPECT_EQ (pc.hull () [2].to_string (), "0,0");
+
+  //  backward iteration
+  std::string r, rc;
+  for (db::Polygon::polygon_contour_iterator p = poly.end_hull (); p != poly.begin_hull (); ) {
+    --p;
+    r += (*p).to_string () + ";";
+  }
+  for (db::Polygon::polygon_contour_iterator p = pc.end_hull (); p != pc.begin_hull (); ) {
+    --p;
+    rc += (*p).to_string () + ";";
+  }
+  EXPECT_EQ (rc, r);
+
+  //  edges
+  r.clear ();
+  rc.clear ();
+  for (db::Polygon::polygon_edge_iterator e = poly.begin_edge (); ! e.at_end (); ++e) {
+    r += (*e).to_string () + ";";
+  }
+  for (db::Polygon::polygon_edge_iterator e = pc.begin_edge (); ! e.at_end (); ++e) {
+    rc += (*e).to_string () + ";";
+  }
+  EXPECT_EQ (rc, r);
+
+  //  copy and assignment keep the representation
+  db::Polygon pc2 (pc);
+  EXPECT_EQ (pc2.is_compact (), true);
+  EXPECT_EQ (pc2.to_string (), poly.to_string ());
+  pc2 = poly;
+  EXPECT_EQ (pc2.is_compact (), false);
+  pc2 = pc;
+  EXPECT_EQ (pc2.is_compact (), true);
+
+  //  move keeps the representation, transformation restores the normal one
+  pc2.move (db::Vector (-100000, 200000));
+  EXPECT_EQ (pc2.is_compact (), true);
+  EXPECT_EQ (pc2.to_string (), poly.moved (db::Vector (-100000, 200000)).to_string ());
+  pc2.transform (db::Trans (db::Trans::r90));
+  EXPECT_EQ (pc2.is_compact (), false);
+  EXPECT_EQ (pc2.to_string (), poly.moved (db::Vector (-100000, 200000)).transformed (db::Trans (db::Trans::r90)).to_string ());
+
+  //  compact contours need less memory
+  UsedMemoryCollector m, mc;
+  poly.mem_stat (&m, db::MemStatistics::None, 0);
+  pc.mem_stat (&mc, db::MemStatistics::None, 0);
+  EXPECT_EQ (mc.used < m.used, true);
+
+  //  floating-point polygons are not compacted
+  db::DPolygon dpoly (poly);
+  dpoly.compact ();
+  EXPECT_EQ (dpoly.is_compact (), false);
+}
+
+TEST(30)
+{
+  //  non-orthogonal contours far away from the origin
+  db::Point pts[] = {
+    db::Point (-1000000000, -1000000000),
+    db::Point (-999995000, -1000000001),
+    db::Point (-999995000, -999995000),
+    db::Point (-999999983, -999995000),
+    db::Point (-1000000005, -999999997)
+  };
+
+  db::SimplePolygon poly;
+  poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts [0]));
+
+  db::SimplePolygon pc (poly);
+  pc.compact ();
+  EXPECT_EQ (pc.is_compact (), true);
+  EXPECT_EQ (pc.to_string (), poly.to_string ());
+  EXPECT_EQ (pc.is_rectilinear (), false);
+  EXPECT_EQ (pc.hull ().is_halfmanhattan (), false);
+  EXPECT_EQ (pc.hull ().bbox ().to_string (), poly.hull ().bbox ().to_string ());
+  EXPECT_EQ (pc.hull () [4].to_string (), poly.hull () [4].to_string ());
+  EXPECT_EQ (pc.hull () [1].to_string (), poly.hull () [1].to_string ());
+  EXPECT_EQ (pc < poly, false);
+  EXPECT_EQ (poly < pc, false);
+
+  //  no benefit: a box contour is not compacted
+  db::SimplePolygon box (db::Box (-2000000000, -2000000000, 2000000000, 2000000000));
+  box.compact ();
+  EXPECT_EQ (box.is_compact (), false);
+}
+
+//  compact representation with arena storage
+TEST(31)
+{
+  db::Polygon poly;
+  std::string s ("(0,0;0,1000;100,1000;100,1100;-200,1100;-200,1500;2000,1500;2000,-50;1000,-50;1000,0/10,10;50,10;50,20;10,20)");
+  tl::Extractor ex (s.c_str ());
+  ex.read (poly);
+
+  db::Polygon pcopy;
+
+  {
+    tl::Arena arena;
+
+    db::Polygon pc (poly);
+    pc.compact (&arena);
+    EXPECT_EQ (pc.is_compact (), true);
+    EXPECT_EQ (pc.to_string (), poly.to_string ());
+    EXPECT_EQ (arena.used () > 0, true);
+
+    //  no benefit: the box is not compacted, but lives in the arena
+    size_t used = arena.used ();
+    db::Polygon box (db::Box (-1000000000, -1000000000, 1000000000, 1000000000));
+    box.compact (&arena);
+    EXPECT_EQ (box.is_compact (), false);
+    EXPECT_EQ (arena.used (), used + 4 * sizeof (db::Point));
+    EXPECT_EQ (box.to_string (), "(-1000000000,-1000000000;-1000000000,1000000000;1000000000,1000000000;1000000000,-1000000000)");
+
+    //  copies use the heap
+    pcopy = pc;
+
+    //  edits fall back to the heap
+    box.move (db::Vector (10, 20));
+    EXPECT_EQ (box.to_string (), "(-999999990,-999999980;-999999990,1000000020;1000000010,1000000020;1000000010,-999999980)");
+    box.transform (db::Trans (db::Trans::r90));
+    EXPECT_EQ (box.to_string (), "(-1000000020,-999999990;-1000000020,1000000010;999999980,1000000010;999999980,-999999990)");
+    pc.move (db::Vector (1, 2));
+    EXPECT_EQ (pc.is_compact (), true);
+    EXPECT_EQ (pc.to_string (), poly.moved (db::Vector (1, 2)).to_string ());
+    pc.assign_hull (poly.begin_hull (), poly.end_hull ());
+    EXPECT_EQ (pc.is_compact (), false);
+  }
+
+  EXPECT_EQ (pcopy.is_compact (), true);
+  EXPECT_EQ (pcopy.to_string (), poly.to_string ());
+
+  //  swapping with a polygon using the heap does not hand over arena storage
+  db::Polygon ph (poly);
+  db::SimplePolygon sph (db::SimplePolygon (poly.box ()));
+
+  {
+    tl::Arena arena;
+
+    db::Polygon pa (poly.moved (db::Vector (10, 0)));
+    pa.compact (&arena);
+    EXPECT_EQ (pa.in_arena (), true);
+
+    ph.swap (pa);
+    EXPECT_EQ (ph.in_arena (), false);
+    EXPECT_EQ (pa.in_arena (), false);
+    EXPECT_EQ (pa.to_string (), poly.to_string ());
+
+    db::SimplePolygon spa (poly.box ().moved (db::Vector (10, 0)));
+    spa.compact (&arena);
+    EXPECT_EQ (spa.in_arena (), true);
+
+    std::swap (sph, spa);
+    EXPECT_EQ (sph.in_arena (), false);
+    EXPECT_EQ (spa.in_arena (), false);
+
+  }
+
+  //  the arena is gone, but the swapped polygons are still valid
+  EXPECT_EQ (ph.to_string (), poly.moved (db::Vector (10, 0)).to_string ());
+  EXPECT_EQ (sph.to_string (), db::SimplePolygon (poly.box ().moved (db::Vector (10, 0))).to_string ());
+
+  //  swaps between arena polygons copy too, as the polygons may live in different arenas
+  db::Polygon pb1 (poly);
+  tl::Arena arena1;
+  pb1.compact (&arena1);
+
+  {
+    tl::Arena arena2;
+
+    db::Polygon pb2 (poly.moved (db::Vector (0, 5)));
+    pb2.compact (&arena2);
+
+    pb1.swap (pb2);
+    EXPECT_EQ (pb1.in_arena (), false);
+    EXPECT_EQ (pb2.in_arena (), false);
+    EXPECT_EQ (pb1.is_compact (), true);
+    EXPECT_EQ (pb2.to_string (), poly.to_string ());
+  }
+
+  EXPECT_EQ (pb1.to_string (), poly.moved (db::Vector (0, 5)).to_string ());
+}
+
+static std::string indexes_to_string (const std::vector<db::PolygonArrays::index_type> &indexes)
+{
+  std::string res;
+  for (std::vector<db::PolygonArrays::index_type>::const_iterator i = indexes.begin (); i != indexes.end (); ++i) {
+    if (! res.empty ()) {
+      res += ",";
+    }
+    res += tl::to_string (*i);
+  }
+  return res;
+}
+
+//  PolygonArrays
+TEST(32)
+{
+  db::Polygon poly;
+  tl::Extractor ex ("(0,0;0,1000;1000,1000;1000,0/100,100;200,100;200,200;100,200/500,500;600,500;600,600;500,600)");
+  ex.read (poly);
+
+  db::PolygonArrays arrays;
+  EXPECT_EQ (arrays.size (), size_t (0));
+
+  arrays.add (poly);
+  arrays.add (db::Polygon (db::Box (-10, -20, 30, 40)));
+  EXPECT_EQ (arrays.size (), size_t (2));
+  EXPECT_EQ (arrays.coordinates ().size (), size_t (32));
+  EXPECT_EQ (indexes_to_string (arrays.contours ()), "0,4,8,12,16");
+  EXPECT_EQ (indexes_to_string (arrays.polygons ()), "0,3,4");
+  EXPECT_EQ (arrays.polygon (0).to_string (), poly.to_string ());
+  EXPECT_EQ (arrays.polygon (1).to_string (), "(-10,-20;-10,40;30,40;30,-20)");
+
+  db::PolygonArrays copy (arrays.coordinates (), arrays.contours (), arrays.polygons ());
+  EXPECT_EQ (copy.size (), size_t (2));
+  EXPECT_EQ (copy.polygon (0).to_string (), poly.to_string ());
+  EXPECT_EQ (copy.polygon (1).to_string (), "(-10,-20;-10,40;30,40;30,-20)");
+
+  //  inconsistent arrays are rejected
+  std::vector<db::PolygonArrays::index_type> bad_contours (arrays.contours ());
+  bad_contours.back () = 17;
+  try {
+    db::PolygonArrays bad (arrays.coordinates (), bad_contours, arrays.polygons ());
+    EXPECT_EQ (true, false);
+  } catch (tl::Exception &) {
+    //  expected
+  }
+}
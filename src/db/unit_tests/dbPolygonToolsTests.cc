@@ -2009,6 +2009,54 @@ TEST(314)
   );
 }
 
+//  decompose_to_convex, is_convex and cut_polygon on compact contours
+TEST(315)
+{
+  db::Polygon p;
+  tl::Extractor ex ("(0,0;0,40000;40000,40000;40000,0/10000,10000;30000,10000;30000,30000;10000,30000)");
+  ex.read (p);
+
+  db::Polygon pc (p);
+  pc.compact ();
+  EXPECT_EQ (pc.is_compact (), true);
+
+  db::SimplePolygon sp = db::polygon_to_simple_polygon (p);
+  db::SimplePolygon spc (sp);
+  spc.compact ();
+  EXPECT_EQ (spc.is_compact (), true);
+
+  EXPECT_EQ (db::is_convex (pc), false);
+  EXPECT_EQ (db::is_convex (spc), false);
+
+  db::Polygon hc;
+  hc.assign_hull (p.begin_hull (), p.end_hull ());
+  hc.compact ();
+  EXPECT_EQ (db::is_convex (hc), true);
+
+  for (int po = int (db::PO_any); po <= int (db::PO_vtrapezoids); ++po) {
+
+    TestPolygonSink ps, psc;
+    db::decompose_convex (p, db::PreferredOrientation (po), ps);
+    db::decompose_convex (pc, db::PreferredOrientation (po), psc);
+    EXPECT_EQ (psc.s, ps.s);
+
+    ps.s.clear ();
+    psc.s.clear ();
+    db::decompose_convex (sp, db::PreferredOrientation (po), ps);
+    db::decompose_convex (spc, db::PreferredOrientation (po), psc);
+    EXPECT_EQ (psc.s, ps.s);
+
+  }
+
+  std::vector<db::Polygon> right_of, right_of_c;
+  db::cut_polygon (p, db::Edge (db::Point (0, 20000), db::Point (1, 20000)), std::back_inserter (right_of));
+  db::cut_polygon (pc, db::Edge (db::Point (0, 20000), db::Point (1, 20000)), std::back_inserter (right_of_c));
+  EXPECT_EQ (right_of_c.size (), right_of.size ());
+  for (size_t i = 0; i < right_of.size () && i < right_of_c.size (); ++i) {
+    EXPECT_EQ (right_of_c [i].to_string (), right_of [i].to_string ());
+  }
+}
+
 //  decompose_to_trapezoids
 TEST(320)
 {
@@ -28,6 +28,7 @@
 #include "tlUnitTest.h"
 
 #include <vector>
+#include <algorithm>
 
 std::string collect(db::RecursiveShapeIterator &s, const db::Layout &layout, bool with_layer = false) 
 {
@@ -1304,3 +1305,141 @@ TEST(10)
     "end\n"
   );
 }
+
+namespace
+{
+
+class BoxCollectingReceiver
+  : public db::RecursiveShapeReceiver
+{
+public:
+  BoxCollectingReceiver () { }
+
+  virtual void shape (const db::RecursiveShapeIterator * /*iter*/, const db::Shape &shape, const db::ICplxTrans &trans, const db::Box & /*region*/, const box_tree_type * /*complex_region*/)
+  {
+    boxes.push_back (trans * shape.bbox ());
+  }
+
+  std::vector<db::Box> boxes;
+};
+
+class ParallelBoxCollectingReceiver
+  : public db::ParallelRecursiveShapeReceiver
+{
+public:
+  ParallelBoxCollectingReceiver () : chunks (0) { }
+
+  virtual db::RecursiveShapeReceiver *create_receiver (size_t /*index*/, const db::Box & /*box*/)
+  {
+    ++chunks;
+    return new BoxCollectingReceiver ();
+  }
+
+  virtual void finish_receiver (size_t /*index*/, db::RecursiveShapeReceiver *receiver)
+  {
+    const std::vector<db::Box> &b = static_cast<BoxCollectingReceiver *> (receiver)->boxes;
+    boxes.insert (boxes.end (), b.begin (), b.end ());
+  }
+
+  size_t chunks;
+  std::vector<db::Box> boxes;
+};
+
+}
+
+static std::vector<db::Box> collect_sorted (db::RecursiveShapeIterator iter)
+{
+  BoxCollectingReceiver rec;
+  iter.push (&rec);
+  std::sort (rec.boxes.begin (), rec.boxes.end ());
+  return rec.boxes;
+}
+
+static std::vector<db::Box> collect_sorted_parallel (db::RecursiveShapeIterator iter, unsigned int threads, size_t chunks, size_t &nchunks)
+{
+  ParallelBoxCollectingReceiver rec;
+  iter.push (&rec, threads, chunks);
+  nchunks = rec.chunks;
+  std::sort (rec.boxes.begin (), rec.boxes.end ());
+  return rec.boxes;
+}
+
+TEST(11)
+{
+  //  partitioned push mode
+
+  db::Layout g;
+  g.insert_layer (0);
+
+  db::Cell &c0 (g.cell (g.add_cell ()));
+  db::Cell &c1 (g.cell (g.add_cell ()));
+  db::Cell &c2 (g.cell (g.add_cell ()));
+
+  c1.shapes (0).insert (db::Box (0, 0, 100, 200));
+  c1.shapes (0).insert (db::Box (-50, 150, 1050, 250));
+  c2.shapes (0).insert (db::Box (0, 0, 3000, 10));
+
+  c2.insert (db::CellInstArray (db::CellInst (c1.cell_index ()), db::Trans (db::Vector (0, 0)), db::Vector (500, 0), db::Vector (0, 700), 6, 4));
+  c2.insert (db::CellInstArray (db::CellInst (c1.cell_index ()), db::Trans (db::Trans::r90, db::Vector (200, 3000))));
+
+  for (int i = 0; i < 1000; ++i) {
+    int x = rand () % 100000;
+    int y = rand () % 50000;
+    c0.shapes (0).insert (db::Box (x, y, x + 1 + rand () % 2000, y + 1 + rand () % 2000));
+  }
+
+  for (int i = 0; i < 50; ++i) {
+    int x = rand () % 100000;
+    int y = rand () % 50000;
+    c0.insert (db::CellInstArray (db::CellInst (c2.cell_index ()), db::Trans (i % 8, db::Vector (x, y))));
+  }
+  c0.insert (db::CellInstArray (db::CellInst (c2.cell_index ()), db::ICplxTrans (2.0, 0.0, false, db::Vector (-1000, 500))));
+
+  size_t nchunks = 0;
+
+  db::RecursiveShapeIterator iter (g, c0, 0);
+  std::vector<db::Box> ref = collect_sorted (iter);
+  EXPECT_EQ (ref.size () > 1000, true);
+  EXPECT_EQ (collect_sorted_parallel (iter, 0, 16, nchunks) == ref, true);
+  EXPECT_EQ (collect_sorted_parallel (iter, 2, 7, nchunks) == ref, true);
+  EXPECT_EQ (collect_sorted_parallel (iter, 3, 0, nchunks) == ref, true);
+
+  //  the region is 50000x25000: 12 chunks give a 5x2 grid, 7 chunks a 4x1 grid
+  db::RecursiveShapeIterator iter_touching (g, c0, 0, db::Box (10000, 5000, 60000, 30000), false);
+  ref = collect_sorted (iter_touching);
+  EXPECT_EQ (ref.size () > 100, true);
+  EXPECT_EQ (collect_sorted_parallel (iter_touching, 2, 12, nchunks) == ref, true);
+  EXPECT_EQ (nchunks, size_t (10));
+  EXPECT_EQ (collect_sorted_parallel (iter_touching, 0, 12, nchunks) == ref, true);
+  EXPECT_EQ (nchunks, size_t (10));
+  EXPECT_EQ (collect_sorted_parallel (iter_touching, 2, 7, nchunks) == ref, true);
+  EXPECT_EQ (nchunks, size_t (4));
+  //  the default is four chunks per thread
+  EXPECT_EQ (collect_sorted_parallel (iter_touching, 3, 0, nchunks) == ref, true);
+  EXPECT_EQ (nchunks, size_t (10));
+  EXPECT_EQ (collect_sorted_parallel (iter_touching, 1, 0, nchunks) == ref, true);
+  EXPECT_EQ (nchunks, size_t (3));
+
+  db::RecursiveShapeIterator iter_overlapping (g, c0, 0, db::Box (10000, 5000, 60000, 30000), true);
+  ref = collect_sorted (iter_overlapping);
+  EXPECT_EQ (ref.size () > 100, true);
+  EXPECT_EQ (collect_sorted_parallel (iter_overlapping, 2, 12, nchunks) == ref, true);
+  EXPECT_EQ (nchunks, size_t (10));
+
+  //  flattening a region
+  db::Region r (iter);
+  db::Region rp (iter);
+  r.flatten ();
+  rp.flatten (2);
+  EXPECT_EQ (rp.has_valid_polygons (), true);
+  EXPECT_EQ (rp.count (), r.count ());
+  EXPECT_EQ (rp.area (), r.area ());
+  EXPECT_EQ ((rp ^ r).empty (), true);
+
+  //  arbitrary-angle instances fall back to a single chunk
+  c0.insert (db::CellInstArray (db::CellInst (c2.cell_index ()), db::ICplxTrans (1.0, 45.0, false, db::Vector (20000, 20000))));
+
+  ref = collect_sorted (iter);
+  EXPECT_EQ (collect_sorted_parallel (iter, 2, 12, nchunks) == ref, true);
+  EXPECT_EQ (nchunks, size_t (1));
+}
@@ -1973,6 +1973,61 @@ TEST(35c_interact_with_count_text)
   EXPECT_EQ (r.selected_not_interacting (rr, 3, 4).to_string (), "(0,0;0,200;100,200;100,0)");
 }
 
+static std::vector<db::EdgePair> sorted_edge_pairs (const db::EdgePairs &ep)
+{
+  std::vector<db::EdgePair> v;
+  for (db::EdgePairs::const_iterator i = ep.begin (); ! i.at_end (); ++i) {
+    v.push_back (*i);
+  }
+  std::sort (v.begin (), v.end ());
+  return v;
+}
+
+TEST(36_MultiThreadedFlatChecks)
+{
+  db::Region r, rr;
+
+  srand (1);
+
+  for (int i = 0; i < 1000; ++i) {
+    db::Coord x = rand () % 20000;
+    db::Coord y = rand () % 2000;
+    if (i % 10 == 0) {
+      //  some L shapes and wide shapes
+      r.insert (db::Box (x, y, x + 10 + rand () % 1000, y + 10));
+      r.insert (db::Box (x, y, x + 10, y + 50));
+    } else {
+      r.insert (db::Box (x, y, x + 5 + rand () % 40, y + 5 + rand () % 40));
+    }
+    x = rand () % 20000;
+    y = rand () % 2000;
+    rr.insert (db::Box (x, y, x + 5 + rand () % 60, y + 5 + rand () % 60));
+  }
+
+  db::RegionCheckOptions opt;
+  db::RegionCheckOptions opt_mt;
+  opt_mt.threads = 4;
+
+  EXPECT_EQ (sorted_edge_pairs (r.width_check (20, opt_mt)) == sorted_edge_pairs (r.width_check (20, opt)), true);
+  EXPECT_EQ (sorted_edge_pairs (r.space_check (20, opt_mt)) == sorted_edge_pairs (r.space_check (20, opt)), true);
+  EXPECT_EQ (sorted_edge_pairs (r.isolated_check (20, opt_mt)) == sorted_edge_pairs (r.isolated_check (20, opt)), true);
+  EXPECT_EQ (sorted_edge_pairs (r.enclosing_check (rr, 20, opt_mt)) == sorted_edge_pairs (r.enclosing_check (rr, 20, opt)), true);
+  EXPECT_EQ (sorted_edge_pairs (r.separation_check (rr, 20, opt_mt)) == sorted_edge_pairs (r.separation_check (rr, 20, opt)), true);
+  EXPECT_EQ (r.space_check (20, opt).count () > 0, true);
+  EXPECT_EQ (r.separation_check (rr, 20, opt).count () > 0, true);
+
+  //  unshielded mode uses the plain subject scheme
+  opt.shielded = false;
+  opt_mt.shielded = false;
+  EXPECT_EQ (sorted_edge_pairs (r.space_check (20, opt_mt)) == sorted_edge_pairs (r.space_check (20, opt)), true);
+
+  //  negative output (two-polygon checks fall back to a single thread)
+  opt.negative = true;
+  opt_mt.negative = true;
+  EXPECT_EQ (sorted_edge_pairs (r.width_check (20, opt_mt)) == sorted_edge_pairs (r.width_check (20, opt)), true);
+  EXPECT_EQ (sorted_edge_pairs (r.space_check (20, opt_mt)) == sorted_edge_pairs (r.space_check (20, opt)), true);
+}
+
 TEST(100_Processors)
 {
   db::Region r;
@@ -3235,6 +3235,246 @@ TEST(23)
   EXPECT_EQ (shapes_to_string_norm (_this, s2), "edge_pair (0,0;1,1)/(10,10;11,11) #17\n");
 }
 
+//  Clear with undo/redo (snapshot)
+TEST(24)
+{
+  db::Manager m (true);
+  db::Shapes shapes1 (&m, 0, true);
+
+  m.transaction ("insert");
+  shapes1.insert (db::Box (0, 0, 100, 200));
+  shapes1.insert (db::Edge (0, 0, 100, 200));
+  shapes1.insert (db::PolygonWithProperties (db::Polygon (db::Box (10, 20, 30, 40)), 5));
+  m.commit ();
+
+  std::string orig = shapes_to_string_norm (_this, shapes1);
+
+  m.transaction ("clear");
+  shapes1.clear ();
+  m.commit ();
+
+  EXPECT_EQ (shapes1.empty (), true);
+  EXPECT_EQ (m.memory_used () > 0, true);
+
+  m.undo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), orig);
+  shapes1.update_bbox ();
+  EXPECT_EQ (shapes1.bbox ().to_string (), "(0,0;100,200)");
+
+  m.redo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), "");
+  shapes1.update_bbox ();
+  EXPECT_EQ (shapes1.bbox ().empty (), true);
+
+  m.undo ();
+  m.undo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), "");
+  m.redo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), orig);
+}
+
+//  Undo memory budget
+static void undo_budget_test (tl::TestBase *_this, bool spill)
+{
+  db::Manager m (true);
+  db::Shapes shapes1 (&m, 0, true);
+
+  std::vector<std::string> states;
+  states.push_back (shapes_to_string_norm (_this, shapes1));
+
+  for (int t = 0; t < 10; ++t) {
+
+    m.transaction ("insert");
+    for (int type = 0; type < 5; ++type) {
+      for (int i = 0; i < 100; ++i) {
+        db::Coord x = t * 1000 + i * 10;
+        db::Point pts[] = { db::Point (x, 0), db::Point (x, 100 + i), db::Point (x + 5, 200), db::Point (x + 7, 50) };
+        if (type == 0) {
+          db::Polygon poly;
+          poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts [0]));
+          shapes1.insert (poly);
+        } else if (type == 1) {
+          shapes1.insert (db::PathWithProperties (db::Path (pts, pts + 3, 10, 1, 2, (i % 2) != 0), i + 1));
+        } else if (type == 2) {
+          shapes1.insert (db::Box (x, 0, x + i, 10));
+        } else if (type == 3) {
+          shapes1.insert (db::EdgePair (db::Edge (pts [0], pts [1]), db::Edge (pts [2], pts [3]), (i % 2) != 0));
+        } else {
+          shapes1.insert (db::Text ("T", db::Trans (db::Vector (x, 0))));
+        }
+      }
+    }
+    if (t == 5) {
+      //  erases polygons (layer_op with erase) and records them
+      shapes1.erase (db::Polygon::tag (), db::stable_layer_tag (), shapes1.begin (db::Polygon::tag (), db::stable_layer_tag ()), shapes1.end (db::Polygon::tag (), db::stable_layer_tag ()));
+    }
+    m.commit ();
+
+    states.push_back (shapes_to_string_norm (_this, shapes1));
+
+  }
+
+  size_t mem_before = m.memory_used ();
+  m.set_spill_to_disk (spill);
+  m.set_max_memory (mem_before / 4);
+  size_t mem_after = m.memory_used ();
+  EXPECT_EQ (mem_after < mem_before / 2, true);
+
+  for (int t = 10; t > 0; --t) {
+    EXPECT_EQ (shapes_to_string_norm (_this, shapes1), states [t]);
+    m.undo ();
+  }
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), states [0]);
+
+  for (int t = 0; t < 10; ++t) {
+    m.redo ();
+    EXPECT_EQ (shapes_to_string_norm (_this, shapes1), states [t + 1]);
+  }
+}
+
+TEST(25)
+{
+  undo_budget_test (_this, false);
+}
+
+TEST(26)
+{
+  undo_budget_test (_this, true);
+}
+
+//  Undo of a clear with shapes added without undo support
+TEST(27)
+{
+  db::Manager m (true);
+  db::Shapes shapes1 (&m, 0, true);
+
+  m.transaction ("insert");
+  shapes1.insert (db::Box (0, 0, 100, 200));
+  shapes1.insert (db::Edge (0, 0, 100, 200));
+  m.commit ();
+
+  m.transaction ("clear");
+  shapes1.clear ();
+  m.commit ();
+
+  //  not recorded
+  shapes1.insert (db::Box (10, 20, 30, 40));
+  shapes1.insert (db::Text ("T", db::Trans ()));
+
+  m.undo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1),
+    "box (0,0;100,200) #0\n"
+    "box (10,20;30,40) #0\n"
+    "edge (0,0;100,200) #0\n"
+    "text ('T',r0 0,0) #0\n"
+  );
+
+  m.redo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), "");
+
+  m.undo ();
+  m.undo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1),
+    "box (10,20;30,40) #0\n"
+    "text ('T',r0 0,0) #0\n"
+  );
+}
+
+//  Undo memory budget with cleared shapes containers
+TEST(28)
+{
+  db::Manager m (true);
+  db::Shapes shapes1 (&m, 0, true);
+
+  m.transaction ("insert");
+  for (int i = 0; i < 1000; ++i) {
+    db::Point pts[] = { db::Point (i * 10, 0), db::Point (i * 10, 100 + i), db::Point (i * 10 + 5, 200), db::Point (i * 10 + 7, 50) };
+    db::Polygon poly;
+    poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts [0]));
+    shapes1.insert (poly);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    shapes1.insert (db::BoxWithProperties (db::Box (i * 10, 0, i * 10 + i, 10), i + 1));
+  }
+  for (int i = 0; i < 1000; i += 100) {
+    //  texts are not compacted
+    shapes1.insert (db::Text ("T", db::Trans (db::Vector (i * 10, 0))));
+  }
+  m.commit ();
+
+  std::string s1 = shapes_to_string_norm (_this, shapes1);
+
+  m.transaction ("clear");
+  shapes1.clear ();
+  m.commit ();
+
+  m.transaction ("insert 2");
+  shapes1.insert (db::Box (0, 0, 10, 10));
+  m.commit ();
+
+  std::string s3 = shapes_to_string_norm (_this, shapes1);
+
+  //  the insert and the clear transaction are compacted
+  size_t mem_before = m.memory_used ();
+  m.set_max_memory (mem_before / 10);
+  EXPECT_EQ (m.memory_used () < mem_before / 4, true);
+
+  m.undo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), "");
+  m.undo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), s1);
+  m.undo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), "");
+
+  m.redo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), s1);
+  m.redo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), "");
+  m.redo ();
+  EXPECT_EQ (shapes_to_string_norm (_this, shapes1), s3);
+}
+
+//  Reuse of the spill file space
+TEST(29)
+{
+  db::Manager m (true);
+  db::Shapes shapes1 (&m, 0, true);
+
+  m.set_spill_to_disk (true);
+  m.set_max_memory (1000);
+
+  size_t first_size = 0;
+
+  for (int cycle = 0; cycle < 5; ++cycle) {
+
+    //  the new transactions discard the ones undone before
+    for (int t = 0; t < 10; ++t) {
+      m.transaction ("insert");
+      for (int i = 0; i < 200; ++i) {
+        db::Point pts[] = { db::Point (i * 10, t), db::Point (i * 10, 100 + i), db::Point (i * 10 + 5, 200), db::Point (i * 10 + 7, 50) };
+        db::Polygon poly;
+        poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts [0]));
+        shapes1.insert (poly);
+      }
+      m.commit ();
+    }
+
+    if (cycle == 0) {
+      first_size = m.spill_file_size ();
+      EXPECT_EQ (first_size > 0, true);
+    } else {
+      //  the space is reused, so the file does not grow with the cycles
+      EXPECT_EQ (m.spill_file_size () <= first_size * 2, true);
+    }
+
+    for (int t = 0; t < 10; ++t) {
+      m.undo ();
+    }
+    EXPECT_EQ (shapes1.empty (), true);
+
+  }
+}
+
 //  Bug #107
 TEST(100)
 {
@@ -31,8 +31,10 @@
 #include "dbWriter.h"
 #include "dbSaveLayoutOptions.h"
 #include "dbShapeProcessor.h"
+#include "dbReader.h"
 
 #include <cstdlib>
+#include <set>
 
 unsigned int get_rand()
 {
@@ -448,3 +450,254 @@ TEST(5)
   EXPECT_EQ (sum, 2500000000);
   EXPECT_EQ (num, 134225);
 }
+
+//  adaptive tiling
+TEST(6)
+{
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type top = ly.add_cell ("TOP");
+  db::cell_index_type c1 = ly.add_cell ("C1");
+
+  for (db::Coord x = 0; x < 10000; x += 1000) {
+    for (db::Coord y = 0; y < 10000; y += 1000) {
+      ly.cell (c1).shapes (l1).insert (db::Box (x, y, x + 500, y + 500));
+    }
+  }
+
+  //  a dense block of 400 boxes in the lower left and a single box in the upper right
+  ly.cell (top).insert (db::CellInstArray (db::CellInst (c1), db::Trans (), db::Vector (10000, 0), db::Vector (0, 10000), 2, 2));
+  ly.cell (top).shapes (l1).insert (db::Box (90000, 90000, 91000, 91000));
+
+  db::Region r_uniform;
+
+  {
+    db::TilingProcessor tp;
+    tp.tile_size (25.0, 25.0);
+    tp.input ("a", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+    tp.output ("o", r_uniform);
+    tp.queue ("_output(o, a)");
+    tp.execute ("test");
+
+    EXPECT_EQ (tp.tile_statistics ().size (), size_t (16));
+    EXPECT_EQ (tp.tile_statistics ().front ().estimated_count, size_t (0));
+  }
+
+  db::Region r_adaptive;
+
+  {
+    db::TilingProcessor tp;
+    tp.set_threads (2);
+    tp.set_adaptive (true);
+    tp.set_adaptive_threshold (10);
+    tp.tile_size (25.0, 25.0);
+    tp.input ("a", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+    tp.output ("o", r_adaptive);
+    tp.queue ("_output(o, a)");
+    tp.execute ("test");
+
+    const std::vector<db::TileStatistics> &stat = tp.tile_statistics ();
+    EXPECT_EQ (stat.size () > 16, true);
+
+    size_t total = 0, max_count = 0;
+    double area = 0.0;
+    for (std::vector<db::TileStatistics>::const_iterator s = stat.begin (); s != stat.end (); ++s) {
+      total += s->estimated_count;
+      max_count = std::max (max_count, s->estimated_count);
+      area += s->box.area ();
+    }
+
+    //  the tiles cover the same area as the uniform grid
+    EXPECT_EQ (tl::to_string (area), "10000");
+    //  boxes touching tile boundaries are counted twice
+    EXPECT_EQ (total >= 401, true);
+    //  no tile exceeds twice the average of the uniform grid
+    EXPECT_EQ (max_count <= 50, true);
+  }
+
+  //  tiles are clipped differently, but the result is the same
+  EXPECT_EQ ((r_uniform ^ r_adaptive).empty (), true);
+}
+
+class TileIndexRecorder
+  : public db::TileOutputReceiver
+{
+public:
+  TileIndexRecorder (size_t *nx, size_t *ny, std::set<std::pair<size_t, size_t> > *tiles)
+    : mp_nx (nx), mp_ny (ny), mp_tiles (tiles)
+  { }
+
+  virtual void begin (size_t nx, size_t ny, const db::DPoint & /*p0*/, double /*dx*/, double /*dy*/, const db::DBox & /*frame*/)
+  {
+    *mp_nx = nx;
+    *mp_ny = ny;
+  }
+
+  virtual void put (size_t ix, size_t iy, const db::Box & /*tile*/, size_t /*id*/, const tl::Variant & /*obj*/, double /*dbu*/, const db::ICplxTrans & /*trans*/, bool /*clip*/)
+  {
+    mp_tiles->insert (std::make_pair (ix, iy));
+  }
+
+private:
+  size_t *mp_nx, *mp_ny;
+  std::set<std::pair<size_t, size_t> > *mp_tiles;
+};
+
+static void run_adaptive_index_test (const db::Layout &ly, db::cell_index_type top, unsigned int l1, size_t threshold, size_t &nx, size_t &ny, std::set<std::pair<size_t, size_t> > &tiles, size_t &ntiles)
+{
+  db::TilingProcessor tp;
+  tp.set_adaptive (true);
+  tp.set_adaptive_threshold (threshold);
+  tp.tile_size (25.0, 25.0);
+  tp.tile_origin (0.0, 0.0);
+  tp.input ("a", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+  tp.output ("r", 0, new TileIndexRecorder (&nx, &ny, &tiles), db::ICplxTrans ());
+  tp.queue ("_output(r, a)");
+  tp.execute ("test");
+
+  ntiles = tp.tile_statistics ().size ();
+}
+
+//  adaptive tiling: tile indexes
+TEST(6b)
+{
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type top = ly.add_cell ("TOP");
+
+  //  400 boxes in the lower left tile, 169 of them in its lower left quarter
+  for (db::Coord x = 0; x < 20000; x += 1000) {
+    for (db::Coord y = 0; y < 20000; y += 1000) {
+      ly.cell (top).shapes (l1).insert (db::Box (x, y, x + 100, y + 100));
+    }
+  }
+  ly.cell (top).shapes (l1).insert (db::Box (90000, 90000, 91000, 91000));
+
+  size_t nx = 0, ny = 0, ntiles = 0;
+  std::set<std::pair<size_t, size_t> > tiles;
+
+  //  without subdivision, the tile grid is the regular one
+  run_adaptive_index_test (ly, top, l1, 1000, nx, ny, tiles, ntiles);
+
+  EXPECT_EQ (ntiles, size_t (16));
+  EXPECT_EQ (nx, size_t (4));
+  EXPECT_EQ (ny, size_t (4));
+  EXPECT_EQ (tiles.size (), size_t (16));
+  EXPECT_EQ (tiles.begin ()->first, size_t (0));
+  EXPECT_EQ (tiles.begin ()->second, size_t (0));
+  EXPECT_EQ (tiles.rbegin ()->first, size_t (3));
+  EXPECT_EQ (tiles.rbegin ()->second, size_t (3));
+
+  //  one level of subdivision in the lower left tile: the grid is twice as fine
+  nx = ny = 0;
+  tiles.clear ();
+  run_adaptive_index_test (ly, top, l1, 200, nx, ny, tiles, ntiles);
+
+  EXPECT_EQ (ntiles, size_t (19));
+  EXPECT_EQ (nx, size_t (8));
+  EXPECT_EQ (ny, size_t (8));
+  EXPECT_EQ (tiles.size (), size_t (19));
+  EXPECT_EQ (tiles.find (std::make_pair (size_t (1), size_t (1))) != tiles.end (), true);
+  EXPECT_EQ (tiles.find (std::make_pair (size_t (2), size_t (0))) != tiles.end (), true);
+  EXPECT_EQ (tiles.find (std::make_pair (size_t (1), size_t (2))) != tiles.end (), false);
+  EXPECT_EQ (tiles.rbegin ()->first, size_t (6));
+  EXPECT_EQ (tiles.rbegin ()->second, size_t (6));
+}
+
+static std::string run_stream_writer_test (tl::TestBase *_this, const std::string &fn, db::TileStreamWriter::Mode mode, size_t threads)
+{
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type top = ly.add_cell ("TOP");
+
+  for (db::Coord x = 0; x < 20000; x += 1500) {
+    for (db::Coord y = 0; y < 20000; y += 1500) {
+      ly.cell (top).shapes (l1).insert (db::Box (x, y, x + 1000, y + 700));
+    }
+  }
+  ly.cell (top).shapes (l1).insert (db::Text ("T", db::Trans (db::Vector (100, 200))));
+
+  db::Region r_ref;
+
+  {
+    db::TilingProcessor tp;
+    tp.tile_size (5.0, 5.0);
+    tp.input ("a", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+    tp.output ("o", r_ref);
+    tp.queue ("_output(o, a.sized(100))");
+    tp.execute ("test");
+  }
+
+  std::string path = _this->tmp_file (fn);
+
+  {
+    db::TileStreamWriter writer (path, ly.dbu (), "RESULT", mode);
+
+    db::TilingProcessor tp;
+    tp.set_threads (threads);
+    tp.tile_size (5.0, 5.0);
+    tp.input ("a", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+    tp.input ("t", db::RecursiveShapeIterator (ly, ly.cell (top), l1), db::ICplxTrans (), db::TilingProcessor::TypeTexts);
+    tp.output ("o", writer, db::LayerProperties (100, 0));
+    tp.output ("ot", writer, db::LayerProperties (101, 0));
+    //  two scripts per tile: the results of both end up in the same tile cell
+    tp.queue ("_output(o, a.sized(100))");
+    tp.queue ("_output(ot, t)");
+    tp.execute ("test");
+
+    if (mode == db::TileStreamWriter::Merged) {
+      EXPECT_EQ (writer.tile_cells (), size_t (0));
+    }
+
+    writer.close ();
+    EXPECT_EQ (writer.is_open (), false);
+  }
+
+  db::Layout ly_in;
+  {
+    tl::InputStream is (path);
+    db::Reader reader (is);
+    reader.read (ly_in);
+  }
+
+  std::pair<bool, db::cell_index_type> res_top = ly_in.cell_by_name ("RESULT");
+  EXPECT_EQ (res_top.first, true);
+  EXPECT_EQ (ly_in.cell (res_top.second).is_top (), true);
+
+  db::Region r_out (db::RecursiveShapeIterator (ly_in, ly_in.cell (res_top.second), ly_in.get_layer (db::LayerProperties (100, 0))));
+  EXPECT_EQ ((r_out ^ r_ref).empty (), true);
+
+  db::Texts t_out (db::RecursiveShapeIterator (ly_in, ly_in.cell (res_top.second), ly_in.get_layer (db::LayerProperties (101, 0))));
+  EXPECT_EQ (t_out.to_string (), "('T',r0 100,200)");
+
+  //  the names of the tile cells in sorted order
+  std::set<std::string> names;
+  for (db::Layout::const_iterator c = ly_in.begin (); c != ly_in.end (); ++c) {
+    if (c->cell_index () != res_top.second) {
+      names.insert (ly_in.cell_name (c->cell_index ()));
+    }
+  }
+
+  return tl::join (std::vector<std::string> (names.begin (), names.end ()), ",");
+}
+
+//  TileStreamWriter
+TEST(7)
+{
+  //  one cell per tile - the text is in the lower left tile
+  std::string tiles =
+    "TILE_0_0,TILE_0_1,TILE_0_2,TILE_0_3,TILE_0_4,"
+    "TILE_1_0,TILE_1_1,TILE_1_2,TILE_1_3,TILE_1_4,"
+    "TILE_2_0,TILE_2_1,TILE_2_2,TILE_2_3,TILE_2_4,"
+    "TILE_3_0,TILE_3_1,TILE_3_2,TILE_3_3,TILE_3_4,"
+    "TILE_4_0,TILE_4_1,TILE_4_2,TILE_4_3,TILE_4_4";
+
+  EXPECT_EQ (run_stream_writer_test (_this, "tiles.gds", db::TileStreamWriter::CellPerTile, 1), tiles);
+  EXPECT_EQ (run_stream_writer_test (_this, "tiles.oas", db::TileStreamWriter::CellPerTile, 1), tiles);
+  EXPECT_EQ (run_stream_writer_test (_this, "tiles_merged.gds", db::TileStreamWriter::Merged, 1), "");
+  EXPECT_EQ (run_stream_writer_test (_this, "tiles_merged.oas", db::TileStreamWriter::Merged, 1), "");
+
+  //  tiles computed at the same time still give one cell per tile
+  EXPECT_EQ (run_stream_writer_test (_this, "tiles_mt.oas", db::TileStreamWriter::CellPerTile, 3), tiles);
+  EXPECT_EQ (run_stream_writer_test (_this, "tiles_mt4.gds", db::TileStreamWriter::CellPerTile, 4), tiles);
+}
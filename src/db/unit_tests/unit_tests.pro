@@ -62,6 +62,7 @@ SOURCES = \
     dbLayoutTests.cc \
     dbLayerMappingTests.cc \
     dbLayerTests.cc \
+    dbFillToolTests.cc \
     dbExpressionTests.cc \
     dbEdgesToContoursTests.cc \
     dbEdgesTests.cc \
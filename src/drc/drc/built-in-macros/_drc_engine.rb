@@ -30,6 +30,8 @@ module DRC
       @dbu_read = false
       use_dbu(@def_layout && @def_layout.dbu)
       @output_layout = nil
+      @tile_output = nil
+      @tile_writer = nil
       @output_rdb = nil
       @output_rdb_file = nil
       @output_rdb_cell = nil
@@ -572,6 +574,9 @@ module DRC
     # choice of the tile size) and multi-CPU support is enabled (see \threads).
     # To disable tiling mode use \flat or \deep. 
     #
+    # Tiles covering dense areas are subdivided automatically, so the tiles
+    # require a similar amount of work (see "adaptive=" in TilingProcessor).
+    #
     # Tiling mode will disable deep mode (see \deep).
     
     def tiles(tx, ty = nil)
@@ -682,6 +687,10 @@ module DRC
     # parallelization. Still, all tiles must be processed before the 
     # operation proceeds with the next statement. 
     #
+    # In flat mode without tiling, the width, space, notch, isolated,
+    # separation, overlap, inside and enclosing checks on polygon layers
+    # use the given number of threads too.
+    #
     # Without an argument, "threads" will return the current number of 
     # threads
     
@@ -696,6 +705,68 @@ module DRC
       self.threads(n)
     end
     
+    # %DRC%
+    # @name processes
+    # @brief Specifies the number of worker processes to use in tiling mode
+    # @synopsis processes(n)
+    # @synopsis processes
+    # If a non-zero number of processes is given, tiles are distributed 
+    # over the given number of worker processes instead of threads of the
+    # current process. Each worker process uses the number of threads 
+    # specified with \threads. The worker processes are started using the
+    # "strmtile" tool. This feature is effective in tiling mode only.
+    #
+    # Without an argument, "processes" will return the current number of 
+    # processes.
+    
+    def processes(n = nil)
+      if n
+        @tprocesses = n.to_i
+      end
+      @tprocesses || 0
+    end
+
+    def processes=(n)
+      self.processes(n)
+    end
+    
+    # %DRC%
+    # @name tile_output
+    # @brief Specifies whether layers are written to the target file tile by tile
+    # @synopsis tile_output(mode)
+    # @synopsis tile_output
+    # If this mode is enabled and the target is a file (see \target), layers sent 
+    # to "output" are not collected in an output layout. Instead each layer is written 
+    # to the file tile by tile as soon as it is output. Each tile is written when it is 
+    # complete and the engine does not keep the layer afterwards, so the flat output 
+    # does not need to be kept in memory. The tiles are taken from \tiles. Without tiles, 
+    # the layers are written in one piece. The file format needs to be GDS2 or OASIS.
+    #
+    # "mode" can be ":per_tile" to write the results of each tile into a cell 
+    # of its own (named "TILE_ix_iy") which is placed in the target cell, or 
+    # ":merged" to write all results into the target cell directly. "false" or "nil"
+    # disables this mode. As the layers are written one after another, every further
+    # layer adds a cell per tile in ":per_tile" mode (named "TILE_ix_iy_n"). 
+    # Unlike the normal output, sending data to the same layer twice 
+    # will add to the layer rather than replacing it.
+    #
+    # Without an argument, "tile_output" will return the current mode.
+    
+    def tile_output(*args)
+      if args.size > 0
+        mode = args[0]
+        if mode && mode != :per_tile && mode != :merged
+          raise("Invalid mode for 'tile_output' - must be :per_tile, :merged, false or nil")
+        end
+        @tile_output = mode
+      end
+      @tile_output
+    end
+
+    def tile_output=(mode)
+      self.tile_output(mode)
+    end
+    
     # %DRC%
     # @name deep_reject_odd_polygons
     # @brief Gets or sets a value indicating whether the reject odd polygons in deep mode
@@ -1890,6 +1961,12 @@ CODE
       end
     end
     
+    # the number of threads for flat checks: in tiling mode, the tiles
+    # are already distributed over the threads
+    def _check_threads
+      (@tx && @ty) ? 0 : (@tt || 0)
+    end
+
     def _tcmd(obj, border, result_cls, method, *args)
     
       if @tx && @ty
@@ -1901,11 +1978,13 @@ CODE
         bx = [ @bx || 0.0, border * self.dbu ].max
         by = [ @by || 0.0, border * self.dbu ].max
         tp.tile_border(bx, by)
+        tp.adaptive = true
 
         res = result_cls.new      
         tp.output("res", res)
         tp.input("self", obj)
         tp.threads = (@tt || 1)
+        tp.processes = (@tprocesses || 0)
         args.each_with_index do |a,i|
           if a.is_a?(RBA::Edges) || a.is_a?(RBA::Region) || a.is_a?(RBA::EdgePairs) || a.is_a?(RBA::Texts)
             tp.input("a#{i}", a)
@@ -1953,6 +2032,7 @@ CODE
         bx = [ @bx || 0.0, border * self.dbu ].max
         by = [ @by || 0.0, border * self.dbu ].max
         tp.tile_border(bx, by)
+        tp.adaptive = true
 
         res1 = result_cls1.new
         tp.output("res1", res1)
@@ -1961,6 +2041,7 @@ CODE
         res = [ res1, res2 ]
         tp.input("self", obj)
         tp.threads = (@tt || 1)
+        tp.processes = (@tprocesses || 0)
         args.each_with_index do |a,i|
           if a.is_a?(RBA::Edges) || a.is_a?(RBA::Region) || a.is_a?(RBA::EdgePairs) || a.is_a?(RBA::Texts)
             tp.input("a#{i}", a)
@@ -2004,12 +2085,14 @@ CODE
         tp = RBA::TilingProcessor::new
         tp.tile_size(@tx, @ty)
         tp.tile_border(border * self.dbu, border * self.dbu)
+        tp.adaptive = true
 
         res = RBA::Value::new
         res.value = 0.0
         tp.output("res", res)
         tp.input("self", obj)
         tp.threads = (@tt || 1)
+        tp.processes = (@tprocesses || 0)
         tp.queue("_output(res, _tile ? self.#{method}(_tile.bbox) : self.#{method})")
         run_timed("\"#{method}\" in: #{src_line}", obj) do
           tp.execute("Tiled \"#{method}\" in: #{src_line}")
@@ -2087,7 +2170,10 @@ CODE
         end
       
         # save the output file if requested
-        if @output_layout && @output_layout_file
+        if @tile_writer
+          info("Completing layout file: #{@output_layout_file} ..")
+          @tile_writer.close
+        elsif @output_layout && @output_layout_file
           opt = RBA::SaveLayoutOptions::new
           gzip = opt.set_format_from_filename(@output_layout_file)
           info("Writing layout file: #{@output_layout_file} ..")
@@ -2178,6 +2264,10 @@ CODE
 
       ensure
 
+        # close the tile output file if not done already
+        @tile_writer && @tile_writer.is_open? && @tile_writer.close
+        @tile_writer = nil
+
         @output_layers = []
         @output_layout = nil
         @output_layout_file = nil
@@ -2373,6 +2463,12 @@ CODE
           iter = RBA::RecursiveShapeIterator::new(layout, layout.cell(cell_index), layers)
         end
         iter.shape_flags = shape_flags
+
+        if @verbose && ! layers.empty?
+          # the flat counts are cached by the layout, so this estimate is cheap
+          n = layers.inject(0) { |sum,l| sum + layout.cell(cell_index).flat_shape_count(l) }
+          info("Input has #{n} shapes (flat, upper estimate)", 1)
+        end
         
         sel.each do |s|
           if s == "-"
@@ -2439,21 +2535,6 @@ CODE
       
       else 
 
-        if @output_layout 
-          output = @output_layout
-          if @output_cell
-            output_cell = @output_cell
-          elsif @def_cell
-            output_cell = @output_layout.cell(@def_cell.name) || @output_layout.create_cell(@def_cell.name)
-          end
-          output_cell || raise("No output cell specified (see 'target' instruction)")
-        else
-          output = @def_layout
-          output || raise("No output layout specified")
-          output_cell = @output_cell || @def_cell
-          output_cell || raise("No output cell specified")
-        end
-
         info = nil
         if args.size == 1
           if args[0].is_a?(1.class)
@@ -2470,6 +2551,27 @@ CODE
         else
           raise("Invalid number of arguments - one, two or three arguments expected")
         end
+
+        if @tile_output && @output_layout_file
+          _tile_output(data, info)
+          return
+        end
+
+        if @output_layout 
+          output = @output_layout
+          if @output_cell
+            output_cell = @output_cell
+          elsif @def_cell
+            output_cell = @output_layout.cell(@def_cell.name) || @output_layout.create_cell(@def_cell.name)
+          end
+          output_cell || raise("No output cell specified (see 'target' instruction)")
+        else
+          output = @def_layout
+          output || raise("No output layout specified")
+          output_cell = @output_cell || @def_cell
+          output_cell || raise("No output cell specified")
+        end
+
         li = output.find_layer(info)
         if !li
           li = output.insert_layer(info)
@@ -2514,6 +2616,39 @@ CODE
       end        
     end
     
+    def _tile_output(data, lp)
+
+      if data.is_a?(RBA::EdgePairs)
+        data = data.polygons(1)
+      end
+
+      if !@tile_writer
+        opt = RBA::SaveLayoutOptions::new
+        opt.set_format_from_filename(@output_layout_file)
+        cellname = (@output_cell && @output_cell.name) || (@def_cell && @def_cell.name) || "TOP"
+        info("Writing layout file tile by tile: #{@output_layout_file} ..")
+        @tile_writer = RBA::TileStreamWriter::new(@output_layout_file, self.dbu, cellname, @tile_output != :merged, opt)
+      end
+
+      # the writer receives the results of each tile as they are computed
+      # and writes a tile when it is complete
+      tp = RBA::TilingProcessor::new
+      tp.dbu = self.dbu
+      tp.scale_to_dbu = false
+      if @tx && @ty
+        tp.tile_size(@tx, @ty)
+      end
+      tp.threads = (@tt || 1)
+      tp.input("i", data)
+      tp.output("o", @tile_writer, lp)
+      tp.queue("_output(o, i)")
+
+      run_timed("\"output\" tile by tile in: #{src_line}", data) do
+        tp.execute("Tiled output")
+      end
+
+    end
+    
     def make_source(layout, cell = nil, path = nil)
       name = "layout" + @lnum.to_s
       @lnum += 1
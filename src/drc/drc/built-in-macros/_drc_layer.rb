@@ -3413,6 +3413,8 @@ CODE
             elsif rect_filter != RBA::Region::NoRectFilter
               raise("A rectangle error filter cannot be used with this check")
             end
+            args << false   # negative
+            args << @engine._check_threads
           elsif shielded != nil
             raise("Shielding can only be used for polygon layers")
           elsif opposite_filter != RBA::Region::NoOppositeFilter
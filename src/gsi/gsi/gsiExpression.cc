@@ -71,6 +71,38 @@ public:
     std::vector<const gsi::MethodBase *> m = m_methods;
     std::sort(m.begin (), m.end ());
     m_methods.assign (m.begin (), std::unique (m.begin (), m.end ()));
+
+    //  precompute the methods which are identified by the number of arguments alone,
+    //  so the overload resolution can be skipped for them
+    size_t max_args = 0;
+    for (method_iterator i = begin (); i != end (); ++i) {
+      max_args = std::max (max_args, size_t (std::distance ((*i)->begin_arguments (), (*i)->end_arguments ())));
+    }
+
+    m_unique_candidates.clear ();
+    m_unique_candidates.resize (max_args + 1, 0);
+
+    for (size_t argc = 0; argc <= max_args; ++argc) {
+
+      const gsi::MethodBase *meth = 0;
+      int candidates = 0;
+
+      for (method_iterator i = begin (); i != end (); ++i) {
+        if ((*i)->is_signal ()) {
+          //  signals need to go through the full resolution which reports them
+          candidates = 2;
+          break;
+        } else if (! (*i)->is_callback () && (*i)->compatible_with_num_args ((unsigned int) argc)) {
+          ++candidates;
+          meth = *i;
+        }
+      }
+
+      if (candidates == 1) {
+        m_unique_candidates [argc] = meth;
+      }
+
+    }
   }
 
   method_iterator begin () const
@@ -83,9 +115,20 @@ public:
     return m_methods.end ();
   }
 
+  /**
+   *  @brief Gets the method uniquely identified by the given number of arguments
+   *  If the method is not unique, 0 is returned and the full overload resolution
+   *  needs to be performed.
+   */
+  const gsi::MethodBase *unique_candidate (size_t argc) const
+  {
+    return argc < m_unique_candidates.size () ? m_unique_candidates [argc] : 0;
+  }
+
 private:
   std::string m_name;
   std::vector<const gsi::MethodBase *> m_methods;
+  std::vector<const gsi::MethodBase *> m_unique_candidates;
 };
 
 /**
@@ -137,6 +180,14 @@ public:
     return m_table[mid].end ();
   }
 
+  /**
+   *  @brief Gets the method for method ID mid which is uniquely identified by the number of arguments
+   */
+  const gsi::MethodBase *unique_candidate (size_t mid, size_t argc) const
+  {
+    return m_table[mid].unique_candidate (argc);
+  }
+
   static const ExpressionMethodTable *method_table_by_class (const gsi::ClassBase *cls_decl)
   {
     const ExpressionMethodTable *mt = dynamic_cast<const ExpressionMethodTable *>(cls_decl->gsi_data ());
@@ -1380,18 +1431,27 @@ VariantUserClassImpl::execute_gsi (const tl::ExpressionParserContext & /*context
     throw tl::Exception (tl::to_string (tr ("Unknown method")) + " '" + method + "' of class '" + clsact->name () + "'");
   }
 
-  const gsi::MethodBase *meth = 0;
+  //  use the precomputed method if the number of arguments is sufficient to identify it
+  const gsi::MethodBase *meth = mt->unique_candidate (mid, args.size ());
   int candidates = 0;
 
-  for (ExpressionMethodTableEntry::method_iterator m = mt->begin (mid); m != mt->end (mid); ++m) {
+  if (meth) {
+
+    candidates = 1;
+
+  } else {
+
+    for (ExpressionMethodTableEntry::method_iterator m = mt->begin (mid); m != mt->end (mid); ++m) {
+
+      if ((*m)->is_signal()) {
+        throw tl::Exception (tl::sprintf (tl::to_string (tr ("Signals are not supported inside expressions (event %s)")), method.c_str ()));
+      } else if ((*m)->is_callback()) {
+        //  ignore callbacks
+      } else if ((*m)->compatible_with_num_args ((unsigned int) args.size ())) {
+        ++candidates;
+        meth = *m;
+      }
 
-    if ((*m)->is_signal()) {
-      throw tl::Exception (tl::sprintf (tl::to_string (tr ("Signals are not supported inside expressions (event %s)")), method.c_str ()));
-    } else if ((*m)->is_callback()) {
-      //  ignore callbacks
-    } else if ((*m)->compatible_with_num_args ((unsigned int) args.size ())) {
-      ++candidates;
-      meth = *m;
     }
 
   }
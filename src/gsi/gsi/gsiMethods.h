@@ -276,6 +276,27 @@ public:
     return m_static;
   }
 
+  /**
+   *  @brief Gets a value indicating whether script interpreters may run other threads while this method executes
+   *
+   *  If this flag is set, an interpreter may release its global lock while the method is called.
+   *  The method must not access interpreter objects except through callbacks and events.
+   *  Other threads may use the interpreter at the same time, so the objects involved must not
+   *  be shared with such threads.
+   */
+  bool allow_threads () const
+  {
+    return m_allow_threads;
+  }
+
+  /**
+   *  @brief Sets a value indicating whether script interpreters may run other threads while this method executes
+   */
+  void set_allow_threads (bool f)
+  {
+    m_allow_threads = f;
+  }
+
   /**
    *  @brief Gets a value indicator whether the method is a constructor
    *
@@ -570,6 +591,7 @@ private:
   bool m_const : 1;
   bool m_static : 1;
   bool m_protected : 1;
+  bool m_allow_threads : 1;
   unsigned int m_argsize;
   std::vector<MethodSynonym> m_method_synonyms;
 
@@ -696,6 +718,23 @@ public:
     return *this;
   }
 
+  /**
+   *  @brief Declares the methods as being allowed to run concurrently with other interpreter threads
+   *
+   *  See MethodBase::allow_threads for details. Use this for long-running methods, e.g.
+   *
+   *  @code
+   *  gsi::method ("read", &X::read, ...).allow_threads () +
+   *  @endcode
+   */
+  Methods &allow_threads ()
+  {
+    for (std::vector<MethodBase *>::iterator m = m_methods.begin (); m != m_methods.end (); ++m) {
+      (*m)->set_allow_threads (true);
+    }
+    return *this;
+  }
+
   iterator begin () const
   {
     return m_methods.begin ();
@@ -1213,6 +1213,8 @@ static gsi::Class<C_P> decl_c ("", "C",
   gsi::method ("pass_cd_ptr_as_copy", gsi::return_copy (), &C_P::pass_cd_ptr) +
   gsi::method ("pass_cd_ptr_as_ref", gsi::return_reference (), &C_P::pass_cd_ptr) +
   gsi::method ("g", &C_P::g) +
+  //  for testing callbacks from methods running without the interpreter lock
+  gsi::method ("g_allow_threads", &C_P::g).allow_threads () +
   gsi::method ("s1", &C::s1) +
   gsi::method ("s2", &C::s2) +
   gsi::method ("s2clr", &C::s2clr) +
@@ -565,3 +565,19 @@ TEST(9)
   EXPECT_EQ (collect_func->values[1], 14400);
   EXPECT_EQ (collect_func->values[2], 19600);
 }
+
+//  std::vector<char> is a byte array in all passing modes, also in builds without Qt
+TEST(10)
+{
+  EXPECT_EQ (gsi::type_traits<std::vector<char> >::code () == gsi::T_byte_array, true);
+  EXPECT_EQ (gsi::type_traits<const std::vector<char> &>::code () == gsi::T_byte_array, true);
+  EXPECT_EQ (gsi::type_traits<std::vector<char> &>::code () == gsi::T_byte_array, true);
+  EXPECT_EQ (gsi::type_traits<const std::vector<char> *>::code () == gsi::T_byte_array, true);
+  EXPECT_EQ (gsi::type_traits<std::vector<char> *>::code () == gsi::T_byte_array, true);
+
+  EXPECT_EQ (gsi::type_traits<const std::vector<char> &>::is_cref (), true);
+  EXPECT_EQ (gsi::type_traits<std::vector<char> *>::is_ptr (), true);
+
+  //  other vectors are lists
+  EXPECT_EQ (gsi::type_traits<const std::vector<int> &>::code () == gsi::T_vector, true);
+}
@@ -339,6 +339,11 @@ static void save_image_with_options (lay::LayoutView *view, const std::string &f
   view->save_image_with_options (fn, width, height, linewidth, oversampling, resolution, QColor (), QColor (), QColor (), target_box, monochrome); 
 }
 
+static void save_images_with_options (lay::LayoutView *view, const std::vector<std::string> &fns, const std::vector<db::DBox> &target_boxes, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, bool monochrome, int threads, const std::vector<std::vector<unsigned int> > &layer_sets)
+{
+  view->save_images_with_options (fns, target_boxes, layer_sets, width, height, linewidth, oversampling, resolution, QColor (), QColor (), QColor (), monochrome, threads);
+}
+
 static std::vector<std::string> 
 get_config_names (lay::LayoutView *view)
 {
@@ -1185,6 +1190,30 @@ Class<lay::LayoutView> decl_LayoutView (QT_EXTERNAL_BASE (QWidget) "lay", "Layou
     "\n"
     "This method has been introduced in 0.23.10.\n"
   ) +
+  gsi::method_ext ("save_images_with_options", &save_images_with_options, gsi::arg ("filenames"), gsi::arg ("targets"), gsi::arg ("width"), gsi::arg ("height"), gsi::arg ("linewidth", 0), gsi::arg ("oversampling", 0), gsi::arg ("resolution", 0.0), gsi::arg ("monochrome", false), gsi::arg ("threads", 1), gsi::arg ("layer_sets", std::vector<std::vector<unsigned int> > (), "[]"),
+    "@brief Saves a batch of images of the layout to the given files (with options)\n"
+    "\n"
+    "@param filenames The files to which to write the images to.\n"
+    "@param targets The boxes to draw (one per file). An empty box stands for the current viewport.\n"
+    "@param width The width of the images to render in pixel.\n"
+    "@param height The height of the images to render in pixel.\n"
+    "@param linewidth The width of a line in pixels (usually 1) or 0 for default.\n"
+    "@param oversampling The oversampling factor (1..3) or 0 for default.\n"
+    "@param resolution The resolution (pixel size compared to a screen pixel, i.e 1/oversampling) or 0 for default.\n"
+    "@param monochrome If true, monochrome images will be produced.\n"
+    "@param threads The number of images rendered concurrently. 0 renders the images synchroneously.\n"
+    "@param layer_sets The layers to draw per image. Each entry is a list of layer IDs (see \\LayerPropertiesNode#id) of leaf layer nodes.\n"
+    "\n"
+    "This method is equivalent to calling \\save_image_with_options for each target box, but the layout is prepared "
+    "only once and the images are rendered concurrently. Hence it is suitable for producing a large number of snapshots, "
+    "for example for review reports. "
+    "The images are written as PNG files.\n"
+    "\n"
+    "If a layer set is given for an image, only those of the visible layers which are listed in the set are drawn. "
+    "If no layer set or an empty one is given for an image, all visible layers are drawn.\n"
+    "\n"
+    "This method has been introduced in 0.27.\n"
+  ) +
   gsi::method_ext ("#save_as", &save_as2, gsi::arg ("index"), gsi::arg ("filename"), gsi::arg ("gzip"), gsi::arg ("options"),
     "@brief Saves a layout to the given stream file\n"
     "\n"
@@ -42,6 +42,8 @@
 
 #include <sstream>
 #include <algorithm>
+#include <list>
+#include <memory>
 
 namespace lay
 {
@@ -776,8 +778,8 @@ LayoutCanvas::image (unsigned int width, unsigned int height)
   return image_with_options (width, height, -1, -1, -1.0, QColor (), QColor (), QColor (), db::DBox (), false); 
 }
 
-QImage 
-LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active, const db::DBox &target_box, bool is_mono) 
+void
+LayoutCanvas::normalize_image_options (int &linewidth, int &oversampling, double &resolution, QColor &background, QColor &foreground, QColor &active) const
 {
   if (oversampling <= 0) {
     oversampling = m_oversampling;
@@ -797,7 +799,36 @@ LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int l
   if (active == QColor ()) {
     active = active_color ();
   }
+}
+
+QImage 
+LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active, const db::DBox &target_box, bool is_mono) 
+{
+  normalize_image_options (linewidth, oversampling, resolution, background, foreground, active);
+
+  //  provide canvas objects for the layout bitmaps
+  BitmapRedrawThreadCanvas rd_canvas;
+
+  //  compute the new viewport 
+  db::DBox tb (target_box);
+  if (tb.empty ()) {
+    tb = m_viewport.target_box ();
+  }
+  Viewport vp (width * oversampling, height * oversampling, tb);
+  vp.set_global_trans (m_viewport.global_trans ());
+
+  lay::RedrawThread redraw_thread (&rd_canvas, mp_view);
 
+  //  render the layout
+  redraw_thread.start (0 /*synchroneous*/, m_layers, vp, resolution, true);
+  redraw_thread.stop (); // safety
+
+  return compose_image (rd_canvas, vp, width, height, linewidth, resolution, background, foreground, active, is_mono);
+}
+
+QImage
+LayoutCanvas::compose_image (lay::BitmapRedrawThreadCanvas &rd_canvas, const lay::Viewport &vp, unsigned int width, unsigned int height, int linewidth, double resolution, QColor background, QColor foreground, QColor active, bool is_mono)
+{
   //  TODO: for other architectures MonoLSB may not be the right format
   QImage img (width, height, is_mono ? QImage::Format_MonoLSB : QImage::Format_RGB32);
 
@@ -813,17 +844,8 @@ LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int l
     img.fill (background.rgb ());
   }
 
-  //  provide canvas objects for the layout bitmaps and the foreground/background objects
-  BitmapRedrawThreadCanvas rd_canvas;
-  DetachedViewObjectCanvas vo_canvas (background, foreground, active, width * oversampling, height * oversampling, resolution, &img);
-
-  //  compute the new viewport 
-  db::DBox tb (target_box);
-  if (tb.empty ()) {
-    tb = m_viewport.target_box ();
-  }
-  Viewport vp (width * oversampling, height * oversampling, tb);
-  vp.set_global_trans (m_viewport.global_trans ());
+  //  provide a canvas object for the foreground/background objects
+  DetachedViewObjectCanvas vo_canvas (background, foreground, active, vp.width (), vp.height (), resolution, &img);
 
   std::vector<lay::ViewOp> view_ops (m_view_ops); 
   if (linewidth > 1) {
@@ -832,12 +854,6 @@ LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int l
     }
   }
 
-  lay::RedrawThread redraw_thread (&rd_canvas, mp_view);
-
-  //  render the layout
-  redraw_thread.start (0 /*synchroneous*/, m_layers, vp, resolution, true);
-  redraw_thread.stop (); // safety
-
   //  paint the background objects. It uses "img" to paint on.
   if (! is_mono) {
 
@@ -867,6 +883,104 @@ LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int l
   return img;
 }
 
+namespace
+{
+
+/**
+ *  @brief A rendering slot for LayoutCanvas::images_with_options
+ *
+ *  Each slot provides a bitmap canvas and a redraw thread of its own. The redraw
+ *  threads of different slots run concurrently and share the layout objects.
+ */
+struct SnapshotSlot
+{
+  SnapshotSlot (lay::LayoutView *view)
+    : redraw_thread (&canvas, view), index (0)
+  { }
+
+  lay::BitmapRedrawThreadCanvas canvas;
+  lay::RedrawThread redraw_thread;
+  lay::Viewport vp;
+  size_t index;
+};
+
+}
+
+void
+LayoutCanvas::images_with_options (const std::vector<lay::SnapshotSpec> &specs, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active, bool is_mono, int threads, lay::SnapshotReceiver *receiver)
+{
+  tl_assert (receiver != 0);
+
+  normalize_image_options (linewidth, oversampling, resolution, background, foreground, active);
+
+  size_t nslots = threads > 0 ? size_t (threads) : size_t (1);
+  int workers_per_slot = threads > 0 ? 1 : 0;
+
+  //  NOTE: the slots are created and started from this thread only. The layouts
+  //  are updated by the first start and remain unchanged while the batch is rendered.
+  std::list<std::unique_ptr<SnapshotSlot> > slots;
+  std::list<SnapshotSlot *> free_slots, running_slots;
+
+  size_t next = 0;
+  while (next < specs.size () || ! running_slots.empty ()) {
+
+    //  fill the free slots with new requests
+    while (next < specs.size () && (! free_slots.empty () || slots.size () < nslots)) {
+
+      SnapshotSlot *slot;
+      if (free_slots.empty ()) {
+        slot = new SnapshotSlot (mp_view);
+        slots.push_back (std::unique_ptr<SnapshotSlot> (slot));
+      } else {
+        slot = free_slots.front ();
+        free_slots.pop_front ();
+      }
+
+      const lay::SnapshotSpec &spec = specs [next];
+
+      db::DBox tb (spec.target_box);
+      if (tb.empty ()) {
+        tb = m_viewport.target_box ();
+      }
+      slot->vp = Viewport (width * oversampling, height * oversampling, tb);
+      slot->vp.set_global_trans (m_viewport.global_trans ());
+      slot->index = next++;
+
+      std::vector<lay::RedrawLayerInfo> layers (m_layers);
+      if (! spec.layers.empty ()) {
+        std::vector<bool> selected (layers.size (), false);
+        for (std::vector<unsigned int>::const_iterator l = spec.layers.begin (); l != spec.layers.end (); ++l) {
+          if (*l < selected.size ()) {
+            selected [*l] = true;
+          }
+        }
+        for (size_t i = 0; i < layers.size (); ++i) {
+          if (! selected [i]) {
+            layers [i].visible = false;
+            layers [i].enabled = false;
+          }
+        }
+      }
+
+      slot->redraw_thread.start (workers_per_slot, layers, slot->vp, resolution, true);
+      running_slots.push_back (slot);
+
+    }
+
+    //  deliver the results in the order of the requests
+    SnapshotSlot *slot = running_slots.front ();
+    running_slots.pop_front ();
+
+    slot->redraw_thread.wait ();
+    slot->redraw_thread.stop (); // safety
+
+    receiver->image_ready (slot->index, compose_image (slot->canvas, slot->vp, width, height, linewidth, resolution, background, foreground, active, is_mono));
+
+    free_slots.push_back (slot);
+
+  }
+}
+
 QImage 
 LayoutCanvas::screenshot () 
 {
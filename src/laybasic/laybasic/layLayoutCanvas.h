@@ -50,6 +50,52 @@ namespace lay
 class LayoutView;
 class RedrawThread;
 
+/**
+ *  @brief Describes one image of a snapshot batch
+ *
+ *  See LayoutCanvas::images_with_options for details.
+ */
+struct SnapshotSpec
+{
+  SnapshotSpec ()
+  { }
+
+  SnapshotSpec (const db::DBox &box, const std::vector<unsigned int> &l = std::vector<unsigned int> ())
+    : target_box (box), layers (l)
+  { }
+
+  /**
+   *  @brief The box to draw or an empty box for the current viewport
+   */
+  db::DBox target_box;
+
+  /**
+   *  @brief The indexes of the redraw layers to draw
+   *
+   *  The indexes refer to the redraw layer list (see LayoutCanvas::get_redraw_layers).
+   *  If this list is empty, all visible layers are drawn.
+   */
+  std::vector<unsigned int> layers;
+};
+
+/**
+ *  @brief A receiver for the images produced by LayoutCanvas::images_with_options
+ */
+class SnapshotReceiver
+{
+public:
+  SnapshotReceiver () { }
+  virtual ~SnapshotReceiver () { }
+
+  /**
+   *  @brief Delivers the image for the snapshot with the given index
+   *
+   *  This method is called from the thread that called images_with_options.
+   *  The images are delivered in the order of the snapshot specs.
+   */
+  virtual void image_ready (size_t index, const QImage &image) = 0;
+};
+
 /**
  *  @brief A class representing one entry in the image cache
  */
@@ -169,6 +215,17 @@ public:
   QImage image (unsigned int width, unsigned int height);
   QImage image_with_options (unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, const db::DBox &target_box, bool monochrome);
 
+  /**
+   *  @brief Renders a batch of images
+   *
+   *  This method renders one image per snapshot spec with the given options (see image_with_options).
+   *  The layout is updated once and the images are rendered concurrently with "threads" redraw
+   *  threads which share the layout objects. Each redraw thread uses one worker. If "threads" is 0,
+   *  the images are rendered synchroneously.
+   *  The images are delivered to the receiver in the order of the specs.
+   */
+  void images_with_options (const std::vector<lay::SnapshotSpec> &specs, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, bool monochrome, int threads, lay::SnapshotReceiver *receiver);
+
   void update_image ();
 
   virtual void paintEvent (QPaintEvent *);
@@ -398,6 +455,8 @@ private:
 
   void do_update_image ();
   void do_end_of_drawing ();
+  void normalize_image_options (int &linewidth, int &oversampling, double &resolution, QColor &background, QColor &foreground, QColor &active) const;
+  QImage compose_image (lay::BitmapRedrawThreadCanvas &rd_canvas, const lay::Viewport &vp, unsigned int width, unsigned int height, int linewidth, double resolution, QColor background, QColor foreground, QColor active, bool is_mono);
   void do_redraw_all (bool force_redraw = true);
 
   void prepare_drawing ();
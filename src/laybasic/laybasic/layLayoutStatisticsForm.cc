@@ -28,7 +28,7 @@
 #include "tlExpression.h"
 #include "tlTimer.h"
 #include "dbLayoutQuery.h"
-#include "dbCellGraphUtils.h"
+#include "dbShapeCounts.h"
 
 #include <set>
 #include <sstream>
@@ -379,129 +379,6 @@ StatisticsTemplateProcessor::process (const QDomElement &element, tl::Eval &eval
 
 // ------------------------------------------------------------
 
-class ShapeStatistics
-{
-public:
-  ShapeStatistics ()
-  {
-    // .. nothing yet ..
-  }
-
-  void compute (const db::Shapes &shapes)
-  {
-    for (db::Shapes::shape_iterator i = shapes.begin (db::ShapeIterator::All); ! i.at_end (); ++i) {
-      size_t n = 1;
-      if (i.in_array ()) {
-        n = i.array ().array_size ();
-        m_count [i.array ().type ()] += 1;
-        i.finish_array ();
-      }
-      m_count [i->type ()] += n;
-    }
-  }
-
-  void operator*= (size_t f)
-  {
-    for (std::map<db::Shape::object_type, size_t>::iterator c = m_count.begin (); c != m_count.end (); ++c) {
-      c->second *= f;
-    }
-  }
-
-  void operator+= (const ShapeStatistics &other)
-  {
-    for (std::map<db::Shape::object_type, size_t>::const_iterator c = other.m_count.begin (); c != other.m_count.end (); ++c) {
-      m_count [c->first] += c->second;
-    }
-  }
-
-  size_t count (db::Shape::object_type t) const
-  {
-    std::map<db::Shape::object_type, size_t>::const_iterator c = m_count.find (t);
-    if (c != m_count.end ()) {
-      return c->second;
-    } else {
-      return 0;
-    }
-  }
-
-  size_t box_total () const
-  {
-    return count (db::Shape::Box) + count (db::Shape::BoxArrayMember) + count (db::Shape::ShortBox) + count (db::Shape::ShortBoxArrayMember);
-  }
-
-  size_t box_single () const
-  {
-    return count (db::Shape::Box) + count (db::Shape::ShortBox);
-  }
-
-  size_t box_array () const
-  {
-    return count (db::Shape::BoxArray) + count (db::Shape::ShortBoxArray);
-  }
-
-  size_t polygon_total () const
-  {
-    return count (db::Shape::Polygon) + count (db::Shape::PolygonRef) + count (db::Shape::PolygonPtrArrayMember)
-         + count (db::Shape::SimplePolygon) + count (db::Shape::SimplePolygonRef) + count (db::Shape::SimplePolygonPtrArrayMember);
-  }
-
-  size_t polygon_single () const
-  {
-    return count (db::Shape::Polygon) + count (db::Shape::PolygonRef)
-         + count (db::Shape::SimplePolygon) + count (db::Shape::SimplePolygonRef);
-  }
-
-  size_t polygon_array () const
-  {
-    return count (db::Shape::PolygonPtrArray) + count (db::Shape::SimplePolygonPtrArray);
-  }
-
-  size_t path_total () const
-  {
-    return count (db::Shape::Path) + count (db::Shape::PathRef) + count (db::Shape::PathPtrArrayMember);
-  }
-
-  size_t path_single () const
-  {
-    return count (db::Shape::Path) + count (db::Shape::PathRef);
-  }
-
-  size_t path_array () const
-  {
-    return count (db::Shape::PathPtrArray);
-  }
-
-  size_t text_total () const
-  {
-    return count (db::Shape::Text) + count (db::Shape::TextRef) + count (db::Shape::TextPtrArrayMember);
-  }
-
-  size_t text_single () const
-  {
-    return count (db::Shape::Text) + count (db::Shape::TextRef);
-  }
-
-  size_t text_array () const
-  {
-    return count (db::Shape::TextPtrArray);
-  }
-
-  size_t edge_total () const
-  {
-    return count (db::Shape::Edge);
-  }
-
-  size_t user_total () const
-  {
-    return count (db::Shape::UserObject);
-  }
-
-private:
-  std::map<db::Shape::object_type, size_t> m_count;
-};
-
-// ------------------------------------------------------------
-
 class StatisticsSource
   : public lay::BrowserSource
 {
@@ -585,49 +462,37 @@ StatisticsSource::get (const std::string &url)
        <<       "</tr>" << std::endl
       ;
 
-    db::CellCounter cc (&layout);
-
-    tl::RelativeProgress progress (tl::to_string (QObject::tr ("Collecting statistics")), layers.size () * layout.cells (), 100000);
+    tl::RelativeProgress progress (tl::to_string (QObject::tr ("Collecting statistics")), layers.size (), 1);
     for (std::vector <unsigned int>::const_iterator l = layers.begin (); l != layers.end (); ++l) {
 
-      ShapeStatistics st_hier;
-      ShapeStatistics st_flat;
-
-      for (db::Layout::top_down_const_iterator c = layout.begin_top_down (); c != layout.end_top_down (); ++c) {
+      //  NOTE: the layout caches the per-cell counts and the cell multiplicities
+      db::ShapeCounts st_hier = layout.shape_counts (*l, false);
+      db::ShapeCounts st_flat = layout.shape_counts (*l, true);
 
-        ShapeStatistics st;
-        st.compute (layout.cell (*c).shapes (*l));
-
-        st_hier += st;
-        st *= cc.weight (*c);
-        st_flat += st;
-
-        ++progress;
-
-      }
+      ++progress;
 
       os <<       "<tr>" << std::endl
          <<         "<td>" << layout.get_properties (*l).to_string () << "</td>" << std::endl
          // Boxes (total, single, array)
-         <<         "<td>" << st_hier.box_total () << "<br></br>" << st_flat.box_total () << "</td>" << std::endl
-         <<         "<td>" << st_hier.box_single () << "<br></br>" << st_flat.box_single () << "</td>" << std::endl
-         <<         "<td>" << st_hier.box_array () << "<br></br>" << st_flat.box_array () << "</td>" << std::endl
+         <<         "<td>" << st_hier.total (db::ShapeCounts::Boxes) << "<br></br>" << st_flat.total (db::ShapeCounts::Boxes) << "</td>" << std::endl
+         <<         "<td>" << st_hier.single (db::ShapeCounts::Boxes) << "<br></br>" << st_flat.single (db::ShapeCounts::Boxes) << "</td>" << std::endl
+         <<         "<td>" << st_hier.arrays (db::ShapeCounts::Boxes) << "<br></br>" << st_flat.arrays (db::ShapeCounts::Boxes) << "</td>" << std::endl
          // Polygons (total, single, array)
-         <<         "<td>" << st_hier.polygon_total () << "<br></br>" << st_flat.polygon_total () << "</td>" << std::endl
-         <<         "<td>" << st_hier.polygon_single () << "<br></br>" << st_flat.polygon_single () << "</td>" << std::endl
-         <<         "<td>" << st_hier.polygon_array () << "<br></br>" << st_flat.polygon_array () << "</td>" << std::endl
+         <<         "<td>" << st_hier.total (db::ShapeCounts::Polygons) << "<br></br>" << st_flat.total (db::ShapeCounts::Polygons) << "</td>" << std::endl
+         <<         "<td>" << st_hier.single (db::ShapeCounts::Polygons) << "<br></br>" << st_flat.single (db::ShapeCounts::Polygons) << "</td>" << std::endl
+         <<         "<td>" << st_hier.arrays (db::ShapeCounts::Polygons) << "<br></br>" << st_flat.arrays (db::ShapeCounts::Polygons) << "</td>" << std::endl
          // Paths (total, single, array)
-         <<         "<td>" << st_hier.path_total () << "<br></br>" << st_flat.path_total () << "</td>" << std::endl
-         <<         "<td>" << st_hier.path_single () << "<br></br>" << st_flat.path_single () << "</td>" << std::endl
-         <<         "<td>" << st_hier.path_array () << "<br></br>" << st_flat.path_array () << "</td>" << std::endl
+         <<         "<td>" << st_hier.total (db::ShapeCounts::Paths) << "<br></br>" << st_flat.total (db::ShapeCounts::Paths) << "</td>" << std::endl
+         <<         "<td>" << st_hier.single (db::ShapeCounts::Paths) << "<br></br>" << st_flat.single (db::ShapeCounts::Paths) << "</td>" << std::endl
+         <<         "<td>" << st_hier.arrays (db::ShapeCounts::Paths) << "<br></br>" << st_flat.arrays (db::ShapeCounts::Paths) << "</td>" << std::endl
          // Texts (total, single, array)
-         <<         "<td>" << st_hier.text_total () << "<br></br>" << st_flat.text_total () << "</td>" << std::endl
-         <<         "<td>" << st_hier.text_single () << "<br></br>" << st_flat.text_single () << "</td>" << std::endl
-         <<         "<td>" << st_hier.text_array () << "<br></br>" << st_flat.text_array () << "</td>" << std::endl
+         <<         "<td>" << st_hier.total (db::ShapeCounts::Texts) << "<br></br>" << st_flat.total (db::ShapeCounts::Texts) << "</td>" << std::endl
+         <<         "<td>" << st_hier.single (db::ShapeCounts::Texts) << "<br></br>" << st_flat.single (db::ShapeCounts::Texts) << "</td>" << std::endl
+         <<         "<td>" << st_hier.arrays (db::ShapeCounts::Texts) << "<br></br>" << st_flat.arrays (db::ShapeCounts::Texts) << "</td>" << std::endl
          // Edges (total)
-         <<         "<td>" << st_hier.edge_total () << "<br></br>" << st_flat.edge_total () << "</td>" << std::endl
+         <<         "<td>" << st_hier.total (db::ShapeCounts::Edges) << "<br></br>" << st_flat.total (db::ShapeCounts::Edges) << "</td>" << std::endl
          // User objects (total)
-         <<         "<td>" << st_hier.user_total () << "<br></br>" << st_flat.user_total () << "</td>" << std::endl
+         <<         "<td>" << st_hier.total (db::ShapeCounts::UserObjects) << "<br></br>" << st_flat.total (db::ShapeCounts::UserObjects) << "</td>" << std::endl
          // ...
          <<         "<td>" << tl::to_string (QObject::tr ("(hier)")) << "<br></br>" << tl::to_string (QObject::tr ("(flat)")) << "</td>" << std::endl
          <<       "</tr>" << std::endl
@@ -423,6 +423,7 @@ LayoutView::init (db::Manager *mgr, QWidget * /*parent*/)
   m_default_font_size = lay::FixedFont::default_font_size ();
   m_text_lazy_rendering = true;
   m_bitmap_caching = true;
+  m_progressive_rendering = false;
   m_show_properties = false;
   m_apply_text_trans = true;
   m_default_text_size = 0.1;
@@ -1320,6 +1321,13 @@ LayoutView::configure (const std::string &name, const std::string &value)
     bitmap_caching (flag);
     return true;
 
+  } else if (name == cfg_progressive_rendering) {
+
+    bool flag;
+    tl::from_string (value, flag);
+    progressive_rendering (flag);
+    return true;
+
   } else if (name == cfg_text_lazy_rendering) {
 
     bool flag;
@@ -3050,6 +3058,109 @@ LayoutView::save_image_with_options (const std::string &fn,
   tl::log << "Saved screen shot to " << fn;
 }
 
+namespace
+{
+
+/**
+ *  @brief A snapshot receiver writing the images to PNG files
+ */
+class PNGSnapshotWriter
+  : public lay::SnapshotReceiver
+{
+public:
+  PNGSnapshotWriter (const lay::LayoutView *view, const std::vector<std::string> &fns, const std::vector<db::DBox> &boxes)
+    : mp_view (view), mp_fns (&fns), mp_boxes (&boxes)
+  { }
+
+  virtual void image_ready (size_t index, const QImage &image)
+  {
+    const std::string &fn = (*mp_fns) [index];
+
+    QImageWriter writer (tl::to_qstring (fn), QByteArray ("PNG"));
+
+    //  Unfortunately the PNG writer does not allow writing of long strings.
+    //  We separate the description into a set of keys:
+
+    for (unsigned int i = 0; i < mp_view->cellviews (); ++i) {
+      if (mp_view->cellview (i).is_valid ()) {
+        std::string name = mp_view->cellview (i)->layout ().cell_name (mp_view->cellview (i).cell_index ());
+        writer.setText (tl::to_qstring ("Cell" + tl::to_string (int (i) + 1)), tl::to_qstring (name));
+      }
+    }
+
+    lay::Viewport vp (image.width (), image.height (), (*mp_boxes) [index]);
+    writer.setText (QString::fromUtf8 ("Rect"), tl::to_qstring (vp.box ().to_string ()));
+
+    if (! writer.write (image)) {
+      throw tl::Exception (tl::to_string (QObject::tr ("Unable to write screenshot to file: %s (%s)")), fn, tl::to_string (writer.errorString ()));
+    }
+
+    if (tl::verbosity () >= 11) {
+      tl::log << "Saved screen shot to " << fn;
+    }
+  }
+
+private:
+  const lay::LayoutView *mp_view;
+  const std::vector<std::string> *mp_fns;
+  const std::vector<db::DBox> *mp_boxes;
+};
+
+}
+
+void
+LayoutView::save_images_with_options (const std::vector<std::string> &fns, const std::vector<db::DBox> &target_boxes, const std::vector<std::vector<unsigned int> > &layer_sets,
+                                      unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution,
+                                      QColor background, QColor foreground, QColor active, bool monochrome, int threads)
+{
+  tl::SelfTimer timer (tl::verbosity () >= 11, tl::to_string (QObject::tr ("Save images")));
+
+  if (fns.size () != target_boxes.size ()) {
+    throw tl::Exception (tl::to_string (QObject::tr ("The number of file names (%d) does not match the number of target boxes (%d)")), int (fns.size ()), int (target_boxes.size ()));
+  }
+
+  //  map the layer properties node IDs to the indexes of the layers the canvas draws
+  const std::vector<lay::RedrawLayerInfo> &redraw_layers = mp_canvas->get_redraw_layers ();
+  std::map<unsigned int, unsigned int> id2index;
+  for (std::vector<lay::RedrawLayerInfo>::const_iterator l = redraw_layers.begin (); l != redraw_layers.end (); ++l) {
+    if (l->node_id != 0) {
+      id2index.insert (std::make_pair (l->node_id, (unsigned int) (l - redraw_layers.begin ())));
+    }
+  }
+
+  std::vector<lay::SnapshotSpec> specs;
+  specs.reserve (target_boxes.size ());
+
+  std::vector<db::DBox> boxes;
+  boxes.reserve (target_boxes.size ());
+
+  for (size_t i = 0; i < target_boxes.size (); ++i) {
+
+    specs.push_back (lay::SnapshotSpec (target_boxes [i]));
+
+    if (i < layer_sets.size ()) {
+      for (std::vector<unsigned int>::const_iterator id = layer_sets [i].begin (); id != layer_sets [i].end (); ++id) {
+        std::map<unsigned int, unsigned int>::const_iterator li = id2index.find (*id);
+        if (li == id2index.end ()) {
+          throw tl::Exception (tl::to_string (QObject::tr ("Not a valid layer ID for image #%d: %d")), int (i), int (*id));
+        }
+        specs.back ().layers.push_back (li->second);
+      }
+    }
+
+    boxes.push_back (target_boxes [i].empty () ? mp_canvas->viewport ().target_box () : target_boxes [i]);
+
+  }
+
+  //  Execute all deferred methods - ensure there are no pending tasks
+  tl::DeferredMethodScheduler::execute ();
+
+  PNGSnapshotWriter writer (this, fns, boxes);
+  mp_canvas->images_with_options (specs, width, height, linewidth, oversampling, resolution, background, foreground, active, monochrome, threads, &writer);
+
+  tl::log << "Saved " << fns.size () << " screen shot(s)";
+}
+
 void
 LayoutView::reload_layout (unsigned int cv_index)
 {
@@ -3923,6 +4034,7 @@ LayoutView::redraw ()
   for (lay::LayerPropertiesConstIterator l = begin_layers (); !l.at_end (); ++l) {
     if (! l->has_children ()) {
       layers.push_back (RedrawLayerInfo (*l));
+      layers.back ().node_id = l->id ();
     }
   }
 
@@ -5120,6 +5232,15 @@ LayoutView::bitmap_caching (bool l)
   }
 }
 
+void 
+LayoutView::progressive_rendering (bool l)
+{
+  if (m_progressive_rendering != l) {
+    m_progressive_rendering = l;
+    redraw ();
+  }
+}
+
 void 
 LayoutView::text_lazy_rendering (bool l)
 {
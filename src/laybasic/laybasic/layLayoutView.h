@@ -926,6 +926,22 @@ public:
    */
   void save_image_with_options (const std::string &fn, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, const db::DBox &target_box, bool monochrome);
 
+  /**
+   *  @brief Save a batch of image files with some options
+   *
+   *  This method renders one image per target box and writes it to the file with the same index.
+   *  The layout is shared by all images and the images are rendered concurrently on the given
+   *  number of threads.
+   *
+   *  @param fns The paths of the files to write
+   *  @param target_boxes The boxes to draw (one per file, an empty box for the current viewport)
+   *  @param layer_sets The layers to draw per image (IDs of leaf layer properties nodes). If this list is shorter than the list of files or an entry is empty, all visible layers are drawn.
+   *  @param threads The number of images to render concurrently (0 for synchroneous rendering)
+   *
+   *  For the other parameters see save_image_with_options.
+   */
+  void save_images_with_options (const std::vector<std::string> &fns, const std::vector<db::DBox> &target_boxes, const std::vector<std::vector<unsigned int> > &layer_sets, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, bool monochrome, int threads);
+
   /**
    *  @brief Get the screen content as a QImage object with the given width and height
    */
@@ -1106,6 +1122,24 @@ public:
     return m_bitmap_caching;
   }
 
+  /** 
+   *  @brief Enable or disable progressive rendering
+   *
+   *  In progressive rendering mode, each layer is drawn in several passes.
+   *  The first passes draw the shapes and instances which are large on the screen.
+   *  The last pass draws the remaining details. This way, a first useful 
+   *  picture is available earlier.
+   */
+  void progressive_rendering (bool en);
+
+  /** 
+   *  @brief Gets a value indicating whether progressive rendering is enabled
+   */
+  bool progressive_rendering () 
+  {
+    return m_progressive_rendering;
+  }
+
   /** 
    *  @brief Lazy rendering of text objects
    */
@@ -2816,6 +2850,7 @@ private:
   bool m_text_visible;
   bool m_text_lazy_rendering;
   bool m_bitmap_caching;
+  bool m_progressive_rendering;
   bool m_show_properties;
   QColor m_text_color;
   bool m_apply_text_trans;
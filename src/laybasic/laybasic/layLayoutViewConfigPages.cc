@@ -599,6 +599,9 @@ LayoutViewConfigPage3f::setup (lay::Dispatcher *root)
   root->config_get (cfg_bitmap_caching, flag);
   mp_ui->bitmap_caching_cbx->setChecked (flag);
 
+  root->config_get (cfg_progressive_rendering, flag);
+  mp_ui->progressive_rendering_cbx->setChecked (flag);
+
   n = 0;
   root->config_get (cfg_image_cache_size, n);
   mp_ui->image_cache_size_spbx->setValue (int (n));
@@ -622,6 +625,7 @@ LayoutViewConfigPage3f::commit (lay::Dispatcher *root)
 
   root->config_set (cfg_text_lazy_rendering, mp_ui->text_lazy_rendering_cbx->isChecked ());
   root->config_set (cfg_bitmap_caching, mp_ui->bitmap_caching_cbx->isChecked ());
+  root->config_set (cfg_progressive_rendering, mp_ui->progressive_rendering_cbx->isChecked ());
 
   root->config_set (cfg_image_cache_size, mp_ui->image_cache_size_spbx->value ());
 }
@@ -1541,6 +1545,7 @@ public:
     options.push_back (std::pair<std::string, std::string> (cfg_text_visible, "true"));
     options.push_back (std::pair<std::string, std::string> (cfg_text_lazy_rendering, "true"));
     options.push_back (std::pair<std::string, std::string> (cfg_bitmap_caching, "true"));
+    options.push_back (std::pair<std::string, std::string> (cfg_progressive_rendering, "false"));
     options.push_back (std::pair<std::string, std::string> (cfg_show_properties, "false"));
     options.push_back (std::pair<std::string, std::string> (cfg_apply_text_trans, "true"));
     options.push_back (std::pair<std::string, std::string> (cfg_global_trans, "r0"));
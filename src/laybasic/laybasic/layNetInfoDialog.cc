@@ -83,6 +83,9 @@ size_t count_shapes (db::LayoutToNetlist *l2ndb, db::Net *net, unsigned int laye
     return 0;
   }
 
+  //  binary databases deliver the net geometry on demand
+  l2ndb->ensure_net_geometry (*net);
+
   db::cell_index_type cell_index = net->circuit ()->cell_index ();
   size_t cluster_id = net->cluster_id ();
 
@@ -250,6 +253,10 @@ void NetInfoDialog::update_info_text ()
 
       const db::Net *net = mp_nets.front ();
       const db::Layout *ly = mp_l2ndb->internal_layout ();
+
+      //  binary databases deliver the net geometry on demand
+      mp_l2ndb->ensure_net_geometry (*net);
+
       db::cell_index_type cell_index = net->circuit ()->cell_index ();
       size_t cluster_id = net->cluster_id ();
 
@@ -426,7 +426,7 @@ BEGIN_PROTECTED
     if (lvsdb && ! browser_page->is_netlist_mode ()) {
 
       //  prepare and open the file dialog
-      lay::FileDialog save_dialog (this, tl::to_string (QObject::tr ("Save LVS Database")), "KLayout LVS DB files (*.lvsdb)");
+      lay::FileDialog save_dialog (this, tl::to_string (QObject::tr ("Save LVS Database")), "KLayout LVS DB files (*.lvsdb);;KLayout binary LVS DB files (*.lvsdbb)");
       std::string fn (lvsdb->filename ());
       if (save_dialog.get_save (fn)) {
 
@@ -440,7 +440,7 @@ BEGIN_PROTECTED
     } else if (l2ndb) {
 
       //  prepare and open the file dialog
-      lay::FileDialog save_dialog (this, tl::to_string (QObject::tr ("Save Netlist Database")), "KLayout L2N DB files (*.l2n)");
+      lay::FileDialog save_dialog (this, tl::to_string (QObject::tr ("Save Netlist Database")), "KLayout L2N DB files (*.l2n);;KLayout binary L2N DB files (*.l2nb)");
       std::string fn (l2ndb->filename ());
       if (save_dialog.get_save (fn)) {
 
@@ -500,7 +500,7 @@ BEGIN_PROTECTED
     fmts += ";;" + rdr->file_format ();
   }
 #else
-  fmts += ";;L2N DB files (*.l2n);;LVS DB files (*.lvsdb)";
+  fmts += ";;L2N DB files (*.l2n);;LVS DB files (*.lvsdb);;Binary L2N DB files (*.l2nb);;Binary LVS DB files (*.lvsdbb)";
   //  TODO: add plain spice
 #endif
 
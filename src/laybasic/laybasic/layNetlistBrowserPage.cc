@@ -1015,6 +1015,9 @@ NetlistBrowserPage::adjust_view ()
 
     } else if (net) {
 
+      //  binary databases deliver the net geometry on demand
+      mp_database->ensure_net_geometry (*net);
+
       db::cell_index_type cell_index = net->circuit ()->cell_index ();
       size_t cluster_id = net->cluster_id ();
 
@@ -1160,6 +1163,9 @@ NetlistBrowserPage::produce_highlights_for_net (const db::Net *net, size_t &n_ma
 {
   const db::Layout *layout = mp_database->internal_layout ();
 
+  //  binary databases deliver the net geometry on demand
+  mp_database->ensure_net_geometry (*net);
+
   db::cell_index_type cell_index = net->circuit ()->cell_index ();
   size_t cluster_id = net->cluster_id ();
 
@@ -42,6 +42,7 @@ RedrawLayerInfo::RedrawLayerInfo (const lay::LayerProperties &lp)
   prop_sel         = lp.prop_sel ();
   inverse_prop_sel = lp.inverse_prop_sel ();
   enabled          = true;
+  node_id          = 0;
 }
 
 }
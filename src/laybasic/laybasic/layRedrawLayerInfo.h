@@ -117,6 +117,14 @@ struct RedrawLayerInfo
    */
   bool inverse_prop_sel;
 
+  /**
+   *  @brief The ID of the layer properties node this entry was made from
+   *
+   *  This member is 0 if the entry was not made from a layer properties node.
+   *  It is set by LayoutView::redraw.
+   */
+  unsigned int node_id;
+
   /**
    *  @brief Returns true, if the layer needs to be drawn
    */
@@ -24,12 +24,23 @@
 #include "layRedrawThreadWorker.h"
 #include "layRedrawThread.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+
 namespace lay
 {
 
 //  time delay until the first snapshot is taken
 const int first_snapshot_delay = 20;
 
+//  the minimum object sizes (in pixels) of the coarse passes in progressive rendering mode (terminated by 0)
+static const double progressive_min_sizes [] = { 64.0, 8.0, 0.0 };
+
+//  the lock protecting the cellview references held by the workers: the references
+//  are released from the worker threads and several redraw threads may be active
+//  at the same time (i.e. for batch snapshots).
+static QMutex s_cellview_ref_lock;
+
 // -------------------------------------------------------------
 
 static inline db::Box safe_transformed_box (const db::Box &box, const db::ICplxTrans &t)
@@ -64,6 +75,10 @@ RedrawThreadWorker::RedrawThreadWorker (RedrawThread *redraw_thread)
   m_text_visible = false;
   m_text_lazy_rendering = false;
   m_bitmap_caching = false;
+  m_progressive_rendering = false;
+  m_min_size = 0.0;
+  m_max_size = 0.0;
+  m_first_frame_pending = false;
   m_show_properties = false;
   m_apply_text_trans = false;
   m_default_text_size = 0.0;
@@ -207,10 +222,59 @@ RedrawThreadWorker::perform_task (tl::Task *task)
           mp_renderer->set_font (db::Font (m_text_font));
           mp_renderer->apply_text_trans (m_apply_text_trans);
 
-          for (std::vector<db::DCplxTrans>::const_iterator t = li.trans.begin (); t != li.trans.end (); ++t) {
-            db::CplxTrans trans = m_vp_trans * *t * db::CplxTrans (mp_layout->dbu ());
-            iterate_variants (m_redraw_region, ci, trans, &RedrawThreadWorker::draw_layer);
-            iterate_variants (text_redraw_regions, ci, trans, &RedrawThreadWorker::draw_text_layer);
+          if (m_progressive_rendering) {
+
+            //  coarse passes: draw the objects which are large on the screen first and
+            //  deliver a frame after each pass. Each pass draws the objects between its
+            //  minimum size and the minimum size of the previous pass only.
+            for (const double *ms = progressive_min_sizes; *ms > 0.0; ++ms) {
+
+              m_max_size = (ms == progressive_min_sizes ? 0.0 : ms [-1]);
+              m_min_size = *ms;
+              try {
+                for (std::vector<db::DCplxTrans>::const_iterator t = li.trans.begin (); t != li.trans.end (); ++t) {
+                  db::CplxTrans trans = m_vp_trans * *t * db::CplxTrans (mp_layout->dbu ());
+                  iterate_variants (m_redraw_region, ci, trans, &RedrawThreadWorker::draw_layer);
+                }
+                m_min_size = m_max_size = 0.0;
+              } catch (...) {
+                m_min_size = m_max_size = 0.0;
+                throw;
+              }
+
+              transfer ();
+              mp_redraw_thread->wakeup ();
+
+              if (m_first_frame_pending) {
+                m_first_frame_pending = false;
+                if (tl::verbosity () >= 21) {
+                  tl::info << tl::to_string (QObject::tr ("First progressive frame delivered after ")) << int ((tl::Clock::current () - m_start_clock).seconds () * 1000.0 + 0.5) << " ms";
+                }
+              }
+
+            }
+
+          }
+
+          //  final pass: draw the objects which have not been drawn in the coarse passes
+          //  (but complete cells into the bitmap cache)
+          m_max_size = 0.0;
+          if (m_progressive_rendering) {
+            for (const double *ms = progressive_min_sizes; *ms > 0.0; ++ms) {
+              m_max_size = *ms;
+            }
+          }
+
+          try {
+            for (std::vector<db::DCplxTrans>::const_iterator t = li.trans.begin (); t != li.trans.end (); ++t) {
+              db::CplxTrans trans = m_vp_trans * *t * db::CplxTrans (mp_layout->dbu ());
+              iterate_variants (m_redraw_region, ci, trans, &RedrawThreadWorker::draw_layer);
+              iterate_variants (text_redraw_regions, ci, trans, &RedrawThreadWorker::draw_text_layer);
+            }
+            m_max_size = 0.0;
+          } catch (...) {
+            m_max_size = 0.0;
+            throw;
           }
 
         } else if (li.cell_frame) {
@@ -469,7 +533,10 @@ void
 RedrawThreadWorker::finish ()
 {
   //  release all cellview references here.
-  m_cellviews.clear ();
+  {
+    QMutexLocker locker (&s_cellview_ref_lock);
+    m_cellviews.clear ();
+  }
 
   //  free the planes
   for (unsigned int i = 0; i < sizeof (m_planes) / sizeof (m_planes[0]); ++i) {
@@ -523,6 +590,11 @@ RedrawThreadWorker::setup (LayoutView *view, RedrawThreadCanvas *canvas, const s
   m_text_visible = view->text_visible ();
   m_text_lazy_rendering = view->text_lazy_rendering ();
   m_bitmap_caching = view->bitmap_caching ();
+  m_progressive_rendering = view->progressive_rendering ();
+  m_min_size = 0.0;
+  m_max_size = 0.0;
+  m_first_frame_pending = m_progressive_rendering;
+  m_start_clock = tl::Clock::current ();
   m_show_properties = view->show_properties_as_text ();
   m_apply_text_trans = view->apply_text_trans ();
   m_default_text_size = view->default_text_size ();
@@ -539,10 +611,13 @@ RedrawThreadWorker::setup (LayoutView *view, RedrawThreadCanvas *canvas, const s
 
   m_hidden_cells = view->hidden_cells ();
 
-  m_cellviews.clear ();
-  m_cellviews.reserve (view->cellviews ());
-  for (unsigned int i = 0; i < view->cellviews (); ++i) {
-    m_cellviews.push_back (view->cellview (i));
+  {
+    QMutexLocker locker (&s_cellview_ref_lock);
+    m_cellviews.clear ();
+    m_cellviews.reserve (view->cellviews ());
+    for (unsigned int i = 0; i < view->cellviews (); ++i) {
+      m_cellviews.push_back (view->cellview (i));
+    }
   }
 
   m_nlayers = mp_redraw_thread->num_layers (); 
@@ -760,6 +835,8 @@ RedrawThreadWorker::draw_boxes (bool drawing_context, db::cell_index_type ci, co
           db::Cell::touching_iterator inst = cell.begin_touching (*v);
           while (! inst.at_end ()) {
 
+            checkpoint ();
+
             const db::CellInstArray &cell_inst = inst->cell_inst ();
 
             db::cell_index_type new_ci = cell_inst.object ().cell_index ();
@@ -953,6 +1030,8 @@ RedrawThreadWorker::draw_box_properties (bool drawing_context, db::cell_index_ty
           db::Cell::touching_iterator inst = cell.begin_touching (*v); 
           while (! inst.at_end ()) {
 
+            checkpoint ();
+
             const db::CellInstArray &cell_inst = inst->cell_inst ();
             db::properties_id_type cell_inst_prop = inst->prop_id ();
 
@@ -1208,6 +1287,12 @@ skip_quad (const db::Box &qb, const lay::Bitmap *vertex_bitmap, const db::CplxTr
   }
 }
 
+inline bool
+smaller_than (const db::DBox &box, double size)
+{
+  return box.width () < size && box.height () < size;
+}
+
 inline void 
 copy_bitmap (const lay::Bitmap *from, lay::Bitmap *to, int dx, int dy)
 {
@@ -1408,6 +1493,8 @@ RedrawThreadWorker::draw_text_layer (bool drawing_context, db::cell_index_type c
           db::Cell::touching_iterator inst = cell.begin_touching (*v); 
           while (! inst.at_end ()) {
 
+            checkpoint ();
+
             //  skip this quad if we have drawn something here already
             size_t qid = inst.quad_id ();
             bool skip = false;
@@ -1626,6 +1713,26 @@ RedrawThreadWorker::draw_layer_wo_cache (int from_level, int to_level, db::cell_
           continue;
         }
 
+        //  in the coarse passes of progressive rendering, skip the objects which are too small
+        if (m_min_size > 0.0) {
+          if (smaller_than (trans * shape.quad_box (), m_min_size)) {
+            shape.skip_quad ();
+            continue;
+          } else if (shape.in_array () && smaller_than (trans * shape.array ().bbox (), m_min_size)) {
+            shape.finish_array ();
+            continue;
+          } else if (smaller_than (trans * shape->bbox (), m_min_size)) {
+            ++shape;
+            continue;
+          }
+        }
+
+        //  in progressive rendering, skip the objects which have been drawn in a previous pass already
+        if (m_max_size > 0.0 && ! smaller_than (trans * shape->bbox (), m_max_size)) {
+          ++shape;
+          continue;
+        }
+
         if (shape.in_array ()) {
 
           if (last_array != shape.array ()) {
@@ -1718,6 +1825,11 @@ RedrawThreadWorker::draw_layer_wo_cache (int from_level, int to_level, db::cell_
           skip = skip_quad (inst.quad_box () & bbox, vertex_bitmap, trans);
         }  
 
+        //  in the coarse passes of progressive rendering, skip the instances which are too small
+        if (! skip && m_min_size > 0.0 && smaller_than (trans * inst.quad_box (), m_min_size)) {
+          skip = true;
+        }
+
         if (skip) {
 
           //  move on to the next quad
@@ -1732,6 +1844,18 @@ RedrawThreadWorker::draw_layer_wo_cache (int from_level, int to_level, db::cell_
           bool hidden = (m_cv_index < int (m_hidden_cells.size ()) && m_hidden_cells [m_cv_index].find (new_ci) != m_hidden_cells [m_cv_index].end ());
 
           db::Box new_cell_box = mp_layout->cell (new_ci).bbox (m_layer);
+
+          if (m_min_size > 0.0 && ! new_cell_box.empty ()) {
+            //  all shapes of the instance are smaller than the instance itself
+            double inst_size = trans.ctrans (std::max (new_cell_box.width (), new_cell_box.height ()));
+            if (cell_inst.is_complex ()) {
+              inst_size *= cell_inst.complex_trans ().mag ();
+            }
+            if (inst_size < m_min_size) {
+              continue;
+            }
+          }
+
           if (! new_cell_box.empty () && ! hidden) {
 
             db::Vector a, b;
@@ -1890,6 +2014,11 @@ RedrawThreadWorker::draw_layer (int from_level, int to_level, db::cell_index_typ
     return;
   }
 
+  //  Nothing to draw in the coarse passes of progressive rendering
+  if (m_min_size > 0.0 && smaller_than (trans * bbox, m_min_size)) {
+    return;
+  }
+
   //  For small bboxes, the cell outline can be reduced ..
   if (m_drop_small_cells && drop_cell (cell, trans)) {
     return;
@@ -1928,7 +2057,8 @@ RedrawThreadWorker::draw_layer (int from_level, int to_level, db::cell_index_typ
 
       //  use the presence of a lay::Bitmap for the drawing plane as an indicator that we can cache the 
       //  drawings
-      bool can_cache = (m_bitmap_caching && dynamic_cast<lay::Bitmap *> (fill) != 0);
+      //  don't cache in the coarse passes of progressive rendering as these will not render all shapes
+      bool can_cache = (m_bitmap_caching && m_min_size <= 0.0 && dynamic_cast<lay::Bitmap *> (fill) != 0);
 
       //  don't cache if the cell is not fully inside the search region
       if (vv.size () > 1 || ! cell_bbox.inside (vv.front ())) {
@@ -1979,7 +2109,17 @@ RedrawThreadWorker::draw_layer (int from_level, int to_level, db::cell_index_typ
           //  this object is responsible for doing updates when a snapshot is taken
           UpdateSnapshotWithCache update_cached_snapshot (update_snapshot, &trans, &cached_cell->second, fill, frame, vertex, text);
 
-          draw_layer_wo_cache (from_level, to_level, ci, drawing_trans, vv, level, cached_cell->second.fill, cached_cell->second.frame, cached_cell->second.vertex, cached_cell->second.text, &update_cached_snapshot);
+          //  the cached bitmaps need to hold the complete cell, including the objects drawn
+          //  in the coarse passes of progressive rendering
+          double max_size = m_max_size;
+          m_max_size = 0.0;
+          try {
+            draw_layer_wo_cache (from_level, to_level, ci, drawing_trans, vv, level, cached_cell->second.fill, cached_cell->second.frame, cached_cell->second.vertex, cached_cell->second.text, &update_cached_snapshot);
+            m_max_size = max_size;
+          } catch (...) {
+            m_max_size = max_size;
+            throw;
+          }
 
         }
         cached_cell->second.hits++;
@@ -2192,6 +2332,8 @@ RedrawThreadWorker::iterate_variants_rec (const std::vector <db::Box> &redraw_re
     //  one level up ..
     while (! p.at_end ()) {
 
+      checkpoint ();
+
       db::Cell::cell_inst_array_type pi = (*p).inst ();
 
       db::cell_index_type new_ci = pi.object ().cell_index ();
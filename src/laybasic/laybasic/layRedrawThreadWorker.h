@@ -216,6 +216,11 @@ private:
   bool m_text_visible;
   bool m_text_lazy_rendering;
   bool m_bitmap_caching;
+  bool m_progressive_rendering;
+  double m_min_size;
+  double m_max_size;
+  bool m_first_frame_pending;
+  tl::Clock m_start_clock;
   bool m_show_properties;
   bool m_apply_text_trans;
   double m_default_text_size;
@@ -839,6 +839,7 @@ private:
       if (cell) {
 
         //  look up all categories used inside this cell and determine top-level categories to insert into the cell node.
+        //  For databases loaded from binary files, this loads the items of the cell when the node is expanded.
 
         std::set <rdb::id_type> category_ids;
         std::pair<rdb::Database::const_item_ref_iterator, rdb::Database::const_item_ref_iterator> be = mp_database->items_by_cell (id);
@@ -888,6 +889,7 @@ private:
       const rdb::Category *category = mp_database->category_by_id (id);
       if (category) {
 
+        //  for databases loaded from binary files, this loads the items of the category when the node is expanded
         std::set <rdb::id_type> cell_ids;
         std::pair<rdb::Database::const_item_ref_iterator, rdb::Database::const_item_ref_iterator> be = mp_database->items_by_category (id);
         for (rdb::Database::const_item_ref_iterator c = be.first; c != be.second; ++c) {
@@ -153,6 +153,7 @@ public:
       tl::make_member (&db::DXFReaderOptions::render_texts_as_polygons, "render-texts-as-polygons") +
       tl::make_member (&db::DXFReaderOptions::keep_other_cells, "keep-other-cells") +
       tl::make_member (&db::DXFReaderOptions::keep_layer_names, "keep-layer-names") +
+      tl::make_member (&db::DXFReaderOptions::streaming_mode, "streaming-mode") +
       tl::make_member (&db::DXFReaderOptions::create_other_layers, "create-other-layers") +
       tl::make_member (&db::DXFReaderOptions::layer_map, "layer-map")
     );
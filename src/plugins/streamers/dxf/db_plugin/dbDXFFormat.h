@@ -53,7 +53,8 @@ public:
       render_texts_as_polygons (false),
       keep_other_cells (false),
       create_other_layers (true),
-      keep_layer_names (false)
+      keep_layer_names (false),
+      streaming_mode (false)
   {
     //  .. nothing yet ..
   }
@@ -170,6 +171,18 @@ public:
    */
   bool keep_layer_names;
 
+  /**
+   *  @brief A flag indicating whether contours are closed in streaming mode
+   *
+   *  In polyline modes 3 and 4, the lines are joined into contours. By default,
+   *  the edges are collected per block and joined when the block is finished.
+   *  In streaming mode, the lines are joined into contours while the file is read
+   *  and closed contours are merged into polygons in batches. This reduces the
+   *  memory required for large files. With a contour accuracy larger than zero,
+   *  lines may be joined differently than in non-streaming mode.
+   */
+  bool streaming_mode;
+
   /**
    *  @brief Implementation of FormatSpecificReaderOptions
    */
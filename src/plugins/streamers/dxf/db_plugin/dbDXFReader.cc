@@ -29,6 +29,8 @@
 #include "dbEdgeProcessor.h"
 #include "dbEdgesToContours.h"
 #include "dbVariableWidthPath.h"
+#include "dbBoxScanner.h"
+#include "dbBoxConvert.h"
 
 #include "tlException.h"
 #include "tlString.h"
@@ -36,7 +38,9 @@
 #include "tlClassRegistry.h"
 
 #include <cctype>
+#include <cmath>
 #include <set>
+#include <algorithm>
 
 #if defined(HAVE_QT)
 # include <QString>
@@ -50,6 +54,400 @@
 namespace db
 {
 
+// ---------------------------------------------------------------
+//  DXFContourCloser
+
+namespace
+{
+
+/**
+ *  @brief A receiver for the box scanner collecting the polygons interacting with new contours
+ */
+struct DXFInteractingPolygons
+  : public db::box_scanner_receiver2<db::Box, size_t, db::Polygon, size_t>
+{
+  DXFInteractingPolygons (std::vector<bool> &selected)
+    : mp_selected (&selected)
+  { }
+
+  void add (const db::Box *, const size_t &, const db::Polygon *, const size_t &p)
+  {
+    (*mp_selected) [p] = true;
+  }
+
+  std::vector<bool> *mp_selected;
+};
+
+/**
+ *  @brief Integer division rounding towards negative infinity
+ */
+inline db::Coord
+grid_div (db::Coord c, db::Coord g)
+{
+  int64_t cc = c;
+  return db::Coord (cc >= 0 ? cc / g : -((g - 1 - cc) / g));
+}
+
+}
+
+static const size_t no_end = std::numeric_limits<size_t>::max ();
+
+DXFContourCloser::DXFContourCloser (db::Coord accuracy, bool auto_close, size_t batch_size)
+  : m_accuracy (std::max (db::Coord (0), accuracy)), m_grid (std::max (db::Coord (1), accuracy)),
+    m_auto_close (auto_close), m_batch_size (batch_size),
+    m_polygon_points (0), m_open_points (0), m_max_pending_points (0), m_batches (0)
+{
+  //  .. nothing yet ..
+}
+
+db::Point
+DXFContourCloser::end_key (const db::Point &p) const
+{
+  if (m_grid == 1) {
+    return p;
+  } else {
+    return db::Point (grid_div (p.x (), m_grid), grid_div (p.y (), m_grid));
+  }
+}
+
+const db::Point &
+DXFContourCloser::end_point (size_t end) const
+{
+  const Contour &c = m_contours [end / 2];
+  return (end & 1) != 0 ? c.back () : c.front ();
+}
+
+void
+DXFContourCloser::register_end (size_t end)
+{
+  m_ends.insert (std::make_pair (end_key (end_point (end)), end));
+}
+
+void
+DXFContourCloser::unregister_end (size_t end)
+{
+  std::pair<end_map::iterator, end_map::iterator> r = m_ends.equal_range (end_key (end_point (end)));
+  for (end_map::iterator i = r.first; i != r.second; ++i) {
+    if (i->second == end) {
+      m_ends.erase (i);
+      return;
+    }
+  }
+
+  tl_assert (false);
+}
+
+size_t
+DXFContourCloser::find_end (const db::Point &p, size_t exclude) const
+{
+  size_t best = no_end;
+  double dmin = 0.0;
+
+  db::Point k1 = end_key (p - db::Vector (m_accuracy, m_accuracy));
+  db::Point k2 = end_key (p + db::Vector (m_accuracy, m_accuracy));
+
+  for (db::Coord kx = k1.x (); kx <= k2.x (); ++kx) {
+    for (db::Coord ky = k1.y (); ky <= k2.y (); ++ky) {
+
+      std::pair<end_map::const_iterator, end_map::const_iterator> r = m_ends.equal_range (db::Point (kx, ky));
+      for (end_map::const_iterator i = r.first; i != r.second; ++i) {
+
+        if (i->second == exclude) {
+          continue;
+        }
+
+        const db::Point &q = end_point (i->second);
+        if (std::abs (q.x () - p.x ()) <= m_accuracy && std::abs (q.y () - p.y ()) <= m_accuracy) {
+          //  take the closest end point and the first contour for equal distances
+          double d = q.sq_double_distance (p);
+          if (best == no_end || d < dmin || (d == dmin && i->second < best)) {
+            best = i->second;
+            dmin = d;
+          }
+        }
+
+      }
+
+    }
+  }
+
+  return best;
+}
+
+size_t
+DXFContourCloser::new_contour ()
+{
+  if (! m_free_contours.empty ()) {
+    size_t c = m_free_contours.back ();
+    m_free_contours.pop_back ();
+    return c;
+  } else {
+    m_contours.push_back (Contour ());
+    return m_contours.size () - 1;
+  }
+}
+
+void
+DXFContourCloser::release_contour (size_t c)
+{
+  //  swap to release the memory
+  std::vector<db::Point> ().swap (m_contours [c].head);
+  std::vector<db::Point> ().swap (m_contours [c].tail);
+  m_contours [c].dir = 0;
+  m_free_contours.push_back (c);
+}
+
+void
+DXFContourCloser::append (size_t end, const db::Point &p, bool forward)
+{
+  unregister_end (end);
+
+  Contour &c = m_contours [end / 2];
+  if ((end & 1) != 0) {
+    c.tail.push_back (p);
+  } else {
+    c.head.push_back (p);
+  }
+
+  //  "forward" is true if the edge runs from the end towards the new point
+  c.dir += (forward == ((end & 1) != 0)) ? 1 : -1;
+
+  ++m_open_points;
+
+  register_end (end);
+}
+
+void
+DXFContourCloser::transfer (size_t to_end, size_t from_end, bool forward)
+{
+  size_t from = from_end / 2;
+
+  unregister_end (from * 2);
+  unregister_end (from * 2 + 1);
+  unregister_end (to_end);
+
+  const Contour &s = m_contours [from];
+  Contour &t = m_contours [to_end / 2];
+  std::vector<db::Point> &target = (to_end & 1) != 0 ? t.tail : t.head;
+
+  //  the source contour keeps its orientation if it is attached to the opposite end
+  t.dir += ((to_end & 1) != (from_end & 1)) ? s.dir : -s.dir;
+
+  //  continue the target contour with the source contour, starting at the connected end
+  if ((from_end & 1) != 0) {
+    target.insert (target.end (), s.tail.rbegin (), s.tail.rend ());
+    target.insert (target.end (), s.head.begin (), s.head.end ());
+  } else {
+    target.insert (target.end (), s.head.rbegin (), s.head.rend ());
+    target.insert (target.end (), s.tail.begin (), s.tail.end ());
+  }
+
+  //  "forward" is true if the connecting edge runs from the target contour to the source contour
+  t.dir += (forward == ((to_end & 1) != 0)) ? 1 : -1;
+
+  release_contour (from);
+
+  register_end (to_end);
+}
+
+void
+DXFContourCloser::close (size_t c)
+{
+  unregister_end (c * 2);
+  unregister_end (c * 2 + 1);
+
+  const Contour &cc = m_contours [c];
+
+  m_closed_starts.push_back (m_closed_points.size ());
+  m_closed_points.insert (m_closed_points.end (), cc.head.rbegin (), cc.head.rend ());
+  m_closed_points.insert (m_closed_points.end (), cc.tail.begin (), cc.tail.end ());
+
+  m_open_points -= cc.size ();
+
+  release_contour (c);
+
+  if (m_closed_points.size () >= std::max (m_batch_size, m_polygon_points / 4)) {
+    flush ();
+  }
+}
+
+void
+DXFContourCloser::update_stats ()
+{
+  m_max_pending_points = std::max (m_max_pending_points, pending_points ());
+}
+
+void
+DXFContourCloser::add (const db::Edge &edge)
+{
+  if (edge.is_degenerate ()) {
+    return;
+  }
+
+  size_t ea = find_end (edge.p1 (), no_end);
+  size_t eb = find_end (edge.p2 (), ea);
+
+  if (ea == no_end && eb == no_end) {
+
+    size_t c = new_contour ();
+    m_contours [c].tail.push_back (edge.p1 ());
+    m_contours [c].tail.push_back (edge.p2 ());
+    m_contours [c].dir = 1;
+    m_open_points += 2;
+
+    register_end (c * 2);
+    register_end (c * 2 + 1);
+
+  } else if (eb == no_end) {
+    append (ea, edge.p2 (), true);
+  } else if (ea == no_end) {
+    append (eb, edge.p1 (), false);
+  } else if (ea / 2 == eb / 2) {
+    close (ea / 2);
+  } else if (m_contours [ea / 2].size () >= m_contours [eb / 2].size ()) {
+    transfer (ea, eb, true);
+  } else {
+    transfer (eb, ea, false);
+  }
+
+  update_stats ();
+}
+
+void
+DXFContourCloser::flush ()
+{
+  if (m_closed_starts.empty ()) {
+    return;
+  }
+
+  ++m_batches;
+
+  std::vector<db::Edge> edges;
+  edges.reserve (m_closed_points.size ());
+
+  std::vector<db::Box> boxes;
+  boxes.reserve (m_closed_starts.size ());
+
+  for (size_t i = 0; i < m_closed_starts.size (); ++i) {
+
+    size_t from = m_closed_starts [i];
+    size_t to = i + 1 < m_closed_starts.size () ? m_closed_starts [i + 1] : m_closed_points.size ();
+
+    db::Box box;
+    for (size_t j = from; j < to; ++j) {
+      box += m_closed_points [j];
+      edges.push_back (db::Edge (m_closed_points [j], m_closed_points [j + 1 < to ? j + 1 : from]));
+    }
+
+    boxes.push_back (box);
+
+  }
+
+  std::vector<db::Point> ().swap (m_closed_points);
+  std::vector<size_t> ().swap (m_closed_starts);
+
+  //  polygons interacting with the new contours need to be merged again
+  if (! m_polygons.empty ()) {
+
+    std::vector<bool> selected (m_polygons.size (), false);
+
+    db::box_scanner2<db::Box, size_t, db::Polygon, size_t> scanner;
+    scanner.reserve1 (boxes.size ());
+    scanner.reserve2 (m_polygons.size ());
+    for (size_t i = 0; i < boxes.size (); ++i) {
+      scanner.insert1 (&boxes [i], i);
+    }
+    for (size_t i = 0; i < m_polygons.size (); ++i) {
+      scanner.insert2 (&m_polygons [i], i);
+    }
+
+    DXFInteractingPolygons rec (selected);
+    scanner.process (rec, 1, db::box_convert<db::Box> (), db::box_convert<db::Polygon> ());
+
+    size_t n = 0;
+    for (size_t i = 0; i < m_polygons.size (); ++i) {
+      if (selected [i]) {
+        for (db::Polygon::polygon_edge_iterator e = m_polygons [i].begin_edge (); ! e.at_end (); ++e) {
+          edges.push_back (*e);
+        }
+        m_polygon_points -= m_polygons [i].vertices ();
+      } else {
+        if (n != i) {
+          m_polygons [n].swap (m_polygons [i]);
+        }
+        ++n;
+      }
+    }
+
+    m_polygons.erase (m_polygons.begin () + n, m_polygons.end ());
+
+  }
+
+  std::vector<db::Polygon> out;
+  db::EdgeProcessor ep;
+  ep.simple_merge (edges, out, true /*resolve holes*/, true /*min coherence*/, 0);
+
+  for (std::vector<db::Polygon>::iterator o = out.begin (); o != out.end (); ++o) {
+    m_polygon_points += o->vertices ();
+    m_polygons.push_back (db::Polygon ());
+    m_polygons.back ().swap (*o);
+  }
+}
+
+void
+DXFContourCloser::finish (db::Shapes &shapes)
+{
+  for (size_t c = 0; c < m_contours.size (); ++c) {
+
+    const Contour &cc = m_contours [c];
+    if (cc.size () == 0) {
+      //  released contour
+      continue;
+    }
+
+    if (m_auto_close) {
+
+      close (c);
+
+    } else {
+
+      //  open contour: create a path with width = 0
+      std::vector<db::Point> pts;
+      pts.reserve (cc.size ());
+      pts.insert (pts.end (), cc.head.rbegin (), cc.head.rend ());
+      pts.insert (pts.end (), cc.tail.begin (), cc.tail.end ());
+
+      //  use the orientation of the majority of edges
+      if (cc.dir < 0) {
+        std::reverse (pts.begin (), pts.end ());
+      }
+
+      db::Path p;
+      p.assign (pts.begin (), pts.end ());
+      p.width (0);
+      shapes.insert (p);
+
+      unregister_end (c * 2);
+      unregister_end (c * 2 + 1);
+      m_open_points -= cc.size ();
+      release_contour (c);
+
+    }
+
+  }
+
+  flush ();
+
+  shapes.insert (m_polygons.begin (), m_polygons.end ());
+
+  m_contours.clear ();
+  m_free_contours.clear ();
+  m_ends.clear ();
+  std::vector<db::Polygon> ().swap (m_polygons);
+  m_polygon_points = 0;
+  m_open_points = 0;
+}
+
 // ---------------------------------------------------------------
 //  DXFReader
 
@@ -59,7 +457,7 @@ DXFReader::DXFReader (tl::InputStream &s)
   : m_stream (s),
     m_progress (tl::to_string (tr ("Reading DXF file")), 1000),
     m_dbu (0.001), m_unit (1.0), m_text_scaling (1.0), m_polyline_mode (0), m_circle_points (100), m_circle_accuracy (0.0), m_contour_accuracy (0.0),
-    m_ascii (false), m_initial (true), m_render_texts_as_polygons (false), m_keep_other_cells (false), m_line_number (0),
+    m_ascii (false), m_initial (true), m_render_texts_as_polygons (false), m_keep_other_cells (false), m_streaming_mode (false), m_max_pending_points (0), m_line_number (0),
     m_zero_layer (0)
 {
   m_progress.set_format (tl::to_string (tr ("%.0fk lines")));
@@ -303,6 +701,8 @@ DXFReader::read (db::Layout &layout, const db::LoadLayoutOptions &options)
   m_contour_accuracy = specific_options.contour_accuracy;
   m_render_texts_as_polygons = specific_options.render_texts_as_polygons;
   m_keep_other_cells = specific_options.keep_other_cells;
+  m_streaming_mode = specific_options.streaming_mode;
+  m_max_pending_points = 0;
 
   if (m_polyline_mode == 0 /*auto mode*/) {
     m_polyline_mode = determine_polyline_mode ();
@@ -1397,10 +1797,93 @@ DXFReader::deliver_text (db::Shapes &shapes, const std::string &s, const db::DCp
   }
 }
 
+namespace
+{
+
+/**
+ *  @brief Collects the edges of the line merge modes per layer
+ *
+ *  In non-streaming mode, the edges are collected and joined into contours when the
+ *  block is finished. In streaming mode, the edges are sent to a DXFContourCloser per
+ *  layer which joins the edges while the block is read.
+ */
+class DXFEdgeCollector
+{
+public:
+  class LayerEdges
+  {
+  public:
+    LayerEdges (std::vector<db::Edge> *edges, db::DXFContourCloser *closer)
+      : mp_edges (edges), mp_closer (closer)
+    { }
+
+    void push_back (const db::Edge &e)
+    {
+      if (mp_closer) {
+        mp_closer->add (e);
+      } else {
+        mp_edges->push_back (e);
+      }
+    }
+
+  private:
+    std::vector<db::Edge> *mp_edges;
+    db::DXFContourCloser *mp_closer;
+  };
+
+  DXFEdgeCollector (bool streaming, db::Coord accuracy, bool auto_close)
+    : m_streaming (streaming), m_accuracy (accuracy), m_auto_close (auto_close), m_max_pending_points (0)
+  { }
+
+  LayerEdges layer (unsigned int l)
+  {
+    if (m_streaming) {
+      std::map <unsigned int, db::DXFContourCloser>::iterator c = m_closers.find (l);
+      if (c == m_closers.end ()) {
+        c = m_closers.insert (std::make_pair (l, db::DXFContourCloser (m_accuracy, m_auto_close))).first;
+      }
+      return LayerEdges (0, &c->second);
+    } else {
+      return LayerEdges (&m_edges [l], 0);
+    }
+  }
+
+  std::map <unsigned int, std::vector <db::Edge> > &edges ()
+  {
+    return m_edges;
+  }
+
+  void finish (db::Cell &cell)
+  {
+    for (std::map <unsigned int, db::DXFContourCloser>::iterator c = m_closers.begin (); c != m_closers.end (); ++c) {
+      c->second.finish (cell.shapes (c->first));
+      m_max_pending_points = std::max (m_max_pending_points, c->second.max_pending_points ());
+    }
+    m_closers.clear ();
+  }
+
+  size_t max_pending_points () const
+  {
+    return m_max_pending_points;
+  }
+
+private:
+  bool m_streaming;
+  db::Coord m_accuracy;
+  bool m_auto_close;
+  size_t m_max_pending_points;
+  std::map <unsigned int, std::vector <db::Edge> > m_edges;
+  std::map <unsigned int, db::DXFContourCloser> m_closers;
+};
+
+}
+
 void
 DXFReader::read_entities (db::Layout &layout, db::Cell &cell, const db::DVector &offset)
 {
-  std::map <unsigned int, std::vector <db::Edge> > collected_edges;
+  db::Coord accuracy = db::coord_traits<db::Coord>::rounded (m_contour_accuracy * m_unit / m_dbu);
+
+  DXFEdgeCollector collected_edges (m_streaming_mode, accuracy, m_polyline_mode == 4 /*auto-close*/);
   db::EdgeProcessor ep (true /* with progress*/);
 
   int g;
@@ -1644,7 +2127,7 @@ DXFReader::read_entities (db::Layout &layout, db::Cell &cell, const db::DVector
           //  in the merge line modes create a set of edges from an open polyline and merge later
           if (width < 1e-6 && /*(flags & 1) == 0 &&*/ m_polyline_mode >= 3) {
 
-            std::vector <db::Edge> &edges = collected_edges.insert (std::make_pair (ll.second, std::vector <db::Edge> ())).first->second;
+            DXFEdgeCollector::LayerEdges edges = collected_edges.layer (ll.second);
             for (std::vector<db::DPoint>::const_iterator p = points.begin () + 1; p != points.end (); ++p) {
               edges.push_back (safe_from_double (db::DEdge (tt.trans (p[-1]), tt.trans (*p))));
             }
@@ -1768,7 +2251,7 @@ DXFReader::read_entities (db::Layout &layout, db::Cell &cell, const db::DVector
         if (m_polyline_mode == 3 || m_polyline_mode == 4) {
 
           //  in "join" mode, add an edge for each segment
-          std::vector <db::Edge> &edges = collected_edges.insert (std::make_pair (ll.second, std::vector <db::Edge> ())).first->second;
+          DXFEdgeCollector::LayerEdges edges = collected_edges.layer (ll.second);
           std::list<db::DPoint>::const_iterator i = new_points.begin ();
           if (i != new_points.end ()) {
             std::list<db::DPoint>::const_iterator ii = i;
@@ -1833,7 +2316,7 @@ DXFReader::read_entities (db::Layout &layout, db::Cell &cell, const db::DVector
 
         if (w < 1e-6 && (m_polyline_mode == 3 || m_polyline_mode == 4)) {
 
-          std::vector <db::Edge> &edges = collected_edges.insert (std::make_pair (ll.second, std::vector <db::Edge> ())).first->second;
+          DXFEdgeCollector::LayerEdges edges = collected_edges.layer (ll.second);
           edges.push_back (safe_from_double (db::DEdge (tt.trans (p1), tt.trans (p2))));
 
         } else {
@@ -1973,7 +2456,7 @@ DXFReader::read_entities (db::Layout &layout, db::Cell &cell, const db::DVector
 
         if (w < 1e-6 && (m_polyline_mode == 3 || m_polyline_mode == 4)) {
 
-          std::vector <db::Edge> &edges = collected_edges.insert (std::make_pair (ll.second, std::vector <db::Edge> ())).first->second;
+          DXFEdgeCollector::LayerEdges edges = collected_edges.layer (ll.second);
           for (size_t i = 1; i < points.size (); ++i) {
             edges.push_back (safe_from_double (db::DEdge (tt.trans (points [i - 1]), tt.trans (points [i]))));
           }
@@ -2448,7 +2931,7 @@ DXFReader::read_entities (db::Layout &layout, db::Cell &cell, const db::DVector
 
         if (m_polyline_mode == 3 || m_polyline_mode == 4) {
 
-          std::vector <db::Edge> &edges = collected_edges.insert (std::make_pair (ll.second, std::vector <db::Edge> ())).first->second;
+          DXFEdgeCollector::LayerEdges edges = collected_edges.layer (ll.second);
 
           db::DVector vmaj = db::DVector (pm); // documentation says that pm is the "endpoint",
           db::DVector vmin (-vmaj.y () * r, vmaj.x () * r);
@@ -2556,7 +3039,7 @@ DXFReader::read_entities (db::Layout &layout, db::Cell &cell, const db::DVector
 
         if (m_polyline_mode == 3 || m_polyline_mode == 4) {
 
-          std::vector <db::Edge> &edges = collected_edges.insert (std::make_pair (ll.second, std::vector <db::Edge> ())).first->second;
+          DXFEdgeCollector::LayerEdges edges = collected_edges.layer (ll.second);
 
           int n = ncircle_for_radius (r);
           double da = (M_PI * 2.0) / n;
@@ -2778,17 +3261,19 @@ DXFReader::read_entities (db::Layout &layout, db::Cell &cell, const db::DVector
 
   }
 
+  //  deliver the contours closed in streaming mode
+  collected_edges.finish (cell);
+  m_max_pending_points = std::max (m_max_pending_points, collected_edges.max_pending_points ());
+
   //  merge the edges 
   
-  if (! collected_edges.empty ()) {
+  if (! collected_edges.edges ().empty ()) {
 
     tl::RelativeProgress progress (tl::to_string (tr ("Merging edges")), 1000000, 10000);
 
     db::EdgesToContours e2c;
 
-    db::Coord accuracy = db::coord_traits<db::Coord>::rounded (m_contour_accuracy * m_unit / m_dbu);
-
-    for (std::map <unsigned int, std::vector <db::Edge> >::iterator ce = collected_edges.begin (); ce != collected_edges.end (); ++ce) {
+    for (std::map <unsigned int, std::vector <db::Edge> >::iterator ce = collected_edges.edges ().begin (); ce != collected_edges.edges ().end (); ++ce) {
 
       std::vector <db::Edge> &edges = ce->second;
       if (! edges.empty ()) {
@@ -2839,6 +3324,100 @@ DXFReader::read_entities (db::Layout &layout, db::Cell &cell, const db::DVector
   }
 }
 
+/**
+ *  @brief Fast path for reading ASCII numbers
+ *
+ *  This function handles the plain decimal format (e.g. "-12.5") which makes up the
+ *  vast majority of numbers in ASCII DXF files. It delivers the same value than
+ *  tl::Extractor. For other formats (exponents, invalid strings etc.) it returns false
+ *  and the caller falls back to tl::Extractor.
+ */
+static bool
+fast_read_number (const char *cp, double &value)
+{
+  while (*cp == ' ' || *cp == '\t') {
+    ++cp;
+  }
+
+  double s = 1.0;
+  if (*cp == '-') {
+    s = -1.0;
+    ++cp;
+  }
+
+  int exponent = 0;
+  int ndigits = 0;
+  double mant = 0.0;
+
+  while (*cp >= '0' && *cp <= '9') {
+    mant = mant * 10.0 + double (*cp - '0');
+    ++ndigits;
+    ++cp;
+  }
+
+  if (*cp == '.') {
+    ++cp;
+    while (*cp >= '0' && *cp <= '9') {
+      mant = mant * 10.0 + double (*cp - '0');
+      ++ndigits;
+      --exponent;
+      ++cp;
+    }
+  }
+
+  while (*cp == ' ' || *cp == '\t') {
+    ++cp;
+  }
+
+  if (ndigits == 0 || *cp) {
+    return false;
+  }
+
+  //  NOTE: this is the computation tl::Extractor uses, so we get the same rounding
+  value = (exponent == 0 ? s * mant : s * mant * pow (10.0, exponent));
+  return true;
+}
+
+/**
+ *  @brief Fast path for reading ASCII group codes
+ *
+ *  Returns false if the string is not a plain integer number.
+ */
+static bool
+fast_read_group_code (const char *cp, int &value)
+{
+  while (*cp == ' ' || *cp == '\t') {
+    ++cp;
+  }
+
+  bool minus = false;
+  if (*cp == '-') {
+    minus = true;
+    ++cp;
+  }
+
+  int ndigits = 0;
+  int v = 0;
+  while (*cp >= '0' && *cp <= '9') {
+    if (++ndigits > 9) {
+      return false;
+    }
+    v = v * 10 + int (*cp - '0');
+    ++cp;
+  }
+
+  while (*cp == ' ' || *cp == '\t') {
+    ++cp;
+  }
+
+  if (ndigits == 0 || *cp) {
+    return false;
+  }
+
+  value = minus ? -v : v;
+  return true;
+}
+
 bool
 DXFReader::prepare_read (bool ignore_empty_lines)
 {
@@ -2970,9 +3549,13 @@ DXFReader::read_group_code ()
 
     do {
     
+      int x = 0;
+      if (fast_read_group_code (m_line.c_str (), x)) {
+        return x;
+      }
+
       //  ignore uninterpretable lines to work around buggy DXF files with empty lines ..
       tl::Extractor ex (m_line.c_str ()); 
-      int x = 0;
       if (! ex.try_read (x) || ! ex.at_end ()) {
         warn ("Expected an ASCII integer value - line ignored");
       } else {
@@ -3032,10 +3615,12 @@ DXFReader::read_int64 ()
   prepare_read (true);
 
   if (m_ascii) {
-    tl::Extractor ex (m_line.c_str ()); 
     double x = 0;
-    if (! ex.try_read (x) || ! ex.at_end ()) {
-      error ("Expected an ASCII numerical value");
+    if (! fast_read_number (m_line.c_str (), x)) {
+      tl::Extractor ex (m_line.c_str ()); 
+      if (! ex.try_read (x) || ! ex.at_end ()) {
+        error ("Expected an ASCII numerical value");
+      }
     }
     if (x < std::numeric_limits<long long>::min() || x > std::numeric_limits<long long>::max()) {
       error ("Value is out of limits for a 64 bit signed integer");
@@ -3066,10 +3651,12 @@ DXFReader::read_double ()
   prepare_read (true);
 
   if (m_ascii) {
-    tl::Extractor ex (m_line.c_str ()); 
     double x = 0;
-    if (! ex.try_read (x) || ! ex.at_end ()) {
-      error ("Expected an ASCII floating-point value");
+    if (! fast_read_number (m_line.c_str (), x)) {
+      tl::Extractor ex (m_line.c_str ()); 
+      if (! ex.try_read (x) || ! ex.at_end ()) {
+        error ("Expected an ASCII floating-point value");
+      }
     }
     return x;
   } else {
@@ -3104,10 +3691,12 @@ DXFReader::read_int32 ()
   prepare_read (true);
 
   if (m_ascii) {
-    tl::Extractor ex (m_line.c_str ()); 
     double x = 0;
-    if (! ex.try_read (x) || ! ex.at_end ()) {
-      error ("Expected an ASCII numerical value");
+    if (! fast_read_number (m_line.c_str (), x)) {
+      tl::Extractor ex (m_line.c_str ()); 
+      if (! ex.try_read (x) || ! ex.at_end ()) {
+        error ("Expected an ASCII numerical value");
+      }
     }
     if (x < std::numeric_limits<int>::min() || x > std::numeric_limits<int>::max()) {
       error ("Value is out of limits for a 32 bit signed integer");
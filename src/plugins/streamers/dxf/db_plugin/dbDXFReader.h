@@ -30,6 +30,7 @@
 #include "dbDXFFormat.h"
 #include "dbStreamLayers.h"
 #include "dbPropertiesRepository.h"
+#include "dbHash.h"
 
 #include "tlException.h"
 #include "tlInternational.h"
@@ -39,6 +40,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 namespace db
 {
@@ -61,6 +63,154 @@ public:
   { }
 };
 
+/**
+ *  @brief A facility to join edges into contours while reading
+ *
+ *  This object receives edges one by one and joins them into contours
+ *  using a hash of the open contour's end points. Edges are unordered
+ *  and end points are considered connected if they are within the given
+ *  accuracy in x and y direction. End points within the accuracy are
+ *  represented by the contour's existing end point.
+ *
+ *  Closed contours are collected and merged into polygons in batches
+ *  using the even-odd rule. Polygons already produced are merged again
+ *  only if they interact with a new batch. As even-odd merging is
+ *  associative, the result is the same as merging all contours at once.
+ *
+ *  A batch is merged when it holds more points than "batch_size" and
+ *  at least a quarter of the points of the polygons produced so far. This
+ *  keeps the intermediate data small while avoiding to scan the produced
+ *  polygons too often.
+ *
+ *  NOTE: the merged polygons are kept until "finish" is called. DXF entities
+ *  come in no particular order, so an edge arriving later may still interact
+ *  with any polygon produced so far and no polygon can be delivered early.
+ *  Hence streaming mode saves the memory for the edges and the open contours,
+ *  but not for the merged polygons.
+ */
+class DB_PLUGIN_PUBLIC DXFContourCloser
+{
+public:
+  /**
+   *  @brief Constructor
+   *
+   *  @param accuracy The distance by which end points may be separated and still be connected
+   *  @param auto_close If true, open contours are closed when the contours are delivered
+   *  @param batch_size The minimum number of points for merging a batch of closed contours
+   */
+  DXFContourCloser (db::Coord accuracy = 0, bool auto_close = false, size_t batch_size = 100000);
+
+  /**
+   *  @brief Adds an edge
+   */
+  void add (const db::Edge &edge);
+
+  /**
+   *  @brief Merges the closed contours collected so far into polygons
+   */
+  void flush ();
+
+  /**
+   *  @brief Delivers the results to the given shapes container
+   *
+   *  Closed contours are delivered as polygons, open contours as paths with
+   *  width 0 unless auto-close mode is selected. After this method, the
+   *  object is empty.
+   */
+  void finish (db::Shapes &shapes);
+
+  /**
+   *  @brief Gets the number of contours which are not closed yet
+   */
+  size_t open_contours () const
+  {
+    return m_contours.size () - m_free_contours.size ();
+  }
+
+  /**
+   *  @brief Gets the number of points currently held in open and closed contours
+   *
+   *  This number does not include the points of polygons already produced.
+   */
+  size_t pending_points () const
+  {
+    return m_open_points + m_closed_points.size ();
+  }
+
+  /**
+   *  @brief Gets the maximum number of points held in open and closed contours so far
+   */
+  size_t max_pending_points () const
+  {
+    return m_max_pending_points;
+  }
+
+  /**
+   *  @brief Gets the number of batches merged so far
+   */
+  size_t batches () const
+  {
+    return m_batches;
+  }
+
+private:
+  struct Contour
+  {
+    Contour ()
+      : dir (0)
+    { }
+
+    //  the points are head in reverse order, followed by tail
+    std::vector<db::Point> head, tail;
+    //  the number of edges running along the contour minus the number of edges running against it
+    long dir;
+
+    const db::Point &front () const
+    {
+      return head.empty () ? tail.front () : head.back ();
+    }
+
+    const db::Point &back () const
+    {
+      return tail.empty () ? head.front () : tail.back ();
+    }
+
+    size_t size () const
+    {
+      return head.size () + tail.size ();
+    }
+  };
+
+  typedef std::unordered_multimap<db::Point, size_t> end_map;
+
+  db::Coord m_accuracy;
+  db::Coord m_grid;
+  bool m_auto_close;
+  size_t m_batch_size;
+  std::vector<Contour> m_contours;
+  std::vector<size_t> m_free_contours;
+  end_map m_ends;
+  std::vector<db::Point> m_closed_points;
+  std::vector<size_t> m_closed_starts;
+  std::vector<db::Polygon> m_polygons;
+  size_t m_polygon_points;
+  size_t m_open_points;
+  size_t m_max_pending_points;
+  size_t m_batches;
+
+  db::Point end_key (const db::Point &p) const;
+  const db::Point &end_point (size_t end) const;
+  void register_end (size_t end);
+  void unregister_end (size_t end);
+  size_t find_end (const db::Point &p, size_t exclude) const;
+  size_t new_contour ();
+  void release_contour (size_t c);
+  void append (size_t end, const db::Point &p, bool forward);
+  void transfer (size_t to_end, size_t from_end, bool forward);
+  void close (size_t c);
+  void update_stats ();
+};
+
 /**
  *  @brief The DXF format stream reader
  */
@@ -121,6 +271,18 @@ public:
    */
   virtual const char *format () const { return "DXF"; }
 
+  /**
+   *  @brief Gets the maximum number of points held by the contour closers of the last read
+   *
+   *  In streaming mode, this is the largest number of points held in open and closed
+   *  contours (not counting merged polygons) of any layer of any block. It is zero in
+   *  non-streaming mode. This figure is provided for diagnostics.
+   */
+  size_t max_pending_points () const
+  {
+    return m_max_pending_points;
+  }
+
   /**
    *  @brief Issue an error with positional information
    *
@@ -184,6 +346,8 @@ private:
   bool m_initial;
   bool m_render_texts_as_polygons;
   bool m_keep_other_cells;
+  bool m_streaming_mode;
+  size_t m_max_pending_points;
   int m_line_number; 
   unsigned int m_zero_layer;
   std::map <db::cell_index_type, std::string> m_template_cells;
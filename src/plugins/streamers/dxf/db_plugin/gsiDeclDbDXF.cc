@@ -169,6 +169,16 @@ static void set_keep_layer_names (db::LoadLayoutOptions *options, bool l)
   options->get_options<db::DXFReaderOptions> ().keep_layer_names = l;
 }
 
+static bool get_dxf_streaming_mode (const db::LoadLayoutOptions *options)
+{
+  return options->get_options<db::DXFReaderOptions> ().streaming_mode;
+}
+
+static void set_dxf_streaming_mode (db::LoadLayoutOptions *options, bool f)
+{
+  options->get_options<db::DXFReaderOptions> ().streaming_mode = f;
+}
+
 //  extend lay::LoadLayoutOptions with the DXF options
 static
 gsi::ClassExt<db::LoadLayoutOptions> dxf_reader_options (
@@ -345,6 +355,21 @@ gsi::ClassExt<db::LoadLayoutOptions> dxf_reader_options (
     "@brief Specifies whether closed POLYLINE and LWPOLYLINE entities with width 0 are converted to polygons.\n"
     "See \\dxf_polyline_mode= for a description of this property.\n"
     "\nThis property has been added in version 0.21.3.\n"
+  ) +
+  gsi::method_ext ("dxf_streaming_mode=", &set_dxf_streaming_mode, gsi::arg ("flag"),
+    "@brief Specifies whether contours are closed in streaming mode\n"
+    "\n"
+    "In polyline mode 3 and 4, lines are joined into contours. In streaming mode, this happens while "
+    "the file is read and closed contours are turned into polygons in batches. This reduces the memory "
+    "footprint for large files. With a non-zero contour accuracy (see \\dxf_contour_accuracy=), lines "
+    "may be joined differently than in non-streaming mode.\n"
+    "\n"
+    "\nThis property has been added in version 0.27.\n"
+  ) +
+  gsi::method_ext ("dxf_streaming_mode?", &get_dxf_streaming_mode,
+    "@brief Gets a value indicating whether contours are closed in streaming mode\n"
+    "See \\dxf_streaming_mode= for a description of this property.\n"
+    "\nThis property has been added in version 0.27.\n"
   ),
   ""
 );
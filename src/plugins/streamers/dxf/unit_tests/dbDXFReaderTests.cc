@@ -23,9 +23,15 @@
 
 #include "dbDXFReader.h"
 #include "dbTestSupport.h"
+#include "dbLayoutDiff.h"
+#include "dbEdgesToContours.h"
+#include "dbEdgeProcessor.h"
 #include "tlUnitTest.h"
+#include "tlTimer.h"
+#include "tlStream.h"
 
 #include <stdlib.h>
+#include <algorithm>
 
 static db::LayerMap string2lm (const char *map)
 {
@@ -485,6 +491,20 @@ TEST(32)
   run_test_public (_this, "round_path.dxf.gz", "t32e_au.gds.gz", opt);
 }
 
+//  streaming mode
+TEST(32s)
+{
+  db::DXFReaderOptions opt;
+  opt.layer_map = string2lm ("L11D0:1,L12D0:2");
+  opt.create_other_layers = false;
+  opt.polyline_mode = 3;
+  opt.streaming_mode = true;
+
+  //  NOTE: with an accuracy > 0, the streaming mode may join contours differently
+  opt.contour_accuracy = 0.0;
+  run_test_public (_this, "round_path.dxf.gz", "t32a_au.gds.gz", opt);
+}
+
 //  issue #704
 TEST(33)
 {
@@ -506,3 +526,228 @@ TEST(33)
   opt.polyline_mode = 2;
   run_test (_this, "t33.dxf.gz", "t33e_au.gds.gz", opt);
 }
+
+static std::string shapes2string (const db::Shapes &shapes)
+{
+  std::vector<std::string> s;
+  for (db::ShapeIterator i = shapes.begin (db::ShapeIterator::All); ! i.at_end (); ++i) {
+    s.push_back (i->to_string ());
+  }
+  std::sort (s.begin (), s.end ());
+  return tl::join (s, "\n");
+}
+
+static void add_box_edges (std::vector<db::Edge> &edges, const db::Box &b, bool reverse)
+{
+  db::Point pts [] = { b.lower_left (), b.upper_left (), b.upper_right (), b.lower_right () };
+  for (unsigned int i = 0; i < 4; ++i) {
+    db::Edge e (pts [i], pts [(i + 1) % 4]);
+    edges.push_back (reverse ? e.swapped_points () : e);
+  }
+}
+
+//  the classic way of joining the edges (see DXFReader::read_entities)
+static std::string merge_classic (const std::vector<db::Edge> &edges, db::Coord accuracy, bool auto_close)
+{
+  db::Shapes shapes;
+
+  std::vector<db::Edge> ee = edges;
+  db::EdgesToContours e2c;
+  e2c.fill (ee.begin (), ee.end (), true, accuracy);
+
+  std::vector<db::Edge> cc_edges;
+  for (size_t c = 0; c < e2c.contours (); ++c) {
+    const std::vector<db::Point> &pts = e2c.contour (c);
+    if (e2c.contour_closed (c) || auto_close) {
+      for (size_t i = 0; i < pts.size (); ++i) {
+        cc_edges.push_back (db::Edge (pts [i], pts [(i + 1) % pts.size ()]));
+      }
+    } else {
+      db::Path p;
+      p.assign (pts.begin (), pts.end ());
+      shapes.insert (p);
+    }
+  }
+
+  std::vector<db::Polygon> pout;
+  db::EdgeProcessor ep;
+  ep.simple_merge (cc_edges, pout, true, true, 0);
+  shapes.insert (pout.begin (), pout.end ());
+
+  return shapes2string (shapes);
+}
+
+static std::string merge_streaming (const std::vector<db::Edge> &edges, db::Coord accuracy, bool auto_close, size_t batch_size, size_t *batches = 0)
+{
+  db::Shapes shapes;
+
+  db::DXFContourCloser closer (accuracy, auto_close, batch_size);
+  for (std::vector<db::Edge>::const_iterator e = edges.begin (); e != edges.end (); ++e) {
+    closer.add (*e);
+  }
+
+  if (batches) {
+    *batches = closer.batches ();
+  }
+
+  closer.finish (shapes);
+  return shapes2string (shapes);
+}
+
+TEST(ContourCloser1)
+{
+  std::vector<db::Edge> edges;
+
+  //  a square with a hole
+  add_box_edges (edges, db::Box (0, 0, 100, 100), false);
+  //  a far square
+  add_box_edges (edges, db::Box (1000, 1000, 1100, 1100), true);
+  //  the hole
+  add_box_edges (edges, db::Box (20, 20, 80, 80), true);
+  //  a square attached to the first one
+  add_box_edges (edges, db::Box (100, 0, 200, 100), false);
+  //  an open contour
+  edges.push_back (db::Edge (db::Point (0, 500), db::Point (100, 500)));
+  edges.push_back (db::Edge (db::Point (100, 500), db::Point (100, 600)));
+
+  //  shuffle the edges in a reproducible way
+  std::vector<db::Edge> shuffled;
+  for (size_t i = 0; i < edges.size (); ++i) {
+    shuffled.push_back (edges [(i * 7) % edges.size ()]);
+  }
+
+  std::string au =
+    "path (0,500;100,500;100,600) w=0 bx=0 ex=0 r=false\n"
+    "polygon (0,0;0,80;20,80;20,20;80,20;80,80;0,80;0,100;200,100;200,0)\n"
+    "polygon (1000,1000;1000,1100;1100,1100;1100,1000)";
+
+  //  NOTE: the orientation of open contours is not the same than with EdgesToContours: the streaming mode
+  //  takes the one of the majority of edges.
+
+  size_t batches = 0;
+  //  NOTE: the attached square forms one contour with the first one
+  EXPECT_EQ (merge_streaming (shuffled, 0, false, 1, &batches), au);
+  EXPECT_EQ (batches, size_t (3));
+
+  EXPECT_EQ (merge_streaming (shuffled, 0, false, 100000, &batches), au);
+  EXPECT_EQ (batches, size_t (0));
+
+  //  auto-close
+  std::string au_closed =
+    "polygon (0,0;0,80;20,80;20,20;80,20;80,80;0,80;0,100;200,100;200,0)\n"
+    "polygon (0,500;100,600;100,500)\n"
+    "polygon (1000,1000;1000,1100;1100,1100;1100,1000)";
+
+  EXPECT_EQ (merge_classic (shuffled, 0, true), au_closed);
+  EXPECT_EQ (merge_streaming (shuffled, 0, true, 1), au_closed);
+}
+
+TEST(ContourCloser2)
+{
+  std::vector<db::Edge> edges;
+
+  //  a contour with gaps up to 3 DBU
+  edges.push_back (db::Edge (db::Point (0, 0), db::Point (0, 100)));
+  edges.push_back (db::Edge (db::Point (2, 103), db::Point (100, 100)));
+  edges.push_back (db::Edge (db::Point (100, 0), db::Point (101, 98)));
+  edges.push_back (db::Edge (db::Point (0, 2), db::Point (98, -1)));
+
+  EXPECT_EQ (merge_streaming (edges, 0, false, 1),
+    "path (0,0;0,100) w=0 bx=0 ex=0 r=false\n"
+    "path (0,2;98,-1) w=0 bx=0 ex=0 r=false\n"
+    "path (100,0;101,98) w=0 bx=0 ex=0 r=false\n"
+    "path (2,103;100,100) w=0 bx=0 ex=0 r=false"
+  );
+
+  //  the points within the accuracy are represented by the first one
+  EXPECT_EQ (merge_streaming (edges, 3, false, 1), "polygon (0,0;0,100;100,100;100,0)");
+}
+
+static std::string make_lines_dxf (int n)
+{
+  std::string s = "0\nSECTION\n2\nHEADER\n0\nENDSEC\n0\nSECTION\n2\nENTITIES\n";
+
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+
+      double x = i * 10.0, y = j * 10.0;
+
+      //  a square of 8x8 with a 4x4 hole; every second cell abuts its right neighbor
+      double w = (j % 2 == 0 ? 10.0 : 8.0);
+      double boxes [2][4] = { { x, y, x + w, y + 8.0 }, { x + 2.25, y + 2.25, x + 6.25, y + 6.25 } };
+
+      for (unsigned int b = 0; b < 2; ++b) {
+
+        const double *bx = boxes [b];
+        double pts [4][2] = { { bx [0], bx [1] }, { bx [0], bx [3] }, { bx [2], bx [3] }, { bx [2], bx [1] } };
+
+        for (unsigned int k = 0; k < 4; ++k) {
+          const double *p1 = pts [k], *p2 = pts [(k + 1) % 4];
+          s += "0\nLINE\n8\nL1D0\n";
+          s += "10\n" + tl::to_string (p1 [0]) + "\n20\n" + tl::to_string (p1 [1]) + "\n";
+          s += "11\n" + tl::to_string (p2 [0]) + "\n21\n" + tl::to_string (p2 [1]) + "\n";
+        }
+
+      }
+
+    }
+  }
+
+  s += "0\nENDSEC\n0\nEOF\n";
+  return s;
+}
+
+static void read_dxf_string (db::Layout &layout, const std::string &dxf, const db::DXFReaderOptions &opt)
+{
+  db::LoadLayoutOptions options;
+  options.set_options (new db::DXFReaderOptions (opt));
+
+  tl::InputMemoryStream ms (dxf.c_str (), dxf.size ());
+  tl::InputStream stream (ms);
+  db::Reader reader (stream);
+  reader.read (layout, options);
+}
+
+//  benchmark: non-streaming vs. streaming mode
+TEST(StreamingBenchmark)
+{
+  std::string dxf = make_lines_dxf (60);
+
+  db::DXFReaderOptions opt;
+  opt.polyline_mode = 3;
+
+  db::Layout layout_classic, layout_streaming;
+
+  {
+    tl::SelfTimer timer ("DXF read, non-streaming mode");
+    read_dxf_string (layout_classic, dxf, opt);
+  }
+
+  opt.streaming_mode = true;
+
+  size_t max_pending_points = 0;
+
+  {
+    tl::SelfTimer timer ("DXF read, streaming mode");
+
+    db::LoadLayoutOptions options;
+    options.set_options (new db::DXFReaderOptions (opt));
+
+    tl::InputMemoryStream ms (dxf.c_str (), dxf.size ());
+    tl::InputStream stream (ms);
+    db::DXFReader reader (stream);
+    reader.read (layout_streaming, options);
+
+    max_pending_points = reader.max_pending_points ();
+  }
+
+  EXPECT_EQ (db::compare_layouts (layout_classic, layout_streaming, db::layout_diff::f_verbose, 0), true);
+
+  //  In non-streaming mode, all edges (two points each) are held until the block is finished.
+  //  In streaming mode, the points are held once in the contours. As this test's contours are
+  //  small and closed early, less than that is held at any time.
+  size_t edges = 60 * 60 * 8;
+  tl::info << "Edges: " << edges << ", max. pending points in streaming mode: " << max_pending_points;
+  EXPECT_EQ (max_pending_points > 0, true);
+  EXPECT_EQ (max_pending_points <= edges, true);
+}
@@ -47,8 +47,12 @@ namespace db
 //  GDS2WriterBase implementation
 
 GDS2WriterBase::GDS2WriterBase ()
+  : m_stream_sf (1.0), m_stream_dbu (0.001),
+    m_stream_multi_xy (false), m_stream_max_vertex_count (8000), m_stream_no_zero_length_paths (false)
 {
-  // .. nothing yet ..
+  for (unsigned int i = 0; i < 6; ++i) {
+    m_stream_time_data [i] = 0;
+  }
 }
 
 static int safe_scale (double sf, int value)
@@ -72,6 +76,27 @@ inline int scale (double sf, int value)
   }
 }
 
+static void get_time_data (short *time_data, bool write_timestamps)
+{
+  for (unsigned int i = 0; i < 6; ++i) {
+    time_data [i] = 0;
+  }
+
+  if (write_timestamps) {
+    time_t ti = 0;
+    time (&ti);
+    const struct tm *t = localtime (&ti);
+    if (t) {
+      time_data[0] = t->tm_year + 1900;
+      time_data[1] = t->tm_mon + 1;
+      time_data[2] = t->tm_mday;
+      time_data[3] = t->tm_hour;
+      time_data[4] = t->tm_min;
+      time_data[5] = t->tm_sec;
+    }
+  }
+}
+
 void
 GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
 {
@@ -107,20 +132,8 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
   }
 
   //  get current time
-  short time_data [6] = { 0, 0, 0, 0, 0, 0 };
-  if (gds2_options.write_timestamps) {
-    time_t ti = 0;
-    time (&ti);
-    const struct tm *t = localtime (&ti);
-    if (t) {
-      time_data[0] = t->tm_year + 1900;
-      time_data[1] = t->tm_mon + 1;
-      time_data[2] = t->tm_mday;
-      time_data[3] = t->tm_hour;
-      time_data[4] = t->tm_min;
-      time_data[5] = t->tm_sec;
-    }
-  }
+  short time_data [6];
+  get_time_data (time_data, gds2_options.write_timestamps);
 
   std::string str_time = tl::sprintf ("%d/%d/%d %d:%02d:%02d", time_data[1], time_data[2], time_data[0], time_data[3], time_data[4], time_data[5]); 
   layout.add_meta_info (MetaInfo ("mod_time", tl::to_string (tr ("Modification Time")), str_time));
@@ -153,21 +166,7 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
 
   //  write header
 
-  write_record_size (6);
-  write_record (sHEADER);
-  write_short (600);
-
-  write_record_size (4 + 12 * 2);
-  write_record (sBGNLIB);
-  write_time (time_data);
-  write_time (time_data);
-
-  write_string_record (sLIBNAME, gds2_options.libname);
-
-  write_record_size (4 + 8 * 2);
-  write_record (sUNITS);
-  write_double (dbu / std::max (1e-9, gds2_options.user_units));
-  write_double (dbu * 1e-6);
+  write_lib_header (time_data, gds2_options.libname, dbu, gds2_options.user_units);
 
   //  layout properties 
 
@@ -300,28 +299,7 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
           while (! shape.at_end ()) {
 
             progress_checkpoint ();
-
-            if (shape->is_text ()) {
-              write_text (layer, datatype, sf, dbu, *shape, layout, shape->prop_id ());
-            } else if (shape->is_polygon ()) {
-              write_polygon (layer, datatype, sf, *shape, multi_xy, max_vertex_count, layout, shape->prop_id ());
-            } else if (shape->is_edge ()) {
-              write_edge (layer, datatype, sf, *shape, layout, shape->prop_id ());
-            } else if (shape->is_edge_pair ()) {
-              write_edge (layer, datatype, sf, shape->edge_pair ().first (), layout, shape->prop_id ());
-              write_edge (layer, datatype, sf, shape->edge_pair ().second (), layout, shape->prop_id ());
-            } else if (shape->is_path ()) {
-              if (no_zero_length_paths && (shape->path_length () - shape->path_extensions ().first - shape->path_extensions ().second) == 0) {
-                //  eliminate the zero-width path
-                db::Polygon poly;
-                shape->polygon (poly);
-                write_polygon (layer, datatype, sf, poly, multi_xy, max_vertex_count, layout, shape->prop_id (), false);
-              } else {
-                write_path (layer, datatype, sf, *shape, multi_xy, layout, shape->prop_id ());
-              }
-            } else if (shape->is_box ()) {
-              write_box (layer, datatype, sf, *shape, layout, shape->prop_id ());
-            }
+            write_shape (layer, datatype, sf, dbu, *shape, multi_xy, max_vertex_count, no_zero_length_paths, layout, shape->prop_id ());
 
             ++shape;
 
@@ -346,6 +324,139 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
   progress_checkpoint ();
 }
 
+void
+GDS2WriterBase::write_lib_header (const short *time_data, const std::string &libname, double dbu, double user_units)
+{
+  write_record_size (6);
+  write_record (sHEADER);
+  write_short (600);
+
+  write_record_size (4 + 12 * 2);
+  write_record (sBGNLIB);
+  write_time (time_data);
+  write_time (time_data);
+
+  write_string_record (sLIBNAME, libname);
+
+  write_record_size (4 + 8 * 2);
+  write_record (sUNITS);
+  write_double (dbu / std::max (1e-9, user_units));
+  write_double (dbu * 1e-6);
+}
+
+void
+GDS2WriterBase::write_shape (int layer, int datatype, double sf, double dbu, const db::Shape &shape, bool multi_xy, size_t max_vertex_count, bool no_zero_length_paths, const db::Layout &layout, db::properties_id_type prop_id)
+{
+  if (shape.is_text ()) {
+    write_text (layer, datatype, sf, dbu, shape, layout, prop_id);
+  } else if (shape.is_polygon ()) {
+    write_polygon (layer, datatype, sf, shape, multi_xy, max_vertex_count, layout, prop_id);
+  } else if (shape.is_edge ()) {
+    write_edge (layer, datatype, sf, shape, layout, prop_id);
+  } else if (shape.is_edge_pair ()) {
+    write_edge (layer, datatype, sf, shape.edge_pair ().first (), layout, prop_id);
+    write_edge (layer, datatype, sf, shape.edge_pair ().second (), layout, prop_id);
+  } else if (shape.is_path ()) {
+    if (no_zero_length_paths && (shape.path_length () - shape.path_extensions ().first - shape.path_extensions ().second) == 0) {
+      //  eliminate the zero-width path
+      db::Polygon poly;
+      shape.polygon (poly);
+      write_polygon (layer, datatype, sf, poly, multi_xy, max_vertex_count, layout, prop_id, false);
+    } else {
+      write_path (layer, datatype, sf, shape, multi_xy, layout, prop_id);
+    }
+  } else if (shape.is_box ()) {
+    write_box (layer, datatype, sf, shape, layout, prop_id);
+  }
+}
+
+bool
+GDS2WriterBase::supports_streaming () const
+{
+  return true;
+}
+
+void
+GDS2WriterBase::begin_stream (tl::OutputStream &stream, double dbu, const db::SaveLayoutOptions &options)
+{
+  set_stream (stream);
+
+  m_stream_dbu = (options.dbu () == 0.0) ? dbu : options.dbu ();
+  m_stream_sf = options.scale_factor () * (dbu / m_stream_dbu);
+  if (fabs (m_stream_sf - 1.0) < 1e-9) {
+    //  to avoid rounding problems, set to 1.0 exactly if possible.
+    m_stream_sf = 1.0;
+  }
+
+  db::GDS2WriterOptions gds2_options = options.get_options<db::GDS2WriterOptions> ();
+
+  m_stream_multi_xy = gds2_options.multi_xy_records;
+  m_stream_max_vertex_count = std::max (gds2_options.max_vertex_count, (unsigned int)4);
+  m_stream_no_zero_length_paths = gds2_options.no_zero_length_paths;
+
+  get_time_data (m_stream_time_data, gds2_options.write_timestamps);
+
+  write_lib_header (m_stream_time_data, gds2_options.libname, m_stream_dbu, gds2_options.user_units);
+}
+
+void
+GDS2WriterBase::begin_stream_cell (const std::string &name)
+{
+  progress_checkpoint ();
+
+  write_record_size (4 + 12 * 2);
+  write_record (sBGNSTR);
+  write_time (m_stream_time_data);
+  write_time (m_stream_time_data);
+
+  write_string_record (sSTRNAME, name);
+}
+
+void
+GDS2WriterBase::stream_shapes (const db::Layout &layout, const db::Shapes &shapes, const db::LayerProperties &lp)
+{
+  db::ShapeIterator shape (shapes.begin (db::ShapeIterator::Boxes | db::ShapeIterator::Polygons | db::ShapeIterator::Edges | db::ShapeIterator::EdgePairs | db::ShapeIterator::Paths | db::ShapeIterator::Texts));
+  while (! shape.at_end ()) {
+    progress_checkpoint ();
+    //  properties are not written in streaming mode
+    write_shape (lp.layer, lp.datatype, m_stream_sf, m_stream_dbu, *shape, m_stream_multi_xy, m_stream_max_vertex_count, m_stream_no_zero_length_paths, layout, 0);
+    ++shape;
+  }
+}
+
+void
+GDS2WriterBase::stream_cell_reference (const std::string &name, const db::Vector &disp)
+{
+  write_record_size (4);
+  write_record (sSREF);
+
+  write_string_record (sSNAME, name);
+
+  write_record_size (12);
+  write_record (sXY);
+  write_int (scale (m_stream_sf, disp.x ()));
+  write_int (scale (m_stream_sf, disp.y ()));
+
+  write_record_size (4);
+  write_record (sENDEL);
+}
+
+void
+GDS2WriterBase::end_stream_cell ()
+{
+  write_record_size (4);
+  write_record (sENDSTR);
+}
+
+void
+GDS2WriterBase::end_stream ()
+{
+  write_record_size (4);
+  write_record (sENDLIB);
+
+  progress_checkpoint ();
+}
+
 void
 GDS2WriterBase::write_inst (double sf, const db::Instance &instance, bool normalize, const db::Layout &layout, db::properties_id_type prop_id)
 {
@@ -58,6 +58,15 @@ public:
    */
   void write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
 
+  //  Streaming mode implementation (see db::WriterBase)
+  virtual bool supports_streaming () const;
+  virtual void begin_stream (tl::OutputStream &stream, double dbu, const db::SaveLayoutOptions &options);
+  virtual void begin_stream_cell (const std::string &name);
+  virtual void stream_shapes (const db::Layout &layout, const db::Shapes &shapes, const db::LayerProperties &lp);
+  virtual void stream_cell_reference (const std::string &name, const db::Vector &disp);
+  virtual void end_stream_cell ();
+  virtual void end_stream ();
+
 protected:
   /**
    *  @brief Write a byte
@@ -166,8 +175,15 @@ protected:
 
 private:
   db::WriterCellNameMap m_cell_name_map;
+  double m_stream_sf, m_stream_dbu;
+  short m_stream_time_data [6];
+  bool m_stream_multi_xy;
+  size_t m_stream_max_vertex_count;
+  bool m_stream_no_zero_length_paths;
 
   void write_properties (const db::Layout &layout, db::properties_id_type prop_id);
+  void write_lib_header (const short *time_data, const std::string &libname, double dbu, double user_units);
+  void write_shape (int layer, int datatype, double sf, double dbu, const db::Shape &shape, bool multi_xy, size_t max_vertex_count, bool no_zero_length_paths, const db::Layout &layout, db::properties_id_type prop_id);
 };
 
 } // namespace db
@@ -24,6 +24,8 @@
 #include "dbDEFImporter.h"
 #include "dbPolygonTools.h"
 #include "tlGlobPattern.h"
+#include "tlThreadedWorkers.h"
+#include "tlLog.h"
 
 #include <cmath>
 
@@ -52,8 +54,219 @@ struct DEFImporterGroup
   std::vector<tl::GlobPattern> comp_match;
 };
 
+/**
+ *  @brief Holds the objects parsed from COMPONENTS, NETS or SPECIALNETS statements
+ *
+ *  The stage records the objects in parse order, but without touching the layout:
+ *  layers and via cells are given by interned keys and net names are recorded instead
+ *  of property IDs. This way, the statements can be parsed in worker threads while the
+ *  layout objects are created in the main thread (see DEFImporter::produce_staged).
+ */
+struct DEFImporterStage
+{
+  enum OpType
+  {
+    SetNet,
+    Box,
+    Polygon,
+    Path,
+    Via,
+    Component
+  };
+
+  struct Op
+  {
+    Op (OpType _type, unsigned int _key, size_t _index)
+      : type (_type), key (_key), index (_index)
+    { }
+
+    OpType type;
+    unsigned int key;
+    size_t index;
+  };
+
+  struct ViaInst
+  {
+    db::Trans trans;
+    db::Vector a, b;
+    unsigned long na, nb;
+  };
+
+  struct ComponentInst
+  {
+    std::string inst_name, model, maskshift;
+    const MacroDesc *macro;
+    db::Trans trans;
+  };
+
+  typedef std::pair<std::string, std::pair<unsigned int, unsigned int> > layer_key_type;
+  typedef std::pair<std::string, unsigned int> via_key_type;
+
+  std::vector<Op> ops;
+  std::vector<std::string> nets;
+  std::vector<db::Box> boxes;
+  std::vector<db::Polygon> polygons;
+  std::vector<db::Path> paths;
+  std::vector<ViaInst> vias;
+  std::vector<ComponentInst> components;
+  std::vector<layer_key_type> layer_keys;
+  std::unordered_map<layer_key_type, unsigned int> layer_ids;
+  std::vector<via_key_type> via_keys;
+  std::unordered_map<via_key_type, unsigned int> via_ids;
+  std::vector<std::string> warnings;
+
+  //  filled by DEFImporter::produce_staged
+  std::vector<std::set<unsigned int> > layers;
+  std::vector<bool> layers_resolved;
+  std::vector<db::Cell *> via_cells;
+  std::vector<bool> via_cells_resolved;
+
+  void clear ()
+  {
+    ops.clear ();
+    nets.clear ();
+    boxes.clear ();
+    polygons.clear ();
+    paths.clear ();
+    vias.clear ();
+    components.clear ();
+    warnings.clear ();
+    //  NOTE: the layer and via keys are kept together with the resolved layers and via cells,
+    //  so these need to be resolved only once when the stage is reused
+  }
+
+  unsigned int layer (const std::string &name, LayerPurpose purpose, unsigned int mask)
+  {
+    layer_key_type key (name, std::make_pair ((unsigned int) purpose, mask));
+    std::unordered_map<layer_key_type, unsigned int>::const_iterator l = layer_ids.find (key);
+    if (l != layer_ids.end ()) {
+      return l->second;
+    }
+    unsigned int id = (unsigned int) layer_keys.size ();
+    layer_keys.push_back (key);
+    layer_ids.insert (std::make_pair (key, id));
+    return id;
+  }
+
+  void set_net (const std::string &net)
+  {
+    ops.push_back (Op (SetNet, 0, nets.size ()));
+    nets.push_back (net);
+  }
+
+  void add_box (unsigned int layer, const db::Box &box)
+  {
+    ops.push_back (Op (Box, layer, boxes.size ()));
+    boxes.push_back (box);
+  }
+
+  void add_polygon (unsigned int layer, const db::Polygon &polygon)
+  {
+    ops.push_back (Op (Polygon, layer, polygons.size ()));
+    polygons.push_back (polygon);
+  }
+
+  void add_path (unsigned int layer, const db::Path &path)
+  {
+    ops.push_back (Op (Path, layer, paths.size ()));
+    paths.push_back (path);
+  }
+
+  void add_via (const std::string &name, unsigned int mask_bottom, unsigned int mask_cut, unsigned int mask_top, const db::Trans &trans, const db::Vector &a = db::Vector (), const db::Vector &b = db::Vector (), unsigned long na = 1, unsigned long nb = 1)
+  {
+    //  masks are single digits (see read_single_net)
+    via_key_type key (name, mask_bottom + 10 * mask_cut + 100 * mask_top);
+
+    unsigned int id = (unsigned int) via_keys.size ();
+    std::unordered_map<via_key_type, unsigned int>::const_iterator v = via_ids.find (key);
+    if (v != via_ids.end ()) {
+      id = v->second;
+    } else {
+      via_keys.push_back (key);
+      via_ids.insert (std::make_pair (key, id));
+    }
+
+    ops.push_back (Op (Via, id, vias.size ()));
+    vias.push_back (ViaInst ());
+    vias.back ().trans = trans;
+    vias.back ().a = a;
+    vias.back ().b = b;
+    vias.back ().na = na;
+    vias.back ().nb = nb;
+  }
+
+  void add_component (const std::string &inst_name, const std::string &model, const std::string &maskshift, const MacroDesc *macro, const db::Trans &trans)
+  {
+    ops.push_back (Op (Component, 0, components.size ()));
+    components.push_back (ComponentInst ());
+    components.back ().inst_name = inst_name;
+    components.back ().model = model;
+    components.back ().maskshift = maskshift;
+    components.back ().macro = macro;
+    components.back ().trans = trans;
+  }
+};
+
+/**
+ *  @brief A chunk of section text for parsing in a worker thread
+ */
+struct DEFImporterChunk
+{
+  DEFImporterChunk ()
+    : first_line (0)
+  { }
+
+  std::string text;
+  size_t first_line;
+  DEFImporterStage stage;
+  std::string error;
+};
+
+class DEFImporterChunkTask
+  : public tl::Task
+{
+public:
+  DEFImporterChunkTask (const DEFImporter *importer, DEFImporterChunk *chunk, int section, double dbu, double scale)
+    : mp_importer (importer), mp_chunk (chunk), m_section (section), m_dbu (dbu), m_scale (scale)
+  { }
+
+  void perform ()
+  {
+    mp_importer->parse_chunk (*mp_chunk, DEFImporter::StagedSection (m_section), m_dbu, m_scale);
+  }
+
+private:
+  const DEFImporter *mp_importer;
+  DEFImporterChunk *mp_chunk;
+  int m_section;
+  double m_dbu, m_scale;
+};
+
+class DEFImporterChunkWorker
+  : public tl::Worker
+{
+public:
+  DEFImporterChunkWorker ()
+    : tl::Worker ()
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<DEFImporterChunkTask *> (task)->perform ();
+  }
+};
+
+// -----------------------------------------------------------------------------------
+//  DEFImporter implementation
+
 DEFImporter::DEFImporter ()
-  : LEFDEFImporter ()
+  : LEFDEFImporter (), mp_parent (0)
+{
+  //  .. nothing yet ..
+}
+
+DEFImporter::DEFImporter (const DEFImporter *parent)
+  : LEFDEFImporter (), mp_parent (parent)
 {
   //  .. nothing yet ..
 }
@@ -64,6 +277,12 @@ DEFImporter::read_lef (tl::InputStream &stream, db::Layout &layout, LEFDEFReader
   m_lef_importer.read (stream, layout, state);
 }
 
+void
+DEFImporter::read_lef_files (const std::vector<std::string> &paths, db::Layout &layout, LEFDEFReaderState &state)
+{
+  m_lef_importer.read_files (paths, layout, state);
+}
+
 void
 DEFImporter::finish_lef (db::Layout &layout)
 {
@@ -111,14 +330,14 @@ DEFImporter::read_rect (db::Polygon &poly, double scale)
 std::pair<db::Coord, db::Coord>
 DEFImporter::get_wire_width_for_rule (const std::string &rulename, const std::string &ln, double dbu)
 {
-  std::pair<double, double> wxy = m_lef_importer.layer_width (ln, rulename);
+  std::pair<double, double> wxy = master ().m_lef_importer.layer_width (ln, rulename);
   db::Coord wx = db::coord_traits<db::Coord>::rounded (wxy.first / dbu);
   db::Coord wy = db::coord_traits<db::Coord>::rounded (wxy.second / dbu);
 
   //  try to find local nondefault rule
   if (! rulename.empty ()) {
-    std::map<std::string, std::map<std::string, db::Coord> >::const_iterator nd = m_nondefault_widths.find (rulename);
-    if (nd != m_nondefault_widths.end ()) {
+    std::map<std::string, std::map<std::string, db::Coord> >::const_iterator nd = master ().m_nondefault_widths.find (rulename);
+    if (nd != master ().m_nondefault_widths.end ()) {
       std::map<std::string, db::Coord>::const_iterator ld = nd->second.find (ln);
       if (ld != nd->second.end ()) {
         wx = wy = ld->second;
@@ -126,7 +345,7 @@ DEFImporter::get_wire_width_for_rule (const std::string &rulename, const std::st
     }
   }
 
-  std::pair<double, double> min_wxy = m_lef_importer.min_layer_width (ln);
+  std::pair<double, double> min_wxy = master ().m_lef_importer.min_layer_width (ln);
   db::Coord min_wx = db::coord_traits<db::Coord>::rounded (min_wxy.first / dbu);
   db::Coord min_wy = db::coord_traits<db::Coord>::rounded (min_wxy.second / dbu);
 
@@ -139,10 +358,24 @@ DEFImporter::get_def_ext (const std::string &ln, const std::pair<db::Coord, db::
   //  This implementation assumes the "preferred width" is controlling the default extension and it is
   //  identical to the minimum effective width. This is true if "LEF58_MINWIDTH" with "WRONGDIRECTION" is
   //  used in the proposed way. Which is to specify a larger width for the "wrong" direction.
-  db::Coord de = db::coord_traits<db::Coord>::rounded (m_lef_importer.layer_ext (ln, std::min (wxy.first, wxy.second) * 0.5 * dbu) / dbu);
+  db::Coord de = db::coord_traits<db::Coord>::rounded (master ().m_lef_importer.layer_ext (ln, std::min (wxy.first, wxy.second) * 0.5 * dbu) / dbu);
   return std::make_pair (de, de);
 }
 
+const DEFImporter::wire_width_and_ext_type &
+DEFImporter::get_wire_width_and_ext (const std::string &rulename, const std::string &ln, double dbu)
+{
+  //  NOTE: the cache is cleared when NONDEFAULTRULES are read
+  std::pair<std::string, std::string> key (rulename, ln);
+  std::unordered_map<std::pair<std::string, std::string>, wire_width_and_ext_type>::const_iterator c = m_wire_width_cache.find (key);
+  if (c != m_wire_width_cache.end ()) {
+    return c->second;
+  }
+
+  std::pair<db::Coord, db::Coord> w = get_wire_width_for_rule (rulename, ln, dbu);
+  return m_wire_width_cache.insert (std::make_pair (key, std::make_pair (w, get_def_ext (ln, w, dbu)))).first->second;
+}
+
 void
 DEFImporter::read_diearea (db::Layout &layout, db::Cell &design, double scale)
 {
@@ -188,6 +421,7 @@ DEFImporter::read_nondefaultrules (double scale)
         if (test ("WIDTH")) {
           double w = get_double () * scale;
           m_nondefault_widths[n][l] = db::coord_traits<db::Coord>::rounded (w);
+          m_wire_width_cache.clear ();
         }
 
       }
@@ -330,7 +564,7 @@ DEFImporter::read_blockages (db::Layout &layout, db::Cell &design, double scale)
 }
 
 void
-DEFImporter::produce_routing_geometry (db::Cell &design, const Polygon *style, unsigned int layer, properties_id_type prop_id, const std::vector<db::Point> &pts, const std::vector<std::pair<db::Coord, db::Coord> > &ext, std::pair<db::Coord, db::Coord> w)
+DEFImporter::produce_routing_geometry (DEFImporterStage &stage, const Polygon *style, unsigned int layer, const std::vector<db::Point> &pts, const std::vector<std::pair<db::Coord, db::Coord> > &ext, std::pair<db::Coord, db::Coord> w)
 {
   if (! style) {
 
@@ -391,12 +625,7 @@ DEFImporter::produce_routing_geometry (db::Cell &design, const Polygon *style, u
           ee = ext.back ().first;
         }
 
-        db::Path p (pt0, pt + 1, wxy, be, ee, false);
-        if (prop_id != 0) {
-          design.shapes (layer).insert (db::object_with_properties<db::Path> (p, prop_id));
-        } else {
-          design.shapes (layer).insert (p);
-        }
+        stage.add_path (layer, db::Path (pt0, pt + 1, wxy, be, ee, false));
 
         was_path_before = true;
 
@@ -423,12 +652,7 @@ DEFImporter::produce_routing_geometry (db::Cell &design, const Polygon *style, u
         db::Polygon k;
         k.assign_hull (octagon, octagon + sizeof (octagon) / sizeof (octagon[0]));
 
-        db::Polygon p = db::minkowsky_sum (k, db::Edge (*pt0, *pt));
-        if (prop_id != 0) {
-          design.shapes (layer).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-        } else {
-          design.shapes (layer).insert (p);
-        }
+        stage.add_polygon (layer, db::minkowsky_sum (k, db::Edge (*pt0, *pt)));
 
         was_path_before = false;
 
@@ -439,19 +663,14 @@ DEFImporter::produce_routing_geometry (db::Cell &design, const Polygon *style, u
   } else {
 
     for (size_t i = 0; i < pts.size () - 1; ++i) {
-      db::Polygon p = db::minkowsky_sum (*style, db::Edge (pts [i], pts [i + 1]));
-      if (prop_id != 0) {
-        design.shapes (layer).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-      } else {
-        design.shapes (layer).insert (p);
-      }
+      stage.add_polygon (layer, db::minkowsky_sum (*style, db::Edge (pts [i], pts [i + 1])));
     }
 
   }
 }
 
 void
-DEFImporter::read_single_net (std::string &nondefaultrule, Layout &layout, db::Cell &design, double scale, db::properties_id_type prop_id, bool specialnets)
+DEFImporter::read_single_net (std::string &nondefaultrule, DEFImporterStage &stage, double dbu, double scale, bool specialnets)
 {
   std::string taperrule;
 
@@ -509,12 +728,13 @@ DEFImporter::read_single_net (std::string &nondefaultrule, Layout &layout, db::C
     std::pair<db::Coord, db::Coord> def_ext (0, 0);
 
     if (! specialnets) {
-      w = get_wire_width_for_rule (*rulename, ln, layout.dbu ());
-      def_ext = get_def_ext (ln, w, layout.dbu ());
+      const wire_width_and_ext_type &we = get_wire_width_and_ext (*rulename, ln, dbu);
+      w = we.first;
+      def_ext = we.second;
     }
 
-    std::map<int, db::Polygon>::const_iterator s = m_styles.find (sn);
-    if (s != m_styles.end ()) {
+    std::map<int, db::Polygon>::const_iterator s = master ().m_styles.find (sn);
+    if (s != master ().m_styles.end ()) {
       style = &s->second;
     }
 
@@ -554,22 +774,10 @@ DEFImporter::read_single_net (std::string &nondefaultrule, Layout &layout, db::C
 
         test (")");
 
-        std::set <unsigned int> dl = open_layer (layout, ln, specialnets ? SpecialRouting : Routing, mask);
-        if (! dl.empty ()) {
+        db::Box rect (db::Point (db::DPoint ((x + x1) * scale, (y + y1) * scale)),
+                      db::Point (db::DPoint ((x + x2) * scale, (y + y2) * scale)));
 
-          db::Point p (x, y);
-          db::Box rect (db::Point (db::DPoint ((x + x1) * scale, (y + y1) * scale)),
-                        db::Point (db::DPoint ((x + x2) * scale, (y + y2) * scale)));
-
-          for (std::set<unsigned int>::const_iterator l = dl.begin (); l != dl.end (); ++l) {
-            if (prop_id != 0) {
-              design.shapes (*l).insert (db::object_with_properties<db::Box> (rect, prop_id));
-            } else {
-              design.shapes (*l).insert (rect);
-            }
-          }
-
-        }
+        stage.add_box (stage.layer (ln, specialnets ? SpecialRouting : Routing, mask), rect);
 
       } else if (test ("VIRTUAL")) {
 
@@ -617,10 +825,7 @@ DEFImporter::read_single_net (std::string &nondefaultrule, Layout &layout, db::C
         }
 
         if (pts.size () > 1) {
-          std::set <unsigned int> dl = open_layer (layout, ln, specialnets ? SpecialRouting : Routing, mask);
-          for (std::set<unsigned int>::const_iterator l = dl.begin (); l != dl.end (); ++l) {
-            produce_routing_geometry (design, style, *l, prop_id, pts, ext, w);
-          }
+          produce_routing_geometry (stage, style, stage.layer (ln, specialnets ? SpecialRouting : Routing, mask), pts, ext, w);
         }
 
         //  continue a segment with the current point and the new mask
@@ -659,21 +864,18 @@ DEFImporter::read_single_net (std::string &nondefaultrule, Layout &layout, db::C
 
         }
 
-        std::map<std::string, ViaDesc>::const_iterator vd = m_via_desc.find (vn);
-        if (vd != m_via_desc.end () && ! pts.empty ()) {
+        std::unordered_map<std::string, ViaDesc>::const_iterator vd = master ().m_via_desc.find (vn);
+        if (vd != master ().m_via_desc.end () && ! pts.empty ()) {
 
           //  For the via, the masks are encoded in a three-digit number (<mask-top> <mask-cut> <mask_bottom>)
           unsigned int mask_top = (mask / 100) % 10;
           unsigned int mask_cut = (mask / 10) % 10;
           unsigned int mask_bottom = mask % 10;
 
-          db::Cell *cell = reader_state ()->via_cell (vn, layout, mask_bottom, mask_cut, mask_top, &m_lef_importer);
-          if (cell) {
-            if (nx <= 1 && ny <= 1) {
-              design.insert (db::CellInstArray (db::CellInst (cell->cell_index ()), db::Trans (ft.rot (), db::Vector (pts.back ()))));
-            } else {
-              design.insert (db::CellInstArray (db::CellInst (cell->cell_index ()), db::Trans (ft.rot (), db::Vector (pts.back ())), db::Vector (dx, 0), db::Vector (0, dy), (unsigned long) nx, (unsigned long) ny));
-            }
+          if (nx <= 1 && ny <= 1) {
+            stage.add_via (vn, mask_bottom, mask_cut, mask_top, db::Trans (ft.rot (), db::Vector (pts.back ())));
+          } else {
+            stage.add_via (vn, mask_bottom, mask_cut, mask_top, db::Trans (ft.rot (), db::Vector (pts.back ())), db::Vector (dx, 0), db::Vector (0, dy), (unsigned long) nx, (unsigned long) ny);
           }
 
           if (ln == vd->second.m1) {
@@ -691,8 +893,9 @@ DEFImporter::read_single_net (std::string &nondefaultrule, Layout &layout, db::C
         }
 
         if (! specialnets) {
-          w = get_wire_width_for_rule (*rulename, ln, layout.dbu ());
-          def_ext = get_def_ext (ln, w, layout.dbu ());
+          const wire_width_and_ext_type &we = get_wire_width_and_ext (*rulename, ln, dbu);
+          w = we.first;
+          def_ext = we.second;
         }
 
         //  continue a segment with the current point and the new layer
@@ -715,182 +918,162 @@ DEFImporter::read_single_net (std::string &nondefaultrule, Layout &layout, db::C
 void
 DEFImporter::read_nets (db::Layout &layout, db::Cell &design, double scale, bool specialnets)
 {
-  while (test ("-")) {
+  read_staged_section (layout, &design, 0, specialnets ? SpecialNets : Nets, scale);
+}
 
-    std::string net = get ();
-    std::string nondefaultrule;
-    std::string stored_netname, stored_nondefaultrule;
-    db::properties_id_type stored_prop_id;
-    bool in_subnet = false;
+void
+DEFImporter::read_net (DEFImporterStage &stage, double dbu, double scale, bool specialnets)
+{
+  std::string net = get ();
+  std::string nondefaultrule;
+  std::string stored_netname, stored_nondefaultrule;
+  bool in_subnet = false;
 
-    db::properties_id_type prop_id = 0;
-    if (produce_net_props ()) {
-      db::PropertiesRepository::properties_set props;
-      props.insert (std::make_pair (net_prop_name_id (), tl::Variant (net)));
-      prop_id = layout.properties_repository ().properties_id (props);
-    }
+  if (produce_net_props ()) {
+    stage.set_net (net);
+  }
 
-    while (test ("(")) {
-      while (! test (")")) {
-        take ();
-      }
+  while (test ("(")) {
+    while (! test (")")) {
+      take ();
     }
+  }
 
-    while (test ("+")) {
+  while (test ("+")) {
 
-      bool was_shield = false;
-      unsigned int mask = 0;
+    bool was_shield = false;
+    unsigned int mask = 0;
 
-      if (! specialnets && test ("SUBNET")) {
+    if (! specialnets && test ("SUBNET")) {
 
-        std::string subnetname = get ();
+      std::string subnetname = get ();
 
-        while (test ("(")) {
-          while (! test (")")) {
-            take ();
-          }
+      while (test ("(")) {
+        while (! test (")")) {
+          take ();
         }
+      }
 
-        if (! in_subnet) {
-          stored_netname = net;
-          stored_nondefaultrule = nondefaultrule;
-          stored_prop_id = prop_id;
-          in_subnet = true;
-        } else {
-          warn ("Nested subnets");
-        }
+      if (! in_subnet) {
+        stored_netname = net;
+        stored_nondefaultrule = nondefaultrule;
+        in_subnet = true;
+      } else {
+        warn ("Nested subnets");
+      }
 
-        net = stored_netname + "/" + subnetname;
+      net = stored_netname + "/" + subnetname;
 
-        if (produce_net_props ()) {
-          db::PropertiesRepository::properties_set props;
-          props.insert (std::make_pair (net_prop_name_id (), tl::Variant (net)));
-          prop_id = layout.properties_repository ().properties_id (props);
-        }
+      if (produce_net_props ()) {
+        stage.set_net (net);
+      }
 
-      } else if (! specialnets && test ("NONDEFAULTRULE")) {
+    } else if (! specialnets && test ("NONDEFAULTRULE")) {
 
-        nondefaultrule = get ();
+      nondefaultrule = get ();
 
-      } else {
+    } else {
 
-        bool prefixed = false;
-        bool can_have_rect_polygon_or_via = true;
+      bool prefixed = false;
+      bool can_have_rect_polygon_or_via = true;
 
-        if ((was_shield = test ("SHIELD")) == true || test ("NOSHIELD") || test ("ROUTED") || test ("FIXED") || test ("COVER")) {
-          if (was_shield) {
-            take ();
-          }
-          prefixed = true;
-          can_have_rect_polygon_or_via = test ("+");
+      if ((was_shield = test ("SHIELD")) == true || test ("NOSHIELD") || test ("ROUTED") || test ("FIXED") || test ("COVER")) {
+        if (was_shield) {
+          take ();
         }
+        prefixed = true;
+        can_have_rect_polygon_or_via = test ("+");
+      }
 
-        bool any = false;
+      bool any = false;
 
-        if (can_have_rect_polygon_or_via) {
-          if (test ("SHAPE")) {
-            take ();
-            test ("+");
-          }
-          if (test ("MASK")) {
-            mask = get_mask (get_long ());
-            test ("+");
-          }
+      if (can_have_rect_polygon_or_via) {
+        if (test ("SHAPE")) {
+          take ();
+          test ("+");
         }
+        if (test ("MASK")) {
+          mask = get_mask (get_long ());
+          test ("+");
+        }
+      }
 
-        if (can_have_rect_polygon_or_via && test ("POLYGON")) {
-
-          std::string ln = get ();
+      if (can_have_rect_polygon_or_via && test ("POLYGON")) {
 
-          db::Polygon p;
-          read_polygon (p, scale);
+        std::string ln = get ();
 
-          std::set <unsigned int> dl = open_layer (layout, ln, specialnets ? SpecialRouting : Routing, mask);
-          for (std::set<unsigned int>::const_iterator l = dl.begin (); l != dl.end (); ++l) {
-            if (prop_id != 0) {
-              design.shapes (*l).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-            } else {
-              design.shapes (*l).insert (p);
-            }
-          }
+        db::Polygon p;
+        read_polygon (p, scale);
 
-          any = true;
+        stage.add_polygon (stage.layer (ln, specialnets ? SpecialRouting : Routing, mask), p);
 
-        } else if (can_have_rect_polygon_or_via && test ("RECT")) {
+        any = true;
 
-          std::string ln = get ();
+      } else if (can_have_rect_polygon_or_via && test ("RECT")) {
 
-          db::Polygon p;
-          read_rect (p, scale);
+        std::string ln = get ();
 
-          std::set <unsigned int> dl = open_layer (layout, ln, specialnets ? SpecialRouting : Routing, mask);
-          for (std::set<unsigned int>::const_iterator l = dl.begin (); l != dl.end (); ++l) {
-            if (prop_id != 0) {
-              design.shapes (*l).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-            } else {
-              design.shapes (*l).insert (p);
-            }
-          }
+        db::Polygon p;
+        read_rect (p, scale);
 
-          any = true;
+        stage.add_polygon (stage.layer (ln, specialnets ? SpecialRouting : Routing, mask), p);
 
-        } else if (can_have_rect_polygon_or_via && test ("VIA")) {
+        any = true;
 
-          std::string vn = get ();
-          db::FTrans ft = get_orient (true /*optional*/);
+      } else if (can_have_rect_polygon_or_via && test ("VIA")) {
 
-          test ("(");
-          db::Vector pt = get_vector (scale);
-          test (")");
+        std::string vn = get ();
+        db::FTrans ft = get_orient (true /*optional*/);
 
-          std::map<std::string, ViaDesc>::const_iterator vd = m_via_desc.find (vn);
-          if (vd != m_via_desc.end ()) {
-            //  TODO: no mask specification here?
-            db::Cell *cell = reader_state ()->via_cell (vn, layout, 0, 0, 0, &m_lef_importer);
-            if (cell) {
-              design.insert (db::CellInstArray (db::CellInst (cell->cell_index ()), db::Trans (ft.rot (), pt)));
-            }
-          } else {
-            error (tl::to_string (tr ("Invalid via name: ")) + vn);
-          }
+        test ("(");
+        db::Vector pt = get_vector (scale);
+        test (")");
 
-          any = true;
+        std::unordered_map<std::string, ViaDesc>::const_iterator vd = master ().m_via_desc.find (vn);
+        if (vd != master ().m_via_desc.end ()) {
+          //  TODO: no mask specification here?
+          stage.add_via (vn, 0, 0, 0, db::Trans (ft.rot (), pt));
+        } else {
+          error (tl::to_string (tr ("Invalid via name: ")) + vn);
+        }
 
-        } else if (prefixed) {
+        any = true;
 
-          read_single_net (nondefaultrule, layout, design, scale, prop_id, specialnets);
-          any = true;
+      } else if (prefixed) {
 
-        } else {
+        read_single_net (nondefaultrule, stage, dbu, scale, specialnets);
+        any = true;
 
-          //  lazily skip everything else
-          while (! peek ("+") && ! peek ("-") && ! peek (";")) {
-            take ();
-          }
+      } else {
 
+        //  lazily skip everything else
+        while (! peek ("+") && ! peek ("-") && ! peek (";")) {
+          take ();
         }
 
-        if (any && in_subnet) {
+      }
 
-          in_subnet = false;
+      if (any && in_subnet) {
 
-          net = stored_netname;
-          nondefaultrule = stored_nondefaultrule;
-          prop_id = stored_prop_id;
+        in_subnet = false;
 
-          stored_netname.clear ();
-          stored_nondefaultrule.clear ();
-          stored_prop_id = 0;
+        net = stored_netname;
+        nondefaultrule = stored_nondefaultrule;
 
+        if (produce_net_props ()) {
+          stage.set_net (net);
         }
 
+        stored_netname.clear ();
+        stored_nondefaultrule.clear ();
+
       }
 
     }
 
-    expect (";");
-
   }
+
+  expect (";");
 }
 
 void
@@ -1278,53 +1461,249 @@ DEFImporter::read_styles (double scale)
 void
 DEFImporter::read_components (db::Layout &layout, std::list<std::pair<std::string, CellInstArray> > &instances, double scale)
 {
-  while (test ("-")) {
+  read_staged_section (layout, 0, &instances, Components, scale);
+}
 
-    std::string inst_name = get ();
-    std::string model = get ();
+void
+DEFImporter::read_component (DEFImporterStage &stage, double scale)
+{
+  std::string inst_name = get ();
+  std::string model = get ();
 
-    db::FTrans ft;
-    db::Vector d;
-    bool is_placed = false;
-    std::string maskshift;
+  db::FTrans ft;
+  db::Vector d;
+  bool is_placed = false;
+  std::string maskshift;
+
+  std::map<std::string, MacroDesc>::const_iterator m = master ().m_lef_importer.macros ().find (model);
+  if (m == master ().m_lef_importer.macros ().end ()) {
+    error (tl::to_string (tr ("Macro not found in LEF file: ")) + model);
+  }
 
-    std::map<std::string, MacroDesc>::const_iterator m = m_lef_importer.macros ().find (model);
-    if (m == m_lef_importer.macros ().end ()) {
-      error (tl::to_string (tr ("Macro not found in LEF file: ")) + model);
+  while (test ("+")) {
+
+    if (test ("PLACED") || test ("FIXED") || test ("COVER")) {
+
+      test ("(");
+      db::Point pt = get_point (scale);
+      test (")");
+
+      ft = get_orient (false /*mandatory*/);
+      d = pt - m->second.bbox.transformed (ft).lower_left ();
+      is_placed = true;
+
+    } else if (test ("MASKSHIFT")) {
+
+      maskshift = get ();
+
+    } else {
+      while (! peek ("+") && ! peek ("-") && ! peek (";")) {
+        take ();
+      }
     }
 
-    while (test ("+")) {
+  }
 
-      if (test ("PLACED") || test ("FIXED") || test ("COVER")) {
+  expect (";");
 
-        test ("(");
-        db::Point pt = get_point (scale);
-        test (")");
+  if (is_placed) {
+    stage.add_component (inst_name, model, maskshift, &m->second, db::Trans (ft.rot (), d));
+  }
+}
+
+void
+DEFImporter::read_staged_statement (DEFImporterStage &stage, StagedSection section, double dbu, double scale)
+{
+  if (section == Components) {
+    read_component (stage, scale);
+  } else {
+    read_net (stage, dbu, scale, section == SpecialNets);
+  }
+}
+
+void
+DEFImporter::read_staged_section (db::Layout &layout, db::Cell *design, std::list<std::pair<std::string, db::CellInstArray> > *instances, StagedSection section, double scale)
+{
+  DEFImporterStage stage;
 
-        ft = get_orient (false /*mandatory*/);
-        d = pt - m->second.bbox.transformed (ft).lower_left ();
-        is_placed = true;
+  unsigned int threads = options ().threads ();
+  if (threads == 0) {
 
-      } else if (test ("MASKSHIFT")) {
+    //  single-threaded: produce the objects right after each statement
+    while (test ("-")) {
+      stage.clear ();
+      read_staged_statement (stage, section, layout.dbu (), scale);
+      produce_staged (stage, layout, design, instances);
+    }
 
-        maskshift = get ();
+    return;
 
-      } else {
-        while (! peek ("+") && ! peek ("-") && ! peek (";")) {
-          take ();
-        }
+  }
+
+  //  Multi-threaded: the statements are collected into chunks of text which are parsed
+  //  in parallel in batches. The objects are produced in the original order afterwards.
+
+  const size_t chunk_size = 256 * 1024;
+  const size_t chunks_per_batch = size_t (threads) * 4;
+
+  bool at_end = false;
+
+  while (! at_end) {
+
+    std::vector<DEFImporterChunk> chunks;
+    chunks.reserve (chunks_per_batch);
+
+    while (chunks.size () < chunks_per_batch) {
+      chunks.push_back (DEFImporterChunk ());
+      if (! read_section_chunk (chunks.back ().text, chunks.back ().first_line, chunk_size)) {
+        chunks.pop_back ();
+        at_end = true;
+        break;
+      }
+    }
+
+    if (chunks.size () == 1) {
+
+      parse_chunk (chunks.front (), section, layout.dbu (), scale);
+
+    } else if (chunks.size () > 1) {
+
+      tl::Job<DEFImporterChunkWorker> job (int (std::min (size_t (threads), chunks.size ())));
+      for (std::vector<DEFImporterChunk>::iterator c = chunks.begin (); c != chunks.end (); ++c) {
+        job.schedule (new DEFImporterChunkTask (this, &*c, int (section), layout.dbu (), scale));
+      }
+
+      job.start ();
+      job.wait ();
+
+      if (job.has_error ()) {
+        throw tl::Exception (job.error_messages ().front ());
       }
 
     }
 
-    expect (";");
+    for (std::vector<DEFImporterChunk>::iterator c = chunks.begin (); c != chunks.end (); ++c) {
+      produce_staged (c->stage, layout, design, instances);
+      if (! c->error.empty ()) {
+        throw db::ReaderException (c->error);
+      }
+    }
+
+  }
+}
+
+void
+DEFImporter::parse_chunk (DEFImporterChunk &chunk, StagedSection section, double dbu, double scale) const
+{
+  DEFImporter parser (this);
+
+  tl::InputMemoryStream memory_stream (chunk.text.c_str (), chunk.text.size ());
+  tl::InputStream stream (memory_stream);
+  tl::TextInputStream text_stream (stream);
+
+  parser.begin_chunk (*this, text_stream, chunk.first_line, &chunk.stage.warnings);
+
+  try {
+    while (! parser.at_end ()) {
+      parser.expect ("-");
+      parser.read_staged_statement (chunk.stage, section, dbu, scale);
+    }
+  } catch (tl::Exception &ex) {
+    chunk.error = ex.msg ();
+  }
+
+  parser.end_chunk ();
+}
+
+void
+DEFImporter::produce_staged (DEFImporterStage &stage, db::Layout &layout, db::Cell *design, std::list<std::pair<std::string, db::CellInstArray> > *instances)
+{
+  for (std::vector<std::string>::const_iterator w = stage.warnings.begin (); w != stage.warnings.end (); ++w) {
+    tl::warn << *w;
+  }
+
+  //  layers and via cells are resolved on first use, so they are created in the same order
+  //  than without staging
+  std::vector<std::set<unsigned int> > &layers = stage.layers;
+  std::vector<bool> &layers_resolved = stage.layers_resolved;
+  layers.resize (stage.layer_keys.size ());
+  layers_resolved.resize (stage.layer_keys.size (), false);
+
+  std::vector<db::Cell *> &via_cells = stage.via_cells;
+  std::vector<bool> &via_cells_resolved = stage.via_cells_resolved;
+  via_cells.resize (stage.via_keys.size (), (db::Cell *) 0);
+  via_cells_resolved.resize (stage.via_keys.size (), false);
 
-    if (is_placed) {
+  db::properties_id_type prop_id = 0;
+
+  for (std::vector<DEFImporterStage::Op>::const_iterator op = stage.ops.begin (); op != stage.ops.end (); ++op) {
+
+    if (op->type == DEFImporterStage::SetNet) {
+
+      db::PropertiesRepository::properties_set props;
+      props.insert (std::make_pair (net_prop_name_id (), tl::Variant (stage.nets [op->index])));
+      prop_id = layout.properties_repository ().properties_id (props);
+
+    } else if (op->type == DEFImporterStage::Via) {
+
+      if (! via_cells_resolved [op->key]) {
+        const DEFImporterStage::via_key_type &vk = stage.via_keys [op->key];
+        via_cells [op->key] = reader_state ()->via_cell (vk.first, layout, vk.second % 10, (vk.second / 10) % 10, (vk.second / 100) % 10, &m_lef_importer);
+        via_cells_resolved [op->key] = true;
+      }
+
+      db::Cell *cell = via_cells [op->key];
+      if (cell && design) {
+        const DEFImporterStage::ViaInst &vi = stage.vias [op->index];
+        if (vi.na <= 1 && vi.nb <= 1) {
+          design->insert (db::CellInstArray (db::CellInst (cell->cell_index ()), vi.trans));
+        } else {
+          design->insert (db::CellInstArray (db::CellInst (cell->cell_index ()), vi.trans, vi.a, vi.b, vi.na, vi.nb));
+        }
+      }
+
+    } else if (op->type == DEFImporterStage::Component) {
+
+      const DEFImporterStage::ComponentInst &ci = stage.components [op->index];
+      std::pair<db::Cell *, db::Trans> ct = reader_state ()->macro_cell (ci.model, layout, m_component_maskshift, string2masks (ci.maskshift), *ci.macro, &m_lef_importer);
+      if (ct.first && instances) {
+        db::CellInstArray inst (db::CellInst (ct.first->cell_index ()), ci.trans * ct.second);
+        instances->push_back (std::make_pair (ci.inst_name, inst));
+      }
+
+    } else if (design) {
+
+      if (! layers_resolved [op->key]) {
+        const DEFImporterStage::layer_key_type &lk = stage.layer_keys [op->key];
+        layers [op->key] = open_layer (layout, lk.first, LayerPurpose (lk.second.first), lk.second.second);
+        layers_resolved [op->key] = true;
+      }
+
+      const std::set<unsigned int> &dl = layers [op->key];
+      for (std::set<unsigned int>::const_iterator l = dl.begin (); l != dl.end (); ++l) {
+
+        db::Shapes &shapes = design->shapes (*l);
+
+        if (op->type == DEFImporterStage::Box) {
+          if (prop_id != 0) {
+            shapes.insert (db::object_with_properties<db::Box> (stage.boxes [op->index], prop_id));
+          } else {
+            shapes.insert (stage.boxes [op->index]);
+          }
+        } else if (op->type == DEFImporterStage::Polygon) {
+          if (prop_id != 0) {
+            shapes.insert (db::object_with_properties<db::Polygon> (stage.polygons [op->index], prop_id));
+          } else {
+            shapes.insert (stage.polygons [op->index]);
+          }
+        } else if (op->type == DEFImporterStage::Path) {
+          if (prop_id != 0) {
+            shapes.insert (db::object_with_properties<db::Path> (stage.paths [op->index], prop_id));
+          } else {
+            shapes.insert (stage.paths [op->index]);
+          }
+        }
 
-      std::pair<db::Cell *, db::Trans> ct = reader_state ()->macro_cell (model, layout, m_component_maskshift, string2masks (maskshift), m->second, &m_lef_importer);
-      if (ct.first) {
-        db::CellInstArray inst (db::CellInst (ct.first->cell_index ()), db::Trans (ft.rot (), d) * ct.second);
-        instances.push_back (std::make_pair (inst_name, inst));
       }
 
     }
@@ -1344,8 +1723,10 @@ DEFImporter::do_read (db::Layout &layout)
   std::list<DEFImporterGroup> groups;
   std::list<std::pair<std::string, db::CellInstArray> > instances;
 
-  m_via_desc = m_lef_importer.vias ();
+  m_via_desc.clear ();
+  m_via_desc.insert (m_lef_importer.vias ().begin (), m_lef_importer.vias ().end ());
   m_styles.clear ();
+  m_wire_width_cache.clear ();
 
   db::Cell &design = layout.cell (layout.add_cell ("TOP"));
 
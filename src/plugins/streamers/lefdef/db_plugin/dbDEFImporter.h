@@ -29,14 +29,19 @@
 #include "dbLayout.h"
 #include "tlStream.h"
 #include "dbLEFImporter.h"
+#include "dbHash.h"
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 namespace db
 {
 
 struct DEFImporterGroup;
+struct DEFImporterStage;
+struct DEFImporterChunk;
+class DEFImporterChunkTask;
 
 /**
  *  @brief The DEF importer object
@@ -58,6 +63,14 @@ public:
    */
   void read_lef (tl::InputStream &stream, db::Layout &layout, LEFDEFReaderState &state);
 
+  /**
+   *  @brief Reads the given LEF files
+   *
+   *  This is equivalent to calling "read_lef" for each file, but allows parsing the files
+   *  in multiple threads and taking them from the LEF cache (see LEFImporter::read_files).
+   */
+  void read_lef_files (const std::vector<std::string> &paths, db::Layout &layout, LEFDEFReaderState &state);
+
   /**
    *  @brief Provided for test purposes
    */
@@ -67,28 +80,63 @@ protected:
   void do_read (db::Layout &layout);
 
 private:
+  friend class DEFImporterChunkTask;
+
+  /**
+   *  @brief The sections which are parsed into a DEFImporterStage
+   */
+  enum StagedSection
+  {
+    Components,
+    Nets,
+    SpecialNets
+  };
+
+  typedef std::pair<std::pair<db::Coord, db::Coord>, std::pair<db::Coord, db::Coord> > wire_width_and_ext_type;
+
+  const DEFImporter *mp_parent;
   LEFImporter m_lef_importer;
   std::map<std::string, std::map<std::string, db::Coord> > m_nondefault_widths;
-  std::map<std::string, ViaDesc> m_via_desc;
+  //  NOTE: the via descriptors are looked up for every via in the routing, hence the hash table
+  std::unordered_map<std::string, ViaDesc> m_via_desc;
   std::map<int, db::Polygon> m_styles;
   std::vector<std::string> m_component_maskshift;
+  std::unordered_map<std::pair<std::string, std::string>, wire_width_and_ext_type> m_wire_width_cache;
+
+  DEFImporter (const DEFImporter *parent);
+
+  /**
+   *  @brief Gets the importer holding the LEF, via, style and rule data
+   *  For chunk parsers this is the parent importer.
+   */
+  const DEFImporter &master () const
+  {
+    return mp_parent ? *mp_parent : *this;
+  }
 
   void read_polygon (db::Polygon &poly, double scale);
   void read_rect (db::Polygon &poly, double scale);
   std::pair<Coord, Coord> get_wire_width_for_rule(const std::string &rule, const std::string &ln, double dbu);
   std::pair<db::Coord, db::Coord> get_def_ext (const std::string &ln, const std::pair<db::Coord, db::Coord> &wxy, double dbu);
+  const wire_width_and_ext_type &get_wire_width_and_ext (const std::string &rule, const std::string &ln, double dbu);
   void read_diearea (db::Layout &layout, db::Cell &design, double scale);
   void read_nondefaultrules (double scale);
   void read_regions (std::map<std::string, std::vector<db::Polygon> > &regions, double scale);
   void read_groups (std::list<DEFImporterGroup> &groups, double scale);
   void read_blockages (db::Layout &layout, db::Cell &design, double scale);
   void read_nets (db::Layout &layout, db::Cell &design, double scale, bool specialnets);
+  void read_net (DEFImporterStage &stage, double dbu, double scale, bool specialnets);
   void read_vias (db::Layout &layout, db::Cell &design, double scale);
   void read_pins (db::Layout &layout, db::Cell &design, double scale);
   void read_styles (double scale);
   void read_components (Layout &layout, std::list<std::pair<std::string, db::CellInstArray> > &instances, double scale);
-  void read_single_net (std::string &nondefaultrule, db::Layout &layout, db::Cell &design, double scale, properties_id_type prop_id, bool specialnets);
-  void produce_routing_geometry (db::Cell &design, const db::Polygon *style, unsigned int layer, properties_id_type prop_id, const std::vector<db::Point> &pts, const std::vector<std::pair<db::Coord, db::Coord> > &ext, std::pair<db::Coord, db::Coord> w);
+  void read_component (DEFImporterStage &stage, double scale);
+  void read_single_net (std::string &nondefaultrule, DEFImporterStage &stage, double dbu, double scale, bool specialnets);
+  void produce_routing_geometry (DEFImporterStage &stage, const db::Polygon *style, unsigned int layer, const std::vector<db::Point> &pts, const std::vector<std::pair<db::Coord, db::Coord> > &ext, std::pair<db::Coord, db::Coord> w);
+  void read_staged_section (db::Layout &layout, db::Cell *design, std::list<std::pair<std::string, db::CellInstArray> > *instances, StagedSection section, double scale);
+  void read_staged_statement (DEFImporterStage &stage, StagedSection section, double dbu, double scale);
+  void parse_chunk (DEFImporterChunk &chunk, StagedSection section, double dbu, double scale) const;
+  void produce_staged (DEFImporterStage &stage, db::Layout &layout, db::Cell *design, std::list<std::pair<std::string, db::CellInstArray> > *instances);
 };
 
 }
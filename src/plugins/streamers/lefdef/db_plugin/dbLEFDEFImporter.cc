@@ -397,6 +397,47 @@ GeometryBasedLayoutGenerator::add_via (const std::string &vn, const db::Trans &t
   m_vias.back ().top_mask = top_mask;
 }
 
+namespace
+{
+
+/**
+ *  @brief A properties ID mapper for Shapes::insert
+ */
+class PropertiesIdMapper
+{
+public:
+  PropertiesIdMapper (const std::map<db::properties_id_type, db::properties_id_type> &pm)
+    : mp_pm (&pm)
+  {
+    //  .. nothing yet ..
+  }
+
+  db::properties_id_type operator() (db::properties_id_type id) const
+  {
+    std::map<db::properties_id_type, db::properties_id_type>::const_iterator i = mp_pm->find (id);
+    return i != mp_pm->end () ? i->second : id;
+  }
+
+private:
+  const std::map<db::properties_id_type, db::properties_id_type> *mp_pm;
+};
+
+}
+
+void
+GeometryBasedLayoutGenerator::map_properties (const std::map<db::properties_id_type, db::properties_id_type> &pm)
+{
+  PropertiesIdMapper mapper (pm);
+
+  for (shapes_map::iterator g = m_shapes.begin (); g != m_shapes.end (); ++g) {
+    db::Shapes mapped;
+    for (db::ShapeIterator s = g->second.begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+      mapped.insert (*s, mapper);
+    }
+    g->second.swap (mapped);
+  }
+}
+
 // -----------------------------------------------------------------------------------
 //  LEFDEFTechnologyComponent implementation
 
@@ -443,7 +484,9 @@ LEFDEFReaderOptions::LEFDEFReaderOptions ()
     m_separate_groups (false),
     m_map_file (),
     m_macro_resolution_mode (false),
-    m_read_lef_with_def (true)
+    m_read_lef_with_def (true),
+    m_threads (0),
+    m_lef_cache_path ()
 {
   //  .. nothing yet ..
 }
@@ -513,6 +556,8 @@ LEFDEFReaderOptions &LEFDEFReaderOptions::operator= (const LEFDEFReaderOptions &
     m_macro_resolution_mode = d.m_macro_resolution_mode;
     m_lef_files = d.m_lef_files;
     m_read_lef_with_def = d.m_read_lef_with_def;
+    m_threads = d.m_threads;
+    m_lef_cache_path = d.m_lef_cache_path;
     set_macro_layouts (d.macro_layouts ());
   }
   return *this;
@@ -1672,6 +1717,7 @@ LEFDEFReaderState::macro_cell (const std::string &mn, Layout &layout, const std:
 
 LEFDEFImporter::LEFDEFImporter ()
   : mp_progress (0), mp_stream (0), mp_reader_state (0),
+    m_line_offset (0), mp_warnings (0),
     m_produce_net_props (false), m_net_prop_name_id (0),
     m_produce_inst_props (false), m_inst_prop_name_id (0),
     m_produce_pin_props (false), m_pin_prop_name_id (0)
@@ -1700,6 +1746,30 @@ LEFDEFImporter::read (tl::InputStream &stream, db::Layout &layout, LEFDEFReaderS
   progress.set_format_unit (1000.0);
   progress.set_unit (10000.0);
 
+  attach (layout, state);
+
+  try {
+
+    mp_progress = &progress;
+    mp_stream = new tl::TextInputStream (stream);
+
+    do_read (layout); 
+
+    delete mp_stream;
+    mp_stream = 0;
+    mp_progress = 0;
+
+  } catch (...) {
+    delete mp_stream;
+    mp_stream = 0;
+    mp_progress = 0;
+    throw;
+  }
+}
+
+void
+LEFDEFImporter::attach (db::Layout &layout, LEFDEFReaderState &state)
+{
   mp_reader_state = &state;
 
   if (state.tech_comp ()) {
@@ -1729,22 +1799,40 @@ LEFDEFImporter::read (tl::InputStream &stream, db::Layout &layout, LEFDEFReaderS
     m_produce_pin_props = true;
     m_pin_prop_name_id = layout.properties_repository ().prop_name_id (m_options.pin_property_name ());
   }
+}
+
+void
+LEFDEFImporter::read_detached (tl::InputStream &stream, const std::string &fn, db::Layout &layout, const LEFDEFReaderOptions &options, std::vector<std::string> *warnings)
+{
+  m_fn = fn;
+
+  mp_reader_state = 0;
+  m_options = options;
+  m_line_offset = 0;
+
+  //  property name IDs are not available without a layout to store the properties in
+  m_produce_net_props = m_options.produce_net_names ();
+  m_net_prop_name_id = 0;
+  m_produce_inst_props = m_options.produce_inst_names ();
+  m_inst_prop_name_id = 0;
+  m_produce_pin_props = m_options.produce_pin_names ();
+  m_pin_prop_name_id = 0;
 
   try {
 
-    mp_progress = &progress;
+    mp_warnings = warnings;
     mp_stream = new tl::TextInputStream (stream);
 
-    do_read (layout); 
+    do_read (layout);
 
     delete mp_stream;
     mp_stream = 0;
-    mp_progress = 0;
+    mp_warnings = 0;
 
   } catch (...) {
     delete mp_stream;
     mp_stream = 0;
-    mp_progress = 0;
+    mp_warnings = 0;
     throw;
   }
 }
@@ -1752,17 +1840,25 @@ LEFDEFImporter::read (tl::InputStream &stream, db::Layout &layout, LEFDEFReaderS
 void 
 LEFDEFImporter::error (const std::string &msg)
 {
-  throw LEFDEFReaderException (msg, int (mp_stream->line_number ()), m_cellname, m_fn);
+  throw LEFDEFReaderException (msg, int (mp_stream->line_number () + m_line_offset), m_cellname, m_fn);
 }
 
 void 
 LEFDEFImporter::warn (const std::string &msg)
 {
-  tl::warn << msg 
-           << tl::to_string (tr (" (line=")) << mp_stream->line_number ()
-           << tl::to_string (tr (", cell=")) << m_cellname
-           << tl::to_string (tr (", file=")) << m_fn
-           << ")";
+  if (mp_warnings) {
+    mp_warnings->push_back (msg
+                            + tl::to_string (tr (" (line=")) + tl::to_string (mp_stream->line_number () + m_line_offset)
+                            + tl::to_string (tr (", cell=")) + m_cellname
+                            + tl::to_string (tr (", file=")) + m_fn
+                            + ")");
+  } else {
+    tl::warn << msg
+             << tl::to_string (tr (" (line=")) << mp_stream->line_number () + m_line_offset
+             << tl::to_string (tr (", cell=")) << m_cellname
+             << tl::to_string (tr (", file=")) << m_fn
+             << ")";
+  }
 }
 
 bool
@@ -1951,13 +2047,166 @@ LEFDEFImporter::next ()
 
   } while (c);
 
-  if (mp_stream->line_number () != last_line) {
+  if (mp_progress && mp_stream->line_number () != last_line) {
     ++*mp_progress;
   }
 
   return m_last_token;
 }
 
+bool
+LEFDEFImporter::read_section_chunk (std::string &text, size_t &first_line, size_t max_size)
+{
+  text.clear ();
+  text.reserve (max_size + 1024);
+  first_line = 0;
+
+  if (! m_last_token.empty ()) {
+    if (m_last_token != "-") {
+      return false;
+    }
+    first_line = mp_stream->line_number ();
+    text = m_last_token;
+    m_last_token.clear ();
+  }
+
+  //  The text is copied verbatim, including whitespace and comments, so the line numbers
+  //  stay valid. The tokens are only analyzed as far as required to find the statements.
+
+  bool at_statement_start = text.empty ();
+  size_t statement_end = 0;
+  size_t last_line = mp_stream->line_number ();
+
+  while (true) {
+
+    char c;
+    while ((c = mp_stream->get_char ()) != 0 && isspace (c)) {
+      if (! text.empty ()) {
+        text += c;
+      }
+    }
+
+    if (mp_progress && mp_stream->line_number () != last_line) {
+      last_line = mp_stream->line_number ();
+      ++*mp_progress;
+    }
+
+    if (! c) {
+      //  premature end of file: leave the error to the parser
+      return ! text.empty ();
+    }
+
+    if (text.empty ()) {
+      first_line = mp_stream->line_number ();
+    }
+
+    size_t token_start = text.size ();
+    text += c;
+
+    if (c == '#') {
+
+      while ((c = mp_stream->get_char ()) != 0 && (c != '\015' && c != '\012')) {
+        text += c;
+      }
+      if (c) {
+        text += c;
+      }
+
+    } else if (c == '\'' || c == '"') {
+
+      char quot = c;
+
+      while ((c = mp_stream->get_char ()) != 0 && c != quot) {
+        text += c;
+        if (c == '\\' && (c = mp_stream->get_char ()) != 0) {
+          text += c;
+        }
+      }
+      if (c) {
+        text += c;
+      }
+
+      at_statement_start = false;
+
+    } else {
+
+      bool escaped = false;
+
+      while ((c = mp_stream->get_char ()) != 0 && ! isspace (c)) {
+        text += c;
+        if (c == '\\' && (c = mp_stream->get_char ()) != 0) {
+          text += c;
+          escaped = true;
+        }
+      }
+
+      std::string token;
+      if (escaped) {
+        for (const char *cp = text.c_str () + token_start; *cp; ++cp) {
+          if (*cp != '\\' || ! cp[1]) {
+            token += *cp;
+          } else {
+            token += *++cp;
+          }
+        }
+      } else if (at_statement_start || text.size () == token_start + 1) {
+        token = std::string (text, token_start);
+      }
+
+      if (at_statement_start && token != "-") {
+        //  end of section (or an error): leave this token to the caller
+        m_last_token = token;
+        text.erase (statement_end);
+        return ! text.empty ();
+      }
+
+      if (c) {
+        text += c;
+      }
+
+      at_statement_start = (token == ";");
+      if (at_statement_start) {
+        statement_end = text.size ();
+        if (text.size () >= max_size) {
+          return true;
+        }
+      }
+
+    }
+
+  }
+}
+
+void
+LEFDEFImporter::begin_chunk (const LEFDEFImporter &parent, tl::TextInputStream &stream, size_t first_line, std::vector<std::string> *warnings)
+{
+  mp_progress = 0;
+  mp_stream = &stream;
+  mp_reader_state = 0;
+
+  m_cellname = parent.m_cellname;
+  m_fn = parent.m_fn;
+  m_last_token.clear ();
+  m_line_offset = first_line > 0 ? first_line - 1 : 0;
+  mp_warnings = warnings;
+
+  m_produce_net_props = parent.m_produce_net_props;
+  m_net_prop_name_id = parent.m_net_prop_name_id;
+  m_produce_inst_props = parent.m_produce_inst_props;
+  m_inst_prop_name_id = parent.m_inst_prop_name_id;
+  m_produce_pin_props = parent.m_produce_pin_props;
+  m_pin_prop_name_id = parent.m_pin_prop_name_id;
+  m_options = parent.m_options;
+}
+
+void
+LEFDEFImporter::end_chunk ()
+{
+  mp_stream = 0;
+  m_line_offset = 0;
+  mp_warnings = 0;
+}
+
 db::FTrans
 LEFDEFImporter::get_orient (bool optional)
 {
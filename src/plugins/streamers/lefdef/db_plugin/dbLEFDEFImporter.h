@@ -791,6 +791,35 @@ public:
     m_macro_resolution_mode = m;
   }
 
+  /**
+   *  @brief Gets the number of threads to use for parsing the DEF component and net sections and the LEF files
+   *  With 0 threads (the default), these sections and files are parsed in the calling thread.
+   */
+  unsigned int threads () const
+  {
+    return m_threads;
+  }
+
+  void set_threads (unsigned int n)
+  {
+    m_threads = n;
+  }
+
+  /**
+   *  @brief Gets the directory where parsed LEF files are cached
+   *  If this path is non-empty, the parsed LEF files are stored there and
+   *  reused if a LEF file with the same content is read with the same options again.
+   */
+  const std::string &lef_cache_path () const
+  {
+    return m_lef_cache_path;
+  }
+
+  void set_lef_cache_path (const std::string &p)
+  {
+    m_lef_cache_path = p;
+  }
+
   void set_macro_layouts (const std::vector<db::Layout *> &layouts)
   {
     for (std::vector<db::Layout *>::const_iterator l = layouts.begin (); l != layouts.end (); ++l) {
@@ -864,6 +893,8 @@ private:
   std::string m_map_file;
   unsigned int m_macro_resolution_mode;
   bool m_read_lef_with_def;
+  unsigned int m_threads;
+  std::string m_lef_cache_path;
   std::vector<std::string> m_lef_files;
   tl::weak_collection<db::Layout> m_macro_layouts;
 };
@@ -955,6 +986,23 @@ public:
   void set_cut_mask (unsigned int m) { m_cut_mask = m; }
   void set_top_mask (unsigned int m) { m_top_mask = m; }
 
+  const db::Vector &cutsize () const { return m_cutsize; }
+  const db::Vector &cutspacing () const { return m_cutspacing; }
+  const db::Point &offset () const { return m_offset; }
+  const db::Vector &be () const { return m_be; }
+  const db::Vector &te () const { return m_te; }
+  const db::Vector &bo () const { return m_bo; }
+  const db::Vector &to () const { return m_to; }
+  int rows () const { return m_rows; }
+  int columns () const { return m_columns; }
+  const std::string &pattern () const { return m_pattern; }
+  const std::string &bottom_layer () const { return m_bottom_layer; }
+  const std::string &cut_layer () const { return m_cut_layer; }
+  const std::string &top_layer () const { return m_top_layer; }
+  unsigned int bottom_mask () const { return m_bottom_mask; }
+  unsigned int cut_mask () const { return m_cut_mask; }
+  unsigned int top_mask () const { return m_top_mask; }
+
 private:
   std::string m_bottom_layer, m_cut_layer, m_top_layer;
   unsigned int m_bottom_mask, m_cut_mask, m_top_mask;
@@ -1000,7 +1048,13 @@ public:
     m_fixedmask = f;
   }
 
-private:
+  /**
+   *  @brief Replaces the properties IDs of the shapes
+   *
+   *  The map gives the new properties ID for a given one. IDs not listed are kept.
+   */
+  void map_properties (const std::map<db::properties_id_type, db::properties_id_type> &pm);
+
   struct Via {
     Via () : bottom_mask (0), cut_mask (0), top_mask (0) { }
     std::string name;
@@ -1008,6 +1062,33 @@ private:
     db::Trans trans;
   };
 
+  typedef std::map <std::pair<std::string, std::pair<LayerPurpose, unsigned int> >, db::Shapes> shapes_map;
+
+  /**
+   *  @brief Gets the shapes per layer name, purpose and mask
+   */
+  const shapes_map &shapes () const
+  {
+    return m_shapes;
+  }
+
+  /**
+   *  @brief Gets the shapes for a given layer name, purpose and mask (non-const version)
+   */
+  db::Shapes &shapes (const std::string &ln, LayerPurpose purpose, unsigned int mask)
+  {
+    return m_shapes [std::make_pair (ln, std::make_pair (purpose, mask))];
+  }
+
+  /**
+   *  @brief Gets the via instances
+   */
+  const std::list<Via> &vias () const
+  {
+    return m_vias;
+  }
+
+private:
   std::map <std::pair<std::string, std::pair<LayerPurpose, unsigned int> >, db::Shapes> m_shapes;
   std::list<Via> m_vias;
   std::vector<std::string> m_maskshift_layers;
@@ -1270,6 +1351,25 @@ public:
   void read (tl::InputStream &stream, db::Layout &layout, LEFDEFReaderState &state);
 
 protected:
+  /**
+   *  @brief Attaches the importer to a reader state without reading a file
+   *
+   *  This method takes the options from the reader state and registers the property names
+   *  in the layout. "read" does this before reading the file.
+   */
+  void attach (db::Layout &layout, LEFDEFReaderState &state);
+
+  /**
+   *  @brief Reads a file without a reader state
+   *
+   *  In this mode, the importer cannot create layers, cells or properties. Implementations
+   *  need to keep what they read inside the importer instead. This mode is used for parsing
+   *  files independently (i.e. in multiple threads). "layout" only provides the database unit
+   *  and "fn" is the file name used in messages. If "warnings" is non-null, the warnings are
+   *  collected there rather than being issued.
+   */
+  void read_detached (tl::InputStream &stream, const std::string &fn, db::Layout &layout, const LEFDEFReaderOptions &options, std::vector<std::string> *warnings);
+
   /**
    *  @brief Actually does the readong
    *
@@ -1360,6 +1460,34 @@ protected:
    */
   unsigned int get_mask (long m);
 
+  /**
+   *  @brief Collects the raw text of the next statements of a section
+   *
+   *  This method is used to extract the statements of sections like "COMPONENTS" or "NETS" for
+   *  parsing them separately (i.e. in multiple threads). Each statement starts with "-" and is
+   *  terminated by ";". The text of the statements is copied verbatim into "text" until it
+   *  exceeds "max_size" characters. "first_line" receives the line number of the first statement.
+   *  When a token other than "-" is encountered at the beginning of a statement, the
+   *  collection stops and this token becomes the next one to be read (usually "END").
+   *  Returns false if no statement was read.
+   */
+  bool read_section_chunk (std::string &text, size_t &first_line, size_t max_size);
+
+  /**
+   *  @brief Prepares this importer for parsing text extracted with "read_section_chunk"
+   *
+   *  This method takes the options, the file name and the property settings from the parent.
+   *  "first_line" is the line number of the text's first line within the original file.
+   *  If "warnings" is non-null, the warnings are collected there rather than being issued.
+   *  There is no reader state in chunk parser mode.
+   */
+  void begin_chunk (const LEFDEFImporter &parent, tl::TextInputStream &stream, size_t first_line, std::vector<std::string> *warnings);
+
+  /**
+   *  @brief Terminates the chunk parser mode
+   */
+  void end_chunk ();
+
   /**
    *  @brief Create a new layer or return the index of the given layer
    */
@@ -1463,6 +1591,8 @@ private:
   std::string m_cellname;
   std::string m_fn;
   std::string m_last_token;
+  size_t m_line_offset;
+  std::vector<std::string> *mp_warnings;
   bool m_produce_net_props;
   db::property_names_id_type m_net_prop_name_id;
   bool m_produce_inst_props;
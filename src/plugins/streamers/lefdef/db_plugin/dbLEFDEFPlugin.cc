@@ -131,16 +131,13 @@ private:
 
       db::LEFImporter importer;
 
+      std::vector<std::string> lef_paths;
       for (std::vector<std::string>::const_iterator l = effective_options.begin_lef_files (); l != effective_options.end_lef_files (); ++l) {
-
-        std::string lp = correct_path (*l, layout, tl::dirname (m_stream.absolute_path ()));
-
-        tl::InputStream lef_stream (lp);
-        tl::log << tl::to_string (tr ("Reading")) << " " << lp;
-        importer.read (lef_stream, layout, state);
-
+        lef_paths.push_back (correct_path (*l, layout, tl::dirname (m_stream.absolute_path ())));
       }
 
+      importer.read_files (lef_paths, layout, state);
+
       tl::log << tl::to_string (tr ("Reading")) << " " << m_stream.source ();
       importer.read (m_stream, layout, state);
 
@@ -152,16 +149,9 @@ private:
 
       DEFImporter importer;
 
+      std::vector<std::string> lef_paths;
       for (std::vector<std::string>::const_iterator l = effective_options.begin_lef_files (); l != effective_options.end_lef_files (); ++l) {
-
-        std::string lp = correct_path (*l, layout, tl::dirname (m_stream.absolute_path ()));
-
-        tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (tr ("Reading LEF file: ")) + lp);
-
-        tl::InputStream lef_stream (lp);
-        tl::log << tl::to_string (tr ("Reading")) << " " << lp;
-        importer.read_lef (lef_stream, layout, state);
-
+        lef_paths.push_back (correct_path (*l, layout, tl::dirname (m_stream.absolute_path ())));
       }
 
       //  Additionally read all LEF files next to the DEF file
@@ -176,15 +166,7 @@ private:
           for (std::vector<std::string>::const_iterator e = entries.begin (); e != entries.end (); ++e) {
 
             if (is_lef_format (*e)) {
-
-              std::string lp = tl::combine_path (input_dir, *e);
-
-              tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (tr ("Reading LEF file: ")) + lp);
-
-              tl::InputStream lef_stream (lp);
-              tl::log << tl::to_string (tr ("Reading")) << " " << lp;
-              importer.read_lef (lef_stream, layout, state);
-
+              lef_paths.push_back (tl::combine_path (input_dir, *e));
             }
 
           }
@@ -193,6 +175,11 @@ private:
 
       }
 
+      {
+        tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (tr ("Reading LEF files")));
+        importer.read_lef_files (lef_paths, layout, state);
+      }
+
       tl::log << tl::to_string (tr ("Reading")) << " " << m_stream.source ();
       importer.read (m_stream, layout, state);
 
@@ -367,7 +354,9 @@ class LEFDEFFormatDeclaration
       tl::make_member (&LEFDEFReaderOptions::read_lef_with_def, &LEFDEFReaderOptions::set_read_lef_with_def, "read-lef-with-def") +
       tl::make_member (&LEFDEFReaderOptions::macro_resolution_mode, &LEFDEFReaderOptions::set_macro_resolution_mode, "macro-resolution-mode", MacroResolutionModeConverter ()) +
       tl::make_member (&LEFDEFReaderOptions::separate_groups, &LEFDEFReaderOptions::set_separate_groups, "separate-groups") +
-      tl::make_member (&LEFDEFReaderOptions::map_file, &LEFDEFReaderOptions::set_map_file, "map-file")
+      tl::make_member (&LEFDEFReaderOptions::map_file, &LEFDEFReaderOptions::set_map_file, "map-file") +
+      tl::make_member (&LEFDEFReaderOptions::threads, &LEFDEFReaderOptions::set_threads, "threads") +
+      tl::make_member (&LEFDEFReaderOptions::lef_cache_path, &LEFDEFReaderOptions::set_lef_cache_path, "lef-cache-path")
     );
   }
 };
@@ -24,8 +24,15 @@
 #include "dbLEFImporter.h"
 
 #include "tlStream.h"
+#include "tlThreadedWorkers.h"
+#include "tlFileUtils.h"
+#include "tlProgress.h"
+#include "tlLog.h"
 
 #include <cctype>
+#include <cstring>
+#include <memory>
+#include <stdint.h>
 
 namespace db
 {
@@ -40,7 +47,7 @@ LEFImporter::LEFImporter ()
 
 LEFImporter::~LEFImporter ()
 {
-  //  .. nothing yet ..
+  clear_staged ();
 }
 
 double
@@ -140,6 +147,7 @@ LEFImporter::read_geometries (GeometryBasedLayoutGenerator *lg, double dbu, Laye
 {
   std::string layer_name;
   double w = 0.0;
+  bool default_width = false;
 
   while (true) {
 
@@ -155,6 +163,7 @@ LEFImporter::read_geometries (GeometryBasedLayoutGenerator *lg, double dbu, Laye
       layer_name = get ();
 
       w = 0.0;
+      default_width = true;
       std::map<std::string, std::pair<double, double> >::const_iterator dw = m_default_widths.find (layer_name);
       if (dw != m_default_widths.end ()) {
         w = dw->second.first;
@@ -167,6 +176,7 @@ LEFImporter::read_geometries (GeometryBasedLayoutGenerator *lg, double dbu, Laye
     } else if (test ("WIDTH")) {
 
       w = get_double ();
+      default_width = false;
       expect (";");
 
     } else if (test ("PATH")) {
@@ -190,6 +200,11 @@ LEFImporter::read_geometries (GeometryBasedLayoutGenerator *lg, double dbu, Laye
 
       if (lg) {
 
+        if (default_width && ! reader_state ()) {
+          //  without a reader state, the width may depend on LEF files read before
+          m_width_dependencies.insert (layer_name);
+        }
+
         db::Coord iw = db::coord_traits<db::Coord>::rounded (w / dbu);
         db::Path p (points.begin (), points.end (), iw, iw / 2, iw / 2, false);
 
@@ -536,6 +551,11 @@ LEFImporter::read_viadef_by_geometry (GeometryBasedLayoutGenerator *lg, ViaDesc
 
       layer_name = get ();
 
+      if (! reader_state () && m_routing_layers.find (layer_name) == m_routing_layers.end ()) {
+        //  without a reader state, the layer type may be defined by LEF files read before
+        m_routing_layer_dependencies.insert (layer_name);
+      }
+
       if (m_routing_layers.find (layer_name) != m_routing_layers.end ()) {
 
         if (routing_layers.size () == 0) {
@@ -645,11 +665,11 @@ LEFImporter::read_viadef (Layout &layout)
   if (test ("VIARULE")) {
     std::unique_ptr<RuleBasedViaGenerator> vg (new RuleBasedViaGenerator ());
     read_viadef_by_rule (vg.get (), via_desc, n, layout.dbu ());
-    reader_state ()->register_via_cell (n, vg.release ());
+    define_via (n, vg.release ());
   } else {
     std::unique_ptr<GeometryBasedLayoutGenerator> vg (new GeometryBasedLayoutGenerator ());
     read_viadef_by_geometry (vg.get (), via_desc, n, layout.dbu ());
-    reader_state ()->register_via_cell (n, vg.release ());
+    define_via (n, vg.release ());
   }
 
   test ("VIA");
@@ -664,7 +684,7 @@ LEFImporter::read_layer (Layout & /*layout*/)
   double w = 0.0, w_wrongdir = 0.0;
   bool is_horizontal = false;
 
-  register_layer (ln);
+  define_layer (ln);
 
   //  just extract the width from the layer - we need that as the default width for paths
   while (! at_end ()) {
@@ -810,7 +830,7 @@ LEFImporter::read_macro (Layout &layout)
   set_cellname (mn);
 
   GeometryBasedLayoutGenerator *mg = new GeometryBasedLayoutGenerator ();
-  reader_state ()->register_macro_cell (mn, mg);
+  define_macro (mn, mg);
 
   db::Trans foreign_trans;
   std::string foreign_name;
@@ -866,13 +886,11 @@ LEFImporter::read_macro (Layout &layout)
           }
           */
 
-          if (reader_state ()->tech_comp ()->produce_lef_pins ()) {
+          if (options ().produce_lef_pins ()) {
 
             db::properties_id_type prop_id = 0;
             if (produce_pin_props ()) {
-              db::PropertiesRepository::properties_set props;
-              props.insert (std::make_pair (pin_prop_name_id (), tl::Variant (label)));
-              prop_id = layout.properties_repository ().properties_id (props);
+              prop_id = pin_properties_id (layout, label);
             }
 
             std::map <std::string, db::Box> boxes_for_labels;
@@ -929,7 +947,7 @@ LEFImporter::read_macro (Layout &layout)
 
     } else if (test ("OBS")) {
 
-      if (reader_state ()->tech_comp ()->produce_obstructions ()) {
+      if (options ().produce_obstructions ()) {
         read_geometries (mg, layout.dbu (), Obstructions);
       } else {
         read_geometries (0, layout.dbu (), Obstructions);
@@ -1090,5 +1108,1128 @@ LEFImporter::finish_lef (db::Layout &layout)
   }
 }
 
+void
+LEFImporter::define_layer (const std::string &ln)
+{
+  if (reader_state ()) {
+    reader_state ()->register_layer (ln);
+  } else {
+    m_staged.push_back (StagedDefinition (StagedDefinition::Layer, ln, 0));
+  }
+}
+
+void
+LEFImporter::define_via (const std::string &vn, LEFDEFLayoutGenerator *generator)
+{
+  if (reader_state ()) {
+    reader_state ()->register_via_cell (vn, generator);
+  } else {
+    m_staged.push_back (StagedDefinition (StagedDefinition::Via, vn, generator));
+  }
+}
+
+void
+LEFImporter::define_macro (const std::string &mn, LEFDEFLayoutGenerator *generator)
+{
+  if (reader_state ()) {
+    reader_state ()->register_macro_cell (mn, generator);
+  } else {
+    m_staged.push_back (StagedDefinition (StagedDefinition::Macro, mn, generator));
+  }
+}
+
+db::properties_id_type
+LEFImporter::pin_properties_id (db::Layout &layout, const std::string &label)
+{
+  if (reader_state ()) {
+
+    db::PropertiesRepository::properties_set props;
+    props.insert (std::make_pair (pin_prop_name_id (), tl::Variant (label)));
+    return layout.properties_repository ().properties_id (props);
+
+  } else {
+
+    //  without a reader state, the properties IDs are indexes into the label list
+    //  (plus one). They are translated into real ones by "merge".
+    std::map<std::string, db::properties_id_type>::const_iterator i = m_staged_pin_prop_ids.find (label);
+    if (i != m_staged_pin_prop_ids.end ()) {
+      return i->second;
+    }
+
+    m_staged_pin_labels.push_back (label);
+    db::properties_id_type id = db::properties_id_type (m_staged_pin_labels.size ());
+    m_staged_pin_prop_ids.insert (std::make_pair (label, id));
+    return id;
+
+  }
+}
+
+void
+LEFImporter::clear_staged ()
+{
+  for (std::vector<StagedDefinition>::const_iterator d = m_staged.begin (); d != m_staged.end (); ++d) {
+    delete d->generator;
+  }
+
+  m_staged.clear ();
+  m_staged_pin_labels.clear ();
+  m_staged_pin_prop_ids.clear ();
+  m_width_dependencies.clear ();
+  m_routing_layer_dependencies.clear ();
+  m_staged_warnings.clear ();
+}
+
+bool
+LEFImporter::merge (LEFImporter &other, db::Layout &layout)
+{
+  //  The other importer has been reading without knowing the LEF files before. Its result is
+  //  only valid if none of its layer lookups would find something defined before.
+
+  for (std::set<std::string>::const_iterator l = other.m_width_dependencies.begin (); l != other.m_width_dependencies.end (); ++l) {
+    if (m_default_widths.find (*l) != m_default_widths.end ()) {
+      return false;
+    }
+  }
+
+  for (std::set<std::string>::const_iterator l = other.m_routing_layer_dependencies.begin (); l != other.m_routing_layer_dependencies.end (); ++l) {
+    if (m_routing_layers.find (*l) != m_routing_layers.end ()) {
+      return false;
+    }
+  }
+
+  //  duplicate macros will be reported when reading the file regularly
+  for (std::map<std::string, MacroDesc>::const_iterator m = other.m_macros.begin (); m != other.m_macros.end (); ++m) {
+    if (m_macros.find (m->first) != m_macros.end ()) {
+      return false;
+    }
+  }
+
+  for (std::vector<std::string>::const_iterator w = other.m_staged_warnings.begin (); w != other.m_staged_warnings.end (); ++w) {
+    tl::warn << *w;
+  }
+
+  //  merge the tables with the semantics of reading the files one after another
+
+  for (std::map<std::string, std::map<std::string, std::pair<double, double> > >::const_iterator r = other.m_nondefault_widths.begin (); r != other.m_nondefault_widths.end (); ++r) {
+    for (std::map<std::string, std::pair<double, double> >::const_iterator w = r->second.begin (); w != r->second.end (); ++w) {
+      m_nondefault_widths [r->first][w->first] = w->second;
+    }
+  }
+
+  m_default_widths.insert (other.m_default_widths.begin (), other.m_default_widths.end ());
+  m_default_ext.insert (other.m_default_ext.begin (), other.m_default_ext.end ());
+  m_min_widths.insert (other.m_min_widths.begin (), other.m_min_widths.end ());
+  m_routing_layers.insert (other.m_routing_layers.begin (), other.m_routing_layers.end ());
+  m_cut_layers.insert (other.m_cut_layers.begin (), other.m_cut_layers.end ());
+
+  for (std::map<std::string, unsigned int>::const_iterator nm = other.m_num_masks.begin (); nm != other.m_num_masks.end (); ++nm) {
+    m_num_masks [nm->first] = nm->second;
+  }
+
+  for (std::map<std::string, ViaDesc>::const_iterator v = other.m_vias.begin (); v != other.m_vias.end (); ++v) {
+    ViaDesc &vd = m_vias [v->first];
+    if (! v->second.m1.empty () || ! v->second.m2.empty ()) {
+      vd = v->second;
+    }
+  }
+
+  m_macros.insert (other.m_macros.begin (), other.m_macros.end ());
+
+  //  create the pin properties in the same order than reading the file would do
+
+  std::map<db::properties_id_type, db::properties_id_type> prop_id_map;
+  for (std::vector<std::string>::const_iterator l = other.m_staged_pin_labels.begin (); l != other.m_staged_pin_labels.end (); ++l) {
+    db::PropertiesRepository::properties_set props;
+    props.insert (std::make_pair (pin_prop_name_id (), tl::Variant (*l)));
+    prop_id_map.insert (std::make_pair (db::properties_id_type (l - other.m_staged_pin_labels.begin ()) + 1, layout.properties_repository ().properties_id (props)));
+  }
+
+  //  transfer the layers and generators
+
+  for (std::vector<StagedDefinition>::iterator d = other.m_staged.begin (); d != other.m_staged.end (); ++d) {
+
+    if (! prop_id_map.empty ()) {
+      GeometryBasedLayoutGenerator *gg = dynamic_cast<GeometryBasedLayoutGenerator *> (d->generator);
+      if (gg) {
+        gg->map_properties (prop_id_map);
+      }
+    }
+
+    if (d->kind == StagedDefinition::Layer) {
+      define_layer (d->name);
+    } else if (d->kind == StagedDefinition::Via) {
+      define_via (d->name, d->generator);
+    } else if (d->kind == StagedDefinition::Macro) {
+      define_macro (d->name, d->generator);
+    }
+
+    d->generator = 0;
+
+  }
+
+  other.clear_staged ();
+  return true;
+}
+
+// -----------------------------------------------------------------------------------
+//  LEF cache file
+
+//  The cache file layout is:
+//
+//    magic ("KLayout-LEF-cache\0"), version
+//    key: options, file name, size and hash of the LEF file's content
+//    warnings
+//    layer tables, via and macro descriptors, layer dependencies, pin labels
+//    staged definitions (layers, vias, macros) with their generators
+//
+//  Unsigned integers are stored as variable-length integers with 7 bits per byte,
+//  least significant group first. Signed integers are zig-zag encoded.
+//  Doubles are stored as their 8-byte IEEE representation, little endian.
+
+static const char cache_magic [] = "KLayout-LEF-cache";
+static const unsigned int cache_version = 1;
+
+static const unsigned char generator_none = 0;
+static const unsigned char generator_rule_based = 1;
+static const unsigned char generator_geometry_based = 2;
+
+static const unsigned char shape_type_box = 0;
+static const unsigned char shape_type_polygon = 1;
+static const unsigned char shape_type_path = 2;
+static const unsigned char shape_type_text = 3;
+
+namespace
+{
+
+class CacheWriter
+{
+public:
+  CacheWriter (tl::OutputStream &os)
+    : m_os (os)
+  {
+    //  .. nothing yet ..
+  }
+
+  void put_bytes (const char *b, size_t n)
+  {
+    m_os.put (b, n);
+  }
+
+  void put_byte (unsigned char b)
+  {
+    char c = char (b);
+    put_bytes (&c, 1);
+  }
+
+  void put_uint (uint64_t v)
+  {
+    do {
+      unsigned char b = (unsigned char) (v & 0x7f);
+      v >>= 7;
+      if (v) {
+        b |= 0x80;
+      }
+      put_byte (b);
+    } while (v);
+  }
+
+  void put_int (int64_t v)
+  {
+    put_uint (v < 0 ? ((uint64_t (-(v + 1)) << 1) | 1) : (uint64_t (v) << 1));
+  }
+
+  void put_double (double d)
+  {
+    uint64_t u = 0;
+    memcpy (&u, &d, sizeof (u));
+    char b [8];
+    for (unsigned int i = 0; i < 8; ++i) {
+      b [i] = char ((u >> (8 * i)) & 0xff);
+    }
+    put_bytes (b, 8);
+  }
+
+  void put_string (const std::string &s)
+  {
+    put_uint (s.size ());
+    put_bytes (s.c_str (), s.size ());
+  }
+
+  void put_point (const db::Point &p)
+  {
+    put_int (p.x ());
+    put_int (p.y ());
+  }
+
+  void put_trans (const db::Trans &t)
+  {
+    put_uint ((unsigned int) t.rot ());
+    put_int (t.disp ().x ());
+    put_int (t.disp ().y ());
+  }
+
+  void put_box (const db::Box &b)
+  {
+    put_byte (b.empty () ? 1 : 0);
+    if (! b.empty ()) {
+      put_point (b.p1 ());
+      put_point (b.p2 ());
+    }
+  }
+
+private:
+  tl::OutputStream &m_os;
+};
+
+class CacheReader
+{
+public:
+  CacheReader (tl::InputStream &is)
+    : m_is (is)
+  {
+    //  .. nothing yet ..
+  }
+
+  const char *get_bytes (size_t n)
+  {
+    const char *b = m_is.get (n);
+    if (! b) {
+      throw tl::Exception (tl::to_string (tr ("Unexpected end of file in LEF cache file")));
+    }
+    return b;
+  }
+
+  unsigned char get_byte ()
+  {
+    return (unsigned char) *get_bytes (1);
+  }
+
+  uint64_t get_uint ()
+  {
+    uint64_t v = 0;
+    unsigned int s = 0;
+    unsigned char b;
+    do {
+      if (s > 63) {
+        throw tl::Exception (tl::to_string (tr ("Integer overflow in LEF cache file")));
+      }
+      b = get_byte ();
+      v |= uint64_t (b & 0x7f) << s;
+      s += 7;
+    } while ((b & 0x80) != 0);
+    return v;
+  }
+
+  size_t get_size ()
+  {
+    return size_t (get_uint ());
+  }
+
+  int64_t get_int ()
+  {
+    uint64_t u = get_uint ();
+    if ((u & 1) != 0) {
+      return -int64_t (u >> 1) - 1;
+    } else {
+      return int64_t (u >> 1);
+    }
+  }
+
+  db::Coord get_coord ()
+  {
+    return db::Coord (get_int ());
+  }
+
+  double get_double ()
+  {
+    const char *b = get_bytes (8);
+    uint64_t u = 0;
+    for (unsigned int i = 0; i < 8; ++i) {
+      u |= uint64_t ((unsigned char) b [i]) << (8 * i);
+    }
+    double d = 0.0;
+    memcpy (&d, &u, sizeof (d));
+    return d;
+  }
+
+  std::string get_string ()
+  {
+    size_t n = get_size ();
+    if (n == 0) {
+      return std::string ();
+    }
+    const char *b = get_bytes (n);
+    return std::string (b, n);
+  }
+
+  db::Point get_point ()
+  {
+    db::Coord x = get_coord ();
+    db::Coord y = get_coord ();
+    return db::Point (x, y);
+  }
+
+  db::Trans get_trans ()
+  {
+    int f = int (get_uint ());
+    db::Coord x = get_coord ();
+    db::Coord y = get_coord ();
+    return db::Trans (f, db::Vector (x, y));
+  }
+
+  db::Box get_box ()
+  {
+    if (get_byte () != 0) {
+      return db::Box ();
+    }
+    db::Point p1 = get_point ();
+    db::Point p2 = get_point ();
+    return db::Box (p1, p2);
+  }
+
+private:
+  tl::InputStream &m_is;
+};
+
+}
+
+static void
+write_string_set (CacheWriter &w, const std::set<std::string> &strings)
+{
+  w.put_uint (strings.size ());
+  for (std::set<std::string>::const_iterator s = strings.begin (); s != strings.end (); ++s) {
+    w.put_string (*s);
+  }
+}
+
+static void
+read_string_set (CacheReader &r, std::set<std::string> &strings)
+{
+  strings.clear ();
+  for (size_t n = r.get_size (); n > 0; --n) {
+    strings.insert (r.get_string ());
+  }
+}
+
+static void
+write_widths (CacheWriter &w, const std::map<std::string, std::pair<double, double> > &widths)
+{
+  w.put_uint (widths.size ());
+  for (std::map<std::string, std::pair<double, double> >::const_iterator i = widths.begin (); i != widths.end (); ++i) {
+    w.put_string (i->first);
+    w.put_double (i->second.first);
+    w.put_double (i->second.second);
+  }
+}
+
+static void
+read_widths (CacheReader &r, std::map<std::string, std::pair<double, double> > &widths)
+{
+  widths.clear ();
+  for (size_t n = r.get_size (); n > 0; --n) {
+    std::string name = r.get_string ();
+    double w1 = r.get_double ();
+    double w2 = r.get_double ();
+    widths.insert (std::make_pair (name, std::make_pair (w1, w2)));
+  }
+}
+
+static void
+write_shapes (CacheWriter &w, const db::Shapes &shapes)
+{
+  w.put_uint (shapes.size ());
+
+  for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+
+    if (s->is_box ()) {
+
+      w.put_byte (shape_type_box);
+      w.put_uint (s->prop_id ());
+      w.put_box (s->box ());
+
+    } else if (s->is_polygon ()) {
+
+      db::Polygon poly;
+      s->polygon (poly);
+
+      w.put_byte (shape_type_polygon);
+      w.put_uint (s->prop_id ());
+      w.put_uint (poly.holes () + 1);
+      for (unsigned int c = 0; c < poly.holes () + 1; ++c) {
+        const db::Polygon::contour_type &ctr = poly.contour (c);
+        w.put_uint (ctr.size ());
+        for (size_t i = 0; i < ctr.size (); ++i) {
+          w.put_point (ctr [i]);
+        }
+      }
+
+    } else if (s->is_path ()) {
+
+      db::Path path;
+      s->path (path);
+
+      w.put_byte (shape_type_path);
+      w.put_uint (s->prop_id ());
+      w.put_int (path.width ());
+      w.put_int (path.bgn_ext ());
+      w.put_int (path.end_ext ());
+      w.put_byte (path.round () ? 1 : 0);
+      w.put_uint (path.points ());
+      for (db::Path::iterator p = path.begin (); p != path.end (); ++p) {
+        w.put_point (*p);
+      }
+
+    } else if (s->is_text ()) {
+
+      db::Text text;
+      s->text (text);
+
+      w.put_byte (shape_type_text);
+      w.put_uint (s->prop_id ());
+      w.put_string (text.string ());
+      w.put_trans (text.trans ());
+      w.put_int (text.size ());
+      w.put_int (int (text.font ()));
+      w.put_int (int (text.halign ()));
+      w.put_int (int (text.valign ()));
+
+    } else {
+      throw tl::Exception (tl::to_string (tr ("Unexpected shape type in LEF cache file")));
+    }
+
+  }
+}
+
+template <class Shape>
+static void
+insert_cached_shape (db::Shapes &shapes, const Shape &shape, db::properties_id_type prop_id)
+{
+  if (prop_id == 0) {
+    shapes.insert (shape);
+  } else {
+    shapes.insert (db::object_with_properties<Shape> (shape, prop_id));
+  }
+}
+
+static void
+read_shapes (CacheReader &r, db::Shapes &shapes)
+{
+  for (size_t n = r.get_size (); n > 0; --n) {
+
+    unsigned char type = r.get_byte ();
+    db::properties_id_type prop_id = db::properties_id_type (r.get_uint ());
+
+    if (type == shape_type_box) {
+
+      insert_cached_shape (shapes, r.get_box (), prop_id);
+
+    } else if (type == shape_type_polygon) {
+
+      db::Polygon poly;
+      std::vector<db::Point> pts;
+
+      size_t nc = r.get_size ();
+      for (size_t c = 0; c < nc; ++c) {
+        pts.clear ();
+        for (size_t np = r.get_size (); np > 0; --np) {
+          pts.push_back (r.get_point ());
+        }
+        if (c == 0) {
+          poly.assign_hull (pts.begin (), pts.end (), false);
+        } else {
+          poly.insert_hole (pts.begin (), pts.end (), false);
+        }
+      }
+
+      insert_cached_shape (shapes, poly, prop_id);
+
+    } else if (type == shape_type_path) {
+
+      db::Coord width = r.get_coord ();
+      db::Coord bgn_ext = r.get_coord ();
+      db::Coord end_ext = r.get_coord ();
+      bool round = r.get_byte () != 0;
+
+      std::vector<db::Point> pts;
+      for (size_t np = r.get_size (); np > 0; --np) {
+        pts.push_back (r.get_point ());
+      }
+
+      insert_cached_shape (shapes, db::Path (pts.begin (), pts.end (), width, bgn_ext, end_ext, round), prop_id);
+
+    } else if (type == shape_type_text) {
+
+      std::string string = r.get_string ();
+      db::Trans trans = r.get_trans ();
+      db::Coord size = r.get_coord ();
+      db::Font font = db::Font (r.get_int ());
+      db::HAlign halign = db::HAlign (r.get_int ());
+      db::VAlign valign = db::VAlign (r.get_int ());
+
+      insert_cached_shape (shapes, db::Text (string, trans, size, font, halign, valign), prop_id);
+
+    } else {
+      throw tl::Exception (tl::to_string (tr ("Invalid shape type in LEF cache file")));
+    }
+
+  }
+}
+
+static void
+write_generator (CacheWriter &w, const LEFDEFLayoutGenerator *generator)
+{
+  const RuleBasedViaGenerator *rg = dynamic_cast<const RuleBasedViaGenerator *> (generator);
+  const GeometryBasedLayoutGenerator *gg = dynamic_cast<const GeometryBasedLayoutGenerator *> (generator);
+
+  if (rg) {
+
+    w.put_byte (generator_rule_based);
+    w.put_string (rg->bottom_layer ());
+    w.put_string (rg->cut_layer ());
+    w.put_string (rg->top_layer ());
+    w.put_uint (rg->bottom_mask ());
+    w.put_uint (rg->cut_mask ());
+    w.put_uint (rg->top_mask ());
+    w.put_point (db::Point () + rg->cutsize ());
+    w.put_point (db::Point () + rg->cutspacing ());
+    w.put_point (db::Point () + rg->be ());
+    w.put_point (db::Point () + rg->te ());
+    w.put_point (db::Point () + rg->bo ());
+    w.put_point (db::Point () + rg->to ());
+    w.put_point (rg->offset ());
+    w.put_int (rg->rows ());
+    w.put_int (rg->columns ());
+    w.put_string (rg->pattern ());
+
+  } else if (gg) {
+
+    w.put_byte (generator_geometry_based);
+    w.put_byte (gg->is_fixedmask () ? 1 : 0);
+
+    std::vector<std::string> msl = gg->maskshift_layers ();
+    w.put_uint (msl.size ());
+    for (std::vector<std::string>::const_iterator l = msl.begin (); l != msl.end (); ++l) {
+      w.put_string (*l);
+    }
+
+    w.put_uint (gg->shapes ().size ());
+    for (GeometryBasedLayoutGenerator::shapes_map::const_iterator s = gg->shapes ().begin (); s != gg->shapes ().end (); ++s) {
+      w.put_string (s->first.first);
+      w.put_uint ((unsigned int) s->first.second.first);
+      w.put_uint (s->first.second.second);
+      write_shapes (w, s->second);
+    }
+
+    w.put_uint (gg->vias ().size ());
+    for (std::list<GeometryBasedLayoutGenerator::Via>::const_iterator v = gg->vias ().begin (); v != gg->vias ().end (); ++v) {
+      w.put_string (v->name);
+      w.put_trans (v->trans);
+      w.put_uint (v->bottom_mask);
+      w.put_uint (v->cut_mask);
+      w.put_uint (v->top_mask);
+    }
+
+  } else {
+    w.put_byte (generator_none);
+  }
+}
+
+static LEFDEFLayoutGenerator *
+read_generator (CacheReader &r)
+{
+  unsigned char type = r.get_byte ();
+
+  if (type == generator_rule_based) {
+
+    std::unique_ptr<RuleBasedViaGenerator> rg (new RuleBasedViaGenerator ());
+    rg->set_bottom_layer (r.get_string ());
+    rg->set_cut_layer (r.get_string ());
+    rg->set_top_layer (r.get_string ());
+    rg->set_bottom_mask ((unsigned int) r.get_uint ());
+    rg->set_cut_mask ((unsigned int) r.get_uint ());
+    rg->set_top_mask ((unsigned int) r.get_uint ());
+    rg->set_cutsize (r.get_point () - db::Point ());
+    rg->set_cutspacing (r.get_point () - db::Point ());
+    rg->set_be (r.get_point () - db::Point ());
+    rg->set_te (r.get_point () - db::Point ());
+    rg->set_bo (r.get_point () - db::Point ());
+    rg->set_to (r.get_point () - db::Point ());
+    rg->set_offset (r.get_point ());
+    rg->set_rows (int (r.get_int ()));
+    rg->set_columns (int (r.get_int ()));
+    rg->set_pattern (r.get_string ());
+    return rg.release ();
+
+  } else if (type == generator_geometry_based) {
+
+    std::unique_ptr<GeometryBasedLayoutGenerator> gg (new GeometryBasedLayoutGenerator ());
+    gg->set_fixedmask (r.get_byte () != 0);
+
+    std::vector<std::string> msl;
+    for (size_t n = r.get_size (); n > 0; --n) {
+      msl.push_back (r.get_string ());
+    }
+    gg->set_maskshift_layers (msl);
+
+    for (size_t n = r.get_size (); n > 0; --n) {
+      std::string ln = r.get_string ();
+      LayerPurpose purpose = LayerPurpose (r.get_uint ());
+      unsigned int mask = (unsigned int) r.get_uint ();
+      read_shapes (r, gg->shapes (ln, purpose, mask));
+    }
+
+    for (size_t n = r.get_size (); n > 0; --n) {
+      std::string vn = r.get_string ();
+      db::Trans trans = r.get_trans ();
+      unsigned int bottom_mask = (unsigned int) r.get_uint ();
+      unsigned int cut_mask = (unsigned int) r.get_uint ();
+      unsigned int top_mask = (unsigned int) r.get_uint ();
+      gg->add_via (vn, trans, bottom_mask, cut_mask, top_mask);
+    }
+
+    return gg.release ();
+
+  } else if (type == generator_none) {
+    return 0;
+  } else {
+    throw tl::Exception (tl::to_string (tr ("Invalid generator type in LEF cache file")));
+  }
+}
+
+void
+LEFImporter::write_cache (tl::OutputStream &os, const std::string &key) const
+{
+  CacheWriter w (os);
+
+  w.put_bytes (cache_magic, sizeof (cache_magic));
+  w.put_uint (cache_version);
+  w.put_string (key);
+
+  w.put_uint (m_staged_warnings.size ());
+  for (std::vector<std::string>::const_iterator i = m_staged_warnings.begin (); i != m_staged_warnings.end (); ++i) {
+    w.put_string (*i);
+  }
+
+  w.put_uint (m_nondefault_widths.size ());
+  for (std::map<std::string, std::map<std::string, std::pair<double, double> > >::const_iterator i = m_nondefault_widths.begin (); i != m_nondefault_widths.end (); ++i) {
+    w.put_string (i->first);
+    write_widths (w, i->second);
+  }
+
+  write_widths (w, m_default_widths);
+  write_widths (w, m_min_widths);
+
+  w.put_uint (m_default_ext.size ());
+  for (std::map<std::string, double>::const_iterator i = m_default_ext.begin (); i != m_default_ext.end (); ++i) {
+    w.put_string (i->first);
+    w.put_double (i->second);
+  }
+
+  write_string_set (w, m_routing_layers);
+  write_string_set (w, m_cut_layers);
+
+  w.put_uint (m_num_masks.size ());
+  for (std::map<std::string, unsigned int>::const_iterator i = m_num_masks.begin (); i != m_num_masks.end (); ++i) {
+    w.put_string (i->first);
+    w.put_uint (i->second);
+  }
+
+  w.put_uint (m_vias.size ());
+  for (std::map<std::string, ViaDesc>::const_iterator i = m_vias.begin (); i != m_vias.end (); ++i) {
+    w.put_string (i->first);
+    w.put_string (i->second.m1);
+    w.put_string (i->second.m2);
+  }
+
+  w.put_uint (m_macros.size ());
+  for (std::map<std::string, MacroDesc>::const_iterator i = m_macros.begin (); i != m_macros.end (); ++i) {
+    w.put_string (i->first);
+    w.put_string (i->second.foreign_name);
+    w.put_trans (i->second.foreign_trans);
+    w.put_point (i->second.origin);
+    w.put_box (i->second.bbox);
+  }
+
+  write_string_set (w, m_width_dependencies);
+  write_string_set (w, m_routing_layer_dependencies);
+
+  w.put_uint (m_staged_pin_labels.size ());
+  for (std::vector<std::string>::const_iterator i = m_staged_pin_labels.begin (); i != m_staged_pin_labels.end (); ++i) {
+    w.put_string (*i);
+  }
+
+  w.put_uint (m_staged.size ());
+  for (std::vector<StagedDefinition>::const_iterator i = m_staged.begin (); i != m_staged.end (); ++i) {
+    w.put_byte ((unsigned char) i->kind);
+    w.put_string (i->name);
+    write_generator (w, i->generator);
+  }
+}
+
+bool
+LEFImporter::read_cache (tl::InputStream &is, const std::string &key)
+{
+  CacheReader r (is);
+
+  if (memcmp (r.get_bytes (sizeof (cache_magic)), cache_magic, sizeof (cache_magic)) != 0) {
+    return false;
+  }
+  if (r.get_uint () != cache_version) {
+    return false;
+  }
+  if (r.get_string () != key) {
+    return false;
+  }
+
+  for (size_t n = r.get_size (); n > 0; --n) {
+    m_staged_warnings.push_back (r.get_string ());
+  }
+
+  for (size_t n = r.get_size (); n > 0; --n) {
+    std::string rule = r.get_string ();
+    read_widths (r, m_nondefault_widths [rule]);
+  }
+
+  read_widths (r, m_default_widths);
+  read_widths (r, m_min_widths);
+
+  for (size_t n = r.get_size (); n > 0; --n) {
+    std::string ln = r.get_string ();
+    m_default_ext [ln] = r.get_double ();
+  }
+
+  read_string_set (r, m_routing_layers);
+  read_string_set (r, m_cut_layers);
+
+  for (size_t n = r.get_size (); n > 0; --n) {
+    std::string ln = r.get_string ();
+    m_num_masks [ln] = (unsigned int) r.get_uint ();
+  }
+
+  for (size_t n = r.get_size (); n > 0; --n) {
+    std::string vn = r.get_string ();
+    ViaDesc &vd = m_vias [vn];
+    vd.m1 = r.get_string ();
+    vd.m2 = r.get_string ();
+  }
+
+  for (size_t n = r.get_size (); n > 0; --n) {
+    std::string mn = r.get_string ();
+    MacroDesc &md = m_macros [mn];
+    md.foreign_name = r.get_string ();
+    md.foreign_trans = r.get_trans ();
+    md.origin = r.get_point ();
+    md.bbox = r.get_box ();
+  }
+
+  read_string_set (r, m_width_dependencies);
+  read_string_set (r, m_routing_layer_dependencies);
+
+  for (size_t n = r.get_size (); n > 0; --n) {
+    m_staged_pin_labels.push_back (r.get_string ());
+    m_staged_pin_prop_ids.insert (std::make_pair (m_staged_pin_labels.back (), db::properties_id_type (m_staged_pin_labels.size ())));
+  }
+
+  for (size_t n = r.get_size (); n > 0; --n) {
+    unsigned char kind = r.get_byte ();
+    if (kind > (unsigned char) StagedDefinition::Macro) {
+      throw tl::Exception (tl::to_string (tr ("Invalid definition type in LEF cache file")));
+    }
+    std::string name = r.get_string ();
+    m_staged.push_back (StagedDefinition (StagedDefinition::Kind (kind), name, 0));
+    m_staged.back ().generator = read_generator (r);
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------------
+//  Reading multiple LEF files
+
+/**
+ *  @brief Computes a 64 bit FNV-1a hash of the given string
+ */
+static uint64_t
+fnv_hash (const std::string &s)
+{
+  uint64_t h = 14695981039346656037ull;
+  for (std::string::const_iterator c = s.begin (); c != s.end (); ++c) {
+    h ^= uint64_t ((unsigned char) *c);
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+static std::string
+hash_string (uint64_t h)
+{
+  char b [17];
+  for (unsigned int i = 0; i < 16; ++i) {
+    b [15 - i] = "0123456789abcdef" [(h >> (4 * i)) & 0xf];
+  }
+  b [16] = 0;
+  return std::string (b);
+}
+
+void
+LEFImporter::read_file_detached (const std::string &path, db::Layout &layout, const LEFDEFReaderOptions &options, bool &from_cache)
+{
+  from_cache = false;
+
+  tl::InputStream stream (path);
+  std::string fn = stream.filename ();
+  std::string content = stream.read_all ();
+
+  //  the key includes everything the parsed representation depends on
+  std::string key;
+  key += "dbu=" + tl::to_string (layout.dbu ());
+  key += ",lef-pins=" + tl::to_string (options.produce_lef_pins ());
+  key += ",obstructions=" + tl::to_string (options.produce_obstructions ());
+  key += ",pin-names=" + tl::to_string (options.produce_pin_names ());
+  key += ",macro-resolution-mode=" + tl::to_string (options.macro_resolution_mode ());
+  key += ",file=" + fn;
+  key += ",size=" + tl::to_string (content.size ());
+  key += ",hash=" + hash_string (fnv_hash (content));
+
+  std::string cache_file, cache_error;
+  if (! options.lef_cache_path ().empty ()) {
+
+    cache_file = tl::combine_path (options.lef_cache_path (), "lef-" + hash_string (fnv_hash (key)) + ".cache");
+
+    if (tl::file_exists (cache_file)) {
+
+      try {
+        tl::InputStream cache_stream (cache_file);
+        if (read_cache (cache_stream, key)) {
+          from_cache = true;
+          return;
+        }
+      } catch (tl::Exception &ex) {
+        cache_error = ex.msg ();
+      }
+
+      clear_staged ();
+      m_nondefault_widths.clear ();
+      m_default_widths.clear ();
+      m_default_ext.clear ();
+      m_min_widths.clear ();
+      m_macros.clear ();
+      m_vias.clear ();
+      m_routing_layers.clear ();
+      m_cut_layers.clear ();
+      m_num_masks.clear ();
+
+    }
+
+  }
+
+  tl::InputMemoryStream memory_stream (content.c_str (), content.size ());
+  tl::InputStream lef_stream (memory_stream);
+  read_detached (lef_stream, fn, layout, options, &m_staged_warnings);
+
+  if (! cache_file.empty ()) {
+
+    //  write to a temporary file first, so other readers never see an incomplete file
+    std::string tmp_file = cache_file + ".tmp";
+
+    try {
+      {
+        tl::OutputStream os (tmp_file);
+        write_cache (os, key);
+      }
+      tl::rm_file (cache_file);
+      tl::rename_file (tmp_file, cache_file);
+    } catch (tl::Exception &ex) {
+      m_staged_warnings.push_back (tl::to_string (tr ("Unable to write LEF cache file ")) + cache_file + ": " + ex.msg ());
+      tl::rm_file (tmp_file);
+    }
+
+  }
+
+  //  NOTE: the warnings are issued by "merge" in the main thread. This one is not stored in the cache file.
+  if (! cache_error.empty ()) {
+    m_staged_warnings.push_back (tl::to_string (tr ("Ignoring invalid LEF cache file ")) + cache_file + ": " + cache_error);
+  }
+}
+
+/**
+ *  @brief A LEF file read without a reader state
+ */
+class LEFImporterFile
+{
+public:
+  LEFImporterFile (const std::string &path, double dbu, const LEFDEFReaderOptions &options)
+    : m_path (path), mp_options (&options), m_from_cache (false)
+  {
+    m_layout.dbu (dbu);
+  }
+
+  void read ()
+  {
+    try {
+      m_importer.read_file_detached (m_path, m_layout, *mp_options, m_from_cache);
+    } catch (tl::Exception &ex) {
+      m_error = ex.msg ();
+    }
+  }
+
+  const std::string &path () const
+  {
+    return m_path;
+  }
+
+  LEFImporter &importer ()
+  {
+    return m_importer;
+  }
+
+  bool from_cache () const
+  {
+    return m_from_cache;
+  }
+
+  bool has_error () const
+  {
+    return ! m_error.empty ();
+  }
+
+private:
+  std::string m_path;
+  const LEFDEFReaderOptions *mp_options;
+  db::Layout m_layout;
+  LEFImporter m_importer;
+  bool m_from_cache;
+  std::string m_error;
+
+  //  no copying
+  LEFImporterFile (const LEFImporterFile &);
+  LEFImporterFile &operator= (const LEFImporterFile &);
+};
+
+class LEFImporterFileTask
+  : public tl::Task
+{
+public:
+  LEFImporterFileTask (LEFImporterFile *file)
+    : mp_file (file)
+  { }
+
+  void perform ()
+  {
+    mp_file->read ();
+  }
+
+private:
+  LEFImporterFile *mp_file;
+};
+
+class LEFImporterFileWorker
+  : public tl::Worker
+{
+public:
+  LEFImporterFileWorker ()
+    : tl::Worker ()
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<LEFImporterFileTask *> (task)->perform ();
+  }
+};
+
+void
+LEFImporter::read_files (const std::vector<std::string> &paths, db::Layout &layout, LEFDEFReaderState &state)
+{
+  if (paths.empty ()) {
+    return;
+  }
+
+  const LEFDEFReaderOptions *options = state.tech_comp ();
+  tl_assert (options != 0);
+
+  unsigned int threads = options->threads ();
+
+  if (threads == 0 && options->lef_cache_path ().empty ()) {
+
+    for (std::vector<std::string>::const_iterator p = paths.begin (); p != paths.end (); ++p) {
+      tl::InputStream lef_stream (*p);
+      tl::log << tl::to_string (tr ("Reading")) << " " << *p;
+      read (lef_stream, layout, state);
+    }
+
+    return;
+
+  }
+
+  if (! options->lef_cache_path ().empty () && ! tl::file_exists (options->lef_cache_path ())) {
+    tl::mkpath (options->lef_cache_path ());
+  }
+
+  //  The files are parsed independently. The results are merged in the original order, so
+  //  layers, cells and properties are created in the same order than when reading the files
+  //  one by one.
+
+  std::vector<LEFImporterFile *> files;
+  files.reserve (paths.size ());
+
+  try {
+
+    for (std::vector<std::string>::const_iterator p = paths.begin (); p != paths.end (); ++p) {
+      files.push_back (new LEFImporterFile (*p, layout.dbu (), *options));
+    }
+
+    if (threads == 0 || files.size () == 1) {
+
+      for (std::vector<LEFImporterFile *>::const_iterator f = files.begin (); f != files.end (); ++f) {
+        (*f)->read ();
+      }
+
+    } else {
+
+      tl::Job<LEFImporterFileWorker> job (int (std::min (size_t (threads), files.size ())));
+      for (std::vector<LEFImporterFile *>::const_iterator f = files.begin (); f != files.end (); ++f) {
+        job.schedule (new LEFImporterFileTask (*f));
+      }
+
+      job.start ();
+      job.wait ();
+
+      if (job.has_error ()) {
+        throw tl::Exception (job.error_messages ().front ());
+      }
+
+    }
+
+    tl::RelativeProgress progress (tl::to_string (tr ("Reading LEF files")), files.size (), 1);
+
+    //  the reader state and the property names are needed for merging
+    attach (layout, state);
+
+    for (std::vector<LEFImporterFile *>::iterator f = files.begin (); f != files.end (); ++f) {
+
+      ++progress;
+
+      if (! (*f)->has_error () && merge ((*f)->importer (), layout)) {
+        tl::log << tl::to_string (tr ("Reading")) << " " << (*f)->path () << ((*f)->from_cache () ? tl::to_string (tr (" (from cache)")) : std::string ());
+      } else {
+        //  files which failed or depend on the ones before are read the regular way
+        tl::InputStream lef_stream ((*f)->path ());
+        tl::log << tl::to_string (tr ("Reading")) << " " << (*f)->path ();
+        read (lef_stream, layout, state);
+      }
+
+      delete *f;
+      *f = 0;
+
+    }
+
+  } catch (...) {
+    for (std::vector<LEFImporterFile *>::const_iterator f = files.begin (); f != files.end (); ++f) {
+      delete *f;
+    }
+    throw;
+  }
+}
+
 }
 
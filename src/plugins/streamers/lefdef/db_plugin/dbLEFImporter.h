@@ -36,10 +36,13 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
 
 namespace db
 {
 
+class LEFImporterFile;
+
 /**
  *  @brief The LEF importer object
  */
@@ -131,10 +134,44 @@ public:
    */
   void finish_lef (db::Layout &layout);
 
+  /**
+   *  @brief Reads a set of LEF files
+   *
+   *  The effect is the same than reading the files one by one in the given order. The files
+   *  are parsed in multiple threads if the reader options ask for this. If the options specify
+   *  a LEF cache path, the parsed files are stored there and are taken from there
+   *  instead of parsing the files again.
+   */
+  void read_files (const std::vector<std::string> &paths, db::Layout &layout, LEFDEFReaderState &state);
+
 protected:
   void do_read (db::Layout &layout);
 
 private:
+  friend class LEFImporterFile;
+
+  /**
+   *  @brief A layer, via or macro definition made while reading without a reader state
+   */
+  struct StagedDefinition
+  {
+    enum Kind { Layer, Via, Macro };
+
+    StagedDefinition (Kind k, const std::string &n, LEFDEFLayoutGenerator *g)
+      : kind (k), name (n), generator (g)
+    { }
+
+    Kind kind;
+    std::string name;
+    LEFDEFLayoutGenerator *generator;
+  };
+
+  std::vector<StagedDefinition> m_staged;
+  std::vector<std::string> m_staged_pin_labels;
+  std::map<std::string, db::properties_id_type> m_staged_pin_prop_ids;
+  std::set<std::string> m_width_dependencies, m_routing_layer_dependencies;
+  std::vector<std::string> m_staged_warnings;
+
   std::map<std::string, std::map<std::string, std::pair<double, double> > > m_nondefault_widths;
   std::map<std::string, std::pair<double, double> > m_default_widths;
   std::map<std::string, double> m_default_ext;
@@ -152,6 +189,16 @@ private:
   void read_viadef_by_geometry (GeometryBasedLayoutGenerator *lg, ViaDesc &desc, const std::string &n, double dbu);
   void read_layer (Layout &layout);
   void read_macro (Layout &layout);
+
+  void define_layer (const std::string &ln);
+  void define_via (const std::string &vn, LEFDEFLayoutGenerator *generator);
+  void define_macro (const std::string &mn, LEFDEFLayoutGenerator *generator);
+  db::properties_id_type pin_properties_id (db::Layout &layout, const std::string &label);
+  void clear_staged ();
+  void read_file_detached (const std::string &path, db::Layout &layout, const LEFDEFReaderOptions &options, bool &from_cache);
+  bool merge (LEFImporter &other, db::Layout &layout);
+  void write_cache (tl::OutputStream &os, const std::string &key) const;
+  bool read_cache (tl::InputStream &is, const std::string &key);
 };
 
 }
@@ -834,6 +834,35 @@ gsi::Class<db::LEFDEFReaderOptions> decl_lefdef_config ("db", "LEFDEFReaderConfi
     "See \\read_lef_with_def for details about this property.\n"
     "\n"
     "This property has been added in version 0.27.\n"
+  ) +
+  gsi::method ("threads", &db::LEFDEFReaderOptions::threads,
+    "@brief Gets the number of threads to use for reading DEF files.\n"
+    "With a value larger than 0, the COMPONENTS, NETS and SPECIALNETS sections of DEF files are parsed in the given number "
+    "of threads. The LEF files are parsed in parallel too. Layers, cells and properties are still created in the calling thread and in file order, so the result "
+    "is the same as with single-threaded reading. With 0 threads (the default), these sections and files are parsed in the calling thread.\n"
+    "\n"
+    "This property has been added in version 0.27.\n"
+  ) +
+  gsi::method ("threads=", &db::LEFDEFReaderOptions::set_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads to use for reading DEF files.\n"
+    "See \\threads for details about this property.\n"
+    "\n"
+    "This property has been added in version 0.27.\n"
+  ) +
+  gsi::method ("lef_cache_path", &db::LEFDEFReaderOptions::lef_cache_path,
+    "@brief Gets the directory where parsed LEF files are cached.\n"
+    "If this path is set, the reader stores the parsed LEF files in this directory. When a LEF file with the same content "
+    "is read again with the same options - in the same or in a later session - the parsed representation is taken from the cache "
+    "and the LEF file is not parsed again. The cache files are named after a hash of the content and the relevant options. "
+    "The directory is created if it does not exist. An empty path (the default) disables the cache.\n"
+    "\n"
+    "This property has been added in version 0.27.\n"
+  ) +
+  gsi::method ("lef_cache_path=", &db::LEFDEFReaderOptions::set_lef_cache_path, gsi::arg ("path"),
+    "@brief Sets the directory where parsed LEF files are cached.\n"
+    "See \\lef_cache_path for details about this property.\n"
+    "\n"
+    "This property has been added in version 0.27.\n"
   ),
   "@brief Detailed LEF/DEF reader options\n"
   "This class is a aggregate belonging to the \\LoadLayoutOptions class. It provides options for the LEF/DEF reader. "
@@ -27,6 +27,8 @@
 #include "dbLEFImporter.h"
 
 #include "tlUnitTest.h"
+#include "tlTimer.h"
+#include "tlFileUtils.h"
 #include "dbTestSupport.h"
 
 #include <cstdlib>
@@ -752,6 +754,318 @@ TEST(119_multimapping)
   )
 }
 
+TEST(120_threads)
+{
+  db::LEFDEFReaderOptions options = default_options ();
+  options.set_threads (4);
+
+  run_test (_this, "specialnets_geo", "lef:test.lef+def:test.def", "au.oas.gz", options, false);
+  run_test (_this, "wrongdirection", "lef:test.lef+def:test.def", "au.oas.gz", options, false);
+  run_test (_this, "scanchain", "def:test.def", "au.oas.gz", options, false);
+
+  options.set_map_file ("in.map");
+  run_test (_this, "masks-2", "lef:in_tech.lef+lef:in.lef+def:in.def", "au.oas.gz", options, false);
+}
+
+static void read_big_def (db::Layout &layout, const std::string &def_file, unsigned int threads)
+{
+  std::string lef_path = tl::testsrc () + "/testdata/lefdef/masks-2/";
+
+  db::LEFDEFReaderOptions options = default_options ();
+  options.set_threads (threads);
+
+  db::LEFDEFReaderState ld (&options, layout, lef_path);
+  db::DEFImporter imp;
+
+  {
+    tl::InputStream stream (lef_path + "in_tech.lef");
+    imp.read_lef (stream, layout, ld);
+  }
+  {
+    tl::InputStream stream (lef_path + "in.lef");
+    imp.read_lef (stream, layout, ld);
+  }
+  {
+    tl::InputStream stream (def_file);
+    imp.read (stream, layout, ld);
+  }
+
+  ld.finish (layout);
+}
+
+static std::string read_big_def_error (const std::string &def_file, unsigned int threads)
+{
+  try {
+    db::Layout layout;
+    read_big_def (layout, def_file, threads);
+    return std::string ();
+  } catch (tl::Exception &ex) {
+    return ex.msg ();
+  }
+}
+
+//  a DEF file big enough for a couple of chunks in multi-threaded mode
+TEST(121_threads_big)
+{
+  const int n = 20000;
+  const char *macros[] = { "mask_macro", "nomask_macro", "fixedmask_macro" };
+  const char *orient[] = { "N", "S", "FN", "E" };
+
+  std::string def_file = tmp_file ("big.def");
+  std::string def_file_with_error = tmp_file ("big_with_error.def");
+
+  for (int with_error = 0; with_error < 2; ++with_error) {
+
+    tl::OutputStream os (with_error ? def_file_with_error : def_file);
+
+    os << "VERSION 5.8 ;\nDIVIDERCHAR \"/\" ;\nBUSBITCHARS \"[]\" ;\nDESIGN big ;\nUNITS DISTANCE MICRONS 1000 ;\n";
+    os << "DIEAREA ( 0 0 ) ( 1000000 1000000 ) ;\n";
+    os << "COMPONENTMASKSHIFT M2 M1 M0PO ;\n";
+
+    os << "COMPONENTS " << tl::to_string (n) << " ;\n";
+    for (int i = 0; i < n; ++i) {
+      os << "- c" << tl::to_string (i) << " " << macros [i % 3] << "\n";
+      if (i % 5 == 0) {
+        os << "  + MASKSHIFT 21\n";
+      }
+      os << "  + PLACED ( " << tl::to_string ((i % 100) * 2000) << " " << tl::to_string ((i / 100) * 2000) << " ) " << orient [i % 4] << " ;\n";
+    }
+    os << "END COMPONENTS\n";
+
+    os << "NETS " << tl::to_string (n) << " ;\n";
+    for (int i = 0; i < n; ++i) {
+      int x = (i % 100) * 2000, y = (i / 100) * 2000;
+      if (i % 7 == 0) {
+        os << "# comment with separators ; - END\n";
+      }
+      os << "- n" << tl::to_string (i) << " ( c" << tl::to_string (i) << " A )\n";
+      os << "  + PROPERTY p \"value ; - " << tl::to_string (i) << "\"\n";
+      if (with_error && i == n - 100) {
+        os << "  + VIA nonexisting ( 0 0 )\n";
+      }
+      os << "  + ROUTED M0PO ( " << tl::to_string (x) << " " << tl::to_string (y) << " ) ( " << tl::to_string (x + 500) << " * ) square ( * " << tl::to_string (y + 500) << " )\n";
+      os << "    NEW M1 MASK " << tl::to_string (1 + i % 2) << " ( " << tl::to_string (x) << " " << tl::to_string (y) << " ) ( * " << tl::to_string (y + 800) << " 10 )\n";
+      if (i % 3 == 0) {
+        os << "  + SUBNET s" << tl::to_string (i) << " ( c" << tl::to_string (i) << " Z )\n  + ROUTED M2 ( " << tl::to_string (x) << " " << tl::to_string (y) << " ) ( " << tl::to_string (x + 300) << " * )\n";
+      }
+      os << "  ;\n";
+    }
+    os << "END NETS\n";
+
+    os << "SPECIALNETS " << tl::to_string (n / 10) << " ;\n";
+    for (int i = 0; i < n / 10; ++i) {
+      os << "- vdd" << tl::to_string (i) << "\n";
+      os << "  + ROUTED M2 100 ( " << tl::to_string (i * 1000) << " 0 ) ( * 10000 )\n";
+      os << "  + RECT M1 ( " << tl::to_string (i * 1000) << " 0 ) ( " << tl::to_string (i * 1000 + 200) << " 200 )\n";
+      os << "  ;\n";
+    }
+    os << "END SPECIALNETS\n";
+
+    os << "END DESIGN\n";
+
+  }
+
+  db::Layout ly_single, ly_threads;
+
+  {
+    tl::SelfTimer timer ("DEF reader, single-threaded");
+    read_big_def (ly_single, def_file, 0);
+  }
+
+  {
+    tl::SelfTimer timer ("DEF reader, 4 threads");
+    read_big_def (ly_threads, def_file, 4);
+  }
+
+  EXPECT_EQ (db::compare_layouts (ly_single, ly_threads, db::layout_diff::f_verbose, 0, 100), true);
+
+  db::cell_index_type top = *ly_threads.begin_top_down ();
+  EXPECT_EQ (ly_threads.cell (top).cell_instances () > size_t (n), true);
+
+  //  errors are reported with the same line number in multi-threaded mode
+  std::string error_single = read_big_def_error (def_file_with_error, 0);
+  EXPECT_EQ (error_single.find ("Invalid via name: nonexisting (line=") == 0, true);
+  EXPECT_EQ (read_big_def_error (def_file_with_error, 4), error_single);
+}
+
+static void read_lefs_and_def (db::Layout &layout, const std::string &path, const std::vector<std::string> &lefs, const std::string &def, const db::LEFDEFReaderOptions &options, bool one_by_one)
+{
+  db::LEFDEFReaderState ld (&options, layout, path);
+  db::DEFImporter imp;
+
+  std::vector<std::string> lef_paths;
+  for (std::vector<std::string>::const_iterator l = lefs.begin (); l != lefs.end (); ++l) {
+    lef_paths.push_back (path + *l);
+  }
+
+  if (one_by_one) {
+    for (std::vector<std::string>::const_iterator l = lef_paths.begin (); l != lef_paths.end (); ++l) {
+      tl::InputStream stream (*l);
+      imp.read_lef (stream, layout, ld);
+    }
+  } else {
+    imp.read_lef_files (lef_paths, layout, ld);
+  }
+
+  if (! def.empty ()) {
+    tl::InputStream stream (path + def);
+    imp.read (stream, layout, ld);
+  } else {
+    imp.finish_lef (layout);
+  }
+
+  ld.finish (layout);
+}
+
+static void check_lef_files (tl::TestBase *_this, const std::string &path, const std::vector<std::string> &lefs, const std::string &def, const db::LEFDEFReaderOptions &options)
+{
+  db::Layout ly_ref, ly;
+  read_lefs_and_def (ly_ref, path, lefs, def, options, true);
+  read_lefs_and_def (ly, path, lefs, def, options, false);
+
+  EXPECT_EQ (db::compare_layouts (ly_ref, ly, db::layout_diff::f_verbose, 0, 100), true);
+}
+
+TEST(122_lef_files_threads)
+{
+  db::LEFDEFReaderOptions options = default_options ();
+  options.set_threads (4);
+  options.set_produce_pin_names (true);
+  options.set_cell_outline_layer ("OUTLINE (8/0)");
+
+  std::vector<std::string> lefs;
+  lefs.push_back ("in_tech.lef");
+  lefs.push_back ("in.lef");
+
+  check_lef_files (_this, tl::testsrc () + "/testdata/lefdef/lefpins/", lefs, "in.def", options);
+  check_lef_files (_this, tl::testsrc () + "/testdata/lefdef/lefpins/", lefs, std::string (), options);
+  check_lef_files (_this, tl::testsrc () + "/testdata/lefdef/masks-2/", lefs, "in.def", options);
+  check_lef_files (_this, tl::testsrc () + "/testdata/lefdef/foreigncell/", lefs, "in.def", options);
+
+  options.set_macro_resolution_mode (1);
+  check_lef_files (_this, tl::testsrc () + "/testdata/lefdef/foreigncell/", lefs, "in.def", options);
+
+  //  macro and via definitions depending on layers of LEF files read before
+  std::string path = tmp_file ("lefs") + "/";
+  tl::mkpath (path);
+
+  {
+    tl::OutputStream os (path + "tech.lef");
+    os << "LAYER M1\n  TYPE ROUTING ;\n  WIDTH 0.1 ;\nEND M1\n";
+    os << "LAYER V1\n  TYPE CUT ;\nEND V1\n";
+    os << "LAYER M2\n  TYPE ROUTING ;\n  WIDTH 0.2 ;\nEND M2\n";
+    os << "END LIBRARY\n";
+  }
+
+  {
+    tl::OutputStream os (path + "macros.lef");
+    os << "VIA V1X\n  LAYER M1 ;\n    RECT -0.1 -0.1 0.1 0.1 ;\n  LAYER V1 ;\n    RECT -0.05 -0.05 0.05 0.05 ;\n  LAYER M2 ;\n    RECT -0.1 -0.1 0.1 0.1 ;\nEND V1X\n";
+    os << "MACRO A\n  SIZE 2 BY 2 ;\n  PIN Z\n    PORT\n      LAYER M1 ;\n        PATH 0 0 1 0 ;\n    END\n  END Z\n";
+    os << "  OBS\n    LAYER M2 ;\n      PATH 0 1 1 1 ;\n    VIA 1 1 V1X ;\n  END\nEND A\n";
+    os << "END LIBRARY\n";
+  }
+
+  {
+    tl::OutputStream os (path + "more_macros.lef");
+    os << "MACRO B\n  SIZE 1 BY 1 ;\n  PIN Z\n    PORT\n      LAYER M1 ;\n        RECT 0 0 0.5 0.5 ;\n    END\n  END Z\nEND B\n";
+    os << "END LIBRARY\n";
+  }
+
+  lefs.clear ();
+  lefs.push_back ("tech.lef");
+  lefs.push_back ("macros.lef");
+  lefs.push_back ("more_macros.lef");
+
+  options = default_options ();
+  options.set_threads (4);
+  options.set_produce_pin_names (true);
+
+  check_lef_files (_this, path, lefs, std::string (), options);
+
+  //  errors are reported like when reading the files one by one
+  lefs.push_back ("more_macros.lef");
+
+  std::string error_ref, error;
+
+  try {
+    db::Layout ly;
+    read_lefs_and_def (ly, path, lefs, std::string (), options, true);
+  } catch (tl::Exception &ex) {
+    error_ref = ex.msg ();
+  }
+
+  try {
+    db::Layout ly;
+    read_lefs_and_def (ly, path, lefs, std::string (), options, false);
+  } catch (tl::Exception &ex) {
+    error = ex.msg ();
+  }
+
+  EXPECT_EQ (error_ref.find ("Duplicate MACRO name: B") == 0, true);
+  EXPECT_EQ (error, error_ref);
+}
+
+TEST(123_lef_cache)
+{
+  std::string path = tl::testsrc () + "/testdata/lefdef/masks-2/";
+  std::string cache_path = tmp_file ("lef_cache");
+
+  std::vector<std::string> lefs;
+  lefs.push_back ("in_tech.lef");
+  lefs.push_back ("in.lef");
+
+  db::LEFDEFReaderOptions options = default_options ();
+  options.set_produce_pin_names (true);
+  options.set_lef_cache_path (cache_path);
+
+  //  the first pass fills the cache, the second one takes the files from the cache
+  for (int pass = 0; pass < 2; ++pass) {
+    check_lef_files (_this, path, lefs, "in.def", options);
+    EXPECT_EQ (tl::dir_entries (cache_path, true, false).size (), size_t (2));
+  }
+
+  //  with threads
+  options.set_threads (2);
+  check_lef_files (_this, path, lefs, "in.def", options);
+  EXPECT_EQ (tl::dir_entries (cache_path, true, false).size (), size_t (2));
+
+  //  different options make a different cache entry
+  options.set_produce_obstructions (false);
+  check_lef_files (_this, path, lefs, "in.def", options);
+  EXPECT_EQ (tl::dir_entries (cache_path, true, false).size (), size_t (4));
+
+  //  invalid cache files are ignored
+  std::vector<std::string> entries = tl::dir_entries (cache_path, true, false);
+  for (std::vector<std::string>::const_iterator e = entries.begin (); e != entries.end (); ++e) {
+    tl::OutputStream os (tl::combine_path (cache_path, *e));
+    os << "garbage";
+  }
+
+  check_lef_files (_this, path, lefs, "in.def", options);
+  check_lef_files (_this, path, lefs, "in.def", options);
+
+  //  through the reader
+  db::LEFDEFReaderOptions lefdef_opt = default_options ();
+  lefdef_opt.set_map_file ("in.map");
+  lefdef_opt.set_lef_cache_path (cache_path);
+  db::LoadLayoutOptions opt;
+  opt.set_options (lefdef_opt);
+
+  for (int pass = 0; pass < 2; ++pass) {
+
+    db::Layout ly;
+
+    {
+      tl::InputStream is (tl::testsrc () + "/testdata/lefdef/masks-1/in.def");
+      db::Reader reader (is);
+      reader.read (ly, opt);
+    }
+
+    db::compare_layouts (_this, ly, tl::testsrc () + "/testdata/lefdef/masks-1/au_plugin_def.oas.gz", db::WriteOAS);
+
+  }
+}
+
 TEST(200_lefdef_plugin)
 {
   db::Layout ly;
@@ -323,5 +323,13 @@ TEST(1)
 
   options.set_macro_resolution_mode (2);
   EXPECT_EQ (options.macro_resolution_mode (), (unsigned int) 2);
+
+  EXPECT_EQ (options.threads (), (unsigned int) 0);
+  options.set_threads (4);
+  EXPECT_EQ (options.threads (), (unsigned int) 4);
+
+  EXPECT_EQ (options.lef_cache_path (), "");
+  options.set_lef_cache_path ("/tmp/lef_cache");
+  EXPECT_EQ (options.lef_cache_path (), "/tmp/lef_cache");
 }
 
@@ -670,6 +670,7 @@ OASISWriter::OASISWriter ()
     m_propname_id (0),
     m_propstring_id (0),
     m_proptables_written (false),
+    m_streaming (false),
     m_progress (tl::to_string (tr ("Writing OASIS file")), 10000)
 {
   m_progress.set_format (tl::to_string (tr ("%.0f MB")));
@@ -1183,6 +1184,8 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
     m_sf = 1.0;
   }
 
+  m_streaming = false;
+
   std::vector <std::pair <unsigned int, db::LayerProperties> > layers;
   options.get_valid_layers (layout, layers, db::SaveLayoutOptions::LP_AssignNumber);
 
@@ -1792,6 +1795,155 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
   m_progress.set (mp_stream->pos ());
 }
 
+std::string
+OASISWriter::current_cell_name () const
+{
+  if (mp_cell && mp_layout) {
+    return mp_layout->cell_name (mp_cell->cell_index ());
+  } else {
+    return m_stream_cell_name;
+  }
+}
+
+bool
+OASISWriter::supports_streaming () const
+{
+  return true;
+}
+
+void
+OASISWriter::begin_stream (tl::OutputStream &stream, double dbu, const db::SaveLayoutOptions &options)
+{
+  mp_layout = 0;
+  mp_cell = 0;
+  m_layer = m_datatype = 0;
+  m_in_cblock = false;
+  m_cblock_buffer.clear ();
+  m_streaming = true;
+
+  m_options = options.get_options<OASISWriterOptions> ();
+  mp_stream = &stream;
+
+  double out_dbu = (options.dbu () == 0.0) ? dbu : options.dbu ();
+  m_sf = options.scale_factor () * (dbu / out_dbu);
+  if (fabs (m_sf - 1.0) < 1e-9) {
+    //  to avoid rounding problems, set to 1.0 exactly if possible.
+    m_sf = 1.0;
+  }
+
+  m_textstrings.clear ();
+  m_propnames.clear ();
+  m_propstrings.clear ();
+
+  //  write header
+
+  char magic[] = "%SEMI-OASIS\015\012";
+  write_bytes (magic, sizeof (magic) - 1);
+
+  //  START record: streaming mode is always non-strict since we don't write name tables
+  //  (all names are given explicitly) and the (empty) offset table is written up front.
+  write_record_id (1); 
+  write_bstring ("1.0");
+  write (1.0 / out_dbu);
+  write_byte (0);
+
+  for (unsigned int i = 0; i < 12; ++i) {
+    write_byte (0);
+  }
+
+  reset_modal_variables ();
+}
+
+void
+OASISWriter::begin_stream_cell (const std::string &name)
+{
+  m_progress.set (mp_stream->pos ());
+
+  m_stream_cell_name = name;
+
+  write_record_id (14);  // CELL (by name)
+  write_nstring (name.c_str ());
+
+  reset_modal_variables ();
+
+  if (m_options.write_cblocks) {
+    begin_cblock ();
+  }
+}
+
+void
+OASISWriter::stream_shapes (const db::Layout &layout, const db::Shapes &shapes, const db::LayerProperties &lp)
+{
+  mp_layout = &layout;
+  if (! shapes.empty ()) {
+    write_shapes (lp, shapes);
+    m_progress.set (mp_stream->pos ());
+  }
+  mp_layout = 0;
+}
+
+void
+OASISWriter::stream_cell_reference (const std::string &name, const db::Vector &disp)
+{
+  unsigned char info = 0x80;  // explicit cell name
+  if (mm_placement_x != disp.x ()) {
+    info |= 0x20;
+  }
+  if (mm_placement_y != disp.y ()) {
+    info |= 0x10;
+  }
+
+  write_record_id (17);
+  write_byte (info);
+
+  write_nstring (name.c_str ());
+  //  the modal placement cell is an index in non-streaming mode, so we don't keep the name
+  mm_placement_cell.reset ();
+
+  if (info & 0x20) {
+    mm_placement_x = disp.x ();
+    write_coord (mm_placement_x.get ());
+  }
+  if (info & 0x10) {
+    mm_placement_y = disp.y ();
+    write_coord (mm_placement_y.get ());
+  }
+}
+
+void
+OASISWriter::end_stream_cell ()
+{
+  if (m_options.write_cblocks) {
+    end_cblock ();
+  }
+
+  m_stream_cell_name.clear ();
+}
+
+void
+OASISWriter::end_stream ()
+{
+  //  END record (non-strict mode: the offset table is in the START record)
+
+  size_t end_record_pos = mp_stream->pos ();
+
+  write_record_id (2);
+
+  //  write a b-string to pad up to 255 bytes
+  //  (this bstring consists of a "long zero" and no characters
+  while (mp_stream->pos () < end_record_pos + 254) {
+    write_byte (char (0x80));
+  }
+  write_byte (0);
+
+  //  validation-scheme
+  write_byte (0);
+
+  m_progress.set (mp_stream->pos ());
+
+  m_streaming = false;
+}
+
 void 
 OASISWriter::write (const Repetition &rep)
 {
@@ -2074,6 +2226,11 @@ OASISWriter::write_insts (const std::set <db::cell_index_type> &cell_set)
 void
 OASISWriter::write_props (db::properties_id_type prop_id)
 {
+  //  properties are not supported in streaming mode (we don't have name tables there)
+  if (m_streaming) {
+    return;
+  }
+
   std::vector<tl::Variant> pv_list; 
 
   const db::PropertiesRepository::properties_set &props = mp_layout->properties_repository ().properties (prop_id);
@@ -2336,11 +2493,16 @@ OASISWriter::write (const db::Text &text, db::properties_id_type prop_id, const
   m_progress.set (mp_stream->pos ());
 
   db::Trans trans = text.trans ();
-  std::map <std::string, unsigned long>::const_iterator ts = m_textstrings.find (text.string ());
-  tl_assert (ts != m_textstrings.end ());
-  unsigned long text_id = ts->second;
 
-  unsigned char info = 0x20;
+  //  in streaming mode, text strings are written explicitly
+  unsigned long text_id = 0;
+  if (! m_streaming) {
+    std::map <std::string, unsigned long>::const_iterator ts = m_textstrings.find (text.string ());
+    tl_assert (ts != m_textstrings.end ());
+    text_id = ts->second;
+  }
+
+  unsigned char info = m_streaming ? 0 : 0x20;
 
   if (mm_text_string != text.string ()) {
     info |= 0x40;
@@ -2365,7 +2527,11 @@ OASISWriter::write (const db::Text &text, db::properties_id_type prop_id, const
   write_byte (info);
   if (info & 0x40) {
     mm_text_string = text.string ();
-    write ((unsigned long) text_id);
+    if (m_streaming) {
+      write_astring (text.string ());
+    } else {
+      write ((unsigned long) text_id);
+    }
   }
   if (info & 0x01) {
     mm_textlayer = m_layer;
@@ -2414,7 +2580,7 @@ OASISWriter::write (const db::SimplePolygon &polygon, db::properties_id_type pro
   }
 
   if (m_pointlist.size () < 2) {
-    std::string msg = tl::to_string (tr ("Polygons with less than three points cannot be written to OASIS files (cell ")) + mp_layout->cell_name (mp_cell->cell_index ()) + tl::to_string (tr (", position ")) + tl::to_string (start.x ()) + ", " + tl::to_string (start.y ()) + " DBU)";
+    std::string msg = tl::to_string (tr ("Polygons with less than three points cannot be written to OASIS files (cell ")) + current_cell_name () + tl::to_string (tr (", position ")) + tl::to_string (start.x ()) + ", " + tl::to_string (start.y ()) + " DBU)";
     if (m_options.permissive) {
       tl::warn << msg;
       return;
@@ -2515,7 +2681,7 @@ OASISWriter::write (const db::Polygon &polygon, db::properties_id_type prop_id,
     }
 
     if (m_pointlist.size () < 2) {
-      std::string msg = tl::to_string (tr ("Polygons with less than three points cannot be written to OASIS files (cell ")) + mp_layout->cell_name (mp_cell->cell_index ()) + tl::to_string (tr (", position ")) + tl::to_string (start.x ()) + ", " + tl::to_string (start.y ()) + " DBU)";
+      std::string msg = tl::to_string (tr ("Polygons with less than three points cannot be written to OASIS files (cell ")) + current_cell_name () + tl::to_string (tr (", position ")) + tl::to_string (start.x ()) + ", " + tl::to_string (start.y ()) + " DBU)";
       if (m_options.permissive) {
         tl::warn << msg;
         return;
@@ -2691,7 +2857,7 @@ OASISWriter::write (const db::Path &path, db::properties_id_type prop_id, const
       db::Coord w = safe_scale (m_sf, path.width ());
       db::Coord hw = w / 2;
       if (hw * 2 != w) {
-        std::string msg = tl::to_string (tr ("Circles with odd diameter cannot be written to OASIS files (cell ")) + mp_layout->cell_name (mp_cell->cell_index ()) + tl::to_string (tr (", position ")) + tl::to_string (start.x ()) + ", " + tl::to_string (start.y ()) + " DBU)";
+        std::string msg = tl::to_string (tr ("Circles with odd diameter cannot be written to OASIS files (cell ")) + current_cell_name () + tl::to_string (tr (", position ")) + tl::to_string (start.x ()) + ", " + tl::to_string (start.y ()) + " DBU)";
         if (m_options.permissive) {
           tl::warn << msg << " - " << tl::to_string (tr ("circle diameter is rounded"));
         } else {
@@ -2763,7 +2929,7 @@ OASISWriter::write (const db::Path &path, db::properties_id_type prop_id, const
     db::Coord w = safe_scale (m_sf, path.width ());
     db::Coord hw = w / 2;
     if (hw * 2 != w) {
-      std::string msg = tl::to_string (tr ("Paths with odd width cannot be written to OASIS files (cell ")) + mp_layout->cell_name (mp_cell->cell_index ()) + tl::to_string (tr (", position ")) + tl::to_string (start.x ()) + ", " + tl::to_string (start.y ()) + " DBU)";
+      std::string msg = tl::to_string (tr ("Paths with odd width cannot be written to OASIS files (cell ")) + current_cell_name () + tl::to_string (tr (", position ")) + tl::to_string (start.x ()) + ", " + tl::to_string (start.y ()) + " DBU)";
       if (m_options.permissive) {
         tl::warn << msg << " - " << tl::sprintf (tl::to_string (tr ("path width is rounded from %d to %d DBU")), w, hw * 2);
       } else {
@@ -112,6 +112,15 @@ public:
    */
   void write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
 
+  //  Streaming mode implementation (see db::WriterBase)
+  virtual bool supports_streaming () const;
+  virtual void begin_stream (tl::OutputStream &stream, double dbu, const db::SaveLayoutOptions &options);
+  virtual void begin_stream_cell (const std::string &name);
+  virtual void stream_shapes (const db::Layout &layout, const db::Shapes &shapes, const db::LayerProperties &lp);
+  virtual void stream_cell_reference (const std::string &name, const db::Vector &disp);
+  virtual void end_stream_cell ();
+  virtual void end_stream ();
+
   void write (const db::CellInstArray &inst_array, const db::Repetition &rep)
   {
     write (inst_array, 0, rep);
@@ -210,6 +219,8 @@ private:
   unsigned long m_propname_id;
   unsigned long m_propstring_id;
   bool m_proptables_written;
+  bool m_streaming;
+  std::string m_stream_cell_name;
 
   std::map <std::string, unsigned long> m_textstrings;
   std::map <std::string, unsigned long> m_propnames;
@@ -295,6 +306,7 @@ private:
   void end_table (size_t pos);
 
   void reset_modal_variables ();
+  std::string current_cell_name () const;
 
   void emit_propname_def (db::properties_id_type prop_id);
   void emit_propstring_def (db::properties_id_type prop_id);
@@ -939,16 +939,28 @@ GerberDrillFileReader::produce_circle_raw (double cx, double cy, double r, doubl
   //  adjust the radius so we get a outer approximation of the circle:
   //  r *= 1.0 / cos (M_PI / double (n_circle));
 
+  //  the cosine and sine values are the same for all holes
+  if (m_circle_table.size () != size_t (n_circle)) {
+    m_circle_table.clear ();
+    m_circle_table.reserve (n_circle);
+    for (int i = 0; i < n_circle; ++i) {
+      double a = M_PI * 2.0 * (double (i) / double (n_circle));
+      m_circle_table.push_back (std::make_pair (cos (a), sin (a)));
+    }
+  }
+
+  points.reserve (n_circle);
+
   int i = 0;
 
   for (; i < n_circle / 2; ++i) {
-    double a = M_PI * 2.0 * (double (i) / double (n_circle));
-    points.push_back (db::DPoint (cx + nx * cos (a) + mx * sin (a), cy + ny * cos (a) + my * sin (a)));
+    double ca = m_circle_table [i].first, sa = m_circle_table [i].second;
+    points.push_back (db::DPoint (cx + nx * ca + mx * sa, cy + ny * ca + my * sa));
   }
 
   for (; i < n_circle; ++i) {
-    double a = M_PI * 2.0 * (double (i) / double (n_circle));
-    points.push_back (db::DPoint (ex + nx * cos (a) + mx * sin (a), ey + ny * cos (a) + my * sin (a)));
+    double ca = m_circle_table [i].first, sa = m_circle_table [i].second;
+    points.push_back (db::DPoint (ex + nx * ca + mx * sa, ey + ny * ca + my * sa));
   }
 
   db::DPolygon p;
@@ -92,6 +92,7 @@ private:
   bool m_routing;
   bool m_plunged;
   bool m_linear_interpolation;
+  std::vector<std::pair<double, double> > m_circle_table;
 
   const std::string &get_block ();
   void read_line (std::string &b);
@@ -38,7 +38,7 @@ GerberImportData::GerberImportData ()
   : invert_negative_layers (false), border (5000),
     free_layer_mapping (false), mode (ModeSamePanel), mounting (MountingTop),
     num_metal_layers (0), num_via_types (0), num_circle_points (-1),
-    merge_flag (false), dbu (0.001), topcell_name ("PCB")
+    merge_flag (false), num_threads (0), dbu (0.001), topcell_name ("PCB")
 {
   // .. nothing yet ..
 }
@@ -87,6 +87,7 @@ GerberImportData::setup_importer (db::GerberImporter *importer)
   importer->set_merge (merge_flag);
   importer->set_invert_negative_layers (invert_negative_layers);
   importer->set_border (border);
+  importer->set_threads (num_threads > 0 ? (unsigned int) num_threads : 0);
 
   if (free_layer_mapping) {
 
@@ -225,6 +226,7 @@ pcb_project_structure ("pcb-project",
   tl::make_member (&GerberImportData::layer_properties_file, "layer-properties-file") +
   tl::make_member (&GerberImportData::num_circle_points, "num-circle-points") +
   tl::make_member (&GerberImportData::merge_flag, "merge-flag") +
+  tl::make_member (&GerberImportData::num_threads, "num-threads") +
   tl::make_member (&GerberImportData::dbu, "dbu") +
   tl::make_member (&GerberImportData::topcell_name, "cell-name")
 );
@@ -421,6 +423,12 @@ GerberImportData::from_string (const std::string &s)
       ex.read (merge_flag);
       ex.test (";");
 
+    } else if (ex.test ("num-threads")) {
+
+      ex.test ("=");
+      ex.read (num_threads);
+      ex.test (";");
+
     } else if (ex.test ("dbu")) {
 
       ex.test ("=");
@@ -508,6 +516,7 @@ GerberImportData::to_string () const
   s += "layer-properties-file=" + tl::to_quoted_string (layer_properties_file) + ";";
   s += "num-circle-points=" + tl::to_string (num_circle_points) + ";";
   s += "merge-flag=" + tl::to_string (merge_flag) + ";";
+  s += "num-threads=" + tl::to_string (num_threads) + ";";
   s += "dbu=" + tl::to_string (dbu) + ";";
   s += "cell-name=" + tl::to_quoted_string (topcell_name) + ";";
 
@@ -85,6 +85,7 @@ public:
   std::string layer_properties_file;
   int num_circle_points;
   bool merge_flag;
+  int num_threads;
   double dbu;
   std::string topcell_name;
 
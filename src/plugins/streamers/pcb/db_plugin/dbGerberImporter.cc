@@ -33,6 +33,7 @@
 #include "tlString.h"
 #include "tlLog.h"
 #include "tlFileUtils.h"
+#include "tlThreadedWorkers.h"
 #include "dbShapeProcessor.h"
 
 #include <cmath>
@@ -110,6 +111,7 @@ static std::string format_to_string (int l, int t, bool tz)
 
 GerberFileReader::GerberFileReader ()
   : m_circle_points (64), m_digits_before (-1), m_digits_after (-1), m_omit_leading_zeroes (true),
+    m_explicit_digits (false), m_explicit_zeroes (false), m_default_format_used (false),
     m_merge (false), m_inverse (false),
     m_dbu (0.001), m_unit (1000.0),
     m_rot (0.0), m_s (1.0), m_ox (0.0), m_oy (0.0),
@@ -117,7 +119,8 @@ GerberFileReader::GerberFileReader ()
     m_orot (0.0), m_os (1.0), m_omx (false), m_omy (false),
     m_ep (true /*report progress*/),
     mp_layout (0), mp_top_cell (0), mp_stream (0),
-    m_progress (tl::to_string (tr ("Reading Gerber file")), 10000)
+    m_progress (tl::to_string (tr ("Reading Gerber file")), 10000),
+    mp_messages (0)
 {
   m_progress.set_format (tl::to_string (tr ("%.0f MB")));
   m_progress.set_unit (1024 * 1024);
@@ -165,6 +168,10 @@ GerberFileReader::read (tl::TextInputStream &stream, db::Layout &layout, db::Cel
   mp_top_cell = &cell;
   m_target_layers = targets;
 
+  //  the format given before is the default format - see "depends_on_default_format"
+  m_explicit_digits = m_explicit_zeroes = false;
+  m_default_format_used = false;
+
   try {
     do_read ();
   } catch (tl::BreakException &) {
@@ -198,13 +205,21 @@ GerberFileReader::format_string () const
 void 
 GerberFileReader::warn (const std::string &warning)
 {
-  tl::warn << warning << tl::to_string (tr (" in line ")) << mp_stream->line_number () << tl::to_string (tr (" (file ")) << mp_stream->source () << ")";
+  if (mp_messages) {
+    mp_messages->push_back (std::make_pair (false, warning + tl::to_string (tr (" in line ")) + tl::to_string (mp_stream->line_number ()) + tl::to_string (tr (" (file ")) + mp_stream->source () + ")"));
+  } else {
+    tl::warn << warning << tl::to_string (tr (" in line ")) << mp_stream->line_number () << tl::to_string (tr (" (file ")) << mp_stream->source () << ")";
+  }
 }
 
 void 
 GerberFileReader::error (const std::string &error)
 {
-  tl::error << error << tl::to_string (tr (" in line ")) << mp_stream->line_number () << tl::to_string (tr (" (file ")) << mp_stream->source () << ")";
+  if (mp_messages) {
+    mp_messages->push_back (std::make_pair (true, error + tl::to_string (tr (" in line ")) + tl::to_string (mp_stream->line_number ()) + tl::to_string (tr (" (file ")) + mp_stream->source () + ")"));
+  } else {
+    tl::error << error << tl::to_string (tr (" in line ")) << mp_stream->line_number () << tl::to_string (tr (" (file ")) << mp_stream->source () << ")";
+  }
 }
 
 void 
@@ -219,9 +234,19 @@ GerberFileReader::accuracy() const
   return m_unit / pow (10.0, m_digits_after);
 }
 
+void
+GerberFileReader::format_used ()
+{
+  if (! m_explicit_digits || ! m_explicit_zeroes) {
+    m_default_format_used = true;
+  }
+}
+
 double 
 GerberFileReader::read_coord (tl::Extractor &ex) 
 {
+  format_used ();
+
   ex.skip ();
   int sign = 1;
   if (*ex == '+') {
@@ -528,10 +553,226 @@ std::vector <tl::shared_ptr<db::GerberFileReader> > get_readers ()
   return readers;
 }
 
+namespace
+{
+
+/**
+ *  @brief The reader settings for one file
+ */
+struct GerberReaderSetup
+{
+  GerberReaderSetup ()
+    : dbu (0.001), merge (false), circle_points (-1)
+  { }
+
+  void apply (db::GerberFileReader &reader) const
+  {
+    reader.set_dbu (dbu);
+    reader.set_global_trans (global_trans);
+    reader.set_format_string (file_format);
+    if (! reader.has_format ()) {
+      reader.set_format_string (default_format);
+    }
+    reader.set_merge (merge);
+    reader.set_circle_points (circle_points);
+  }
+
+  double dbu;
+  db::DCplxTrans global_trans;
+  std::string file_format;
+  std::string default_format;
+  bool merge;
+  int circle_points;
+};
+
+/**
+ *  @brief Reads the given file into the target layers of the given cell
+ *
+ *  Returns the reader used. If "messages" is non-null, warnings and errors are stored there.
+ */
+tl::shared_ptr<db::GerberFileReader>
+read_file (const std::string &fp, const std::string &filename, const GerberReaderSetup &setup, db::Layout &layout, db::Cell &cell, const std::vector <unsigned int> &targets, std::vector<std::pair<bool, std::string> > *messages)
+{
+  tl::InputStream input_file (fp);
+  tl::TextInputStream stream (input_file);
+
+  std::vector <tl::shared_ptr<db::GerberFileReader> > readers = get_readers ();
+
+  //  determine the reader to use:
+  tl::shared_ptr<db::GerberFileReader> reader;
+  for (std::vector <tl::shared_ptr<db::GerberFileReader> >::iterator r = readers.begin (); r != readers.end (); ++r) {
+    stream.reset ();
+    if ((*r)->accepts (stream)) {
+      reader = *r;
+      break;
+    }
+  }
+
+  if (! reader) {
+    throw tl::Exception (tl::to_string (tr ("Unable to determine format for file '%s'")), fp);
+  }
+
+  stream.reset ();
+
+  //  set up the reader
+  setup.apply (*reader);
+  reader->set_message_sink (messages);
+
+  //  actually read
+  try {
+    reader->read (stream, layout, cell, targets);
+  } catch (tl::BreakException &) {
+    throw;
+  } catch (tl::Exception &ex) {
+    throw tl::Exception (ex.msg () + ", reading file " + filename);
+  }
+
+  reader->set_message_sink (0);
+
+  return reader;
+}
+
+/**
+ *  @brief A file read into a staging layout
+ *
+ *  The staging layout has a single layer. The shapes are transferred to the target
+ *  layers later.
+ */
+class GerberStagedFile
+{
+public:
+  GerberStagedFile (const std::string &path, const std::string &filename, const GerberReaderSetup &setup)
+    : m_path (path), m_filename (filename), m_setup (setup), m_inverse (false), m_depends_on_default_format (true)
+  {
+    m_layout.dbu (setup.dbu);
+    m_cell_index = m_layout.add_cell ("PCB");
+    m_layer = m_layout.insert_layer ();
+  }
+
+  void read ()
+  {
+    try {
+
+      std::vector <unsigned int> targets;
+      targets.push_back (m_layer);
+
+      tl::shared_ptr<db::GerberFileReader> reader = read_file (m_path, m_filename, m_setup, m_layout, m_layout.cell (m_cell_index), targets, &m_messages);
+
+      m_format = reader->format_string ();
+      m_inverse = reader->is_inverse ();
+      m_depends_on_default_format = reader->depends_on_default_format ();
+
+    } catch (tl::Exception &ex) {
+      m_error = ex.msg ();
+    }
+  }
+
+  void issue_messages () const
+  {
+    for (std::vector<std::pair<bool, std::string> >::const_iterator m = m_messages.begin (); m != m_messages.end (); ++m) {
+      if (m->first) {
+        tl::error << m->second;
+      } else {
+        tl::warn << m->second;
+      }
+    }
+  }
+
+  void transfer (db::Cell &cell, const std::vector <unsigned int> &targets) const
+  {
+    const db::Shapes &shapes = m_layout.cell (m_cell_index).shapes (m_layer);
+    for (std::vector <unsigned int>::const_iterator t = targets.begin (); t != targets.end (); ++t) {
+      db::Shapes &out = cell.shapes (*t);
+      for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+        out.insert (*s);
+      }
+    }
+  }
+
+  const std::string &default_format () const
+  {
+    return m_setup.default_format;
+  }
+
+  const std::string &format_string () const
+  {
+    return m_format;
+  }
+
+  bool is_inverse () const
+  {
+    return m_inverse;
+  }
+
+  bool depends_on_default_format () const
+  {
+    return m_depends_on_default_format;
+  }
+
+  bool has_error () const
+  {
+    return ! m_error.empty ();
+  }
+
+  const std::string &error () const
+  {
+    return m_error;
+  }
+
+private:
+  std::string m_path, m_filename;
+  GerberReaderSetup m_setup;
+  db::Layout m_layout;
+  db::cell_index_type m_cell_index;
+  unsigned int m_layer;
+  std::string m_format;
+  bool m_inverse;
+  bool m_depends_on_default_format;
+  std::vector<std::pair<bool, std::string> > m_messages;
+  std::string m_error;
+
+  //  no copying
+  GerberStagedFile (const GerberStagedFile &);
+  GerberStagedFile &operator= (const GerberStagedFile &);
+};
+
+class GerberStagedFileTask
+  : public tl::Task
+{
+public:
+  GerberStagedFileTask (GerberStagedFile *file)
+    : mp_file (file)
+  { }
+
+  void perform ()
+  {
+    mp_file->read ();
+  }
+
+private:
+  GerberStagedFile *mp_file;
+};
+
+class GerberStagedFileWorker
+  : public tl::Worker
+{
+public:
+  GerberStagedFileWorker ()
+    : tl::Worker ()
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<GerberStagedFileTask *> (task)->perform ();
+  }
+};
+
+}
+
 GerberImporter::GerberImporter ()
   : m_cell_name ("PCB"), m_dbu (0.001), m_merge (false), 
     m_invert_negative_layers (false), m_border (5000), 
-    m_circle_points (64)
+    m_circle_points (64), m_threads (0)
 {
   // .. nothing yet ..
 }
@@ -961,11 +1202,13 @@ GerberImporter::do_read (db::Layout &layout, db::cell_index_type cell_index)
 
     std::string format (m_format_string);
 
-    for (std::vector<db::GerberFile>::iterator file = m_files.begin (); file != m_files.end (); ++file) {
+    std::vector<std::vector <unsigned int> > targets_per_file;
+    targets_per_file.reserve (m_files.size ());
 
-      ++progress;
+    for (std::vector<db::GerberFile>::iterator file = m_files.begin (); file != m_files.end (); ++file) {
 
-      std::vector <unsigned int> targets;
+      targets_per_file.push_back (std::vector <unsigned int> ());
+      std::vector <unsigned int> &targets = targets_per_file.back ();
 
       for (std::vector <db::LayerProperties>::const_iterator ls = file->layer_specs ().begin (); ls != file->layer_specs ().end (); ++ls) {
 
@@ -985,55 +1228,104 @@ GerberImporter::do_read (db::Layout &layout, db::cell_index_type cell_index)
 
       }
 
-      std::string fp = tl::combine_path (tl::absolute_file_path (m_dir), file->filename ());
-      tl::InputStream input_file (fp);
-      tl::TextInputStream stream (input_file);
+    }
+
+    GerberReaderSetup setup;
+    setup.dbu = m_dbu;
+    setup.global_trans = db::DCplxTrans (1.0 / m_dbu) * global_trans * db::DCplxTrans (m_dbu);
 
-      std::vector <tl::shared_ptr<db::GerberFileReader> > readers = get_readers ();
+    std::vector<GerberStagedFile *> staged_files;
 
-      //  determine the reader to use:
-      db::GerberFileReader *reader = 0;
-      for (std::vector <tl::shared_ptr<db::GerberFileReader> >::iterator r = readers.begin (); r != readers.end (); ++r) {
-        stream.reset ();
-        if ((*r)->accepts (stream)) {
-          reader = r->operator-> ();
-          break;
+    try {
+
+      if (m_threads > 0 && m_files.size () > 1) {
+
+        //  Read the files into staging layouts concurrently. A file which does not specify a format
+        //  gets the one from the file before by default. As this is not known yet, the project's
+        //  format is used here and files which actually depend on the default format are read
+        //  again when merging.
+
+        staged_files.reserve (m_files.size ());
+
+        for (std::vector<db::GerberFile>::iterator file = m_files.begin (); file != m_files.end (); ++file) {
+          setup.file_format = file->format_string ();
+          setup.default_format = m_format_string;
+          setup.merge = (file->merge_mode () >= 0 ? (file->merge_mode () != 0) : m_merge);
+          setup.circle_points = (file->circle_points () >= 0 ? file->circle_points () : m_circle_points);
+          staged_files.push_back (new GerberStagedFile (tl::combine_path (tl::absolute_file_path (m_dir), file->filename ()), file->filename (), setup));
         }
-      }
 
-      if (! reader) {
-        throw tl::Exception (tl::to_string (tr ("Unable to determine format for file '%s'")), fp);
-      }
-      
-      stream.reset ();
+        tl::Job<GerberStagedFileWorker> job (int (std::min (size_t (m_threads), staged_files.size ())));
+        for (std::vector<GerberStagedFile *>::const_iterator f = staged_files.begin (); f != staged_files.end (); ++f) {
+          job.schedule (new GerberStagedFileTask (*f));
+        }
+
+        job.start ();
+        job.wait ();
+
+        if (job.has_error ()) {
+          throw tl::Exception (job.error_messages ().front ());
+        }
 
-      //  set up the reader
-      reader->set_dbu (m_dbu);
-      reader->set_global_trans (db::DCplxTrans (1.0 / m_dbu) * global_trans * db::DCplxTrans (m_dbu));
-      reader->set_format_string (file->format_string ());
-      if (! reader->has_format ()) {
-        reader->set_format_string (format);
       }
-      reader->set_merge (file->merge_mode () >= 0 ? (file->merge_mode () != 0) : m_merge);
-      reader->set_circle_points (file->circle_points () >= 0 ? file->circle_points () : m_circle_points);
 
-      //  actually read
-      try {
+      for (std::vector<db::GerberFile>::iterator file = m_files.begin (); file != m_files.end (); ++file) {
+
+        ++progress;
+
+        size_t index = std::distance (m_files.begin (), file);
+        const std::vector <unsigned int> &targets = targets_per_file [index];
+
+        GerberStagedFile *staged = staged_files.empty () ? 0 : staged_files [index];
+
         tl::log << "Reading PCB file '" << file->filename () << "' with format '" << file->format_string () << "'";
-        reader->read (stream, layout, layout.cell (cell_index), targets);
-      } catch (tl::BreakException &) {
-        throw;
-      } catch (tl::Exception &ex) {
-        throw tl::Exception (ex.msg () + ", reading file " + file->filename ());
-      }
 
-      //  use the current format as further default
-      format = reader->format_string ();
+        if (staged && (file->has_format () || staged->default_format () == format || ! staged->depends_on_default_format ())) {
+
+          staged->issue_messages ();
+          if (staged->has_error ()) {
+            throw tl::Exception (staged->error ());
+          }
+
+          staged->transfer (layout.cell (cell_index), targets);
+
+          format = staged->format_string ();
+
+          if (staged->is_inverse ()) {
+            inverse_layers.insert (targets.begin (), targets.end ());
+          }
+
+        } else {
+
+          setup.file_format = file->format_string ();
+          setup.default_format = format;
+          setup.merge = (file->merge_mode () >= 0 ? (file->merge_mode () != 0) : m_merge);
+          setup.circle_points = (file->circle_points () >= 0 ? file->circle_points () : m_circle_points);
+
+          std::string fp = tl::combine_path (tl::absolute_file_path (m_dir), file->filename ());
+          tl::shared_ptr<db::GerberFileReader> reader = read_file (fp, file->filename (), setup, layout, layout.cell (cell_index), targets, 0);
+
+          //  use the current format as further default
+          format = reader->format_string ();
+
+          if (reader->is_inverse ()) {
+            inverse_layers.insert (targets.begin (), targets.end ());
+          }
+
+        }
+
+        if (staged) {
+          delete staged;
+          staged_files [index] = 0;
+        }
 
-      if (reader->is_inverse ()) {
-        inverse_layers.insert (targets.begin (), targets.end ());
       }
 
+    } catch (...) {
+      for (std::vector<GerberStagedFile *>::const_iterator f = staged_files.begin (); f != staged_files.end (); ++f) {
+        delete *f;
+      }
+      throw;
     }
 
   }
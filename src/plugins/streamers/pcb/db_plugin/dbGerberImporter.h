@@ -329,6 +329,7 @@ public:
     m_digits_before = before;
     m_digits_after = after;
     m_omit_leading_zeroes = omit_leading_zeroes;
+    m_explicit_digits = m_explicit_zeroes = true;
   }
 
   /**
@@ -339,6 +340,7 @@ public:
   void set_format (bool omit_leading_zeroes)
   {
     m_omit_leading_zeroes = omit_leading_zeroes;
+    m_explicit_zeroes = true;
   }
 
   /**
@@ -351,6 +353,19 @@ public:
   {
     m_digits_before = before;
     m_digits_after = after;
+    m_explicit_digits = true;
+  }
+
+  /**
+   *  @brief Returns true, if the result of the last "read" depends on the format given before
+   *
+   *  The format set before "read" is the default format. The file may specify a format itself.
+   *  This method returns false, if the file has specified the full format before the first coordinate
+   *  was read. In that case, the result of "read" and the final format do not depend on the default format.
+   */
+  bool depends_on_default_format () const
+  {
+    return m_default_format_used || ! m_explicit_digits || ! m_explicit_zeroes;
   }
 
   /**
@@ -374,6 +389,17 @@ public:
    */
   void produce_polygon (const db::DPolygon &p, bool clear);
 
+  /**
+   *  @brief Sets a container which receives the warnings and errors instead of the log channels
+   *
+   *  The messages are stored as pairs of a flag (true for errors) and the message text.
+   *  This is used for reading files in worker threads. Pass 0 to issue the messages directly.
+   */
+  void set_message_sink (std::vector<std::pair<bool, std::string> > *messages)
+  {
+    mp_messages = messages;
+  }
+
   /**
    *  @brief Returns true, if the inverse layer flag was set during read
    */
@@ -574,6 +600,8 @@ private:
   int m_digits_before;
   int m_digits_after;
   bool m_omit_leading_zeroes;
+  bool m_explicit_digits, m_explicit_zeroes;
+  bool m_default_format_used;
   bool m_merge;
   bool m_inverse;
   double m_dbu;
@@ -597,8 +625,10 @@ private:
   tl::TextInputStream *mp_stream;
   tl::AbsoluteProgress m_progress;
   std::list<GraphicsState> m_graphics_stack;
+  std::vector<std::pair<bool, std::string> > *mp_messages;
 
   void process_clear_polygons ();
+  void format_used ();
   void swap_graphics_state (GraphicsState &state);
 };
 
@@ -899,6 +929,26 @@ public:
     return m_circle_points;
   }
 
+  /**
+   *  @brief Sets the number of threads to use for reading the files
+   *
+   *  With 0 threads (the default), the files are read one after another into the
+   *  target layout. Otherwise, the files are read concurrently into separate staging
+   *  layouts which are merged into the target layout in the order of the files.
+   */
+  void set_threads (unsigned int n)
+  {
+    m_threads = n;
+  }
+
+  /**
+   *  @brief Gets the number of threads to use for reading the files
+   */
+  unsigned int threads () const
+  {
+    return m_threads;
+  }
+
   /**
    *  @brief Specifies the layer styles to use
    *
@@ -1043,6 +1093,7 @@ private:
   bool m_invert_negative_layers;
   double m_border;
   int m_circle_points;
+  unsigned int m_threads;
   std::string m_format_string;
   std::string m_layer_styles;
   std::string m_dir;
@@ -59,19 +59,49 @@ RS274XApertureBase::produce_flash (const db::DCplxTrans &d, RS274XReader &reader
     }
 
     m_needs_update = false;
+    m_flash_cache.clear ();
 
     mp_reader = 0;
     mp_ep = 0;
 
   }
 
+  //  The transformed flash geometry is kept per transformation without the displacement.
+  //  Repeated flashes (e.g. pads) of the same aperture only need to shift this geometry.
+  //  NOTE: shifting the cached geometry gives the same coordinates as the full transformation
+  //  because the displacement is added last there too. The output transformation and rounding
+  //  to database units happen in produce_polygon and produce_line as before.
   db::CplxTrans trans = d * db::CplxTrans (reader.dbu ());
+  db::DVector disp = trans.disp ();
+  trans.disp (db::DVector ());
+
+  std::map<db::CplxTrans, FlashGeometry>::iterator fg = m_flash_cache.find (trans);
+  if (fg == m_flash_cache.end ()) {
+
+    //  usually there are very few transformations per aperture - avoid excessive growth otherwise
+    const size_t max_cache_size = 16;
+    if (m_flash_cache.size () >= max_cache_size) {
+      m_flash_cache.clear ();
+    }
+
+    fg = m_flash_cache.insert (std::make_pair (trans, FlashGeometry ())).first;
+
+    fg->second.polygons.reserve (m_polygons.size ());
+    for (std::vector <db::Polygon>::const_iterator p = m_polygons.begin (); p != m_polygons.end (); ++p) {
+      fg->second.polygons.push_back (p->transformed (trans));
+    }
+    fg->second.lines.reserve (m_lines.size ());
+    for (std::vector <db::Path>::const_iterator p = m_lines.begin (); p != m_lines.end (); ++p) {
+      fg->second.lines.push_back (p->transformed (trans));
+    }
 
-  for (std::vector <db::Polygon>::const_iterator p = m_polygons.begin (); p != m_polygons.end (); ++p) {
-    reader.produce_polygon (p->transformed (trans), clear);
   }
-  for (std::vector <db::Path>::const_iterator p = m_lines.begin (); p != m_lines.end (); ++p) {
-    reader.produce_line (p->transformed (trans), clear);
+
+  for (std::vector <db::DPolygon>::const_iterator p = fg->second.polygons.begin (); p != fg->second.polygons.end (); ++p) {
+    reader.produce_polygon (p->moved (disp), clear);
+  }
+  for (std::vector <db::DPath>::const_iterator p = fg->second.lines.begin (); p != fg->second.lines.end (); ++p) {
+    reader.produce_line (p->moved (disp), clear);
   }
 }
 
@@ -32,6 +32,7 @@
 #include "tlStream.h"
 
 #include <vector>
+#include <map>
 
 namespace db
 {
@@ -70,6 +71,15 @@ protected:
   virtual bool do_produce_linear (const db::DPoint &from, const db::DPoint &to) = 0;
 
 private:
+  /**
+   *  @brief The flash geometry for one transformation
+   */
+  struct FlashGeometry
+  {
+    std::vector<db::DPolygon> polygons;
+    std::vector<db::DPath> lines;
+  };
+
   std::vector<db::Point> m_points;
   std::vector<db::Polygon> m_polygons;
   std::vector<db::Polygon> m_clear_polygons;
@@ -77,6 +87,7 @@ private:
   db::EdgeProcessor *mp_ep;
   RS274XReader *mp_reader;
   bool m_needs_update;
+  std::map<db::CplxTrans, FlashGeometry> m_flash_cache;
 };
 
 
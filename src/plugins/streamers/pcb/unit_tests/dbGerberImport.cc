@@ -30,8 +30,11 @@
 
 #include "tlUnitTest.h"
 #include "tlXMLParser.h"
+#include "tlStream.h"
+#include "tlFileUtils.h"
 
 #include <stdlib.h>
+#include <set>
 
 static void run_test (tl::TestBase *_this, const char *dir)
 {
@@ -376,3 +379,288 @@ TEST(X2_5b)
 {
   run_test (_this, "x2-5b");
 }
+
+static void write_text_file (const std::string &path, const std::string &text)
+{
+  tl::OutputStream stream (path);
+  stream << text;
+}
+
+static std::string make_copper_layer (int nx, int ny, bool clear)
+{
+  std::string s;
+  s += "G04 synthetic copper layer*\n";
+  s += "%FSLAX24Y24*%\n";
+  s += "%MOIN*%\n";
+  s += "%ADD10C,0.0100*%\n";
+  s += "%ADD11R,0.0600X0.0400*%\n";
+  s += "%ADD12C,0.0500X0.0200*%\n";
+  s += "%ADD13O,0.0800X0.0400*%\n";
+
+  s += "D11*\n";
+  for (int i = 0; i < nx; ++i) {
+    for (int j = 0; j < ny; ++j) {
+      s += "X" + tl::to_string (i * 1000) + "Y" + tl::to_string (j * 1000) + "D03*\n";
+    }
+  }
+
+  s += "D12*\n";
+  for (int i = 0; i < nx; ++i) {
+    s += "X" + tl::to_string (i * 1000 + 500) + "Y-2000D03*\n";
+  }
+
+  s += "%LR45*%\n";
+  s += "D13*\n";
+  for (int i = 0; i < nx; ++i) {
+    s += "X" + tl::to_string (i * 1000 + 500) + "Y-4000D03*\n";
+  }
+  s += "%LR0*%\n";
+
+  s += "%SRX2Y1I5.0J0*%\n";
+  s += "D10*\n";
+  s += "X0Y-6000D02*\n";
+  s += "X20000Y-6000D01*\n";
+  s += "X20000Y-8000D01*\n";
+  s += "%SR*%\n";
+
+  if (clear) {
+    s += "%LPC*%\n";
+    s += "D11*\n";
+    s += "X0Y0D03*\n";
+    s += "%LPD*%\n";
+  }
+
+  s += "M02*\n";
+  return s;
+}
+
+static std::string make_drill_file (int n, bool with_format)
+{
+  std::string s;
+  s += "M48\n";
+  s += with_format ? "INCH,TZ\n" : "INCH\n";
+  s += "T1C0.0300\n";
+  s += "T2C0.0120\n";
+  s += "%\n";
+  s += "T1\n";
+  for (int i = 0; i < n; ++i) {
+    s += "X" + tl::to_string (i * 1000) + "Y" + tl::to_string (500) + "\n";
+  }
+  s += "T2\n";
+  for (int i = 0; i < n; ++i) {
+    s += "X" + tl::to_string (i * 1000 + 500) + "Y" + tl::to_string (-500) + "\n";
+  }
+  s += "M30\n";
+  return s;
+}
+
+static void setup_synthetic_importer (tl::TestBase *_this, db::GerberImporter &importer, int nfiles)
+{
+  importer.set_dir (tl::absolute_path (_this->tmp_file ("layer0.gbr")));
+  importer.set_circle_points (16);
+
+  for (int i = 0; i < nfiles; ++i) {
+
+    std::string fn;
+
+    if (i % 4 == 3) {
+      //  drill files without format depend on the format of the file before
+      fn = "drill" + tl::to_string (i) + ".drl";
+      write_text_file (_this->tmp_file (fn), make_drill_file (20 + i, (i % 8) == 7));
+    } else {
+      fn = "layer" + tl::to_string (i) + ".gbr";
+      std::string data = make_copper_layer (10 + i, 5, (i % 2) == 0);
+      if (i % 4 == 2) {
+        //  a negative layer
+        data = "%IPNEG*%\n" + data;
+      }
+      write_text_file (_this->tmp_file (fn), data);
+    }
+
+    db::GerberFile file;
+    file.set_filename (fn);
+    file.add_layer_spec (db::LayerProperties (i + 1, 0));
+    if (i % 4 == 1) {
+      //  the same layer twice
+      file.add_layer_spec (db::LayerProperties (100, 0));
+    }
+    importer.add_file (file);
+
+  }
+}
+
+TEST(30_ParallelRead)
+{
+  db::Layout layout_seq, layout_par;
+
+  db::GerberImporter importer;
+  setup_synthetic_importer (_this, importer, 12);
+  importer.set_invert_negative_layers (true);
+  importer.set_merge (true);
+
+  importer.read (layout_seq);
+
+  importer.set_threads (4);
+  importer.read (layout_par);
+
+  EXPECT_EQ (db::compare_layouts (layout_seq, layout_par, db::layout_diff::f_verbose, 0), true);
+
+  //  all layers have been populated
+  const db::Cell &top = layout_par.cell (*layout_par.begin_top_down ());
+  for (db::Layout::layer_iterator l = layout_par.begin_layers (); l != layout_par.end_layers (); ++l) {
+    EXPECT_EQ (top.shapes ((*l).first).empty (), false);
+  }
+
+  //  a single file and more threads than files
+  db::GerberImporter importer1;
+  setup_synthetic_importer (_this, importer1, 1);
+
+  db::Layout layout_seq1, layout_par1;
+  importer1.read (layout_seq1);
+  importer1.set_threads (4);
+  importer1.read (layout_par1);
+
+  EXPECT_EQ (db::compare_layouts (layout_seq1, layout_par1, db::layout_diff::f_verbose, 0), true);
+}
+
+TEST(31_ParallelReadErrors)
+{
+  db::GerberImporter importer;
+  setup_synthetic_importer (_this, importer, 6);
+
+  db::GerberFile file;
+  file.set_filename ("does_not_exist.gbr");
+  file.add_layer_spec (db::LayerProperties (1, 0));
+  importer.add_file (file);
+
+  //  a file which cannot be read either - the first error is reported
+  write_text_file (_this->tmp_file ("garbage.gbr"), "G04 garbage*\n");
+  file.set_filename ("garbage.gbr");
+  importer.add_file (file);
+
+  std::string error_seq, error_par;
+
+  try {
+    db::Layout layout;
+    importer.read (layout);
+  } catch (tl::Exception &ex) {
+    error_seq = ex.msg ();
+  }
+
+  importer.set_threads (3);
+
+  try {
+    db::Layout layout;
+    importer.read (layout);
+  } catch (tl::Exception &ex) {
+    error_par = ex.msg ();
+  }
+
+  EXPECT_EQ (error_seq.empty (), false);
+  EXPECT_EQ (error_seq, error_par);
+}
+
+TEST(32_FlashGeometry)
+{
+  std::string s;
+  s += "%FSLAX24Y24*%\n";
+  s += "%MOIN*%\n";
+  s += "%ADD11R,0.0600X0.0400*%\n";
+  s += "D11*\n";
+  s += "X10000Y15000D03*\n";
+  s += "X20000Y15000D03*\n";
+  s += "%SRX2Y1I0.5J0*%\n";
+  s += "X10000Y25000D03*\n";
+  s += "%SR*%\n";
+  s += "%LR90*%\n";
+  s += "X10000Y35000D03*\n";
+  s += "M02*\n";
+  write_text_file (_this->tmp_file ("flash.gbr"), s);
+
+  db::GerberImporter importer;
+  importer.set_dir (tl::absolute_path (_this->tmp_file ("flash.gbr")));
+  db::GerberFile file;
+  file.set_filename ("flash.gbr");
+  file.add_layer_spec (db::LayerProperties (1, 0));
+  importer.add_file (file);
+
+  db::Layout layout;
+  db::cell_index_type ci = importer.read (layout);
+
+  //  1 inch is 25400000 database units
+  db::Box pad (-762000, -508000, 762000, 508000);
+  std::set<std::string> expected;
+  expected.insert (db::Polygon (pad.moved (db::Vector (25400000, 38100000))).to_string ());
+  expected.insert (db::Polygon (pad.moved (db::Vector (50800000, 38100000))).to_string ());
+  expected.insert (db::Polygon (pad.moved (db::Vector (25400000, 63500000))).to_string ());
+  expected.insert (db::Polygon (pad.moved (db::Vector (38100000, 63500000))).to_string ());
+  expected.insert (db::Polygon (db::Box (-508000, -762000, 508000, 762000).moved (db::Vector (25400000, 88900000))).to_string ());
+
+  std::set<std::string> produced;
+  for (db::ShapeIterator sh = layout.cell (ci).shapes (0).begin (db::ShapeIterator::All); ! sh.at_end (); ++sh) {
+    db::Polygon p;
+    sh->polygon (p);
+    produced.insert (p.to_string ());
+  }
+
+  EXPECT_EQ (tl::join (std::vector<std::string> (produced.begin (), produced.end ()), ";"), tl::join (std::vector<std::string> (expected.begin (), expected.end ()), ";"));
+}
+
+static std::set<std::string> read_flash_polygons (tl::TestBase *_this, const std::string &fn, const std::string &text)
+{
+  write_text_file (_this->tmp_file (fn), text);
+
+  db::GerberImporter importer;
+  importer.set_dir (tl::absolute_path (_this->tmp_file (fn)));
+  db::GerberFile file;
+  file.set_filename (fn);
+  file.add_layer_spec (db::LayerProperties (1, 0));
+  importer.add_file (file);
+
+  db::Layout layout;
+  db::cell_index_type ci = importer.read (layout);
+
+  std::set<std::string> produced;
+  for (db::ShapeIterator sh = layout.cell (ci).shapes (0).begin (db::ShapeIterator::All); ! sh.at_end (); ++sh) {
+    db::Polygon p;
+    sh->polygon (p);
+    produced.insert (p.to_string ());
+  }
+  return produced;
+}
+
+TEST(33_FlashGeometryRounding)
+{
+  //  Flashes drawn from the aperture's geometry cache need to give exactly the
+  //  same result as a flash drawn without a cache (first flash of a file)
+  std::string header;
+  header += "%FSLAX25Y25*%\n";
+  header += "%MOMM*%\n";
+  header += "%ADD12C,0.3333*%\n";
+  header += "%ADD13R,0.1111X0.7777*%\n";
+  header += "%LR33.3*%\n";
+
+  const char *flashes[] = {
+    "D12*\nX1234567Y7654321D03*\n",
+    "D12*\nX-333333Y1000001D03*\n",
+    "D12*\nX0Y77777D03*\n",
+    "D13*\nX1234567Y7654321D03*\n",
+    "D13*\nX-1Y-999999D03*\n",
+    "D13*\nX555555Y555555D03*\n"
+  };
+  const size_t n = sizeof (flashes) / sizeof (flashes [0]);
+
+  std::string all = header;
+  std::set<std::string> expected;
+  for (size_t i = 0; i < n; ++i) {
+    all += flashes [i];
+    std::set<std::string> single = read_flash_polygons (_this, "flash_single.gbr", header + flashes [i] + "M02*\n");
+    expected.insert (single.begin (), single.end ());
+  }
+  all += "M02*\n";
+
+  std::set<std::string> produced = read_flash_polygons (_this, "flash_all.gbr", all);
+
+  EXPECT_EQ (produced.size (), n);
+  EXPECT_EQ (tl::join (std::vector<std::string> (produced.begin (), produced.end ()), ";"), tl::join (std::vector<std::string> (expected.begin (), expected.end ()), ";"));
+}
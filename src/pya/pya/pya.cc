@@ -286,6 +286,9 @@ PythonInterpreter::PythonInterpreter (bool embedded)
 
   Py_InitializeEx (0 /*don't set signals*/);
 
+  //  creates the interpreter lock which is needed for methods running without it
+  PyEval_InitThreads ();
+
   //  Set dummy argv[]
   //  TODO: more?
   char *argv[1] = { make_string (app_path) };
@@ -316,6 +319,12 @@ PythonInterpreter::PythonInterpreter (bool embedded)
   PyImport_AppendInittab (pya_module_name, &init_pya_module);
   Py_InitializeEx (0 /*don't set signals*/);
 
+#if PY_VERSION_HEX < 0x03070000
+  //  creates the interpreter lock which is needed for methods running without it
+  //  (Python 3.7 and later do this in Py_Initialize)
+  PyEval_InitThreads ();
+#endif
+
   //  Set dummy argv[]
   //  TODO: more?
   wchar_t *argv[1] = { mp_py3_app_name };
@@ -223,6 +223,20 @@ std::vector<char> python2c_func<std::vector<char> >::operator() (PyObject *rval)
     char *cp = PyByteArray_AsString (rval);
     ssize_t sz = PyByteArray_Size (rval);
     return std::vector<char> (cp, cp + sz);
+#if PY_MAJOR_VERSION >= 3
+  } else if (PyObject_CheckBuffer (rval)) {
+    //  objects implementing the buffer protocol (e.g. array.array, memoryview or numpy arrays)
+    //  are taken as raw memory. PyBUF_ANY_CONTIGUOUS rejects strided views.
+    Py_buffer view;
+    if (PyObject_GetBuffer (rval, &view, PyBUF_ANY_CONTIGUOUS) != 0) {
+      check_error ();
+      throw tl::Exception (tl::to_string (tr ("Argument cannot be converted to a byte array")));
+    }
+    const char *cp = (const char *) view.buf;
+    std::vector<char> res (cp, cp + view.len);
+    PyBuffer_Release (&view);
+    return res;
+#endif
   } else {
     throw tl::Exception (tl::to_string (tr ("Argument cannot be converted to a byte array")));
   }
@@ -185,7 +185,21 @@ struct test_type_func<const char *>
 };
 
 template <> struct test_type_func<std::string> : public test_type_func<const char *> { };
-template <> struct test_type_func<std::vector<char> > : public test_type_func<const char *> { };
+
+//  byte arrays additionally accept objects implementing the buffer protocol
+template <>
+struct test_type_func<std::vector<char> >
+{
+  bool operator() (PyObject *rval, bool loose)
+  {
+#if PY_MAJOR_VERSION < 3
+    return test_type_func<const char *> () (rval, loose);
+#else
+    return test_type_func<const char *> () (rval, loose) || PyObject_CheckBuffer (rval);
+#endif
+  }
+};
+
 #if defined(HAVE_QT)
 template <> struct test_type_func<QString> : public test_type_func<const char *> { };
 template <> struct test_type_func<QByteArray> : public test_type_func<const char *> { };
@@ -37,13 +37,16 @@ namespace pya
 
 /**
  *  @brief An adaptor for a string from ruby objects
+ *
+ *  NOTE: the string is copied, so the adaptor does not keep a reference to the
+ *  Python object. This way it can be deleted without holding the interpreter lock.
  */
 class PythonBasedStringAdaptor
   : public gsi::StringAdaptor
 {
 public:
   PythonBasedStringAdaptor (const PythonPtr &string)
-    : m_stdstr (python2c<std::string> (string.get ())), m_string (string)
+    : m_stdstr (python2c<std::string> (string.get ()))
   {
     //  .. nothing yet ..
   }
@@ -66,7 +69,6 @@ public:
 
 private:
   std::string m_stdstr;
-  PythonPtr m_string;
 };
 
 /**
@@ -77,7 +79,7 @@ class PythonBasedByteArrayAdaptor
 {
 public:
   PythonBasedByteArrayAdaptor (const PythonPtr &ba)
-    : m_bytearray (python2c<std::vector<char> > (ba.get ())), m_bytes (ba)
+    : m_bytearray (python2c<std::vector<char> > (ba.get ()))
   {
     //  .. nothing yet ..
   }
@@ -100,7 +102,6 @@ public:
 
 private:
   std::vector<char> m_bytearray;
-  PythonPtr m_bytes;
 };
 
 /**
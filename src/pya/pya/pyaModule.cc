@@ -51,6 +51,52 @@ class MethodTableEntry
 public:
   typedef std::vector<const gsi::MethodBase *>::const_iterator method_iterator;
 
+  struct MethodVariantKey
+  {
+    MethodVariantKey (PyObject *args, bool is_static, bool is_const)
+      : m_is_static (is_static), m_is_const (is_const)
+    {
+      int argc = args == NULL ? 0 : int (PyTuple_Size (args));
+      m_argtypes.reserve (size_t (argc));
+      for (int i = 0; i < argc; ++i) {
+        PyObject *arg = PyTuple_GetItem (args, i);
+        //  const references to objects don't match non-const reference arguments, hence
+        //  the constness of the argument is part of the key
+        size_t t = size_t (Py_TYPE (arg)) << 1;
+        if (PythonModule::cls_for_type (Py_TYPE (arg)) && PYAObjectBase::from_pyobject (arg)->const_ref ()) {
+          t |= 1;
+        }
+        m_argtypes.push_back (t);
+      }
+    }
+
+    bool operator== (const MethodVariantKey &other) const
+    {
+      return m_argtypes == other.m_argtypes &&
+             m_is_static == other.m_is_static &&
+             m_is_const == other.m_is_const;
+    }
+
+    bool operator< (const MethodVariantKey &other) const
+    {
+      if (m_argtypes != other.m_argtypes) {
+        return m_argtypes < other.m_argtypes;
+      }
+      if (m_is_static != other.m_is_static) {
+        return m_is_static < other.m_is_static;
+      }
+      if (m_is_const != other.m_is_const) {
+        return m_is_const < other.m_is_const;
+      }
+      return false;
+    }
+
+  private:
+    std::vector<size_t> m_argtypes;
+    bool m_is_static;
+    bool m_is_const;
+  };
+
   MethodTableEntry (const std::string &name, bool st, bool prot)
     : m_name (name), m_is_static (st), m_is_protected (prot)
   { }
@@ -73,6 +119,8 @@ public:
   void add (const gsi::MethodBase *m)
   {
     m_methods.push_back (m);
+    //  the resolved variants may change with the new method
+    m_variants.clear ();
   }
 
   void finish ()
@@ -81,6 +129,7 @@ public:
     std::vector<const gsi::MethodBase *> m = m_methods;
     std::sort(m.begin (), m.end ());
     m_methods.assign (m.begin (), std::unique (m.begin (), m.end ()));
+    m_variants.clear ();
   }
 
   method_iterator begin () const
@@ -93,11 +142,170 @@ public:
     return m_methods.end ();
   }
 
+  const gsi::MethodBase *get_variant (PyObject *args, bool is_static, bool is_const, bool strict) const
+  {
+    //  caching can't work for tuples, lists or dicts - in this case, give up
+
+    int argc = args == NULL ? 0 : int (PyTuple_Size (args));
+    for (int i = 0; i < argc; ++i) {
+      PyObject *arg = PyTuple_GetItem (args, i);
+      if (PyTuple_Check (arg) || PyList_Check (arg) || PyDict_Check (arg)) {
+        return find_variant (args, is_static, is_const, strict);
+      }
+    }
+
+    //  try to find the variant in the cache
+
+    MethodVariantKey key (args, is_static, is_const);
+    std::map<MethodVariantKey, const gsi::MethodBase *>::const_iterator v = m_variants.find (key);
+    if (v != m_variants.end ()) {
+      return v->second;
+    }
+
+    const gsi::MethodBase *meth = find_variant (args, is_static, is_const, strict);
+    if (meth) {
+      m_variants[key] = meth;
+    }
+    return meth;
+  }
+
 private:
+  const gsi::MethodBase *find_variant (PyObject *args, bool is_static, bool is_const, bool strict) const
+  {
+    int argc = args == NULL ? 0 : int (PyTuple_Size (args));
+
+    //  get number of candidates by argument count
+    const gsi::MethodBase *meth = 0;
+    unsigned int candidates = 0;
+
+    for (MethodTableEntry::method_iterator m = begin (); m != end (); ++m) {
+
+      if ((*m)->is_callback()) {
+
+        //  ignore callbacks
+
+      } else if ((*m)->compatible_with_num_args (argc)) {
+
+        ++candidates;
+        meth = *m;
+
+      }
+
+    }
+
+    //  no candidate -> error
+    if (! meth) {
+
+      if (! strict) {
+        return 0;
+      }
+
+      std::set<unsigned int> nargs;
+      for (MethodTableEntry::method_iterator m = begin (); m != end (); ++m) {
+        if (! (*m)->is_callback ()) {
+          nargs.insert (std::distance ((*m)->begin_arguments (), (*m)->end_arguments ()));
+        }
+      }
+
+      std::string nargs_s;
+      for (std::set<unsigned int>::const_iterator na = nargs.begin (); na != nargs.end (); ++na) {
+        if (na != nargs.begin ()) {
+          nargs_s += "/";
+        }
+        nargs_s += tl::to_string (*na);
+      }
+
+      throw tl::Exception (tl::sprintf (tl::to_string (tr ("Invalid number of arguments (got %d, expected %s)")), argc, nargs_s));
+
+    }
+
+    //  more than one candidate -> refine by checking the arguments
+    if (candidates > 1) {
+
+      meth = 0;
+      candidates = 0;
+      int score = 0;
+      bool const_matching = true;
+
+      for (MethodTableEntry::method_iterator m = begin (); m != end (); ++m) {
+
+        if (! (*m)->is_callback ()) {
+
+          //  check arguments (count and type)
+          bool is_valid = (*m)->compatible_with_num_args (argc);
+          int sc = 0;
+          int i = 0;
+          for (gsi::MethodBase::argument_iterator a = (*m)->begin_arguments (); is_valid && i < argc && a != (*m)->end_arguments (); ++a, ++i) {
+            if (test_arg (*a, PyTuple_GetItem (args, i), false /*strict*/)) {
+              ++sc;
+            } else if (test_arg (*a, PyTuple_GetItem (args, i), true /*loose*/)) {
+              //  non-scoring match
+            } else {
+              is_valid = false;
+            }
+          }
+
+          if (is_valid && ! is_static) {
+
+            //  constness matching candidates have precedence
+            if ((*m)->is_const () != is_const) {
+              if (const_matching && candidates > 0) {
+                is_valid = false;
+              } else {
+                const_matching = false;
+              }
+            } else if (! const_matching) {
+              const_matching = true;
+              candidates = 0;
+            }
+
+          }
+
+          if (is_valid) {
+
+            //  otherwise take the candidate with the better score
+            if (candidates > 0 && sc > score) {
+              candidates = 1;
+              meth = *m;
+              score = sc;
+            } else if (candidates == 0 || sc == score) {
+              ++candidates;
+              meth = *m;
+              score = sc;
+            }
+
+          }
+
+        }
+
+      }
+
+    }
+
+    if (! meth) {
+      if (! strict) {
+        return 0;
+      } else {
+        throw tl::Exception (tl::to_string (tr ("No overload with matching arguments")));
+      }
+    }
+
+    if (candidates > 1) {
+      if (! strict) {
+        return 0;
+      } else {
+        throw tl::Exception (tl::to_string (tr ("Ambiguous overload variants - multiple method declarations match arguments")));
+      }
+    }
+
+    return meth;
+  }
+
   std::string m_name;
   bool m_is_static : 1;
   bool m_is_protected : 1;
   std::vector<const gsi::MethodBase *> m_methods;
+  mutable std::map<MethodVariantKey, const gsi::MethodBase *> m_variants;
 };
 
 /**
@@ -319,6 +527,14 @@ public:
     return m_property_table[mid - m_property_offset].second.end ();
   }
 
+  /**
+   *  @brief Gets the method table entry for method ID mid
+   */
+  const MethodTableEntry &entry (size_t mid) const
+  {
+    return m_table[mid - m_method_offset];
+  }
+
   /**
    *  @brief Begins iteration of the overload variants for method ID mid
    */
@@ -735,12 +951,6 @@ match_method (int mid, PyObject *self, PyObject *args, bool strict)
 
   tl_assert (cls_decl != 0);
 
-  int argc = args == NULL ? 0 : int (PyTuple_Size (args));
-
-  //  get number of candidates by argument count
-  const gsi::MethodBase *meth = 0;
-  unsigned int candidates = 0;
-
   const MethodTable *mt = MethodTable::method_table_by_class (cls_decl);
   tl_assert (mt);
 
@@ -754,127 +964,7 @@ match_method (int mid, PyObject *self, PyObject *args, bool strict)
 
   }
 
-  for (MethodTableEntry::method_iterator m = mt->begin (mid); m != mt->end (mid); ++m) {
-
-    if ((*m)->is_callback()) {
-
-      //  ignore callbacks
-
-    } else if ((*m)->compatible_with_num_args (argc)) {
-
-      ++candidates;
-      meth = *m;
-
-    }
-
-  }
-
-  //  no candidate -> error
-  if (! meth) {
-
-    if (! strict) {
-      return 0;
-    }
-
-    std::set<unsigned int> nargs;
-    for (MethodTableEntry::method_iterator m = mt->begin (mid); m != mt->end (mid); ++m) {
-      if (! (*m)->is_callback ()) {
-        nargs.insert (std::distance ((*m)->begin_arguments (), (*m)->end_arguments ()));
-      }
-    }
-
-    std::string nargs_s;
-    for (std::set<unsigned int>::const_iterator na = nargs.begin (); na != nargs.end (); ++na) {
-      if (na != nargs.begin ()) {
-        nargs_s += "/";
-      }
-      nargs_s += tl::to_string (*na);
-    }
-
-    throw tl::Exception (tl::sprintf (tl::to_string (tr ("Invalid number of arguments (got %d, expected %s)")), argc, nargs_s));
-
-  }
-
-  //  more than one candidate -> refine by checking the arguments
-  if (candidates > 1) {
-
-    meth = 0;
-    candidates = 0;
-    int score = 0;
-    bool const_matching = true;
-
-    for (MethodTableEntry::method_iterator m = mt->begin (mid); m != mt->end (mid); ++m) {
-
-      if (! (*m)->is_callback ()) {
-
-        //  check arguments (count and type)
-        bool is_valid = (*m)->compatible_with_num_args (argc);
-        int sc = 0;
-        int i = 0;
-        for (gsi::MethodBase::argument_iterator a = (*m)->begin_arguments (); is_valid && i < argc && a != (*m)->end_arguments (); ++a, ++i) {
-          if (test_arg (*a, PyTuple_GetItem (args, i), false /*strict*/)) {
-            ++sc;
-          } else if (test_arg (*a, PyTuple_GetItem (args, i), true /*loose*/)) {
-            //  non-scoring match
-          } else {
-            is_valid = false;
-          }
-        }
-
-        if (is_valid && p) {
-
-          //  constness matching candidates have precedence
-          if ((*m)->is_const () != p->const_ref ()) {
-            if (const_matching && candidates > 0) {
-              is_valid = false;
-            } else {
-              const_matching = false;
-            }
-          } else if (! const_matching) {
-            const_matching = true;
-            candidates = 0;
-          }
-
-        }
-
-        if (is_valid) {
-
-          //  otherwise take the candidate with the better score
-          if (candidates > 0 && sc > score) {
-            candidates = 1;
-            meth = *m;
-            score = sc;
-          } else if (candidates == 0 || sc == score) {
-            ++candidates;
-            meth = *m;
-            score = sc;
-          }
-
-        }
-
-      }
-
-    }
-
-  }
-
-  if (! meth) {
-    if (! strict) {
-      return 0;
-    } else {
-      throw tl::Exception (tl::to_string (tr ("No overload with matching arguments")));
-    }
-  }
-
-  if (candidates > 1) {
-    if (! strict) {
-      return 0;
-    } else {
-      throw tl::Exception (tl::to_string (tr ("Ambiguous overload variants - multiple method declarations match arguments")));
-    }
-  }
-
-  return meth;
+  return mt->entry (mid).get_variant (args, p == 0, p != 0 && p->const_ref (), strict);
 }
 
 /**
@@ -1095,6 +1185,31 @@ object_is_const (PyObject *self, PyObject *args)
   return c2python (PYAObjectBase::from_pyobject (self)->const_ref ());
 }
 
+/**
+ *  @brief Calls a gsi method, releasing the interpreter lock if possible
+ *
+ *  The lock is released for methods declared with "allow_threads" only. Variant, vector and
+ *  map arguments are read from the Python objects while the method executes, so methods
+ *  with such arguments keep the lock.
+ */
+static void
+call_method (const gsi::MethodBase *meth, void *obj, gsi::SerialArgs &arglist, gsi::SerialArgs &retlist)
+{
+  bool allow_threads = meth->allow_threads ();
+  for (gsi::MethodBase::argument_iterator a = meth->begin_arguments (); allow_threads && a != meth->end_arguments (); ++a) {
+    if (a->type () == gsi::T_var || a->type () == gsi::T_vector || a->type () == gsi::T_map) {
+      allow_threads = false;
+    }
+  }
+
+  if (allow_threads) {
+    PythonAllowThreads nolock;
+    meth->call (obj, arglist, retlist);
+  } else {
+    meth->call (obj, arglist, retlist);
+  }
+}
+
 static PyObject *
 special_method_impl (gsi::MethodBase::special_method_type smt, PyObject *self, PyObject *args)
 {
@@ -1177,7 +1292,7 @@ method_adaptor (int mid, PyObject *self, PyObject *args)
 
       }
 
-      meth->call (obj, arglist, retlist);
+      call_method (meth, obj, arglist, retlist);
 
       ret = get_return_value (p, retlist, meth, heap);
 
@@ -1728,7 +1843,7 @@ method_init_adaptor (int mid, PyObject *self, PyObject *args)
 
       }
 
-      meth->call (0, arglist, retlist);
+      call_method (meth, 0, arglist, retlist);
 
       void *obj = retlist.read<void *> (heap);
       if (obj) {
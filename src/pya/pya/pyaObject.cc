@@ -122,6 +122,9 @@ Callee::can_call () const
 void 
 Callee::call (int id, gsi::SerialArgs &args, gsi::SerialArgs &ret) const
 {
+  //  the callback may come from a method running without the interpreter lock
+  PythonGILLock locker;
+
   const gsi::MethodBase *meth = m_cbfuncs [id].method ();
 
   try {
@@ -123,6 +123,9 @@ SignalHandler::~SignalHandler ()
 
 void SignalHandler::call (const gsi::MethodBase *meth, gsi::SerialArgs &args, gsi::SerialArgs &ret) const
 {
+  //  the event may come from a method running without the interpreter lock
+  PythonGILLock locker;
+
   PYTHON_BEGIN_EXEC
 
     tl::Heap heap;
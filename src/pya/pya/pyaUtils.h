@@ -70,6 +70,62 @@ namespace pya
  */
 void check_error ();
 
+/**
+ *  @brief Releases the Python interpreter lock while this object is alive
+ *
+ *  Use this object around C++ code that does not access Python objects.
+ *  Other Python threads can run while the lock is released.
+ */
+class PythonAllowThreads
+{
+public:
+  PythonAllowThreads ()
+    : mp_state (PyEval_SaveThread ())
+  {
+    //  .. nothing yet ..
+  }
+
+  ~PythonAllowThreads ()
+  {
+    PyEval_RestoreThread (mp_state);
+  }
+
+private:
+  PyThreadState *mp_state;
+
+  PythonAllowThreads (const PythonAllowThreads &);
+  PythonAllowThreads &operator= (const PythonAllowThreads &);
+};
+
+/**
+ *  @brief Acquires the Python interpreter lock while this object is alive
+ *
+ *  Code entering Python from C++ callbacks needs to hold this object as
+ *  the callback may originate from a method running without the lock
+ *  (see PythonAllowThreads). If the lock is already held by the current
+ *  thread, this object does nothing.
+ */
+class PythonGILLock
+{
+public:
+  PythonGILLock ()
+    : m_state (PyGILState_Ensure ())
+  {
+    //  .. nothing yet ..
+  }
+
+  ~PythonGILLock ()
+  {
+    PyGILState_Release (m_state);
+  }
+
+private:
+  PyGILState_STATE m_state;
+
+  PythonGILLock (const PythonGILLock &);
+  PythonGILLock &operator= (const PythonGILLock &);
+};
+
 }
 
 #endif
@@ -111,5 +111,12 @@ PYTHONTEST (tlTest, "tlTest.py")
 PYTHONTEST (qtbinding, "qtbinding.py")
 #endif
 
+//  a benchmark - runs in slow mode only
+TEST(dispatchBenchmark)
+{
+  test_is_long_runner ();
+  run_pythontest (_this, "dispatchBenchmark.py");
+}
+
 #endif
 
@@ -45,6 +45,12 @@ module_init (const char *pymod_name, const char *mod_name, const char *mod_descr
 
   PYA_TRY
   
+#if PY_VERSION_HEX < 0x03070000
+    //  creates the interpreter lock which is needed for methods running without it
+    //  (Python 3.7 and later do this in Py_Initialize)
+    PyEval_InitThreads ();
+#endif
+
     gsi::initialize ();
 
     //  required for the tiling processor for example
@@ -149,5 +149,12 @@ RUBYTEST (qtbinding, "qtbinding.rb")
 RUBYTEST (rdbTest, "rdbTest.rb")
 RUBYTEST (tlTest, "tlTest.rb")
 
+//  a benchmark - runs in slow mode only
+TEST(dispatchBenchmark)
+{
+  test_is_long_runner ();
+  run_rubytest (_this, "dispatchBenchmark.rb");
+}
+
 #endif
 
@@ -1368,7 +1368,12 @@ Class<rdb::Database> decl_ReportDatabase ("rdb", "ReportDatabase",
   gsi::method ("save", &rdb::Database::save, gsi::arg ("filename"),
     "@brief Saves the database to the given file\n"
     "@param filename The file to which to save the database\n"
-    "The database is always saved in KLayout's XML-based format.\n"
+    "The database is saved in KLayout's XML-based format, unless the file name has the '.lyrdbb' extension. "
+    "In that case, the database is saved in KLayout's binary report database format. This format is faster to read and write "
+    "than the XML format. When \\load reads an uncompressed binary file, it takes the item counts from the file's index and "
+    "loads the items on demand.\n"
+    "\n"
+    "The binary format has been added in version 0.27.\n"
   ),
   "@brief The report database object\n"
   "A report database is organised around a set of items which are associated with cells and categories. "
@@ -23,6 +23,7 @@
 
 #include "rdb.h"
 #include "rdbReader.h"
+#include "rdbBinaryFile.h"
 #include "tlString.h"
 #include "tlAssert.h"
 #include "tlStream.h"
@@ -998,7 +999,7 @@ Item::set_image_str (const std::string &s)
 //  Database implementation
 
 Database::Database ()
-  : m_next_id (0), m_num_items (0), m_num_items_visited (0), m_modified (true)
+  : m_next_id (0), mp_binary_file (0), m_num_items (0), m_num_items_visited (0), m_modified (true)
 {
   m_cells.set_database (this);
 
@@ -1011,6 +1012,9 @@ Database::Database ()
 
 Database::~Database ()
 {
+  delete mp_binary_file;
+  mp_binary_file = 0;
+
   m_items_by_cell_id.clear ();
   m_items_by_cell_and_category_id.clear ();
   m_items_by_category_id.clear ();
@@ -1385,6 +1389,34 @@ Database::create_item (id_type cell_id, id_type category_id)
     category = category->parent ();
   }
 
+  return create_registered_item (cell_id, category_id);
+}
+
+void
+Database::register_items (id_type cell_id, id_type category_id, size_t n, size_t n_visited)
+{
+  m_num_items += n;
+  m_num_items_visited += n_visited;
+
+  Cell *cell = cell_by_id_non_const (cell_id);
+  tl_assert (cell != 0);
+
+  cell->m_num_items += n;
+  cell->m_num_items_visited += n_visited;
+
+  Category *category = category_by_id_non_const (category_id);
+  while (category != 0) {
+    category->m_num_items += n;
+    category->m_num_items_visited += n_visited;
+    m_num_items_by_cell_and_category.insert (std::make_pair (std::make_pair (cell_id, category->id ()), 0)).first->second += n;
+    m_num_items_visited_by_cell_and_category.insert (std::make_pair (std::make_pair (cell_id, category->id ()), 0)).first->second += n_visited;
+    category = category->parent ();
+  }
+}
+
+Item *
+Database::create_registered_item (id_type cell_id, id_type category_id)
+{
   mp_items->add_item (Item ());
   Item *item = &mp_items->back ();
   item->set_cell_id (cell_id);
@@ -1402,6 +1434,8 @@ static std::list<ItemRef> empty_list;
 std::pair<Database::const_item_ref_iterator, Database::const_item_ref_iterator> 
 Database::items_by_cell_and_category (id_type cell_id, id_type category_id) const
 {
+  load_items (cell_id, category_id);
+
   std::map <std::pair <id_type, id_type>, std::list<ItemRef> >::const_iterator i = m_items_by_cell_and_category_id.find (std::make_pair (cell_id, category_id));
   if (i != m_items_by_cell_and_category_id.end ()) {
     return std::make_pair (i->second.begin (), i->second.end ());
@@ -1413,6 +1447,8 @@ Database::items_by_cell_and_category (id_type cell_id, id_type category_id) cons
 std::pair<Database::const_item_ref_iterator, Database::const_item_ref_iterator> 
 Database::items_by_cell (id_type cell_id) const
 {
+  load_items (cell_id, 0);
+
   std::map <id_type, std::list<ItemRef> >::const_iterator i = m_items_by_cell_id.find (cell_id);
   if (i != m_items_by_cell_id.end ()) {
     return std::make_pair (i->second.begin (), i->second.end ());
@@ -1424,6 +1460,8 @@ Database::items_by_cell (id_type cell_id) const
 std::pair<Database::const_item_ref_iterator, Database::const_item_ref_iterator> 
 Database::items_by_category (id_type category_id) const
 {
+  load_items (0, category_id);
+
   std::map <id_type, std::list<ItemRef> >::const_iterator i = m_items_by_category_id.find (category_id);
   if (i != m_items_by_category_id.end ()) {
     return std::make_pair (i->second.begin (), i->second.end ());
@@ -1443,6 +1481,24 @@ Database::num_items (id_type cell_id, id_type category_id) const
   }
 }
 
+size_t
+Database::num_loaded_items () const
+{
+  if (mp_binary_file) {
+    return m_num_items - mp_binary_file->num_items () + mp_binary_file->num_loaded_items ();
+  } else {
+    return m_num_items;
+  }
+}
+
+void
+Database::load_items (id_type cell_id, id_type category_id) const
+{
+  if (mp_binary_file) {
+    mp_binary_file->load_items_on_demand (cell_id, category_id);
+  }
+}
+
 size_t 
 Database::num_items_visited (id_type cell_id, id_type category_id) const
 {
@@ -1479,6 +1535,9 @@ Database::clear ()
   m_num_items = 0;
   m_num_items_visited = 0;
 
+  delete mp_binary_file;
+  mp_binary_file = 0;
+
   delete mp_items;
   mp_items = new Items ();
   mp_items->set_database (this);
@@ -1493,14 +1552,24 @@ Database::load (const std::string &fn)
 {
   tl::log << "Loading RDB from " << fn;
 
-  tl::InputStream stream (fn);
-  rdb::Reader reader (stream);
+  if (BinaryDatabaseFile::can_open (fn)) {
 
-  clear ();
-  reader.read (*this);
+    //  binary files deliver the items on demand
+    clear ();
+    mp_binary_file = new BinaryDatabaseFile (fn, *this);
+
+  } else {
 
-  set_filename (stream.absolute_path ());
-  set_name (stream.filename ());
+    tl::InputStream stream (fn);
+    rdb::Reader reader (stream);
+
+    clear ();
+    reader.read (*this);
+
+    set_filename (stream.absolute_path ());
+    set_name (stream.filename ());
+
+  }
 
   reset_modified ();
 
@@ -62,6 +62,7 @@ class Database;
 class Cells;
 class Cell;
 class Items;
+class BinaryDatabaseFile;
 
 /**
  *  @brief A report item's category
@@ -2197,11 +2198,36 @@ public:
    */
   size_t num_items_visited (id_type cell_id, id_type category_id) const;
 
+  /**
+   *  @brief Report the number of items present in memory
+   *
+   *  Databases loaded from binary files load their items on demand. For these, this
+   *  number may be less than the total number of items.
+   */
+  size_t num_loaded_items () const;
+
   /**
    *  @brief Create a new item for the given cell and category (both given by id)
    */
   Item *create_item (id_type cell_id, id_type category_id);
 
+  /**
+   *  @brief Registers items which are not loaded yet
+   *
+   *  This method is provided for persistency application only. It should not be used otherwise.
+   *  The item counts are updated as if "n" items, "n_visited" of them visited, had been created
+   *  for the given cell and category. The items need to be created with "create_registered_item" later.
+   */
+  void register_items (id_type cell_id, id_type category_id, size_t n, size_t n_visited);
+
+  /**
+   *  @brief Creates an item registered with "register_items" before
+   *
+   *  This method is provided for persistency application only. It should not be used otherwise.
+   *  The item counts are not changed. The visited flag needs to be set with Item::set_visited.
+   */
+  Item *create_registered_item (id_type cell_id, id_type category_id);
+
   /**
    *  @brief Set a tag's description
    */
@@ -2236,9 +2262,12 @@ public:
 
   /**
    *  @brief Get the items collection (const version)
+   *
+   *  For databases loaded from binary files, this method loads all items.
    */
   const Items &items () const
   {
+    load_items (0, 0);
     return *mp_items;
   }
 
@@ -2252,6 +2281,9 @@ public:
 
   /**
    *  @brief Get an iterator pair that delivers the const items (ItemRef) for a given cell
+   *
+   *  For databases loaded from binary files, this method and the other "items_by_..." methods
+   *  load the items they deliver on demand.
    */
   std::pair<const_item_ref_iterator, const_item_ref_iterator> items_by_cell (id_type cell_id) const; 
 
@@ -2290,10 +2322,26 @@ public:
    *  @brief Load the database from a file
    *
    *  @brief This clears the existing database.
+   *
+   *  Uncompressed binary files are opened for on-demand loading: the item counts
+   *  are taken from the file's block index and the items are loaded when they are
+   *  asked for.
    */
   void load (const std::string &filename);
 
+  /**
+   *  @brief Gets the binary file the items are loaded from on demand
+   *
+   *  This method returns 0 if the database was not loaded from a binary file.
+   */
+  BinaryDatabaseFile *binary_file () const
+  {
+    return mp_binary_file;
+  }
+
 private:
+  friend class BinaryDatabaseFile;
+
   std::string m_generator;
   std::string m_filename;
   std::string m_description;
@@ -2313,12 +2361,14 @@ private:
   std::map <id_type, std::list<ItemRef> > m_items_by_cell_id;
   std::map <id_type, std::list<ItemRef> > m_items_by_category_id;
   Items *mp_items;
+  BinaryDatabaseFile *mp_binary_file;
   Cells m_cells;
   size_t m_num_items;
   size_t m_num_items_visited;
   bool m_modified;
 
   void clear ();
+  void load_items (id_type cell_id, id_type category_id) const;
 
   void set_modified () 
   {
@@ -13,6 +13,7 @@ RESOURCES = \
 SOURCES = \
   gsiDeclRdb.cc \
   rdb.cc \
+  rdbBinaryFile.cc \
   rdbForceLink.cc \
   rdbFile.cc \
   rdbReader.cc \
@@ -22,6 +23,7 @@ SOURCES = \
 
 HEADERS = \
   rdb.h \
+  rdbBinaryFile.h \
   rdbForceLink.h \
   rdbReader.h \
   rdbTiledRdbOutputReceiver.h \
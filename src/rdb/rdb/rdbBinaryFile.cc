@@ -0,0 +1,1213 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "rdbBinaryFile.h"
+#include "rdbReader.h"
+
+#include "dbPolygon.h"
+#include "dbPath.h"
+#include "dbText.h"
+#include "dbEdge.h"
+#include "dbEdgePair.h"
+#include "tlTimer.h"
+#include "tlLog.h"
+#include "tlClassRegistry.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+
+namespace rdb
+{
+
+//  The file layout is:
+//
+//    magic ("KLayout-RDB-binary\0"), version
+//    header: description, original file, generator, top cell, tags, categories, cells
+//    number of blocks, blocks: cell id, category id, number of items, items
+//    index: number of blocks, per block: cell id, category id, number of items, number of visited items,
+//           flags, bbox, offset, size
+//    position of the index (8 bytes, little endian)
+//
+//  Unsigned integers are stored as variable-length integers with 7 bits per byte,
+//  least significant group first. Doubles are stored as IEEE 8-byte little endian values.
+//  Ids are the ones of the database the file was written from.
+//
+//  Version 1 files have no visited counts in the index. They are read completely.
+
+static const char binary_magic [] = "KLayout-RDB-binary";
+static const unsigned int binary_version = 2;
+static const unsigned int block_flag_non_geometric = 1;
+
+static const char *binary_file_format = "KLayout binary RDB files (*.lyrdbb)";
+
+// -------------------------------------------------------------
+//  Binary writer and reader utilities
+
+namespace
+{
+
+class BinaryWriter
+{
+public:
+  BinaryWriter (tl::OutputStream &os)
+    : m_os (os), m_pos (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  void put_bytes (const char *b, size_t n)
+  {
+    m_os.put (b, n);
+    m_pos += n;
+  }
+
+  void put_byte (unsigned char b)
+  {
+    char c = char (b);
+    put_bytes (&c, 1);
+  }
+
+  void put_uint (uint64_t v)
+  {
+    do {
+      unsigned char b = (unsigned char) (v & 0x7f);
+      v >>= 7;
+      if (v) {
+        b |= 0x80;
+      }
+      put_byte (b);
+    } while (v);
+  }
+
+  void put_fixed (uint64_t u)
+  {
+    char b [8];
+    for (unsigned int i = 0; i < 8; ++i) {
+      b [i] = char ((u >> (8 * i)) & 0xff);
+    }
+    put_bytes (b, 8);
+  }
+
+  void put_double (double d)
+  {
+    uint64_t u;
+    memcpy (&u, &d, sizeof (u));
+    put_fixed (u);
+  }
+
+  void put_string (const std::string &s)
+  {
+    put_uint (s.size ());
+    put_bytes (s.c_str (), s.size ());
+  }
+
+  void put_point (const db::DPoint &p)
+  {
+    put_double (p.x ());
+    put_double (p.y ());
+  }
+
+  void put_edge (const db::DEdge &e)
+  {
+    put_point (e.p1 ());
+    put_point (e.p2 ());
+  }
+
+  void put_box (const db::DBox &b)
+  {
+    //  empty boxes are written as (1,1;-1,-1)
+    if (b.empty ()) {
+      put_point (db::DPoint (1.0, 1.0));
+      put_point (db::DPoint (-1.0, -1.0));
+    } else {
+      put_point (b.p1 ());
+      put_point (b.p2 ());
+    }
+  }
+
+  template <class Iter>
+  void put_points (Iter from, Iter to, size_t n)
+  {
+    put_uint (n);
+    for (Iter p = from; p != to; ++p) {
+      put_point (*p);
+    }
+  }
+
+  size_t pos () const
+  {
+    return m_pos;
+  }
+
+private:
+  tl::OutputStream &m_os;
+  size_t m_pos;
+};
+
+class BinaryReader
+{
+public:
+  BinaryReader (tl::InputStream &is)
+    : m_is (is)
+  {
+    //  .. nothing yet ..
+  }
+
+  const char *get_bytes (size_t n)
+  {
+    const char *b = m_is.get (n);
+    if (! b) {
+      throw ReaderException (tl::to_string (tr ("Unexpected end of file in binary RDB file")));
+    }
+    return b;
+  }
+
+  unsigned char get_byte ()
+  {
+    return (unsigned char) *get_bytes (1);
+  }
+
+  uint64_t get_uint ()
+  {
+    uint64_t v = 0;
+    unsigned int s = 0;
+    unsigned char b;
+    do {
+      if (s > 63) {
+        throw ReaderException (tl::to_string (tr ("Integer overflow in binary RDB file")));
+      }
+      b = get_byte ();
+      v |= uint64_t (b & 0x7f) << s;
+      s += 7;
+    } while ((b & 0x80) != 0);
+    return v;
+  }
+
+  size_t get_size ()
+  {
+    return size_t (get_uint ());
+  }
+
+  uint64_t get_fixed ()
+  {
+    const char *b = get_bytes (8);
+    uint64_t u = 0;
+    for (unsigned int i = 0; i < 8; ++i) {
+      u |= uint64_t ((unsigned char) b [i]) << (8 * i);
+    }
+    return u;
+  }
+
+  double get_double ()
+  {
+    uint64_t u = get_fixed ();
+    double d;
+    memcpy (&d, &u, sizeof (d));
+    return d;
+  }
+
+  std::string get_string ()
+  {
+    size_t n = get_size ();
+    if (n == 0) {
+      return std::string ();
+    }
+    const char *b = get_bytes (n);
+    return std::string (b, n);
+  }
+
+  db::DPoint get_point ()
+  {
+    double x = get_double ();
+    double y = get_double ();
+    return db::DPoint (x, y);
+  }
+
+  db::DEdge get_edge ()
+  {
+    db::DPoint p1 = get_point ();
+    db::DPoint p2 = get_point ();
+    return db::DEdge (p1, p2);
+  }
+
+  db::DBox get_box ()
+  {
+    db::DPoint p1 = get_point ();
+    db::DPoint p2 = get_point ();
+    if (p1.x () > p2.x () || p1.y () > p2.y ()) {
+      return db::DBox ();
+    } else {
+      return db::DBox (p1, p2);
+    }
+  }
+
+  void get_points (std::vector<db::DPoint> &pts)
+  {
+    size_t n = get_size ();
+    pts.clear ();
+    pts.reserve (n);
+    for (size_t i = 0; i < n; ++i) {
+      pts.push_back (get_point ());
+    }
+  }
+
+private:
+  tl::InputStream &m_is;
+};
+
+}
+
+// -------------------------------------------------------------
+//  Value serialization
+
+static db::DBox
+value_bbox (const ValueBase *v)
+{
+  if (const Value<db::DPolygon> *p = dynamic_cast<const Value<db::DPolygon> *> (v)) {
+    return p->value ().box ();
+  } else if (const Value<db::DBox> *b = dynamic_cast<const Value<db::DBox> *> (v)) {
+    return b->value ();
+  } else if (const Value<db::DEdge> *e = dynamic_cast<const Value<db::DEdge> *> (v)) {
+    return e->value ().bbox ();
+  } else if (const Value<db::DEdgePair> *ep = dynamic_cast<const Value<db::DEdgePair> *> (v)) {
+    return ep->value ().bbox ();
+  } else if (const Value<db::DPath> *pa = dynamic_cast<const Value<db::DPath> *> (v)) {
+    return pa->value ().box ();
+  } else if (const Value<db::DText> *t = dynamic_cast<const Value<db::DText> *> (v)) {
+    return t->value ().box ();
+  } else {
+    return db::DBox ();
+  }
+}
+
+static db::DBox
+item_bbox (const Item &item)
+{
+  db::DBox box;
+  for (Values::const_iterator v = item.values ().begin (); v != item.values ().end (); ++v) {
+    if (v->get ()) {
+      box += value_bbox (v->get ());
+    }
+  }
+  return box;
+}
+
+static void
+write_value (BinaryWriter &w, const ValueBase *v)
+{
+  w.put_byte ((unsigned char) v->type_index ());
+
+  if (const Value<double> *d = dynamic_cast<const Value<double> *> (v)) {
+
+    w.put_double (d->value ());
+
+  } else if (const Value<std::string> *s = dynamic_cast<const Value<std::string> *> (v)) {
+
+    w.put_string (s->value ());
+
+  } else if (const Value<db::DPolygon> *p = dynamic_cast<const Value<db::DPolygon> *> (v)) {
+
+    const db::DPolygon &poly = p->value ();
+    w.put_uint (poly.holes ());
+    w.put_points (poly.begin_hull (), poly.end_hull (), poly.hull ().size ());
+    for (unsigned int h = 0; h < poly.holes (); ++h) {
+      w.put_points (poly.begin_hole (h), poly.end_hole (h), poly.hole (h).size ());
+    }
+
+  } else if (const Value<db::DEdge> *e = dynamic_cast<const Value<db::DEdge> *> (v)) {
+
+    w.put_edge (e->value ());
+
+  } else if (const Value<db::DEdgePair> *ep = dynamic_cast<const Value<db::DEdgePair> *> (v)) {
+
+    w.put_edge (ep->value ().first ());
+    w.put_edge (ep->value ().second ());
+    w.put_byte (ep->value ().is_symmetric () ? 1 : 0);
+
+  } else if (const Value<db::DBox> *b = dynamic_cast<const Value<db::DBox> *> (v)) {
+
+    w.put_box (b->value ());
+
+  } else if (const Value<db::DPath> *pa = dynamic_cast<const Value<db::DPath> *> (v)) {
+
+    const db::DPath &path = pa->value ();
+    w.put_double (path.width ());
+    w.put_double (path.bgn_ext ());
+    w.put_double (path.end_ext ());
+    w.put_byte (path.round () ? 1 : 0);
+    w.put_points (path.begin (), path.end (), path.points ());
+
+  } else if (const Value<db::DText> *t = dynamic_cast<const Value<db::DText> *> (v)) {
+
+    const db::DText &text = t->value ();
+    w.put_string (text.string ());
+    w.put_uint ((unsigned int) text.trans ().rot ());
+    w.put_point (db::DPoint () + text.trans ().disp ());
+    w.put_double (text.size ());
+    w.put_uint ((unsigned int) (int (text.font ()) + 1));
+    w.put_uint ((unsigned int) (int (text.halign ()) + 1));
+    w.put_uint ((unsigned int) (int (text.valign ()) + 1));
+
+  } else {
+    throw tl::Exception (tl::to_string (tr ("Value type not supported by the binary RDB format: %s")), v->to_string ());
+  }
+}
+
+static ValueBase *
+read_value (BinaryReader &r)
+{
+  unsigned int type_index = r.get_byte ();
+
+  if (type_index == (unsigned int) type_index_of<double> ()) {
+
+    return new Value<double> (r.get_double ());
+
+  } else if (type_index == (unsigned int) type_index_of<std::string> ()) {
+
+    return new Value<std::string> (r.get_string ());
+
+  } else if (type_index == (unsigned int) type_index_of<db::DPolygon> ()) {
+
+    size_t nholes = r.get_size ();
+
+    std::vector<db::DPoint> pts;
+    db::DPolygon poly;
+
+    r.get_points (pts);
+    poly.assign_hull (pts.begin (), pts.end (), false /*don't compress*/);
+    for (size_t h = 0; h < nholes; ++h) {
+      r.get_points (pts);
+      poly.insert_hole (pts.begin (), pts.end (), false /*don't compress*/);
+    }
+
+    return new Value<db::DPolygon> (poly);
+
+  } else if (type_index == (unsigned int) type_index_of<db::DEdge> ()) {
+
+    return new Value<db::DEdge> (r.get_edge ());
+
+  } else if (type_index == (unsigned int) type_index_of<db::DEdgePair> ()) {
+
+    db::DEdge e1 = r.get_edge ();
+    db::DEdge e2 = r.get_edge ();
+    bool symmetric = r.get_byte () != 0;
+    return new Value<db::DEdgePair> (db::DEdgePair (e1, e2, symmetric));
+
+  } else if (type_index == (unsigned int) type_index_of<db::DBox> ()) {
+
+    return new Value<db::DBox> (r.get_box ());
+
+  } else if (type_index == (unsigned int) type_index_of<db::DPath> ()) {
+
+    double w = r.get_double ();
+    double bgn_ext = r.get_double ();
+    double end_ext = r.get_double ();
+    bool round = r.get_byte () != 0;
+
+    std::vector<db::DPoint> pts;
+    r.get_points (pts);
+
+    return new Value<db::DPath> (db::DPath (pts.begin (), pts.end (), w, bgn_ext, end_ext, round));
+
+  } else if (type_index == (unsigned int) type_index_of<db::DText> ()) {
+
+    std::string s = r.get_string ();
+    int rot = int (r.get_uint ());
+    db::DPoint disp = r.get_point ();
+    double size = r.get_double ();
+    int font = int (r.get_uint ()) - 1;
+    int halign = int (r.get_uint ()) - 1;
+    int valign = int (r.get_uint ()) - 1;
+
+    return new Value<db::DText> (db::DText (s, db::DTrans (rot, disp - db::DPoint ()), size, db::Font (font), db::HAlign (halign), db::VAlign (valign)));
+
+  } else {
+    throw ReaderException (tl::sprintf (tl::to_string (tr ("Invalid value type %d in binary RDB file")), int (type_index)));
+  }
+}
+
+// -------------------------------------------------------------
+//  Writer implementation
+
+static void
+write_categories (BinaryWriter &w, const Categories &categories)
+{
+  size_t n = 0;
+  for (Categories::const_iterator c = categories.begin (); c != categories.end (); ++c) {
+    ++n;
+  }
+
+  w.put_uint (n);
+  for (Categories::const_iterator c = categories.begin (); c != categories.end (); ++c) {
+    w.put_uint (c->id ());
+    w.put_string (c->name ());
+    w.put_string (c->description ());
+    write_categories (w, c->sub_categories ());
+  }
+}
+
+static void
+write_item (BinaryWriter &w, const Database &db, const Item &item)
+{
+  std::vector<id_type> tag_ids;
+  for (Tags::const_iterator t = db.tags ().begin_tags (); t != db.tags ().end_tags (); ++t) {
+    if (item.has_tag (t->id ())) {
+      tag_ids.push_back (t->id ());
+    }
+  }
+
+  w.put_uint (tag_ids.size ());
+  for (std::vector<id_type>::const_iterator t = tag_ids.begin (); t != tag_ids.end (); ++t) {
+    w.put_uint (*t);
+  }
+
+  w.put_byte (item.visited () ? 1 : 0);
+  w.put_uint (item.multiplicity ());
+
+#if defined(HAVE_QT)
+  w.put_string (item.image_str ());
+#else
+  w.put_string (std::string ());
+#endif
+
+  size_t n = 0;
+  for (Values::const_iterator v = item.values ().begin (); v != item.values ().end (); ++v) {
+    if (v->get ()) {
+      ++n;
+    }
+  }
+
+  w.put_uint (n);
+  for (Values::const_iterator v = item.values ().begin (); v != item.values ().end (); ++v) {
+    if (v->get ()) {
+      w.put_uint (v->tag_id ());
+      write_value (w, v->get ());
+    }
+  }
+}
+
+namespace
+{
+
+typedef std::pair<const Item *, db::DBox> item_with_box;
+
+struct ItemCenterXCompare
+{
+  bool operator() (const item_with_box &a, const item_with_box &b) const
+  {
+    return a.second.center ().x () < b.second.center ().x ();
+  }
+};
+
+struct ItemCenterYCompare
+{
+  bool operator() (const item_with_box &a, const item_with_box &b) const
+  {
+    return a.second.center ().y () < b.second.center ().y ();
+  }
+};
+
+struct ItemHasNoGeometry
+{
+  bool operator() (const item_with_box &a) const
+  {
+    return a.second.empty ();
+  }
+};
+
+struct BlockIndexEntry
+{
+  id_type cell_id, category_id;
+  size_t count, visited;
+  unsigned int flags;
+  db::DBox bbox;
+  size_t offset, size;
+};
+
+}
+
+/**
+ *  @brief Sorts the geometric items of one cell and category into tiles of "block_size" items
+ *
+ *  This is a "sort-tile-recursive" packing: the items are sorted by x and cut into vertical
+ *  slices. Inside each slice the items are sorted by y. Consecutive runs of "block_size" items
+ *  then form compact blocks.
+ */
+static void
+sort_spatially (std::vector<item_with_box>::iterator from, std::vector<item_with_box>::iterator to, size_t block_size)
+{
+  size_t n = to - from;
+  if (n <= block_size) {
+    return;
+  }
+
+  size_t nblocks = (n + block_size - 1) / block_size;
+  size_t nslices = size_t (ceil (sqrt (double (nblocks))));
+  size_t slice_size = ((nblocks + nslices - 1) / nslices) * block_size;
+
+  std::stable_sort (from, to, ItemCenterXCompare ());
+  for (std::vector<item_with_box>::iterator s = from; s != to; ) {
+    std::vector<item_with_box>::iterator e = s + std::min (slice_size, size_t (to - s));
+    std::stable_sort (s, e, ItemCenterYCompare ());
+    s = e;
+  }
+}
+
+void
+write_binary_database (const Database &db, tl::OutputStream &os, size_t block_size)
+{
+  tl::SelfTimer timer (tl::verbosity () >= 11, "Writing binary marker database file");
+
+  if (block_size == 0) {
+    block_size = 1;
+  }
+
+  BinaryWriter w (os);
+
+  w.put_bytes (binary_magic, sizeof (binary_magic));
+  w.put_uint (binary_version);
+
+  //  header
+
+  w.put_string (db.description ());
+  w.put_string (db.original_file ());
+  w.put_string (db.generator ());
+  w.put_string (db.top_cell_name ());
+
+  size_t ntags = 0;
+  for (Tags::const_iterator t = db.tags ().begin_tags (); t != db.tags ().end_tags (); ++t) {
+    ++ntags;
+  }
+
+  w.put_uint (ntags);
+  for (Tags::const_iterator t = db.tags ().begin_tags (); t != db.tags ().end_tags (); ++t) {
+    w.put_uint (t->id ());
+    w.put_string (t->name ());
+    w.put_byte (t->is_user_tag () ? 1 : 0);
+    w.put_string (t->description ());
+  }
+
+  write_categories (w, db.categories ());
+
+  size_t ncells = 0;
+  for (Cells::const_iterator c = db.cells ().begin (); c != db.cells ().end (); ++c) {
+    ++ncells;
+  }
+
+  w.put_uint (ncells);
+  for (Cells::const_iterator c = db.cells ().begin (); c != db.cells ().end (); ++c) {
+
+    w.put_uint (c->id ());
+    w.put_string (c->name ());
+    w.put_string (c->variant ());
+
+    size_t nrefs = 0;
+    for (References::const_iterator r = c->references ().begin (); r != c->references ().end (); ++r) {
+      ++nrefs;
+    }
+
+    w.put_uint (nrefs);
+    for (References::const_iterator r = c->references ().begin (); r != c->references ().end (); ++r) {
+      w.put_uint (r->parent_cell_id ());
+      w.put_double (r->trans ().mag ());
+      w.put_double (r->trans ().angle ());
+      w.put_byte (r->trans ().is_mirror () ? 1 : 0);
+      w.put_point (db::DPoint () + r->trans ().disp ());
+    }
+
+  }
+
+  //  group the items by cell and category
+
+  std::map<std::pair<id_type, id_type>, std::vector<item_with_box> > items_by_cell_and_category;
+  for (Items::const_iterator i = db.items ().begin (); i != db.items ().end (); ++i) {
+    items_by_cell_and_category [std::make_pair (i->cell_id (), i->category_id ())].push_back (std::make_pair (i.operator-> (), item_bbox (*i)));
+  }
+
+  //  form the blocks: items without geometry first, geometric items sorted into compact blocks
+
+  std::vector<BlockIndexEntry> blocks;
+  std::vector<std::pair<std::vector<item_with_box>::const_iterator, std::vector<item_with_box>::const_iterator> > block_items;
+
+  for (std::map<std::pair<id_type, id_type>, std::vector<item_with_box> >::iterator g = items_by_cell_and_category.begin (); g != items_by_cell_and_category.end (); ++g) {
+
+    std::vector<item_with_box> &items = g->second;
+    std::vector<item_with_box>::iterator geo = std::stable_partition (items.begin (), items.end (), ItemHasNoGeometry ());
+    sort_spatially (geo, items.end (), block_size);
+
+    for (std::vector<item_with_box>::const_iterator i = items.begin (); i != items.end (); ) {
+
+      std::vector<item_with_box>::const_iterator ie = i + std::min (block_size, size_t (items.end () - i));
+      if (i < geo && ie > geo) {
+        ie = geo;
+      }
+
+      BlockIndexEntry b;
+      b.cell_id = g->first.first;
+      b.category_id = g->first.second;
+      b.count = ie - i;
+      b.visited = 0;
+      b.flags = (i < geo ? block_flag_non_geometric : 0);
+      for (std::vector<item_with_box>::const_iterator ii = i; ii != ie; ++ii) {
+        b.bbox += ii->second;
+        if (ii->first->visited ()) {
+          ++b.visited;
+        }
+      }
+      b.offset = 0;
+      b.size = 0;
+
+      blocks.push_back (b);
+      block_items.push_back (std::make_pair (i, ie));
+
+      i = ie;
+
+    }
+
+  }
+
+  //  items
+
+  w.put_uint (blocks.size ());
+
+  for (size_t bi = 0; bi < blocks.size (); ++bi) {
+
+    BlockIndexEntry &b = blocks [bi];
+    b.offset = w.pos ();
+
+    w.put_uint (b.cell_id);
+    w.put_uint (b.category_id);
+    w.put_uint (b.count);
+
+    for (std::vector<item_with_box>::const_iterator i = block_items [bi].first; i != block_items [bi].second; ++i) {
+      write_item (w, db, *i->first);
+    }
+
+    b.size = w.pos () - b.offset;
+
+  }
+
+  //  index
+
+  size_t index_pos = w.pos ();
+
+  w.put_uint (blocks.size ());
+  for (std::vector<BlockIndexEntry>::const_iterator b = blocks.begin (); b != blocks.end (); ++b) {
+    w.put_uint (b->cell_id);
+    w.put_uint (b->category_id);
+    w.put_uint (b->count);
+    w.put_uint (b->visited);
+    w.put_uint (b->flags);
+    w.put_box (b->bbox);
+    w.put_uint (b->offset);
+    w.put_uint (b->size);
+  }
+
+  w.put_fixed (index_pos);
+}
+
+bool
+is_binary_database_file_name (const std::string &fn)
+{
+  return match_filename_to_format (fn, binary_file_format);
+}
+
+// -------------------------------------------------------------
+//  Reader implementation
+
+namespace
+{
+
+/**
+ *  @brief Maps the ids of the file to the ids of the database
+ */
+struct BinaryIdMaps
+{
+  std::map<id_type, id_type> cell_ids, category_ids, tag_ids;
+
+  id_type map (const std::map<id_type, id_type> &m, id_type id) const
+  {
+    std::map<id_type, id_type>::const_iterator i = m.find (id);
+    if (i == m.end ()) {
+      throw ReaderException (tl::sprintf (tl::to_string (tr ("Invalid id %lu in binary RDB file")), (unsigned long) id));
+    }
+    return i->second;
+  }
+};
+
+}
+
+static unsigned int
+read_magic (BinaryReader &r)
+{
+  const char *m = r.get_bytes (sizeof (binary_magic));
+  if (memcmp (m, binary_magic, sizeof (binary_magic)) != 0) {
+    throw ReaderException (tl::to_string (tr ("Not a binary RDB file")));
+  }
+
+  unsigned int version = (unsigned int) r.get_uint ();
+  if (version > binary_version) {
+    throw ReaderException (tl::sprintf (tl::to_string (tr ("Unsupported binary RDB file version %d")), int (version)));
+  }
+
+  return version;
+}
+
+static void
+read_categories (BinaryReader &r, Database &db, Category *parent, BinaryIdMaps &maps)
+{
+  size_t n = r.get_size ();
+  for (size_t i = 0; i < n; ++i) {
+
+    id_type id = id_type (r.get_uint ());
+    std::string name = r.get_string ();
+
+    Category *cat = parent ? db.create_category (parent, name) : db.create_category (name);
+    cat->set_description (r.get_string ());
+    maps.category_ids [id] = cat->id ();
+
+    read_categories (r, db, cat, maps);
+
+  }
+}
+
+static unsigned int
+read_header (BinaryReader &r, Database &db, BinaryIdMaps &maps)
+{
+  unsigned int version = read_magic (r);
+
+  db.set_description (r.get_string ());
+  db.set_original_file (r.get_string ());
+  db.set_generator (r.get_string ());
+  db.set_top_cell_name (r.get_string ());
+
+  size_t ntags = r.get_size ();
+  for (size_t i = 0; i < ntags; ++i) {
+    id_type id = id_type (r.get_uint ());
+    std::string name = r.get_string ();
+    bool user_tag = r.get_byte () != 0;
+    std::string description = r.get_string ();
+    id_type tag_id = db.tags ().tag (name, user_tag).id ();
+    db.set_tag_description (tag_id, description);
+    maps.tag_ids [id] = tag_id;
+  }
+
+  read_categories (r, db, 0, maps);
+
+  //  cells are created first, so references can point to any cell
+
+  std::vector<std::pair<Cell *, std::vector<std::pair<id_type, db::DCplxTrans> > > > cells_with_refs;
+
+  size_t ncells = r.get_size ();
+  for (size_t i = 0; i < ncells; ++i) {
+
+    id_type id = id_type (r.get_uint ());
+    std::string name = r.get_string ();
+    std::string variant = r.get_string ();
+
+    Cell *cell = db.create_cell (name, variant);
+    maps.cell_ids [id] = cell->id ();
+
+    cells_with_refs.push_back (std::make_pair (cell, std::vector<std::pair<id_type, db::DCplxTrans> > ()));
+
+    size_t nrefs = r.get_size ();
+    for (size_t j = 0; j < nrefs; ++j) {
+      id_type parent_id = id_type (r.get_uint ());
+      double mag = r.get_double ();
+      double angle = r.get_double ();
+      bool mirror = r.get_byte () != 0;
+      db::DPoint disp = r.get_point ();
+      cells_with_refs.back ().second.push_back (std::make_pair (parent_id, db::DCplxTrans (mag, angle, mirror, disp - db::DPoint ())));
+    }
+
+  }
+
+  for (std::vector<std::pair<Cell *, std::vector<std::pair<id_type, db::DCplxTrans> > > >::const_iterator c = cells_with_refs.begin (); c != cells_with_refs.end (); ++c) {
+    for (std::vector<std::pair<id_type, db::DCplxTrans> >::const_iterator ref = c->second.begin (); ref != c->second.end (); ++ref) {
+      c->first->references ().insert (Reference (ref->second, maps.map (maps.cell_ids, ref->first)));
+    }
+  }
+
+  return version;
+}
+
+/**
+ *  @brief Reads the items of a block
+ *
+ *  If "registered" is true, the items have been registered with Database::register_items
+ *  before and the item counts are not changed.
+ */
+static size_t
+read_block (BinaryReader &r, Database &db, const BinaryIdMaps &maps, bool registered)
+{
+  id_type cell_id = maps.map (maps.cell_ids, id_type (r.get_uint ()));
+  id_type category_id = maps.map (maps.category_ids, id_type (r.get_uint ()));
+
+  size_t n = r.get_size ();
+  for (size_t i = 0; i < n; ++i) {
+
+    Item *item = registered ? db.create_registered_item (cell_id, category_id) : db.create_item (cell_id, category_id);
+
+    size_t ntags = r.get_size ();
+    for (size_t t = 0; t < ntags; ++t) {
+      item->add_tag (maps.map (maps.tag_ids, id_type (r.get_uint ())));
+    }
+
+    bool visited = r.get_byte () != 0;
+    if (registered) {
+      item->set_visited (visited);
+    } else if (visited) {
+      db.set_item_visited (item, true);
+    }
+
+    item->set_multiplicity (r.get_size ());
+
+    std::string image_str = r.get_string ();
+#if defined(HAVE_QT)
+    if (! image_str.empty ()) {
+      item->set_image_str (image_str);
+    }
+#endif
+
+    size_t nvalues = r.get_size ();
+    for (size_t v = 0; v < nvalues; ++v) {
+      id_type tag_id = id_type (r.get_uint ());
+      if (tag_id != 0) {
+        tag_id = maps.map (maps.tag_ids, tag_id);
+      }
+      ValueBase *value = read_value (r);
+      item->values ().add (value, tag_id);
+    }
+
+  }
+
+  return n;
+}
+
+class BinaryReader_
+  : public ReaderBase
+{
+public:
+  BinaryReader_ (tl::InputStream &stream)
+    : m_input_stream (stream)
+  {
+    // .. nothing yet ..
+  }
+
+  virtual void read (Database &db)
+  {
+    tl::SelfTimer timer (tl::verbosity () >= 11, "Reading binary marker database file");
+
+    BinaryReader r (m_input_stream);
+    BinaryIdMaps maps;
+
+    read_header (r, db, maps);
+
+    size_t nblocks = r.get_size ();
+    for (size_t i = 0; i < nblocks; ++i) {
+      read_block (r, db, maps, false);
+    }
+  }
+
+  virtual const char *format () const
+  {
+    return "KLayout-RDB-Binary";
+  }
+
+private:
+  tl::InputStream &m_input_stream;
+};
+
+class BinaryFormatDeclaration
+  : public FormatDeclaration
+{
+  virtual std::string format_name () const { return "KLayout-RDB-Binary"; }
+  virtual std::string format_desc () const { return "KLayout binary report database format"; }
+  virtual std::string file_format () const { return binary_file_format; }
+
+  virtual bool detect (tl::InputStream &stream) const
+  {
+    const char *m = stream.get (sizeof (binary_magic));
+    return m && memcmp (m, binary_magic, sizeof (binary_magic)) == 0;
+  }
+
+  virtual ReaderBase *create_reader (tl::InputStream &s) const
+  {
+    return new BinaryReader_ (s);
+  }
+};
+
+static tl::RegisteredClass<rdb::FormatDeclaration> format_decl (new BinaryFormatDeclaration (), 10, "KLayout-RDB-Binary");
+
+// -------------------------------------------------------------
+//  BinaryDatabaseFile implementation
+
+static void
+read_file_section (std::ifstream &is, const std::string &path, size_t offset, size_t size, std::vector<char> &buffer)
+{
+  buffer.resize (size);
+  is.clear ();
+  is.seekg (std::streamoff (offset), std::ios::beg);
+  if (size > 0) {
+    is.read (&buffer.front (), std::streamsize (size));
+  }
+  if (! is.good ()) {
+    throw ReaderException (tl::sprintf (tl::to_string (tr ("Unable to read from binary RDB file %s")), path));
+  }
+}
+
+bool
+BinaryDatabaseFile::can_open (const std::string &path)
+{
+  //  compressed files can't be read block by block, hence the file is looked at directly
+  std::ifstream is (path.c_str (), std::ios::in | std::ios::binary);
+  if (! is.good ()) {
+    return false;
+  }
+
+  //  magic and a version of up to 10 bytes
+  char buffer [sizeof (binary_magic) + 10];
+  is.read (buffer, sizeof (buffer));
+  size_t n = size_t (is.gcount ());
+  if (n <= sizeof (binary_magic) || memcmp (buffer, binary_magic, sizeof (binary_magic)) != 0) {
+    return false;
+  }
+
+  uint64_t version = 0;
+  for (size_t i = sizeof (binary_magic), s = 0; i < n; ++i, s += 7) {
+    version |= uint64_t ((unsigned char) buffer [i] & 0x7f) << s;
+    if (((unsigned char) buffer [i] & 0x80) == 0) {
+      return version >= 2 && version <= binary_version;
+    }
+  }
+
+  return false;
+}
+
+BinaryDatabaseFile::BinaryDatabaseFile (const std::string &path, Database &db)
+  : m_path (path), mp_db (&db), m_num_items (0), m_num_loaded_items (0)
+{
+  tl::SelfTimer timer (tl::verbosity () >= 11, "Reading binary marker database index");
+
+  BinaryIdMaps maps;
+  unsigned int version = 0;
+
+  {
+    tl::InputStream stream (path);
+    BinaryReader r (stream);
+    version = read_header (r, db, maps);
+    db.set_filename (stream.absolute_path ());
+    db.set_name (stream.filename ());
+  }
+
+  if (version < 2) {
+    throw ReaderException (tl::sprintf (tl::to_string (tr ("Binary RDB file %s has no visited counts in the index and can't be loaded on demand")), path));
+  }
+
+  m_cell_ids = maps.cell_ids;
+  m_category_ids = maps.category_ids;
+  m_tag_ids = maps.tag_ids;
+
+  //  read the index
+
+  std::ifstream is (path.c_str (), std::ios::in | std::ios::binary);
+  if (! is.good ()) {
+    throw ReaderException (tl::sprintf (tl::to_string (tr ("Unable to open binary RDB file %s")), path));
+  }
+
+  is.seekg (0, std::ios::end);
+  size_t file_size = size_t (is.tellg ());
+  if (file_size < 8) {
+    throw ReaderException (tl::sprintf (tl::to_string (tr ("Binary RDB file %s is truncated")), path));
+  }
+
+  std::vector<char> buffer;
+  read_file_section (is, path, file_size - 8, 8, buffer);
+
+  uint64_t index_pos = 0;
+  for (unsigned int i = 0; i < 8; ++i) {
+    index_pos |= uint64_t ((unsigned char) buffer [i]) << (8 * i);
+  }
+  if (index_pos > file_size - 8) {
+    throw ReaderException (tl::sprintf (tl::to_string (tr ("Invalid index position in binary RDB file %s")), path));
+  }
+
+  read_file_section (is, path, size_t (index_pos), file_size - 8 - size_t (index_pos), buffer);
+
+  tl::InputMemoryStream index_mem (buffer.empty () ? 0 : &buffer.front (), buffer.size ());
+  tl::InputStream index_stream (index_mem);
+  BinaryReader r (index_stream);
+
+  size_t nblocks = r.get_size ();
+  m_blocks.reserve (nblocks);
+
+  for (size_t i = 0; i < nblocks; ++i) {
+
+    id_type cell_id = maps.map (maps.cell_ids, id_type (r.get_uint ()));
+    id_type category_id = maps.map (maps.category_ids, id_type (r.get_uint ()));
+
+    Block b;
+    b.count = r.get_size ();
+    b.visited = r.get_size ();
+    b.has_non_geometric = (r.get_uint () & block_flag_non_geometric) != 0;
+    b.bbox = r.get_box ();
+    b.offset = r.get_size ();
+    b.size = r.get_size ();
+
+    if (b.offset + b.size > size_t (index_pos) || b.visited > b.count) {
+      throw ReaderException (tl::sprintf (tl::to_string (tr ("Invalid block in binary RDB file %s")), path));
+    }
+
+    m_blocks_by_cell_and_category [std::make_pair (cell_id, category_id)].push_back (m_blocks.size ());
+    m_blocks.push_back (b);
+
+    //  the counts are taken from the index, so they are valid before the items are loaded
+    db.register_items (cell_id, category_id, b.count, b.visited);
+    m_num_items += b.count;
+
+  }
+
+  db.reset_modified ();
+}
+
+size_t
+BinaryDatabaseFile::num_items (id_type cell_id, id_type category_id) const
+{
+  size_t n = 0;
+  std::map<std::pair<id_type, id_type>, std::vector<size_t> >::const_iterator bb = m_blocks_by_cell_and_category.find (std::make_pair (cell_id, category_id));
+  if (bb != m_blocks_by_cell_and_category.end ()) {
+    for (std::vector<size_t>::const_iterator b = bb->second.begin (); b != bb->second.end (); ++b) {
+      n += m_blocks [*b].count;
+    }
+  }
+  return n;
+}
+
+void
+BinaryDatabaseFile::load_items_on_demand (id_type cell_id, id_type category_id)
+{
+  if (m_num_loaded_items == m_num_items) {
+    return;
+  } else if (cell_id != 0 && category_id != 0) {
+    load_items (cell_id, category_id);
+    return;
+  }
+
+  //  0 for the cell or category id stands for all cells or categories
+  for (std::map<std::pair<id_type, id_type>, std::vector<size_t> >::const_iterator bb = m_blocks_by_cell_and_category.begin (); bb != m_blocks_by_cell_and_category.end (); ++bb) {
+    if ((cell_id == 0 || bb->first.first == cell_id) && (category_id == 0 || bb->first.second == category_id)) {
+      for (std::vector<size_t>::const_iterator b = bb->second.begin (); b != bb->second.end (); ++b) {
+        load_block (m_blocks [*b]);
+      }
+    }
+  }
+}
+
+size_t
+BinaryDatabaseFile::load_items (id_type cell_id, id_type category_id)
+{
+  size_t n = 0;
+  std::map<std::pair<id_type, id_type>, std::vector<size_t> >::const_iterator bb = m_blocks_by_cell_and_category.find (std::make_pair (cell_id, category_id));
+  if (bb != m_blocks_by_cell_and_category.end ()) {
+    for (std::vector<size_t>::const_iterator b = bb->second.begin (); b != bb->second.end (); ++b) {
+      n += load_block (m_blocks [*b]);
+    }
+  }
+  return n;
+}
+
+size_t
+BinaryDatabaseFile::load_items (id_type cell_id, id_type category_id, const db::DBox &box)
+{
+  size_t n = 0;
+  std::map<std::pair<id_type, id_type>, std::vector<size_t> >::const_iterator bb = m_blocks_by_cell_and_category.find (std::make_pair (cell_id, category_id));
+  if (bb != m_blocks_by_cell_and_category.end ()) {
+    for (std::vector<size_t>::const_iterator b = bb->second.begin (); b != bb->second.end (); ++b) {
+      Block &block = m_blocks [*b];
+      if (block.has_non_geometric || block.bbox.touches (box)) {
+        n += load_block (block);
+      }
+    }
+  }
+  return n;
+}
+
+size_t
+BinaryDatabaseFile::load_all_items ()
+{
+  size_t n = 0;
+  for (std::vector<Block>::iterator b = m_blocks.begin (); b != m_blocks.end (); ++b) {
+    n += load_block (*b);
+  }
+  return n;
+}
+
+size_t
+BinaryDatabaseFile::load_block (Block &block)
+{
+  if (block.loaded) {
+    return 0;
+  }
+
+  Database *db = mp_db.get ();
+  if (! db) {
+    throw tl::Exception (tl::to_string (tr ("The database of the binary RDB file has been deleted")));
+  }
+
+  std::ifstream is (m_path.c_str (), std::ios::in | std::ios::binary);
+  if (! is.good ()) {
+    throw ReaderException (tl::sprintf (tl::to_string (tr ("Unable to open binary RDB file %s")), m_path));
+  }
+
+  std::vector<char> buffer;
+  read_file_section (is, m_path, block.offset, block.size, buffer);
+
+  tl::InputMemoryStream mem (buffer.empty () ? 0 : &buffer.front (), buffer.size ());
+  tl::InputStream stream (mem);
+  BinaryReader r (stream);
+
+  BinaryIdMaps maps;
+  maps.cell_ids = m_cell_ids;
+  maps.category_ids = m_category_ids;
+  maps.tag_ids = m_tag_ids;
+
+  //  loading items does not count as a modification
+  bool modified = db->is_modified ();
+
+  size_t n = read_block (r, *db, maps, true);
+
+  if (! modified) {
+    db->reset_modified ();
+  }
+
+  block.loaded = true;
+  m_num_loaded_items += n;
+
+  return n;
+}
+
+}
+
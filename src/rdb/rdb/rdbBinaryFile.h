@@ -0,0 +1,170 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#ifndef HDR_rdbBinaryFile
+#define HDR_rdbBinaryFile
+
+#include "rdbCommon.h"
+#include "rdb.h"
+
+#include "dbBox.h"
+#include "tlStream.h"
+#include "tlObject.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace rdb
+{
+
+/**
+ *  @brief Writes a database in the binary report database format
+ *
+ *  The binary format stores the tags, categories and cells in a header section.
+ *  The items follow in blocks, each holding items of a single cell and category.
+ *  Inside a cell and category, the items are sorted spatially before they are split
+ *  into blocks, so each block covers a compact area. An index at the end of the file
+ *  lists the blocks with cell, category, item count, visited count, bounding box and file position.
+ *
+ *  @param block_size The maximum number of items per block
+ */
+RDB_PUBLIC void write_binary_database (const Database &db, tl::OutputStream &os, size_t block_size = 1024);
+
+/**
+ *  @brief Returns a value indicating whether the file name asks for the binary format
+ */
+RDB_PUBLIC bool is_binary_database_file_name (const std::string &fn);
+
+/**
+ *  @brief Provides on-demand access to the items of a binary report database file
+ *
+ *  This object is created by Database::load for uncompressed binary files. It reads the
+ *  header and the block index and installs the tags, categories and cells in the database.
+ *  The item counts of the database, the cells and the categories are taken from the block
+ *  index. The items are not loaded. The database loads them block by block when they are
+ *  asked for (e.g. through Database::items_by_cell). The "load_items" methods allow loading
+ *  items in advance. Every block is loaded only once, hence it's safe to request items for
+ *  the same cell and category multiple times.
+ *
+ *  The ids passed to and delivered by this object are the ids of the database, not
+ *  the ones stored in the file.
+ */
+class RDB_PUBLIC BinaryDatabaseFile
+{
+public:
+  /**
+   *  @brief Returns a value indicating whether the given file can be opened for on-demand loading
+   *
+   *  This is the case for uncompressed binary files with a block index including the visited counts.
+   */
+  static bool can_open (const std::string &path);
+
+  /**
+   *  @brief Gets the number of item blocks in the file
+   */
+  size_t num_blocks () const
+  {
+    return m_blocks.size ();
+  }
+
+  /**
+   *  @brief Gets the total number of items in the file
+   */
+  size_t num_items () const
+  {
+    return m_num_items;
+  }
+
+  /**
+   *  @brief Gets the number of items stored in the file for the given cell and category
+   *
+   *  Other than Database::num_items, this number does not include the items of sub-categories.
+   */
+  size_t num_items (id_type cell_id, id_type category_id) const;
+
+  /**
+   *  @brief Gets the number of items loaded so far
+   */
+  size_t num_loaded_items () const
+  {
+    return m_num_loaded_items;
+  }
+
+  /**
+   *  @brief Loads all items of the given cell and category
+   *
+   *  @return The number of items newly loaded
+   */
+  size_t load_items (id_type cell_id, id_type category_id);
+
+  /**
+   *  @brief Loads the items of the given cell and category which may touch the given box
+   *
+   *  Only the blocks whose bounding box touches the given box are loaded. As the blocks
+   *  are loaded as a whole, the database may receive items outside the box as well.
+   *  Blocks containing items without geometry are always loaded.
+   *
+   *  @return The number of items newly loaded
+   */
+  size_t load_items (id_type cell_id, id_type category_id, const db::DBox &box);
+
+  /**
+   *  @brief Loads all remaining items
+   *
+   *  @return The number of items newly loaded
+   */
+  size_t load_all_items ();
+
+private:
+  friend class Database;
+
+  struct Block
+  {
+    Block () : count (0), visited (0), offset (0), size (0), has_non_geometric (false), loaded (false) { }
+
+    size_t count, visited;
+    db::DBox bbox;
+    size_t offset, size;
+    bool has_non_geometric;
+    bool loaded;
+  };
+
+  std::string m_path;
+  tl::weak_ptr<Database> mp_db;
+  std::vector<Block> m_blocks;
+  std::map<std::pair<id_type, id_type>, std::vector<size_t> > m_blocks_by_cell_and_category;
+  std::map<id_type, id_type> m_cell_ids, m_category_ids, m_tag_ids;
+  size_t m_num_items, m_num_loaded_items;
+
+  BinaryDatabaseFile (const std::string &path, Database &db);
+
+  void load_items_on_demand (id_type cell_id, id_type category_id);
+  size_t load_block (Block &block);
+};
+
+}
+
+#endif
+
@@ -24,6 +24,7 @@
 #include "rdb.h"
 #include "rdbReader.h"
 #include "rdbCommon.h"
+#include "rdbBinaryFile.h"
 
 #include "tlTimer.h"
 #include "tlProgress.h"
@@ -124,8 +125,15 @@ make_rdb_structure (rdb::Database *rdb)
 void
 rdb::Database::save (const std::string &fn)
 {
+  //  items not loaded yet are read before the file is written - it may be the one they come from
+  load_items (0, 0);
+
   tl::OutputStream os (fn, tl::OutputStream::OM_Auto);
-  make_rdb_structure (this).write (os, *this); 
+  if (is_binary_database_file_name (fn)) {
+    write_binary_database (*this, os);
+  } else {
+    make_rdb_structure (this).write (os, *this); 
+  }
   set_filename (fn);
 
   tl::log << "Saved RDB to " << fn;
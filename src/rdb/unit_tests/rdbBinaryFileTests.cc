@@ -0,0 +1,365 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "rdb.h"
+#include "rdbBinaryFile.h"
+#include "tlUnitTest.h"
+
+#include "dbPolygon.h"
+#include "dbPath.h"
+#include "dbText.h"
+#include "dbEdge.h"
+#include "dbEdgePair.h"
+
+static std::string item_values (const rdb::Item &item)
+{
+  std::string s;
+  for (rdb::Values::const_iterator v = item.values ().begin (); v != item.values ().end (); ++v) {
+    if (! s.empty ()) {
+      s += ";";
+    }
+    s += v->get ()->to_string ();
+  }
+  return s;
+}
+
+static size_t num_items (const rdb::Database &db, rdb::id_type cell_id, rdb::id_type cat_id)
+{
+  std::pair<rdb::Database::const_item_ref_iterator, rdb::Database::const_item_ref_iterator> be = db.items_by_cell_and_category (cell_id, cat_id);
+  size_t n = 0;
+  for ( ; be.first != be.second; ++be.first) {
+    ++n;
+  }
+  return n;
+}
+
+TEST(1_RoundTrip)
+{
+  std::string tmp_file = tl::TestBase::tmp_file ("tmp_1.lyrdbb");
+
+  {
+    rdb::Database db;
+
+    db.set_description ("db-description");
+    db.set_generator ("db-generator");
+    db.set_original_file ("original.gds");
+    db.set_top_cell_name ("TOP");
+
+    rdb::Category *cath = db.create_category ("cath_name");
+    cath->set_description ("cath description");
+    rdb::Category *cath2 = db.create_category ("cath2");
+    rdb::Category *cath2cc = db.create_category (cath2, "cc");
+    cath2cc->set_description ("cath2.cc description");
+
+    rdb::Cell *c1 = db.create_cell ("c1");
+    rdb::Cell *c2 = db.create_cell ("c2", "var");
+    c2->references ().insert (rdb::Reference (db::DCplxTrans (1.5, 45, true, db::DVector (10.0, 20.0)), c1->id ()));
+
+    rdb::id_type tag1 = db.tags ().tag ("tag1").id ();
+    rdb::id_type tag2 = db.tags ().tag ("tag2", true).id ();
+    db.set_tag_description (tag2, "user tag");
+
+    rdb::Item *i1 = db.create_item (c1->id (), cath->id ());
+    i1->values ().add (new rdb::Value<db::DBox> (db::DBox (1.0, -1.0, 10.0, 11.0)));
+    i1->values ().add (new rdb::Value<std::string> ("text"), tag1);
+    i1->values ().add (new rdb::Value<double> (2.5));
+    i1->add_tag (tag1);
+    i1->set_multiplicity (17);
+
+    rdb::Item *i2 = db.create_item (c2->id (), cath2->id ());
+    db::DPolygon poly (db::DBox (0, 0, 100, 100));
+    std::vector<db::DPoint> hole;
+    hole.push_back (db::DPoint (10, 10));
+    hole.push_back (db::DPoint (10, 20));
+    hole.push_back (db::DPoint (20, 20));
+    hole.push_back (db::DPoint (20, 10));
+    poly.insert_hole (hole.begin (), hole.end ());
+    i2->values ().add (new rdb::Value<db::DPolygon> (poly));
+    i2->values ().add (new rdb::Value<db::DEdge> (db::DEdge (db::DPoint (1.0, -1.0), db::DPoint (10.0, 11.0))));
+    i2->values ().add (new rdb::Value<db::DEdgePair> (db::DEdgePair (db::DEdge (0, 0, 0, 10), db::DEdge (5, 10, 5, 0), true)));
+    i2->add_tag (tag1);
+    i2->add_tag (tag2);
+    db.set_item_visited (i2, true);
+
+    rdb::Item *i3 = db.create_item (c1->id (), cath2cc->id ());
+    std::vector<db::DPoint> pts;
+    pts.push_back (db::DPoint (0, 0));
+    pts.push_back (db::DPoint (10, 0));
+    pts.push_back (db::DPoint (10, 20));
+    i3->values ().add (new rdb::Value<db::DPath> (db::DPath (pts.begin (), pts.end (), 2.0, 1.0, 0.5, false)));
+    i3->values ().add (new rdb::Value<db::DText> (db::DText ("T", db::DTrans (db::DTrans::r90, db::DVector (1.0, 2.0)))));
+
+    db.save (tmp_file);
+  }
+
+  rdb::Database db2;
+  db2.load (tmp_file);
+
+  EXPECT_EQ (db2.name (), "tmp_1.lyrdbb");
+  EXPECT_EQ (db2.filename (), tmp_file);
+  EXPECT_EQ (db2.description (), "db-description");
+  EXPECT_EQ (db2.generator (), "db-generator");
+  EXPECT_EQ (db2.original_file (), "original.gds");
+  EXPECT_EQ (db2.top_cell_name (), "TOP");
+  EXPECT_EQ (db2.is_modified (), false);
+
+  EXPECT_EQ (db2.category_by_name ("cath_name") != 0, true);
+  EXPECT_EQ (db2.category_by_name ("cath_name")->description (), "cath description");
+  EXPECT_EQ (db2.category_by_name ("cath2.cc") != 0, true);
+  EXPECT_EQ (db2.category_by_name ("cath2.cc")->description (), "cath2.cc description");
+
+  EXPECT_EQ (db2.tags ().tag ("tag2", true).is_user_tag (), true);
+  EXPECT_EQ (db2.tags ().tag ("tag2", true).description (), "user tag");
+
+  const rdb::Cell *c1 = db2.cell_by_qname ("c1");
+  const rdb::Cell *c2 = db2.cell_by_qname ("c2:var");
+  EXPECT_EQ (c1 != 0, true);
+  EXPECT_EQ (c2 != 0, true);
+
+  rdb::References::const_iterator r = c2->references ().begin ();
+  EXPECT_EQ (r != c2->references ().end (), true);
+  EXPECT_EQ (r->trans ().to_string (), "m22.5 *1.5 10,20");
+  EXPECT_EQ (r->parent_cell_id (), c1->id ());
+
+  std::pair<rdb::Database::const_item_ref_iterator, rdb::Database::const_item_ref_iterator> be;
+
+  be = db2.items_by_cell_and_category (c1->id (), db2.category_by_name ("cath_name")->id ());
+  EXPECT_EQ (be.first != be.second, true);
+  EXPECT_EQ (item_values (**be.first), "box: (1,-1;10,11);text: text;float: 2.5");
+  EXPECT_EQ ((*be.first)->values ().begin ()->tag_id (), rdb::id_type (0));
+  EXPECT_EQ ((++(*be.first)->values ().begin ())->tag_id (), db2.tags ().tag ("tag1").id ());
+  EXPECT_EQ ((*be.first)->multiplicity (), size_t (17));
+  EXPECT_EQ ((*be.first)->visited (), false);
+  EXPECT_EQ ((*be.first)->has_tag (db2.tags ().tag ("tag1").id ()), true);
+  EXPECT_EQ ((*be.first)->has_tag (db2.tags ().tag ("tag2", true).id ()), false);
+
+  be = db2.items_by_cell_and_category (c2->id (), db2.category_by_name ("cath2")->id ());
+  EXPECT_EQ (be.first != be.second, true);
+  EXPECT_EQ (item_values (**be.first), "polygon: (0,0;0,100;100,100;100,0/10,10;20,10;20,20;10,20);edge: (1,-1;10,11);edge-pair: (0,0;0,10)|(5,10;5,0)");
+  EXPECT_EQ ((*be.first)->visited (), true);
+  EXPECT_EQ ((*be.first)->has_tag (db2.tags ().tag ("tag2", true).id ()), true);
+  EXPECT_EQ (db2.num_items_visited (), size_t (1));
+
+  be = db2.items_by_cell_and_category (c1->id (), db2.category_by_name ("cath2.cc")->id ());
+  EXPECT_EQ (be.first != be.second, true);
+  EXPECT_EQ (item_values (**be.first), "path: (0,0;10,0;10,20) w=2 bx=1 ex=0.5 r=false;label: ('T',r90 1,2)");
+}
+
+TEST(2_LazyLoading)
+{
+  std::string tmp_file = tl::TestBase::tmp_file ("tmp_2.lyrdbb");
+
+  {
+    rdb::Database db;
+
+    rdb::Category *cat = db.create_category ("cat");
+    rdb::Category *cat2 = db.create_category ("cat2");
+    rdb::Cell *c1 = db.create_cell ("c1");
+
+    //  a 100x100 grid of markers
+    for (int i = 0; i < 100; ++i) {
+      for (int j = 0; j < 100; ++j) {
+        rdb::Item *item = db.create_item (c1->id (), cat->id ());
+        item->values ().add (new rdb::Value<db::DBox> (db::DBox (i * 10.0, j * 10.0, i * 10.0 + 5.0, j * 10.0 + 5.0)));
+      }
+    }
+
+    //  one item without geometry
+    rdb::Item *item = db.create_item (c1->id (), cat->id ());
+    item->values ().add (new rdb::Value<std::string> ("no geometry"));
+
+    for (int i = 0; i < 10; ++i) {
+      rdb::Item *item = db.create_item (c1->id (), cat2->id ());
+      item->values ().add (new rdb::Value<db::DEdge> (db::DEdge (0, i, 10, i)));
+    }
+
+    tl::OutputStream os (tmp_file);
+    rdb::write_binary_database (db, os, 100);
+  }
+
+  rdb::Database db2;
+  db2.load (tmp_file);
+
+  EXPECT_EQ (db2.binary_file () != 0, true);
+  rdb::BinaryDatabaseFile &file = *db2.binary_file ();
+
+  rdb::id_type c1 = db2.cell_by_qname ("c1")->id ();
+  rdb::id_type cat = db2.category_by_name ("cat")->id ();
+  rdb::id_type cat2 = db2.category_by_name ("cat2")->id ();
+
+  //  100 blocks for the grid, one for the non-geometric item, one for cat2
+  EXPECT_EQ (file.num_blocks (), size_t (102));
+  EXPECT_EQ (file.num_items (), size_t (10011));
+  EXPECT_EQ (file.num_items (c1, cat), size_t (10001));
+  EXPECT_EQ (file.num_items (c1, cat2), size_t (10));
+  EXPECT_EQ (file.num_loaded_items (), size_t (0));
+
+  //  the counts are taken from the index
+  EXPECT_EQ (db2.num_items (), size_t (10011));
+  EXPECT_EQ (db2.num_items (c1, cat), size_t (10001));
+  EXPECT_EQ (db2.num_loaded_items (), size_t (0));
+
+  //  a small region needs a few blocks only plus the non-geometric one
+  size_t n = file.load_items (c1, cat, db::DBox (0, 0, 1, 1));
+  EXPECT_EQ (n > 1 && n <= 201, true);
+  EXPECT_EQ (file.num_loaded_items (), n);
+  EXPECT_EQ (db2.num_loaded_items (), n);
+  EXPECT_EQ (db2.is_modified (), false);
+
+  //  blocks are loaded only once
+  EXPECT_EQ (file.load_items (c1, cat, db::DBox (0, 0, 1, 1)), size_t (0));
+
+  //  asking the database for the items loads the remaining ones of this cell and category
+  bool found_box = false, found_text = false;
+  std::pair<rdb::Database::const_item_ref_iterator, rdb::Database::const_item_ref_iterator> be = db2.items_by_cell_and_category (c1, cat);
+  for ( ; be.first != be.second; ++be.first) {
+    std::string v = item_values (**be.first);
+    if (v == "box: (0,0;5,5)") {
+      found_box = true;
+    } else if (v == "text: 'no geometry'") {
+      found_text = true;
+    }
+  }
+  EXPECT_EQ (found_box, true);
+  EXPECT_EQ (found_text, true);
+
+  EXPECT_EQ (file.num_loaded_items (), size_t (10001));
+  EXPECT_EQ (num_items (db2, c1, cat), size_t (10001));
+  EXPECT_EQ (db2.num_items (), size_t (10011));
+  EXPECT_EQ (db2.num_items (c1, cat), size_t (10001));
+
+  EXPECT_EQ (num_items (db2, c1, cat2), size_t (10));
+  EXPECT_EQ (file.load_all_items (), size_t (0));
+  EXPECT_EQ (file.num_loaded_items (), size_t (10011));
+  EXPECT_EQ (db2.num_loaded_items (), size_t (10011));
+  EXPECT_EQ (db2.is_modified (), false);
+}
+
+TEST(3_OnDemandLoading)
+{
+  std::string tmp_file = tl::TestBase::tmp_file ("tmp_3.lyrdbb");
+
+  const int ncells = 50;
+  const int nitems = 400;
+
+  {
+    rdb::Database db;
+
+    rdb::Category *a = db.create_category ("a");
+    rdb::Category *ab = db.create_category (a, "b");
+    rdb::Category *c = db.create_category ("c");
+
+    for (int i = 0; i < ncells; ++i) {
+      rdb::Cell *cell = db.create_cell ("C" + tl::to_string (i));
+      for (int j = 0; j < nitems; ++j) {
+        rdb::Item *item = db.create_item (cell->id (), ab->id ());
+        item->values ().add (new rdb::Value<db::DBox> (db::DBox (j * 10.0, i * 10.0, j * 10.0 + 5.0, i * 10.0 + 5.0)));
+        if (j % 100 == 0) {
+          db.set_item_visited (item, true);
+        }
+        item = db.create_item (cell->id (), c->id ());
+        item->values ().add (new rdb::Value<db::DEdge> (db::DEdge (j * 10.0, i * 10.0, j * 10.0 + 5.0, i * 10.0)));
+      }
+    }
+
+    db.save (tmp_file);
+  }
+
+  rdb::Database db2;
+  db2.load (tmp_file);
+
+  EXPECT_EQ (db2.binary_file () != 0, true);
+  EXPECT_EQ (db2.is_modified (), false);
+
+  //  nothing is loaded, but the counts are complete
+  EXPECT_EQ (db2.num_loaded_items (), size_t (0));
+  EXPECT_EQ (db2.num_items (), size_t (ncells * nitems * 2));
+  EXPECT_EQ (db2.num_items_visited (), size_t (ncells * 4));
+
+  const rdb::Cell *c7 = db2.cell_by_qname ("C7");
+  const rdb::Category *a = db2.category_by_name ("a");
+  const rdb::Category *ab = db2.category_by_name ("a.b");
+  const rdb::Category *c = db2.category_by_name ("c");
+
+  EXPECT_EQ (c7->num_items (), size_t (nitems * 2));
+  EXPECT_EQ (c7->num_items_visited (), size_t (4));
+  EXPECT_EQ (a->num_items (), size_t (ncells * nitems));
+  EXPECT_EQ (a->num_items_visited (), size_t (ncells * 4));
+  EXPECT_EQ (c->num_items (), size_t (ncells * nitems));
+  EXPECT_EQ (db2.num_items (c7->id (), a->id ()), size_t (nitems));
+  EXPECT_EQ (db2.num_items (c7->id (), ab->id ()), size_t (nitems));
+  EXPECT_EQ (db2.num_items_visited (c7->id (), ab->id ()), size_t (4));
+  EXPECT_EQ (db2.num_items_visited (c7->id (), c->id ()), size_t (0));
+  EXPECT_EQ (db2.num_loaded_items (), size_t (0));
+
+  //  expanding a cell loads the items of this cell only
+  std::pair<rdb::Database::const_item_ref_iterator, rdb::Database::const_item_ref_iterator> be = db2.items_by_cell (c7->id ());
+  size_t n = 0, nv = 0;
+  for ( ; be.first != be.second; ++be.first) {
+    ++n;
+    if ((*be.first)->visited ()) {
+      ++nv;
+    }
+  }
+  EXPECT_EQ (n, size_t (nitems * 2));
+  EXPECT_EQ (nv, size_t (4));
+  EXPECT_EQ (db2.num_loaded_items (), size_t (nitems * 2));
+
+  //  expanding a category loads the items of this category in all cells
+  be = db2.items_by_category (c->id ());
+  n = 0;
+  for ( ; be.first != be.second; ++be.first) {
+    ++n;
+  }
+  EXPECT_EQ (n, size_t (ncells * nitems));
+  EXPECT_EQ (db2.num_loaded_items (), size_t (ncells * nitems + nitems));
+  EXPECT_EQ (db2.num_items (), size_t (ncells * nitems * 2));
+  EXPECT_EQ (db2.is_modified (), false);
+
+  //  loaded items are regular items
+  be = db2.items_by_cell_and_category (c7->id (), c->id ());
+  db2.set_item_visited (&**be.first, true);
+  EXPECT_EQ (db2.num_items_visited (), size_t (ncells * 4 + 1));
+  EXPECT_EQ (db2.num_items_visited (c7->id (), c->id ()), size_t (1));
+
+  //  saving loads the remaining items before the file is written, even if it is the same file
+  db2.save (tmp_file);
+  EXPECT_EQ (db2.num_loaded_items (), size_t (ncells * nitems * 2));
+
+  rdb::Database db3;
+  db3.load (tmp_file);
+
+  EXPECT_EQ (db3.num_items (), size_t (ncells * nitems * 2));
+  EXPECT_EQ (db3.num_items_visited (), size_t (ncells * 4 + 1));
+
+  n = 0;
+  nv = 0;
+  for (rdb::Items::const_iterator i = db3.items ().begin (); i != db3.items ().end (); ++i) {
+    ++n;
+    if (i->visited ()) {
+      ++nv;
+    }
+  }
+  EXPECT_EQ (n, size_t (ncells * nitems * 2));
+  EXPECT_EQ (nv, size_t (ncells * 4 + 1));
+  EXPECT_EQ (db3.num_loaded_items (), size_t (ncells * nitems * 2));
+}
@@ -9,6 +9,7 @@ DEFINES += MAKE_TL_LIBRARY
 FORMS =
 
 SOURCES = \
+    tlArena.cc \
     tlAssert.cc \
     tlClassRegistry.cc \
     tlCopyOnWrite.cc \
@@ -54,6 +55,7 @@ SOURCES = \
 
 HEADERS = \
     tlAlgorithm.h \
+    tlArena.h \
     tlAssert.h \
     tlClassRegistry.h \
     tlCopyOnWrite.h \
@@ -0,0 +1,105 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#include "tlArena.h"
+#include "tlAssert.h"
+
+#include <algorithm>
+
+namespace tl
+{
+
+Arena::Arena (size_t block_size)
+  : mp_ptr (0), mp_end (0), m_block_size (block_size), m_used (0), m_capacity (0)
+{
+  tl_assert (block_size > 0);
+}
+
+Arena::~Arena ()
+{
+  clear ();
+}
+
+void *
+Arena::allocate (size_t n, size_t align)
+{
+  tl_assert (align > 0 && (align & (align - 1)) == 0);
+
+  if (n == 0) {
+    n = 1;
+  }
+
+  //  big chunks get a block of their own, so the current block remains available
+  if (n > m_block_size / 4) {
+    m_used += n;
+    return new_block (n);
+  }
+
+  size_t pad = (align - ((size_t) mp_ptr & (align - 1))) & (align - 1);
+  if (! mp_ptr || pad + n > size_t (mp_end - mp_ptr)) {
+    mp_ptr = new_block (m_block_size);
+    mp_end = mp_ptr + m_block_size;
+    pad = 0;
+  }
+
+  char *p = mp_ptr + pad;
+  mp_ptr = p + n;
+  m_used += n;
+
+  return (void *) p;
+}
+
+char *
+Arena::new_block (size_t n)
+{
+  //  operator new delivers memory suitable for any fundamental alignment
+  char *b = (char *) ::operator new (n);
+  m_blocks.push_back (b);
+  m_capacity += n;
+  return b;
+}
+
+void
+Arena::clear ()
+{
+  for (std::vector<char *>::const_iterator b = m_blocks.begin (); b != m_blocks.end (); ++b) {
+    ::operator delete ((void *) *b);
+  }
+  m_blocks.clear ();
+  mp_ptr = mp_end = 0;
+  m_used = m_capacity = 0;
+}
+
+void
+Arena::swap (Arena &other)
+{
+  m_blocks.swap (other.m_blocks);
+  std::swap (mp_ptr, other.mp_ptr);
+  std::swap (mp_end, other.mp_end);
+  std::swap (m_block_size, other.m_block_size);
+  std::swap (m_used, other.m_used);
+  std::swap (m_capacity, other.m_capacity);
+}
+
+}
@@ -0,0 +1,131 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#ifndef HDR_tlArena
+#define HDR_tlArena
+
+#include "tlCommon.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace tl
+{
+
+/**
+ *  @brief A simple bump allocator
+ *
+ *  The arena hands out memory chunks from large blocks. Chunks cannot be
+ *  freed individually - the memory is released wholesale when the arena
+ *  is cleared or destroyed. This avoids many small heap allocations for
+ *  objects which share a common lifetime and makes tearing down such objects
+ *  cheap.
+ *
+ *  The arena is not thread-safe.
+ */
+class TL_PUBLIC Arena
+{
+public:
+  /**
+   *  @brief Constructor
+   *
+   *  @param block_size The size of the blocks to allocate from the heap
+   */
+  Arena (size_t block_size = 1024 * 1024);
+
+  /**
+   *  @brief Destructor
+   *
+   *  This will release all memory handed out by the arena.
+   */
+  ~Arena ();
+
+  /**
+   *  @brief Allocates a chunk of n bytes with the given alignment
+   *
+   *  The alignment must be a power of two. Chunks bigger than a fraction of the
+   *  block size are allocated in a block of their own.
+   */
+  void *allocate (size_t n, size_t align = sizeof (void *));
+
+  /**
+   *  @brief Allocates an uninitialized array of n objects of type T
+   */
+  template <class T>
+  T *allocate_array (size_t n)
+  {
+    return reinterpret_cast<T *> (allocate (n * sizeof (T), alignment_of<T> ()));
+  }
+
+  /**
+   *  @brief Releases all memory
+   *
+   *  All chunks handed out before become invalid.
+   */
+  void clear ();
+
+  /**
+   *  @brief Gets the number of bytes handed out
+   */
+  size_t used () const
+  {
+    return m_used;
+  }
+
+  /**
+   *  @brief Gets the number of bytes allocated from the heap
+   */
+  size_t capacity () const
+  {
+    return m_capacity;
+  }
+
+  /**
+   *  @brief Swaps the contents of two arenas
+   */
+  void swap (Arena &other);
+
+private:
+  std::vector<char *> m_blocks;
+  char *mp_ptr, *mp_end;
+  size_t m_block_size;
+  size_t m_used, m_capacity;
+
+  //  no copying
+  Arena (const Arena &);
+  Arena &operator= (const Arena &);
+
+  template <class T>
+  static size_t alignment_of ()
+  {
+    struct probe { char c; T t; };
+    return offsetof (probe, t);
+  }
+
+  char *new_block (size_t n);
+};
+
+}
+
+#endif
@@ -399,19 +399,19 @@ ArrayClass ArrayClass::instance;
 //  ExpressionNode implementation
 
 ExpressionNode::ExpressionNode (const ExpressionParserContext &context)
-  : m_context (context)
+  : m_context (context), m_can_fold (false)
 {
   // .. nothing yet ..
 }
 
-ExpressionNode::ExpressionNode (const ExpressionParserContext &context, size_t children)
-  : m_context (context)
+ExpressionNode::ExpressionNode (const ExpressionParserContext &context, size_t children, bool can_fold)
+  : m_context (context), m_can_fold (can_fold)
 {
   m_c.reserve (children);
 }
 
 ExpressionNode::ExpressionNode (const ExpressionNode &other, const tl::Expression *expr)
-  : m_context (other.m_context)
+  : m_context (other.m_context), m_can_fold (other.m_can_fold)
 {
   m_context.set_expr (expr);
   m_c.reserve (other.m_c.size ());
@@ -484,7 +484,7 @@ class TL_PUBLIC LessExpressionNode
 {
 public:
   LessExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -534,7 +534,7 @@ class TL_PUBLIC LessOrEqualExpressionNode
 {
 public:
   LessOrEqualExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -584,7 +584,7 @@ class TL_PUBLIC GreaterExpressionNode
 {
 public:
   GreaterExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -634,7 +634,7 @@ class TL_PUBLIC GreaterOrEqualExpressionNode
 {
 public:
   GreaterOrEqualExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -684,7 +684,7 @@ class TL_PUBLIC EqualExpressionNode
 {
 public:
   EqualExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -734,7 +734,7 @@ class TL_PUBLIC NotEqualExpressionNode
 {
 public:
   NotEqualExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -931,7 +931,7 @@ class TL_PUBLIC LogAndExpressionNode
 {
 public:
   LogAndExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -973,7 +973,7 @@ class TL_PUBLIC LogOrExpressionNode
 {
 public:
   LogOrExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1014,7 +1014,7 @@ class TL_PUBLIC IfExpressionNode
 {
 public:
   IfExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b, ExpressionNode *c)
-    : ExpressionNode (context, 3)
+    : ExpressionNode (context, 3, true)
   {
     add_child (a);
     add_child (b);
@@ -1052,7 +1052,7 @@ class TL_PUBLIC ShiftLeftExpressionNode
 {
 public:
   ShiftLeftExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1108,7 +1108,7 @@ class TL_PUBLIC ShiftRightExpressionNode
 {
 public:
   ShiftRightExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1164,7 +1164,7 @@ class TL_PUBLIC PlusExpressionNode
 {
 public:
   PlusExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1226,7 +1226,7 @@ class TL_PUBLIC MinusExpressionNode
 {
 public:
   MinusExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1286,7 +1286,7 @@ class TL_PUBLIC StarExpressionNode
 {
 public:
   StarExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1376,7 +1376,7 @@ class TL_PUBLIC SlashExpressionNode
 {
 public:
   SlashExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1460,7 +1460,7 @@ class TL_PUBLIC PercentExpressionNode
 {
 public:
   PercentExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1532,7 +1532,7 @@ class TL_PUBLIC AmpersandExpressionNode
 {
 public:
   AmpersandExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1588,7 +1588,7 @@ class TL_PUBLIC PipeExpressionNode
 {
 public:
   PipeExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1644,7 +1644,7 @@ class TL_PUBLIC AcuteExpressionNode
 {
 public:
   AcuteExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1782,7 +1782,7 @@ class TL_PUBLIC UnaryMinusExpressionNode
 {
 public:
   UnaryMinusExpressionNode (const ExpressionParserContext &context, ExpressionNode *a)
-    : ExpressionNode (context, 1)
+    : ExpressionNode (context, 1, true)
   {
     add_child (a);
   }
@@ -1839,7 +1839,7 @@ class TL_PUBLIC UnaryTildeExpressionNode
 {
 public:
   UnaryTildeExpressionNode (const ExpressionParserContext &context, ExpressionNode *a)
-    : ExpressionNode (context, 1)
+    : ExpressionNode (context, 1, true)
   {
     add_child (a);
   }
@@ -1894,7 +1894,7 @@ class TL_PUBLIC UnaryNotExpressionNode
 {
 public:
   UnaryNotExpressionNode (const ExpressionParserContext &context, ExpressionNode *a)
-    : ExpressionNode (context, 1)
+    : ExpressionNode (context, 1, true)
   {
     add_child (a);
   }
@@ -1947,6 +1947,11 @@ public:
     return new ConstantExpressionNode (*this, expr);
   }
 
+  const tl::Variant *constant_value () const
+  {
+    return &m_value;
+  }
+
   void execute (EvalTarget &v) const 
   {
     v.set (m_value);
@@ -1956,6 +1961,41 @@ private:
   tl::Variant m_value;
 };
 
+ExpressionNode *
+ExpressionNode::fold_constants ()
+{
+  bool all_constant = true;
+
+  for (std::vector <ExpressionNode *>::iterator c = m_c.begin (); c != m_c.end (); ++c) {
+
+    ExpressionNode *folded = (*c)->fold_constants ();
+    if (folded != *c) {
+      delete *c;
+      *c = folded;
+    }
+
+    //  objects are not folded as their methods may have side effects
+    const tl::Variant *cv = (*c)->constant_value ();
+    if (! cv || cv->is_user ()) {
+      all_constant = false;
+    }
+
+  }
+
+  if (! all_constant || ! can_fold ()) {
+    return this;
+  }
+
+  try {
+    EvalTarget v;
+    execute (v);
+    return new ConstantExpressionNode (m_context, *v);
+  } catch (tl::Exception &) {
+    //  errors are reported when the expression is executed
+    return this;
+  }
+}
+
 /**
  *  @brief Evaluates a bracket expression in the context
  */
@@ -2029,7 +2069,8 @@ public:
     for (std::vector<ExpressionNode *>::const_iterator c = m_c.begin () + 1; c != m_c.end (); ++c) {
       EvalTarget a;
       (*c)->execute (a);
-      vv.push_back (*a);
+      vv.push_back (tl::Variant ());
+      a.swap (vv.back ());
     }
 
     const EvalClass *c = 0;
@@ -2064,7 +2105,7 @@ class TL_PUBLIC ListExpressionNode
 {
 public:
   ListExpressionNode (const ExpressionParserContext &context)
-    : ExpressionNode (context)
+    : ExpressionNode (context, 0, true)
   {
     //  .. nothing yet ..
   }
@@ -2101,7 +2142,7 @@ class TL_PUBLIC ArrayExpressionNode
 {
 public:
   ArrayExpressionNode (const ExpressionParserContext &context)
-    : ExpressionNode (context)
+    : ExpressionNode (context, 0, true)
   {
     //  .. nothing yet ..
   }
@@ -2193,7 +2234,8 @@ public:
     for (std::vector<ExpressionNode *>::const_iterator c = m_c.begin (); c != m_c.end (); ++c) {
       EvalTarget a;
       (*c)->execute (a);
-      vv.push_back (*a);
+      vv.push_back (tl::Variant ());
+      a.swap (vv.back ());
     }
 
     tl::Variant o;
@@ -2229,6 +2271,12 @@ public:
     return new RVariableExpressionNode (*this, expr);
   }
 
+  const tl::Variant *constant_value () const
+  {
+    //  read-only variables are static constants
+    return mp_var;
+  }
+
   void execute (EvalTarget &v) const 
   {
     v.set (*mp_var);
@@ -3122,13 +3170,31 @@ Expression::execute (EvalTarget &v) const
   } 
 }
 
+void
+Expression::fold_constants ()
+{
+  if (m_root.get ()) {
+    ExpressionNode *folded = m_root->fold_constants ();
+    if (folded != m_root.get ()) {
+      m_root.reset (folded);
+    }
+  }
+}
+
+bool
+Expression::is_constant () const
+{
+  const tl::Variant *cv = m_root.get () ? m_root->constant_value () : 0;
+  return cv != 0 && ! cv->is_user ();
+}
+
 // ----------------------------------------------------------------------------
 //  Implementation of Eval
 
 Eval Eval::m_global;
 
 Eval::Eval (Eval *parent, bool sloppy)
-  : mp_parent (parent), m_sloppy (sloppy), mp_ctx_handler (0)
+  : mp_parent (parent), m_sloppy (sloppy), m_fold_constants (true), mp_ctx_handler (0)
 {
   // .. nothing yet ..
 }
@@ -3991,6 +4057,10 @@ Eval::parse (Expression &expr, const std::string &s, bool top)
   }
 
   context.expect_end ();
+
+  if (m_fold_constants) {
+    expr.fold_constants ();
+  }
 }
 
 void 
@@ -4009,6 +4079,10 @@ Eval::parse (Expression &expr, tl::Extractor &ex, bool top)
 
   expr.set_text (std::string (ex0.get (), ex.get () - ex0.get ())); 
 
+  if (m_fold_constants) {
+    expr.fold_constants ();
+  }
+
   ex = context;
 }
 
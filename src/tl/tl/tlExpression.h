@@ -170,8 +170,11 @@ public:
 
   /**
    *  @brief Constructor with reservation of a certain number of child nodes
+   *
+   *  "can_fold" indicates that the node has no side effects and can be replaced
+   *  by its value if all children are constants.
    */
-  ExpressionNode (const ExpressionParserContext &context, size_t children);
+  ExpressionNode (const ExpressionParserContext &context, size_t children, bool can_fold = false);
 
   /**
    *  @brief Copy ctor
@@ -198,7 +201,32 @@ public:
    */
   virtual ExpressionNode *clone (const tl::Expression *expr) const = 0;
 
+  /**
+   *  @brief Replaces constant subexpressions by their values
+   *
+   *  Returns the node which replaces this one. If this node is not replaced,
+   *  "this" is returned. Otherwise the caller is responsible for deleting this node.
+   */
+  ExpressionNode *fold_constants ();
+
+  /**
+   *  @brief Gets the value if the node delivers a constant
+   *  Returns 0 if the node's value is not a constant.
+   */
+  virtual const tl::Variant *constant_value () const
+  {
+    return 0;
+  }
+
 protected:
+  /**
+   *  @brief Returns true, if the node can be replaced by its value if all children are constants
+   */
+  bool can_fold () const
+  {
+    return m_can_fold;
+  }
+
   std::vector <ExpressionNode *> m_c;
   ExpressionParserContext m_context;
 
@@ -209,6 +237,9 @@ protected:
   {
     m_context.set_expr (expr);
   }
+
+private:
+  bool m_can_fold;
 };
 
 /**
@@ -328,6 +359,14 @@ public:
     mp_text = s;
   }
 
+  /**
+   *  @brief Returns true, if the expression delivers a constant value
+   *
+   *  This is the case if constant folding has reduced the expression to
+   *  a single value.
+   */
+  bool is_constant () const;
+
 private:
   const char *mp_text;
   std::string m_local_text;
@@ -353,6 +392,11 @@ private:
   {
     return m_root;
   }
+
+  /**
+   *  @brief Replaces constant subexpressions by their values
+   */
+  void fold_constants ();
 };
 
 /**
@@ -415,6 +459,26 @@ public:
    */
   void define_function (const std::string &name, EvalFunction *function);
 
+  /**
+   *  @brief Enables or disables constant folding
+   *
+   *  With constant folding enabled (the default), subexpressions which do not
+   *  depend on variables or functions are computed once when the expression
+   *  is parsed.
+   */
+  void set_fold_constants (bool f)
+  {
+    m_fold_constants = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether constant folding is enabled
+   */
+  bool fold_constants () const
+  {
+    return m_fold_constants;
+  }
+
   /**
    *  @brief Define a global variable for use within an expression
    */
@@ -517,6 +581,7 @@ private:
   std::map <std::string, tl::Variant> m_local_vars;
   std::map <std::string, EvalFunction *> m_local_functions;
   bool m_sloppy;
+  bool m_fold_constants;
   const ContextHandler *mp_ctx_handler;
   std::vector<std::string> m_match_substrings;
 
@@ -24,6 +24,7 @@
 #include "tlStream.h"
 #include "tlLog.h"
 #include "tlInternational.h"
+#include "tlEnv.h"
 
 #include <cctype>
 
@@ -594,6 +595,39 @@ std::string current_dir ()
 #endif
 }
 
+std::string tmpdir (const std::string &domain)
+{
+#if defined(_WIN32)
+
+  wchar_t buffer[MAX_PATH + 1];
+  DWORD len = GetTempPathW (MAX_PATH + 1, buffer);
+  std::string base = len > 0 ? tl::to_string (std::wstring (buffer, 0, len)) : current_dir ();
+
+  for (unsigned int i = 0; i < 1000; ++i) {
+    std::string path = combine_path (base, domain + "." + tl::to_string ((unsigned long) GetCurrentProcessId ()) + "." + tl::to_string (i));
+    if (! file_exists (path) && mkdir (path)) {
+      return path;
+    }
+  }
+
+  throw tl::Exception (tl::to_string (tr ("Unable to create a temporary directory in %s")), base);
+
+#else
+
+  std::string base = tl::get_env ("TMPDIR", "/tmp");
+
+  std::string tmpl = tl::to_local (combine_path (base, domain + ".XXXXXX"));
+  std::vector<char> buffer (tmpl.begin (), tmpl.end ());
+  buffer.push_back (0);
+
+  if (mkdtemp (&buffer.front ()) == NULL) {
+    throw tl::Exception (tl::to_string (tr ("Unable to create a temporary directory in %s")), base);
+  }
+
+  return tl::to_string_from_local (&buffer.front ());
+
+#endif
+}
 
 static std::pair<std::string, bool> absolute_path_of_existing (const std::string &s)
 {
@@ -170,6 +170,15 @@ std::string TL_PUBLIC combine_path (const std::string &p1, const std::string &p2
  */
 std::string TL_PUBLIC current_dir ();
 
+/**
+ *  @brief Creates a new, unique temporary directory and returns its path
+ *  The directory is created inside the system's temporary directory ($TMPDIR on Linux).
+ *  "domain" is used as the prefix for the directory name.
+ *  The caller is responsible for removing the directory (e.g. with "rm_dir_recursive").
+ *  An exception is thrown if the directory cannot be created.
+ */
+std::string TL_PUBLIC tmpdir (const std::string &domain);
+
 /**
  *  @brief This function splits the path into it's components
  *  On Windows, the first component may be the drive prefix ("C:") or
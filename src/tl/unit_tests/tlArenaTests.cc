@@ -0,0 +1,86 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2021 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#include "tlArena.h"
+#include "tlUnitTest.h"
+
+#include <cstring>
+
+TEST(1)
+{
+  tl::Arena arena (1024);
+  EXPECT_EQ (arena.used (), size_t (0));
+  EXPECT_EQ (arena.capacity (), size_t (0));
+
+  char *c1 = (char *) arena.allocate (3, 1);
+  char *c2 = (char *) arena.allocate (5, 1);
+  EXPECT_EQ (c2 - c1, 3);
+  EXPECT_EQ (arena.used (), size_t (8));
+  EXPECT_EQ (arena.capacity (), size_t (1024));
+
+  //  alignment
+  double *d = (double *) arena.allocate (sizeof (double), sizeof (double));
+  EXPECT_EQ (((size_t) d) % sizeof (double), size_t (0));
+  *d = 1.5;
+
+  int *ia = arena.allocate_array<int> (10);
+  EXPECT_EQ (((size_t) ia) % sizeof (int), size_t (0));
+  for (int i = 0; i < 10; ++i) {
+    ia [i] = i;
+  }
+
+  //  a new block is started if the current one is exhausted
+  for (int i = 0; i < 10; ++i) {
+    memset (arena.allocate (200), 0, 200);
+  }
+  EXPECT_EQ (arena.capacity () > size_t (1024), true);
+
+  //  big chunks get a block of their own
+  size_t cap = arena.capacity ();
+  memset (arena.allocate (5000), 0, 5000);
+  EXPECT_EQ (arena.capacity (), cap + 5000);
+
+  EXPECT_EQ (*d, 1.5);
+  EXPECT_EQ (ia [9], 9);
+
+  arena.clear ();
+  EXPECT_EQ (arena.used (), size_t (0));
+  EXPECT_EQ (arena.capacity (), size_t (0));
+
+  c1 = (char *) arena.allocate (3, 1);
+  EXPECT_EQ (c1 != 0, true);
+  EXPECT_EQ (arena.capacity (), size_t (1024));
+}
+
+TEST(2)
+{
+  tl::Arena a1, a2 (100);
+  a1.allocate (10);
+  EXPECT_EQ (a1.used (), size_t (10));
+  a1.swap (a2);
+  EXPECT_EQ (a1.used (), size_t (0));
+  EXPECT_EQ (a2.used (), size_t (10));
+  a1.allocate (10);
+  EXPECT_EQ (a1.capacity (), size_t (100));
+}
@@ -24,6 +24,7 @@
 #include "tlExpression.h"
 #include "tlVariantUserClasses.h"
 #include "tlUnitTest.h"
+#include "tlTimer.h"
 #include "tlEnv.h"
 
 #define _USE_MATH_DEFINES // for MSVC
@@ -1189,3 +1190,148 @@ TEST(19)
   v = e.parse ("# A comment\nvar i=CellInstArray.new(17,tr,a,b,100,200); i.to_s(); # A final comment").execute ();
   EXPECT_EQ (v.to_string (), std::string ("#17 r90 10,20 [1,2*100;11,22*200]"));
 }
+
+// constant folding
+TEST(20)
+{
+  tl::Eval e;
+  tl::Eval en;
+  en.set_fold_constants (false);
+  EXPECT_EQ (e.fold_constants (), true);
+  EXPECT_EQ (en.fold_constants (), false);
+
+  const char *exprs[] = {
+    "1+2*3",
+    "(1+2)*3-7%4",
+    "M_PI*2",
+    "'a'+'b'+'c'",
+    "1<2 && 2>=2 || false",
+    "-(5-7)",
+    "~5|2",
+    "[1,2+3,'x'][1]",
+    "{1=>2*3}",
+    "1>2?'a':'b'"
+  };
+
+  for (size_t i = 0; i < sizeof (exprs) / sizeof (exprs[0]); ++i) {
+    EXPECT_EQ (e.parse (exprs [i]).execute ().to_string (), en.parse (exprs [i]).execute ().to_string ());
+  }
+
+  tl::Variant v;
+  v = e.parse ("2*3+4").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("10"));
+  v = e.parse ("[1,2*3]").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("1,6"));
+
+  //  errors are not raised at parse time but when the expression is executed
+  tl::Expression ex;
+  e.parse (ex, "1/0");
+  bool error = false;
+  try {
+    ex.execute ();
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+
+  //  non-constant parts are not affected
+  e.set_var ("x", 17);
+  ex = tl::Expression ();
+  e.parse (ex, "x*(2+3)");
+  EXPECT_EQ (ex.execute ().to_string (), std::string ("85"));
+  e.set_var ("x", 2);
+  EXPECT_EQ (ex.execute ().to_string (), std::string ("10"));
+
+  //  assignments are never folded
+  e.parse ("var y=1+1").execute ();
+  EXPECT_EQ (e.parse ("y=y+2; y").execute ().to_string (), std::string ("4"));
+  EXPECT_EQ (e.parse ("y=y+2; y").execute ().to_string (), std::string ("6"));
+}
+
+// constant folding: which expressions are reduced to constants
+TEST(21)
+{
+  tl::Eval e;
+  tl::Eval en;
+  en.set_fold_constants (false);
+
+  e.set_var ("x", 1.0);
+  en.set_var ("x", 1.0);
+
+  EXPECT_EQ (e.parse ("1+2*3").is_constant (), true);
+  EXPECT_EQ (en.parse ("1+2*3").is_constant (), false);
+  EXPECT_EQ (e.parse ("(M_PI/180.0)*(2*3-1)").is_constant (), true);
+  EXPECT_EQ (e.parse ("[1,2*3,'a'+'b']").is_constant (), true);
+  EXPECT_EQ (e.parse ("1>2?'a':'b'").is_constant (), true);
+  EXPECT_EQ (e.parse ("17").is_constant (), true);
+
+  //  variables, functions and errors prevent folding
+  EXPECT_EQ (e.parse ("x*(M_PI/180.0)").is_constant (), false);
+  EXPECT_EQ (e.parse ("sqrt(16)").is_constant (), false);
+  EXPECT_EQ (e.parse ("1/0").is_constant (), false);
+  EXPECT_EQ (e.parse ("var y=1+2").is_constant (), false);
+
+  //  partially constant expressions deliver the same result
+  const char *expr = "x*(M_PI/180.0)+(2*3-1)*sqrt(16)+abs(-2.5*4)";
+
+  tl::Expression ex, exn;
+  e.parse (ex, expr);
+  en.parse (exn, expr);
+  EXPECT_EQ (ex.execute ().to_string (), exn.execute ().to_string ());
+
+  e.set_var ("x", 180.0);
+  en.set_var ("x", 180.0);
+  EXPECT_EQ (ex.execute ().to_string (), exn.execute ().to_string ());
+  EXPECT_EQ (ex.execute ().to_string (), std::string ("33.1415926536"));
+}
+
+// constant folding benchmark: the same expressions evaluated with and without folding
+TEST(22)
+{
+  //  typical per-shape or per-tile expressions: mixed constant and variable parts,
+  //  a fully constant one and one without constant parts
+  const char *exprs[] = {
+    "x*(M_PI/180.0)+(2*3-1)*sqrt(16)+abs(-2.5*4)",
+    "x>(1000*0.001+0.5*2) && x<(10000*0.001*(1+1))",
+    "(M_PI/180.0)*(90-45/2)+[1,2*3,4][1]",
+    "x*x+x"
+  };
+
+  const int n = 100000;
+
+  for (size_t i = 0; i < sizeof (exprs) / sizeof (exprs[0]); ++i) {
+
+    tl::Eval e, en;
+    en.set_fold_constants (false);
+    e.set_var ("x", 0.0);
+    en.set_var ("x", 0.0);
+
+    tl::Expression ex, exn;
+    e.parse (ex, exprs [i]);
+    en.parse (exn, exprs [i]);
+
+    double r = 0.0, rn = 0.0;
+    tl::Timer timer;
+
+    timer.start ();
+    for (int j = 0; j < n; ++j) {
+      en.set_var ("x", double (j % 100));
+      rn += exn.execute ().to_double ();
+    }
+    timer.stop ();
+    double t_tree = timer.sec_user ();
+
+    timer.start ();
+    for (int j = 0; j < n; ++j) {
+      e.set_var ("x", double (j % 100));
+      r += ex.execute ().to_double ();
+    }
+    timer.stop ();
+    double t_folded = timer.sec_user ();
+
+    tl::info << "'" << exprs [i] << "': " << n << " evaluations in " << t_tree << "s without and " << t_folded << "s with constant folding";
+
+    EXPECT_EQ (tl::to_string (r), tl::to_string (rn));
+
+  }
+}
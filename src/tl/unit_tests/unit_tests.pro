@@ -8,6 +8,7 @@ include($$PWD/../../lib_ut.pri)
 
 SOURCES = \
   tlAlgorithmTests.cc \
+  tlArenaTests.cc \
   tlClassRegistryTests.cc \
   tlCommandLineParserTests.cc \
   tlCopyOnWriteTests.cc \
@@ -39,7 +39,7 @@ class Buddies_TestClass < TestBase
   def test_basic
 
     # Basic - buddies can be called
-    %w(strm2cif strm2dxf strm2gds strm2gdstxt strm2oas strm2mag strm2txt strmclip strmcmp strmrun strmxor).each do |bin|
+    %w(strm2cif strm2dxf strm2gds strm2gdstxt strm2oas strm2mag strm2txt strmclip strmcmp strmrun strmtile strmxor).each do |bin|
       version = bin + " " + `#{self.buddy_bin(bin)} --version`
       assert_equal(version =~ /^#{bin} \d+\./, 0) 
     end
@@ -21,6 +21,7 @@ import unittest
 import os
 import sys
 import gc
+import threading
 
 # Set this to True to disable some tests involving exceptions
 leak_check = "TEST_LEAK_CHECK" in os.environ
@@ -2893,6 +2894,72 @@ class BasicTest(unittest.TestCase):
     self.assertEqual(pya.GObject.g_inst_count(), gc)
 
 
+  # Overload resolution is cached per argument types
+  def test_81(self):
+
+    b = pya.B()
+    a = pya.A()
+    ax = AEXT()
+
+    def outcome(f):
+      try:
+        return str(f())
+      except:
+        return "error"
+
+    none_result = outcome(lambda: b.bx(None))
+
+    # the result does not depend on the order of calls
+    for i in range(0, 3):
+      self.assertEqual(b.bx(), 17)
+      self.assertEqual(b.bx(5), "xz")
+      self.assertEqual(b.bx(a), "aref")
+      self.assertEqual(outcome(lambda: b.bx(None)), none_result)
+      self.assertEqual(b.bx(ax), "aref")
+      self.assertEqual(b.bx(6), "xz")
+      self.assertEqual(b.bx("a", 15), 20.5)
+      self.assertEqual(b.bx(a, 15), "aref+i")
+      self.assertEqual(b.bx(ax, 15), "aref+i")
+      # failed resolutions are not cached
+      if not leak_check:
+        self.assertEqual(outcome(lambda: b.bx(a, "X")), "error")
+        self.assertEqual(outcome(lambda: b.bx(1, 5, 7)), "error")
+      self.assertEqual(b.bx(a, 16), "aref+i")
+
+    # list arguments are not cached, but resolved each time
+    self.assertEqual(b.b22a([ pya.LayerInfo("hallo") ]), 1)
+    self.assertEqual(b.b22a([ pya.LayerInfo("hallo") ]), 1)
+
+    b.destroy()
+    a.destroy()
+
+  # Callbacks from methods running without the interpreter lock
+  def test_82(self):
+
+    c1 = C_IMP1()
+    self.assertEqual(c1.g_allow_threads("x"), 615)
+    c2 = C_IMP2()
+    self.assertEqual(c2.g_allow_threads("abc"), 3)
+    c0 = pya.C()
+    self.assertEqual(c0.g_allow_threads("x"), 1977)
+
+    # with other Python threads running
+    results = []
+    def worker():
+      c = C_IMP2()
+      for i in range(0, 100):
+        results.append(c.g_allow_threads("ab"))
+
+    threads = [ threading.Thread(target = worker) for i in range(0, 4) ]
+    for t in threads:
+      t.start()
+    for t in threads:
+      t.join()
+
+    self.assertEqual(len(results), 400)
+    self.assertEqual(sum(results), 800)
+
+
 # run unit tests
 if __name__ == '__main__':
   suite = unittest.TestSuite()
@@ -20,6 +20,7 @@ import pya
 import unittest
 import sys
 import os
+import array
 
 class DBRegionTest(unittest.TestCase):
 
@@ -40,6 +41,46 @@ class DBRegionTest(unittest.TestCase):
     r.merge()
     self.assertEqual(str(r), "(0,100;0,300;50,300;50,350;250,350;250,150;200,150;200,100)")
 
+  def test_2_Arrays(self):
+
+    r = pya.Region()
+    r.insert(pya.Box(0, 100, 200, 300))
+    r.insert(pya.Polygon([ pya.Point(0, 0), pya.Point(0, 10), pya.Point(10, 0) ]))
+
+    (coords, contours, polygons) = r.to_arrays()
+
+    a = array.array("i")
+    a.frombytes(coords)
+    self.assertEqual(len(a), 14)
+
+    a = array.array("q")
+    a.frombytes(contours)
+    self.assertEqual(list(a), [ 0, 4, 7 ])
+
+    a = array.array("q")
+    a.frombytes(polygons)
+    self.assertEqual(list(a), [ 0, 1, 2 ])
+
+    r2 = pya.Region.from_arrays(coords, contours, polygons)
+    self.assertEqual(str(r2), str(r))
+
+    # objects implementing the buffer protocol are accepted as well
+    r2 = pya.Region.from_arrays(array.array("i", [ 0, 0, 0, 10, 10, 10, 10, 0 ]), array.array("q", [ 0, 4 ]), array.array("q", [ 0, 1 ]))
+    self.assertEqual(str(r2), "(0,0;0,10;10,10;10,0)")
+
+    e = pya.Edges(pya.Box(0, 0, 10, 20))
+    e2 = pya.Edges.from_array(e.to_array())
+    self.assertEqual(str(e2), str(e))
+
+    ly = pya.Layout()
+    top = ly.create_cell("TOP")
+    shapes = top.shapes(ly.layer(1, 0))
+    shapes.insert_polygon_arrays(coords, contours, polygons)
+    self.assertEqual(shapes.size(), 2)
+    (coords2, contours2, polygons2) = shapes.to_polygon_arrays()
+    self.assertEqual(len(coords2), len(coords))
+    self.assertEqual(contours2, contours)
+
   def test_deep1(self):
 
     ut_testsrc = os.getenv("TESTSRC")
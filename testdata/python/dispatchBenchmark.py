@@ -0,0 +1,93 @@
+# encoding: UTF-8
+
+# KLayout Layout Viewer
+# Copyright (C) 2006-2021 Matthias Koefferlein
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+import pya
+import unittest
+import sys
+import time
+import os
+
+# Measures the throughput of frequently used, overloaded methods.
+# The results are printed as calls per second. The iteration count
+# can be raised with the KLAYOUT_BENCHMARK_ITERATIONS environment variable.
+
+iterations = int(os.getenv("KLAYOUT_BENCHMARK_ITERATIONS", "20000"))
+
+def report(name, n, t):
+  if t > 0:
+    print("%-24s %12.0f calls/s" % (name, n / t))
+
+class DispatchBenchmark(unittest.TestCase):
+
+  def test_1_BoxNew(self):
+
+    t = time.time()
+    b = None
+    for i in range(0, iterations):
+      b = pya.Box(i, 0, i + 100, 200)
+    report("Box.new", iterations, time.time() - t)
+
+    self.assertEqual(str(b), "(" + str(iterations - 1) + ",0;" + str(iterations + 99) + ",200)")
+
+  def test_2_TransPoint(self):
+
+    tr = pya.Trans(pya.Trans.R90, pya.Vector(10, 20))
+    p = pya.Point(1, 2)
+    box = pya.Box(0, 0, 100, 200)
+
+    t = time.time()
+    q = None
+    for i in range(0, iterations):
+      q = tr * p
+    report("Trans * Point", iterations, time.time() - t)
+
+    self.assertEqual(str(q), "8,21")
+
+    t = time.time()
+    bb = None
+    for i in range(0, iterations):
+      bb = tr * box
+    report("Trans * Box", iterations, time.time() - t)
+
+    self.assertEqual(str(bb), "(-190,20;10,120)")
+
+  def test_3_ShapePolygon(self):
+
+    ly = pya.Layout()
+    top = ly.create_cell("TOP")
+    shapes = top.shapes(ly.layer(1, 0))
+    for i in range(0, 100):
+      shapes.insert(pya.Box(i * 10, 0, i * 10 + 5, 5))
+
+    n = 0
+    t = time.time()
+    while n < iterations:
+      for s in shapes.each():
+        s.polygon
+        n += 1
+    report("Shape#polygon", n, time.time() - t)
+
+    self.assertEqual(n >= iterations, True)
+
+# run unit tests
+if __name__ == '__main__':
+  suite = unittest.TestLoader().loadTestsFromTestCase(DispatchBenchmark)
+
+  if not unittest.TextTestRunner(verbosity = 1).run(suite).wasSuccessful():
+    sys.exit(1)
@@ -0,0 +1,108 @@
+# encoding: UTF-8
+
+# KLayout Layout Viewer
+# Copyright (C) 2006-2021 Matthias Koefferlein
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+if !$:.member?(File::dirname($0))
+  $:.push(File::dirname($0))
+end
+
+load("test_prologue.rb")
+
+# Measures the throughput of frequently used, overloaded methods.
+# The results are printed as calls per second. The iteration count
+# can be raised with the KLAYOUT_BENCHMARK_ITERATIONS environment variable.
+
+class DispatchBenchmark_TestClass < TestBase
+
+  def iterations
+    (ENV["KLAYOUT_BENCHMARK_ITERATIONS"] || "20000").to_i
+  end
+
+  def report(name, n, t)
+    if t > 0
+      puts "%-24s %12.0f calls/s" % [ name, n / t ]
+    end
+  end
+
+  def test_1_BoxNew
+
+    n = iterations
+    t = Time.now
+    b = nil
+    n.times do |i|
+      b = RBA::Box::new(i, 0, i + 100, 200)
+    end
+    report("Box.new", n, Time.now - t)
+
+    assert_equal(b.to_s, "(#{n - 1},0;#{n + 99},200)")
+
+  end
+
+  def test_2_TransPoint
+
+    tr = RBA::Trans::new(RBA::Trans::R90, RBA::Vector::new(10, 20))
+    p = RBA::Point::new(1, 2)
+    box = RBA::Box::new(0, 0, 100, 200)
+
+    n = iterations
+    t = Time.now
+    q = nil
+    n.times do
+      q = tr * p
+    end
+    report("Trans * Point", n, Time.now - t)
+
+    assert_equal(q.to_s, "8,21")
+
+    t = Time.now
+    bb = nil
+    n.times do
+      bb = tr * box
+    end
+    report("Trans * Box", n, Time.now - t)
+
+    assert_equal(bb.to_s, "(-190,20;10,120)")
+
+  end
+
+  def test_3_ShapePolygon
+
+    ly = RBA::Layout::new
+    top = ly.create_cell("TOP")
+    shapes = top.shapes(ly.layer(1, 0))
+    100.times do |i|
+      shapes.insert(RBA::Box::new(i * 10, 0, i * 10 + 5, 5))
+    end
+
+    n = 0
+    t = Time.now
+    while n < iterations
+      shapes.each do |s|
+        s.polygon
+        n += 1
+      end
+    end
+    report("Shape#polygon", n, Time.now - t)
+
+    assert_equal(n >= iterations, true)
+
+  end
+
+end
+
+load("test_epilogue.rb")
@@ -418,6 +418,144 @@ class LAYLayoutView_TestClass < TestBase
 
   end
 
+  def make_snapshot_view
+
+    lv = RBA::LayoutView::new
+
+    cv = lv.cellview(lv.create_layout(1))
+    ly = cv.layout
+
+    top = ly.create_cell("TOP")
+    a = ly.create_cell("A")
+
+    l1 = ly.layer(1, 0)
+    l2 = ly.layer(2, 0)
+    l3 = ly.layer(3, 0)
+
+    # objects of various sizes, so that all passes of progressive rendering
+    # contribute to the image
+    a.shapes(l1).insert(RBA::Box::new(0, 0, 200, 200))
+    a.shapes(l1).insert(RBA::Box::new(300, 0, 310, 10))
+    a.shapes(l2).insert(RBA::Polygon::new([ RBA::Point::new(0, 300), RBA::Point::new(250, 300), RBA::Point::new(0, 550) ]))
+    a.shapes(l3).insert(RBA::Path::new([ RBA::Point::new(0, 600), RBA::Point::new(400, 600) ], 20))
+
+    top.insert(RBA::CellInstArray::new(a.cell_index, RBA::Trans::new, RBA::Vector::new(500, 0), RBA::Vector::new(0, 700), 20, 20))
+    top.shapes(l1).insert(RBA::Box::new(-1000, -1000, 11000, -500))
+    top.shapes(l2).insert(RBA::Box::new(-1000, 14000, 11000, 20000))
+    top.shapes(l3).insert(RBA::Box::new(2000, 2000, 2001, 2001))
+
+    cv.cell = top
+
+    lv.add_missing_layers
+    lv.max_hier
+    lv.zoom_fit
+
+    lv
+
+  end
+
+  def layer_ids(lv)
+    ids = []
+    li = lv.begin_layers
+    while !li.at_end?
+      ids << li.current.id
+      li.next
+    end
+    ids
+  end
+
+  def test_4
+
+    # batch snapshots compared against serial renders
+    lv = make_snapshot_view
+
+    targets = [
+      RBA::DBox::new,
+      RBA::DBox::new(0, 0, 1.0, 1.0),
+      RBA::DBox::new(-1.0, -1.0, 5.0, 3.0),
+      RBA::DBox::new(2.0, 2.0, 2.001, 2.001),
+      RBA::DBox::new
+    ]
+
+    ids = layer_ids(lv)
+    assert_equal(ids.size, 3)
+
+    # the layer IDs are given in a different order than the layer list
+    layer_sets = [ [], [], [], [], [ ids[2], ids[0] ] ]
+
+    # threads = 0 renders one image after the other
+    serial = targets.size.times.collect { |i| File::join($ut_testtmp, "serial_#{i}.png") }
+    lv.save_images_with_options(serial, targets, 200, 100, 0, 1, 0.0, false, 0, layer_sets)
+
+    concurrent = targets.size.times.collect { |i| File::join($ut_testtmp, "concurrent_#{i}.png") }
+    lv.save_images_with_options(concurrent, targets, 200, 100, 0, 1, 0.0, false, 3, layer_sets)
+
+    targets.size.times do |i|
+      assert_equal(File::binread(concurrent[i]) == File::binread(serial[i]), true)
+    end
+
+    # the image of the current viewport is identical to the one from save_image_with_options
+    single = File::join($ut_testtmp, "single.png")
+    lv.save_image_with_options(single, 200, 100, 0, 1, 0.0, RBA::DBox::new, false)
+    assert_equal(File::binread(single) == File::binread(serial[0]), true)
+
+    # hiding layer 2/0 gives the image of the layer set
+    assert_equal(File::binread(serial[4]) == File::binread(serial[0]), false)
+    li = lv.begin_layers
+    li.next
+    lp = li.current.dup
+    lp.visible = false
+    lv.set_layer_properties(li, lp)
+    lv.save_image_with_options(single, 200, 100, 0, 1, 0.0, RBA::DBox::new, false)
+    assert_equal(File::binread(single) == File::binread(serial[4]), true)
+
+    # invalid layer IDs are reported
+    begin
+      lv.save_images_with_options([ single ], [ RBA::DBox::new ], 200, 100, 0, 1, 0.0, false, 0, [ [ ids.max + 1000 ] ])
+      assert_equal(true, false)
+    rescue => ex
+      assert_equal(ex.to_s.index("Not a valid layer ID") != nil, true)
+    end
+
+  end
+
+  def test_5
+
+    # progressive rendering: the coarse passes and the final pass together
+    # produce the same image as the regular rendering
+    lv = make_snapshot_view
+
+    targets = [
+      RBA::DBox::new,
+      RBA::DBox::new(0, 0, 1.0, 1.0),
+      RBA::DBox::new(-1.0, -1.0, 5.0, 3.0)
+    ]
+
+    regular = targets.size.times.collect { |i| File::join($ut_testtmp, "regular_#{i}.png") }
+    lv.save_images_with_options(regular, targets, 300, 200, 0, 1, 0.0, false, 0)
+
+    lv.set_config("progressive-rendering", "true")
+
+    progressive = targets.size.times.collect { |i| File::join($ut_testtmp, "progressive_#{i}.png") }
+    lv.save_images_with_options(progressive, targets, 300, 200, 0, 1, 0.0, false, 2)
+
+    targets.size.times do |i|
+      assert_equal(File::binread(progressive[i]) == File::binread(regular[i]), true)
+    end
+
+    # a cancelled progressive redraw does not leave partial drawings behind:
+    # the next snapshot is complete
+    lv.zoom_box(RBA::DBox::new(0, 0, 1.0, 1.0))
+    lv.stop_redraw
+    lv.zoom_fit
+    lv.stop_redraw
+
+    single = File::join($ut_testtmp, "single.png")
+    lv.save_image_with_options(single, 300, 200, 0, 1, 0.0, RBA::DBox::new, false)
+    assert_equal(File::binread(single) == File::binread(regular[0]), true)
+
+  end
+
 end
 
 load("test_epilogue.rb")